@@ -95,6 +95,8 @@
 //*	Mar 22,	2024	<MLS> Build 175
 //*	Apr 15,	2024	<MLS> Build 176
 //*	Apr 29,	2024	<MLS> Build 177
+//*	Oct 19,	2026	<MLS> Added kAlpacaImageData_Packed12/14 & TYPE_PackedImageInfo
+//*	Oct 19,	2026	<MLS> Added kAlpacaImageData_Compressed & TYPE_CompressedImageInfo
 //*****************************************************************************
 //#include	"alpaca_defs.h"
 
@@ -765,9 +767,58 @@ enum
 	kAlpacaImageData_Decimal	=	5,
 	kAlpacaImageData_Byte		=	6,
 	kAlpacaImageData_Int64		=	7,
-	kAlpacaImageData_UInt16		=	8
+	kAlpacaImageData_UInt16		=	8,
+
+	//*	AlpacaPi extension, NOT part of the Alpaca standard.
+	//*	Only sent when the client asks for "application/imagebytes-packed",
+	//*	the value is 100 + the bits per pixel.  The header is followed by
+	//*	TYPE_PackedImageInfo, the data then starts at DataStart.
+	//*	Groups of 4 pixels are packed into (bits / 2) bytes, little endian,
+	//*	first pixel in the low bits.  Each pixel is (value >> Shift).
+	kAlpacaImageData_Packed12	=	112,
+	kAlpacaImageData_Packed14	=	114,
+
+	//*	AlpacaPi extension, NOT part of the Alpaca standard.
+	//*	Only sent when the client asks for "application/imagebytes-deflate".
+	//*	The header is followed by TYPE_CompressedImageInfo, then BandCount int32
+	//*	compressed band sizes, the band data then starts at DataStart.
+	//*	The uncompressed data is the normal imagebytes data of type ElementType.
+	//*	Band bb covers Dimension1 indexes (bb * Dimension1) / BandCount up to
+	//*	((bb + 1) * Dimension1) / BandCount, each band is compressed on its own
+	kAlpacaImageData_Compressed	=	200
 };
 
+//*****************************************************************************
+//*	kAlpacaImageData_Compressed
+enum
+{
+	kAlpacaCodec_Deflate		=	1		//*	zlib format (RFC 1950)
+};
+
+enum
+{
+	kAlpacaPredictor_None		=	0,
+	kAlpacaPredictor_Delta		=	1		//*	difference to the value PredictorStride elements back,
+											//*	zigzag coded, split into byte planes (image_kernels.c)
+};
+
+typedef struct	//	TYPE_CompressedImageInfo
+{
+	int32_t		ElementType;				// Bytes 44..47 - TransmissionElementType of the uncompressed data
+	int32_t		Codec;						// Bytes 48..51 - kAlpacaCodec_xxx
+	int32_t		Predictor;					// Bytes 52..55 - kAlpacaPredictor_xxx
+	int32_t		PredictorStride;			// Bytes 56..59 - 2 for Bayer data, 3 for RGB
+	int32_t		BandCount;					// Bytes 60..63
+	int32_t		UncompressedSize;			// Bytes 64..67
+} TYPE_CompressedImageInfo;
+
+//*****************************************************************************
+typedef struct	//	TYPE_PackedImageInfo
+{
+	int32_t		BitsPerPixel;				// Bytes 44..47
+	int32_t		Shift;						// Bytes 48..51 - value = (packed << Shift)
+} TYPE_PackedImageInfo;
+
 
 //*****************************************************************************
 //*	slit tracker properties, (NOT defined by ASCOM)
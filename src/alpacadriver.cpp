@@ -187,6 +187,10 @@
 //*	Apr 25,	2024	<MLS> Successfully got JavaScript to send HTTP PUT command
 //*	Apr 25,	2024	<MLS> Added ProcessOptionsCommand()
 //*	Apr 28,	2024	<MLS> Fixed ProcessGetPutRequest() to properly handle image requests
+//*	Oct 19,	2026	<MLS> Added -m <count> option for the number of simulator cameras
+//*	Oct 19,	2026	<MLS> Added -w option for wide (legacy) imagebytes element types
+//*	Oct 19,	2026	<MLS> Added -k option to lock the camera frame buffers in RAM
+//*	Oct 19,	2026	<MLS> SendFileToSocket() now sends the HTTP header and supports Range requests
 //*****************************************************************************
 //*	to install code blocks 20
 //*	Step 1: sudo add-apt-repository ppa:codeblocks-devs/release
@@ -314,6 +318,9 @@ bool			gLiveView									=	false;
 bool			gAutoExposure								=	false;
 bool			gDisplayImage								=	false;
 bool			gSimulateCameraImage						=	false;
+int				gSimCameraCount								=	1;
+bool			gImageBytesLegacy							=	false;	//*	Int32 imagebytes for old clients
+bool			gLockFrameBuffers							=	false;	//*	mlock() the camera frame buffers
 bool			gVerbose									=	false;
 bool			gDebugDiscovery								=	false;
 bool			gObservatorySettingsOK						=	false;
@@ -2843,36 +2850,14 @@ char	lineBuffer[256];
 	SocketWriteData(socketFD,	"</UL>\r\n");
 }
 
-//*****************************************************************************
-const char	gHTML_HeaderJpeg[]	=
-{
-	"HTTP/1.0 200 ok\r\n"
-//	"Server: alpaca\r\n"
-	"Mime-Version: 1.0\r\n"
-	"Content-Type: image/jpeg\r\n"
-	"Connection: close\r\n"
-	"\r\n"
-
-};
-
-
-//*****************************************************************************
-const char	gHTML_HeaderPNG[]	=
-{
-	"HTTP/1.0 200 ok\r\n"
-//	"Server: alpaca\r\n"
-	"Mime-Version: 1.0\r\n"
-	"Content-Type: image/png\r\n"
-	"Connection: close\r\n"
-	"\r\n"
-
-};
-
 //*****************************************************************************
 //*	Open and sends fileName to socket as a binary stream
+//*	If contentType is not NULL, the HTTP header is sent as well, it supports
+//*	"Range:" requests so an interrupted download can be resumed.
+//*	The ETag is made from the modification time and size of the file.
 //*	returns bytes sent
 //*****************************************************************************
-static int	SendFileToSocket(int socket, const char *fileName)
+static int	SendFileToSocket(int socket, const char *fileName, const char *contentType, const char *htmlData)
 {
 FILE			*filePointer;
 int				numRead;
@@ -2880,6 +2865,15 @@ int				bytesWritten;
 int				totalBytesWritten;
 bool			keepGoing;
 char			dataBuffer[1600];
+char			httpHeader[512];
+char			lineBuff[128];
+char			entityTag[64];
+struct stat		fileStatus;
+long			fileSize;
+long			firstByte;
+long			lastByte;
+long			bytesLeft;
+int				rangeType;
 
 //	CONSOLE_DEBUG_W_STR("Sending file:", fileName);
 	totalBytesWritten	=	0;
@@ -2887,22 +2881,103 @@ char			dataBuffer[1600];
 	if (filePointer != NULL)
 	{
 //		CONSOLE_DEBUG_W_STR("File is open:", fileName);
-		keepGoing			=	true;
+		fileSize	=	-1;
+		firstByte	=	0;
+		if (fstat(fileno(filePointer), &fileStatus) == 0)
+		{
+			fileSize	=	fileStatus.st_size;
+		}
+		lastByte	=	fileSize - 1;
+		if ((contentType != NULL) && (fileSize >= 0))
+		{
+			sprintf(entityTag, "\"%lx-%lx\"", (long)fileStatus.st_mtime, fileSize);
+			rangeType	=	kHTTPrange_None;
+			if (htmlData != NULL)
+			{
+				rangeType	=	HTTP_GetRange(htmlData, entityTag, fileSize, &firstByte, &lastByte);
+			}
+			switch(rangeType)
+			{
+				case kHTTPrange_Partial:
+					strcpy(httpHeader,	"HTTP/1.0 206 Partial Content\r\n");
+					sprintf(lineBuff,	"Content-Range: bytes %ld-%ld/%ld\r\n", firstByte, lastByte, fileSize);
+					strcat(httpHeader,	lineBuff);
+					break;
+
+				case kHTTPrange_NotSatisfiable:
+					strcpy(httpHeader,	"HTTP/1.0 416 Range Not Satisfiable\r\n");
+					sprintf(lineBuff,	"Content-Range: bytes */%ld\r\n", fileSize);
+					strcat(httpHeader,	lineBuff);
+					firstByte	=	0;
+					lastByte	=	-1;
+					break;
+
+				default:
+					strcpy(httpHeader,	"HTTP/1.0 200 ok\r\n");
+					firstByte	=	0;
+					lastByte	=	fileSize - 1;
+					break;
+			}
+			strcat(httpHeader,	"Mime-Version: 1.0\r\n");
+			sprintf(lineBuff,	"Content-Type: %s\r\n", contentType);
+			strcat(httpHeader,	lineBuff);
+			sprintf(lineBuff,	"Content-Length: %ld\r\n", ((lastByte - firstByte) + 1));
+			strcat(httpHeader,	lineBuff);
+			strcat(httpHeader,	"Accept-Ranges: bytes\r\n");
+			sprintf(lineBuff,	"ETag: %s\r\n", entityTag);
+			strcat(httpHeader,	lineBuff);
+			strcat(httpHeader,	"Connection: close\r\n");
+			strcat(httpHeader,	"\r\n");
+			SocketWriteData(socket,	httpHeader);
+
+			if (firstByte > 0)
+			{
+				fseek(filePointer, firstByte, SEEK_SET);
+			}
+		}
+		else if (contentType != NULL)
+		{
+			sprintf(httpHeader,	"HTTP/1.0 200 ok\r\n"
+								"Mime-Version: 1.0\r\n"
+								"Content-Type: %s\r\n"
+								"Connection: close\r\n"
+								"\r\n",
+								contentType);
+			SocketWriteData(socket,	httpHeader);
+		}
+		//*	-1 if the size is not known, send all of it
+		bytesLeft			=	(lastByte - firstByte) + 1;
+		keepGoing			=	(bytesLeft != 0);
 		while (keepGoing)
 		{
-			numRead	=	fread(dataBuffer, 1, 1500, filePointer);
-			if ((numRead > 0) || (feof(filePointer)))
+			numRead	=	1500;
+			if ((fileSize >= 0) && (bytesLeft < numRead))
+			{
+				numRead	=	bytesLeft;
+			}
+			numRead	=	fread(dataBuffer, 1, numRead, filePointer);
+			if (numRead > 0)
 			{
 //				CONSOLE_DEBUG_W_NUM("numRead=", numRead);
 				bytesWritten		=	write(socket, dataBuffer, numRead);
-				totalBytesWritten	+=	bytesWritten;
+				if (bytesWritten != numRead)
+				{
+					//*	the client went away, no point in sending the rest
+					CONSOLE_DEBUG("Write error");
+					keepGoing	=	false;
+				}
+				if (bytesWritten > 0)
+				{
+					totalBytesWritten	+=	bytesWritten;
+					bytesLeft			-=	bytesWritten;
+				}
 			}
 			else
 			{
 				keepGoing	=	false;
 			}
 
-			if (feof(filePointer))
+			if (feof(filePointer) || ((fileSize >= 0) && (bytesLeft <= 0)))
 			{
 				keepGoing	=	false;
 			}
@@ -2914,6 +2989,13 @@ char			dataBuffer[1600];
 	else
 	{
 		CONSOLE_DEBUG("Failed to open file");
+		if (contentType != NULL)
+		{
+			SocketWriteData(socket,	"HTTP/1.0 404 Not Found\r\n"
+									"Content-Length: 0\r\n"
+									"Connection: close\r\n"
+									"\r\n");
+		}
 	}
 	return(totalBytesWritten);
 }
@@ -2933,7 +3015,9 @@ int		iii;
 }
 
 //*****************************************************************************
-static void	SendJpegResponse(int socket, const char *jpegFileName)
+//*	htmlData is the request, it is checked for a "Range:" header
+//*****************************************************************************
+static void	SendJpegResponse(int socket, const char *jpegFileName, const char *htmlData)
 {
 int				totalBytesWritten;
 char			myJpegFileName[256];
@@ -2941,19 +3025,10 @@ char			altJpegFileName[256];
 char			*myFilenamePtr;
 struct stat		fileStatus;
 int				returnCode;
+const char		*contentType;
 
 //	CONSOLE_DEBUG(__FUNCTION__);
 
-	if (strcasestr(jpegFileName, ".png") != NULL)
-	{
-//		CONSOLE_DEBUG("Sending PNG file!!!!!!!!!!!!!!");
-		SocketWriteData(socket,	gHTML_HeaderPNG);
-	}
-	else
-	{
-//		CONSOLE_DEBUG("Sending JPEG file!!!!!!!!!!!!!!");
-		SocketWriteData(socket,	gHTML_HeaderJpeg);
-	}
 	if (jpegFileName != NULL)
 	{
 //		CONSOLE_DEBUG_W_STR("jpegFileName\t=", jpegFileName);
@@ -3000,7 +3075,17 @@ int				returnCode;
 		strcpy(myJpegFileName, "image.jpg");
 	}
 //	CONSOLE_DEBUG_W_STR("myJpegFileName=", myJpegFileName);
-	totalBytesWritten	=	SendFileToSocket(socket, myJpegFileName);
+	if (strcasestr(myJpegFileName, ".png") != NULL)
+	{
+//		CONSOLE_DEBUG("Sending PNG file!!!!!!!!!!!!!!");
+		contentType	=	"image/png";
+	}
+	else
+	{
+//		CONSOLE_DEBUG("Sending JPEG file!!!!!!!!!!!!!!");
+		contentType	=	"image/jpeg";
+	}
+	totalBytesWritten	=	SendFileToSocket(socket, myJpegFileName, contentType, htmlData);
 	if (totalBytesWritten <= 0)
 	{
 		CONSOLE_DEBUG_W_STR("Failed to send file:", myJpegFileName);
@@ -4092,25 +4177,25 @@ int	iii;
 			if (strncasecmp(parseChrPtr,	"/favicon.ico", 12) == 0)
 			{
 //				CONSOLE_DEBUG("favicon.ico");
-				SendJpegResponse(socket, "favicon.ico");
+				SendJpegResponse(socket, "favicon.ico", htmlData);
 			}
 			//-------------------------------------------------------------------
 			else if (strncasecmp(parseChrPtr,	"/image.jpg", 10) == 0)
 			{
 //				CONSOLE_DEBUG("image.jpg");
-				SendJpegResponse(socket, NULL);
+				SendJpegResponse(socket, NULL, htmlData);
 			}
 			//-------------------------------------------------------------------
 			else if (strstr(parseChrPtr, ".jpg") != NULL)
 			{
 //				CONSOLE_DEBUG(".....jpg");
-				SendJpegResponse(socket, parseChrPtr);
+				SendJpegResponse(socket, parseChrPtr, htmlData);
 			}
 			//-------------------------------------------------------------------
 			else if (strstr(parseChrPtr, ".png") != NULL)
 			{
 //				CONSOLE_DEBUG(".....png");
-				SendJpegResponse(socket, parseChrPtr);
+				SendJpegResponse(socket, parseChrPtr, htmlData);
 			}
 			else
 			{
@@ -4270,12 +4355,17 @@ static void	PrintHelp(const char *appName)
 	printf("\t%-20s\t%s\r\n",	"-g...",			"GPS support not enabled in this build");
 #endif
 	printf("\t%-20s\t%s\r\n",	"-h",				"This help message");
+	printf("\t%-20s\t%s\r\n",	"-k",				"Keep camera frame buffers in RAM (mlock)");
 	printf("\t%-20s\t%s\r\n",	"-l",				"Live mode");
+#ifdef _ENABLE_CAMERA_SIMULATOR_
+	printf("\t%-20s\t%s\r\n",	"-m <count>",		"Number of simulator cameras (default 1)");
+#endif
 	printf("\t%-20s\t%s\r\n",	"-p <port>",		"what port to use (default 6800)");
 	printf("\t%-20s\t%s\r\n",	"-q",				"quiet (less console messages)");
 	printf("\t%-20s\t%s\r\n",	"-s",				"Simulate camera image");
 	printf("\t%-20s\t%s\r\n",	"-t <profile>",		"Which telescope profile to use");
 	printf("\t%-20s\t%s\r\n",	"-v",				"verbose (more console messages default)");
+	printf("\t%-20s\t%s\r\n",	"-w",				"Wide imagebytes (Int32) for legacy clients");
 }
 
 #ifdef _ENABLE_GLOBAL_GPS_
@@ -4345,6 +4435,11 @@ int		newListenPort;
 					exit(0);	//*	help message
 					break;
 
+				//	"-k" means keep the camera frame buffers in RAM (mlock)
+				case 'k':
+					gLockFrameBuffers	=	true;
+					break;
+
 				//	"-l" means live view
 				case 'l':
 				#ifdef _USE_OPENCV_
@@ -4354,6 +4449,22 @@ int		newListenPort;
 				#endif
 					break;
 
+		#ifdef _ENABLE_CAMERA_SIMULATOR_
+				//	-m specifies the number of simulator cameras
+				case 'm':
+					if (argc > (iii+1))
+					{
+						iii++;
+						gSimCameraCount	=	atoi(argv[iii]);
+						if ((gSimCameraCount < 1) || (gSimCameraCount > 8))
+						{
+							CONSOLE_DEBUG("Simulator camera count must be 1 to 8");
+							gSimCameraCount	=	1;
+						}
+					}
+					break;
+		#endif
+
 				//	-p specifies a port
 				case 'p':
 					iii++;
@@ -4402,6 +4513,11 @@ int		newListenPort;
 				case 'v':
 					gVerbose	=	true;
 					break;
+
+				//	"-w" means wide imagebytes element types for legacy clients
+				case 'w':
+					gImageBytesLegacy	=	true;
+					break;
 			}
 		}
 	}
@@ -5509,17 +5625,17 @@ int			returnCode;
 			CONSOLE_DEBUG_W_STR("fileExtension\t=", fileExtension);
 			if (strcasecmp(fileExtension, ".jpg") == 0)
 			{
-				SendJpegResponse(mySocketFD, filePath);
+				SendJpegResponse(mySocketFD, filePath, reqData->htmlData);
 			}
 			else if (strcasecmp(fileExtension, ".png") == 0)
 			{
-				SendJpegResponse(mySocketFD, filePath);
+				SendJpegResponse(mySocketFD, filePath, reqData->htmlData);
 			}
 			else
 			{
 				//*	send the file to the socket
 				SocketWriteData(mySocketFD,	gHtmlHeader);
-				SendFileToSocket(mySocketFD, filePath);
+				SendFileToSocket(mySocketFD, filePath, NULL, NULL);
 			}
 		}
 		else
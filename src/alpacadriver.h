@@ -31,6 +31,9 @@
 //*	Sep  2,	2021	<MLS> Added _ENABLE_BANDWIDTH_LOGGING_
 //*	Nov 28,	2022	<MLS> Added cLastDeviceErrMsg
 //*	Sep 20,	2023	<MLS> Moved camera read thread to base class
+//*	Oct 19,	2026	<MLS> Added gSimCameraCount
+//*	Oct 19,	2026	<MLS> Added gImageBytesLegacy
+//*	Oct 19,	2026	<MLS> Added gLockFrameBuffers
 //*****************************************************************************
 //#include	"alpacadriver.h"
 
@@ -407,6 +410,9 @@ extern	bool			gLiveView;
 extern	bool			gAutoExposure;
 extern	bool			gDisplayImage;
 extern	bool			gSimulateCameraImage;
+extern	int				gSimCameraCount;
+extern	bool			gImageBytesLegacy;
+extern	bool			gLockFrameBuffers;
 extern	bool			gVerbose;
 extern	bool			gDebugDiscovery;
 extern	bool			gObservatorySettingsOK;
@@ -14,10 +14,15 @@
 //*	Mar  9,	2023	<MLS> Added GetDomeShutterStatusString()
 //*	Jun 18,	2023	<MLS> Added LookupStringInTable()
 //*	Jul 16,	2023	<MLS> Added DumpCoverCalibProp()
+//*	Oct 19,	2026	<MLS> Added Packed12/14 to GetBinaryElementTypeString()
+//*	Oct 19,	2026	<MLS> Added HTTP_GetRange()
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_ALPACADRIVER_HELPER_MAIN_ for HTTP_GetRange()
 //*****************************************************************************
 
 #include	<string.h>
 #include	<stdio.h>
+#include	<stdlib.h>
+#include	<ctype.h>
 
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
@@ -202,6 +207,8 @@ void	GetBinaryElementTypeString(const int elementType, char *typeString)
 		case kAlpacaImageData_Byte:		strcpy(typeString,	"Byte");	break;
 		case kAlpacaImageData_Int64:	strcpy(typeString,	"Int64");	break;
 		case kAlpacaImageData_UInt16:	strcpy(typeString,	"UInt16");	break;
+		case kAlpacaImageData_Packed12:	strcpy(typeString,	"Packed12");	break;
+		case kAlpacaImageData_Packed14:	strcpy(typeString,	"Packed14");	break;
 		default:						strcpy(typeString,	"Unknown");	break;
 	}
 }
@@ -256,3 +263,223 @@ char	titleLine[128];
 	CONSOLE_DEBUG_W_DBL(	"coverCalibProp->Aperture        \t=",	coverCalibProp->Aperture);
 	CONSOLE_DEBUG_W_BOOL(	"coverCalibProp->CanSetAperture  \t=",	coverCalibProp->CanSetAperture);
 }
+
+//*****************************************************************************
+//*	looks for a "Range: bytes=" header line in the request (RFC 7233)
+//*	only a single range is supported, anything else gets the whole thing
+//*		bytes=first-last
+//*		bytes=first-
+//*		bytes=-suffixLength
+//*	If there is an "If-Range:" line, it has to match entityTag,
+//*	if it does not, the data has changed and the whole thing has to be sent
+//*****************************************************************************
+int	HTTP_GetRange(	const char	*htmlData,
+					const char	*entityTag,
+					const long	totalLength,
+					long		*firstByte,
+					long		*lastByte)
+{
+const char	*rangePtr;
+const char	*ifRangePtr;
+char		*endPtr;
+char		ifRangeValue[80];
+int			ccc;
+long		suffixLength;
+
+	*firstByte	=	0;
+	*lastByte	=	totalLength - 1;
+
+	rangePtr	=	strcasestr(htmlData, "\nRange:");
+	if (rangePtr == NULL)
+	{
+		return(kHTTPrange_None);
+	}
+
+	ifRangePtr	=	strcasestr(htmlData, "\nIf-Range:");
+	if (ifRangePtr != NULL)
+	{
+		ifRangePtr	+=	10;
+		while (*ifRangePtr == 0x20)
+		{
+			ifRangePtr++;
+		}
+		ccc	=	0;
+		while ((ifRangePtr[ccc] >= 0x20) && (ccc < ((int)sizeof(ifRangeValue) - 1)))
+		{
+			ifRangeValue[ccc]	=	ifRangePtr[ccc];
+			ccc++;
+		}
+		while ((ccc > 0) && (ifRangeValue[ccc - 1] == 0x20))
+		{
+			ccc--;
+		}
+		ifRangeValue[ccc]	=	0;
+		if ((entityTag == NULL) || (strcmp(ifRangeValue, entityTag) != 0))
+		{
+			return(kHTTPrange_None);
+		}
+	}
+
+	rangePtr	+=	7;
+	while (*rangePtr == 0x20)
+	{
+		rangePtr++;
+	}
+	if (strncasecmp(rangePtr, "bytes=", 6) != 0)
+	{
+		return(kHTTPrange_None);
+	}
+	rangePtr	+=	6;
+
+	//*	multiple ranges are not supported
+	for (ccc = 0; rangePtr[ccc] >= 0x20; ccc++)
+	{
+		if (rangePtr[ccc] == ',')
+		{
+			return(kHTTPrange_None);
+		}
+	}
+
+	if (*rangePtr == '-')
+	{
+		suffixLength	=	strtol(rangePtr + 1, &endPtr, 10);
+		if ((endPtr == (rangePtr + 1)) || (suffixLength < 0))
+		{
+			return(kHTTPrange_None);
+		}
+		if ((suffixLength == 0) || (totalLength <= 0))
+		{
+			return(kHTTPrange_NotSatisfiable);
+		}
+		if (suffixLength > totalLength)
+		{
+			suffixLength	=	totalLength;
+		}
+		*firstByte	=	totalLength - suffixLength;
+	}
+	else if (isdigit(*rangePtr))
+	{
+		*firstByte	=	strtol(rangePtr, &endPtr, 10);
+		if (*endPtr != '-')
+		{
+			//*	kHTTPrange_None always comes back with the whole thing
+			*firstByte	=	0;
+			return(kHTTPrange_None);
+		}
+		endPtr++;
+		if (isdigit(*endPtr))
+		{
+			*lastByte	=	strtol(endPtr, NULL, 10);
+			if (*lastByte < *firstByte)
+			{
+				*firstByte	=	0;
+				*lastByte	=	totalLength - 1;
+				return(kHTTPrange_None);
+			}
+			if (*lastByte >= totalLength)
+			{
+				*lastByte	=	totalLength - 1;
+			}
+		}
+		if (*firstByte >= totalLength)
+		{
+			return(kHTTPrange_NotSatisfiable);
+		}
+	}
+	else
+	{
+		return(kHTTPrange_None);
+	}
+	return(kHTTPrange_Partial);
+}
+
+#ifdef _INCLUDE_ALPACADRIVER_HELPER_MAIN_
+//*****************************************************************************
+//*	HTTP_GetRange() self test
+//*	make rangetest
+//*****************************************************************************
+typedef struct
+{
+	const char	*headerLines;
+	long		totalLength;
+	int			rangeType;
+	long		firstByte;
+	long		lastByte;
+} TYPE_RANGE_TEST;
+
+#define	kTestETag	"\"5a3f-18c2-0\""
+
+//*****************************************************************************
+static TYPE_RANGE_TEST	gRangeTests[]	=
+{
+	{	"Host: camera\r\n",											1000,	kHTTPrange_None,			0,		999	},
+	{	"Range: bytes=0-499\r\n",									1000,	kHTTPrange_Partial,			0,		499	},
+	{	"Range: bytes=500-\r\n",									1000,	kHTTPrange_Partial,			500,	999	},
+	{	"Range: bytes=-100\r\n",									1000,	kHTTPrange_Partial,			900,	999	},
+	{	"Range: bytes=-2000\r\n",									1000,	kHTTPrange_Partial,			0,		999	},
+	{	"Range: bytes=900-5000\r\n",								1000,	kHTTPrange_Partial,			900,	999	},
+	{	"Range: bytes=999-999\r\n",									1000,	kHTTPrange_Partial,			999,	999	},
+	{	"range:   BYTES=10-19  \r\n",								1000,	kHTTPrange_Partial,			10,		19	},
+	{	"Range: bytes=-0\r\n",										1000,	kHTTPrange_NotSatisfiable,	-1,		-1	},
+	{	"Range: bytes=1000-\r\n",									1000,	kHTTPrange_NotSatisfiable,	-1,		-1	},
+	{	"Range: bytes=1000-1500\r\n",								1000,	kHTTPrange_NotSatisfiable,	-1,		-1	},
+	{	"Range: bytes=0-\r\n",										0,		kHTTPrange_NotSatisfiable,	-1,		-1	},
+	{	"Range: bytes=500-400\r\n",									1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: bytes=0-1,5-9\r\n",									1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: items=0-9\r\n",										1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: bytes=abc\r\n",										1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: bytes=10\r\n",										1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: bytes=100-\r\nIf-Range: " kTestETag "\r\n",			1000,	kHTTPrange_Partial,			100,	999	},
+	{	"If-Range:  " kTestETag " \r\nRange: bytes=100-199\r\n",	1000,	kHTTPrange_Partial,			100,	199	},
+	{	"Range: bytes=100-\r\nIf-Range: \"5a3f-18c2-1\"\r\n",		1000,	kHTTPrange_None,			-1,		-1	},
+	{	"Range: bytes=100-\r\nIf-Range: Wed, 21 Oct 2026\r\n",		1000,	kHTTPrange_None,			-1,		-1	},
+	{	NULL,														0,		0,							0,		0	}
+};
+
+//*****************************************************************************
+int	main(void)
+{
+char	htmlData[512];
+long	firstByte;
+long	lastByte;
+int		rangeType;
+int		iii;
+int		errorCnt;
+bool	passed;
+
+	errorCnt	=	0;
+	iii			=	0;
+	while (gRangeTests[iii].headerLines != NULL)
+	{
+		snprintf(htmlData, sizeof(htmlData),
+					"GET /api/v1/camera/0/imagearray HTTP/1.1\r\n%s\r\n",
+					gRangeTests[iii].headerLines);
+		rangeType	=	HTTP_GetRange(	htmlData,
+										kTestETag,
+										gRangeTests[iii].totalLength,
+										&firstByte,
+										&lastByte);
+		passed		=	(rangeType == gRangeTests[iii].rangeType);
+		//*	the byte range only matters when it is going to be used
+		if (passed && (rangeType != kHTTPrange_NotSatisfiable) && (gRangeTests[iii].firstByte >= 0))
+		{
+			passed	=	(firstByte == gRangeTests[iii].firstByte) && (lastByte == gRangeTests[iii].lastByte);
+		}
+		if (rangeType == kHTTPrange_None)
+		{
+			passed	=	passed && (firstByte == 0) && (lastByte == (gRangeTests[iii].totalLength - 1));
+		}
+		if (passed == false)
+		{
+			printf("%-45.45s got %d %ld-%ld, expected %d %ld-%ld\r\n",
+						gRangeTests[iii].headerLines,
+						rangeType, firstByte, lastByte,
+						gRangeTests[iii].rangeType, gRangeTests[iii].firstByte, gRangeTests[iii].lastByte);
+			errorCnt++;
+		}
+		iii++;
+	}
+	printf("HTTP_GetRange() %d cases\t\t%s\r\n", iii, ((errorCnt == 0) ? "OK" : "FAILED"));
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_ALPACADRIVER_HELPER_MAIN_
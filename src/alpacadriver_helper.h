@@ -98,6 +98,19 @@ extern	char		gWebTitle[];
 int	LookupStringInTable(const char *lookupString, TYPE_LookupTable *lookupTable);
 int	LookupStringInCmdTable(const char *lookupString, TYPE_CmdEntry *commandTable);
 
+//*	HTTP range requests, return values from HTTP_GetRange()
+enum
+{
+	kHTTPrange_None	=	0,		//*	no range (or not usable), send everything with 200
+	kHTTPrange_Partial,			//*	send firstByte thru lastByte with 206
+	kHTTPrange_NotSatisfiable	//*	send 416
+};
+int	HTTP_GetRange(	const char	*htmlData,
+					const char	*entityTag,
+					const long	totalLength,
+					long		*firstByte,
+					long		*lastByte);
+
 #define	DEGREES_F(x)	((x * (9.0/5.0) ) + 32.0)
 
 
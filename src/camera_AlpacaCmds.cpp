@@ -3,6 +3,22 @@
 //*		This file is used by both the driver and the controller
 //*****************************************************************************
 //*	Jul  1,	2023	<MLS> Created camera_AlpacaCmds.cpp
+//*	Oct 19,	2026	<MLS> Added livestack & stackedimage
+//*	Oct 19,	2026	<MLS> Added calibration & buildcalibmaster
+//*	Oct 19,	2026	<MLS> Added hotpixels & buildhotpixelmap
+//*	Oct 19,	2026	<MLS> Added staranalysis
+//*	Oct 19,	2026	<MLS> Added autofocus
+//*	Oct 19,	2026	<MLS> Added platesolve
+//*	Oct 19,	2026	<MLS> Added demosaic
+//*	Oct 19,	2026	<MLS> Added imageencode
+//*	Oct 19,	2026	<MLS> Added simulator
+//*	Oct 19,	2026	<MLS> Added overlay
+//*	Oct 19,	2026	<MLS> Added pipelinetiming
+//*	Oct 19,	2026	<MLS> Added imageindex
+//*	Oct 19,	2026	<MLS> Added softbinning
+//*	Oct 19,	2026	<MLS> Added preview
+//*	Oct 19,	2026	<MLS> Added imagestats
+//*	Oct 19,	2026	<MLS> Added mjpeg
 //*****************************************************************************
 
 
@@ -83,6 +99,11 @@ TYPE_CmdEntry	gCameraCmdTable[]	=
 
 
 	{	"autoexposure",				kCmd_Camera_autoexposure,			kCmdType_BOTH	},
+	{	"autofocus",				kCmd_Camera_autofocus,				kCmdType_BOTH	},
+	{	"buildcalibmaster",			kCmd_Camera_buildcalibmaster,		kCmdType_BOTH	},
+	{	"buildhotpixelmap",			kCmd_Camera_buildhotpixelmap,		kCmdType_PUT	},
+	{	"calibration",				kCmd_Camera_calibration,			kCmdType_BOTH	},
+	{	"demosaic",					kCmd_Camera_demosaic,				kCmdType_BOTH	},
 	{	"displayimage",				kCmd_Camera_displayimage,			kCmdType_BOTH	},
 	{	"exposuretime",				kCmd_Camera_ExposureTime,			kCmdType_BOTH	},
 #ifdef _ENABLE_FITS_
@@ -92,7 +113,17 @@ TYPE_CmdEntry	gCameraCmdTable[]	=
 	{	"filenameoptions",			kCmd_Camera_filenameoptions,		kCmdType_PUT	},
 	{	"flip",						kCmd_Camera_flip,					kCmdType_BOTH	},
 	{	"framerate",				kCmd_Camera_framerate,				kCmdType_GET	},
+	{	"hotpixels",				kCmd_Camera_hotpixels,				kCmdType_BOTH	},
+	{	"imageencode",				kCmd_Camera_imageencode,			kCmdType_BOTH	},
+	{	"imageindex",				kCmd_Camera_imageindex,				kCmdType_GET	},
+	{	"imagestats",				kCmd_Camera_imagestats,				kCmdType_GET	},
 	{	"livemode",					kCmd_Camera_livemode,				kCmdType_BOTH	},
+	{	"livestack",				kCmd_Camera_livestack,				kCmdType_BOTH	},
+	{	"mjpeg",					kCmd_Camera_mjpeg,					kCmdType_GET	},
+	{	"overlay",					kCmd_Camera_overlay,				kCmdType_BOTH	},
+	{	"pipelinetiming",			kCmd_Camera_pipelinetiming,			kCmdType_BOTH	},
+	{	"platesolve",				kCmd_Camera_platesolve,				kCmdType_BOTH	},
+	{	"preview",					kCmd_Camera_preview,				kCmdType_GET	},
 	{	"rgbarray",					kCmd_Camera_rgbarray,				kCmdType_GET	},
 	{	"saveallimages",			kCmd_Camera_saveallimages,			kCmdType_BOTH	},
 
@@ -104,6 +135,10 @@ TYPE_CmdEntry	gCameraCmdTable[]	=
 	{	"savedimages",				kCmd_Camera_savedimages,			kCmdType_GET	},
 	{	"savenextimage",			kCmd_Camera_savenextimage,			kCmdType_PUT	},
 	{	"settelescopeinfo",			kCmd_Camera_settelescopeinfo,		kCmdType_PUT	},
+	{	"simulator",				kCmd_Camera_simulator,				kCmdType_BOTH	},
+	{	"softbinning",				kCmd_Camera_softbinning,			kCmdType_BOTH	},
+	{	"stackedimage",				kCmd_Camera_stackedimage,			kCmdType_GET	},
+	{	"staranalysis",				kCmd_Camera_staranalysis,			kCmdType_BOTH	},
 	{	"startsequence",			kCmd_Camera_startsequence,			kCmdType_PUT	},
 	{	"startvideo",				kCmd_Camera_startvideo,				kCmdType_PUT	},
 	{	"stopvideo",				kCmd_Camera_stopvideo,				kCmdType_PUT	},
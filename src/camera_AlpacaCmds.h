@@ -2,6 +2,21 @@
 //*	camera_AlpacaCmds.h
 //*****************************************************************************
 //*	Jun 30,	2023	<MLS> Created camera_AlpacaCmds.h
+//*	Oct 19,	2026	<MLS> Added livestack & stackedimage
+//*	Oct 19,	2026	<MLS> Added calibration & buildcalibmaster
+//*	Oct 19,	2026	<MLS> Added hotpixels & buildhotpixelmap
+//*	Oct 19,	2026	<MLS> Added staranalysis
+//*	Oct 19,	2026	<MLS> Added autofocus
+//*	Oct 19,	2026	<MLS> Added platesolve
+//*	Oct 19,	2026	<MLS> Added demosaic
+//*	Oct 19,	2026	<MLS> Added imageencode
+//*	Oct 19,	2026	<MLS> Added simulator
+//*	Oct 19,	2026	<MLS> Added overlay
+//*	Oct 19,	2026	<MLS> Added pipelinetiming
+//*	Oct 19,	2026	<MLS> Added imageindex
+//*	Oct 19,	2026	<MLS> Added softbinning
+//*	Oct 19,	2026	<MLS> Added preview
+//*	Oct 19,	2026	<MLS> Added imagestats
 //*****************************************************************************
 //#include	"camera_AlpacaCmds.h"
 
@@ -103,6 +118,11 @@ enum
 
 
 	kCmd_Camera_autoexposure,
+	kCmd_Camera_autofocus,
+	kCmd_Camera_buildcalibmaster,
+	kCmd_Camera_buildhotpixelmap,
+	kCmd_Camera_calibration,
+	kCmd_Camera_demosaic,
 	kCmd_Camera_displayimage,
 
 	kCmd_Camera_ExposureTime,
@@ -111,7 +131,17 @@ enum
 	kCmd_Camera_fitsheader,
 	kCmd_Camera_flip,
 	kCmd_Camera_framerate,
+	kCmd_Camera_hotpixels,
+	kCmd_Camera_imageencode,
+	kCmd_Camera_imageindex,
+	kCmd_Camera_imagestats,
 	kCmd_Camera_livemode,
+	kCmd_Camera_livestack,
+	kCmd_Camera_mjpeg,
+	kCmd_Camera_overlay,
+	kCmd_Camera_pipelinetiming,
+	kCmd_Camera_platesolve,
+	kCmd_Camera_preview,
 	kCmd_Camera_rgbarray,
 	kCmd_Camera_settelescopeinfo,
 	kCmd_Camera_saveallimages,
@@ -121,6 +151,10 @@ enum
 	kCmd_Camera_saveasRAW,
 	kCmd_Camera_savedimages,
 	kCmd_Camera_savenextimage,
+	kCmd_Camera_simulator,
+	kCmd_Camera_softbinning,
+	kCmd_Camera_stackedimage,
+	kCmd_Camera_staranalysis,
 	kCmd_Camera_startsequence,
 	kCmd_Camera_startvideo,
 	kCmd_Camera_stopvideo,
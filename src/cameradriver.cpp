@@ -208,6 +208,40 @@
 //*	Sep  9,	2023	<MLS> Added _USE_CAMERA_READ_THREAD_
 //*	Mar 25,	2024	<MLS> Read NASA Moon Phase on creation of camera objects
 //*	Apr 19,	2024	<MLS> Added check for flip enabled to Put_Flip()
+//*	Oct 19,	2026	<MLS> Added livestack and stackedimage commands
+//*	Oct 19,	2026	<MLS> Added calibration and buildcalibmaster commands
+//*	Oct 19,	2026	<MLS> Added hotpixels and buildhotpixelmap commands
+//*	Oct 19,	2026	<MLS> Added staranalysis command
+//*	Oct 19,	2026	<MLS> Added autofocus command
+//*	Oct 19,	2026	<MLS> Added platesolve command
+//*	Oct 19,	2026	<MLS> Added demosaic command
+//*	Oct 19,	2026	<MLS> Added imageencode command
+//*	Oct 19,	2026	<MLS> Added simulator command
+//*	Oct 19,	2026	<MLS> Added overlay command
+//*	Oct 19,	2026	<MLS> Live window now uses a display pyramid
+//*	Oct 19,	2026	<MLS> Added pipelinetiming command and per stage timing of each frame
+//*	Oct 19,	2026	<MLS> Get_Filelist() now uses an inotify maintained index with start/count/filter
+//*	Oct 19,	2026	<MLS> Added imageindex command (metadata index of the saved images)
+//*	Oct 19,	2026	<MLS> Added packed 12/14 bit imagebytes for RAW16 (application/imagebytes-packed)
+//*	Oct 19,	2026	<MLS> imagebytes uses the narrowest element type for all clients, -w for Int32
+//*	Oct 19,	2026	<MLS> Fixed BuildBinaryImage_RGB24_32bit() offset and scaling
+//*	Oct 19,	2026	<MLS> AllocateImageBuffer() now uses FrameAlloc_Allocate() (mmap, huge pages, mlock)
+//*	Oct 19,	2026	<MLS> Added softbinning command, software BinX/BinY and sub frames for full frame cameras
+//*	Oct 19,	2026	<MLS> Added preview command, downscaled and stretched JPEG/PNG/raw of the current frame
+//*	Oct 19,	2026	<MLS> Added imagestats command, full resolution statistics and histogram
+//*	Oct 19,	2026	<MLS> imagearray responses are cached per frame and format and shared by all clients
+//*	Oct 19,	2026	<MLS> Added mjpeg command, multipart JPEG live stream
+//*	Oct 19,	2026	<MLS> imagebytes can be sent compressed if the client asks for imagebytes-deflate
+//*	Oct 19,	2026	<MLS> imagebytes responses support Range requests, the ETag pins the frame
+//*	Oct 19,	2026	<MLS> Cache entries are released after they are sent, stored with the frame number
+//*	Oct 19,	2026	<MLS> An interrupted imagebytes download can be resumed after the next frame
+//*	Oct 19,	2026	<MLS> Frame processing holds cLiveStackMutex
+//*	Oct 19,	2026	<MLS> imageindex returns InvalidOperation for PUT
+//*	Oct 19,	2026	<MLS> ImageReady is set after the frame is processed, added cFramesProcessed
+//*	Oct 19,	2026	<MLS> Autofocus frames are not saved, stacked or added to a master
+//*	Oct 19,	2026	<MLS> StartExposure returns InvalidOperation while autofocus is running
+//*	Oct 19,	2026	<MLS> cLiveStackMutex is only held while a frame is added to the stack
+//*	Oct 19,	2026	<MLS> Added BuildImageBytesResponse() for images that are not the current frame
 //*****************************************************************************
 //*	Jan  1,	2119	<TODO> ----------------------------------------
 //*	Jun 26,	2119	<TODO> Add support for sub frames
@@ -262,6 +296,8 @@
 #include	"JsonResponse.h"
 #include	"eventlogging.h"
 #include	"helper_functions.h"
+#include	"image_kernels.h"
+#include	"file_index.h"
 
 #include	"alpaca_defs.h"
 #include	"cpu_stats.h"
@@ -424,6 +460,7 @@ CameraDriver::CameraDriver(void)
 	:AlpacaDriver(kDeviceType_Camera)
 {
 int	mkdirErrCode;
+int	iii;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 
@@ -505,11 +542,13 @@ int	mkdirErrCode;
 	cVideoDuration_secs				=	0;
 	cTotalFramesSaved				=	0;
 	cFramesRead						=	0;
+	cFramesProcessed				=	0;
 	cFrameRate						=	0.0;
 	//*	init the data buffers to nothing
 	cInternalCameraState			=	kCameraState_Idle;
 	cCameraDataBuffer				=	NULL;
 	cCameraBGRbuffer				=	NULL;
+	memset((void *)&cCameraDataAlloc, 0, sizeof(TYPE_FRAME_BUFFER));
 
 	cCameraDataBuffLen				=	0;
 	cAutoAdjustExposure				=	gAutoExposure;
@@ -530,6 +569,12 @@ int	mkdirErrCode;
 	cCreateOpenCVwindow				=	true;
 	cOpenCV_ImagePtr				=	NULL;
 	cOpenCV_LiveDisplayPtr			=	NULL;
+#if !defined(_USE_OPENCV_CPP_) && (CV_MAJOR_VERSION < 4)
+	cOpenCV_LiveSmallPtr			=	NULL;
+#endif
+	memset(cDisplayPyramid, 0, sizeof(cDisplayPyramid));
+	cDisplayPyramidLevel			=	0;
+	cSideBarValid					=	false;
 	cOpenCV_Histogram				=	NULL;
 	cCreateHistogramWindow			=	true;
 	cOpenCV_videoWriter				=	NULL;
@@ -664,6 +709,163 @@ int	iii;
 	cOverlayMode		=	0;		//*	0 = none
 	cOverlayPosition	=	0;
 	cOverlayColor		=	0;
+	cOverlayCacheEnabled	=	true;
+	memset(cOverlayTiles, 0, sizeof(cOverlayTiles));
+	cOverlayLast_us			=	0;
+	cOverlayDirectAvg_us	=	0;
+	cOverlayCachedAvg_us	=	0;
+	cOverlayTileRenders		=	0;
+
+#ifdef _INCLUDE_HISTOGRAM_
+	cHistogramFrame			=	-1;
+#endif
+
+	//===========================================================================
+	//*	Live stacking
+	cLiveStackEnabled		=	false;
+	cLiveStackMode			=	kLiveStack_Mean;
+	cLiveStackSigma			=	kLiveStackDefaultSigma;
+	cLiveStackElementCnt	=	0;
+	cLiveStackAllocCnt		=	0;
+	cLiveStackSum			=	NULL;
+	cLiveStackSumSq			=	NULL;
+	memset(&cLiveStackROIinfo, 0, sizeof(TYPE_IMAGE_ROI_Info));
+	pthread_mutex_init(&cLiveStackMutex, NULL);
+	LiveStack_Reset();
+
+	//===========================================================================
+	//*	Calibration
+	cCalibrationEnabled		=	false;
+	memset(cCalibMaster, 0, sizeof(cCalibMaster));
+	memset(&cCalibLookupKey, 0, sizeof(TYPE_CALIB_HEADER));
+	cCalibLastApply_ms		=	0;
+	cCalibBuildActive		=	false;
+	cCalibBuildType			=	kCalibMaster_Dark;
+	cCalibBuildFramesReq	=	0;
+	memset(&cCalibBuildHeader, 0, sizeof(TYPE_CALIB_HEADER));
+	cCalibBuildSum			=	NULL;
+	cCalibBuildAllocCnt		=	0;
+	strcpy(cCalibBuildStatus, "Idle");
+	pthread_mutex_init(&cCalibMutex, NULL);
+
+	//===========================================================================
+	//*	Hot pixel map
+	cHotPixelEnabled		=	false;
+	cHotPixelDetectPending	=	false;
+	cHotPixelSigma			=	kHotPixelDefaultSigma;
+	cHotPixelList			=	NULL;
+	cHotPixelLastCorrect_ms	=	0;
+	memset(&cHotPixelHeader, 0, sizeof(TYPE_HOTPIXEL_HEADER));
+	memset(&cHotPixelLookupKey, 0, sizeof(TYPE_HOTPIXEL_HEADER));
+
+	//===========================================================================
+	//*	Star analysis
+	cStarAnalysisEnabled	=	false;
+	cStarSigma				=	kStarAnalysis_DefaultSigma;
+	cStarResults			=	NULL;
+
+	//===========================================================================
+	//*	Autofocus
+	cAutoFocusState				=	kAutoFocus_Idle;
+	cAutoFocusFinalState		=	kAutoFocus_Idle;
+	memset(cAutoFocusSamples, 0, sizeof(cAutoFocusSamples));
+	cAutoFocusSampleCnt			=	0;
+	cAutoFocusSampleIdx			=	0;
+	cAutoFocusMeasureIdx		=	0;
+	cAutoFocusStepSize			=	100;
+	cAutoFocusBacklash			=	0;
+	cAutoFocusExposure_us		=	0;
+	cAutoFocusSavedExposure_us	=	0;
+	cAutoFocusStartPosition		=	0;
+	cAutoFocusFinalPosition		=	0;
+	cAutoFocusTarget			=	0;
+	cAutoFocusStateStart_ms		=	0;
+	cAutoFocusBestPosition		=	0;
+	cAutoFocusBestHFR			=	0.0;
+	cAutoFocusFitQuality		=	0.0;
+	strcpy(cAutoFocusStatusMsg, "Idle");
+
+	//===========================================================================
+	//*	Plate solving
+	cPlateSolveEnabled		=	false;
+	cPlateSolveScale_arcsec	=	0.0;
+	memset(&cPlateSolveResult, 0, sizeof(TYPE_PLATESOLVE_RESULT));
+
+	//===========================================================================
+	//*	Bayer demosaic
+	cDemosaicEnabled		=	false;
+	cDemosaicMethod			=	kDemosaic_Bilinear;
+	cDemosaicRGB48			=	false;
+	cDemosaicPattern		=	-1;
+	cDemosaicLast_ms		=	0;
+
+	//*	JPEG/PNG encoding
+	cImageEncodeFast		=	true;
+	ImageEncode_SetDefaults(&cImageEncodeOptions);
+	cJpegEncode_ms			=	0;
+	cPngEncode_ms			=	0;
+
+	//*	software binning, drivers that need it call SoftBin_Enable()
+	cSoftBinEnabled			=	false;
+	cSoftBinMode			=	kBinMode_Sum;
+	memset((void *)&cSoftBinPool, 0, sizeof(TYPE_FRAME_BUFFER));
+	cSoftBinLast_ms			=	0;
+
+	//*	server side preview
+	memset((void *)&cPreviewCache, 0, sizeof(TYPE_PREVIEW_CACHE));
+	cPreviewCache.frameNumber	=	-1;
+	cPreviewScratch[0]			=	NULL;
+	cPreviewScratch[1]			=	NULL;
+	cPreviewScratchSize[0]		=	0;
+	cPreviewScratchSize[1]		=	0;
+	cPreviewLast_ms				=	0;
+	cPreviewCacheHits			=	0;
+
+	//*	full resolution image statistics
+	memset((void *)&cImageStats, 0, sizeof(TYPE_IMAGE_STATS));
+	cImageStats.frameNumber		=	-1;
+
+	//*	serialized imagearray cache
+	pthread_mutex_init(&cImageCacheMutex, NULL);
+	memset((void *)cImageCache, 0, sizeof(cImageCache));
+	cImageCacheBytes			=	0;
+	cImageCacheHits				=	0;
+	cImageCacheMisses			=	0;
+	cImageRangeRequests			=	0;
+
+	//*	MJPEG live stream, the settings come from the clients
+	pthread_mutex_init(&cMJPEGmutex, NULL);
+	memset((void *)cMJPEGclients, 0, sizeof(cMJPEGclients));
+	for (iii=0; iii<kMJPEG_MaxClients; iii++)
+	{
+		cMJPEGclients[iii].socketFD	=	-1;
+	}
+	cMJPEGthreadRunning			=	false;
+	cMJPEGwakePipe[0]			=	-1;
+	cMJPEGwakePipe[1]			=	-1;
+	cMJPEGclientCnt				=	0;
+	cMJPEGframe					=	NULL;
+	cMJPEGframeSeq				=	0;
+	cMJPEGinputPending			=	false;
+	cMJPEGinputPtr				=	NULL;
+	cMJPEGscratch[0]			=	NULL;
+	cMJPEGscratch[1]			=	NULL;
+	cMJPEGscratchSize[0]		=	0;
+	cMJPEGscratchSize[1]		=	0;
+	cMJPEGmaxWidth				=	0;
+	cMJPEGstretch				=	0;
+	cMJPEGquality				=	0;
+	cMJPEGframesEncoded			=	0;
+	cMJPEGframesSkipped			=	0;
+	cMJPEGencode_ms				=	0;
+
+	//*	compressed imagebytes
+	cDeflateCount				=	0;
+	cDeflateRatio				=	0.0;
+	cDeflate_ms					=	0;
+
+	//*	capture pipeline timing
+	PipelineTiming_Reset();
 
 	//========================================
 	//*	GPS data QHY174-GPS
@@ -1576,6 +1778,226 @@ char				httpHeader[500];
 			}
 			break;
 
+		case kCmd_Camera_calibration:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_Calibration(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_Calibration(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_buildcalibmaster:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_BuildCalibMaster(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_BuildCalibMaster(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_hotpixels:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_HotPixels(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_HotPixels(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_buildhotpixelmap:
+			if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_BuildHotPixelMap(reqData, alpacaErrMsg);
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Get not allowed for buildhotpixelmap");
+			}
+			break;
+
+		case kCmd_Camera_livestack:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_LiveStack(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_LiveStack(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_mjpeg:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_MJPEGstream(reqData, alpacaErrMsg);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Put not allowed for mjpeg");
+			}
+			break;
+
+		case kCmd_Camera_staranalysis:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_StarAnalysis(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_StarAnalysis(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_autofocus:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_AutoFocus(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_AutoFocus(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_platesolve:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_PlateSolve(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_PlateSolve(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_demosaic:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_Demosaic(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_Demosaic(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_imageencode:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_ImageEncode(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_ImageEncode(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_overlay:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_Overlay(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_Overlay(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_imageindex:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_ImageIndex(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Put not allowed for imageindex");
+			}
+			break;
+
+		case kCmd_Camera_softbinning:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_SoftBinning(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_SoftBinning(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_preview:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_Preview(reqData, alpacaErrMsg);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Put not allowed for preview");
+			}
+			break;
+
+		case kCmd_Camera_imagestats:
+			if (reqData->get_putIndicator == 'G')
+			{
+				//*	the histogram can be bigger than the json buffer
+				JsonResponse_FinishHeader(httpHeader, "");
+				JsonResponse_SendTextBuffer(mySocket, httpHeader);
+				cHttpHeaderSent	=	true;
+				alpacaErrCode	=	Get_ImageStats(reqData, alpacaErrMsg);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Put not allowed for imagestats");
+			}
+			break;
+
+		case kCmd_Camera_pipelinetiming:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_PipelineTiming(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_PipelineTiming(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_simulator:
+			if (reqData->get_putIndicator == 'G')
+			{
+				alpacaErrCode	=	Get_Simulator(reqData, alpacaErrMsg, gValueString);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	Put_Simulator(reqData, alpacaErrMsg);
+			}
+			break;
+
+		case kCmd_Camera_stackedimage:
+			if (reqData->get_putIndicator == 'G')
+			{
+				cHttpHeaderSent	=	true;
+				alpacaErrCode	=	Get_StackedImage(reqData, alpacaErrMsg);
+			}
+			else if (reqData->get_putIndicator == 'P')
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Put not allowed for stackedimage");
+			}
+			break;
+
 		case kCmd_Camera_readall:
 			alpacaErrCode	=	Get_Readall(reqData, alpacaErrMsg);
 			break;
@@ -1881,8 +2303,15 @@ int					newBinValue;
 			newBinValue	=	atoi(argumentString);
 			if ((newBinValue >= 1) && (newBinValue <= cCameraProp.MaxbinX))
 			{
-			//	alpacaErrCode		=	kASCOM_Err_Success;
-				alpacaErrCode		=	Write_BinX(newBinValue);
+				if (cSoftBinEnabled)
+				{
+					//*	binned in software after the frame is read
+					alpacaErrCode		=	kASCOM_Err_Success;
+				}
+				else
+				{
+					alpacaErrCode		=	Write_BinX(newBinValue);
+				}
 				if (alpacaErrCode == kASCOM_Err_Success)
 				{
 					cCameraProp.BinX	=	newBinValue;
@@ -1934,8 +2363,15 @@ int					newBinValue;
 			newBinValue	=	atoi(argumentString);
 			if ((newBinValue >= 1) && (newBinValue <= cCameraProp.MaxbinY))
 			{
-			//	alpacaErrCode		=	kASCOM_Err_Success;
-				alpacaErrCode		=	Write_BinY(newBinValue);
+				if (cSoftBinEnabled)
+				{
+					//*	binned in software after the frame is read
+					alpacaErrCode		=	kASCOM_Err_Success;
+				}
+				else
+				{
+					alpacaErrCode		=	Write_BinY(newBinValue);
+				}
 				if (alpacaErrCode == kASCOM_Err_Success)
 				{
 					cCameraProp.BinY	=	newBinValue;
@@ -3671,7 +4107,13 @@ bool				lightFrame;
 
 
 		//*	first we are going to check a bunch of stuff to make CONFORM happy
-		if ((cCameraProp.CanAsymmetricBin == false) && (cCameraProp.BinX != cCameraProp.BinY))
+		if (AutoFocus_IsActive())
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Autofocus is running");
+			CONSOLE_DEBUG(alpacaErrMsg);
+		}
+		else if ((cCameraProp.CanAsymmetricBin == false) && (cCameraProp.BinX != cCameraProp.BinY))
 		{
 			alpacaErrCode	=	kASCOM_Err_InvalidValue;
 			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "binX and binY do not match");
@@ -3734,6 +4176,7 @@ bool				lightFrame;
 				//*	Save all of the info about this exposure for reference
 				SetLastExposureInfo();
 
+				PipelineTiming_ExposureStart();
 				alpacaErrCode				=	Start_CameraExposure(cCurrentExposure_us, lightFrame);
 				GenerateFileNameRoot();
 
@@ -4211,6 +4654,95 @@ int		pixelIndex;
 	return(ccc);
 }
 
+//*****************************************************************************
+//*	same order as BuildBinaryImage_Raw16(), column by column, but bit packed.
+//*	The columns are gathered into a small buffer that is packed in one call,
+//*	kPackChunkPixels is a multiple of 4 so the groups never cross a chunk
+//*****************************************************************************
+int	CameraDriver::BuildBinaryImage_Raw16Packed(	unsigned char 	*binaryDataBuffer,
+												int				startOffset,
+												int				bufferSize,
+												int				bitsPerPixel,
+												int				shift)
+{
+#define	kPackChunkPixels	4096
+uint16_t	pixelChunk[kPackChunkPixels];
+uint16_t	*pixelPtr;
+int			xxx;
+int			yyy;
+int			ccc;
+int			chunkCnt;
+int			imgWidth;
+int			imgHeight;
+int			groupBytes;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	ccc	=	startOffset;
+	if (cCameraDataBuffer != NULL)
+	{
+		pixelPtr	=	(uint16_t *)cCameraDataBuffer;
+		imgWidth	=	cLastExposure_ROIinfo.currentROIwidth;
+		imgHeight	=	cLastExposure_ROIinfo.currentROIheight;
+		groupBytes	=	bitsPerPixel / 2;
+		chunkCnt	=	0;
+		for (xxx=0; xxx<imgWidth; xxx++)
+		{
+			for (yyy=0; yyy<imgHeight; yyy++)
+			{
+				pixelChunk[chunkCnt++]	=	pixelPtr[(yyy * imgWidth) + xxx];
+				if (chunkCnt >= kPackChunkPixels)
+				{
+					if ((ccc + ((kPackChunkPixels / 4) * groupBytes)) > bufferSize)
+					{
+						return(ccc);
+					}
+					ccc			+=	ImageKernel_PackBits_U16(&binaryDataBuffer[ccc], pixelChunk, chunkCnt, bitsPerPixel, shift);
+					chunkCnt	=	0;
+				}
+			}
+		}
+		if ((chunkCnt > 0) && ((ccc + (((chunkCnt + 3) / 4) * groupBytes)) <= bufferSize))
+		{
+			ccc	+=	ImageKernel_PackBits_U16(&binaryDataBuffer[ccc], pixelChunk, chunkCnt, bitsPerPixel, shift);
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG("cCameraDataBuffer is NULL");
+	}
+	return(ccc);
+}
+
+//*****************************************************************************
+//*	Packing is only used if it is lossless, the OR of all of the pixels gives
+//*	the lowest and highest bits used.  Returns 12, 14 or 0 for no packing
+//*****************************************************************************
+static int	GetPackedBitDepth(const uint16_t *pixelPtr, const int totalPixels, int32_t *shift)
+{
+uint16_t	orValue;
+int			highBit;
+int			usedBits;
+
+	orValue	=	ImageKernel_OrReduce_U16(pixelPtr, totalPixels);
+	if (orValue == 0)
+	{
+		*shift	=	0;
+		return(12);
+	}
+	*shift		=	__builtin_ctz(orValue);
+	highBit		=	31 - __builtin_clz(orValue);
+	usedBits	=	highBit - *shift + 1;
+	if (usedBits <= 12)
+	{
+		return(12);
+	}
+	else if (usedBits <= 14)
+	{
+		return(14);
+	}
+	return(0);
+}
+
 //*****************************************************************************
 //*	returns byte count
 //*****************************************************************************
@@ -4301,37 +4833,35 @@ int		pixelIndex;
 //*****************************************************************************
 //*	returns byte count
 //*****************************************************************************
-int	CameraDriver::BuildBinaryImage_RGB24_32bit(	uint32_t 	*binaryDataBuffer,
-												int			startOffset,
-												int			bufferSize)
+int	CameraDriver::BuildBinaryImage_RGB24_32bit(	unsigned char 	*binaryDataBuffer,
+												int				startOffset,
+												int				bufferSize)
 {
 int		xxx;
 int		yyy;
 int		ccc;
 int		pixelIndex;
-int		pixelCntMax;
+int		rgbIdx;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 
 	ccc	=	startOffset;
 	if (cCameraDataBuffer != NULL)
 	{
-		pixelCntMax	=	bufferSize / 4;
 		for (xxx=0; xxx<cLastExposure_ROIinfo.currentROIwidth; xxx++)
 		{
 			pixelIndex	=	xxx * 3;
 			for (yyy=0; yyy < cLastExposure_ROIinfo.currentROIheight; yyy++)
 			{
-				if (ccc < pixelCntMax)
+				//*	red, green, blue, the camera data is BGR
+				for (rgbIdx=2; (rgbIdx >= 0) && ((ccc + 4) <= bufferSize); rgbIdx--)
 				{
-					//*	red data
-					binaryDataBuffer[ccc++]	=	(cCameraDataBuffer[pixelIndex + 2] & 0x00ff) << 24;
-
-					//*	green data
-					binaryDataBuffer[ccc++]	=	(cCameraDataBuffer[pixelIndex + 1] & 0x00ff) << 24;
-
-					//*	blue data
-					binaryDataBuffer[ccc++]	=	(cCameraDataBuffer[pixelIndex] & 0x00ff) << 24;
+					//*	its little endian, 8 bit value scaled to 16 bits in 32 bit word,
+					//*	the same as BuildBinaryImage_Raw8_32bit()
+					binaryDataBuffer[ccc++]	=	0;
+					binaryDataBuffer[ccc++]	=	(cCameraDataBuffer[pixelIndex + rgbIdx] & 0x00ff);
+					binaryDataBuffer[ccc++]	=	0;
+					binaryDataBuffer[ccc++]	=	0;
 				}
 				pixelIndex	+=	cLastExposure_ROIinfo.currentROIwidth * 3;
 			}
@@ -4400,7 +4930,166 @@ static void	GetAlpacaImageDataTypeString(int dataType, char *dataTypeString)
 		case kAlpacaImageData_Byte:		strcpy(dataTypeString, "Byte");		break;
 		case kAlpacaImageData_Int64:	strcpy(dataTypeString, "Int64");	break;
 		case kAlpacaImageData_UInt16:	strcpy(dataTypeString, "UInt16");	break;
+		case kAlpacaImageData_Packed12:	strcpy(dataTypeString, "Packed12");	break;
+		case kAlpacaImageData_Packed14:	strcpy(dataTypeString, "Packed14");	break;
+	}
+}
+
+//*****************************************************************************
+//*	Sets the ImageBytes element types for the image type and returns the bytes per pixel.
+//*	ImageElementType is always Int32, the type of the ImageArray property.
+//*	8 bit data is in ImageArray as (value << 8), the same as the JSON imagearray,
+//*	so the narrowest type that keeps the values for a standard client is UInt16.
+//*	AlpacaPi clients do the shift themselves and get Byte.
+//*	wideTypes (-w on the command line) sends Int32 for clients that only decode Int16/Int32
+//*****************************************************************************
+static int	SetImageBytesElementTypes(	TYPE_BinaryImageHdr	*binaryImageHdr,
+										const int			imageType,
+										const bool			alpacaPiClient,
+										const bool			wideTypes)
+{
+int		bytesPerElement;
+int		planeCnt;
+
+	binaryImageHdr->ImageElementType	=	kAlpacaImageData_Int32;		//	Element type of the source image array
+	binaryImageHdr->Dimension3			=	0;							//	(0 for 2D array)
+	planeCnt							=	1;
+	switch(imageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+		case kImageType_RGB24:
+			if (imageType == kImageType_RGB24)
+			{
+				binaryImageHdr->Rank		=	3;		//	Image array rank
+				binaryImageHdr->Dimension3	=	3;		//	Length of image array third dimension
+				planeCnt					=	3;
+			}
+			if (alpacaPiClient)
+			{
+				bytesPerElement							=	1;
+				binaryImageHdr->TransmissionElementType	=	kAlpacaImageData_Byte;		//	Element type as sent over the network
+			}
+			else if (wideTypes)
+			{
+				bytesPerElement							=	4;
+				binaryImageHdr->TransmissionElementType	=	kAlpacaImageData_Int32;		//	Element type as sent over the network
+			}
+			else
+			{
+				bytesPerElement							=	2;
+				binaryImageHdr->TransmissionElementType	=	kAlpacaImageData_UInt16;	//	Element type as sent over the network
+			}
+			break;
+
+		case kImageType_RAW16:
+			//*	values above 32767 do not fit in Int16, UInt16 is the narrowest for everyone
+			bytesPerElement							=	2;
+			binaryImageHdr->TransmissionElementType	=	kAlpacaImageData_UInt16;	//	Element type as sent over the network
+			break;
+
+		default:
+			bytesPerElement	=	6;
+			break;
 	}
+	return(bytesPerElement * planeCnt);
+}
+
+//*****************************************************************************
+//*	builds a complete imagebytes response (HTTP header + data) for an image that
+//*	is not the current frame, i.e. a copy of the live stack.
+//*	cCameraDataBuffer and cLastExposure_ROIinfo are not used, the values are the
+//*	same as Get_Imagearray_Binary() sends for that image type.
+//*	returns a malloc'd buffer, NULL if there is no memory or the type is not supported
+//*****************************************************************************
+uint8_t	*CameraDriver::BuildImageBytesResponse(	const unsigned char			*imageData,
+												const TYPE_IMAGE_ROI_Info	*roiInfo,
+												const bool					alpacaPiClient,
+												size_t						*responseLen)
+{
+TYPE_BinaryImageHdr	binaryImageHdr;
+char				httpHeader[256];
+uint8_t				*responseBuffer;
+uint8_t				*dataPtr;
+size_t				httpHeaderSize;
+size_t				dataPayloadSize;
+uint32_t			pixelValue;
+long				pixelIndex;
+int					bytesPerPixel;
+int					planeCnt;
+int					elementBytes;
+int					xxx;
+int					yyy;
+int					plane;
+int					bbb;
+
+	*responseLen	=	0;
+	memset((void *)&binaryImageHdr, 0, sizeof(TYPE_BinaryImageHdr));
+	binaryImageHdr.MetadataVersion	=	1;
+	binaryImageHdr.DataStart		=	sizeof(TYPE_BinaryImageHdr);
+	binaryImageHdr.Rank				=	2;
+	binaryImageHdr.Dimension1		=	roiInfo->currentROIwidth;
+	binaryImageHdr.Dimension2		=	roiInfo->currentROIheight;
+	bytesPerPixel					=	SetImageBytesElementTypes(	&binaryImageHdr,
+																	roiInfo->currentROIimageType,
+																	alpacaPiClient,
+																	gImageBytesLegacy);
+	planeCnt		=	(roiInfo->currentROIimageType == kImageType_RGB24) ? 3 : 1;
+	elementBytes	=	bytesPerPixel / planeCnt;
+	if ((imageData == NULL) || (elementBytes > 4))
+	{
+		return(NULL);
+	}
+	dataPayloadSize	=	binaryImageHdr.DataStart +
+						((size_t)roiInfo->currentROIwidth * roiInfo->currentROIheight * bytesPerPixel);
+	sprintf(httpHeader,	"HTTP/1.0 200 OK\r\n"
+						"Content-Length: %ld\r\n"
+						"Content-type: application/imagebytes; charset=utf-8\r\n"
+						"Server: AlpacaPi\r\n"
+						"\r\n",
+						(long)dataPayloadSize);
+	httpHeaderSize	=	strlen(httpHeader);
+
+	responseBuffer	=	(uint8_t *)malloc(httpHeaderSize + dataPayloadSize);
+	if (responseBuffer != NULL)
+	{
+		memcpy(responseBuffer, httpHeader, httpHeaderSize);
+		memcpy(&responseBuffer[httpHeaderSize], &binaryImageHdr, sizeof(TYPE_BinaryImageHdr));
+		dataPtr	=	&responseBuffer[httpHeaderSize + binaryImageHdr.DataStart];
+
+		//*	column order, little endian, RGB planes for each pixel
+		for (xxx=0; xxx<roiInfo->currentROIwidth; xxx++)
+		{
+			for (yyy=0; yyy<roiInfo->currentROIheight; yyy++)
+			{
+				pixelIndex	=	((long)yyy * roiInfo->currentROIwidth) + xxx;
+				for (plane=0; plane<planeCnt; plane++)
+				{
+					if (roiInfo->currentROIimageType == kImageType_RAW16)
+					{
+						pixelValue	=	((const uint16_t *)imageData)[pixelIndex];
+					}
+					else
+					{
+						//*	the data is BGR
+						pixelValue	=	imageData[(pixelIndex * planeCnt) + (planeCnt - 1 - plane)];
+						if (elementBytes > 1)
+						{
+							//*	8 bit values are (value << 8) in ImageArray
+							pixelValue	=	pixelValue << 8;
+						}
+					}
+					for (bbb=0; bbb<elementBytes; bbb++)
+					{
+						*dataPtr++	=	(pixelValue >> (8 * bbb)) & 0x00ff;
+					}
+				}
+			}
+		}
+		*responseLen	=	httpHeaderSize + dataPayloadSize;
+	}
+	return(responseBuffer);
 }
 
 //*****************************************************************************
@@ -4421,9 +5110,20 @@ char				httpHeader[1024];
 char				lineBuff[128];
 size_t				httpHeaderSize;
 int					returnedDataLen;
+uint64_t			serializeStart_us;
+uint64_t			sendStart_us;
+TYPE_PackedImageInfo	packedInfo;
+bool				packedRequested;
+bool				deflateRequested;
+int					cacheFormat;
+int					cacheVariant;
+long				cacheFrame;
+TYPE_IMAGEARRAY_CACHE	*cacheEntry;
+char				entityTag[80];
 //char				dataTypeString[32];
 
 	CONSOLE_DEBUG(__FUNCTION__);
+	serializeStart_us	=	PipelineTiming_Now_us();
 
 	cResponseIsJSON	=	false;
 
@@ -4447,69 +5147,71 @@ int					returnedDataLen;
 	CONSOLE_DEBUG_W_NUM("cLastExposure_ROIinfo.currentROIheight\t=",	cLastExposure_ROIinfo.currentROIheight);
 	totalPixels		=	cLastExposure_ROIinfo.currentROIwidth * cLastExposure_ROIinfo.currentROIheight;
 	bytesPerPixel	=	6;
+	memset((void *)&packedInfo, 0, sizeof(TYPE_PackedImageInfo));
 
 bool	xmit16BitAs32Bit	=	false;
-	switch(cLastExposure_ROIinfo.currentROIimageType)
-	{
-		case kImageType_RAW8:
-		case kImageType_Y8:
-		case kImageType_MONO8:
-			CONSOLE_DEBUG("kImageType_RAW8");
-			binaryImageHdr.Dimension3				=	0;							//	(0 for 2D array)
-			if (reqData->cHTTPclientType == kHTTPclient_AlpacaPi)
-		//	if (reqData->cHTTPclientType == kHTTPclient_last)
-			{
-				bytesPerPixel							=	1;
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_Byte;		//	Element type of the source image array
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Byte;		//	Element type as sent over the network
-			}
-			else
-			{
-				bytesPerPixel							=	4;
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_Int32;		//	Element type of the source image array
-//				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Int32;		//	Element type as sent over the network
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Int16;		//	Element type as sent over the network
-			}
-			break;
-
-		case kImageType_RAW16:
-			CONSOLE_DEBUG("kImageType_RAW16");
-			if (xmit16BitAs32Bit)
-			{
-				bytesPerPixel	=	4;
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_Int32;	//	Element type of the source image array
-				binaryImageHdr.Dimension3				=	0;						//	(0 for 2D array)
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Int32;	//	Element type as sent over the network
-			}
-			else
-			{
-				bytesPerPixel	=	2;
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_UInt16;	//	Element type of the source image array
-				binaryImageHdr.Dimension3				=	0;							//	(0 for 2D array)
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_UInt16;	//	Element type as sent over the network
-			}
-			break;
+	bytesPerPixel	=	SetImageBytesElementTypes(	&binaryImageHdr,
+													cLastExposure_ROIinfo.currentROIimageType,
+													(reqData->cHTTPclientType == kHTTPclient_AlpacaPi),
+													gImageBytesLegacy);
+	packedRequested	=	(strcasestr(reqData->htmlData, "application/imagebytes-packed") != NULL);
+	deflateRequested	=	false;
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+	//*	the compressed data is smaller than the packed data, it is never both
+	if (strcasestr(reqData->htmlData, "application/imagebytes-deflate") != NULL)
+	{
+		deflateRequested	=	true;
+		packedRequested		=	false;
+	}
+#endif
 
-		case kImageType_RGB24:
-			CONSOLE_DEBUG("kImageType_RGB24");
-			binaryImageHdr.Rank						=	3;	//	Image array rank
-			binaryImageHdr.Dimension3				=	3;	//	Length of image array third dimension (0 for 2D array)
-			if (reqData->cHTTPclientType == kHTTPclient_AlpacaPi)
-			{
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_Byte;		//	Element type of the source image array
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Byte;		//	Element type as sent over the network
-				bytesPerPixel							=	3;
-			}
-			else
+	//*	another client may already have asked for this frame in this format
+	cacheFormat		=	binaryImageHdr.TransmissionElementType;
+	cacheVariant	=	(binaryImageHdr.ImageElementType << 8) | (packedRequested ? 1 : 0) | (deflateRequested ? 2 : 0);
+	cacheFrame		=	cFramesProcessed;
+
+	//*	the ETag pins the frame, a resumed download (Range + If-Range) gets the
+	//*	rest of the frame it started with, it is kept in the cache for a while
+	ImageCache_GetEntityTag(cacheFormat, cacheVariant, entityTag);
+	cacheEntry		=	ImageCache_FindResume(reqData->htmlData);
+	if (cacheEntry == NULL)
+	{
+		cacheEntry	=	ImageCache_Find(cacheFormat, cacheVariant);
+	}
+	if (cacheEntry != NULL)
+	{
+		sendStart_us	=	PipelineTiming_Now_us();
+		ImageCache_KeepForResume(cacheEntry->entityTag);
+		if (ImageCache_SendResponse(reqData, cacheEntry->dataPtr, cacheEntry->dataLen, cacheEntry->entityTag) == false)
+		{
+			CONSOLE_DEBUG("FAILED!!! to transmit entire data block!!!!!!!!!!!!!!!");
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_Success;
+			PipelineTiming_Delivered(serializeStart_us, sendStart_us);
+		}
+		ImageCache_Release(cacheEntry);
+		return(alpacaErrCode);
+	}
+
+	if (cLastExposure_ROIinfo.currentROIimageType == kImageType_RAW16)
+	{
+		if (xmit16BitAs32Bit)
+		{
+			bytesPerPixel	=	4;
+			binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Int32;	//	Element type as sent over the network
+		}
+		//*	AlpacaPi extension, only if the client asked for it
+		else if (packedRequested && (cCameraDataBuffer != NULL) && (totalPixels > 0))
+		{
+			packedInfo.BitsPerPixel	=	GetPackedBitDepth((uint16_t *)cCameraDataBuffer, totalPixels, &packedInfo.Shift);
+			if (packedInfo.BitsPerPixel > 0)
 			{
-				binaryImageHdr.ImageElementType			=	kAlpacaImageData_Int32;		//	Element type of the source image array
-				binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Int32;		//	Element type as sent over the network
-				bytesPerPixel							=	12;
+				binaryImageHdr.TransmissionElementType	=	100 + packedInfo.BitsPerPixel;
+				binaryImageHdr.DataStart				+=	sizeof(TYPE_PackedImageInfo);
 			}
-			break;
-
-		default:
-			break;
+		}
 	}
 
 //	CONSOLE_DEBUG_W_NUM("MetadataVersion\t\t=",			binaryImageHdr.MetadataVersion);
@@ -4528,8 +5230,15 @@ bool	xmit16BitAs32Bit	=	false;
 //	CONSOLE_DEBUG_W_NUM("Dimension2\t\t=",				binaryImageHdr.Dimension2);
 //	CONSOLE_DEBUG_W_NUM("Dimension3\t\t=",				binaryImageHdr.Dimension3);
 
-	dataPayloadSize		=	totalPixels * bytesPerPixel;
-	dataPayloadSize		+=	sizeof(TYPE_BinaryImageHdr);		//*	this should be 44 for version 1.
+	if (packedInfo.BitsPerPixel > 0)
+	{
+		dataPayloadSize		=	((totalPixels + 3) / 4) * (packedInfo.BitsPerPixel / 2);
+	}
+	else
+	{
+		dataPayloadSize		=	totalPixels * bytesPerPixel;
+	}
+	dataPayloadSize		+=	binaryImageHdr.DataStart;			//*	this should be 44 for version 1.
 
 	CONSOLE_DEBUG_W_NUM("bytesPerPixel\t\t=",			bytesPerPixel);
 	CONSOLE_DEBUG_W_NUM("totalPixels\t\t=",				totalPixels);
@@ -4541,6 +5250,11 @@ bool	xmit16BitAs32Bit	=	false;
 	strcat(httpHeader,	lineBuff);
 	strcat(httpHeader,	"Content-type: application/imagebytes; charset=utf-8\r\n");
 	strcat(httpHeader,	"Server: AlpacaPi\r\n");
+	if (packedInfo.BitsPerPixel > 0)
+	{
+		sprintf(lineBuff,	"AlpacaPi-Packed: bits=%d, shift=%d\r\n", packedInfo.BitsPerPixel, packedInfo.Shift);
+		strcat(httpHeader,	lineBuff);
+	}
 	strcat(httpHeader, "\r\n");
 
 	httpHeaderSize	=	strlen(httpHeader);
@@ -4565,6 +5279,11 @@ bool	xmit16BitAs32Bit	=	false;
 			//*	imgDataOffset is the index to put the image data
 			imgDataOffset		=	httpHeaderSize;
 			imgDataOffset		+=	sizeof(TYPE_BinaryImageHdr);
+			if (packedInfo.BitsPerPixel > 0)
+			{
+				memcpy(&binaryDataBuffer[imgDataOffset], &packedInfo, sizeof(TYPE_PackedImageInfo));
+				imgDataOffset	+=	sizeof(TYPE_PackedImageInfo);
+			}
 
 			CONSOLE_DEBUG_W_SIZE("httpHeaderSize             \t=",	httpHeaderSize);
 			CONSOLE_DEBUG_W_SIZE("sizeof(TYPE_BinaryImageHdr)\t=",	sizeof(TYPE_BinaryImageHdr));
@@ -4585,6 +5304,7 @@ bool	xmit16BitAs32Bit	=	false;
 							break;
 
 						case kAlpacaImageData_Int16:
+						case kAlpacaImageData_UInt16:
 							returnedDataLen	=	BuildBinaryImage_Raw8_16bit(binaryDataBuffer, imgDataOffset, bufferSize);
 							break;
 
@@ -4607,6 +5327,14 @@ bool	xmit16BitAs32Bit	=	false;
 					{
 						returnedDataLen	=	BuildBinaryImage_Raw32(binaryDataBuffer, imgDataOffset, bufferSize);
 					}
+					else if (packedInfo.BitsPerPixel > 0)
+					{
+						returnedDataLen	=	BuildBinaryImage_Raw16Packed(	binaryDataBuffer,
+																		imgDataOffset,
+																		bufferSize,
+																		packedInfo.BitsPerPixel,
+																		packedInfo.Shift);
+					}
 					else
 					{
 						returnedDataLen	=	BuildBinaryImage_Raw16(binaryDataBuffer, imgDataOffset, bufferSize);
@@ -4615,13 +5343,19 @@ bool	xmit16BitAs32Bit	=	false;
 
 				case kImageType_RGB24:
 					CONSOLE_DEBUG("kImageType_RGB24");
-					if (bytesPerPixel == 3)
-					{
-						returnedDataLen	=	BuildBinaryImage_RGB24(binaryDataBuffer, imgDataOffset, bufferSize);
-					}
-					else
+					switch (binaryImageHdr.TransmissionElementType)
 					{
-						returnedDataLen	=	BuildBinaryImage_RGB24_32bit((uint32_t *)binaryDataBuffer, imgDataOffset, bufferSize);
+						case kAlpacaImageData_Byte:
+							returnedDataLen	=	BuildBinaryImage_RGB24(binaryDataBuffer, imgDataOffset, bufferSize);
+							break;
+
+						case kAlpacaImageData_UInt16:
+							returnedDataLen	=	BuildBinaryImage_RGBx16(binaryDataBuffer, imgDataOffset, bufferSize);
+							break;
+
+						default:
+							returnedDataLen	=	BuildBinaryImage_RGB24_32bit(binaryDataBuffer, imgDataOffset, bufferSize);
+							break;
 					}
 					break;
 
@@ -4634,21 +5368,40 @@ bool	xmit16BitAs32Bit	=	false;
 					break;
 			}
 
+		#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+			//*	AlpacaPi extension, replace it with the compressed version
+			if (deflateRequested && (returnedDataLen > 0))
+			{
+			unsigned char	*compressedBuffer;
+			size_t			compressedSize;
+
+				compressedBuffer	=	ImageBytes_Deflate(	&binaryDataBuffer[httpHeaderSize],
+															(bufferSize - httpHeaderSize),
+															&compressedSize);
+				if (compressedBuffer != NULL)
+				{
+					free(binaryDataBuffer);
+					binaryDataBuffer	=	compressedBuffer;
+					bufferSize			=	compressedSize;
+				}
+			}
+		#endif
+
 			CONSOLE_DEBUG_W_SIZE("bufferSize\t\t=", bufferSize);
 			//*	if the data buffer is small, send it as one block
 		//	if (bufferSize < (20 * 1000000))
 			if (1)
 			{
 				CONSOLE_DEBUG_W_SIZE("Writting to TCP socket, bufferSize\t=", bufferSize);
-				bytesWritten	=	write(reqData->socket, binaryDataBuffer, bufferSize);
-				CONSOLE_DEBUG_W_SIZE("bytesWritten\t\t=", bytesWritten);
-				if (bytesWritten < bufferSize)
+				sendStart_us	=	PipelineTiming_Now_us();
+				if (ImageCache_SendResponse(reqData, binaryDataBuffer, bufferSize, entityTag) == false)
 				{
 					CONSOLE_DEBUG("FAILED!!! to transmit entire data block!!!!!!!!!!!!!!!");
 				}
 				else
 				{
 					alpacaErrCode	=	kASCOM_Err_Success;
+					PipelineTiming_Delivered(serializeStart_us, sendStart_us);
 				}
 			}
 			else
@@ -4682,7 +5435,17 @@ bool	xmit16BitAs32Bit	=	false;
 					CONSOLE_DEBUG_W_SIZE("bytesWritten\t\t=", bytesWritten);
 				}
 			}
-			free(binaryDataBuffer);
+			//*	keep it for the next client, the cache frees it when the next frame arrives
+			if ((returnedDataLen <= 0) ||
+				(ImageCache_Store(cacheFrame, cacheFormat, cacheVariant, entityTag, binaryDataBuffer, bufferSize) == false))
+			{
+				free(binaryDataBuffer);
+			}
+			else
+			{
+				//*	the client can resume it, even after the next frame
+				ImageCache_KeepForResume(entityTag);
+			}
 		}
 		else
 		{
@@ -4707,6 +5470,10 @@ char				imageTimeString[64];
 double				exposureTimeSecs;
 int					imgRank;
 char				httpHeader[500];
+TYPE_IMAGEARRAY_CACHE	*cacheEntry;
+long				cacheFrame;
+uint8_t				*jsonArrayText;
+size_t				jsonArrayLen;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 //	CONSOLE_DEBUG_W_STR("htmlData\t=",		reqData->htmlData);
@@ -4833,41 +5600,65 @@ char				httpHeader[500];
 		JsonResponse_SendTextBuffer(mySocket, reqData->jsonTextBuffer);
 
 		CONSOLE_DEBUG_W_NUM("pixelCount\t=", pixelCount);
-		switch(cLastExposure_ROIinfo.currentROIimageType)
+		//*	the array text is the same for every client, build it once per frame
+		cacheFrame	=	cFramesProcessed;
+		cacheEntry	=	ImageCache_Find(kImageCache_JSON, cLastExposure_ROIinfo.currentROIimageType);
+		if (cacheEntry != NULL)
 		{
-			case kImageType_RAW8:
-			case kImageType_Y8:
-			case kImageType_MONO8:
-				CONSOLE_DEBUG("kImageType_RAW8");
-				Send_imagearray_raw8(	mySocket,
-										cCameraDataBuffer,
-										cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
-										cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
-										pixelCount);
-				break;
+			ImageCache_Write(mySocket, cacheEntry->dataPtr, cacheEntry->dataLen);
+			ImageCache_Release(cacheEntry);
+		}
+		else
+		{
+			jsonArrayText	=	ImageCache_BuildJSON(&jsonArrayLen);
+			if (jsonArrayText != NULL)
+			{
+				ImageCache_Write(mySocket, jsonArrayText, jsonArrayLen);
+				if (ImageCache_Store(cacheFrame, kImageCache_JSON, cLastExposure_ROIinfo.currentROIimageType, NULL, jsonArrayText, jsonArrayLen) == false)
+				{
+					free(jsonArrayText);
+				}
+			}
+			else
+			{
+				//*	not enough memory for the whole text, send it as it is formatted
+				switch(cLastExposure_ROIinfo.currentROIimageType)
+				{
+					case kImageType_RAW8:
+					case kImageType_Y8:
+					case kImageType_MONO8:
+						CONSOLE_DEBUG("kImageType_RAW8");
+						Send_imagearray_raw8(	mySocket,
+												cCameraDataBuffer,
+												cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
+												cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
+												pixelCount);
+						break;
 
-			case kImageType_RAW16:
-				CONSOLE_DEBUG("kImageType_RAW16");
-				Send_imagearray_raw16(	mySocket,
-										(uint16_t *)cCameraDataBuffer,
-										cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
-										cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
-										pixelCount);
-				break;
+					case kImageType_RAW16:
+						CONSOLE_DEBUG("kImageType_RAW16");
+						Send_imagearray_raw16(	mySocket,
+												(uint16_t *)cCameraDataBuffer,
+												cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
+												cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
+												pixelCount);
+						break;
 
-			case kImageType_RGB24:
-				CONSOLE_DEBUG("kImageType_RGB24");
+					case kImageType_RGB24:
+						CONSOLE_DEBUG("kImageType_RGB24");
 
-				Send_imagearray_rgb24(	mySocket,
-										cCameraDataBuffer,
-										cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
-										cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
-										pixelCount);
-				break;
+						Send_imagearray_rgb24(	mySocket,
+												cCameraDataBuffer,
+												cLastExposure_ROIinfo.currentROIheight,		//*	# of rows
+												cLastExposure_ROIinfo.currentROIwidth,		//*	# of columns
+												pixelCount);
+						break;
 
 
-			default:
-				break;
+					default:
+						break;
+				}
+			}
 		}
 
 
@@ -6363,16 +7154,21 @@ bool		successFlag;
 		{
 			CONSOLE_DEBUG("Freeing existing buffer");
 			//*	buffer is not big enough, free it so we can allocate a new one
-			free(cCameraDataBuffer);
+			FrameAlloc_Free(&cCameraDataAlloc);
 			cCameraDataBuffer	=	NULL;
 			cCameraDataBuffLen	=	0;
 		}
 
 		CONSOLE_DEBUG_W_NUM("myBufferSize\t=", myBufferSize);
-		cCameraDataBuffer	=	(unsigned char *)malloc(myBufferSize + 128);
+		//*	mmap'd with the pages already faulted in (huge pages if available),
+		//*	so the first readout into it does not pay for the page faults
+		if (FrameAlloc_Allocate(&cCameraDataAlloc, (myBufferSize + 128), gLockFrameBuffers))
+		{
+			cCameraDataBuffer	=	cCameraDataAlloc.dataPtr;
+		}
 		if (cCameraDataBuffer != NULL)
 		{
-			CONSOLE_DEBUG("cCameraDataBuffer allocated");
+			CONSOLE_DEBUG_W_STR("cCameraDataBuffer allocated\t=", FrameAlloc_GetTypeString(cCameraDataAlloc.allocType));
 			cCameraDataBuffLen	=	myBufferSize;
 			successFlag			=	true;
 		}
@@ -6632,6 +7428,7 @@ TYPE_ASCOM_STATUS		alpacaErrCode;
 	cCameraProp.ImageReady		=	false;
 	SaveNextImage();
 	SetLastExposureInfo();
+	PipelineTiming_ExposureStart();
 	alpacaErrCode	=	Start_CameraExposure(cCurrentExposure_us);
 
 	return(alpacaErrCode);
@@ -7392,6 +8189,13 @@ uint32_t			elapsedMilliSecs;
 	#endif
 		cUpdateOtherDevices	=	false;
 	}
+
+	//*	autofocus has control of the camera while it is running
+	if (AutoFocus_IsActive())
+	{
+		return(AutoFocus_RunStateMachine());
+	}
+
 	alpacaErrCode	=	kASCOM_Err_Success;
 	delayMicroSecs	=	99999999;
 	switch(cImageMode)
@@ -7424,6 +8228,7 @@ uint32_t			elapsedMilliSecs;
 					//*	start next image
 					cCurrentExposure_us	+=	cSeqDeltaExposure_us;
 					SaveNextImage();
+					PipelineTiming_ExposureStart();
 					alpacaErrCode		=	Start_CameraExposure(cCurrentExposure_us);
 					GenerateFileNameRoot();
 					cImageSeqNumber++;
@@ -7442,6 +8247,7 @@ uint32_t			elapsedMilliSecs;
 			CONSOLE_DEBUG("kImageMode_Live");
 			{
 				SetLastExposureInfo();
+				PipelineTiming_ExposureStart();
 				alpacaErrCode	=	Start_CameraExposure(cCurrentExposure_us);
 				GenerateFileNameRoot();
 				if (alpacaErrCode != 0)
@@ -7473,6 +8279,8 @@ int	CameraDriver::RunStateMachine_TakingPicture(void)
 {
 int					exposureState;
 TYPE_ASCOM_STATUS	alpacaErrCode;
+bool				autoFocusFrame;
+uint64_t			stageStart_us;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 
@@ -7508,6 +8316,9 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 
 		case kExposure_Success:
 			CONSOLE_DEBUG("kExposure_Success");
+			//*	not ready until it has been read and processed
+			cCameraProp.ImageReady	=	false;
+			ImageCache_Invalidate();		//*	the serialized copies are of the previous frame
 			cFramesRead++;
 			if (gVerbose)
 			{
@@ -7515,15 +8326,23 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 			}
 
 			cWorkingLoopCnt		=	0;
+			PipelineTiming_StageDone(kPipeStage_Exposure, 0);
+
 			//*	Extract Image
+			stageStart_us		=	PipelineTiming_Now_us();
 			alpacaErrCode		=	Read_ImageData();
 			if (alpacaErrCode == kASCOM_Err_Success)
+			{
+				//*	BinX/BinY and the sub frame for cameras that only read the full sensor
+				SoftBin_ProcessFrame();
+			}
+			PipelineTiming_StageDone(kPipeStage_Readout, stageStart_us);
+			if (alpacaErrCode == kASCOM_Err_Success)
 			{
 				//*	record the time the exposure ended
 				gettimeofday(&cCameraProp.Lastexposure_EndTime, NULL);
-				cNewImageReadyToDisplay		=	true;
-				cCameraProp.ImageReady		=	true;
-//				CONSOLE_DEBUG("cCameraProp.ImageReady set to TRUE!!!!!!!!!!!!!!");
+				//*	some drivers set it while reading, the frame is not processed yet
+				cCameraProp.ImageReady		=	false;
 
 				if (cImageMode == kImageMode_Live)
 				{
@@ -7536,15 +8355,62 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 					}
 					cFrameRate	=	(cFramesRead * 1.0) / secondsOfExposure;
 				}
+
+				//*	autofocus starts the next focuser move now,
+				//*	the move overlaps the processing of this frame
+				stageStart_us	=	PipelineTiming_Now_us();
+				autoFocusFrame	=	AutoFocus_FrameRead();
+
+				//*	the hot pixel map is built from the raw frame
+				if (cHotPixelDetectPending)
+				{
+					HotPixel_DetectFromFrame();
+				}
+
+				//*	dark/bias/flat correction, or add to the master being built,
+				//*	autofocus frames are never added to a master
+				Calibration_ProcessFrame(autoFocusFrame);
+
+				//*	cosmetic correction, this only touches the pixels in the map
+				if (cHotPixelEnabled)
+				{
+					HotPixel_CorrectFrame();
+				}
+
+				//*	star count, HFR and FWHM
+				if (cStarAnalysisEnabled || cPlateSolveEnabled || autoFocusFrame)
+				{
+					StarAnalysis_ProcessFrame();
+				}
+				if (autoFocusFrame)
+				{
+					AutoFocus_FrameMeasured();
+				}
+				else if (cPlateSolveEnabled)
+				{
+					PlateSolve_ProcessFrame();
+				}
+
+				//*	the stack is updated before anything else looks at the image
+				if (cLiveStackEnabled && (autoFocusFrame == false))
+				{
+					pthread_mutex_lock(&cLiveStackMutex);
+					LiveStack_AddFrame();
+					pthread_mutex_unlock(&cLiveStackMutex);
+				}
+				PipelineTiming_StageDone(kPipeStage_Analysis, stageStart_us);
 			#ifdef _USE_OPENCV_
+				stageStart_us	=	PipelineTiming_Now_us();
 				CreateOpenCVImage(cCameraDataBuffer);
 				if (cOverlayMode)
 				{
 					DrawOverlayOntoImage();
 				}
+				PipelineTiming_StageDone(kPipeStage_Overlay, stageStart_us);
 			#endif
 
-				if (cSaveNextImage || cSaveAllImages)
+				stageStart_us	=	PipelineTiming_Now_us();
+				if ((cSaveNextImage || cSaveAllImages) && (autoFocusFrame == false))
 				{
 					SaveImageData();
 				}
@@ -7552,6 +8418,7 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 				{
 	//				CONSOLE_DEBUG("Image not saved");
 				}
+				PipelineTiming_StageDone(kPipeStage_Save, stageStart_us);
 
 				//*	check to see if we are in auto exposure adjustment
 				if (cAutoAdjustExposure)
@@ -7566,6 +8433,18 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 					UpdateLiveWindow();
 				}
 			#endif
+
+				//*	hand it to the MJPEG stream, this does not wait for the encoder
+				if (cMJPEGclientCnt > 0)
+				{
+					MJPEG_SubmitCurrentFrame();
+				}
+
+				//*	the frame is complete, imagearray can send and cache it now
+				cFramesProcessed			=	cFramesRead;
+				cNewImageReadyToDisplay		=	true;
+				cCameraProp.ImageReady		=	true;
+//				CONSOLE_DEBUG("cCameraProp.ImageReady set to TRUE!!!!!!!!!!!!!!");
 			}
 			else
 			{
@@ -7573,7 +8452,6 @@ TYPE_ASCOM_STATUS	alpacaErrCode;
 				CONSOLE_DEBUG("Resetting to single image mode");
 				cImageMode				=	kImageMode_Single;
 			}
-
 			cInternalCameraState	=	kCameraState_Idle;
 			break;
 
@@ -7835,55 +8713,95 @@ char		fileNameDateString[64];
 #pragma mark -
 
 
-//#define	_SORT_FILENAMES_
-#ifdef _SORT_FILENAMES_
+//*****************************************************************************
+//*	one index for the image directory, it is shared by all of the cameras
+static TYPE_FILE_INDEX	gImageDirIndex;
+static bool				gImageDirIndexInitialized	=	false;
 
-#define	kMaxFileCnt	200
 //*****************************************************************************
-typedef struct
+typedef struct	//	TYPE_FILELIST_OUTPUT
 {
-	char	filename[128];
-} TYPE_FILE_ENTRY;
+	TYPE_GetPutRequestData	*reqData;
+	int						bytesWritten;
+	bool					firstLine;
+} TYPE_FILELIST_OUTPUT;
 
 //*****************************************************************************
-int	DirSort(const void *e1, const void* e2)
+static void	FileList_OutputName(const char *fileName, void *context)
 {
-int	retValue;
-TYPE_FILE_ENTRY	*file1;
-TYPE_FILE_ENTRY	*file2;
+TYPE_FILELIST_OUTPUT	*fileListOutput;
+char					lineBuff[512];
 
-	file1		=	(TYPE_FILE_ENTRY *)e1;
-	file2		=	(TYPE_FILE_ENTRY *)e2;
-	retValue	=	strcmp(file1->filename, file2->filename);
-	return(retValue);
+	fileListOutput	=	(TYPE_FILELIST_OUTPUT *)context;
+	if (fileListOutput->firstLine)
+	{
+		strcpy(lineBuff, "\r\n\t\t\t\"");
+		fileListOutput->firstLine	=	false;
+	}
+	else
+	{
+		strcpy(lineBuff, "\t\t\t\"");
+	}
+	strncat(lineBuff, fileName, 400);
+	strcat(lineBuff, "\",");
+	strcat(lineBuff, "\r\n");
+	fileListOutput->bytesWritten	+=	JsonResponse_Add_RawText(	fileListOutput->reqData->socket,
+											fileListOutput->reqData->jsonTextBuffer,
+											kMaxJsonBuffLen,
+											lineBuff);
 }
-#endif // _SORT_FILENAMES_
 
+//*****************************************************************************
+//*	the file names come from an index that is kept up to date with inotify,
+//*	the directory is only read the first time
+//*		start=INT		(optional, first file to return, default 0)
+//*		count=INT		(optional, number of files to return, default 100)
+//*		filter=STR		(optional, only file names that contain this string)
 //*****************************************************************************
 TYPE_ASCOM_STATUS	CameraDriver::Get_Filelist(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
 {
-TYPE_ASCOM_STATUS	alpacaErrCode;
-DIR					*directory;
-struct dirent		*dir;
-int					errorCode;
-bool				keepGoing;
-bool				firstLine;
-int					mySocketFD;
-char				lineBuff[512];
-int					fileCount	=	0;
-#ifdef _SORT_FILENAMES_
-TYPE_FILE_ENTRY		files[kMaxFileCnt];
-int					fileIdx		=	0;
-int					iii;
-#endif // _SORT_FILENAMES_
+TYPE_ASCOM_STATUS		alpacaErrCode	=	kASCOM_Err_InternalError;
+int						mySocketFD;
+char					argumentString[64];
+char					nameFilter[128];
+int						startIdx;
+int						maxCount;
+int						matchCnt;
+TYPE_FILELIST_OUTPUT	fileListOutput;
 
 	CONSOLE_DEBUG_W_STR(__FUNCTION__, gImageDataDir);
 //	DumpRequestStructure(__FUNCTION__, reqData);
 
 	mySocketFD	=	reqData->socket;
 
-	directory	=	opendir(gImageDataDir);
-	if (directory != NULL)
+	startIdx	=	0;
+	maxCount	=	100;
+	nameFilter[0]	=	0;
+	if (GetKeyWordArgument(reqData->contentData, "Start", argumentString, (sizeof(argumentString) -1)))
+	{
+		startIdx	=	atoi(argumentString);
+		if (startIdx < 0)
+		{
+			startIdx	=	0;
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "Count", argumentString, (sizeof(argumentString) -1)))
+	{
+		maxCount	=	atoi(argumentString);
+		if (maxCount < 0)
+		{
+			maxCount	=	0;
+		}
+	}
+	GetKeyWordArgument(reqData->contentData, "Filter", nameFilter, (sizeof(nameFilter) -1));
+
+	if (gImageDirIndexInitialized == false)
+	{
+		FileIndex_Init(&gImageDirIndex);
+		gImageDirIndexInitialized	=	true;
+	}
+
+	if (FileIndex_Update(&gImageDirIndex, gImageDataDir))
 	{
 		cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(mySocketFD,
 										reqData->jsonTextBuffer,
@@ -7897,134 +8815,59 @@ int					iii;
 										kMaxJsonBuffLen,
 										gValueString);
 		alpacaErrCode	=	kASCOM_Err_Success;
-		keepGoing		=	true;
-		firstLine		=	true;
-		while (keepGoing && (fileCount < 100))
-		{
-			dir	=	readdir(directory);
-			if (dir != NULL)
-			{
-			//	if ((strcmp(dir->d_name, ".") == 0) || (strcmp(dir->d_name, "..") == 0))
-				if (dir->d_name[0] == '.')
-				{
-					//*	ignore . and ..
-				}
-				else if (dir->d_type == DT_DIR)
-				{
-					//*	ignore directories
-				}
-				else
-				{
-				//	CONSOLE_DEBUG(dir->d_name);
-				#ifdef _SORT_FILENAMES_
-					if (fileIdx < kMaxFileCnt)
-					{
-						strcpy(files[fileIdx].filename, dir->d_name);
-						fileIdx++;
-					}
-					else
-					{
-						CONSOLE_DEBUG("Exceeded file list max count!!!!!!");
-						keepGoing	=	false;
-					}
-				#else
-				//	printf("%2d\t%s\r\n", dir->d_type, dir->d_name);
-					if (firstLine)
-					{
-						strcpy(lineBuff, "\r\n\t\t\t\"");
-						firstLine	=	false;
-					}
-					else
-					{
-						strcpy(lineBuff, "\t\t\t\"");
-					}
-					strcat(lineBuff, dir->d_name);
-					strcat(lineBuff, "\",");
-					strcat(lineBuff, "\r\n");
-				//	CONSOLE_DEBUG_W_NUM("len of jsonTextBuffer\t=", strlen(reqData->jsonTextBuffer));
-					cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(	mySocketFD,
-													reqData->jsonTextBuffer,
-													kMaxJsonBuffLen,
-													lineBuff);
-				//	CONSOLE_DEBUG_W_NUM("len of jsonTextBuffer\t=", strlen(reqData->jsonTextBuffer));
-				//	CONSOLE_DEBUG_W_NUM("kMaxJsonBuffLen\t=", kMaxJsonBuffLen);
-					if (strlen(reqData->jsonTextBuffer) >= kMaxJsonBuffLen)
-					{
-						CONSOLE_DEBUG("Houston, we have a problem!!!");
-					}
-				#endif // _SORT_FILENAMES_
-					fileCount++;
-					if ((fileCount % 25) == 0)
-					{
-//						CONSOLE_DEBUG_W_NUM("Delay, fileCount\t=", fileCount);
-						usleep(5000);
-					}
-				}
-			}
-			else
-			{
-				CONSOLE_DEBUG("End of directory entries");
-				keepGoing	=	false;
-			}
-		}
-	#ifdef _SORT_FILENAMES_
-//CONSOLE_DEBUG("sorting");
-//CONSOLE_DEBUG_W_NUM("kMaxFileCnt\t=", kMaxFileCnt);
-//CONSOLE_DEBUG_W_NUM("fileIdx    \t=", fileIdx);
 
-		qsort(files, fileIdx, sizeof(TYPE_FILE_ENTRY), DirSort);
-		for (iii=0; iii < fileIdx; iii++)
-		{
-			lineBuff[0]	=	0;
-			if (firstLine)
-			{
-				strcpy(lineBuff, "\r\n");
-				firstLine	=	false;
-			}
-			strcat(lineBuff, "\t\t\t\"");
-			strcat(lineBuff, files[iii].filename);
-			strcat(lineBuff, "\",");
-			strcat(lineBuff, "\r\n");
-//			CONSOLE_DEBUG_W_NUM("len of lineBuff\t=", strlen(lineBuff));
-			cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(	mySocketFD,
-											reqData->jsonTextBuffer,
-											kMaxJsonBuffLen,
-											lineBuff);
-		}
-	#endif // _SORT_FILENAMES_
+		fileListOutput.reqData		=	reqData;
+		fileListOutput.bytesWritten	=	0;
+		fileListOutput.firstLine	=	true;
+		matchCnt	=	FileIndex_Query(&gImageDirIndex,
+										nameFilter,
+										startIdx,
+										maxCount,
+										FileList_OutputName,
+										&fileListOutput);
+		cBytesWrittenForThisCmd	+=	fileListOutput.bytesWritten;
 
-//CONSOLE_DEBUG_W_NUM("kMaxJsonBuffLen      \t=", kMaxJsonBuffLen);
-//CONSOLE_DEBUG_W_LONG("len of jsonTextBuffer\t=", strlen(reqData->jsonTextBuffer));
 		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(	mySocketFD,
 										reqData->jsonTextBuffer,
 										kMaxJsonBuffLen,
 										"\t\t\t\"END\"\r\n");
-//CONSOLE_DEBUG_W_SIZE("len of jsonTextBuffer\t=", strlen(reqData->jsonTextBuffer));
 		cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	mySocketFD,
 										reqData->jsonTextBuffer,
 										kMaxJsonBuffLen,
 										INCLUDE_COMMA);
-//CONSOLE_DEBUG_W_SIZE("len of jsonTextBuffer\t=", strlen(reqData->jsonTextBuffer));
-		errorCode	=	closedir(directory);
-		if (errorCode != 0)
-		{
-			CONSOLE_DEBUG_W_NUM("closedir errorCode\t=", errorCode);
-			CONSOLE_DEBUG_W_NUM("errno\t=", errno);
-		}
-//CONSOLE_DEBUG(__FUNCTION__);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocketFD,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"filecount",
+										gImageDirIndex.nameCnt,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocketFD,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"matchcount",
+										matchCnt,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocketFD,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"start",
+										startIdx,
+										INCLUDE_COMMA);
 	}
 	else
 	{
 		CONSOLE_DEBUG_W_STR("Failed to open", gImageDataDir);
 		CONSOLE_DEBUG_W_NUM("errno\t=", errno);
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to open image data directory");
 		LogEvent(	"camera",
 					"Failure",
 					NULL,
 					kASCOM_Err_Success,
 					"Failed to open image data directory");
 	}
-//CONSOLE_DEBUG(__FUNCTION__);
-
 	return(alpacaErrCode);
 }
 
@@ -8405,11 +9248,40 @@ bool	CameraDriver::DeviceState_Add_Content(const int socketFD, char *jsonTextBuf
 }
 
 
+//*****************************************************************************
+//*	only the simulator has settings, it overrides these
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_NotImplemented;
+
+	GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Not a simulated camera");
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_NotImplemented;
+
+	GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Not a simulated camera");
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+static const char	*gCalibReadallNames[]	=
+{
+	"calibbias",
+	"calibdark",
+	"calibflat"
+};
+
 //*****************************************************************************
 TYPE_ASCOM_STATUS	CameraDriver::Get_Readall(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
 {
 TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
 int					mySocket;
+int					iii;
 char				cameraStateString[32];
 char				imageModeString[32];
 int					exposureState;
@@ -8720,6 +9592,60 @@ char				textBuffer[128];
 
 		Get_Flip(reqData, alpacaErrMsg, "flip");
 
+		Get_LiveStack(reqData, alpacaErrMsg, "livestack");
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"stackframecount",
+										cLiveStackFrameCnt,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"stackrejected",
+										cLiveStackRejectCnt,
+										INCLUDE_COMMA);
+
+		Get_Calibration(reqData, alpacaErrMsg, "calibration");
+		for (iii=0; iii<kCalibMaster_last; iii++)
+		{
+			cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(mySocket,
+											reqData->jsonTextBuffer,
+											kMaxJsonBuffLen,
+											gCalibReadallNames[iii],
+											(cCalibMaster[iii].valid ? cCalibMaster[iii].fileName : "none"),
+											INCLUDE_COMMA);
+		}
+		Get_BuildCalibMaster(reqData, alpacaErrMsg, "calibbuildstatus");
+
+		Get_HotPixels(reqData, alpacaErrMsg, "hotpixels");
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	mySocket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"hotpixelcount",
+										cHotPixelHeader.defectCount,
+										INCLUDE_COMMA);
+
+		StarAnalysis_OutputReadall(reqData);
+		AutoFocus_OutputReadall(reqData);
+		PlateSolve_OutputReadall(reqData);
+		Demosaic_OutputReadall(reqData);
+		ImageEncode_OutputReadall(reqData);
+		Overlay_OutputReadall(reqData);
+		PipelineTiming_OutputReadall(reqData);
+		SoftBin_OutputReadall(reqData);
+		Preview_OutputReadall(reqData);
+		ImageCache_OutputReadall(reqData);
+		MJPEG_OutputReadall(reqData);
+	#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+		ImageBytes_OutputReadall(reqData);
+	#endif
+		if (cCameraIsSiumlated)
+		{
+			Get_Simulator(reqData, alpacaErrMsg, "simulator");
+		}
+
 
 		//*	figure out how much time is remaining on the video
  		if (cVideoDuration_secs > 0)
@@ -9295,11 +10221,30 @@ bool	foundFlag	=	true;
 		//=================================================================
 		//*	commands added that are not part of Alpaca
 		case kCmd_Camera_autoexposure:		strcpy(agumentString, "autoexposure=BOOL");		break;
+		case kCmd_Camera_autofocus:			strcpy(agumentString, "autofocus=BOOL, stepsize=INT, samples=INT, exposure=FLOAT, backlash=INT, center=INT");	break;
+		case kCmd_Camera_platesolve:		strcpy(agumentString, "platesolve=BOOL, scale=FLOAT");	break;
+		case kCmd_Camera_demosaic:			strcpy(agumentString, "demosaic=BOOL, method=bilinear|edge, output=rgb24|rgb48, pattern=auto|RGGB|BGGR|GRBG|GBRG");	break;
+		case kCmd_Camera_buildcalibmaster:	strcpy(agumentString, "type=bias|dark|flat, count=INT");	break;
+		case kCmd_Camera_buildhotpixelmap:	strcpy(agumentString, "sigma=FLOAT (optional)");	break;
+		case kCmd_Camera_calibration:		strcpy(agumentString, "calibration=BOOL");		break;
+		case kCmd_Camera_hotpixels:			strcpy(agumentString, "hotpixels=BOOL");		break;
+		case kCmd_Camera_imageencode:		strcpy(agumentString, "encoder=fast|legacy, quality=INT, fastdct=BOOL, compression=INT, filter=none|sub|up|average|paeth|adaptive, strips=INT");	break;
+		case kCmd_Camera_overlay:			strcpy(agumentString, "overlay=INT (0=off, 1=time), cache=BOOL");	break;
+		case kCmd_Camera_pipelinetiming:	strcpy(agumentString, "reset=BOOL");	break;
+		case kCmd_Camera_imageindex:		strcpy(agumentString, "object=STR, filter=STR, name=STR, minexposure=FLOAT, maxexposure=FLOAT, maxhfr=FLOAT, since=FLOAT, until=FLOAT, start=INT, count=INT");	break;
+		case kCmd_Camera_softbinning:		strcpy(agumentString, "mode=sum|average");	break;
+		case kCmd_Camera_imagestats:		strcpy(agumentString, "bins=INT (0=none), x=INT, y=INT, width=INT, height=INT");	break;
+		case kCmd_Camera_preview:			strcpy(agumentString, "maxwidth=INT, stretch=auto|linear|none, format=jpeg|png|raw, quality=INT");	break;
+		case kCmd_Camera_simulator:			strcpy(agumentString, "simulator=starfield|pattern, ra=FLOAT, dec=FLOAT, rotation=FLOAT, scale=FLOAT, seeing=FLOAT, maglimit=FLOAT, skylevel=FLOAT, readnoise=FLOAT, hotpixels=INT, driftra=FLOAT, driftdec=FLOAT, bayer=BOOL, seed=INT, ringsize=INT");	break;
 		case kCmd_Camera_displayimage:		strcpy(agumentString, "displayImage=BOOL");		break;
 		case kCmd_Camera_ExposureTime:		strcpy(agumentString, "duration=FLOAT");		break;
+		case kCmd_Camera_filelist:			strcpy(agumentString, "start=INT, count=INT, filter=STR");	break;
 		case kCmd_Camera_filenameoptions:	strcpy(agumentString, "includecamera=BOOL");	break;
 		case kCmd_Camera_flip:				strcpy(agumentString, "flip=INT (0,1,2,3)");	break;
 		case kCmd_Camera_livemode:			strcpy(agumentString, "livemode=BOOL");			break;
+		case kCmd_Camera_livestack:			strcpy(agumentString, "livestack=BOOL, mode=mean|sigma, sigma=FLOAT");	break;
+		case kCmd_Camera_mjpeg:				strcpy(agumentString, "maxwidth=INT, stretch=auto|linear|none, quality=INT");	break;
+		case kCmd_Camera_staranalysis:		strcpy(agumentString, "staranalysis=BOOL, sigma=FLOAT (optional)");	break;
 		case kCmd_Camera_settelescopeinfo:	strcpy(agumentString, "RefID,Telescope,Focuser,Filterwheel,Object,Prefix,Suffix,auxtext");			break;
 		case kCmd_Camera_saveallimages:		strcpy(agumentString, "saveallimages=BOOL");						break;
 		case kCmd_Camera_saveasFITS:		strcpy(agumentString, "saveasfits=BOOL");							break;
@@ -9314,9 +10259,9 @@ bool	foundFlag	=	true;
 		case kCmd_Camera_fitsheader:
 #endif
 		case kCmd_Camera_framerate:
-		case kCmd_Camera_filelist:
 		case kCmd_Camera_rgbarray:
 		case kCmd_Camera_savedimages:
+		case kCmd_Camera_stackedimage:
 		case kCmd_Camera_savenextimage:
 		case kCmd_Camera_stopvideo:
 		case kCmd_Camera_readall:
@@ -9493,6 +10438,8 @@ bool		checkedFlag;
 
 
 	SocketWriteData(mySocketFD,	"</form>\r\n");
+
+	PipelineTiming_OutputHTML(reqData);
 	return(true);
 }
 
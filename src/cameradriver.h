@@ -29,6 +29,34 @@
 //*	Jun  4,	2023	<MLS> Added cSaveAsFITS, cSaveAsJPEG, cSaveAsPNG, cSaveAsRAW
 //*	Aug 31,	2023	<MLS> Adding support for GPS, specifically the QHY174-GPS
 //*	Apr 19,	2024	<MLS> Added kImageType_MONO8
+//*	Oct 19,	2026	<MLS> Added live stacking (cameradriver_stack.cpp)
+//*	Oct 19,	2026	<MLS> Added calibration master support (cameradriver_calib.cpp)
+//*	Oct 19,	2026	<MLS> Added hot pixel map (cameradriver_hotpixel.cpp)
+//*	Oct 19,	2026	<MLS> Added star analysis (cameradriver_stars.cpp)
+//*	Oct 19,	2026	<MLS> Added autofocus (cameradriver_autofocus.cpp)
+//*	Oct 19,	2026	<MLS> Added plate solving (cameradriver_platesolve.cpp)
+//*	Oct 19,	2026	<MLS> Added Bayer demosaic (cameradriver_demosaic.cpp)
+//*	Oct 19,	2026	<MLS> Added multithreaded JPEG/PNG encoding (cameradriver_encode.cpp)
+//*	Oct 19,	2026	<MLS> Added virtual Get_Simulator() & Put_Simulator()
+//*	Oct 19,	2026	<MLS> Added cached overlay layer (TYPE_OVERLAY_TILE)
+//*	Oct 19,	2026	<MLS> Added live window display pyramid (TYPE_PYRAMID_LEVEL)
+//*	Oct 19,	2026	<MLS> Added capture pipeline timing (cameradriver_timing.cpp)
+//*	Oct 19,	2026	<MLS> Added saved image metadata index (cameradriver_imageindex.cpp)
+//*	Oct 19,	2026	<MLS> Added BuildBinaryImage_Raw16Packed()
+//*	Oct 19,	2026	<MLS> Added cCameraDataAlloc (mmap/huge page frame buffer)
+//*	Oct 19,	2026	<MLS> Added software binning and sub frames (cameradriver_softbin.cpp)
+//*	Oct 19,	2026	<MLS> Added server side preview (cameradriver_preview.cpp)
+//*	Oct 19,	2026	<MLS> Added full resolution image statistics (cameradriver_imagestats.cpp)
+//*	Oct 19,	2026	<MLS> Added serialized imagearray cache (cameradriver_imagecache.cpp)
+//*	Oct 19,	2026	<MLS> Added MJPEG live stream (cameradriver_mjpeg.cpp)
+//*	Oct 19,	2026	<MLS> Added compressed imagebytes (cameradriver_deflate.cpp)
+//*	Oct 19,	2026	<MLS> Added cImageCacheMutex and reference counted cache entries
+//*	Oct 19,	2026	<MLS> Added ImageCache_FindResume() and ImageCache_KeepForResume()
+//*	Oct 19,	2026	<MLS> Added cLiveStackMutex
+//*	Oct 19,	2026	<MLS> Added filterName to TYPE_CALIB_HEADER
+//*	Oct 19,	2026	<MLS> Added cCalibMutex
+//*	Oct 19,	2026	<MLS> Removed cLiveStackOutput and cImageCacheBypass, added BuildImageBytesResponse()
+//*	Oct 19,	2026	<MLS> cLiveStackSum, cLiveStackSumSq and cCalibBuildSum changed to double
 //*****************************************************************************
 //#include	"cameradriver.h"
 
@@ -73,6 +101,22 @@
 	#include	"alpacadriver.h"
 #endif
 
+#ifndef _STAR_ANALYSIS_H_
+	#include	"star_analysis.h"
+#endif
+
+#ifndef _PLATE_SOLVE_H_
+	#include	"plate_solve.h"
+#endif
+
+#ifndef _IMAGE_ENCODE_H_
+	#include	"image_encode.h"
+#endif
+
+#ifndef _FRAME_ALLOC_H_
+	#include	"frame_alloc.h"
+#endif
+
 #if defined(_ENABLE_FILTERWHEEL_) || defined(_ENABLE_FILTERWHEEL_ZWO_) || defined(_ENABLE_FILTERWHEEL_ATIK_)
 	#include	"filterwheeldriver.h"
 #endif
@@ -208,6 +252,306 @@ typedef struct	//	TYPE_FILENAME
 #define	SAVE_AVI	true
 
 
+//*****************************************************************************
+//*	live stacking
+#define	kLiveStackMaxStars		16
+#define	kLiveStackDefaultSigma	3.0
+
+//*****************************************************************************
+typedef enum
+{
+	kLiveStack_Mean	=	0,
+	kLiveStack_SigmaClip,
+
+	kLiveStack_last
+} TYPE_LIVESTACK_MODE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STACK_STAR
+{
+	double	xCenter;
+	double	yCenter;
+	double	starFlux;		//*	peak value minus background
+} TYPE_STACK_STAR;
+
+
+//*****************************************************************************
+//*	calibration masters
+#define	kCalibrationDir			"calibration"
+#define	kCalibHeaderSize		256
+
+//*****************************************************************************
+typedef enum
+{
+	kCalibMaster_Bias	=	0,
+	kCalibMaster_Dark,
+	kCalibMaster_Flat,
+
+	kCalibMaster_last
+} TYPE_CALIB_MASTER;
+
+//*****************************************************************************
+//*	this is the header at the start of each master file, the data follows
+//*	at kCalibHeaderSize as an array of floats, one per value in the image
+//*	flat masters are stored as a gain (normalized mean / flat)
+typedef struct	//	TYPE_CALIB_HEADER
+{
+	char		magic[8];
+	int32_t		version;
+	int32_t		masterType;
+	int32_t		imageType;
+	int32_t		width;
+	int32_t		height;
+	int32_t		binning;
+	int32_t		gain;
+	int32_t		offset;
+	int32_t		exposure_us;
+	float		sensorTemp;
+	int32_t		frameCount;
+	char		filterName[48];		//*	flats only match the filter they were taken with
+} TYPE_CALIB_HEADER;
+
+//*****************************************************************************
+typedef struct	//	TYPE_CALIB_MASTER_INFO
+{
+	bool				valid;
+	char				fileName[kMaxFileNameLen];
+	TYPE_CALIB_HEADER	header;
+	void				*mapPtr;
+	size_t				mapSize;
+	const float			*dataPtr;
+} TYPE_CALIB_MASTER_INFO;
+
+//*****************************************************************************
+//*	hot pixel map, the header is followed by a sorted list of uint32_t pixel indexes
+//*	(yyy * width + xxx), for RGB24 all 3 colors of the pixel are replaced
+#define	kHotPixelDefaultSigma	6.0
+#define	kHotPixelMaxDefects		(256 * 1024)
+
+typedef struct	//	TYPE_HOTPIXEL_HEADER
+{
+	char		magic[8];
+	int32_t		version;
+	char		serialNum[32];
+	int32_t		imageType;
+	int32_t		width;
+	int32_t		height;
+	int32_t		binning;
+	int32_t		gain;
+	float		sensorTemp;
+	int32_t		hotCount;
+	int32_t		coldCount;
+	int32_t		defectCount;		//*	hotCount + coldCount
+} TYPE_HOTPIXEL_HEADER;
+
+//*****************************************************************************
+//*	autofocus
+#define	kAutoFocusMaxSamples		41
+#define	kAutoFocusDefaultSamples	9
+#define	kAutoFocusMinValidSamples	5
+#define	kAutoFocusMinStars			3
+#define	kAutoFocusMoveTimeout_secs	120
+
+//*****************************************************************************
+typedef enum
+{
+	kAutoFocus_Idle	=	0,
+	kAutoFocus_Backlash,			//*	moving below the first sample position
+	kAutoFocus_WaitForFocuser,		//*	moving to the next sample position
+	kAutoFocus_Exposing,
+	kAutoFocus_Measuring,			//*	last frame is being analyzed
+	kAutoFocus_BacklashToFinal,
+	kAutoFocus_MovingToFinal,
+	kAutoFocus_Complete,
+	kAutoFocus_Failed,
+	kAutoFocus_Aborted,
+
+	kAutoFocus_last
+} TYPE_AUTOFOCUS_STATE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_AUTOFOCUS_SAMPLE
+{
+	int32_t		position;
+	double		hfr;
+	int			starCount;
+	bool		valid;
+} TYPE_AUTOFOCUS_SAMPLE;
+
+//*****************************************************************************
+//*	one piece of the overlay, rendered once and kept in the layout of the frame
+//*	(premultiplied color and 1 - alpha per sample) until its text or the frame format changes
+#define	kOverlay_MaxTiles		8
+typedef struct	//	TYPE_OVERLAY_TILE
+{
+	char		text[128];
+	int			left;
+	int			top;
+	int			width;
+	int			height;
+	int			frameType;			//*	OpenCV type of the frame it was converted for
+	void		*colorBuf;
+	void		*invAlphaBuf;
+	size_t		bufSize;
+} TYPE_OVERLAY_TILE;
+
+//*****************************************************************************
+//*	one level of the live window display pyramid, each level is a 2x2 box filter
+//*	of the one above it, level 0 is the full size image and is not copied
+#define	kDisplayPyramid_Levels	4		//*	1x, 2x, 4x, 8x
+typedef struct	//	TYPE_PYRAMID_LEVEL
+{
+	uint8_t		*pixels;
+	int			width;
+	int			height;
+	int			rowBytes;			//*	no padding, width * channels * bytesPerSample
+	size_t		bufSize;
+} TYPE_PYRAMID_LEVEL;
+
+#define	kSideBar_MaxLines		16
+
+//*****************************************************************************
+//*	capture pipeline timing, one record per frame, see cameradriver_timing.cpp
+enum
+{
+	kPipeStage_Exposure	=	0,	//*	start exposure until the camera reports it is done
+	kPipeStage_Readout,			//*	Read_ImageData()
+	kPipeStage_Analysis,		//*	calibration, hot pixels, stars, plate solve, stacking
+	kPipeStage_Overlay,			//*	OpenCV image and overlay
+	kPipeStage_Save,			//*	FITS/JPEG/PNG/RAW files
+	kPipeStage_Serialize,		//*	building the imagebytes buffer
+	kPipeStage_Send,			//*	write() to the client
+
+	kPipeStage_Last
+};
+
+#define	kPipelineTiming_RingSize	64
+typedef struct	//	TYPE_PIPELINE_TIMING
+{
+	long		frameNumber;				//*	cFramesRead, 0 = exposure still in progress
+	uint64_t	exposureStart_us;			//*	CLOCK_MONOTONIC
+	uint64_t	exposureEnd_us;
+	uint32_t	stage_us[kPipeStage_Last];
+	uint32_t	delivery_us;				//*	end of exposure to the end of the first send, 0 = not sent
+	bool		processed;					//*	all of the stages up to the save are done
+} TYPE_PIPELINE_TIMING;
+
+uint64_t	PipelineTiming_Now_us(void);
+
+//*****************************************************************************
+//*	server side preview, see cameradriver_preview.cpp
+enum
+{
+	kPreviewStretch_Auto	=	0,
+	kPreviewStretch_Linear,
+	kPreviewStretch_None
+};
+
+enum
+{
+	kPreviewFormat_JPEG	=	0,
+	kPreviewFormat_PNG,
+	kPreviewFormat_RAW
+};
+
+typedef struct	//	TYPE_PREVIEW_CACHE
+{
+	long		frameNumber;		//*	cFramesRead it was made from, -1 = empty
+	int			maxWidth;
+	int			stretch;			//*	kPreviewStretch_xxx
+	int			format;				//*	kPreviewFormat_xxx
+	int			quality;
+	uint8_t		*responseBuf;		//*	HTTP header followed by the image
+	size_t		responseLen;
+} TYPE_PREVIEW_CACHE;
+
+const uint8_t	*Preview_Reduce(const uint8_t	*srcPixels,
+								int				*width,
+								int				*height,
+								const int		channels,
+								const int		bytesPerValue,
+								const int		maxWidth,
+								uint8_t			**scratchBuf,
+								size_t			*scratchSize);
+bool			Preview_Stretch(uint8_t			*displayBuf,
+								const uint8_t	*srcPixels,
+								const int		pixelCnt,
+								const int		channels,
+								const int		bytesPerValue,
+								const int		stretchMode);
+
+//*****************************************************************************
+//*	full resolution image statistics, see cameradriver_imagestats.cpp
+typedef struct	//	TYPE_CHANNEL_STATS
+{
+	uint64_t	pixelCnt;
+	int			minValue;
+	int			maxValue;
+	int			median;
+	double		mean;
+	double		stdDev;
+	uint32_t	saturatedCnt;		//*	pixels at full scale
+} TYPE_CHANNEL_STATS;
+
+typedef struct	//	TYPE_IMAGE_STATS
+{
+	long				frameNumber;		//*	cFramesRead it was made from, -1 = none
+	int					roiX;
+	int					roiY;
+	int					roiWidth;
+	int					roiHeight;
+	int					channels;			//*	1 or 3 (R, G, B)
+	int					histSize;			//*	per channel, 256 or 65536
+	uint32_t			*histogram;			//*	channels * histSize
+	TYPE_CHANNEL_STATS	channelStats[3];
+	uint32_t			calc_ms;
+} TYPE_IMAGE_STATS;
+
+//*****************************************************************************
+//*	serialized imagearray, see cameradriver_imagecache.cpp
+#define	kImageCache_Entries		4
+#define	kImageCache_JSON		-1			//*	format, otherwise the imagebytes TransmissionElementType
+
+typedef struct	//	TYPE_IMAGEARRAY_CACHE
+{
+	long		frameNumber;		//*	cFramesRead it was made from
+	int			format;
+	int			variant;			//*	what else the bytes depend on (element type, packing)
+	uint8_t		*dataPtr;			//*	malloc'd
+	size_t		dataLen;
+	long		hitCount;
+	long		lastUse;
+	int			refCnt;				//*	clients sending it, +1 while it is in the cache
+	char		entityTag[80];		//*	imagebytes only, empty for JSON
+	time_t		resumeUntil;		//*	kept after the next frame until then, for a resumed download
+} TYPE_IMAGEARRAY_CACHE;
+
+size_t	ImageCache_Write(const int socketFD, const uint8_t *dataPtr, const size_t dataLen);
+
+//*****************************************************************************
+//*	MJPEG live stream, see cameradriver_mjpeg.cpp
+#define	kMJPEG_MaxClients		8
+
+typedef struct	//	TYPE_MJPEG_FRAME
+{
+	uint8_t		*dataPtr;			//*	multipart header, JPEG, CRLF
+	size_t		dataLen;
+	long		frameSeq;
+	int			refCnt;				//*	clients sending it, +1 while it is the newest
+} TYPE_MJPEG_FRAME;
+
+typedef struct	//	TYPE_MJPEG_CLIENT
+{
+	int					socketFD;			//*	-1 = slot not used
+	char				ipAddress[48];
+	TYPE_MJPEG_FRAME	*frame;				//*	being sent, NULL = waiting for the next one
+	size_t				sendOffset;
+	long				lastFrameSeq;
+	long				framesSent;
+	long				framesDropped;		//*	newer frames arrived while this one was being sent
+} TYPE_MJPEG_CLIENT;
+
+
 
 //**************************************************************************************
 //*	image flip, this is the ZWO definition, we will adopt that
@@ -364,10 +708,15 @@ class CameraDriver: public AlpacaDriver
 		int					BuildBinaryImage_Raw8_16bit(	unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
 		int					BuildBinaryImage_Raw8_32bit(	unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
 		int					BuildBinaryImage_Raw16(			unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
+		int					BuildBinaryImage_Raw16Packed(	unsigned char	*binaryDataBuffer, int startOffset, int bufferSize, int bitsPerPixel, int shift);
 		int					BuildBinaryImage_Raw32(			unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
 		int					BuildBinaryImage_RGB24(			unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
-		int					BuildBinaryImage_RGB24_32bit(	uint32_t		*binaryDataBuffer, int startOffset, int bufferSize);
+		int					BuildBinaryImage_RGB24_32bit(	unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
 		int					BuildBinaryImage_RGBx16(		unsigned char	*binaryDataBuffer, int startOffset, int bufferSize);
+		uint8_t				*BuildImageBytesResponse(		const unsigned char			*imageData,
+															const TYPE_IMAGE_ROI_Info	*roiInfo,
+															const bool					alpacaPiClient,
+															size_t						*responseLen);
 
 		//-------------------------------------------------------------------------------------------------
 		//*	Added by MLS
@@ -424,6 +773,39 @@ class CameraDriver: public AlpacaDriver
 		TYPE_ASCOM_STATUS	Put_Filenameoptions(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
 
 		TYPE_ASCOM_STATUS	Get_RGBarray(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_LiveStack(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_LiveStack(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_StackedImage(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_Calibration(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_Calibration(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_BuildCalibMaster(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_BuildCalibMaster(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_HotPixels(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_HotPixels(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Put_BuildHotPixelMap(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_StarAnalysis(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_StarAnalysis(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_AutoFocus(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_AutoFocus(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_PlateSolve(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_PlateSolve(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_Demosaic(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_Demosaic(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_ImageEncode(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_ImageEncode(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		//*	only the simulator has settings, see cameradriver_sim.cpp
+		virtual	TYPE_ASCOM_STATUS	Get_Simulator(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		virtual	TYPE_ASCOM_STATUS	Put_Simulator(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_Overlay(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_Overlay(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_PipelineTiming(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_PipelineTiming(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_ImageIndex(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Get_SoftBinning(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		TYPE_ASCOM_STATUS	Put_SoftBinning(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_Preview(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_MJPEGstream(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+		TYPE_ASCOM_STATUS	Get_ImageStats(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
 		TYPE_ASCOM_STATUS	Get_Readall(			TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
 
 		//*	these are borrowed from the telescope device
@@ -509,7 +891,9 @@ class CameraDriver: public AlpacaDriver
 			#ifdef _ENABLE_JPEGLIB_
 				void	SaveUsingJpegLib(void);
 			#endif	//	_ENABLE_JPEGLIB_
+			#ifdef _ENABLE_PNGLIB_
 				void	SaveUsingPNGlib(void);
+			#endif	//	_ENABLE_PNGLIB_
 
 				void	AutoAdjustExposure(void);
 				void	CheckPulseGuiding(void);
@@ -540,11 +924,26 @@ class CameraDriver: public AlpacaDriver
 		void			Draw3TextStrings(		cv::Mat *theImage, const char *textStr1, const char *textStr2, const char *textStr3);
 	#else
 		void			DrawSidebar(			IplImage *imageDisplay);
+		void			DrawSidebarLine(		IplImage	*imageDisplay,
+												const int	lineIdx,
+												const int	xLoc,
+												const int	yLoc,
+												const int	lineWidth,
+												const char	*label,
+												const char	*value);
 		void			CreateHistogramGraph(	IplImage *imageDisplay);
 		void			SetOpenCVcolors(		IplImage *imageDisplay);
 		void			Draw3TextStrings(		IplImage *theImage, const char *textStr1, const char *textStr2, const char *textStr3);
 	#endif // _USE_OPENCV_CPP_
 
+		bool			DisplayPyramid_Build(	const uint8_t	*srcPixels,
+												const int		width,
+												const int		height,
+												const int		srcRowBytes,
+												const int		channels,
+												const int		bytesPerSample,
+												const int		levelCount);
+		void			DisplayPyramid_Free(void);
 	#endif	//	_USE_OPENCV_
 		//*****************************************************************************
 		//*	image analysis routines
@@ -692,6 +1091,7 @@ protected:
 	bool				cNewImageReadyToDisplay;
 	long				cCameraDataBuffLen;
 	unsigned char		*cCameraDataBuffer;
+	TYPE_FRAME_BUFFER	cCameraDataAlloc;			//*	how cCameraDataBuffer was allocated
 	unsigned char		*cCameraBGRbuffer;			//*	Blue, Green, Red, for FITS
 
 	int					cAVIfourCC;					//*	the fourCC mode used in the avi file
@@ -712,6 +1112,7 @@ protected:
 	bool				cSaveAllImages;
 	long				cWorkingLoopCnt;
 	long				cFramesRead;
+	long				cFramesProcessed;			//*	cFramesRead of the last frame that is completely processed
 	double				cFrameRate;					//*	primarily used in live mode
 	//*****************************************************************************
 	bool				cSaveAsFITS;
@@ -764,6 +1165,7 @@ protected:
 #else
 	IplImage			*cOpenCV_ImagePtr;
 	IplImage			*cOpenCV_LiveDisplayPtr;
+	IplImage			*cOpenCV_LiveSmallPtr;		//*	mono image at display size, before the gray to color conversion
 	IplImage			*cOpenCV_Histogram;
 	CvVideoWriter		*cOpenCV_videoWriter;
 #endif // _USE_OPENCV_CPP_
@@ -781,6 +1183,15 @@ protected:
 	const static int	cSideFrameWidth	=	16;
 	int					cLiveDisplayWidth;
 	int					cLiveDisplayHeight;
+
+	//*	the live window is made from the smallest pyramid level that is not smaller than the display
+	TYPE_PYRAMID_LEVEL	cDisplayPyramid[kDisplayPyramid_Levels];
+	int					cDisplayPyramidLevel;
+	//*	what is on the sidebar now, a line is only redrawn when its text changes
+	bool				cSideBarValid;
+	char				cSideBarText[kSideBar_MaxLines][80];
+	int32_t				cSideBarHistogram[4][256];
+	uint8_t				cSideBarHistMax[4];
 	bool				cDisplayCrossHairs;
 	int					cCrossHairX;
 	int					cCrossHairY;
@@ -849,7 +1260,9 @@ public:
 	//*****************************************************************************
 	//*	image analysis data
 	void		CalculateHistogramArray(void);
+	void		CalculateHistogramArray(const void *imageData, const int32_t imageDataLen, const int imageType);
 	void		SaveHistogramFile(void);
+	long		cHistogramFrame;		//*	cFramesRead when the histogram was calculated
 
 	int32_t		cHistogramLum[256];
 	int32_t		cHistogramRed[256];
@@ -874,6 +1287,308 @@ public:
 	uint8_t		cOverlayPosition;
 	uint8_t		cOverlayColor;
 	void		DrawOverlayOntoImage(void);
+	void		Overlay_DrawDirect(const char *overlayString);
+	bool		Overlay_DrawCached(const char segmentList[][128], const int segmentCnt);
+	bool		Overlay_RenderTile(TYPE_OVERLAY_TILE *tile, const char *text, const int textX);
+	void		Overlay_FreeTiles(void);
+	void		Overlay_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	bool				cOverlayCacheEnabled;
+	TYPE_OVERLAY_TILE	cOverlayTiles[kOverlay_MaxTiles];
+	uint32_t			cOverlayLast_us;
+	uint32_t			cOverlayDirectAvg_us;		//*	running averages, to compare the two
+	uint32_t			cOverlayCachedAvg_us;
+	uint32_t			cOverlayTileRenders;
+
+	//===========================================================================
+	//*	Live stacking, see cameradriver_stack.cpp
+	void				LiveStack_Reset(void);
+	void				LiveStack_AddFrame(void);
+	bool				LiveStack_AllocateBuffers(void);
+	void				LiveStack_FreeBuffers(void);
+	int					LiveStack_FindStars(void);
+	bool				LiveStack_Register(int *deltaX, int *deltaY);
+	bool				LiveStack_Centroid(int peakX, int peakY, TYPE_STACK_STAR *starInfo);
+	uint32_t			LiveStack_GetPixel(int xxx, int yyy);
+	void				LiveStack_RenderOutput(unsigned char *outputPtr);
+	void				LiveStack_SendJSON(	TYPE_GetPutRequestData		*reqData,
+											unsigned char				*stackImage,
+											const TYPE_IMAGE_ROI_Info	*stackROIinfo,
+											const int					stackFrameCnt);
+
+	bool				cLiveStackEnabled;
+	TYPE_LIVESTACK_MODE	cLiveStackMode;
+	double				cLiveStackSigma;			//*	rejection threshold for sigma clip mode
+	int					cLiveStackFrameCnt;			//*	number of frames in the accumulator
+	int					cLiveStackRejectCnt;		//*	frames that could not be registered
+	TYPE_IMAGE_ROI_Info	cLiveStackROIinfo;			//*	geometry of the frames in the accumulator
+	long				cLiveStackElementCnt;		//*	values per frame (pixels * channels)
+	long				cLiveStackAllocCnt;			//*	values allocated in the buffers
+	double				*cLiveStackSum;
+	double				*cLiveStackSumSq;			//*	only used for sigma clip
+	pthread_mutex_t		cLiveStackMutex;			//*	the accumulator and the counts
+	int					cLiveStackRefCnt;
+	TYPE_STACK_STAR		cLiveStackRefStars[kLiveStackMaxStars];
+	int					cLiveStackLastDeltaX;
+	int					cLiveStackLastDeltaY;
+	uint32_t			cLiveStackLastAdd_ms;		//*	time it took to add the last frame
+
+	//===========================================================================
+	//*	Calibration, see cameradriver_calib.cpp
+	void				Calibration_ProcessFrame(const bool autoFocusFrame);
+	void				Calibration_ApplyToFrame(void);
+	void				Calibration_FillHeader(TYPE_CALIB_HEADER *calibHeader, TYPE_CALIB_MASTER masterType);
+	bool				Calibration_FindMasters(void);
+	bool				Calibration_LoadMaster(TYPE_CALIB_MASTER masterType, const char *fileName);
+	void				Calibration_ReleaseMaster(TYPE_CALIB_MASTER masterType);
+	void				Calibration_BuildAddFrame(void);
+	bool				Calibration_BuildFinish(void);
+
+	bool					cCalibrationEnabled;
+	TYPE_CALIB_MASTER_INFO	cCalibMaster[kCalibMaster_last];
+	TYPE_CALIB_HEADER		cCalibLookupKey;			//*	settings used for the last master lookup
+	uint32_t				cCalibLastApply_ms;
+	//*	building of masters
+	bool					cCalibBuildActive;
+	TYPE_CALIB_MASTER		cCalibBuildType;
+	int						cCalibBuildFramesReq;
+	TYPE_CALIB_HEADER		cCalibBuildHeader;
+	double					*cCalibBuildSum;
+	long					cCalibBuildAllocCnt;
+	char					cCalibBuildStatus[64];
+	pthread_mutex_t			cCalibMutex;				//*	between the commands and the state machine
+
+	//===========================================================================
+	//*	Hot pixel map, see cameradriver_hotpixel.cpp
+	void				HotPixel_FillHeader(TYPE_HOTPIXEL_HEADER *hotPixelHeader);
+	bool				HotPixel_FindMap(void);
+	void				HotPixel_FreeMap(void);
+	void				HotPixel_DetectFromFrame(void);
+	void				HotPixel_CorrectFrame(void);
+	bool				HotPixel_IsDefect(uint32_t pixelIndex);
+
+	bool					cHotPixelEnabled;
+	bool					cHotPixelDetectPending;		//*	the next frame is a dark to build the map from
+	double					cHotPixelSigma;
+	TYPE_HOTPIXEL_HEADER	cHotPixelHeader;			//*	header of the map in cHotPixelList
+	TYPE_HOTPIXEL_HEADER	cHotPixelLookupKey;			//*	settings used for the last map lookup
+	uint32_t				*cHotPixelList;
+	uint32_t				cHotPixelLastCorrect_ms;
+
+	//===========================================================================
+	//*	Star detection / HFR / FWHM, see cameradriver_stars.cpp
+	bool				StarAnalysis_ProcessFrame(void);
+	double				StarAnalysis_GetPixelScale(void);
+	void				StarAnalysis_OutputReadall(TYPE_GetPutRequestData *reqData);
+#ifdef _ENABLE_FITS_
+	void				StarAnalysis_WriteFITS(fitsfile *fitsFilePtr);
+#endif
+
+	bool				cStarAnalysisEnabled;
+	double				cStarSigma;					//*	detection threshold
+	TYPE_STAR_RESULTS	*cStarResults;				//*	allocated on first use
+
+	//===========================================================================
+	//*	Autofocus, see cameradriver_autofocus.cpp
+	bool				AutoFocus_IsActive(void);
+	int32_t				AutoFocus_RunStateMachine(void);
+	bool				AutoFocus_FrameRead(void);
+	void				AutoFocus_FrameMeasured(void);
+	bool				AutoFocus_MoveFocuser(const int32_t newPosition);
+	bool				AutoFocus_FocuserArrived(void);
+	bool				AutoFocus_FitCurve(void);
+	void				AutoFocus_MoveToFinal(const int32_t finalPosition, TYPE_AUTOFOCUS_STATE finalState);
+	void				AutoFocus_Finish(TYPE_AUTOFOCUS_STATE finalState, const char *statusMsg);
+	void				AutoFocus_OutputStatus(TYPE_GetPutRequestData *reqData);
+	void				AutoFocus_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	TYPE_AUTOFOCUS_STATE	cAutoFocusState;
+	TYPE_AUTOFOCUS_STATE	cAutoFocusFinalState;		//*	state to go to after the last move
+	TYPE_AUTOFOCUS_SAMPLE	cAutoFocusSamples[kAutoFocusMaxSamples];
+	int						cAutoFocusSampleCnt;
+	int						cAutoFocusSampleIdx;		//*	next sample to expose
+	int						cAutoFocusMeasureIdx;		//*	sample being analyzed
+	int32_t					cAutoFocusStepSize;
+	int32_t					cAutoFocusBacklash;
+	int32_t					cAutoFocusExposure_us;
+	int32_t					cAutoFocusSavedExposure_us;	//*	restored when done
+	int32_t					cAutoFocusStartPosition;	//*	returned to if the fit fails
+	int32_t					cAutoFocusFinalPosition;
+	int32_t					cAutoFocusTarget;			//*	position of the current move
+	uint32_t				cAutoFocusStateStart_ms;
+	int32_t					cAutoFocusBestPosition;
+	double					cAutoFocusBestHFR;
+	double					cAutoFocusFitQuality;		//*	R squared of the hyperbola fit
+	char					cAutoFocusStatusMsg[80];
+
+	//===========================================================================
+	//*	Plate solving, see cameradriver_platesolve.cpp
+	bool				PlateSolve_ProcessFrame(void);
+	void				PlateSolve_OutputReadall(TYPE_GetPutRequestData *reqData);
+#ifdef _ENABLE_FITS_
+	void				PlateSolve_WriteFITS(fitsfile *fitsFilePtr);
+#endif
+
+	bool					cPlateSolveEnabled;
+	double					cPlateSolveScale_arcsec;	//*	0 = from the telescope info
+	TYPE_PLATESOLVE_RESULT	cPlateSolveResult;
+
+	//===========================================================================
+	//*	Bayer demosaic, see cameradriver_demosaic.cpp
+	bool				Demosaic_IsActive(const TYPE_IMAGE_TYPE imageType);
+	int					Demosaic_OutputBytesPerPixel(const TYPE_IMAGE_TYPE imageType);
+	bool				Demosaic_Frame(	const unsigned char		*srcPtr,
+										unsigned char			*dstPtr,
+										const int				width,
+										const int				height,
+										const int				dstRowBytes,
+										const TYPE_IMAGE_TYPE	imageType);
+	void				Demosaic_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	bool				cDemosaicEnabled;
+	int					cDemosaicMethod;			//*	kDemosaic_Bilinear or kDemosaic_EdgeAware
+	bool				cDemosaicRGB48;				//*	RAW16 goes to RGB48 instead of RGB24
+	int					cDemosaicPattern;			//*	-1 = from the camera (cBayerPattern)
+	uint32_t			cDemosaicLast_ms;
+
+	//===========================================================================
+	//*	JPEG/PNG encoding, see cameradriver_encode.cpp
+	void				ImageEncode_SetupRawImage(TYPE_ENCODE_IMAGE *encodeImage);
+	bool				ImageEncode_SaveFile(	const TYPE_ENCODE_IMAGE	*encodeImage,
+												const char				*imageFilePath,
+												const bool				saveAsPNG);
+	void				ImageEncode_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	bool				cImageEncodeFast;			//*	false = the original OpenCV/libjpeg output
+	TYPE_ENCODE_OPTIONS	cImageEncodeOptions;
+	uint32_t			cJpegEncode_ms;
+	uint32_t			cPngEncode_ms;
+
+	//===========================================================================
+	//*	Capture pipeline timing, see cameradriver_timing.cpp
+	void					PipelineTiming_Reset(void);
+	void					PipelineTiming_ExposureStart(void);
+	void					PipelineTiming_StageDone(const int stage, const uint64_t stageStart_us);
+	void					PipelineTiming_Delivered(const uint64_t serializeStart_us, const uint64_t sendStart_us);
+	int						PipelineTiming_GetPercentiles(const int stage, uint32_t *p50, uint32_t *p90, uint32_t *p99, uint32_t *maxValue);
+	void					PipelineTiming_OutputReadall(TYPE_GetPutRequestData *reqData);
+	void					PipelineTiming_OutputHTML(TYPE_GetPutRequestData *reqData);
+
+	TYPE_PIPELINE_TIMING	cPipeTiming[kPipelineTiming_RingSize];
+	int						cPipeTimingIdx;			//*	record of the frame in the pipeline now
+	long					cPipeTimingCount;		//*	total number of records started
+
+	//===========================================================================
+	//*	Saved image metadata index, see cameradriver_imageindex.cpp
+	void					ImageIndex_AddSavedImage(void);
+	void					ImageIndex_CalculateStats(int32_t *minPixel, int32_t *maxPixel, float *meanPixel, float *saturationPct);
+
+	//===========================================================================
+	//*	Software binning and sub frames, see cameradriver_softbin.cpp
+	void					SoftBin_Enable(void);
+	void					SoftBin_ProcessFrame(void);
+	void					SoftBin_OutputReadall(TYPE_GetPutRequestData *reqData);
+	void					GetLastFrameSize(int *width, int *height);
+
+	bool					cSoftBinEnabled;		//*	the camera returns the full sensor, bin and crop it here
+	int						cSoftBinMode;			//*	kBinMode_Sum or kBinMode_Average
+	TYPE_FRAME_BUFFER		cSoftBinPool;			//*	binned output, kept from frame to frame
+	uint32_t				cSoftBinLast_ms;
+
+	//===========================================================================
+	//*	Server side preview, see cameradriver_preview.cpp
+	TYPE_ASCOM_STATUS		Preview_Build(const int maxWidth, const int stretchMode, const int format, const int quality, char *alpacaErrMsg);
+	void					Preview_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	TYPE_PREVIEW_CACHE		cPreviewCache;
+	uint8_t					*cPreviewScratch[2];	//*	reduction passes alternate between these
+	size_t					cPreviewScratchSize[2];
+	uint32_t				cPreviewLast_ms;
+	long					cPreviewCacheHits;
+
+	//===========================================================================
+	//*	Full resolution image statistics, see cameradriver_imagestats.cpp
+	TYPE_ASCOM_STATUS		ImageStats_Calculate(int roiX, int roiY, int roiWidth, int roiHeight, char *alpacaErrMsg);
+
+	TYPE_IMAGE_STATS		cImageStats;
+
+	//===========================================================================
+	//*	Serialized imagearray cache, see cameradriver_imagecache.cpp
+	void					ImageCache_Invalidate(void);
+	TYPE_IMAGEARRAY_CACHE	*ImageCache_Find(const int format, const int variant);
+	TYPE_IMAGEARRAY_CACHE	*ImageCache_FindResume(const char *htmlData);
+	void					ImageCache_KeepForResume(const char *entityTag);
+	void					ImageCache_Release(TYPE_IMAGEARRAY_CACHE *cacheEntry);
+	void					ImageCache_Remove(const int entryIdx);
+	int						ImageCache_FindOldest(const bool olderFrames);
+	bool					ImageCache_Store(	const long	frameNumber,
+												const int	format,
+												const int	variant,
+												const char	*entityTag,
+												uint8_t		*dataPtr,
+												const size_t dataLen);
+	uint8_t					*ImageCache_BuildJSON(size_t *textLen);
+	void					ImageCache_OutputReadall(TYPE_GetPutRequestData *reqData);
+	void					ImageCache_GetEntityTag(const int format, const int variant, char *entityTag);
+	bool					ImageCache_SendResponse(TYPE_GetPutRequestData	*reqData,
+													const uint8_t			*responsePtr,
+													const size_t			responseLen,
+													const char				*entityTag);
+
+	pthread_mutex_t			cImageCacheMutex;		//*	the table, the reference counts and the totals
+	TYPE_IMAGEARRAY_CACHE	*cImageCache[kImageCache_Entries];
+	size_t					cImageCacheBytes;
+	long					cImageCacheHits;
+	long					cImageCacheMisses;
+	long					cImageRangeRequests;	//*	partial (206) imagebytes responses
+
+	//===========================================================================
+	//*	MJPEG live stream, see cameradriver_mjpeg.cpp
+	void					MJPEG_SubmitCurrentFrame(void);
+	void					MJPEG_SubmitFrame(const uint8_t *pixels, int width, int height, const int channels, const int bytesPerValue);
+	void					MJPEG_RunThread(void);
+	void					MJPEG_EncodeFrame(void);
+	void					MJPEG_ReleaseFrame(TYPE_MJPEG_FRAME *frame);
+	void					MJPEG_CloseClient(TYPE_MJPEG_CLIENT *client);
+	void					MJPEG_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	pthread_mutex_t			cMJPEGmutex;			//*	clients, newest frame and the hand off
+	pthread_t				cMJPEGthreadID;
+	bool					cMJPEGthreadRunning;
+	int						cMJPEGwakePipe[2];		//*	wakes the stream thread when a frame is handed off
+	TYPE_MJPEG_CLIENT		cMJPEGclients[kMJPEG_MaxClients];
+	int						cMJPEGclientCnt;
+	TYPE_MJPEG_FRAME		*cMJPEGframe;			//*	newest encoded frame
+	long					cMJPEGframeSeq;
+
+	//*	the reduced frame handed off by the acquisition loop, owned by the
+	//*	stream thread while cMJPEGinputPending is true
+	bool					cMJPEGinputPending;
+	const uint8_t			*cMJPEGinputPtr;
+	int						cMJPEGinputWidth;
+	int						cMJPEGinputHeight;
+	int						cMJPEGinputChannels;
+	int						cMJPEGinputBytesPerValue;
+	long					cMJPEGinputFrameNum;
+	uint8_t					*cMJPEGscratch[2];
+	size_t					cMJPEGscratchSize[2];
+
+	//*	settings, the most recent client sets them for all of them
+	int						cMJPEGmaxWidth;
+	int						cMJPEGstretch;
+	int						cMJPEGquality;
+	long					cMJPEGframesEncoded;
+	long					cMJPEGframesSkipped;	//*	arrived while the encoder was still busy
+	uint32_t				cMJPEGencode_ms;
+
+	//===========================================================================
+	//*	compressed imagebytes, see cameradriver_deflate.cpp
+	uint8_t					*ImageBytes_Deflate(const uint8_t *payloadPtr, const size_t payloadLen, size_t *responseLen);
+	void					ImageBytes_OutputReadall(TYPE_GetPutRequestData *reqData);
+
+	long					cDeflateCount;
+	double					cDeflateRatio;			//*	of the last image sent compressed
+	uint32_t				cDeflate_ms;
 
 	//===========================================================================
 	//*	GPS info
@@ -45,6 +45,7 @@
 //*	Jan 12,	2020	<MLS> Added better limit checking to AutoAdjustExposure()
 //*	Feb 15,	2020	<MLS> Fixed negative exposure bug in AutoAdjustExposure()
 //*	Apr 22,	2024	<MLS> Added support for kImageType_MONO8 (8 bit image type)
+//*	Oct 19,	2026	<MLS> CalculateHistogramArray() can now work on any buffer (live window pyramid)
 //**************************************************************************
 
 #ifdef _ENABLE_CAMERA_
@@ -548,7 +549,28 @@ long			exposureAdjustment_us;	//*	micro-seconds
 //*****************************************************************************
 void	CameraDriver::CalculateHistogramArray(void)
 {
-int32_t			imageDataLen;
+	if (cCameraDataBuffer != NULL)
+	{
+		//*	figure out what type of image it is
+		GetImage_ROI_info();
+		CalculateHistogramArray(cCameraDataBuffer,
+								(cCameraProp.CameraXsize * cCameraProp.CameraYsize),
+								cROIinfo.currentROIimageType);
+	}
+	else
+	{
+		CONSOLE_DEBUG("cCameraDataBuffer is NULL");
+	}
+}
+
+//*****************************************************************************
+//*	the live window uses this with a reduced size copy of the image,
+//*	the shape of the histogram is the same, only the counts are smaller
+//*****************************************************************************
+void	CameraDriver::CalculateHistogramArray(	const void		*imageData,
+												const int32_t	imageDataLen,
+												const int		imageType)
+{
 int32_t			currPixValue;
 int32_t			iii;
 int32_t			ccc;
@@ -567,9 +589,7 @@ bool			lookingForMin;
 	CONSOLE_DEBUG(__FUNCTION__);
 	START_TIMING();
 
-	imageDataLen	=	cCameraProp.CameraXsize * cCameraProp.CameraYsize;
-
-	if (cCameraDataBuffer != NULL)
+	if (imageData != NULL)
 	{
 		cPeakHistogramValue	=	0;
 		cMaxHistogramValue	=	0;
@@ -585,14 +605,12 @@ bool			lookingForMin;
 		memset(cHistogramGrn,	0,	sizeof(cHistogramGrn));
 		memset(cHistogramBlu,	0,	sizeof(cHistogramBlu));
 
-		//*	figure out what type of image it is
-		GetImage_ROI_info();
-		switch(cROIinfo.currentROIimageType)
+		switch(imageType)
 		{
 			case kImageType_RAW8:
 			case kImageType_MONO8:
 			case kImageType_Y8:
-				imageDataPtr8bit	=	(uint8_t *)cCameraDataBuffer;
+				imageDataPtr8bit	=	(uint8_t *)imageData;
 				for (iii=0; iii<imageDataLen; iii++)
 				{
 					currPixValue	=	imageDataPtr8bit[iii] & 0x00ff;
@@ -607,7 +625,7 @@ bool			lookingForMin;
 				break;
 
 			case kImageType_RAW16:
-				imageDataPtr16bit	=	(uint16_t *)cCameraDataBuffer;
+				imageDataPtr16bit	=	(uint16_t *)imageData;
 				for (iii=0; iii<imageDataLen; iii++)
 				{
 					//*	for 16 bit data, we shift it right 8 bits
@@ -619,7 +637,7 @@ bool			lookingForMin;
 
 
 			case kImageType_RGB24:
-				imageDataPtr8bit	=	(uint8_t *)cCameraDataBuffer;
+				imageDataPtr8bit	=	(uint8_t *)imageData;
 				ccc					=	0;
 				for (iii=0; iii<imageDataLen; iii++)
 				{
@@ -715,11 +733,13 @@ bool			lookingForMin;
 			}
 		}
 
+		cHistogramFrame	=	cFramesRead;
+
 		DEBUG_TIMING("Time to save calculate histogram file (milliseconds)\t=");
 	}
 	else
 	{
-		CONSOLE_DEBUG("cCameraDataBuffer is NULL");
+		CONSOLE_DEBUG("imageData is NULL");
 	}
 }
 
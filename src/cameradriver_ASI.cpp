@@ -84,6 +84,7 @@
 //*	Apr 30,	2023	<MLS> Added Read_SensorTargetTemp() & Write_SensorTargetTemp()
 //*	Sep  9,	2023	<MLS> Moved read thread stuff to parent class
 //*	Sep  9,	2023	<MLS> Deleted _USE_THREADS_FOR_ASI_CAMERA_
+//*	Oct 19,	2026	<MLS> Video frames are handed to the MJPEG stream
 //*****************************************************************************
 //*	Length: unspecified [text/plain]
 //*	Saving to: "imagearray.1"
@@ -1014,6 +1015,16 @@ int					bytesPerRow;
 		{
 
 			cNumVideoFramesSaved++;
+			//*	the MJPEG stream wants contiguous 8 bit rows
+			if ((cMJPEGclientCnt > 0) && (bytesPerRow == (cOpenCV_ImagePtr->cols * bytesPerPixel)) &&
+				(cOpenCV_ImagePtr->elemSize1() == 1))
+			{
+				MJPEG_SubmitFrame(	cOpenCV_ImagePtr->data,
+									cOpenCV_ImagePtr->cols,
+									cOpenCV_ImagePtr->rows,
+									cOpenCV_ImagePtr->channels(),
+									1);
+			}
 //#define _DEBUG_VIDEO_
 		#ifdef _DEBUG_VIDEO_
 			char	imageFilePath[64];
@@ -1230,6 +1241,16 @@ bool			timeToStop;
 		{
 
 			cNumVideoFramesSaved++;
+			//*	the MJPEG stream wants contiguous 8 bit rows
+			if ((cMJPEGclientCnt > 0) && (cOpenCV_ImagePtr->depth == IPL_DEPTH_8U) &&
+				(cOpenCV_ImagePtr->widthStep == (cOpenCV_ImagePtr->width * cOpenCV_ImagePtr->nChannels)))
+			{
+				MJPEG_SubmitFrame(	(uint8_t *)cOpenCV_ImagePtr->imageData,
+									cOpenCV_ImagePtr->width,
+									cOpenCV_ImagePtr->height,
+									cOpenCV_ImagePtr->nChannels,
+									1);
+			}
 //#define _DEBUG_VIDEO_
 		#ifdef _DEBUG_VIDEO_
 			char	imageFilePath[64];
@@ -48,6 +48,7 @@
 //*	Sep  8,	2023	<MLS> Added CheckColorCamOptions()
 //*	Sep 23,	2023	<MLS> Fixed bug interpreting camera temperature availability
 //*	Sep 26,	2023	<MLS> Added closing of QHY camera to class destructor
+//*	Oct 19,	2026	<MLS> CheckColorCamOptions() sets cBayerPattern for the demosaic
 //*----------------------------------------------------------------------------
 //*	Oct 10,	2122	<TODO> Add support for percentcompleted to QHY camera driver
 //*****************************************************************************
@@ -919,6 +920,13 @@ uint32_t	qhyRetCode;
 		if (qhyRetCode == BAYER_GB || qhyRetCode == BAYER_GR || qhyRetCode == BAYER_BG || qhyRetCode == BAYER_RG)
 		{
 			CONSOLE_DEBUG("This is a color camera.");
+			switch(qhyRetCode)
+			{
+				case BAYER_GB:	cBayerPattern	=	kBAYER_PAT_GB;	break;
+				case BAYER_GR:	cBayerPattern	=	kBAYER_PAT_GR;	break;
+				case BAYER_BG:	cBayerPattern	=	kBAYER_PAT_BG;	break;
+				default:		cBayerPattern	=	kBAYER_PAT_RG;	break;
+			}
 		//	printf("even this is a color camera, in Single Frame mode THE SDK ONLY SUPPORT RAW OUTPUT.So please do not set SetQHYCCDDebayerOnOff() to true;");
 			qhyRetCode	=	SetQHYCCDDebayerOnOff(cQHYcamHandle, true);
 			CONSOLE_DEBUG_W_NUM("qhyRetCode\t=", qhyRetCode);
@@ -0,0 +1,895 @@
+//**************************************************************************
+//*	Name:			cameradriver_autofocus.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Closed loop autofocus using the focuser in this driver
+//*
+//*					The focuser is stepped through a series of positions (a V curve),
+//*					one frame is taken at each position and the median HFR is
+//*					measured by the star analysis (cameradriver_stars.cpp).
+//*					A hyperbola is fit to the HFR values and the focuser is sent
+//*					to the vertex of the hyperbola.
+//*
+//*					All moves are made in the same direction (increasing), the focuser
+//*					is first sent below the starting position by the backlash amount.
+//*
+//*					The move to the next position is started as soon as a frame has been
+//*					read out, the star analysis of that frame runs while the focuser moves.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_autofocus.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<math.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"star_analysis.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+
+//*****************************************************************************
+static const char	*gAutoFocusStateNames[]	=
+{
+	"Idle",
+	"Backlash",
+	"Moving",
+	"Exposing",
+	"Measuring",
+	"BacklashToFinal",
+	"MovingToFinal",
+	"Complete",
+	"Failed",
+	"Aborted",
+};
+
+//*****************************************************************************
+//*	Gaussian elimination with partial pivoting
+//*****************************************************************************
+static bool	Solve3x3(double matrix[3][3], double vector[3], double result[3])
+{
+int		iii;
+int		jjj;
+int		kkk;
+int		pivotRow;
+double	factor;
+double	temp;
+
+	for (iii=0; iii<3; iii++)
+	{
+		pivotRow	=	iii;
+		for (jjj=iii+1; jjj<3; jjj++)
+		{
+			if (fabs(matrix[jjj][iii]) > fabs(matrix[pivotRow][iii]))
+			{
+				pivotRow	=	jjj;
+			}
+		}
+		if (fabs(matrix[pivotRow][iii]) < 1.0e-12)
+		{
+			return(false);
+		}
+		if (pivotRow != iii)
+		{
+			for (kkk=0; kkk<3; kkk++)
+			{
+				temp					=	matrix[iii][kkk];
+				matrix[iii][kkk]		=	matrix[pivotRow][kkk];
+				matrix[pivotRow][kkk]	=	temp;
+			}
+			temp				=	vector[iii];
+			vector[iii]			=	vector[pivotRow];
+			vector[pivotRow]	=	temp;
+		}
+		for (jjj=iii+1; jjj<3; jjj++)
+		{
+			factor	=	matrix[jjj][iii] / matrix[iii][iii];
+			for (kkk=iii; kkk<3; kkk++)
+			{
+				matrix[jjj][kkk]	-=	factor * matrix[iii][kkk];
+			}
+			vector[jjj]	-=	factor * vector[iii];
+		}
+	}
+	for (iii=2; iii>=0; iii--)
+	{
+		temp	=	vector[iii];
+		for (kkk=iii+1; kkk<3; kkk++)
+		{
+			temp	-=	matrix[iii][kkk] * result[kkk];
+		}
+		result[iii]	=	temp / matrix[iii][iii];
+	}
+	return(true);
+}
+
+//*****************************************************************************
+static double	HyperbolaValue(const double params[3], const double xValue)
+{
+double	uuu;
+
+	uuu	=	(xValue - params[2]) / params[1];
+	return(params[0] * sqrt(1.0 + (uuu * uuu)));
+}
+
+//*****************************************************************************
+static double	HyperbolaError(const double params[3], const double *xValues, const double *yValues, const int count)
+{
+int		iii;
+double	delta;
+double	sumSquares;
+
+	sumSquares	=	0.0;
+	for (iii=0; iii<count; iii++)
+	{
+		delta		=	yValues[iii] - HyperbolaValue(params, xValues[iii]);
+		sumSquares	+=	delta * delta;
+	}
+	return(sumSquares);
+}
+
+//*****************************************************************************
+//*	hfr = a * sqrt(1 + ((x - c) / b)^2),	params = {a, b, c}
+//*
+//*	hfr^2 is a parabola in x, a weighted parabola fit of hfr^2 gives the
+//*	starting values, Levenberg-Marquardt then fits the hyperbola to the hfr values
+//*****************************************************************************
+static bool	FitHyperbola(const double *xValues, const double *yValues, const int count, double params[3])
+{
+int		iii;
+int		jjj;
+int		kkk;
+int		loopCnt;
+double	matrix[3][3];
+double	vector[3];
+double	poly[3];
+double	sumsX[5];
+double	sumsXY[3];
+double	weight;
+double	xPower;
+double	ySquared;
+double	aSquared;
+double	minY;
+double	lambda;
+double	currentError;
+double	trialError;
+double	trialParams[3];
+double	deriv[3];
+double	delta[3];
+double	uuu;
+double	sss;
+double	residual;
+
+	//*	weighted least squares parabola fit of hfr^2
+	memset(sumsX,	0,	sizeof(sumsX));
+	memset(sumsXY,	0,	sizeof(sumsXY));
+	minY	=	yValues[0];
+	for (iii=0; iii<count; iii++)
+	{
+		ySquared	=	yValues[iii] * yValues[iii];
+		weight		=	1.0 / ySquared;
+		xPower		=	1.0;
+		for (kkk=0; kkk<5; kkk++)
+		{
+			sumsX[kkk]	+=	weight * xPower;
+			if (kkk < 3)
+			{
+				sumsXY[kkk]	+=	weight * ySquared * xPower;
+			}
+			xPower	*=	xValues[iii];
+		}
+		if (yValues[iii] < minY)
+		{
+			minY	=	yValues[iii];
+		}
+	}
+	for (iii=0; iii<3; iii++)
+	{
+		for (jjj=0; jjj<3; jjj++)
+		{
+			matrix[iii][jjj]	=	sumsX[iii + jjj];
+		}
+		vector[iii]	=	sumsXY[iii];
+	}
+	if (Solve3x3(matrix, vector, poly) == false)
+	{
+		return(false);
+	}
+	if (poly[2] <= 0.0)
+	{
+		//*	the curve does not have a minimum
+		return(false);
+	}
+	params[2]	=	-poly[1] / (2.0 * poly[2]);
+	aSquared	=	poly[0] - ((poly[1] * poly[1]) / (4.0 * poly[2]));
+	if (aSquared > 0.0)
+	{
+		params[0]	=	sqrt(aSquared);
+	}
+	else
+	{
+		params[0]	=	0.9 * minY;
+	}
+	params[1]	=	params[0] / sqrt(poly[2]);
+
+	//*	Levenberg-Marquardt on the hyperbola itself
+	lambda			=	0.001;
+	currentError	=	HyperbolaError(params, xValues, yValues, count);
+	for (loopCnt=0; loopCnt<50; loopCnt++)
+	{
+		memset(matrix, 0, sizeof(matrix));
+		memset(vector, 0, sizeof(vector));
+		for (iii=0; iii<count; iii++)
+		{
+			uuu			=	(xValues[iii] - params[2]) / params[1];
+			sss			=	sqrt(1.0 + (uuu * uuu));
+			deriv[0]	=	sss;
+			deriv[1]	=	-(params[0] * uuu * uuu) / (params[1] * sss);
+			deriv[2]	=	-(params[0] * uuu) / (params[1] * sss);
+			residual	=	yValues[iii] - (params[0] * sss);
+			for (jjj=0; jjj<3; jjj++)
+			{
+				for (kkk=0; kkk<3; kkk++)
+				{
+					matrix[jjj][kkk]	+=	deriv[jjj] * deriv[kkk];
+				}
+				vector[jjj]	+=	deriv[jjj] * residual;
+			}
+		}
+		for (jjj=0; jjj<3; jjj++)
+		{
+			matrix[jjj][jjj]	*=	(1.0 + lambda);
+		}
+		if (Solve3x3(matrix, vector, delta) == false)
+		{
+			break;
+		}
+		for (jjj=0; jjj<3; jjj++)
+		{
+			trialParams[jjj]	=	params[jjj] + delta[jjj];
+		}
+		trialParams[0]	=	fabs(trialParams[0]);
+		trialParams[1]	=	fabs(trialParams[1]);
+		if (trialParams[1] < 1.0e-6)
+		{
+			trialParams[1]	=	1.0e-6;
+		}
+		trialError	=	HyperbolaError(trialParams, xValues, yValues, count);
+		if (trialError < currentError)
+		{
+			memcpy(params, trialParams, sizeof(trialParams));
+			if ((currentError - trialError) < (1.0e-10 * currentError))
+			{
+				break;
+			}
+			currentError	=	trialError;
+			lambda			*=	0.1;
+		}
+		else
+		{
+			lambda	*=	10.0;
+			if (lambda > 1.0e8)
+			{
+				break;
+			}
+		}
+	}
+	return(true);
+}
+
+//*****************************************************************************
+bool	CameraDriver::AutoFocus_IsActive(void)
+{
+	return((cAutoFocusState != kAutoFocus_Idle) && (cAutoFocusState < kAutoFocus_Complete));
+}
+
+//*****************************************************************************
+bool	CameraDriver::AutoFocus_MoveFocuser(const int32_t newPosition)
+{
+bool	moveOK;
+
+	moveOK	=	false;
+#ifdef _ENABLE_FOCUSER_
+	if (cConnectedFocuser != NULL)
+	{
+	TYPE_ASCOM_STATUS	alpacaErrCode;
+	char				alpacaErrMsg[128];
+
+		alpacaErrMsg[0]	=	0;
+		alpacaErrCode	=	cConnectedFocuser->SetFocuserPosition(newPosition, alpacaErrMsg);
+		if (alpacaErrCode == kASCOM_Err_Success)
+		{
+			cAutoFocusTarget		=	newPosition;
+			cAutoFocusStateStart_ms	=	millis();
+			moveOK					=	true;
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_STR("SetFocuserPosition() failed", alpacaErrMsg);
+		}
+	}
+#endif // _ENABLE_FOCUSER_
+	return(moveOK);
+}
+
+//*****************************************************************************
+//*	returns true when the focuser has stopped, fails the run if the move takes too long
+//*****************************************************************************
+bool	CameraDriver::AutoFocus_FocuserArrived(void)
+{
+bool		arrived;
+uint32_t	elapsed_ms;
+
+	arrived	=	false;
+#ifdef _ENABLE_FOCUSER_
+	if (cConnectedFocuser != NULL)
+	{
+		if (cConnectedFocuser->GetFocuserIsMoving() == false)
+		{
+			arrived	=	true;
+		}
+	}
+#endif // _ENABLE_FOCUSER_
+	if (arrived == false)
+	{
+		elapsed_ms	=	millis() - cAutoFocusStateStart_ms;
+		if (elapsed_ms > (kAutoFocusMoveTimeout_secs * 1000))
+		{
+			AutoFocus_Finish(kAutoFocus_Failed, "Focuser move timed out");
+		}
+	}
+	return(arrived);
+}
+
+//*****************************************************************************
+//*	all moves end going in the same direction as the sample moves
+//*****************************************************************************
+void	CameraDriver::AutoFocus_MoveToFinal(const int32_t finalPosition, TYPE_AUTOFOCUS_STATE finalState)
+{
+int32_t	backlashPosition;
+
+	cAutoFocusFinalPosition	=	finalPosition;
+	cAutoFocusFinalState	=	finalState;
+	backlashPosition		=	finalPosition - cAutoFocusBacklash;
+	if (backlashPosition < 0)
+	{
+		backlashPosition	=	0;
+	}
+	if (AutoFocus_MoveFocuser(backlashPosition))
+	{
+		cAutoFocusState	=	kAutoFocus_BacklashToFinal;
+	}
+	else
+	{
+		AutoFocus_Finish(kAutoFocus_Failed, "Focuser move failed");
+	}
+}
+
+//*****************************************************************************
+void	CameraDriver::AutoFocus_Finish(TYPE_AUTOFOCUS_STATE finalState, const char *statusMsg)
+{
+	CONSOLE_DEBUG_W_STR("Autofocus finished:", statusMsg);
+	cAutoFocusState		=	finalState;
+	cCurrentExposure_us	=	cAutoFocusSavedExposure_us;
+	if (statusMsg != cAutoFocusStatusMsg)
+	{
+		strcpy(cAutoFocusStatusMsg, statusMsg);
+	}
+}
+
+//*****************************************************************************
+//*	called from RunStateMachine_Idle() while autofocus is active
+//*****************************************************************************
+int32_t	CameraDriver::AutoFocus_RunStateMachine(void)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode;
+uint32_t			elapsed_ms;
+
+	switch(cAutoFocusState)
+	{
+		case kAutoFocus_Backlash:
+			if (AutoFocus_FocuserArrived())
+			{
+				if (AutoFocus_MoveFocuser(cAutoFocusSamples[0].position))
+				{
+					cAutoFocusState	=	kAutoFocus_WaitForFocuser;
+				}
+				else
+				{
+					AutoFocus_Finish(kAutoFocus_Failed, "Focuser move failed");
+				}
+			}
+			break;
+
+		case kAutoFocus_WaitForFocuser:
+			if (AutoFocus_FocuserArrived())
+			{
+				//*	autofocus frames are not saved
+				cCameraProp.ImageReady	=	false;
+				cCurrentExposure_us		=	cAutoFocusExposure_us;
+				SetLastExposureInfo();
+				alpacaErrCode			=	Start_CameraExposure(cAutoFocusExposure_us);
+				if (alpacaErrCode == kASCOM_Err_Success)
+				{
+					cAutoFocusState			=	kAutoFocus_Exposing;
+					cAutoFocusStateStart_ms	=	millis();
+				}
+				else
+				{
+					AutoFocus_Finish(kAutoFocus_Failed, "Failed to start exposure");
+				}
+			}
+			break;
+
+		case kAutoFocus_Exposing:
+			//*	the camera is idle but the frame never arrived
+			elapsed_ms	=	millis() - cAutoFocusStateStart_ms;
+			if (elapsed_ms > (uint32_t)((cAutoFocusExposure_us / 1000) + 60000))
+			{
+				AutoFocus_Finish(kAutoFocus_Failed, "Exposure timed out");
+			}
+			break;
+
+		case kAutoFocus_BacklashToFinal:
+			if (AutoFocus_FocuserArrived())
+			{
+				if (AutoFocus_MoveFocuser(cAutoFocusFinalPosition))
+				{
+					cAutoFocusState	=	kAutoFocus_MovingToFinal;
+				}
+				else
+				{
+					AutoFocus_Finish(kAutoFocus_Failed, "Focuser move failed");
+				}
+			}
+			break;
+
+		case kAutoFocus_MovingToFinal:
+			if (AutoFocus_FocuserArrived())
+			{
+				AutoFocus_Finish(cAutoFocusFinalState, cAutoFocusStatusMsg);
+			}
+			break;
+
+		default:
+			break;
+	}
+	return(50000);
+}
+
+//*****************************************************************************
+//*	called from the state machine right after the frame has been read,
+//*	the focuser is sent to the next position before the frame is analyzed
+//*	returns true if the frame belongs to autofocus
+//*****************************************************************************
+bool	CameraDriver::AutoFocus_FrameRead(void)
+{
+	if (cAutoFocusState != kAutoFocus_Exposing)
+	{
+		return(false);
+	}
+#ifdef _ENABLE_FOCUSER_
+	if (cConnectedFocuser != NULL)
+	{
+		cAutoFocusSamples[cAutoFocusSampleIdx].position	=	cConnectedFocuser->GetFocuserPosition();
+	}
+#endif // _ENABLE_FOCUSER_
+	cAutoFocusMeasureIdx	=	cAutoFocusSampleIdx;
+	cAutoFocusSampleIdx++;
+	if (cAutoFocusSampleIdx < cAutoFocusSampleCnt)
+	{
+		if (AutoFocus_MoveFocuser(cAutoFocusSamples[cAutoFocusSampleIdx].position))
+		{
+			cAutoFocusState	=	kAutoFocus_WaitForFocuser;
+		}
+		else
+		{
+			AutoFocus_Finish(kAutoFocus_Failed, "Focuser move failed");
+		}
+	}
+	else
+	{
+		cAutoFocusState	=	kAutoFocus_Measuring;
+	}
+	return(true);
+}
+
+//*****************************************************************************
+//*	called after the star analysis of an autofocus frame
+//*****************************************************************************
+void	CameraDriver::AutoFocus_FrameMeasured(void)
+{
+TYPE_AUTOFOCUS_SAMPLE	*sample;
+
+	sample				=	&cAutoFocusSamples[cAutoFocusMeasureIdx];
+	sample->valid		=	false;
+	sample->hfr			=	0.0;
+	sample->starCount	=	0;
+	if ((cStarResults != NULL) && cStarResults->valid)
+	{
+		sample->starCount	=	cStarResults->starCount;
+		sample->hfr			=	cStarResults->medianHFR;
+		if ((sample->starCount >= kAutoFocusMinStars) && (sample->hfr > 0.0))
+		{
+			sample->valid	=	true;
+		}
+	}
+	CONSOLE_DEBUG_W_NUM("Autofocus position\t=", sample->position);
+	CONSOLE_DEBUG_W_DBL("Autofocus HFR     \t=", sample->hfr);
+
+	if (cAutoFocusState == kAutoFocus_Measuring)
+	{
+		if (AutoFocus_FitCurve())
+		{
+			strcpy(cAutoFocusStatusMsg, "Focus found");
+			AutoFocus_MoveToFinal(cAutoFocusBestPosition, kAutoFocus_Complete);
+		}
+		else
+		{
+			//*	cAutoFocusStatusMsg has the reason
+			AutoFocus_MoveToFinal(cAutoFocusStartPosition, kAutoFocus_Failed);
+		}
+	}
+	else if (AutoFocus_IsActive())
+	{
+		sprintf(cAutoFocusStatusMsg, "Sample %d of %d", cAutoFocusSampleIdx + 1, cAutoFocusSampleCnt);
+	}
+}
+
+//*****************************************************************************
+bool	CameraDriver::AutoFocus_FitCurve(void)
+{
+double		xValues[kAutoFocusMaxSamples];
+double		yValues[kAutoFocusMaxSamples];
+double		params[3];
+double		meanY;
+double		sumSquares;
+double		delta;
+int			validCnt;
+int			iii;
+int32_t		firstPosition;
+int32_t		lastPosition;
+bool		fitOK;
+
+	//*	positions are scaled to steps to keep the fit well conditioned
+	firstPosition	=	cAutoFocusSamples[0].position;
+	lastPosition	=	cAutoFocusSamples[cAutoFocusSampleCnt - 1].position;
+	validCnt		=	0;
+	meanY			=	0.0;
+	for (iii=0; iii<cAutoFocusSampleCnt; iii++)
+	{
+		if (cAutoFocusSamples[iii].valid)
+		{
+			xValues[validCnt]	=	(1.0 * (cAutoFocusSamples[iii].position - firstPosition)) / cAutoFocusStepSize;
+			yValues[validCnt]	=	cAutoFocusSamples[iii].hfr;
+			meanY				+=	yValues[validCnt];
+			validCnt++;
+		}
+	}
+	if (validCnt < kAutoFocusMinValidSamples)
+	{
+		sprintf(cAutoFocusStatusMsg, "Only %d samples with stars", validCnt);
+		return(false);
+	}
+	meanY	/=	validCnt;
+
+	fitOK	=	FitHyperbola(xValues, yValues, validCnt, params);
+	if (fitOK == false)
+	{
+		strcpy(cAutoFocusStatusMsg, "No minimum in the focus curve");
+		return(false);
+	}
+
+	cAutoFocusBestPosition	=	firstPosition + (int32_t)((params[2] * cAutoFocusStepSize) + 0.5);
+	cAutoFocusBestHFR		=	params[0];
+
+	sumSquares	=	0.0;
+	for (iii=0; iii<validCnt; iii++)
+	{
+		delta		=	yValues[iii] - meanY;
+		sumSquares	+=	delta * delta;
+	}
+	cAutoFocusFitQuality	=	0.0;
+	if (sumSquares > 0.0)
+	{
+		cAutoFocusFitQuality	=	1.0 - (HyperbolaError(params, xValues, yValues, validCnt) / sumSquares);
+	}
+	CONSOLE_DEBUG_W_NUM("Best focus position\t=",	cAutoFocusBestPosition);
+	CONSOLE_DEBUG_W_DBL("Best HFR           \t=",	cAutoFocusBestHFR);
+	CONSOLE_DEBUG_W_DBL("Fit quality (R^2)  \t=",	cAutoFocusFitQuality);
+
+	if ((cAutoFocusBestPosition < firstPosition) || (cAutoFocusBestPosition > lastPosition))
+	{
+		strcpy(cAutoFocusStatusMsg, "Best focus is outside of the sampled range");
+		return(false);
+	}
+	return(true);
+}
+
+//*****************************************************************************
+void	CameraDriver::AutoFocus_OutputStatus(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocusstate",
+									gAutoFocusStateNames[cAutoFocusState],
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocusstatus",
+									cAutoFocusStatusMsg,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocusposition",
+									cAutoFocusBestPosition,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocushfr",
+									cAutoFocusBestHFR,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocusfitquality",
+									cAutoFocusFitQuality,
+									INCLUDE_COMMA);
+}
+
+//*****************************************************************************
+void	CameraDriver::AutoFocus_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocus",
+									AutoFocus_IsActive(),
+									INCLUDE_COMMA);
+	AutoFocus_OutputStatus(reqData);
+}
+
+//*****************************************************************************
+//*	the curve is returned as an array of {position, hfr, stars}
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_AutoFocus(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				lineBuff[128];
+int					iii;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									AutoFocus_IsActive(),
+									INCLUDE_COMMA);
+	AutoFocus_OutputStatus(reqData);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"autofocuscurve");
+	for (iii=0; iii<cAutoFocusSampleIdx; iii++)
+	{
+		sprintf(lineBuff, "{\"position\":%d,\"hfr\":%1.3f,\"stars\":%d}%s",
+							cAutoFocusSamples[iii].position,
+							cAutoFocusSamples[iii].hfr,
+							cAutoFocusSamples[iii].starCount,
+							((iii < (cAutoFocusSampleIdx - 1)) ? "," : ""));
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										lineBuff);
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	autofocus=BOOL
+//*	stepsize=INT	(optional, focuser steps between samples, default 100)
+//*	samples=INT		(optional, number of positions, default 9)
+//*	exposure=FLOAT	(optional, seconds, default is the current exposure)
+//*	backlash=INT	(optional, default is stepsize)
+//*	center=INT		(optional, default is the current focuser position)
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_AutoFocus(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+											"AutoFocus",
+											argumentString,
+											(sizeof(argumentString) -1));
+	if (foundKeyWord == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'autofocus' not found");
+		return(alpacaErrCode);
+	}
+
+	if (IsTrueFalse(argumentString) == false)
+	{
+		if (AutoFocus_IsActive())
+		{
+			AutoFocus_Finish(kAutoFocus_Aborted, "Aborted");
+		}
+		return(alpacaErrCode);
+	}
+
+#ifdef _ENABLE_FOCUSER_
+	int32_t		stepSize;
+	int32_t		sampleCnt;
+	int32_t		backlash;
+	int32_t		centerPosition;
+	int32_t		firstPosition;
+	int32_t		maxStep;
+	int32_t		exposure_us;
+	int			iii;
+
+	if (cConnectedFocuser == NULL)
+	{
+		UpdateFocuserLink();
+	}
+	if (cConnectedFocuser == NULL)
+	{
+		alpacaErrCode	=	kASCOM_Err_NotConnected;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "No focuser found");
+		return(alpacaErrCode);
+	}
+	if (AutoFocus_IsActive() || (cInternalCameraState != kCameraState_Idle) || (cImageMode != kImageMode_Single))
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Camera is busy");
+		return(alpacaErrCode);
+	}
+
+	stepSize		=	100;
+	sampleCnt		=	kAutoFocusDefaultSamples;
+	exposure_us		=	cCurrentExposure_us;
+	centerPosition	=	cConnectedFocuser->GetFocuserPosition();
+	maxStep			=	cConnectedFocuser->GetFocuserMaxStep();
+	if (GetKeyWordArgument(reqData->contentData, "StepSize", argumentString, (sizeof(argumentString) -1)))
+	{
+		stepSize	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "Samples", argumentString, (sizeof(argumentString) -1)))
+	{
+		sampleCnt	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "Exposure", argumentString, (sizeof(argumentString) -1)))
+	{
+		exposure_us	=	atof(argumentString) * 1000000;
+	}
+	backlash	=	stepSize;
+	if (GetKeyWordArgument(reqData->contentData, "Backlash", argumentString, (sizeof(argumentString) -1)))
+	{
+		backlash	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "Center", argumentString, (sizeof(argumentString) -1)))
+	{
+		centerPosition	=	atoi(argumentString);
+	}
+
+	if ((sampleCnt < kAutoFocusMinValidSamples) || (sampleCnt > kAutoFocusMaxSamples))
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Samples out of range (5 to 41)");
+	}
+	else if ((stepSize < 1) || ((stepSize * (sampleCnt - 1)) > maxStep))
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid step size");
+	}
+	else if ((exposure_us <= 0) || (exposure_us < cCameraProp.ExposureMin_us))
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid exposure time");
+	}
+	else if (backlash < 0)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid backlash");
+	}
+	if (alpacaErrCode != kASCOM_Err_Success)
+	{
+		return(alpacaErrCode);
+	}
+
+	//*	keep the whole curve within the range of the focuser
+	firstPosition	=	centerPosition - ((stepSize * (sampleCnt - 1)) / 2);
+	if ((firstPosition + (stepSize * (sampleCnt - 1))) > maxStep)
+	{
+		firstPosition	=	maxStep - (stepSize * (sampleCnt - 1));
+	}
+	if (firstPosition < 0)
+	{
+		firstPosition	=	0;
+	}
+
+	memset(cAutoFocusSamples, 0, sizeof(cAutoFocusSamples));
+	for (iii=0; iii<sampleCnt; iii++)
+	{
+		cAutoFocusSamples[iii].position	=	firstPosition + (iii * stepSize);
+	}
+	cAutoFocusSampleCnt			=	sampleCnt;
+	cAutoFocusSampleIdx			=	0;
+	cAutoFocusMeasureIdx		=	0;
+	cAutoFocusStepSize			=	stepSize;
+	cAutoFocusBacklash			=	backlash;
+	cAutoFocusExposure_us		=	exposure_us;
+	cAutoFocusSavedExposure_us	=	cCurrentExposure_us;
+	cAutoFocusStartPosition		=	cConnectedFocuser->GetFocuserPosition();
+	cAutoFocusBestPosition		=	0;
+	cAutoFocusBestHFR			=	0.0;
+	cAutoFocusFitQuality		=	0.0;
+	strcpy(cAutoFocusStatusMsg, "Starting");
+
+	firstPosition	-=	backlash;
+	if (firstPosition < 0)
+	{
+		firstPosition	=	0;
+	}
+	if (AutoFocus_MoveFocuser(firstPosition))
+	{
+		cAutoFocusState	=	kAutoFocus_Backlash;
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Focuser move failed");
+	}
+#else
+	alpacaErrCode	=	kASCOM_Err_NotImplemented;
+	GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Focuser support is not enabled");
+#endif // _ENABLE_FOCUSER_
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
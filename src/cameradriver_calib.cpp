@@ -0,0 +1,855 @@
+//**************************************************************************
+//*	Name:			cameradriver_calib.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Dark / bias / flat calibration inside the camera driver
+//*
+//*					Master frames are kept in the "calibration" directory, one file per master.
+//*					Each file has a fixed size header (TYPE_CALIB_HEADER) followed by
+//*					an array of floats, one per value in the image.
+//*
+//*					Masters are selected by image type, size, binning, gain, offset,
+//*					exposure and sensor temperature. The selected masters are memory mapped
+//*					and stay mapped until the camera settings change.
+//*
+//*					If a bias master is available, the dark is scaled by the exposure ratio
+//*						pixel	=	(pixel - bias - ((dark - bias) * ratio)) * flatGain
+//*					Without a bias, the dark must match the exposure
+//*
+//*					Masters are built in the driver by averaging the next N frames,
+//*					see buildcalibmaster
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_calib.cpp
+//*	Oct 19,	2026	<MLS> Added Calibration_ApplyToFrame() & Calibration_FindMasters()
+//*	Oct 19,	2026	<MLS> Added Calibration_BuildAddFrame() & Calibration_BuildFinish()
+//*	Oct 19,	2026	<MLS> Flats are matched on the filter name, version 2 header
+//*	Oct 19,	2026	<MLS> Builds and lookups are protected by cCalibMutex
+//*	Oct 19,	2026	<MLS> Master builds accumulate in double, the file is still float
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<ctype.h>
+#include	<dirent.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<math.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<sys/mman.h>
+#include	<sys/stat.h>
+#include	<sys/types.h>
+#include	<unistd.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+
+#define	kCalibMagic				"ALPCALIB"
+#define	kCalibVersion			2
+#define	kCalibTempTolerance		3.0		//*	degrees C
+#define	kCalibMaxBuildFrames	1000
+
+static const char	*gCalibMasterNames[]	=
+{
+	"bias",
+	"dark",
+	"flat",
+	""
+};
+
+//*****************************************************************************
+typedef struct	//	TYPE_CALIB_BAND
+{
+	unsigned char	*pixelPtr;
+	const float		*biasPtr;
+	const float		*darkPtr;
+	const float		*flatGainPtr;
+	int				rowValues;
+	int				bytesPerValue;
+	float			biasScale;
+	float			darkScale;
+} TYPE_CALIB_BAND;
+
+//*****************************************************************************
+static void	Calibration_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_CALIB_BAND	*band;
+long			firstValue;
+int				valueCnt;
+
+	band		=	(TYPE_CALIB_BAND *)context;
+	firstValue	=	(long)firstRow * band->rowValues;
+	valueCnt	=	(lastRow - firstRow) * band->rowValues;
+	if (band->bytesPerValue == 2)
+	{
+		ImageKernel_Calibrate_U16(	((uint16_t *)band->pixelPtr) + firstValue,
+									(band->biasPtr		!= NULL) ? (band->biasPtr + firstValue)		: NULL,
+									(band->darkPtr		!= NULL) ? (band->darkPtr + firstValue)		: NULL,
+									(band->flatGainPtr	!= NULL) ? (band->flatGainPtr + firstValue)	: NULL,
+									valueCnt,
+									band->biasScale,
+									band->darkScale);
+	}
+	else
+	{
+		ImageKernel_Calibrate_U8(	band->pixelPtr + firstValue,
+									(band->biasPtr		!= NULL) ? (band->biasPtr + firstValue)		: NULL,
+									(band->darkPtr		!= NULL) ? (band->darkPtr + firstValue)		: NULL,
+									(band->flatGainPtr	!= NULL) ? (band->flatGainPtr + firstValue)	: NULL,
+									valueCnt,
+									band->biasScale,
+									band->darkScale);
+	}
+}
+
+//*****************************************************************************
+static long	Calibration_ValueCount(const TYPE_CALIB_HEADER *calibHeader)
+{
+long	valueCount;
+
+	valueCount	=	(long)calibHeader->width * calibHeader->height;
+	if (calibHeader->imageType == kImageType_RGB24)
+	{
+		valueCount	*=	3;
+	}
+	return(valueCount);
+}
+
+//*****************************************************************************
+//*	fills in the header with the current camera settings and last frame geometry
+//*****************************************************************************
+void	CameraDriver::Calibration_FillHeader(TYPE_CALIB_HEADER *calibHeader, TYPE_CALIB_MASTER masterType)
+{
+const char	*filterName;
+
+	memset(calibHeader, 0, sizeof(TYPE_CALIB_HEADER));
+	memcpy(calibHeader->magic, kCalibMagic, sizeof(calibHeader->magic));
+	calibHeader->version		=	kCalibVersion;
+	calibHeader->masterType		=	masterType;
+	calibHeader->imageType		=	cLastExposure_ROIinfo.currentROIimageType;
+	calibHeader->width			=	cLastExposure_ROIinfo.currentROIwidth;
+	calibHeader->height			=	cLastExposure_ROIinfo.currentROIheight;
+	calibHeader->binning		=	cCameraProp.BinX;
+	calibHeader->gain			=	cCameraProp.Gain;
+	calibHeader->offset			=	cCameraProp.Offset;
+	calibHeader->exposure_us	=	cCameraProp.Lastexposure_duration_us;
+	if (cTempReadSupported)
+	{
+		calibHeader->sensorTemp	=	cCameraProp.CCDtemperature;
+	}
+	filterName	=	cTS_info.filterName;
+#if defined(_ENABLE_FILTERWHEEL_) || defined(_ENABLE_FILTERWHEEL_ZWO_) || defined(_ENABLE_FILTERWHEEL_ATIK_)
+	if ((cConnectedFilterWheel != NULL) && (strlen(cFilterWheelCurrName) > 0))
+	{
+		filterName	=	cFilterWheelCurrName;
+	}
+#endif
+	snprintf(calibHeader->filterName, sizeof(calibHeader->filterName), "%.*s",
+					(int)(sizeof(calibHeader->filterName) - 1), filterName);
+}
+
+//*****************************************************************************
+void	CameraDriver::Calibration_ReleaseMaster(TYPE_CALIB_MASTER masterType)
+{
+TYPE_CALIB_MASTER_INFO	*masterInfo;
+
+	masterInfo	=	&cCalibMaster[masterType];
+	if (masterInfo->mapPtr != NULL)
+	{
+		munmap(masterInfo->mapPtr, masterInfo->mapSize);
+	}
+	memset(masterInfo, 0, sizeof(TYPE_CALIB_MASTER_INFO));
+}
+
+//*****************************************************************************
+//*	memory maps the master file, if it is already loaded, nothing is done
+//*****************************************************************************
+bool	CameraDriver::Calibration_LoadMaster(TYPE_CALIB_MASTER masterType, const char *fileName)
+{
+TYPE_CALIB_MASTER_INFO	*masterInfo;
+struct stat				fileStatus;
+int						fileDesc;
+void					*mapPtr;
+size_t					expectedSize;
+bool					loadOK;
+
+	masterInfo	=	&cCalibMaster[masterType];
+	if (masterInfo->valid && (strcmp(masterInfo->fileName, fileName) == 0))
+	{
+		return(true);
+	}
+	Calibration_ReleaseMaster(masterType);
+
+	loadOK		=	false;
+	fileDesc	=	open(fileName, O_RDONLY);
+	if (fileDesc >= 0)
+	{
+		if (fstat(fileDesc, &fileStatus) == 0)
+		{
+			mapPtr	=	mmap(NULL, fileStatus.st_size, PROT_READ, (MAP_SHARED | MAP_POPULATE), fileDesc, 0);
+			if (mapPtr != MAP_FAILED)
+			{
+				memcpy(&masterInfo->header, mapPtr, sizeof(TYPE_CALIB_HEADER));
+				expectedSize	=	kCalibHeaderSize + (Calibration_ValueCount(&masterInfo->header) * sizeof(float));
+				if ((size_t)fileStatus.st_size >= expectedSize)
+				{
+					masterInfo->mapPtr		=	mapPtr;
+					masterInfo->mapSize		=	fileStatus.st_size;
+					masterInfo->dataPtr		=	(const float *)((const char *)mapPtr + kCalibHeaderSize);
+					masterInfo->valid		=	true;
+					strcpy(masterInfo->fileName, fileName);
+					loadOK					=	true;
+					CONSOLE_DEBUG_W_STR("Calibration master loaded\t=", fileName);
+				}
+				else
+				{
+					CONSOLE_DEBUG_W_STR("Calibration master is too short\t=", fileName);
+					munmap(mapPtr, fileStatus.st_size);
+				}
+			}
+		}
+		//*	the mapping stays valid after the file is closed
+		close(fileDesc);
+	}
+	return(loadOK);
+}
+
+//*****************************************************************************
+//*	looks through the calibration directory for the best master of each type
+//*	for the settings in cCalibLookupKey
+//*****************************************************************************
+bool	CameraDriver::Calibration_FindMasters(void)
+{
+DIR					*directory;
+struct dirent		*dirEntry;
+FILE				*filePointer;
+TYPE_CALIB_HEADER	fileHeader;
+char				filePath[kMaxFileNameLen];
+char				bestFileName[kCalibMaster_last][kMaxFileNameLen];
+double				bestScore[kCalibMaster_last];
+int32_t				bestExposure_us[kCalibMaster_last];
+double				score;
+double				tempDelta;
+int					masterType;
+size_t				readCnt;
+bool				foundAny;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	for (masterType = 0; masterType < kCalibMaster_last; masterType++)
+	{
+		bestFileName[masterType][0]		=	0;
+		bestScore[masterType]			=	1.0e9;
+		bestExposure_us[masterType]		=	0;
+	}
+
+	directory	=	opendir(kCalibrationDir);
+	if (directory != NULL)
+	{
+		while ((dirEntry = readdir(directory)) != NULL)
+		{
+			if (strstr(dirEntry->d_name, ".calib") == NULL)
+			{
+				continue;
+			}
+			if ((strlen(kCalibrationDir) + strlen(dirEntry->d_name) + 2) >= sizeof(filePath))
+			{
+				continue;
+			}
+			sprintf(filePath, "%s/%s", kCalibrationDir, dirEntry->d_name);
+			filePointer	=	fopen(filePath, "r");
+			if (filePointer == NULL)
+			{
+				continue;
+			}
+			readCnt	=	fread(&fileHeader, sizeof(TYPE_CALIB_HEADER), 1, filePointer);
+			fclose(filePointer);
+			fileHeader.filterName[sizeof(fileHeader.filterName) - 1]	=	0;
+
+			//*	the geometry has to match for all types of masters
+			if ((readCnt != 1) ||
+				(memcmp(fileHeader.magic, kCalibMagic, sizeof(fileHeader.magic)) != 0) ||
+				(fileHeader.version		!= kCalibVersion) ||
+				(fileHeader.masterType	< 0) ||
+				(fileHeader.masterType	>= kCalibMaster_last) ||
+				(fileHeader.imageType	!= cCalibLookupKey.imageType) ||
+				(fileHeader.width		!= cCalibLookupKey.width) ||
+				(fileHeader.height		!= cCalibLookupKey.height) ||
+				(fileHeader.binning		!= cCalibLookupKey.binning))
+			{
+				continue;
+			}
+			tempDelta	=	fabs(fileHeader.sensorTemp - cCalibLookupKey.sensorTemp);
+			score		=	0.0;
+			switch(fileHeader.masterType)
+			{
+				case kCalibMaster_Bias:
+					if ((fileHeader.gain != cCalibLookupKey.gain) || (fileHeader.offset != cCalibLookupKey.offset))
+					{
+						continue;
+					}
+					score	=	tempDelta;
+					break;
+
+				case kCalibMaster_Dark:
+					if ((fileHeader.gain != cCalibLookupKey.gain) || (fileHeader.offset != cCalibLookupKey.offset))
+					{
+						continue;
+					}
+					if (cTempReadSupported && (tempDelta > kCalibTempTolerance))
+					{
+						continue;
+					}
+					//*	prefer the closest exposure, then the closest temperature
+					if ((fileHeader.exposure_us > 0) && (cCalibLookupKey.exposure_us > 0))
+					{
+						score	=	fabs(log((double)cCalibLookupKey.exposure_us / fileHeader.exposure_us));
+					}
+					score	+=	tempDelta * 0.1;
+					break;
+
+				case kCalibMaster_Flat:
+					//*	flats are normalized, gain and exposure do not matter, the filter does
+					if (strcmp(fileHeader.filterName, cCalibLookupKey.filterName) != 0)
+					{
+						continue;
+					}
+					score	=	0.0;
+					break;
+			}
+			if (score < bestScore[fileHeader.masterType])
+			{
+				bestScore[fileHeader.masterType]		=	score;
+				bestExposure_us[fileHeader.masterType]	=	fileHeader.exposure_us;
+				strcpy(bestFileName[fileHeader.masterType], filePath);
+			}
+		}
+		closedir(directory);
+	}
+
+	//*	without a bias, the dark can not be scaled so it has to match the exposure
+	if ((bestFileName[kCalibMaster_Bias][0] == 0) && (bestFileName[kCalibMaster_Dark][0] != 0))
+	{
+		if (abs(bestExposure_us[kCalibMaster_Dark] - cCalibLookupKey.exposure_us) > (cCalibLookupKey.exposure_us / 100))
+		{
+			CONSOLE_DEBUG("No bias master and dark exposure does not match");
+			bestFileName[kCalibMaster_Dark][0]	=	0;
+		}
+	}
+
+	foundAny	=	false;
+	for (masterType = 0; masterType < kCalibMaster_last; masterType++)
+	{
+		if (bestFileName[masterType][0] != 0)
+		{
+			if (Calibration_LoadMaster((TYPE_CALIB_MASTER)masterType, bestFileName[masterType]))
+			{
+				foundAny	=	true;
+			}
+		}
+		else
+		{
+			Calibration_ReleaseMaster((TYPE_CALIB_MASTER)masterType);
+		}
+	}
+	return(foundAny);
+}
+
+//*****************************************************************************
+//*	called from the state machine after Read_ImageData() succeeds
+//*	cCalibMutex keeps the PUT commands from resetting a build or the lookup
+//*	while a frame is being added or calibrated
+//*****************************************************************************
+void	CameraDriver::Calibration_ProcessFrame(const bool autoFocusFrame)
+{
+	pthread_mutex_lock(&cCalibMutex);
+	if (cCalibBuildActive)
+	{
+		//*	masters are built from uncalibrated frames, never from autofocus frames
+		if (autoFocusFrame == false)
+		{
+			Calibration_BuildAddFrame();
+		}
+	}
+	else if (cCalibrationEnabled)
+	{
+		Calibration_ApplyToFrame();
+	}
+	pthread_mutex_unlock(&cCalibMutex);
+}
+
+//*****************************************************************************
+void	CameraDriver::Calibration_ApplyToFrame(void)
+{
+TYPE_CALIB_HEADER	currentKey;
+TYPE_CALIB_BAND		bandInfo;
+uint32_t			startMilliSecs;
+double				exposureRatio;
+
+	if (cCameraDataBuffer == NULL)
+	{
+		return;
+	}
+	startMilliSecs	=	millis();
+	Calibration_FillHeader(&currentKey, kCalibMaster_last);
+	//*	small temperature changes should not cause a new lookup
+	currentKey.sensorTemp	=	round(currentKey.sensorTemp);
+	if (memcmp(&currentKey, &cCalibLookupKey, sizeof(TYPE_CALIB_HEADER)) != 0)
+	{
+		cCalibLookupKey	=	currentKey;
+		Calibration_FindMasters();
+	}
+	if ((cCalibMaster[kCalibMaster_Bias].valid == false) &&
+		(cCalibMaster[kCalibMaster_Dark].valid == false) &&
+		(cCalibMaster[kCalibMaster_Flat].valid == false))
+	{
+		return;
+	}
+
+	bandInfo.pixelPtr		=	cCameraDataBuffer;
+	bandInfo.biasPtr		=	cCalibMaster[kCalibMaster_Bias].valid ? cCalibMaster[kCalibMaster_Bias].dataPtr : NULL;
+	bandInfo.darkPtr		=	cCalibMaster[kCalibMaster_Dark].valid ? cCalibMaster[kCalibMaster_Dark].dataPtr : NULL;
+	bandInfo.flatGainPtr	=	cCalibMaster[kCalibMaster_Flat].valid ? cCalibMaster[kCalibMaster_Flat].dataPtr : NULL;
+	bandInfo.rowValues		=	currentKey.width * ((currentKey.imageType == kImageType_RGB24) ? 3 : 1);
+	bandInfo.bytesPerValue	=	(currentKey.imageType == kImageType_RAW16) ? 2 : 1;
+	bandInfo.biasScale		=	1.0;
+	bandInfo.darkScale		=	1.0;
+	if ((bandInfo.darkPtr != NULL) && (bandInfo.biasPtr != NULL))
+	{
+		//*	bias - (dark - bias) * ratio	==	bias * (1 - ratio) + dark * ratio
+		exposureRatio	=	1.0;
+		if (cCalibMaster[kCalibMaster_Dark].header.exposure_us > 0)
+		{
+			exposureRatio	=	(1.0 * currentKey.exposure_us) / cCalibMaster[kCalibMaster_Dark].header.exposure_us;
+		}
+		bandInfo.biasScale	=	1.0 - exposureRatio;
+		bandInfo.darkScale	=	exposureRatio;
+	}
+	else if (bandInfo.darkPtr != NULL)
+	{
+		//*	the dark already contains the bias
+		bandInfo.biasScale	=	0.0;
+	}
+
+	ImageKernel_RunRowBands(currentKey.height, Calibration_BandProc, &bandInfo);
+	cCalibLastApply_ms	=	millis() - startMilliSecs;
+}
+
+//*****************************************************************************
+//*	adds the current frame to the master being built
+//*****************************************************************************
+void	CameraDriver::Calibration_BuildAddFrame(void)
+{
+TYPE_CALIB_HEADER	currentKey;
+long				valueCount;
+
+	if (cCameraDataBuffer == NULL)
+	{
+		return;
+	}
+	Calibration_FillHeader(&currentKey, cCalibBuildType);
+	valueCount	=	Calibration_ValueCount(&currentKey);
+	if (cCalibBuildHeader.frameCount == 0)
+	{
+		if ((cCalibBuildSum == NULL) || (valueCount > cCalibBuildAllocCnt))
+		{
+			DISPOSEPTR_IF_INUSE(cCalibBuildSum);
+			cCalibBuildSum		=	(double *)malloc(valueCount * sizeof(double));
+			cCalibBuildAllocCnt	=	(cCalibBuildSum != NULL) ? valueCount : 0;
+		}
+		if (cCalibBuildSum == NULL)
+		{
+			strcpy(cCalibBuildStatus, "Failed to allocate memory");
+			cCalibBuildActive	=	false;
+			return;
+		}
+		memset(cCalibBuildSum, 0, (valueCount * sizeof(double)));
+		cCalibBuildHeader	=	currentKey;
+	}
+	else if ((currentKey.imageType	!= cCalibBuildHeader.imageType) ||
+			(currentKey.width		!= cCalibBuildHeader.width) ||
+			(currentKey.height		!= cCalibBuildHeader.height))
+	{
+		strcpy(cCalibBuildStatus, "Aborted, image format changed");
+		cCalibBuildActive	=	false;
+		return;
+	}
+	else if ((cCalibBuildType == kCalibMaster_Flat) &&
+			(strcmp(currentKey.filterName, cCalibBuildHeader.filterName) != 0))
+	{
+		strcpy(cCalibBuildStatus, "Aborted, filter changed");
+		cCalibBuildActive	=	false;
+		return;
+	}
+
+	if (currentKey.imageType == kImageType_RAW16)
+	{
+		ImageKernel_StackAdd_U16(cCalibBuildSum, NULL, (uint16_t *)cCameraDataBuffer, valueCount, 0.0, 0.0);
+	}
+	else
+	{
+		ImageKernel_StackAdd_U8(cCalibBuildSum, NULL, cCameraDataBuffer, valueCount, 0.0, 0.0);
+	}
+	cCalibBuildHeader.frameCount++;
+	sprintf(cCalibBuildStatus, "Building %s, frame %d of %d",	gCalibMasterNames[cCalibBuildType],
+																cCalibBuildHeader.frameCount,
+																cCalibBuildFramesReq);
+	if (cCalibBuildHeader.frameCount >= cCalibBuildFramesReq)
+	{
+		Calibration_BuildFinish();
+		cCalibBuildActive	=	false;
+	}
+}
+
+//*****************************************************************************
+//*	averages the accumulated frames and writes the master file
+//*	flats have the bias removed and are converted to a gain, normalized separately
+//*	for each color (RGB24) or each position in the bayer cell (color RAW)
+//*****************************************************************************
+bool	CameraDriver::Calibration_BuildFinish(void)
+{
+long		valueCount;
+long		ii;
+double		invFrameCnt;
+double		phaseSum[4];
+long		phaseCount[4];
+double		phaseMean[4];
+int			phase;
+int			rowValues;
+int			xxx;
+int			yyy;
+int			mkdirErrCode;
+char		fileName[kMaxFileNameLen];
+char		headerBlock[kCalibHeaderSize];
+char		filterSuffix[sizeof(cCalibBuildHeader.filterName) + 1];
+FILE		*filePointer;
+size_t		writeCnt;
+bool		writeOK;
+float		floatBuff[1024];
+long		chunkCnt;
+long		jj;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	valueCount	=	Calibration_ValueCount(&cCalibBuildHeader);
+	invFrameCnt	=	1.0 / cCalibBuildHeader.frameCount;
+	for (ii=0; ii<valueCount; ii++)
+	{
+		cCalibBuildSum[ii]	*=	invFrameCnt;
+	}
+
+	if (cCalibBuildType == kCalibMaster_Flat)
+	{
+		//*	use the bias master for the current settings if there is one
+		cCalibLookupKey				=	cCalibBuildHeader;
+		cCalibLookupKey.masterType	=	kCalibMaster_last;
+		cCalibLookupKey.frameCount	=	0;
+		cCalibLookupKey.sensorTemp	=	round(cCalibLookupKey.sensorTemp);
+		Calibration_FindMasters();
+		if (cCalibMaster[kCalibMaster_Bias].valid)
+		{
+			for (ii=0; ii<valueCount; ii++)
+			{
+				cCalibBuildSum[ii]	-=	cCalibMaster[kCalibMaster_Bias].dataPtr[ii];
+			}
+		}
+
+		rowValues	=	cCalibBuildHeader.width * ((cCalibBuildHeader.imageType == kImageType_RGB24) ? 3 : 1);
+		for (phase=0; phase<4; phase++)
+		{
+			phaseSum[phase]		=	0.0;
+			phaseCount[phase]	=	0;
+		}
+		for (yyy=0; yyy<cCalibBuildHeader.height; yyy++)
+		{
+			for (xxx=0; xxx<rowValues; xxx++)
+			{
+				if (cCalibBuildHeader.imageType == kImageType_RGB24)
+				{
+					phase	=	xxx % 3;
+				}
+				else if (cIsColorCam && (cCalibBuildHeader.imageType != kImageType_MONO8))
+				{
+					phase	=	((yyy & 0x01) << 1) | (xxx & 0x01);
+				}
+				else
+				{
+					phase	=	0;
+				}
+				phaseSum[phase]	+=	cCalibBuildSum[((long)yyy * rowValues) + xxx];
+				phaseCount[phase]++;
+			}
+		}
+		for (phase=0; phase<4; phase++)
+		{
+			phaseMean[phase]	=	(phaseCount[phase] > 0) ? (phaseSum[phase] / phaseCount[phase]) : 1.0;
+		}
+		for (yyy=0; yyy<cCalibBuildHeader.height; yyy++)
+		{
+			for (xxx=0; xxx<rowValues; xxx++)
+			{
+				if (cCalibBuildHeader.imageType == kImageType_RGB24)
+				{
+					phase	=	xxx % 3;
+				}
+				else if (cIsColorCam && (cCalibBuildHeader.imageType != kImageType_MONO8))
+				{
+					phase	=	((yyy & 0x01) << 1) | (xxx & 0x01);
+				}
+				else
+				{
+					phase	=	0;
+				}
+				ii	=	((long)yyy * rowValues) + xxx;
+				//*	dead or very dark pixels are left alone
+				if (cCalibBuildSum[ii] >= 1.0)
+				{
+					cCalibBuildSum[ii]	=	phaseMean[phase] / cCalibBuildSum[ii];
+				}
+				else
+				{
+					cCalibBuildSum[ii]	=	1.0;
+				}
+			}
+		}
+	}
+
+	mkdirErrCode	=	mkdir(kCalibrationDir, 0744);
+	if ((mkdirErrCode != 0) && (errno != EEXIST))
+	{
+		CONSOLE_DEBUG_W_STR("Failed to create directory\t=", kCalibrationDir);
+	}
+	//*	flats of each filter get their own file
+	filterSuffix[0]	=	0;
+	if ((cCalibBuildType == kCalibMaster_Flat) && (cCalibBuildHeader.filterName[0] != 0))
+	{
+		filterSuffix[0]	=	'_';
+		for (ii=0; cCalibBuildHeader.filterName[ii] != 0; ii++)
+		{
+			filterSuffix[ii + 1]	=	isalnum((unsigned char)cCalibBuildHeader.filterName[ii]) ? cCalibBuildHeader.filterName[ii] : '-';
+		}
+		filterSuffix[ii + 1]	=	0;
+	}
+	sprintf(fileName, "%s/%s_%dx%d_b%d_g%d_o%d_e%d_t%d%s.calib",	kCalibrationDir,
+																gCalibMasterNames[cCalibBuildType],
+																cCalibBuildHeader.width,
+																cCalibBuildHeader.height,
+																cCalibBuildHeader.binning,
+																cCalibBuildHeader.gain,
+																cCalibBuildHeader.offset,
+																cCalibBuildHeader.exposure_us,
+																(int)round(cCalibBuildHeader.sensorTemp),
+																filterSuffix);
+
+	//*	if this master is in use, it has to be unmapped before the file is replaced
+	Calibration_ReleaseMaster(cCalibBuildType);
+
+	writeOK		=	false;
+	filePointer	=	fopen(fileName, "w");
+	if (filePointer != NULL)
+	{
+		memset(headerBlock, 0, sizeof(headerBlock));
+		memcpy(headerBlock, &cCalibBuildHeader, sizeof(TYPE_CALIB_HEADER));
+		writeCnt	=	fwrite(headerBlock, sizeof(headerBlock), 1, filePointer);
+		writeOK		=	(writeCnt == 1);
+		//*	the accumulator is double, the master file is float
+		for (ii=0; writeOK && (ii<valueCount); ii += chunkCnt)
+		{
+			chunkCnt	=	valueCount - ii;
+			if (chunkCnt > (long)(sizeof(floatBuff) / sizeof(float)))
+			{
+				chunkCnt	=	sizeof(floatBuff) / sizeof(float);
+			}
+			for (jj=0; jj<chunkCnt; jj++)
+			{
+				floatBuff[jj]	=	cCalibBuildSum[ii + jj];
+			}
+			writeCnt	=	fwrite(floatBuff, sizeof(float), chunkCnt, filePointer);
+			writeOK		=	(writeCnt == (size_t)chunkCnt);
+		}
+		fclose(filePointer);
+	}
+	if (writeOK)
+	{
+		sprintf(cCalibBuildStatus, "Finished %s, %d frames", gCalibMasterNames[cCalibBuildType], cCalibBuildHeader.frameCount);
+		CONSOLE_DEBUG_W_STR("Calibration master saved\t=", fileName);
+	}
+	else
+	{
+		sprintf(cCalibBuildStatus, "Failed to write %s", gCalibMasterNames[cCalibBuildType]);
+		CONSOLE_DEBUG_W_STR("Failed to write calibration master\t=", fileName);
+	}
+
+	//*	force a new lookup on the next frame
+	memset(&cCalibLookupKey, 0, sizeof(TYPE_CALIB_HEADER));
+	DISPOSEPTR_IF_INUSE(cCalibBuildSum);
+	cCalibBuildAllocCnt	=	0;
+	return(writeOK);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_Calibration(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cCalibrationEnabled,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_Calibration(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Calibration",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			pthread_mutex_lock(&cCalibMutex);
+			cCalibrationEnabled	=	IsTrueFalse(argumentString);
+			//*	look the masters up again, the library may have changed
+			memset(&cCalibLookupKey, 0, sizeof(TYPE_CALIB_HEADER));
+			pthread_mutex_unlock(&cCalibMutex);
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'calibration' not found");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_BuildCalibMaster(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				buildStatus[sizeof(cCalibBuildStatus)];
+
+	pthread_mutex_lock(&cCalibMutex);
+	strcpy(buildStatus, cCalibBuildStatus);
+	pthread_mutex_unlock(&cCalibMutex);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									buildStatus,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	type=bias|dark|flat
+//*	count=INT
+//*	the next "count" frames that are taken are averaged into the master
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_BuildCalibMaster(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+int					masterType;
+int					frameCount;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		masterType		=	-1;
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Type",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			for (masterType = 0; masterType < kCalibMaster_last; masterType++)
+			{
+				if (strcasecmp(argumentString, gCalibMasterNames[masterType]) == 0)
+				{
+					break;
+				}
+			}
+		}
+		frameCount		=	0;
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Count",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			frameCount	=	atoi(argumentString);
+		}
+
+		if ((masterType < 0) || (masterType >= kCalibMaster_last))
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid type, must be bias, dark or flat");
+		}
+		else if ((frameCount < 1) || (frameCount > kCalibMaxBuildFrames))
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid count");
+		}
+		else
+		{
+			//*	the state machine may be adding a frame to the current build
+			pthread_mutex_lock(&cCalibMutex);
+			cCalibBuildType					=	(TYPE_CALIB_MASTER)masterType;
+			cCalibBuildFramesReq			=	frameCount;
+			cCalibBuildHeader.frameCount	=	0;
+			cCalibBuildActive				=	true;
+			sprintf(cCalibBuildStatus, "Waiting for %s frames", gCalibMasterNames[masterType]);
+			pthread_mutex_unlock(&cCalibMutex);
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
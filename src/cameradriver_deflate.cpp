@@ -0,0 +1,290 @@
+//**************************************************************************
+//*	Name:			cameradriver_deflate.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Lossless compressed imagebytes (AlpacaPi extension)
+//*
+//*					Only used when the client asks for "application/imagebytes-deflate",
+//*					the layout is described with kAlpacaImageData_Compressed in alpaca_defs.h.
+//*
+//*					The normal imagebytes data is built first, then it is cut into bands
+//*					along Dimension1 (columns of the image) and each band is predicted
+//*					and deflated on its own (ImageKernel_DeflateElements).
+//*					The bands are spread over the cores with ImageKernel_RunRowBands,
+//*					the client can inflate them the same way.
+//*
+//*					A sky frame is mostly background noise, the predictor takes each
+//*					value from the same Bayer color 2 rows up (3 values back for RGB),
+//*					so what deflate sees is the noise only.
+//*
+//*					If the data does not get smaller, the normal imagebytes is sent.
+//*
+//*					_ENABLE_IMAGEBYTES_DEFLATE_		needs -lz
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_deflate.cpp
+//*****************************************************************************
+
+#if defined(_ENABLE_CAMERA_) && defined(_ENABLE_IMAGEBYTES_DEFLATE_)
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+//*	enough bands to keep 8 cores busy, each band still has plenty of data for deflate
+#define	kDeflate_MaxBands	32
+
+//*****************************************************************************
+typedef struct	//	TYPE_DEFLATE_BANDS
+{
+	const uint8_t	*rawPtr;
+	long			columnBytes;
+	int				numClms;
+	int				bandCount;
+	int				elementBytes;
+	int				stride;
+	uint8_t			*slotBuf;			//*	each band is compressed into its own slot
+	long			slotSize;
+	long			bandLen[kDeflate_MaxBands];
+} TYPE_DEFLATE_BANDS;
+
+//*****************************************************************************
+//*	called by ImageKernel_RunRowBands() with a range of columns,
+//*	does every band that starts in that range
+//*****************************************************************************
+static void	Deflate_BandProc(void *context, int firstClm, int lastClm)
+{
+TYPE_DEFLATE_BANDS	*bandInfo;
+int					bandFirstClm;
+int					bandLastClm;
+int					bb;
+
+	bandInfo	=	(TYPE_DEFLATE_BANDS *)context;
+	for (bb=0; bb<bandInfo->bandCount; bb++)
+	{
+		bandFirstClm	=	(bb * bandInfo->numClms) / bandInfo->bandCount;
+		if ((bandFirstClm >= firstClm) && (bandFirstClm < lastClm))
+		{
+			bandLastClm				=	((bb + 1) * bandInfo->numClms) / bandInfo->bandCount;
+			bandInfo->bandLen[bb]	=	ImageKernel_DeflateElements(
+												&bandInfo->slotBuf[bb * bandInfo->slotSize],
+												bandInfo->slotSize,
+												&bandInfo->rawPtr[bandFirstClm * bandInfo->columnBytes],
+												((bandLastClm - bandFirstClm) * bandInfo->columnBytes),
+												bandInfo->elementBytes,
+												bandInfo->stride);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	payloadPtr is the normal imagebytes data (TYPE_BinaryImageHdr followed by the data)
+//*	returns the complete response including the HTTP header, NULL if it could not be
+//*	compressed, the caller then sends the normal data.
+//*****************************************************************************
+uint8_t	*CameraDriver::ImageBytes_Deflate(	const uint8_t	*payloadPtr,
+											const size_t	payloadLen,
+											size_t			*responseLen)
+{
+TYPE_BinaryImageHdr			binaryImageHdr;
+TYPE_CompressedImageInfo	compressInfo;
+TYPE_DEFLATE_BANDS			bandInfo;
+const uint8_t				*rawPtr;
+long						rawLen;
+long						elementsPerClm;
+long						maxBandBytes;
+long						compressedLen;
+int32_t						bandSize;
+char						httpHeader[512];
+size_t						httpHeaderSize;
+uint8_t						*responseBuf;
+size_t						ccc;
+uint32_t					startMillisecs;
+int							bb;
+
+	if (payloadLen <= sizeof(TYPE_BinaryImageHdr))
+	{
+		return(NULL);
+	}
+	startMillisecs	=	millis();
+	memcpy(&binaryImageHdr, payloadPtr, sizeof(TYPE_BinaryImageHdr));
+
+	memset((void *)&bandInfo, 0, sizeof(TYPE_DEFLATE_BANDS));
+	switch(binaryImageHdr.TransmissionElementType)
+	{
+		case kAlpacaImageData_Byte:		bandInfo.elementBytes	=	1;	break;
+		case kAlpacaImageData_Int16:
+		case kAlpacaImageData_UInt16:	bandInfo.elementBytes	=	2;	break;
+		case kAlpacaImageData_Int32:	bandInfo.elementBytes	=	4;	break;
+
+		default:
+			//*	packed or floating point data, leave it alone
+			return(NULL);
+	}
+
+	elementsPerClm	=	binaryImageHdr.Dimension2;
+	bandInfo.stride	=	2;			//*	same Bayer color, 2 rows up
+	if (binaryImageHdr.Rank == 3)
+	{
+		elementsPerClm	*=	binaryImageHdr.Dimension3;
+		bandInfo.stride	=	binaryImageHdr.Dimension3;
+	}
+	rawPtr				=	payloadPtr + binaryImageHdr.DataStart;
+	rawLen				=	payloadLen - binaryImageHdr.DataStart;
+	bandInfo.rawPtr		=	rawPtr;
+	bandInfo.columnBytes	=	elementsPerClm * bandInfo.elementBytes;
+	bandInfo.numClms	=	binaryImageHdr.Dimension1;
+	if ((bandInfo.numClms <= 0) || (bandInfo.columnBytes <= 0) ||
+		((bandInfo.columnBytes * bandInfo.numClms) > rawLen))
+	{
+		CONSOLE_DEBUG("Image dimensions do not match the data");
+		return(NULL);
+	}
+	rawLen				=	bandInfo.columnBytes * bandInfo.numClms;
+	bandInfo.bandCount	=	kDeflate_MaxBands;
+	if (bandInfo.bandCount > bandInfo.numClms)
+	{
+		bandInfo.bandCount	=	bandInfo.numClms;
+	}
+	maxBandBytes		=	((bandInfo.numClms + bandInfo.bandCount - 1) / bandInfo.bandCount) * bandInfo.columnBytes;
+	bandInfo.slotSize	=	ImageKernel_DeflateBound(maxBandBytes);
+	bandInfo.slotBuf	=	(uint8_t *)malloc(bandInfo.slotSize * bandInfo.bandCount);
+	if (bandInfo.slotBuf == NULL)
+	{
+		CONSOLE_DEBUG("Failed to allocate compression buffer");
+		return(NULL);
+	}
+
+	ImageKernel_RunRowBands(bandInfo.numClms, Deflate_BandProc, &bandInfo);
+
+	compressedLen	=	0;
+	for (bb=0; bb<bandInfo.bandCount; bb++)
+	{
+		if (bandInfo.bandLen[bb] <= 0)
+		{
+			compressedLen	=	rawLen;		//*	a band failed, send it uncompressed
+			break;
+		}
+		compressedLen	+=	bandInfo.bandLen[bb];
+	}
+	if (compressedLen >= rawLen)
+	{
+		free(bandInfo.slotBuf);
+		return(NULL);
+	}
+
+	memset((void *)&compressInfo, 0, sizeof(TYPE_CompressedImageInfo));
+	compressInfo.ElementType		=	binaryImageHdr.TransmissionElementType;
+	compressInfo.Codec				=	kAlpacaCodec_Deflate;
+	compressInfo.Predictor			=	kAlpacaPredictor_Delta;
+	compressInfo.PredictorStride	=	bandInfo.stride;
+	compressInfo.BandCount			=	bandInfo.bandCount;
+	compressInfo.UncompressedSize	=	rawLen;
+
+	binaryImageHdr.TransmissionElementType	=	kAlpacaImageData_Compressed;
+	binaryImageHdr.DataStart				=	sizeof(TYPE_BinaryImageHdr) +
+												sizeof(TYPE_CompressedImageInfo) +
+												(bandInfo.bandCount * sizeof(int32_t));
+
+	cDeflateRatio	=	(1.0 * rawLen) / compressedLen;
+
+	//*	time to build the HTTP header
+	sprintf(httpHeader,	"HTTP/1.0 200 OK\r\n"
+						"Content-Length: %ld\r\n"
+						"Content-type: application/imagebytes; charset=utf-8\r\n"
+						"Server: AlpacaPi\r\n"
+						"AlpacaPi-Compressed: deflate, bands=%d, ratio=%1.2f\r\n"
+						"\r\n",
+						(binaryImageHdr.DataStart + compressedLen),
+						bandInfo.bandCount,
+						cDeflateRatio);
+	httpHeaderSize	=	strlen(httpHeader);
+
+	*responseLen	=	httpHeaderSize + binaryImageHdr.DataStart + compressedLen;
+	responseBuf		=	(uint8_t *)malloc(*responseLen);
+	if (responseBuf != NULL)
+	{
+		memcpy(responseBuf, httpHeader, httpHeaderSize);
+		ccc	=	httpHeaderSize;
+		memcpy(&responseBuf[ccc], &binaryImageHdr, sizeof(TYPE_BinaryImageHdr));
+		ccc	+=	sizeof(TYPE_BinaryImageHdr);
+		memcpy(&responseBuf[ccc], &compressInfo, sizeof(TYPE_CompressedImageInfo));
+		ccc	+=	sizeof(TYPE_CompressedImageInfo);
+		for (bb=0; bb<bandInfo.bandCount; bb++)
+		{
+			bandSize	=	bandInfo.bandLen[bb];
+			memcpy(&responseBuf[ccc], &bandSize, sizeof(int32_t));
+			ccc	+=	sizeof(int32_t);
+		}
+		for (bb=0; bb<bandInfo.bandCount; bb++)
+		{
+			memcpy(&responseBuf[ccc], &bandInfo.slotBuf[bb * bandInfo.slotSize], bandInfo.bandLen[bb]);
+			ccc	+=	bandInfo.bandLen[bb];
+		}
+		cDeflateCount++;
+		cDeflate_ms	=	millis() - startMillisecs;
+		CONSOLE_DEBUG_W_DBL("Compression ratio    \t=", cDeflateRatio);
+		CONSOLE_DEBUG_W_NUM("Compression time (ms)\t=", cDeflate_ms);
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_SIZE("Failed to allocate data buffer of size", *responseLen);
+	}
+	free(bandInfo.slotBuf);
+	return(responseBuf);
+}
+
+//*****************************************************************************
+void	CameraDriver::ImageBytes_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagebytes_deflate_count",
+									cDeflateCount,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagebytes_deflate_ratio",
+									cDeflateRatio,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagebytes_deflate_ms",
+									cDeflate_ms,
+									INCLUDE_COMMA);
+}
+
+#endif // _ENABLE_CAMERA_ && _ENABLE_IMAGEBYTES_DEFLATE_
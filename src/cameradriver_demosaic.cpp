@@ -0,0 +1,350 @@
+//**************************************************************************
+//*	Name:			cameradriver_demosaic.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Bayer demosaic of RAW8/RAW16 frames from color cameras
+//*
+//*					This does not depend on the vendor SDK, it is used for the
+//*					OpenCV image, which is what the live window, JPEG and PNG files use.
+//*					The frame itself (imagearray and FITS) stays raw.
+//*
+//*					RAW8 goes to RGB24, RAW16 goes to RGB24 or RGB48.
+//*					The row kernels are in image_kernels.c (SSE2/NEON),
+//*					the frame is split into row bands that run in parallel.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_demosaic.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<ctype.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+//*****************************************************************************
+//*	same order as TYPE_BAYER_PAT
+static const char	*gBayerPatternNames[]	=
+{
+	"RGGB",
+	"BGGR",
+	"GRBG",
+	"GBRG"
+};
+
+//*****************************************************************************
+typedef struct	//	TYPE_DEMOSAIC_BAND
+{
+	const uint8_t	*srcPtr;
+	uint8_t			*dstPtr;
+	int				width;
+	int				height;
+	int				dstRowBytes;
+	bool			source16;
+	bool			output48;
+	int				bayerPattern;
+	int				method;
+} TYPE_DEMOSAIC_BAND;
+
+//*****************************************************************************
+//*	called by ImageKernel_RunRowBands() for each band of rows
+//*****************************************************************************
+static void	Demosaic_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_DEMOSAIC_BAND	*bandInfo;
+int					rowIdx;
+int					prevIdx;
+int					nextIdx;
+int					srcRowBytes;
+int					redRow;
+int					greenFirst;
+const uint8_t		*prevRow;
+const uint8_t		*curRow;
+const uint8_t		*nextRow;
+uint8_t				*dstRow;
+
+	bandInfo	=	(TYPE_DEMOSAIC_BAND *)context;
+	srcRowBytes	=	bandInfo->width * (bandInfo->source16 ? 2 : 1);
+	for (rowIdx=firstRow; rowIdx<lastRow; rowIdx++)
+	{
+		//*	mirror at the top and bottom so the pattern is kept
+		prevIdx	=	(rowIdx > 0) ? (rowIdx - 1) : (rowIdx + 1);
+		nextIdx	=	(rowIdx < (bandInfo->height - 1)) ? (rowIdx + 1) : (rowIdx - 1);
+		if (bandInfo->height < 2)
+		{
+			prevIdx	=	rowIdx;
+			nextIdx	=	rowIdx;
+		}
+		prevRow	=	bandInfo->srcPtr + (prevIdx * srcRowBytes);
+		curRow	=	bandInfo->srcPtr + (rowIdx * srcRowBytes);
+		nextRow	=	bandInfo->srcPtr + (nextIdx * srcRowBytes);
+		dstRow	=	bandInfo->dstPtr + (rowIdx * bandInfo->dstRowBytes);
+
+		//*	RGGB and GRBG have red in the first row, GRBG and GBRG start with green
+		redRow		=	((bandInfo->bayerPattern == kBAYER_PAT_RG) || (bandInfo->bayerPattern == kBAYER_PAT_GR)) ^ (rowIdx & 1);
+		greenFirst	=	((bandInfo->bayerPattern == kBAYER_PAT_GR) || (bandInfo->bayerPattern == kBAYER_PAT_GB)) ^ (rowIdx & 1);
+
+		if (bandInfo->source16 == false)
+		{
+			ImageKernel_DemosaicRow_U8(	dstRow, prevRow, curRow, nextRow,
+										bandInfo->width, redRow, greenFirst, bandInfo->method);
+		}
+		else if (bandInfo->output48)
+		{
+			ImageKernel_DemosaicRow_U16(	(uint16_t *)dstRow,
+											(const uint16_t *)prevRow,
+											(const uint16_t *)curRow,
+											(const uint16_t *)nextRow,
+											bandInfo->width, redRow, greenFirst, bandInfo->method);
+		}
+		else
+		{
+			ImageKernel_DemosaicRow_U16toU8(dstRow,
+											(const uint16_t *)prevRow,
+											(const uint16_t *)curRow,
+											(const uint16_t *)nextRow,
+											bandInfo->width, redRow, greenFirst, bandInfo->method);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	true if frames of this type are to be demosaiced
+//*****************************************************************************
+bool	CameraDriver::Demosaic_IsActive(const TYPE_IMAGE_TYPE imageType)
+{
+	return(cDemosaicEnabled && cIsColorCam && ((imageType == kImageType_RAW8) || (imageType == kImageType_RAW16)));
+}
+
+//*****************************************************************************
+//*	returns the bytes per pixel of the output, 3 (RGB24) or 6 (RGB48)
+//*****************************************************************************
+int	CameraDriver::Demosaic_OutputBytesPerPixel(const TYPE_IMAGE_TYPE imageType)
+{
+	return(((imageType == kImageType_RAW16) && cDemosaicRGB48) ? 6 : 3);
+}
+
+//*****************************************************************************
+//*	dstRowBytes allows for padded destination rows (OpenCV)
+//*****************************************************************************
+bool	CameraDriver::Demosaic_Frame(	const unsigned char		*srcPtr,
+										unsigned char			*dstPtr,
+										const int				width,
+										const int				height,
+										const int				dstRowBytes,
+										const TYPE_IMAGE_TYPE	imageType)
+{
+TYPE_DEMOSAIC_BAND	bandInfo;
+uint32_t			startMilliSecs;
+
+	if ((srcPtr == NULL) || (dstPtr == NULL) || (Demosaic_IsActive(imageType) == false))
+	{
+		return(false);
+	}
+	startMilliSecs	=	millis();
+
+	bandInfo.srcPtr			=	srcPtr;
+	bandInfo.dstPtr			=	dstPtr;
+	bandInfo.width			=	width;
+	bandInfo.height			=	height;
+	bandInfo.dstRowBytes	=	dstRowBytes;
+	bandInfo.source16		=	(imageType == kImageType_RAW16);
+	bandInfo.output48		=	(Demosaic_OutputBytesPerPixel(imageType) == 6);
+	bandInfo.bayerPattern	=	(cDemosaicPattern >= 0) ? cDemosaicPattern : cBayerPattern;
+	bandInfo.method			=	cDemosaicMethod;
+	if ((bandInfo.bayerPattern < kBAYER_PAT_RG) || (bandInfo.bayerPattern > kBAYER_PAT_GB))
+	{
+		bandInfo.bayerPattern	=	kBAYER_PAT_RG;
+	}
+
+	ImageKernel_RunRowBands(height, Demosaic_BandProc, &bandInfo);
+	cDemosaicLast_ms	=	millis() - startMilliSecs;
+	return(true);
+}
+
+//*****************************************************************************
+void	CameraDriver::Demosaic_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	Get_Demosaic(reqData, NULL, "demosaic");
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_Demosaic(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+int					bayerPattern;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cDemosaicEnabled,
+									INCLUDE_COMMA);
+
+	bayerPattern	=	(cDemosaicPattern >= 0) ? cDemosaicPattern : cBayerPattern;
+	if ((bayerPattern < kBAYER_PAT_RG) || (bayerPattern > kBAYER_PAT_GB))
+	{
+		bayerPattern	=	kBAYER_PAT_RG;
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"demosaicmethod",
+									((cDemosaicMethod == kDemosaic_EdgeAware) ? "edge" : "bilinear"),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"demosaicoutput",
+									(cDemosaicRGB48 ? "rgb48" : "rgb24"),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"demosaicpattern",
+									gBayerPatternNames[bayerPattern],
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"demosaic_ms",
+									(cDemosaicEnabled ? cDemosaicLast_ms : 0),
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	demosaic=BOOL
+//*	method=bilinear|edge			(optional)
+//*	output=rgb24|rgb48				(optional, RAW16 only)
+//*	pattern=auto|RGGB|BGGR|GRBG|GBRG	(optional, auto = from the camera)
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_Demosaic(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+bool				optionFound;
+int					iii;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	optionFound	=	false;
+	if (GetKeyWordArgument(reqData->contentData, "Method", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		if (strcasecmp(argumentString, "bilinear") == 0)
+		{
+			cDemosaicMethod	=	kDemosaic_Bilinear;
+		}
+		else if (strcasecmp(argumentString, "edge") == 0)
+		{
+			cDemosaicMethod	=	kDemosaic_EdgeAware;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Method must be 'bilinear' or 'edge'");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Output", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		if (strcasecmp(argumentString, "rgb24") == 0)
+		{
+			cDemosaicRGB48	=	false;
+		}
+		else if (strcasecmp(argumentString, "rgb48") == 0)
+		{
+			cDemosaicRGB48	=	true;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Output must be 'rgb24' or 'rgb48'");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Pattern", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		if (strcasecmp(argumentString, "auto") == 0)
+		{
+			cDemosaicPattern	=	-1;
+		}
+		else
+		{
+			for (iii=kBAYER_PAT_RG; iii<=kBAYER_PAT_GB; iii++)
+			{
+				if (strcasecmp(argumentString, gBayerPatternNames[iii]) == 0)
+				{
+					cDemosaicPattern	=	iii;
+					break;
+				}
+			}
+			if (iii > kBAYER_PAT_GB)
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Pattern must be auto, RGGB, BGGR, GRBG or GBRG");
+			}
+		}
+	}
+
+	foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+											"Demosaic",
+											argumentString,
+											(sizeof(argumentString) -1));
+	if (foundKeyWord)
+	{
+		cDemosaicEnabled	=	IsTrueFalse(argumentString);
+		if (cDemosaicEnabled && (cIsColorCam == false))
+		{
+			cDemosaicEnabled	=	false;
+			alpacaErrCode		=	kASCOM_Err_InvalidOperation;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Not a color camera");
+		}
+	}
+	else if (optionFound == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'demosaic' not found");
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
@@ -0,0 +1,333 @@
+//**************************************************************************
+//*	Name:			cameradriver_encode.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	JPEG and PNG output through image_encode.c
+//*
+//*					The JPEG that the web page shows is made on every exposure,
+//*					this replaces cv::imwrite() / cvSaveImage() with the strip encoder
+//*					which runs on all cores. The OpenCV output is still available
+//*					with encoder=legacy.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_encode.cpp
+//*	Oct 19,	2026	<MLS> Image size comes from GetLastFrameSize()
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_encode.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+//*****************************************************************************
+//*	same order as kPNGfilter_xxx
+static const char	*gPNGfilterNames[]	=
+{
+	"none",
+	"sub",
+	"up",
+	"average",
+	"paeth",
+	"adaptive"
+};
+
+//*****************************************************************************
+//*	describes the raw camera buffer, RGB24 from the camera is in BGR order
+//*****************************************************************************
+void	CameraDriver::ImageEncode_SetupRawImage(TYPE_ENCODE_IMAGE *encodeImage)
+{
+	GetImage_ROI_info();
+
+	memset(encodeImage, 0, sizeof(TYPE_ENCODE_IMAGE));
+	encodeImage->pixels			=	cCameraDataBuffer;
+	GetLastFrameSize(&encodeImage->width, &encodeImage->height);
+	encodeImage->channels		=	1;
+	encodeImage->bytesPerSample	=	1;
+	switch(cROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW16:
+			encodeImage->bytesPerSample	=	2;
+			break;
+
+		case kImageType_RGB24:
+			encodeImage->channels		=	3;
+			encodeImage->bgrOrder		=	true;
+			break;
+
+		default:
+			break;
+	}
+	encodeImage->rowBytes	=	encodeImage->width * encodeImage->channels * encodeImage->bytesPerSample;
+}
+
+//*****************************************************************************
+//*	returns false if the encoder is not enabled or not built in,
+//*	the caller then uses the original output
+//*****************************************************************************
+bool	CameraDriver::ImageEncode_SaveFile(	const TYPE_ENCODE_IMAGE	*encodeImage,
+											const char				*imageFilePath,
+											const bool				saveAsPNG)
+{
+uint32_t	startMilliSecs;
+uint32_t	encode_ms;
+bool		saveOK;
+
+	if ((cImageEncodeFast == false) || (encodeImage->pixels == NULL))
+	{
+		return(false);
+	}
+	if ((saveAsPNG && (ImageEncode_PNGsupported() == false)) ||
+		((saveAsPNG == false) && (ImageEncode_JPEGsupported() == false)))
+	{
+		return(false);
+	}
+
+	startMilliSecs	=	millis();
+	if (saveAsPNG)
+	{
+		saveOK	=	ImageEncode_SavePNG(encodeImage, &cImageEncodeOptions, imageFilePath);
+	}
+	else
+	{
+		saveOK	=	ImageEncode_SaveJPEG(encodeImage, &cImageEncodeOptions, imageFilePath);
+	}
+	encode_ms	=	millis() - startMilliSecs;
+	if (saveAsPNG)
+	{
+		cPngEncode_ms	=	encode_ms;
+		CONSOLE_DEBUG_W_NUM("PNG encode time (ms)\t=", encode_ms);
+	}
+	else
+	{
+		cJpegEncode_ms	=	encode_ms;
+		CONSOLE_DEBUG_W_NUM("JPEG encode time (ms)\t=", encode_ms);
+	}
+	if (saveOK == false)
+	{
+		CONSOLE_DEBUG_W_STR("Failed to save", imageFilePath);
+	}
+	return(saveOK);
+}
+
+//*****************************************************************************
+void	CameraDriver::ImageEncode_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	Get_ImageEncode(reqData, NULL, "imageencode");
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_ImageEncode(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+int					pngFilter;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									(cImageEncodeFast ? "fast" : "legacy"),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"jpegquality",
+									cImageEncodeOptions.jpegQuality,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"jpegfastdct",
+									cImageEncodeOptions.jpegFastDCT,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pngcompression",
+									cImageEncodeOptions.pngCompression,
+									INCLUDE_COMMA);
+
+	pngFilter	=	cImageEncodeOptions.pngFilter;
+	if ((pngFilter < kPNGfilter_None) || (pngFilter >= kPNGfilter_Last))
+	{
+		pngFilter	=	kImageEncode_DefaultPngFilter;
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pngfilter",
+									gPNGfilterNames[pngFilter],
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"encodestrips",
+									cImageEncodeOptions.stripCount,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"jpegencode_ms",
+									cJpegEncode_ms,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pngencode_ms",
+									cPngEncode_ms,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	encoder=fast|legacy
+//*	quality=INT					(optional, JPEG 1 -> 100)
+//*	fastdct=BOOL				(optional, JPEG)
+//*	compression=INT				(optional, PNG 0 -> 9)
+//*	filter=none|sub|up|average|paeth|adaptive	(optional, PNG)
+//*	strips=INT					(optional, 0 = one per cpu)
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_ImageEncode(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				optionFound;
+int					argValue;
+int					iii;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	optionFound	=	false;
+	if (GetKeyWordArgument(reqData->contentData, "Encoder", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		if (strcasecmp(argumentString, "fast") == 0)
+		{
+			cImageEncodeFast	=	true;
+		}
+		else if (strcasecmp(argumentString, "legacy") == 0)
+		{
+			cImageEncodeFast	=	false;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Encoder must be 'fast' or 'legacy'");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Quality", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		argValue	=	atoi(argumentString);
+		if ((argValue >= 1) && (argValue <= 100))
+		{
+			cImageEncodeOptions.jpegQuality	=	argValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Quality must be 1 to 100");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "FastDCT", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		cImageEncodeOptions.jpegFastDCT	=	IsTrueFalse(argumentString);
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Compression", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		argValue	=	atoi(argumentString);
+		if ((argValue >= 0) && (argValue <= 9))
+		{
+			cImageEncodeOptions.pngCompression	=	argValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Compression must be 0 to 9");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Filter", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		for (iii=kPNGfilter_None; iii<kPNGfilter_Last; iii++)
+		{
+			if (strcasecmp(argumentString, gPNGfilterNames[iii]) == 0)
+			{
+				cImageEncodeOptions.pngFilter	=	iii;
+				break;
+			}
+		}
+		if (iii >= kPNGfilter_Last)
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Filter must be none, sub, up, average, paeth or adaptive");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Strips", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		argValue	=	atoi(argumentString);
+		if ((argValue >= 0) && (argValue <= kImageKernel_MaxThreads))
+		{
+			cImageEncodeOptions.stripCount	=	argValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Strips out of range");
+		}
+	}
+
+	if (optionFound == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'encoder' not found");
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
@@ -104,6 +104,9 @@
 //*	Apr 10,	2024	<MLS> FITS data now supports GPS from serial port
 //*	Apr 18,	2024	<MLS> Added filter wheel serial number to fits output if it exists
 //*	Apr 22,	2024	<MLS> Added support for kImageType_MONO8 (8 bit image type)
+//*	Oct 19,	2026	<MLS> Added star count, HFR & FWHM to observation info
+//*	Oct 19,	2026	<MLS> Added plate solve WCS to observation info
+//*	Oct 19,	2026	<MLS> Image data size comes from GetLastFrameSize(), not the sensor size
 //*****************************************************************************
 
 #if defined(_ENABLE_CAMERA_) && defined(_ENABLE_FITS_)
@@ -404,6 +407,8 @@ fitsfile		*fitsFilePtr;
 int				fitsRetCode;
 int				fitsStatus;
 long			naxes[3];
+int				frameWidth;
+int				frameHeight;
 int				axisCnt;
 double			bzero;
 double			bscale;
@@ -430,8 +435,9 @@ int				iii;
 	strcat(imageFilePath, "/");
 	strcat(imageFilePath, imageFileName);
 
-	naxes[0]		=	cCameraProp.CameraXsize;
-	naxes[1]		=	cCameraProp.CameraYsize;
+	GetLastFrameSize(&frameWidth, &frameHeight);
+	naxes[0]		=	frameWidth;
+	naxes[1]		=	frameHeight;
 	naxes[2]		=	3;				//*	only used for color RGB images (3 planes)
 	axisCnt			=	2;				//*	for all formats except RGB
 	fits_bitpix		=	SHORT_IMG;
@@ -629,7 +635,7 @@ int				iii;
 		long			fpixelArray[4];
 
 //			CONSOLE_DEBUG("Writing image data to FITS file");
-			nelements	=	cCameraProp.CameraXsize * cCameraProp.CameraYsize;
+			nelements	=	(LONGLONG)frameWidth * frameHeight;
 
 
 			fpixelArray[0]	=	1;
@@ -657,7 +663,7 @@ int				iii;
 //					CONSOLE_DEBUG(__FUNCTION__);
 					if (cCameraBGRbuffer != NULL)
 					{
-						nelements		=	3 * cCameraProp.CameraXsize * cCameraProp.CameraYsize;
+						nelements		=	3 * (LONGLONG)frameWidth * frameHeight;
 						fitsRetCode		=	fits_write_pix(	fitsFilePtr,
 												fitsDataType,
 												fpixelArray,
@@ -1845,6 +1851,12 @@ struct tm		myLocalTime;
 												&saturationPrcnt,
 												"Percentage of pixels at saturation", &fitsStatus);
 
+		//*	star count, HFR & FWHM
+		StarAnalysis_WriteFITS(fitsFilePtr);
+
+		//*	WCS from the plate solve
+		PlateSolve_WriteFITS(fitsFilePtr);
+
 		//---------------------------------------------------------------------------------------
 		//*	Histogram information
 		//*	this histogram was already calculated before the FITS routine was called.
@@ -2657,6 +2669,8 @@ int				leftOverCount;
 void		CameraDriver::CreateFitsBGRimage(void)
 {
 long			frameBufSize;
+int				frameWidth;
+int				frameHeight;
 long			iii;
 long			ppp;
 unsigned char	*redBufPtr;
@@ -2665,12 +2679,14 @@ unsigned char	*bluBufPtr;
 
 //	CONSOLE_DEBUG(__FUNCTION__);
 
-	frameBufSize	=	cCameraProp.CameraXsize * cCameraProp.CameraYsize;
+	GetLastFrameSize(&frameWidth, &frameHeight);
+	frameBufSize	=	(long)frameWidth * frameHeight;
 	if (cCameraDataBuffer != NULL)
 	{
 		if (cCameraBGRbuffer == NULL)
 		{
-			cCameraBGRbuffer	=	(unsigned char *)malloc((frameBufSize * 3) + 100);
+			//*	full sensor size, so it is big enough for any binning or sub frame
+			cCameraBGRbuffer	=	(unsigned char *)malloc(((long)cCameraProp.CameraXsize * cCameraProp.CameraYsize * 3) + 100);
 		}
 
 		if (cCameraBGRbuffer != NULL)
@@ -0,0 +1,691 @@
+//**************************************************************************
+//*	Name:			cameradriver_hotpixel.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Hot / cold pixel map and cosmetic correction
+//*
+//*					The map is built from a dark frame, each pixel that is more than
+//*					"sigma" away from the median of its neighbors is listed as a defect.
+//*					The map is saved in the calibration directory as a sorted list of
+//*					pixel indexes, one file per camera, geometry, gain and temperature.
+//*
+//*					Correction only touches the pixels in the list, each one is replaced
+//*					with the median of its (same color) neighbors, so the cost depends on the
+//*					number of defects, not the size of the image.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_hotpixel.cpp
+//*	Oct 19,	2026	<MLS> Added HotPixel_DetectFromFrame() & HotPixel_CorrectFrame()
+//*	Oct 19,	2026	<MLS> The defect list is shrunk into a temporary pointer
+//*	Oct 19,	2026	<MLS> Serial number is copied with snprintf()
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<ctype.h>
+#include	<dirent.h>
+#include	<errno.h>
+#include	<math.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<sys/stat.h>
+#include	<sys/types.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+
+#define	kHotPixelMagic		"ALPHOTPX"
+#define	kHotPixelVersion	1
+
+//*****************************************************************************
+//*	pixel access for the 3 buffer layouts, channel is only used for RGB24
+//*****************************************************************************
+static uint32_t	HotPixel_GetValue(const unsigned char *imageData, int imageType, long pixelIndex, int channel)
+{
+uint32_t	pixelValue;
+
+	switch(imageType)
+	{
+		case kImageType_RAW16:
+			pixelValue	=	((const uint16_t *)imageData)[pixelIndex];
+			break;
+
+		case kImageType_RGB24:
+			pixelValue	=	imageData[(pixelIndex * 3) + channel];
+			break;
+
+		default:
+			pixelValue	=	imageData[pixelIndex];
+			break;
+	}
+	return(pixelValue);
+}
+
+//*****************************************************************************
+static void	HotPixel_SetValue(unsigned char *imageData, int imageType, long pixelIndex, int channel, uint32_t pixelValue)
+{
+	switch(imageType)
+	{
+		case kImageType_RAW16:
+			((uint16_t *)imageData)[pixelIndex]	=	pixelValue;
+			break;
+
+		case kImageType_RGB24:
+			imageData[(pixelIndex * 3) + channel]	=	pixelValue;
+			break;
+
+		default:
+			imageData[pixelIndex]	=	pixelValue;
+			break;
+	}
+}
+
+//*****************************************************************************
+//*	insertion sort, there are never more than 8 values
+//*****************************************************************************
+static uint32_t	HotPixel_Median(uint32_t *valueList, int valueCnt)
+{
+int			iii;
+int			jjj;
+uint32_t	tempValue;
+
+	for (iii=1; iii<valueCnt; iii++)
+	{
+		tempValue	=	valueList[iii];
+		jjj			=	iii - 1;
+		while ((jjj >= 0) && (valueList[jjj] > tempValue))
+		{
+			valueList[jjj + 1]	=	valueList[jjj];
+			jjj--;
+		}
+		valueList[jjj + 1]	=	tempValue;
+	}
+	return(valueList[valueCnt / 2]);
+}
+
+//*****************************************************************************
+static int	HotPixel_CompareIndex(const void *ptr1, const void *ptr2)
+{
+uint32_t	index1	=	*((const uint32_t *)ptr1);
+uint32_t	index2	=	*((const uint32_t *)ptr2);
+
+	if (index1 < index2)
+	{
+		return(-1);
+	}
+	return((index1 > index2) ? 1 : 0);
+}
+
+//*****************************************************************************
+//*	fills in the header with the current camera settings and last frame geometry
+//*****************************************************************************
+void	CameraDriver::HotPixel_FillHeader(TYPE_HOTPIXEL_HEADER *hotPixelHeader)
+{
+	memset(hotPixelHeader, 0, sizeof(TYPE_HOTPIXEL_HEADER));
+	memcpy(hotPixelHeader->magic, kHotPixelMagic, sizeof(hotPixelHeader->magic));
+	hotPixelHeader->version		=	kHotPixelVersion;
+	snprintf(hotPixelHeader->serialNum, sizeof(hotPixelHeader->serialNum), "%.*s",
+					(int)(sizeof(hotPixelHeader->serialNum) - 1), cDeviceSerialNum);
+	hotPixelHeader->imageType	=	cLastExposure_ROIinfo.currentROIimageType;
+	hotPixelHeader->width		=	cLastExposure_ROIinfo.currentROIwidth;
+	hotPixelHeader->height		=	cLastExposure_ROIinfo.currentROIheight;
+	hotPixelHeader->binning		=	cCameraProp.BinX;
+	hotPixelHeader->gain		=	cCameraProp.Gain;
+	if (cTempReadSupported)
+	{
+		//*	small temperature changes should not cause a new lookup
+		hotPixelHeader->sensorTemp	=	round(cCameraProp.CCDtemperature);
+	}
+}
+
+//*****************************************************************************
+void	CameraDriver::HotPixel_FreeMap(void)
+{
+	DISPOSEPTR_IF_INUSE(cHotPixelList);
+	memset(&cHotPixelHeader, 0, sizeof(TYPE_HOTPIXEL_HEADER));
+}
+
+//*****************************************************************************
+bool	CameraDriver::HotPixel_IsDefect(uint32_t pixelIndex)
+{
+	if (cHotPixelList == NULL)
+	{
+		return(false);
+	}
+	return(bsearch(&pixelIndex, cHotPixelList, cHotPixelHeader.defectCount, sizeof(uint32_t), HotPixel_CompareIndex) != NULL);
+}
+
+//*****************************************************************************
+//*	looks through the calibration directory for the map that matches this camera
+//*	and the current geometry, same gain is preferred, then the closest temperature
+//*****************************************************************************
+bool	CameraDriver::HotPixel_FindMap(void)
+{
+DIR						*directory;
+struct dirent			*dirEntry;
+FILE					*filePointer;
+TYPE_HOTPIXEL_HEADER	fileHeader;
+char					filePath[kMaxFileNameLen];
+char					bestFileName[kMaxFileNameLen];
+double					bestScore;
+double					score;
+size_t					readCnt;
+bool					mapLoaded;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	HotPixel_FreeMap();
+	bestFileName[0]	=	0;
+	bestScore		=	1.0e9;
+	directory		=	opendir(kCalibrationDir);
+	if (directory != NULL)
+	{
+		while ((dirEntry = readdir(directory)) != NULL)
+		{
+			if (strstr(dirEntry->d_name, ".hpm") == NULL)
+			{
+				continue;
+			}
+			if ((strlen(kCalibrationDir) + strlen(dirEntry->d_name) + 2) >= sizeof(filePath))
+			{
+				continue;
+			}
+			sprintf(filePath, "%s/%s", kCalibrationDir, dirEntry->d_name);
+			filePointer	=	fopen(filePath, "r");
+			if (filePointer == NULL)
+			{
+				continue;
+			}
+			readCnt	=	fread(&fileHeader, sizeof(TYPE_HOTPIXEL_HEADER), 1, filePointer);
+			fclose(filePointer);
+			if ((readCnt != 1) ||
+				(memcmp(fileHeader.magic, kHotPixelMagic, sizeof(fileHeader.magic)) != 0) ||
+				(fileHeader.version		!= kHotPixelVersion) ||
+				(strncmp(fileHeader.serialNum, cHotPixelLookupKey.serialNum, sizeof(fileHeader.serialNum)) != 0) ||
+				(fileHeader.imageType	!= cHotPixelLookupKey.imageType) ||
+				(fileHeader.width		!= cHotPixelLookupKey.width) ||
+				(fileHeader.height		!= cHotPixelLookupKey.height) ||
+				(fileHeader.binning		!= cHotPixelLookupKey.binning))
+			{
+				continue;
+			}
+			score	=	fabs(fileHeader.sensorTemp - cHotPixelLookupKey.sensorTemp);
+			if (fileHeader.gain != cHotPixelLookupKey.gain)
+			{
+				score	+=	1000.0;
+			}
+			if (score < bestScore)
+			{
+				bestScore	=	score;
+				strcpy(bestFileName, filePath);
+			}
+		}
+		closedir(directory);
+	}
+
+	mapLoaded	=	false;
+	if (bestFileName[0] != 0)
+	{
+		filePointer	=	fopen(bestFileName, "r");
+		if (filePointer != NULL)
+		{
+			readCnt	=	fread(&cHotPixelHeader, sizeof(TYPE_HOTPIXEL_HEADER), 1, filePointer);
+			if ((readCnt == 1) && (cHotPixelHeader.defectCount > 0) && (cHotPixelHeader.defectCount <= kHotPixelMaxDefects))
+			{
+				cHotPixelList	=	(uint32_t *)malloc(cHotPixelHeader.defectCount * sizeof(uint32_t));
+				if (cHotPixelList != NULL)
+				{
+					readCnt		=	fread(cHotPixelList, sizeof(uint32_t), cHotPixelHeader.defectCount, filePointer);
+					mapLoaded	=	(readCnt == (size_t)cHotPixelHeader.defectCount);
+				}
+			}
+			fclose(filePointer);
+		}
+		if (mapLoaded)
+		{
+			CONSOLE_DEBUG_W_STR("Hot pixel map loaded\t=", bestFileName);
+			CONSOLE_DEBUG_W_NUM("Defect count\t\t=", cHotPixelHeader.defectCount);
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_STR("Failed to read hot pixel map\t=", bestFileName);
+			HotPixel_FreeMap();
+		}
+	}
+	return(mapLoaded);
+}
+
+//*****************************************************************************
+//*	the current frame is expected to be a dark
+//*	the global median and MAD are found from a histogram, any pixel that is outside
+//*	of sigma from that is then compared to the median of its neighbors
+//*****************************************************************************
+void	CameraDriver::HotPixel_DetectFromFrame(void)
+{
+TYPE_HOTPIXEL_HEADER	mapHeader;
+uint32_t				*histogram;
+uint32_t				*defectList;
+uint32_t				*shrunkList;
+uint32_t				neighborValues[8];
+uint32_t				histogramSize;
+uint32_t				pixelValue;
+uint32_t				globalMedian;
+uint32_t				madValue;
+uint32_t				localMedian;
+uint32_t				runningCount;
+long					pixelCount;
+long					pixelIndex;
+double					noiseSigma;
+double					threshold;
+int						channelCnt;
+int						channel;
+int						step;
+int						xxx;
+int						yyy;
+int						deltaX;
+int						deltaY;
+int						neighborX;
+int						neighborY;
+int						neighborCnt;
+int						defectCnt;
+int						hotCnt;
+int						coldCnt;
+bool					isDefect;
+char					serialNum[32];
+char					fileName[kMaxFileNameLen];
+FILE					*filePointer;
+size_t					writeCnt;
+int						mkdirErrCode;
+int						iii;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	cHotPixelDetectPending	=	false;
+	if (cCameraDataBuffer == NULL)
+	{
+		return;
+	}
+	HotPixel_FillHeader(&mapHeader);
+	pixelCount		=	(long)mapHeader.width * mapHeader.height;
+	channelCnt		=	(mapHeader.imageType == kImageType_RGB24) ? 3 : 1;
+	histogramSize	=	(mapHeader.imageType == kImageType_RAW16) ? 65536 : 256;
+	//*	on a color camera, the raw neighbors of the same color are 2 pixels away
+	step			=	(cIsColorCam && ((mapHeader.imageType == kImageType_RAW8) || (mapHeader.imageType == kImageType_RAW16))) ? 2 : 1;
+
+	histogram	=	(uint32_t *)calloc(histogramSize, sizeof(uint32_t));
+	defectList	=	(uint32_t *)malloc(kHotPixelMaxDefects * sizeof(uint32_t));
+	if ((histogram == NULL) || (defectList == NULL))
+	{
+		CONSOLE_DEBUG("Failed to allocate memory");
+		DISPOSEPTR_IF_INUSE(histogram);
+		DISPOSEPTR_IF_INUSE(defectList);
+		return;
+	}
+
+	//*	global median
+	for (pixelIndex=0; pixelIndex<pixelCount; pixelIndex++)
+	{
+		for (channel=0; channel<channelCnt; channel++)
+		{
+			histogram[HotPixel_GetValue(cCameraDataBuffer, mapHeader.imageType, pixelIndex, channel)]++;
+		}
+	}
+	globalMedian	=	0;
+	runningCount	=	histogram[0];
+	while ((runningCount < ((pixelCount * channelCnt) / 2)) && (globalMedian < (histogramSize - 1)))
+	{
+		globalMedian++;
+		runningCount	+=	histogram[globalMedian];
+	}
+	//*	median absolute deviation, counted outward from the median
+	madValue		=	0;
+	runningCount	=	histogram[globalMedian];
+	while ((runningCount < ((pixelCount * channelCnt) / 2)) && (madValue < histogramSize))
+	{
+		madValue++;
+		if (globalMedian >= madValue)
+		{
+			runningCount	+=	histogram[globalMedian - madValue];
+		}
+		if ((globalMedian + madValue) < histogramSize)
+		{
+			runningCount	+=	histogram[globalMedian + madValue];
+		}
+	}
+	noiseSigma	=	1.4826 * madValue;
+	if (noiseSigma < 1.0)
+	{
+		noiseSigma	=	1.0;
+	}
+	threshold	=	cHotPixelSigma * noiseSigma;
+
+	//*	the pixels that are far from the global median are checked against their neighbors
+	defectCnt	=	0;
+	hotCnt		=	0;
+	coldCnt		=	0;
+	for (yyy=0; yyy<mapHeader.height; yyy++)
+	{
+		for (xxx=0; xxx<mapHeader.width; xxx++)
+		{
+			pixelIndex	=	((long)yyy * mapHeader.width) + xxx;
+			isDefect	=	false;
+			for (channel=0; channel<channelCnt; channel++)
+			{
+				pixelValue	=	HotPixel_GetValue(cCameraDataBuffer, mapHeader.imageType, pixelIndex, channel);
+				if (fabs((double)pixelValue - globalMedian) <= threshold)
+				{
+					continue;
+				}
+				neighborCnt	=	0;
+				for (deltaY = -1; deltaY <= 1; deltaY++)
+				{
+					for (deltaX = -1; deltaX <= 1; deltaX++)
+					{
+						neighborX	=	xxx + (deltaX * step);
+						neighborY	=	yyy + (deltaY * step);
+						if (((deltaX != 0) || (deltaY != 0)) &&
+							(neighborX >= 0) && (neighborX < mapHeader.width) &&
+							(neighborY >= 0) && (neighborY < mapHeader.height))
+						{
+							neighborValues[neighborCnt++]	=	HotPixel_GetValue(	cCameraDataBuffer,
+																				mapHeader.imageType,
+																				((long)neighborY * mapHeader.width) + neighborX,
+																				channel);
+						}
+					}
+				}
+				localMedian	=	HotPixel_Median(neighborValues, neighborCnt);
+				if (pixelValue > (localMedian + threshold))
+				{
+					hotCnt++;
+					isDefect	=	true;
+				}
+				else if ((pixelValue + threshold) < localMedian)
+				{
+					coldCnt++;
+					isDefect	=	true;
+				}
+				if (isDefect)
+				{
+					break;
+				}
+			}
+			if (isDefect)
+			{
+				if (defectCnt >= kHotPixelMaxDefects)
+				{
+					CONSOLE_DEBUG("Too many defects, was this a dark frame?");
+					DISPOSEPTR_IF_INUSE(histogram);
+					DISPOSEPTR_IF_INUSE(defectList);
+					return;
+				}
+				//*	scanned in order, so the list is already sorted
+				defectList[defectCnt++]	=	pixelIndex;
+			}
+		}
+	}
+	DISPOSEPTR_IF_INUSE(histogram);
+	mapHeader.hotCount		=	hotCnt;
+	mapHeader.coldCount		=	coldCnt;
+	mapHeader.defectCount	=	defectCnt;
+	CONSOLE_DEBUG_W_NUM("globalMedian\t=", globalMedian);
+	CONSOLE_DEBUG_W_NUM("hotCnt\t\t=", hotCnt);
+	CONSOLE_DEBUG_W_NUM("coldCnt\t\t=", coldCnt);
+
+	//*	the serial number becomes part of the file name
+	strcpy(serialNum, (strlen(mapHeader.serialNum) > 0) ? mapHeader.serialNum : "camera");
+	for (iii=0; serialNum[iii] != 0; iii++)
+	{
+		if (isalnum(serialNum[iii]) == 0)
+		{
+			serialNum[iii]	=	'_';
+		}
+	}
+	mkdirErrCode	=	mkdir(kCalibrationDir, 0744);
+	if ((mkdirErrCode != 0) && (errno != EEXIST))
+	{
+		CONSOLE_DEBUG_W_STR("Failed to create directory\t=", kCalibrationDir);
+	}
+	sprintf(fileName, "%s/hotpixels_%s_%dx%d_b%d_g%d_t%d.hpm",	kCalibrationDir,
+																serialNum,
+																mapHeader.width,
+																mapHeader.height,
+																mapHeader.binning,
+																mapHeader.gain,
+																(int)mapHeader.sensorTemp);
+	filePointer	=	fopen(fileName, "w");
+	if (filePointer != NULL)
+	{
+		writeCnt	=	fwrite(&mapHeader, sizeof(TYPE_HOTPIXEL_HEADER), 1, filePointer);
+		if (writeCnt == 1)
+		{
+			writeCnt	=	fwrite(defectList, sizeof(uint32_t), defectCnt, filePointer);
+		}
+		fclose(filePointer);
+		CONSOLE_DEBUG_W_STR("Hot pixel map saved\t=", fileName);
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Failed to create\t=", fileName);
+	}
+
+	//*	the new map becomes the current map
+	HotPixel_FreeMap();
+	if (defectCnt > 0)
+	{
+		//*	shrink it to what was found, keep the original if that fails
+		shrunkList		=	(uint32_t *)realloc(defectList, defectCnt * sizeof(uint32_t));
+		if (shrunkList != NULL)
+		{
+			defectList	=	shrunkList;
+		}
+		cHotPixelList	=	defectList;
+		cHotPixelHeader	=	mapHeader;
+	}
+	else
+	{
+		DISPOSEPTR_IF_INUSE(defectList);
+	}
+	cHotPixelLookupKey	=	mapHeader;
+	cHotPixelLookupKey.hotCount		=	0;
+	cHotPixelLookupKey.coldCount	=	0;
+	cHotPixelLookupKey.defectCount	=	0;
+}
+
+//*****************************************************************************
+//*	replace each listed pixel with the median of its neighbors that are not defects
+//*****************************************************************************
+void	CameraDriver::HotPixel_CorrectFrame(void)
+{
+TYPE_HOTPIXEL_HEADER	currentKey;
+uint32_t				neighborValues[8];
+uint32_t				pixelIndex;
+uint32_t				neighborIndex;
+uint32_t				startMilliSecs;
+int						channelCnt;
+int						channel;
+int						step;
+int						xxx;
+int						yyy;
+int						deltaX;
+int						deltaY;
+int						neighborX;
+int						neighborY;
+int						neighborCnt;
+int						iii;
+
+	if (cCameraDataBuffer == NULL)
+	{
+		return;
+	}
+	startMilliSecs	=	millis();
+	HotPixel_FillHeader(&currentKey);
+	if (memcmp(&currentKey, &cHotPixelLookupKey, sizeof(TYPE_HOTPIXEL_HEADER)) != 0)
+	{
+		cHotPixelLookupKey	=	currentKey;
+		HotPixel_FindMap();
+	}
+	if (cHotPixelList == NULL)
+	{
+		return;
+	}
+
+	channelCnt	=	(currentKey.imageType == kImageType_RGB24) ? 3 : 1;
+	step		=	(cIsColorCam && ((currentKey.imageType == kImageType_RAW8) || (currentKey.imageType == kImageType_RAW16))) ? 2 : 1;
+	for (iii=0; iii<cHotPixelHeader.defectCount; iii++)
+	{
+		pixelIndex	=	cHotPixelList[iii];
+		xxx			=	pixelIndex % currentKey.width;
+		yyy			=	pixelIndex / currentKey.width;
+		for (channel=0; channel<channelCnt; channel++)
+		{
+			neighborCnt	=	0;
+			for (deltaY = -1; deltaY <= 1; deltaY++)
+			{
+				for (deltaX = -1; deltaX <= 1; deltaX++)
+				{
+					neighborX	=	xxx + (deltaX * step);
+					neighborY	=	yyy + (deltaY * step);
+					if (((deltaX != 0) || (deltaY != 0)) &&
+						(neighborX >= 0) && (neighborX < currentKey.width) &&
+						(neighborY >= 0) && (neighborY < currentKey.height))
+					{
+						neighborIndex	=	((uint32_t)neighborY * currentKey.width) + neighborX;
+						if (HotPixel_IsDefect(neighborIndex) == false)
+						{
+							neighborValues[neighborCnt++]	=	HotPixel_GetValue(	cCameraDataBuffer,
+																				currentKey.imageType,
+																				neighborIndex,
+																				channel);
+						}
+					}
+				}
+			}
+			if (neighborCnt > 0)
+			{
+				HotPixel_SetValue(	cCameraDataBuffer,
+									currentKey.imageType,
+									pixelIndex,
+									channel,
+									HotPixel_Median(neighborValues, neighborCnt));
+			}
+		}
+	}
+	cHotPixelLastCorrect_ms	=	millis() - startMilliSecs;
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_HotPixels(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cHotPixelEnabled,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_HotPixels(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"HotPixels",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			cHotPixelEnabled	=	IsTrueFalse(argumentString);
+			//*	look the map up again, a new one may have been copied in
+			memset(&cHotPixelLookupKey, 0, sizeof(TYPE_HOTPIXEL_HEADER));
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'hotpixels' not found");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	sigma=FLOAT	(optional)
+//*	the next frame that is taken is used as the dark to build the map
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_BuildHotPixelMap(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+double				newSigma;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Sigma",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			newSigma	=	atof(argumentString);
+			if ((newSigma >= 2.0) && (newSigma <= 50.0))
+			{
+				cHotPixelSigma	=	newSigma;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Sigma must be between 2 and 50");
+			}
+		}
+		if (alpacaErrCode == kASCOM_Err_Success)
+		{
+			cHotPixelDetectPending	=	true;
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
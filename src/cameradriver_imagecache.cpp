@@ -0,0 +1,1113 @@
+//**************************************************************************
+//*	Name:			cameradriver_imagecache.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Cache of the serialized imagearray for the current frame
+//*
+//*					A guider display, a capture program and a web page can all ask for
+//*					the same frame. Without this, every request builds the imagebytes
+//*					buffer or the JSON text again.
+//*					Each serialized form is kept, keyed by the frame number and the
+//*					transmission format, and later requests just write() it.
+//*
+//*					imagebytes	the complete response including the HTTP header,
+//*								the header only depends on the format
+//*					JSON		the text of the "Value" array, the fields around it
+//*								(ImageTime, ccdtemperature, transaction IDs) are still
+//*								added for each request
+//*
+//*					The cache is emptied when the next frame is read (camera thread)
+//*					while clients may still be sending an entry (listen thread).
+//*					The table is protected by cImageCacheMutex and every entry is
+//*					reference counted, ImageCache_Find() returns it pinned and the
+//*					data is freed by the last ImageCache_Release().
+//*
+//*					An entry is only kept if the cache stays under
+//*					kImageCache_MaxMemoryPct of RAM and at least kImageCache_MinFree_MB
+//*					stays available, otherwise the buffer is sent and freed like before.
+//*
+//*					The JSON text is column major ([[column 0], [column 1], ...]).
+//*					It is built directly into one buffer: the first pass measures every
+//*					column, the second writes each column at its offset. Both passes
+//*					run on bands of columns (ImageKernel_RunRowBands), each band walks
+//*					the rows once for 16 columns at a time, so the frame is read a cache
+//*					line at a time instead of one pixel per line.
+//*
+//*					imagebytes responses support HTTP Range requests so a client
+//*					can resume an interrupted download. The ETag names the frame
+//*					(the time the driver started, cFramesRead and the time the exposure
+//*					ended) and the format, so it does not repeat after a restart. The client
+//*					sends it back in If-Range. Every imagebytes entry that is sent is
+//*					kept for kImageCache_ResumeSecs even if new frames arrive, so a
+//*					resumed request gets the rest of the frame it started with.
+//*					Entries of older frames are the first to go when a new frame needs
+//*					the room. After that the tag does not match and the current frame
+//*					is sent in full.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_imagecache.cpp
+//*	Oct 19,	2026	<MLS> Added ImageCache_SendResponse() with HTTP Range support
+//*	Oct 19,	2026	<MLS> Entries are reference counted, the table is protected by cImageCacheMutex
+//*	Oct 19,	2026	<MLS> An interrupted download is kept kImageCache_ResumeSecs across new frames
+//*	Oct 19,	2026	<MLS> ETag uses the exposure end time and the process start time
+//*	Oct 19,	2026	<MLS> Only completely processed frames are stored
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_CAMERADRIVER_IMAGECACHE_MAIN_ serializer test
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+#define	kImageCache_MaxMemoryPct	25			//*	of MemTotal, for all entries together
+#define	kImageCache_MinFree_MB		128			//*	MemAvailable left after adding an entry
+#define	kImageCache_XmitBlockSize	(2 * 1024 * 1024)
+#define	kImageCache_TileColumns		16
+#define	kImageCache_ResumeSecs		60			//*	how long an interrupted download can be resumed
+#define	kImageCache_FirstBlockSize	4096		//*	data sent in the same write() as the HTTP header
+
+static time_t	gImageCache_StartEpoch	=	time(NULL);	//*	makes the ETags of each run different
+
+//*****************************************************************************
+//*	returns MemTotal and MemAvailable in bytes, 0 if /proc/meminfo can not be read
+//*****************************************************************************
+static void	ImageCache_GetMemInfo(size_t *memTotal, size_t *memAvailable)
+{
+FILE	*filePointer;
+char	lineBuff[128];
+long	memTotal_KB;
+long	memAvailable_KB;
+
+	memTotal_KB		=	0;
+	memAvailable_KB	=	0;
+	filePointer		=	fopen("/proc/meminfo", "r");
+	if (filePointer != NULL)
+	{
+		while (fgets(lineBuff, sizeof(lineBuff), filePointer) != NULL)
+		{
+			sscanf(lineBuff, "MemTotal: %ld", &memTotal_KB);
+			sscanf(lineBuff, "MemAvailable: %ld", &memAvailable_KB);
+		}
+		fclose(filePointer);
+	}
+	*memTotal		=	(size_t)memTotal_KB * 1024;
+	*memAvailable	=	(size_t)memAvailable_KB * 1024;
+}
+
+//*****************************************************************************
+//*	sends the whole buffer, write() can return before all of it is sent
+//*****************************************************************************
+size_t	ImageCache_Write(const int socketFD, const uint8_t *dataPtr, const size_t dataLen)
+{
+size_t	totalBytesWritten;
+size_t	bytesPerBlock;
+ssize_t	bytesWritten;
+
+	totalBytesWritten	=	0;
+	while (totalBytesWritten < dataLen)
+	{
+		bytesPerBlock	=	dataLen - totalBytesWritten;
+		if (bytesPerBlock > kImageCache_XmitBlockSize)
+		{
+			bytesPerBlock	=	kImageCache_XmitBlockSize;
+		}
+		bytesWritten	=	write(socketFD, (dataPtr + totalBytesWritten), bytesPerBlock);
+		if (bytesWritten <= 0)
+		{
+			CONSOLE_DEBUG("Write Error");
+			break;
+		}
+		totalBytesWritten	+=	bytesWritten;
+	}
+	return(totalBytesWritten);
+}
+
+//*****************************************************************************
+//*	ETag for the imagebytes response of the current frame
+//*****************************************************************************
+void	CameraDriver::ImageCache_GetEntityTag(const int format, const int variant, char *entityTag)
+{
+	sprintf(entityTag,	"\"%lx-%ld-%ld.%06ld-%d-%d\"",
+						(long)gImageCache_StartEpoch,
+						cFramesRead,
+						(long)cCameraProp.Lastexposure_EndTime.tv_sec,
+						(long)cCameraProp.Lastexposure_EndTime.tv_usec,
+						format,
+						variant);
+}
+
+//*****************************************************************************
+//*	Sends a complete imagebytes response (HTTP header + data) or the part of it
+//*	asked for with a "Range:" header line.
+//*	The header is rebuilt with the status, Content-Length, Accept-Ranges, ETag
+//*	and Content-Range for what is actually sent.
+//*	If entityTag is NULL the response is sent as is, without range support.
+//*	returns true if everything that was supposed to be sent was sent
+//*****************************************************************************
+bool	CameraDriver::ImageCache_SendResponse(	TYPE_GetPutRequestData	*reqData,
+												const uint8_t			*responsePtr,
+												const size_t			responseLen,
+												const char				*entityTag)
+{
+const uint8_t	*bodyPtr;
+const char		*linePtr;
+const char		*headerEnd;
+size_t			bodyLen;
+size_t			sendLen;
+size_t			bytesWritten;
+size_t			lineLen;
+long			firstByte;
+long			lastByte;
+int				rangeType;
+char			httpHeader[1024];
+char			lineBuff[128];
+char			originalHeader[1024];
+size_t			originalHeaderLen;
+uint8_t			firstBlock[1024 + kImageCache_FirstBlockSize];
+size_t			headerLen;
+size_t			firstLen;
+
+	if (entityTag == NULL)
+	{
+		bytesWritten	=	ImageCache_Write(reqData->socket, responsePtr, responseLen);
+		return(bytesWritten == responseLen);
+	}
+
+	//*	find the end of the existing header
+	originalHeaderLen	=	responseLen;
+	if (originalHeaderLen > (sizeof(originalHeader) - 1))
+	{
+		originalHeaderLen	=	sizeof(originalHeader) - 1;
+	}
+	memcpy(originalHeader, responsePtr, originalHeaderLen);
+	originalHeader[originalHeaderLen]	=	0;
+	headerEnd	=	strstr(originalHeader, "\r\n\r\n");
+	if (headerEnd == NULL)
+	{
+		bytesWritten	=	ImageCache_Write(reqData->socket, responsePtr, responseLen);
+		return(bytesWritten == responseLen);
+	}
+	bodyPtr		=	responsePtr + (headerEnd - originalHeader) + 4;
+	bodyLen		=	responseLen - (bodyPtr - responsePtr);
+
+	rangeType	=	HTTP_GetRange(reqData->htmlData, entityTag, bodyLen, &firstByte, &lastByte);
+	switch(rangeType)
+	{
+		case kHTTPrange_Partial:
+			sendLen	=	(lastByte - firstByte) + 1;
+			strcpy(httpHeader,	"HTTP/1.0 206 Partial Content\r\n");
+			break;
+
+		case kHTTPrange_NotSatisfiable:
+			sendLen	=	0;
+			strcpy(httpHeader,	"HTTP/1.0 416 Range Not Satisfiable\r\n");
+			break;
+
+		case kHTTPrange_None:
+		default:
+			firstByte	=	0;
+			sendLen		=	bodyLen;
+			strcpy(httpHeader,	"HTTP/1.0 200 OK\r\n");
+			break;
+	}
+	sprintf(lineBuff,	"Content-Length: %ld\r\n", (long)sendLen);
+	strcat(httpHeader,	lineBuff);
+
+	//*	keep the rest of the original header lines, skip the status line
+	linePtr	=	strstr(originalHeader, "\r\n") + 2;
+	while (linePtr < headerEnd)
+	{
+		lineLen	=	strstr(linePtr, "\r\n") + 2 - linePtr;
+		if ((strncasecmp(linePtr, "Content-Length:", 15) != 0) &&
+			((strlen(httpHeader) + lineLen) < (sizeof(httpHeader) - 200)))
+		{
+			strncat(httpHeader, linePtr, lineLen);
+		}
+		linePtr	+=	lineLen;
+	}
+	strcat(httpHeader,	"Accept-Ranges: bytes\r\n");
+	sprintf(lineBuff,	"ETag: %s\r\n", entityTag);
+	strcat(httpHeader,	lineBuff);
+	if (rangeType == kHTTPrange_Partial)
+	{
+		sprintf(lineBuff,	"Content-Range: bytes %ld-%ld/%ld\r\n", firstByte, lastByte, (long)bodyLen);
+		strcat(httpHeader,	lineBuff);
+		cImageRangeRequests++;
+	}
+	else if (rangeType == kHTTPrange_NotSatisfiable)
+	{
+		sprintf(lineBuff,	"Content-Range: bytes */%ld\r\n", (long)bodyLen);
+		strcat(httpHeader,	lineBuff);
+	}
+	strcat(httpHeader,	"\r\n");
+
+	//*	the start of the data goes out with the header, clients expect the
+	//*	imagebytes header in the same block as the HTTP header
+	headerLen	=	strlen(httpHeader);
+	firstLen	=	sendLen;
+	if (firstLen > kImageCache_FirstBlockSize)
+	{
+		firstLen	=	kImageCache_FirstBlockSize;
+	}
+	memcpy(firstBlock, httpHeader, headerLen);
+	memcpy(&firstBlock[headerLen], (bodyPtr + firstByte), firstLen);
+	bytesWritten	=	ImageCache_Write(reqData->socket, firstBlock, (headerLen + firstLen));
+	if (bytesWritten < (headerLen + firstLen))
+	{
+		return(false);
+	}
+	bytesWritten	=	ImageCache_Write(reqData->socket, (bodyPtr + firstByte + firstLen), (sendLen - firstLen));
+	return(bytesWritten == (sendLen - firstLen));
+}
+
+//*****************************************************************************
+//*	drops one reference, the entry is freed when nobody uses it any more
+//*	must be called with cImageCacheMutex locked
+//*****************************************************************************
+static void	ImageCache_Unref(TYPE_IMAGEARRAY_CACHE *cacheEntry)
+{
+	cacheEntry->refCnt--;
+	if (cacheEntry->refCnt <= 0)
+	{
+		free(cacheEntry->dataPtr);
+		free(cacheEntry);
+	}
+}
+
+//*****************************************************************************
+//*	takes an entry out of the table, a client still sending it keeps it alive
+//*	must be called with cImageCacheMutex locked
+//*****************************************************************************
+void	CameraDriver::ImageCache_Remove(const int entryIdx)
+{
+	if (cImageCache[entryIdx] != NULL)
+	{
+		cImageCacheBytes	-=	cImageCache[entryIdx]->dataLen;
+		ImageCache_Unref(cImageCache[entryIdx]);
+		cImageCache[entryIdx]	=	NULL;
+	}
+}
+
+//*****************************************************************************
+//*	returns the index of the entry used the longest time ago, -1 if there is none
+//*	olderFrames: only entries of an older frame, kept for a resume
+//*	must be called with cImageCacheMutex locked
+//*****************************************************************************
+int	CameraDriver::ImageCache_FindOldest(const bool olderFrames)
+{
+int		entryIdx;
+int		iii;
+
+	entryIdx	=	-1;
+	for (iii=0; iii<kImageCache_Entries; iii++)
+	{
+		if ((cImageCache[iii] != NULL) &&
+			((olderFrames == false) || (cImageCache[iii]->frameNumber != cFramesRead)) &&
+			((entryIdx < 0) || (cImageCache[iii]->lastUse < cImageCache[entryIdx]->lastUse)))
+		{
+			entryIdx	=	iii;
+		}
+	}
+	return(entryIdx);
+}
+
+//*****************************************************************************
+//*	empties the table, called when a new frame is read
+//*	entries a client is still resuming are kept until their time runs out
+//*****************************************************************************
+void	CameraDriver::ImageCache_Invalidate(void)
+{
+time_t	timeNow;
+int		iii;
+
+	timeNow	=	time(NULL);
+	pthread_mutex_lock(&cImageCacheMutex);
+	for (iii=0; iii<kImageCache_Entries; iii++)
+	{
+		if ((cImageCache[iii] != NULL) && (cImageCache[iii]->resumeUntil > timeNow))
+		{
+			continue;
+		}
+		ImageCache_Remove(iii);
+	}
+	pthread_mutex_unlock(&cImageCacheMutex);
+}
+
+//*****************************************************************************
+//*	returns the entry for the current frame in this format, NULL if there is none
+//*	the entry stays valid until ImageCache_Release() is called for it
+//*****************************************************************************
+TYPE_IMAGEARRAY_CACHE	*CameraDriver::ImageCache_Find(const int format, const int variant)
+{
+TYPE_IMAGEARRAY_CACHE	*cacheEntry;
+TYPE_IMAGEARRAY_CACHE	*foundEntry;
+int						iii;
+
+	foundEntry	=	NULL;
+	pthread_mutex_lock(&cImageCacheMutex);
+	for (iii=0; iii<kImageCache_Entries; iii++)
+	{
+		cacheEntry	=	cImageCache[iii];
+		if ((cacheEntry != NULL) &&
+			(cacheEntry->frameNumber == cFramesRead) &&
+			(cacheEntry->format == format) &&
+			(cacheEntry->variant == variant))
+		{
+			cImageCacheHits++;
+			cacheEntry->hitCount++;
+			cacheEntry->lastUse	=	cImageCacheHits + cImageCacheMisses;
+			cacheEntry->refCnt++;
+			foundEntry			=	cacheEntry;
+			break;
+		}
+	}
+	if (foundEntry == NULL)
+	{
+		cImageCacheMisses++;
+	}
+	pthread_mutex_unlock(&cImageCacheMutex);
+	return(foundEntry);
+}
+
+//*****************************************************************************
+//*	a request with "If-Range:" continues an interrupted download,
+//*	returns the entry with that ETag even if it is from an older frame
+//*	the entry stays valid until ImageCache_Release() is called for it
+//*****************************************************************************
+TYPE_IMAGEARRAY_CACHE	*CameraDriver::ImageCache_FindResume(const char *htmlData)
+{
+TYPE_IMAGEARRAY_CACHE	*cacheEntry;
+TYPE_IMAGEARRAY_CACHE	*foundEntry;
+int						iii;
+
+	if (strcasestr(htmlData, "If-Range:") == NULL)
+	{
+		return(NULL);
+	}
+	foundEntry	=	NULL;
+	pthread_mutex_lock(&cImageCacheMutex);
+	for (iii=0; iii<kImageCache_Entries; iii++)
+	{
+		cacheEntry	=	cImageCache[iii];
+		if ((cacheEntry != NULL) &&
+			(cacheEntry->entityTag[0] != 0) &&
+			(strstr(htmlData, cacheEntry->entityTag) != NULL))
+		{
+			cacheEntry->hitCount++;
+			cacheEntry->lastUse	=	cImageCacheHits + cImageCacheMisses;
+			cacheEntry->refCnt++;
+			foundEntry			=	cacheEntry;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cImageCacheMutex);
+	return(foundEntry);
+}
+
+//*****************************************************************************
+//*	called every time an imagebytes entry is sent, it is kept for the next
+//*	kImageCache_ResumeSecs even if new frames arrive.
+//*	write() returns once the data is in the socket buffer, so the server
+//*	can not tell if the client got all of it.
+//*****************************************************************************
+void	CameraDriver::ImageCache_KeepForResume(const char *entityTag)
+{
+int		iii;
+
+	pthread_mutex_lock(&cImageCacheMutex);
+	for (iii=0; iii<kImageCache_Entries; iii++)
+	{
+		if ((cImageCache[iii] != NULL) && (strcmp(cImageCache[iii]->entityTag, entityTag) == 0))
+		{
+			cImageCache[iii]->resumeUntil	=	time(NULL) + kImageCache_ResumeSecs;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cImageCacheMutex);
+}
+
+//*****************************************************************************
+//*	for every entry returned by ImageCache_Find() or ImageCache_FindResume()
+//*****************************************************************************
+void	CameraDriver::ImageCache_Release(TYPE_IMAGEARRAY_CACHE *cacheEntry)
+{
+	if (cacheEntry != NULL)
+	{
+		pthread_mutex_lock(&cImageCacheMutex);
+		ImageCache_Unref(cacheEntry);
+		pthread_mutex_unlock(&cImageCacheMutex);
+	}
+}
+
+//*****************************************************************************
+//*	takes over dataPtr (malloc'd) if it returns true,
+//*	if it returns false the caller still owns it and has to free it
+//*	frameNumber is cFramesProcessed from before the buffer was built, if a new frame
+//*	was started or the frame was still being processed, the buffer is not stored
+//*	entityTag is the ETag of an imagebytes response, NULL for JSON
+//*****************************************************************************
+bool	CameraDriver::ImageCache_Store(	const long		frameNumber,
+										const int		format,
+										const int		variant,
+										const char		*entityTag,
+										uint8_t			*dataPtr,
+										const size_t	dataLen)
+{
+TYPE_IMAGEARRAY_CACHE	*cacheEntry;
+size_t					memTotal;
+size_t					memAvailable;
+size_t					cacheLimit;
+int						entryIdx;
+int						iii;
+bool					stored;
+
+	if ((dataPtr == NULL) || (dataLen == 0))
+	{
+		return(false);
+	}
+	cacheEntry	=	(TYPE_IMAGEARRAY_CACHE *)calloc(1, sizeof(TYPE_IMAGEARRAY_CACHE));
+	if (cacheEntry == NULL)
+	{
+		return(false);
+	}
+	cacheEntry->frameNumber	=	frameNumber;
+	cacheEntry->format		=	format;
+	cacheEntry->variant		=	variant;
+	cacheEntry->dataPtr		=	dataPtr;
+	cacheEntry->dataLen		=	dataLen;
+	cacheEntry->refCnt		=	1;		//*	the table
+	if (entityTag != NULL)
+	{
+		strncpy(cacheEntry->entityTag, entityTag, (sizeof(cacheEntry->entityTag) - 1));
+	}
+
+	ImageCache_GetMemInfo(&memTotal, &memAvailable);
+
+	cacheLimit	=	(memTotal / 100) * kImageCache_MaxMemoryPct;
+
+	stored	=	false;
+	pthread_mutex_lock(&cImageCacheMutex);
+	//*	otherwise it is out of date or was built while the frame was being processed
+	if ((frameNumber == cFramesRead) && (frameNumber == cFramesProcessed))
+	{
+		//*	entries of older frames only kept for a resume make room first
+		entryIdx	=	ImageCache_FindOldest(true);
+		while (((cImageCacheBytes + dataLen) > cacheLimit) && (entryIdx >= 0))
+		{
+			ImageCache_Remove(entryIdx);
+			entryIdx	=	ImageCache_FindOldest(true);
+		}
+		if ((memTotal == 0) ||
+			((cImageCacheBytes + dataLen) > cacheLimit) ||
+			(memAvailable < ((size_t)kImageCache_MinFree_MB * 1024 * 1024)))
+		{
+			CONSOLE_DEBUG_W_SIZE("Not enough memory to cache the imagearray, size\t=", dataLen);
+		}
+		else
+		{
+			//*	an empty entry, an older frame, or the one used the longest time ago
+			if (entryIdx < 0)
+			{
+				entryIdx	=	ImageCache_FindOldest(false);
+			}
+			for (iii=0; iii<kImageCache_Entries; iii++)
+			{
+				if (cImageCache[iii] == NULL)
+				{
+					entryIdx	=	iii;
+					break;
+				}
+			}
+			ImageCache_Remove(entryIdx);
+			cacheEntry->lastUse		=	cImageCacheHits + cImageCacheMisses;
+			cImageCache[entryIdx]	=	cacheEntry;
+			cImageCacheBytes		+=	dataLen;
+			stored					=	true;
+		}
+	}
+	pthread_mutex_unlock(&cImageCacheMutex);
+
+	if (stored == false)
+	{
+		free(cacheEntry);
+	}
+	return(stored);
+}
+
+//*****************************************************************************
+typedef struct	//	TYPE_JSON_ARRAY_BAND
+{
+	const uint8_t	*pixelPtr;
+	int				numRows;
+	int				numClms;
+	int				imageType;
+	size_t			*columnOffset;		//*	numClms + 1, the length of each column on the first pass
+	char			*textPtr;			//*	NULL on the first pass
+} TYPE_JSON_ARRAY_BAND;
+
+//*****************************************************************************
+static inline int	DigitCount(const uint32_t value)
+{
+	if (value < 10)			return(1);
+	if (value < 100)		return(2);
+	if (value < 1000)		return(3);
+	if (value < 10000)		return(4);
+	if (value < 100000)		return(5);
+	return(10);		//*	not used, the values are 16 bits
+}
+
+//*****************************************************************************
+static inline char	*PutDecimal(char *textPtr, uint32_t value)
+{
+char	digits[8];
+int		digitCnt;
+
+	digitCnt	=	0;
+	do
+	{
+		digits[digitCnt++]	=	'0' + (value % 10);
+		value				/=	10;
+	} while (value > 0);
+	while (digitCnt > 0)
+	{
+		*textPtr++	=	digits[--digitCnt];
+	}
+	return(textPtr);
+}
+
+//*****************************************************************************
+//*	the value sent for one sample, 8 bit data is sent as 16 bit
+//*****************************************************************************
+static inline uint32_t	GetSample(const TYPE_JSON_ARRAY_BAND *band, const int xxx, const long rowOffset, const int ccc)
+{
+	switch(band->imageType)
+	{
+		case kImageType_RAW16:
+			return(((const uint16_t *)band->pixelPtr)[rowOffset + xxx]);
+
+		case kImageType_RGB24:
+			//*	BGR in the buffer, sent as R, G, B
+			return(band->pixelPtr[((rowOffset + xxx) * 3) + (2 - ccc)] << 8);
+
+		default:
+			return(band->pixelPtr[rowOffset + xxx] << 8);
+	}
+}
+
+//*****************************************************************************
+//*	one column is
+//*		[v,v,v,...,v],\n						mono
+//*		[\n[r,g,b],[r,g,b],...,[r,g,b]],\n		RGB
+//*	the last column has no comma
+//*****************************************************************************
+static void	JsonArray_BandProc(void *context, int firstClm, int lastClm)
+{
+TYPE_JSON_ARRAY_BAND	*band;
+char					*textPtr[kImageCache_TileColumns];
+size_t					columnLen[kImageCache_TileColumns];
+int						tileStart;
+int						tileCnt;
+int						channels;
+int						xxx;
+int						yyy;
+int						ccc;
+int						ttt;
+long					rowOffset;
+uint32_t				sampleValue;
+
+	band		=	(TYPE_JSON_ARRAY_BAND *)context;
+	channels	=	(band->imageType == kImageType_RGB24) ? 3 : 1;
+	for (tileStart=firstClm; tileStart<lastClm; tileStart += kImageCache_TileColumns)
+	{
+		tileCnt	=	lastClm - tileStart;
+		if (tileCnt > kImageCache_TileColumns)
+		{
+			tileCnt	=	kImageCache_TileColumns;
+		}
+		for (ttt=0; ttt<tileCnt; ttt++)
+		{
+			columnLen[ttt]	=	(channels == 3) ? 2 : 1;		//*	"[\n" or "["
+			if (band->textPtr != NULL)
+			{
+				textPtr[ttt]	=	band->textPtr + band->columnOffset[tileStart + ttt];
+				*textPtr[ttt]++	=	'[';
+				if (channels == 3)
+				{
+					*textPtr[ttt]++	=	'\n';
+				}
+			}
+		}
+		for (yyy=0; yyy<band->numRows; yyy++)
+		{
+			rowOffset	=	(long)yyy * band->numClms;
+			for (ttt=0; ttt<tileCnt; ttt++)
+			{
+				xxx	=	tileStart + ttt;
+				if (band->textPtr == NULL)
+				{
+					//*	first pass, just the length
+					for (ccc=0; ccc<channels; ccc++)
+					{
+						columnLen[ttt]	+=	DigitCount(GetSample(band, xxx, rowOffset, ccc));
+					}
+					columnLen[ttt]	+=	(channels == 3) ? 4 : 0;		//*	"[" "," "," "]"
+					columnLen[ttt]	+=	(yyy < (band->numRows - 1)) ? 1 : 0;		//*	","
+				}
+				else
+				{
+					if (channels == 3)
+					{
+						*textPtr[ttt]++	=	'[';
+					}
+					for (ccc=0; ccc<channels; ccc++)
+					{
+						sampleValue		=	GetSample(band, xxx, rowOffset, ccc);
+						textPtr[ttt]	=	PutDecimal(textPtr[ttt], sampleValue);
+						if (ccc < (channels - 1))
+						{
+							*textPtr[ttt]++	=	',';
+						}
+					}
+					if (channels == 3)
+					{
+						*textPtr[ttt]++	=	']';
+					}
+					if (yyy < (band->numRows - 1))
+					{
+						*textPtr[ttt]++	=	',';
+					}
+				}
+			}
+		}
+		for (ttt=0; ttt<tileCnt; ttt++)
+		{
+			xxx	=	tileStart + ttt;
+			if (band->textPtr == NULL)
+			{
+				columnLen[ttt]				+=	(xxx < (band->numClms - 1)) ? 3 : 2;		//*	"],\n" or "]\n"
+				band->columnOffset[xxx]		=	columnLen[ttt];
+			}
+			else
+			{
+				*textPtr[ttt]++	=	']';
+				if (xxx < (band->numClms - 1))
+				{
+					*textPtr[ttt]++	=	',';
+				}
+				*textPtr[ttt]++	=	'\n';
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//*	builds the text of the JSON "Value" array, column order.
+//*	Returns a malloc'd buffer (not 0 terminated), NULL if the type is not
+//*	supported or there is not enough memory
+//*****************************************************************************
+static uint8_t	*JsonArray_Build(	const uint8_t	*pixelPtr,
+									const int		numRows,
+									const int		numClms,
+									const int		imageType,
+									size_t			*textLen)
+{
+TYPE_JSON_ARRAY_BAND	bandInfo;
+size_t					columnLen;
+size_t					totalLen;
+int						xxx;
+
+	*textLen	=	0;
+	switch(imageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+		case kImageType_RAW16:
+		case kImageType_RGB24:
+			break;
+
+		default:
+			return(NULL);
+	}
+	if ((pixelPtr == NULL) || (numRows < 1) || (numClms < 1))
+	{
+		return(NULL);
+	}
+	memset(&bandInfo, 0, sizeof(TYPE_JSON_ARRAY_BAND));
+	bandInfo.pixelPtr		=	pixelPtr;
+	bandInfo.numRows		=	numRows;
+	bandInfo.numClms		=	numClms;
+	bandInfo.imageType		=	imageType;
+	bandInfo.columnOffset	=	(size_t *)malloc((bandInfo.numClms + 1) * sizeof(size_t));
+	if (bandInfo.columnOffset == NULL)
+	{
+		return(NULL);
+	}
+
+	//*	first pass, the length of each column, then turn them into offsets
+	ImageKernel_RunRowBands(bandInfo.numClms, JsonArray_BandProc, &bandInfo);
+	totalLen	=	0;
+	for (xxx=0; xxx<bandInfo.numClms; xxx++)
+	{
+		columnLen						=	bandInfo.columnOffset[xxx];
+		bandInfo.columnOffset[xxx]		=	totalLen;
+		totalLen						+=	columnLen;
+	}
+	bandInfo.columnOffset[bandInfo.numClms]	=	totalLen;
+
+	//*	second pass, each column is written at its offset
+	bandInfo.textPtr	=	(char *)malloc(totalLen);
+	if (bandInfo.textPtr != NULL)
+	{
+		ImageKernel_RunRowBands(bandInfo.numClms, JsonArray_BandProc, &bandInfo);
+		*textLen	=	totalLen;
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_SIZE("Failed to allocate JSON imagearray buffer, size\t=", totalLen);
+	}
+	free(bandInfo.columnOffset);
+	return((uint8_t *)bandInfo.textPtr);
+}
+
+//*****************************************************************************
+//*	the JSON "Value" array for the current frame
+//*****************************************************************************
+uint8_t	*CameraDriver::ImageCache_BuildJSON(size_t *textLen)
+{
+	return(JsonArray_Build(	cCameraDataBuffer,
+							cLastExposure_ROIinfo.currentROIheight,
+							cLastExposure_ROIinfo.currentROIwidth,
+							cLastExposure_ROIinfo.currentROIimageType,
+							textLen));
+}
+
+//*****************************************************************************
+void	CameraDriver::ImageCache_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagecachehits",
+									cImageCacheHits,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagecachemisses",
+									cImageCacheMisses,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagecache_MB",
+									(cImageCacheBytes / (1024 * 1024)),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"imagearray_range_requests",
+									cImageRangeRequests,
+									INCLUDE_COMMA);
+}
+
+
+#ifdef _INCLUDE_CAMERADRIVER_IMAGECACHE_MAIN_
+//*****************************************************************************
+//*	JSON imagearray serializer self test and benchmark
+//*	make imagecachetest
+//*****************************************************************************
+#include	<time.h>
+
+//*****************************************************************************
+static double	GetSeconds(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return(timeNow.tv_sec + (timeNow.tv_nsec / 1.0e9));
+}
+
+//*****************************************************************************
+//*	what Send_imagearray_raw8/raw16/rgb() write to the socket,
+//*	the sprintf() and strcat() per value are kept, write() is a memcpy()
+//*****************************************************************************
+static char	*RefJsonArray_Build(	const uint8_t	*pixelPtr,
+									const int		numRows,
+									const int		numClms,
+									const int		imageType,
+									size_t			*textLen)
+{
+char		*outputBuff;
+size_t		outputLen;
+char		lineBuff[256];
+char		longBuffer[2048];
+int			xxx;
+int			yyy;
+int			dataElementCnt;
+long		pixelIndex;
+size_t		bufLen;
+
+	outputBuff	=	(char *)malloc(((size_t)numRows * numClms * 24) + ((size_t)numClms * 8));
+	outputLen	=	0;
+	if (outputBuff == NULL)
+	{
+		*textLen	=	0;
+		return(NULL);
+	}
+	for (xxx=0; xxx < numClms; xxx++)
+	{
+		dataElementCnt	=	0;
+		pixelIndex		=	xxx;
+		if (imageType == kImageType_RGB24)
+		{
+			strcpy(longBuffer, "[\n");
+			for (yyy=0; yyy < numRows; yyy++)
+			{
+				sprintf(lineBuff, "[%d,%d,%d]",	(pixelPtr[(pixelIndex * 3) + 2] << 8),
+												(pixelPtr[(pixelIndex * 3) + 1] << 8),
+												(pixelPtr[(pixelIndex * 3) + 0] << 8));
+				if (yyy < (numRows - 1))
+				{
+					strcat(lineBuff, ",");
+				}
+				strcat(longBuffer, lineBuff);
+				dataElementCnt++;
+				if (dataElementCnt >= 50)
+				{
+					strcat(longBuffer, "\n");
+					bufLen		=	strlen(longBuffer);
+					memcpy(outputBuff + outputLen, longBuffer, bufLen);
+					outputLen	+=	bufLen;
+					dataElementCnt	=	0;
+					longBuffer[0]	=	0;
+				}
+				pixelIndex	+=	numClms;
+			}
+			strcat(longBuffer, ((xxx < (numClms - 1)) ? "],\n" : "]\n"));
+		}
+		else
+		{
+			strcpy(longBuffer, "[");
+			for (yyy=0; yyy < numRows; yyy++)
+			{
+				if (imageType == kImageType_RAW16)
+				{
+					sprintf(lineBuff, "%d", ((const uint16_t *)pixelPtr)[pixelIndex]);
+				}
+				else
+				{
+					sprintf(lineBuff, "%d", (pixelPtr[pixelIndex] << 8));
+				}
+				if (yyy < (numRows - 1))
+				{
+					strcat(lineBuff, ",");
+				}
+				strcat(longBuffer, lineBuff);
+				dataElementCnt++;
+				if ((dataElementCnt >= 100) && (yyy < (numRows - 1)))
+				{
+					strcat(longBuffer, "\n");
+					bufLen		=	strlen(longBuffer);
+					memcpy(outputBuff + outputLen, longBuffer, bufLen);
+					outputLen	+=	bufLen;
+					dataElementCnt	=	0;
+					longBuffer[0]	=	0;
+				}
+				pixelIndex	+=	numClms;
+			}
+			strcat(longBuffer, ((xxx < (numClms - 1)) ? "],\n" : "]\n"));
+		}
+		bufLen		=	strlen(longBuffer);
+		memcpy(outputBuff + outputLen, longBuffer, bufLen);
+		outputLen	+=	bufLen;
+	}
+	*textLen	=	outputLen;
+	return(outputBuff);
+}
+
+//*****************************************************************************
+//*	JSON does not care about white space, the old routines put a
+//*	line break after every 100 values (50 for RGB), the serializer only
+//*	after each column
+//*****************************************************************************
+static bool	SameJsonText(const char *text1, const size_t len1, const char *text2, const size_t len2)
+{
+size_t	idx1;
+size_t	idx2;
+
+	idx1	=	0;
+	idx2	=	0;
+	while (true)
+	{
+		while ((idx1 < len1) && (text1[idx1] == '\n'))
+		{
+			idx1++;
+		}
+		while ((idx2 < len2) && (text2[idx2] == '\n'))
+		{
+			idx2++;
+		}
+		if ((idx1 >= len1) || (idx2 >= len2))
+		{
+			return((idx1 >= len1) && (idx2 >= len2));
+		}
+		if (text1[idx1] != text2[idx2])
+		{
+			return(false);
+		}
+		idx1++;
+		idx2++;
+	}
+}
+
+//*****************************************************************************
+static void	FillPixels(uint8_t *pixelPtr, const size_t byteCnt, uint32_t seedValue)
+{
+size_t	iii;
+
+	for (iii=0; iii<byteCnt; iii++)
+	{
+		seedValue		=	(seedValue * 1103515245) + 12345;
+		pixelPtr[iii]	=	(seedValue >> 16) & 0x0ff;
+	}
+	//*	the widest and narrowest values
+	if (byteCnt >= 4)
+	{
+		pixelPtr[0]	=	0;
+		pixelPtr[1]	=	0;
+		pixelPtr[2]	=	0xff;
+		pixelPtr[3]	=	0xff;
+	}
+}
+
+//*****************************************************************************
+static int	Test_JsonArray(void)
+{
+static const int	imageTypes[]	=	{kImageType_RAW8, kImageType_Y8, kImageType_MONO8, kImageType_RAW16, kImageType_RGB24};
+static const int	imageSizes[][2]	=	{{1, 1}, {1, 250}, {250, 1}, {2, 2}, {101, 3}, {37, 53}, {200, 151}, {64, 1000}};
+uint8_t		*pixelPtr;
+uint8_t		*textPtr;
+char		*refTextPtr;
+size_t		textLen;
+size_t		refTextLen;
+int			typeIdx;
+int			sizeIdx;
+int			numRows;
+int			numClms;
+int			errorCnt;
+
+	errorCnt	=	0;
+	pixelPtr	=	(uint8_t *)malloc(1000 * 64 * 3);
+	for (typeIdx=0; typeIdx<(int)(sizeof(imageTypes) / sizeof(int)); typeIdx++)
+	{
+		for (sizeIdx=0; sizeIdx<(int)(sizeof(imageSizes) / sizeof(imageSizes[0])); sizeIdx++)
+		{
+			numRows		=	imageSizes[sizeIdx][0];
+			numClms		=	imageSizes[sizeIdx][1];
+			FillPixels(pixelPtr, (1000 * 64 * 3), (typeIdx * 100) + sizeIdx);
+			textPtr		=	JsonArray_Build(pixelPtr, numRows, numClms, imageTypes[typeIdx], &textLen);
+			refTextPtr	=	RefJsonArray_Build(pixelPtr, numRows, numClms, imageTypes[typeIdx], &refTextLen);
+			if ((textPtr == NULL) || (refTextPtr == NULL) ||
+				(SameJsonText((char *)textPtr, textLen, refTextPtr, refTextLen) == false))
+			{
+				printf("type %d, %d rows x %d columns: text does not match\r\n", imageTypes[typeIdx], numRows, numClms);
+				errorCnt++;
+			}
+			free(textPtr);
+			free(refTextPtr);
+		}
+	}
+	//*	types that are not supported
+	if (JsonArray_Build(pixelPtr, 10, 10, kImageType_Invalid, &textLen) != NULL)
+	{
+		errorCnt++;
+	}
+	free(pixelPtr);
+	printf("JSON imagearray vs sprintf()\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+static void	Bench_JsonArray(void)
+{
+uint8_t		*pixelPtr;
+uint8_t		*textPtr;
+char		*refTextPtr;
+size_t		textLen;
+size_t		refTextLen;
+double		startTime;
+double		bestTime;
+double		bestRefTime;
+int			passNum;
+
+	pixelPtr	=	(uint8_t *)malloc(6248 * 4176 * 2);
+	if (pixelPtr == NULL)
+	{
+		return;
+	}
+	FillPixels(pixelPtr, (6248 * 4176 * 2), 1);
+	bestTime	=	1.0e9;
+	bestRefTime	=	1.0e9;
+	textLen		=	0;
+	for (passNum=0; passNum<3; passNum++)
+	{
+		startTime	=	GetSeconds();
+		refTextPtr	=	RefJsonArray_Build(pixelPtr, 4176, 6248, kImageType_RAW16, &refTextLen);
+		bestRefTime	=	((GetSeconds() - startTime) < bestRefTime) ? (GetSeconds() - startTime) : bestRefTime;
+
+		startTime	=	GetSeconds();
+		textPtr		=	JsonArray_Build(pixelPtr, 4176, 6248, kImageType_RAW16, &textLen);
+		bestTime	=	((GetSeconds() - startTime) < bestTime) ? (GetSeconds() - startTime) : bestTime;
+		free(textPtr);
+		free(refTextPtr);
+	}
+	printf("6248x4176 RAW16 JSON, %.1f MB, %d threads\r\n", (textLen / 1.0e6), ImageKernel_GetThreadCount());
+	printf("    sprintf() %6.0f ms, serializer %6.0f ms\r\n", (bestRefTime * 1000.0), (bestTime * 1000.0));
+	free(pixelPtr);
+}
+
+//*****************************************************************************
+int	main(void)
+{
+int		errorCnt;
+
+	errorCnt	=	Test_JsonArray();
+	Bench_JsonArray();
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_CAMERADRIVER_IMAGECACHE_MAIN_
+
+#endif // _ENABLE_CAMERA_
@@ -0,0 +1,468 @@
+//**************************************************************************
+//*	Name:			cameradriver_imageindex.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Metadata index of the saved images
+//*
+//*					Every saved image adds a record to imageindex.dat in the image
+//*					directory (see image_meta_index.c). The imageindex command
+//*					returns the records that match the query, the index is kept in
+//*					memory and only read again when the file size changes.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_imageindex.cpp
+//*	Oct 19,	2026	<MLS> The file name buffer is sized from cFileNameRoot
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<math.h>
+#include	<pthread.h>
+#include	<sys/stat.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+#include	"image_meta_index.h"
+
+//*****************************************************************************
+//*	the index is per directory, all of the cameras save to the same one
+static TYPE_IMAGE_META	*gImageMetaList		=	NULL;
+static int				gImageMetaCnt		=	0;
+static off_t			gImageMetaFileSize	=	-1;
+static pthread_mutex_t	gImageMetaMutex		=	PTHREAD_MUTEX_INITIALIZER;
+
+//*****************************************************************************
+//*	the strings are sent in JSON without escaping
+static void	CopyIndexString(char *destString, const char *srcString, const int maxLen)
+{
+int		iii;
+
+	iii	=	0;
+	while ((srcString[iii] != 0) && (iii < (maxLen - 1)))
+	{
+		if ((srcString[iii] == '"') || (srcString[iii] == '\\') || ((unsigned char)srcString[iii] < 0x20))
+		{
+			destString[iii]	=	'_';
+		}
+		else
+		{
+			destString[iii]	=	srcString[iii];
+		}
+		iii++;
+	}
+	destString[iii]	=	0;
+}
+
+//*****************************************************************************
+//*	min, max, mean and saturation in one pass,
+//*	saturation is counted the same way as CountSaturationPixels()
+//*****************************************************************************
+void	CameraDriver::ImageIndex_CalculateStats(int32_t *minPixel, int32_t *maxPixel, float *meanPixel, float *saturationPct)
+{
+uint32_t	pixelCnt;
+uint32_t	valueCnt;
+uint32_t	saturatedPixCnt;
+uint32_t	ii;
+uint32_t	cc;
+uint32_t	currPixValue;
+uint32_t	minValue;
+uint32_t	maxValue;
+uint64_t	pixelSum;
+uint8_t		*imageDataPtr8bit;
+uint16_t	*imageDataPtr16bit;
+bool		saturatedFlag;
+
+	minValue		=	65535;
+	maxValue		=	0;
+	pixelSum		=	0;
+	valueCnt		=	0;
+	saturatedPixCnt	=	0;
+	pixelCnt		=	cCameraProp.CameraXsize * cCameraProp.CameraYsize;
+	switch(cROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_MONO8:
+		case kImageType_Y8:
+			imageDataPtr8bit	=	(uint8_t *)cCameraDataBuffer;
+			for (ii=0; ii<pixelCnt; ii++)
+			{
+				currPixValue	=	imageDataPtr8bit[ii];
+				if (currPixValue < minValue)
+				{
+					minValue	=	currPixValue;
+				}
+				if (currPixValue > maxValue)
+				{
+					maxValue	=	currPixValue;
+				}
+				if (currPixValue == 0x0ff)
+				{
+					saturatedPixCnt++;
+				}
+				pixelSum	+=	currPixValue;
+			}
+			valueCnt	=	pixelCnt;
+			break;
+
+		case kImageType_RAW16:
+			imageDataPtr16bit	=	(uint16_t *)cCameraDataBuffer;
+			for (ii=0; ii<pixelCnt; ii++)
+			{
+				currPixValue	=	imageDataPtr16bit[ii];
+				if (currPixValue < minValue)
+				{
+					minValue	=	currPixValue;
+				}
+				if (currPixValue > maxValue)
+				{
+					maxValue	=	currPixValue;
+				}
+				if (currPixValue == 0x0ffff)
+				{
+					saturatedPixCnt++;
+				}
+				pixelSum	+=	currPixValue;
+			}
+			valueCnt	=	pixelCnt;
+			break;
+
+		case kImageType_RGB24:
+			imageDataPtr8bit	=	(uint8_t *)cCameraDataBuffer;
+			for (ii=0; ii<pixelCnt; ii++)
+			{
+				saturatedFlag	=	false;
+				for (cc=0; cc<3; cc++)
+				{
+					currPixValue	=	imageDataPtr8bit[(ii * 3) + cc];
+					if (currPixValue < minValue)
+					{
+						minValue	=	currPixValue;
+					}
+					if (currPixValue > maxValue)
+					{
+						maxValue	=	currPixValue;
+					}
+					if (currPixValue == 0x0ff)
+					{
+						saturatedFlag	=	true;
+					}
+					pixelSum	+=	currPixValue;
+				}
+				if (saturatedFlag)
+				{
+					saturatedPixCnt++;
+				}
+			}
+			valueCnt	=	pixelCnt * 3;
+			break;
+
+		default:
+			break;
+	}
+	if (valueCnt > 0)
+	{
+		*minPixel		=	minValue;
+		*maxPixel		=	maxValue;
+		*meanPixel		=	(double)pixelSum / valueCnt;
+		*saturationPct	=	(saturatedPixCnt * 100.0) / pixelCnt;
+	}
+	else
+	{
+		*minPixel		=	0;
+		*maxPixel		=	0;
+		*meanPixel		=	0.0;
+		*saturationPct	=	0.0;
+	}
+}
+
+//*****************************************************************************
+//*	called at the end of SaveImageData(), cFileNameRoot is the image just saved
+//*****************************************************************************
+void	CameraDriver::ImageIndex_AddSavedImage(void)
+{
+TYPE_IMAGE_META	imageMeta;
+const char		*fileExtension;
+const char		*filterName;
+char			fileName[sizeof(cFileNameRoot) + 8];		//*	root + extension, the index keeps the first part
+uint32_t		startMillisecs;
+
+	startMillisecs	=	millis();
+	//*	the FITS file is the one the index is for, if there is one
+	if (cSaveAsFITS)
+	{
+		fileExtension	=	".fits";
+	}
+	else if (cSaveAsJPEG)
+	{
+		fileExtension	=	".jpg";
+	}
+	else if (cSaveAsPNG)
+	{
+		fileExtension	=	".png";
+	}
+	else
+	{
+		return;
+	}
+	memset(&imageMeta, 0, sizeof(TYPE_IMAGE_META));
+	snprintf(fileName, sizeof(fileName), "%s%s", cFileNameRoot, fileExtension);
+	CopyIndexString(imageMeta.fileName, fileName, sizeof(imageMeta.fileName));
+
+	imageMeta.time_secs		=	cCameraProp.Lastexposure_StartTime.tv_sec +
+								(cCameraProp.Lastexposure_StartTime.tv_usec / 1000000.0);
+	imageMeta.exposure_secs	=	cCameraProp.Lastexposure_duration_us / 1000000.0;
+	imageMeta.gain			=	cCameraProp.Gain;
+	imageMeta.width			=	cCameraProp.CameraXsize;
+	imageMeta.height		=	cCameraProp.CameraYsize;
+	imageMeta.imageType		=	cROIinfo.currentROIimageType;
+
+	filterName	=	cTS_info.filterName;
+#if defined(_ENABLE_FILTERWHEEL_) || defined(_ENABLE_FILTERWHEEL_ZWO_) || defined(_ENABLE_FILTERWHEEL_ATIK_)
+	if ((cConnectedFilterWheel != NULL) && (strlen(cFilterWheelCurrName) > 0))
+	{
+		filterName	=	cFilterWheelCurrName;
+	}
+#endif
+	CopyIndexString(imageMeta.filter, filterName,	sizeof(imageMeta.filter));
+	CopyIndexString(imageMeta.object, cObjectName,	sizeof(imageMeta.object));
+
+	imageMeta.ra_deg	=	NAN;
+	imageMeta.dec_deg	=	NAN;
+	if (cPlateSolveEnabled && cPlateSolveResult.solved)
+	{
+		imageMeta.ra_deg	=	cPlateSolveResult.ra_deg;
+		imageMeta.dec_deg	=	cPlateSolveResult.dec_deg;
+	}
+	if (cStarAnalysisEnabled && (cStarResults != NULL) && cStarResults->valid)
+	{
+		imageMeta.hfr	=	cStarResults->medianHFR;
+	}
+	ImageIndex_CalculateStats(	&imageMeta.minPixel,
+								&imageMeta.maxPixel,
+								&imageMeta.meanPixel,
+								&imageMeta.saturationPct);
+
+	pthread_mutex_lock(&gImageMetaMutex);
+	if (ImageMetaIndex_Append(gImageDataDir, &imageMeta) == false)
+	{
+		CONSOLE_DEBUG_W_STR("Failed to add to the image index", fileName);
+	}
+	pthread_mutex_unlock(&gImageMetaMutex);
+	CONSOLE_DEBUG_W_NUM("Image index update (ms)\t=", (millis() - startMillisecs));
+}
+
+//*****************************************************************************
+//*	the mutex must be locked
+static void	ImageIndex_Refresh(void)
+{
+char		indexPath[512];
+struct stat	fileStatus;
+off_t		fileSize;
+
+	snprintf(indexPath, sizeof(indexPath), "%s/%s", gImageDataDir, kImageMetaIndex_FileName);
+	fileSize	=	-1;
+	if (stat(indexPath, &fileStatus) == 0)
+	{
+		fileSize	=	fileStatus.st_size;
+	}
+	if ((fileSize != gImageMetaFileSize) || (gImageMetaList == NULL))
+	{
+		if (gImageMetaList != NULL)
+		{
+			free(gImageMetaList);
+		}
+		gImageMetaList		=	ImageMetaIndex_Load(gImageDataDir, &gImageMetaCnt);
+		gImageMetaFileSize	=	fileSize;
+	}
+}
+
+//*****************************************************************************
+//*		object=STR			(optional, object name contains STR)
+//*		filter=STR			(optional, filter name)
+//*		name=STR			(optional, file name contains STR)
+//*		minexposure=FLOAT	(optional, seconds)
+//*		maxexposure=FLOAT	(optional, seconds)
+//*		maxhfr=FLOAT		(optional, pixels)
+//*		since=FLOAT			(optional, unix time)
+//*		until=FLOAT			(optional, unix time)
+//*		start=INT			(optional, first match to return, default 0)
+//*		count=INT			(optional, number of matches to return, default 100)
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_ImageIndex(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS		alpacaErrCode	=	kASCOM_Err_Success;
+TYPE_IMAGE_META_QUERY	query;
+TYPE_IMAGE_META			*imageMeta;
+char					argumentString[64];
+char					objectName[64];
+char					filterName[64];
+char					fileName[128];
+char					lineBuff[512];
+char					raString[32];
+char					decString[32];
+int						startIdx;
+int						maxCount;
+int						matchCnt;
+int						outputCnt;
+int						iii;
+
+	ImageMetaIndex_InitQuery(&query);
+	startIdx	=	0;
+	maxCount	=	100;
+	if (GetKeyWordArgument(reqData->contentData, "object", objectName, (sizeof(objectName) -1)))
+	{
+		query.object	=	objectName;
+	}
+	if (GetKeyWordArgument(reqData->contentData, "filter", filterName, (sizeof(filterName) -1)))
+	{
+		query.filter	=	filterName;
+	}
+	if (GetKeyWordArgument(reqData->contentData, "name", fileName, (sizeof(fileName) -1)))
+	{
+		query.fileName	=	fileName;
+	}
+	if (GetKeyWordArgument(reqData->contentData, "minexposure", argumentString, (sizeof(argumentString) -1)))
+	{
+		query.minExposure_secs	=	atof(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "maxexposure", argumentString, (sizeof(argumentString) -1)))
+	{
+		query.maxExposure_secs	=	atof(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "maxhfr", argumentString, (sizeof(argumentString) -1)))
+	{
+		query.maxHFR	=	atof(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "since", argumentString, (sizeof(argumentString) -1)))
+	{
+		query.since_secs	=	atof(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "until", argumentString, (sizeof(argumentString) -1)))
+	{
+		query.until_secs	=	atof(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "start", argumentString, (sizeof(argumentString) -1)))
+	{
+		startIdx	=	atoi(argumentString);
+		if (startIdx < 0)
+		{
+			startIdx	=	0;
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "count", argumentString, (sizeof(argumentString) -1)))
+	{
+		maxCount	=	atoi(argumentString);
+		if (maxCount < 0)
+		{
+			maxCount	=	0;
+		}
+	}
+
+	pthread_mutex_lock(&gImageMetaMutex);
+	ImageIndex_Refresh();
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"images");
+	matchCnt	=	0;
+	outputCnt	=	0;
+	for (iii=0; iii<gImageMetaCnt; iii++)
+	{
+		imageMeta	=	&gImageMetaList[iii];
+		if (ImageMetaIndex_Match(imageMeta, &query))
+		{
+			if ((matchCnt >= startIdx) && (outputCnt < maxCount))
+			{
+				if (isnan(imageMeta->ra_deg))
+				{
+					strcpy(raString,	"null");
+					strcpy(decString,	"null");
+				}
+				else
+				{
+					sprintf(raString,	"%1.5f",	imageMeta->ra_deg);
+					sprintf(decString,	"%1.5f",	imageMeta->dec_deg);
+				}
+				sprintf(lineBuff, "%s\r\n\t\t{\"file\":\"%s\",\"time\":%1.3f,\"exposure\":%1.6f,\"gain\":%d,\"filter\":\"%s\",\"object\":\"%s\",\"ra\":%s,\"dec\":%s,\"hfr\":%1.2f,\"min\":%d,\"max\":%d,\"mean\":%1.1f,\"saturation\":%1.3f,\"width\":%d,\"height\":%d}",
+									((outputCnt > 0) ? "," : ""),
+									imageMeta->fileName,
+									imageMeta->time_secs,
+									imageMeta->exposure_secs,
+									imageMeta->gain,
+									imageMeta->filter,
+									imageMeta->object,
+									raString,
+									decString,
+									imageMeta->hfr,
+									imageMeta->minPixel,
+									imageMeta->maxPixel,
+									imageMeta->meanPixel,
+									imageMeta->saturationPct,
+									imageMeta->width,
+									imageMeta->height);
+				cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+												reqData->jsonTextBuffer,
+												kMaxJsonBuffLen,
+												lineBuff);
+				outputCnt++;
+			}
+			matchCnt++;
+		}
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"indexcount",
+									gImageMetaCnt,
+									INCLUDE_COMMA);
+	pthread_mutex_unlock(&gImageMetaMutex);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"start",
+									startIdx,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									matchCnt,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
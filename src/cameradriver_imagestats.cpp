@@ -0,0 +1,461 @@
+//**************************************************************************
+//*	Name:			cameradriver_imagestats.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Full resolution statistics and histogram of the current frame
+//*
+//*					/api/v1/camera/0/imagestats?bins=4096&x=0&y=0&width=1000&height=1000
+//*
+//*					Min, max, mean, median, standard deviation and the number of
+//*					saturated pixels for each channel, plus the histogram.
+//*					CalculateHistogramArray() shifts RAW16 down to 8 bits for the
+//*					live window, this keeps all 16 bits.
+//*
+//*					One pass over the frame (or the ROI) builds a full depth histogram
+//*					per channel, 65536 entries for RAW16, 256 for 8 bit data.
+//*					The rows are split into bands (ImageKernel_RunRowBands), each band
+//*					has its own histogram and they are added together at the end.
+//*					Everything else comes from the histogram, so the result is exact.
+//*					It is kept until the next frame, asking again with the same ROI
+//*					only formats the response.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_imagestats.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<math.h>
+#include	<pthread.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+#define	kImageStats_DefaultBins		4096
+#define	kImageStats_ValuesPerLine	128
+
+//*****************************************************************************
+typedef struct	//	TYPE_IMAGESTATS_BAND
+{
+	const uint8_t	*srcPtr;			//*	first pixel of the ROI
+	long			srcRowBytes;
+	int				roiWidth;
+	int				channels;
+	int				bytesPerValue;
+	int				histSize;			//*	per channel
+	uint32_t		*histogram;			//*	channels * histSize, all of the bands added together
+	pthread_mutex_t	mergeMutex;
+} TYPE_IMAGESTATS_BAND;
+
+//*****************************************************************************
+static void	ImageStats_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_IMAGESTATS_BAND	*band;
+const uint8_t			*srcRow;
+uint32_t				*bandHistogram;
+int						histLen;
+int						yyy;
+int						ii;
+
+	band			=	(TYPE_IMAGESTATS_BAND *)context;
+	histLen			=	band->channels * band->histSize;
+	bandHistogram	=	(uint32_t *)calloc(histLen, sizeof(uint32_t));
+	if (bandHistogram == NULL)
+	{
+		CONSOLE_DEBUG("Failed to allocate band histogram");
+		return;
+	}
+	for (yyy=firstRow; yyy<lastRow; yyy++)
+	{
+		srcRow	=	band->srcPtr + ((long)yyy * band->srcRowBytes);
+		if (band->channels == 3)
+		{
+			ImageKernel_Histogram_BGR(bandHistogram, srcRow, band->roiWidth);
+		}
+		else if (band->bytesPerValue == 2)
+		{
+			ImageKernel_Histogram_U16(bandHistogram, (const uint16_t *)srcRow, band->roiWidth);
+		}
+		else
+		{
+			ImageKernel_Histogram_U8(bandHistogram, srcRow, band->roiWidth);
+		}
+	}
+	pthread_mutex_lock(&band->mergeMutex);
+	for (ii=0; ii<histLen; ii++)
+	{
+		band->histogram[ii]	+=	bandHistogram[ii];
+	}
+	pthread_mutex_unlock(&band->mergeMutex);
+	free(bandHistogram);
+}
+
+//*****************************************************************************
+static void	ImageStats_FromHistogram(TYPE_CHANNEL_STATS *channelStats, const uint32_t *histogram, const int histSize)
+{
+uint64_t	pixelCnt;
+uint64_t	runningCnt;
+double		valueSum;
+double		valueSqSum;
+double		variance;
+bool		medianFound;
+int			ii;
+
+	memset(channelStats, 0, sizeof(TYPE_CHANNEL_STATS));
+	pixelCnt	=	0;
+	valueSum	=	0.0;
+	valueSqSum	=	0.0;
+	channelStats->minValue	=	-1;
+	for (ii=0; ii<histSize; ii++)
+	{
+		if (histogram[ii] > 0)
+		{
+			if (channelStats->minValue < 0)
+			{
+				channelStats->minValue	=	ii;
+			}
+			channelStats->maxValue	=	ii;
+			pixelCnt				+=	histogram[ii];
+			valueSum				+=	(double)ii * histogram[ii];
+			valueSqSum				+=	(double)ii * ii * histogram[ii];
+		}
+	}
+	if (pixelCnt == 0)
+	{
+		channelStats->minValue	=	0;
+		return;
+	}
+	channelStats->pixelCnt		=	pixelCnt;
+	channelStats->saturatedCnt	=	histogram[histSize - 1];
+	channelStats->mean			=	valueSum / pixelCnt;
+	variance					=	(valueSqSum / pixelCnt) - (channelStats->mean * channelStats->mean);
+	channelStats->stdDev		=	(variance > 0.0) ? sqrt(variance) : 0.0;
+
+	runningCnt	=	0;
+	medianFound	=	false;
+	for (ii=0; (ii<histSize) && (medianFound == false); ii++)
+	{
+		runningCnt	+=	histogram[ii];
+		if ((runningCnt * 2) >= pixelCnt)
+		{
+			channelStats->median	=	ii;
+			medianFound				=	true;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	ROI is in pixels of the delivered frame, it is clipped to the frame
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::ImageStats_Calculate(int roiX, int roiY, int roiWidth, int roiHeight, char *alpacaErrMsg)
+{
+TYPE_IMAGESTATS_BAND	bandInfo;
+uint32_t				startMilliSecs;
+int						frameWidth;
+int						frameHeight;
+int						ccc;
+
+	memset(&bandInfo, 0, sizeof(TYPE_IMAGESTATS_BAND));
+	switch(cLastExposure_ROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	1;
+			bandInfo.histSize		=	256;
+			break;
+
+		case kImageType_RAW16:
+			bandInfo.bytesPerValue	=	2;
+			bandInfo.channels		=	1;
+			bandInfo.histSize		=	65536;
+			break;
+
+		case kImageType_RGB24:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	3;
+			bandInfo.histSize		=	256;
+			break;
+
+		default:
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Image type not supported for imagestats");
+			return(kASCOM_Err_NotImplemented);
+	}
+	frameWidth	=	cLastExposure_ROIinfo.currentROIwidth;
+	frameHeight	=	cLastExposure_ROIinfo.currentROIheight;
+	if ((roiX < 0) || (roiX >= frameWidth))
+	{
+		roiX	=	0;
+	}
+	if ((roiY < 0) || (roiY >= frameHeight))
+	{
+		roiY	=	0;
+	}
+	if ((roiWidth < 1) || (roiWidth > (frameWidth - roiX)))
+	{
+		roiWidth	=	frameWidth - roiX;
+	}
+	if ((roiHeight < 1) || (roiHeight > (frameHeight - roiY)))
+	{
+		roiHeight	=	frameHeight - roiY;
+	}
+
+	//*	same frame, same ROI, nothing to do
+	if ((cImageStats.histogram != NULL) &&
+		(cImageStats.frameNumber == cFramesRead) &&
+		(cImageStats.roiX == roiX) && (cImageStats.roiY == roiY) &&
+		(cImageStats.roiWidth == roiWidth) && (cImageStats.roiHeight == roiHeight))
+	{
+		return(kASCOM_Err_Success);
+	}
+
+	startMilliSecs	=	millis();
+	free(cImageStats.histogram);
+	cImageStats.frameNumber	=	-1;
+	cImageStats.histogram	=	(uint32_t *)calloc(bandInfo.channels * bandInfo.histSize, sizeof(uint32_t));
+	if (cImageStats.histogram == NULL)
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to allocate histogram");
+		return(kASCOM_Err_InternalError);
+	}
+	bandInfo.srcRowBytes	=	(long)frameWidth * bandInfo.channels * bandInfo.bytesPerValue;
+	bandInfo.srcPtr			=	cCameraDataBuffer +	((long)roiY * bandInfo.srcRowBytes) +
+												((long)roiX * bandInfo.channels * bandInfo.bytesPerValue);
+	bandInfo.roiWidth		=	roiWidth;
+	bandInfo.histogram		=	cImageStats.histogram;
+	pthread_mutex_init(&bandInfo.mergeMutex, NULL);
+	ImageKernel_RunRowBands(roiHeight, ImageStats_BandProc, &bandInfo);
+	pthread_mutex_destroy(&bandInfo.mergeMutex);
+
+	for (ccc=0; ccc<bandInfo.channels; ccc++)
+	{
+		ImageStats_FromHistogram(	&cImageStats.channelStats[ccc],
+									(cImageStats.histogram + (ccc * bandInfo.histSize)),
+									bandInfo.histSize);
+	}
+	cImageStats.frameNumber	=	cFramesRead;
+	cImageStats.roiX		=	roiX;
+	cImageStats.roiY		=	roiY;
+	cImageStats.roiWidth	=	roiWidth;
+	cImageStats.roiHeight	=	roiHeight;
+	cImageStats.channels	=	bandInfo.channels;
+	cImageStats.histSize	=	bandInfo.histSize;
+	cImageStats.calc_ms		=	millis() - startMilliSecs;
+	return(kASCOM_Err_Success);
+}
+
+//*****************************************************************************
+//*	bins=INT			(optional, histogram bins per channel, default 4096, 0 = no histogram)
+//*	x=INT, y=INT, width=INT, height=INT	(optional ROI, default the whole frame)
+//*
+//*	the header has already been sent, the histogram can be bigger than the json buffer
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_ImageStats(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+TYPE_CHANNEL_STATS	*channelStats;
+char				argumentString[32];
+char				lineBuff[2048];
+char				valueBuff[16];
+const char			*channelNames;
+const uint32_t		*histogram;
+uint32_t			binCount;
+int					roiX;
+int					roiY;
+int					roiWidth;
+int					roiHeight;
+int					binCnt;
+int					valuesPerBin;
+int					ccc;
+int					ii;
+int					jj;
+
+	if ((cCameraDataBuffer == NULL) || (cFramesRead <= 0) ||
+		(cLastExposure_ROIinfo.currentROIwidth <= 0) || (cLastExposure_ROIinfo.currentROIheight <= 0))
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "No image available");
+		return(kASCOM_Err_InvalidOperation);
+	}
+
+	roiX		=	0;
+	roiY		=	0;
+	roiWidth	=	0;
+	roiHeight	=	0;
+	binCnt		=	kImageStats_DefaultBins;
+	if (GetKeyWordArgument(reqData->contentData, "x", argumentString, (sizeof(argumentString) -1)))
+	{
+		roiX	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "y", argumentString, (sizeof(argumentString) -1)))
+	{
+		roiY	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "width", argumentString, (sizeof(argumentString) -1)))
+	{
+		roiWidth	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "height", argumentString, (sizeof(argumentString) -1)))
+	{
+		roiHeight	=	atoi(argumentString);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "bins", argumentString, (sizeof(argumentString) -1)))
+	{
+		binCnt	=	atoi(argumentString);
+		if (binCnt < 0)
+		{
+			binCnt	=	0;
+		}
+	}
+
+	alpacaErrCode	=	ImageStats_Calculate(roiX, roiY, roiWidth, roiHeight, alpacaErrMsg);
+	if (alpacaErrCode != kASCOM_Err_Success)
+	{
+		return(alpacaErrCode);
+	}
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"frame",
+									cImageStats.frameNumber,
+									INCLUDE_COMMA);
+
+	sprintf(lineBuff, "\t\"roi\":{\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d},\r\n",
+							cImageStats.roiX,
+							cImageStats.roiY,
+							cImageStats.roiWidth,
+							cImageStats.roiHeight);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									lineBuff);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"bitdepth",
+									((cImageStats.histSize > 256) ? 16 : 8),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"stats_ms",
+									cImageStats.calc_ms,
+									INCLUDE_COMMA);
+
+	//*	one entry per channel
+	channelNames	=	(cImageStats.channels == 3) ? "RGB" : "L";
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"channels");
+	for (ccc=0; ccc<cImageStats.channels; ccc++)
+	{
+		channelStats	=	&cImageStats.channelStats[ccc];
+		sprintf(lineBuff, "%s\r\n\t\t{\"channel\":\"%c\",\"pixels\":%llu,\"min\":%d,\"max\":%d,\"mean\":%1.3f,\"median\":%d,\"stddev\":%1.3f,\"saturated\":%u}",
+								((ccc > 0) ? "," : ""),
+								channelNames[ccc],
+								(unsigned long long)channelStats->pixelCnt,
+								channelStats->minValue,
+								channelStats->maxValue,
+								channelStats->mean,
+								channelStats->median,
+								channelStats->stdDev,
+								channelStats->saturatedCnt);
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										lineBuff);
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+
+	//*	histogram, the full depth histogram is added up into binCnt bins
+	if (binCnt > 0)
+	{
+		if (binCnt > cImageStats.histSize)
+		{
+			binCnt	=	cImageStats.histSize;
+		}
+		valuesPerBin	=	(cImageStats.histSize + binCnt - 1) / binCnt;
+		binCnt			=	(cImageStats.histSize + valuesPerBin - 1) / valuesPerBin;
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"binwidth",
+										valuesPerBin,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"histogram");
+		for (ccc=0; ccc<cImageStats.channels; ccc++)
+		{
+			histogram	=	cImageStats.histogram + (ccc * cImageStats.histSize);
+			strcpy(lineBuff, ((ccc > 0) ? ",\r\n\t\t[" : "\r\n\t\t["));
+			for (ii=0; ii<binCnt; ii++)
+			{
+				binCount	=	0;
+				for (jj=(ii * valuesPerBin); (jj < ((ii + 1) * valuesPerBin)) && (jj < cImageStats.histSize); jj++)
+				{
+					binCount	+=	histogram[jj];
+				}
+				sprintf(valueBuff, "%s%u", ((ii > 0) ? "," : ""), binCount);
+				strcat(lineBuff, valueBuff);
+				if (((ii + 1) % kImageStats_ValuesPerLine) == 0)
+				{
+					cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+													reqData->jsonTextBuffer,
+													kMaxJsonBuffLen,
+													lineBuff);
+					lineBuff[0]	=	0;
+				}
+			}
+			strcat(lineBuff, "]");
+			cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+											reqData->jsonTextBuffer,
+											kMaxJsonBuffLen,
+											lineBuff);
+		}
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										INCLUDE_COMMA);
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
@@ -30,6 +30,8 @@
 //*	Jan 29,	2020	<MLS> Can save jpegs using libjpeg instead of opencv
 //*	Jan 29,	2020	<MLS> Successfully saving jpegs on NVidia/jetson
 //*	Sep 10,	2023	<MLS> Test lib jpeg routines again, working fine
+//*	Oct 19,	2026	<MLS> SaveUsingJpegLib() now uses the multithreaded encoder (image_encode.c)
+//*	Oct 19,	2026	<MLS> SaveUsingJpegLib() handles RAW8/RAW16/RGB24, was assuming RGB
 //*****************************************************************************
 
 
@@ -38,26 +40,24 @@
 #include	<stdio.h>
 #include	<string.h>
 
-
-#include	<jpeglib.h>
-#include	<jerror.h>
-
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
 
+#include	"helper_functions.h"
+#include	"image_encode.h"
 #include	"cameradriver.h"
 
 
+//**************************************************************************************
+//*	used when there is no OpenCV, the JPEG is made from the raw camera data
 //**************************************************************************************
 void	CameraDriver::SaveUsingJpegLib(void)
 {
-struct jpeg_compress_struct	jinfo;
-struct jpeg_error_mgr		jerr;
-FILE						*outputFile;
-JSAMPROW					row_pointer[1];
-int							row_stride;
-char						imageFileName[64];
-char						imageFilePath[128];
+TYPE_ENCODE_IMAGE	encodeImage;
+TYPE_ENCODE_OPTIONS	encodeOptions;
+uint32_t			startMilliSecs;
+char				imageFileName[64];
+char				imageFilePath[128];
 
 //	CONSOLE_DEBUG(__FUNCTION__);
 
@@ -70,38 +70,19 @@ char						imageFilePath[128];
 	strcat(imageFilePath, "/");
 	strcat(imageFilePath, imageFileName);
 
-
-	jinfo.err	=	jpeg_std_error(&jerr);
-
-	jpeg_create_compress(&jinfo);
-
-	outputFile	=	fopen(imageFilePath, "wb");
-	if (outputFile != NULL)
+	ImageEncode_SetupRawImage(&encodeImage);
+	encodeOptions	=	cImageEncodeOptions;
+	if (cImageEncodeFast == false)
 	{
-		jpeg_stdio_dest(&jinfo, outputFile);
-
-		jinfo.image_width		=	cCameraProp.CameraXsize;
-		jinfo.image_height		=	cCameraProp.CameraYsize;
-		jinfo.input_components	=	3;
-		jinfo.in_color_space	=	JCS_RGB;
-
-		jpeg_set_defaults(&jinfo);
-		jpeg_set_quality(&jinfo, 95, TRUE);
-
-		jpeg_start_compress(&jinfo, TRUE);
-
-		row_stride				=	cCameraProp.CameraXsize * 3;
-
-		while (jinfo.next_scanline < jinfo.image_height)
-		{
-			row_pointer[0]	=	&cCameraDataBuffer[jinfo.next_scanline * row_stride];
-			jpeg_write_scanlines(&jinfo, row_pointer, 1);
-
-		}
-		jpeg_finish_compress(&jinfo);
-
-		fclose(outputFile);
+		//*	the original output, one thread
+		encodeOptions.stripCount	=	1;
+	}
 
+	startMilliSecs	=	millis();
+	if (ImageEncode_SaveJPEG(&encodeImage, &encodeOptions, imageFilePath))
+	{
+		cJpegEncode_ms	=	millis() - startMilliSecs;
+		strcpy(cLastJpegImageName, imageFilePath);	//*	save the full image path for the web server
 		AddToDataProductsList(imageFileName, "jpeglib");
 	}
 	else
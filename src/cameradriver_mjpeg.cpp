@@ -0,0 +1,616 @@
+//**************************************************************************
+//*	Name:			cameradriver_mjpeg.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	MJPEG live stream of the camera frames
+//*
+//*					/api/v1/camera/0/mjpeg?maxwidth=1024&stretch=auto&quality=70
+//*
+//*					This is a multipart/x-mixed-replace response that stays open,
+//*					a browser shows it as a moving image (<img src="...">).
+//*					Every frame read (live mode, a sequence, single exposures, video
+//*					on cameras that support it) is sent to all of the clients.
+//*
+//*					The acquisition loop only does the reduction (the same box filter
+//*					passes as preview) into a buffer owned by the stream, that reads
+//*					the full frame once, about the same as a memcpy().
+//*					If the stream is still encoding the last frame, the new one is skipped.
+//*
+//*					The stream thread stretches and encodes each frame once (fast DCT)
+//*					and writes it to all of the clients with non blocking sockets.
+//*					A slow client finishes the frame it is on and then gets the newest
+//*					one, the frames in between are dropped for that client only.
+//*
+//*					The stream settings are shared, the most recent client sets them.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_mjpeg.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<strings.h>
+#include	<unistd.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<poll.h>
+#include	<pthread.h>
+#include	<sys/socket.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"socket_listen.h"
+#include	"image_encode.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+#define	kMJPEG_DefaultMaxWidth	1024
+#define	kMJPEG_MinWidth			16
+#define	kMJPEG_DefaultQuality	70
+#define	kMJPEG_Boundary			"AlpacaPiFrame"
+#define	kMJPEG_PollTimeout_ms	1000
+#define	kMJPEG_SendBufferSize	(256 * 1024)	//*	more than this and a slow client sees old frames
+
+//*****************************************************************************
+static void	*MJPEG_Thread(void *arg)
+{
+CameraDriver	*cameraDriver;
+
+	cameraDriver	=	(CameraDriver *)arg;
+	cameraDriver->MJPEG_RunThread();
+	return(NULL);
+}
+
+//*****************************************************************************
+//*	must be called with cMJPEGmutex locked
+//*****************************************************************************
+void	CameraDriver::MJPEG_ReleaseFrame(TYPE_MJPEG_FRAME *frame)
+{
+	if (frame != NULL)
+	{
+		frame->refCnt--;
+		if (frame->refCnt <= 0)
+		{
+			free(frame->dataPtr);
+			free(frame);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	must be called with cMJPEGmutex locked
+//*****************************************************************************
+void	CameraDriver::MJPEG_CloseClient(TYPE_MJPEG_CLIENT *client)
+{
+	CONSOLE_DEBUG_W_STR("MJPEG client closed\t=", client->ipAddress);
+	shutdown(client->socketFD, SHUT_RDWR);
+	close(client->socketFD);
+	MJPEG_ReleaseFrame(client->frame);
+	memset(client, 0, sizeof(TYPE_MJPEG_CLIENT));
+	client->socketFD	=	-1;
+	cMJPEGclientCnt--;
+}
+
+//*****************************************************************************
+//*	called from the acquisition loop after the frame has been processed
+//*****************************************************************************
+void	CameraDriver::MJPEG_SubmitCurrentFrame(void)
+{
+	switch(cLastExposure_ROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+			MJPEG_SubmitFrame(	cCameraDataBuffer,
+								cLastExposure_ROIinfo.currentROIwidth,
+								cLastExposure_ROIinfo.currentROIheight,
+								1,
+								1);
+			break;
+
+		case kImageType_RAW16:
+			MJPEG_SubmitFrame(	cCameraDataBuffer,
+								cLastExposure_ROIinfo.currentROIwidth,
+								cLastExposure_ROIinfo.currentROIheight,
+								1,
+								2);
+			break;
+
+		case kImageType_RGB24:
+			MJPEG_SubmitFrame(	cCameraDataBuffer,
+								cLastExposure_ROIinfo.currentROIwidth,
+								cLastExposure_ROIinfo.currentROIheight,
+								3,
+								1);
+			break;
+
+		default:
+			break;
+	}
+}
+
+//*****************************************************************************
+//*	hands a frame to the stream thread, pixels are contiguous rows, 3 channels are BGR.
+//*	This does not wait for the stream, if it is busy the frame is skipped
+//*****************************************************************************
+void	CameraDriver::MJPEG_SubmitFrame(const uint8_t *pixels, int width, int height, const int channels, const int bytesPerValue)
+{
+const uint8_t	*reducedPixels;
+size_t			frameSize;
+bool			encoderBusy;
+
+	if ((cMJPEGclientCnt <= 0) || (pixels == NULL) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+	pthread_mutex_lock(&cMJPEGmutex);
+	encoderBusy	=	cMJPEGinputPending;
+	pthread_mutex_unlock(&cMJPEGmutex);
+	if (encoderBusy)
+	{
+		cMJPEGframesSkipped++;
+		return;
+	}
+
+	//*	the scratch buffers are not in use by the stream thread until cMJPEGinputPending is set
+	reducedPixels	=	Preview_Reduce(	pixels,
+										&width,
+										&height,
+										channels,
+										bytesPerValue,
+										cMJPEGmaxWidth,
+										cMJPEGscratch,
+										cMJPEGscratchSize);
+	if (reducedPixels == pixels)
+	{
+		//*	already small enough, it still has to be copied, the camera buffer is reused
+		frameSize	=	(size_t)width * height * channels * bytesPerValue;
+		if (cMJPEGscratchSize[0] < frameSize)
+		{
+			free(cMJPEGscratch[0]);
+			cMJPEGscratch[0]		=	(uint8_t *)malloc(frameSize);
+			cMJPEGscratchSize[0]	=	(cMJPEGscratch[0] != NULL) ? frameSize : 0;
+		}
+		reducedPixels	=	NULL;
+		if (cMJPEGscratch[0] != NULL)
+		{
+			memcpy(cMJPEGscratch[0], pixels, frameSize);
+			reducedPixels	=	cMJPEGscratch[0];
+		}
+	}
+	if (reducedPixels == NULL)
+	{
+		CONSOLE_DEBUG("Failed to allocate MJPEG buffer");
+		return;
+	}
+
+	pthread_mutex_lock(&cMJPEGmutex);
+	cMJPEGinputPtr				=	reducedPixels;
+	cMJPEGinputWidth			=	width;
+	cMJPEGinputHeight			=	height;
+	cMJPEGinputChannels			=	channels;
+	cMJPEGinputBytesPerValue	=	bytesPerValue;
+	cMJPEGinputFrameNum			=	cFramesRead;
+	cMJPEGinputPending			=	true;
+	pthread_mutex_unlock(&cMJPEGmutex);
+	if (write(cMJPEGwakePipe[1], "F", 1) < 0)
+	{
+		//*	the pipe is full, the stream thread is already awake
+	}
+}
+
+//*****************************************************************************
+//*	runs in the stream thread, the input belongs to it until cMJPEGinputPending is cleared
+//*****************************************************************************
+void	CameraDriver::MJPEG_EncodeFrame(void)
+{
+TYPE_ENCODE_IMAGE	encodeImage;
+TYPE_ENCODE_OPTIONS	encodeOptions;
+TYPE_MJPEG_FRAME	*newFrame;
+uint8_t				*displayBuf;
+uint8_t				*jpegBuf;
+size_t				jpegSize;
+char				partHeader[256];
+size_t				partHeaderLen;
+uint32_t			startMilliSecs;
+bool				encodeOK;
+
+	startMilliSecs	=	millis();
+	newFrame		=	NULL;
+	jpegBuf			=	NULL;
+	jpegSize		=	0;
+	encodeOK		=	false;
+	displayBuf		=	(uint8_t *)malloc((size_t)cMJPEGinputWidth * cMJPEGinputHeight * cMJPEGinputChannels);
+	if ((displayBuf != NULL) && Preview_Stretch(displayBuf,
+												cMJPEGinputPtr,
+												(cMJPEGinputWidth * cMJPEGinputHeight),
+												cMJPEGinputChannels,
+												cMJPEGinputBytesPerValue,
+												cMJPEGstretch))
+	{
+		memset(&encodeImage, 0, sizeof(TYPE_ENCODE_IMAGE));
+		encodeImage.pixels			=	displayBuf;
+		encodeImage.width			=	cMJPEGinputWidth;
+		encodeImage.height			=	cMJPEGinputHeight;
+		encodeImage.rowBytes		=	cMJPEGinputWidth * cMJPEGinputChannels;
+		encodeImage.channels		=	cMJPEGinputChannels;
+		encodeImage.bytesPerSample	=	1;
+		encodeImage.bgrOrder		=	false;
+		ImageEncode_SetDefaults(&encodeOptions);
+		encodeOptions.jpegQuality	=	cMJPEGquality;
+		encodeOptions.jpegFastDCT	=	true;
+		encodeOK	=	ImageEncode_JPEGtoMemory(&encodeImage, &encodeOptions, &jpegBuf, &jpegSize);
+	}
+	free(displayBuf);
+
+	if (encodeOK && (jpegBuf != NULL))
+	{
+		sprintf(partHeader,	"--" kMJPEG_Boundary "\r\n"
+							"Content-Type: image/jpeg\r\n"
+							"Content-Length: %ld\r\n"
+							"AlpacaPi-Frame: %ld\r\n"
+							"\r\n",
+							(long)jpegSize,
+							cMJPEGinputFrameNum);
+		partHeaderLen	=	strlen(partHeader);
+		newFrame		=	(TYPE_MJPEG_FRAME *)calloc(1, sizeof(TYPE_MJPEG_FRAME));
+		if (newFrame != NULL)
+		{
+			newFrame->dataPtr	=	(uint8_t *)malloc(partHeaderLen + jpegSize + 2);
+			if (newFrame->dataPtr != NULL)
+			{
+				memcpy(newFrame->dataPtr, partHeader, partHeaderLen);
+				memcpy(newFrame->dataPtr + partHeaderLen, jpegBuf, jpegSize);
+				memcpy(newFrame->dataPtr + partHeaderLen + jpegSize, "\r\n", 2);
+				newFrame->dataLen	=	partHeaderLen + jpegSize + 2;
+				newFrame->refCnt	=	1;
+			}
+			else
+			{
+				free(newFrame);
+				newFrame	=	NULL;
+			}
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG("Failed to encode MJPEG frame");
+	}
+	free(jpegBuf);
+
+	pthread_mutex_lock(&cMJPEGmutex);
+	if (newFrame != NULL)
+	{
+		MJPEG_ReleaseFrame(cMJPEGframe);
+		cMJPEGframeSeq++;
+		newFrame->frameSeq	=	cMJPEGframeSeq;
+		cMJPEGframe			=	newFrame;
+		cMJPEGframesEncoded++;
+	}
+	cMJPEGinputPending	=	false;
+	pthread_mutex_unlock(&cMJPEGmutex);
+	cMJPEGencode_ms	=	millis() - startMilliSecs;
+}
+
+//*****************************************************************************
+//*	encodes the frames that are handed off and writes them to the clients,
+//*	exits when the last client is gone
+//*****************************************************************************
+void	CameraDriver::MJPEG_RunThread(void)
+{
+struct pollfd		pollList[kMJPEG_MaxClients + 1];
+int					clientIdx[kMJPEG_MaxClients + 1];
+TYPE_MJPEG_CLIENT	*client;
+int					pollCnt;
+int					iii;
+bool				encodePending;
+ssize_t				bytesWritten;
+char				readBuff[256];
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	while (true)
+	{
+		pthread_mutex_lock(&cMJPEGmutex);
+		if (cMJPEGclientCnt <= 0)
+		{
+			MJPEG_ReleaseFrame(cMJPEGframe);
+			cMJPEGframe			=	NULL;
+			cMJPEGthreadRunning	=	false;
+			pthread_mutex_unlock(&cMJPEGmutex);
+			break;
+		}
+		encodePending	=	cMJPEGinputPending;
+		pthread_mutex_unlock(&cMJPEGmutex);
+
+		if (encodePending)
+		{
+			MJPEG_EncodeFrame();
+		}
+
+		//*	clients that are between frames start on the newest one
+		pthread_mutex_lock(&cMJPEGmutex);
+		pollList[0].fd		=	cMJPEGwakePipe[0];
+		pollList[0].events	=	POLLIN;
+		pollList[0].revents	=	0;
+		pollCnt				=	1;
+		for (iii=0; iii<kMJPEG_MaxClients; iii++)
+		{
+			client	=	&cMJPEGclients[iii];
+			if (client->socketFD >= 0)
+			{
+				if ((client->frame == NULL) && (cMJPEGframe != NULL) && (client->lastFrameSeq != cMJPEGframe->frameSeq))
+				{
+					if (client->lastFrameSeq > 0)
+					{
+						client->framesDropped	+=	cMJPEGframe->frameSeq - client->lastFrameSeq - 1;
+					}
+					client->frame		=	cMJPEGframe;
+					client->sendOffset	=	0;
+					client->frame->refCnt++;
+				}
+				//*	POLLIN is only for seeing the connection close, the clients do not send anything
+				pollList[pollCnt].fd		=	client->socketFD;
+				pollList[pollCnt].events	=	(client->frame != NULL) ? (POLLIN | POLLOUT) : POLLIN;
+				pollList[pollCnt].revents	=	0;
+				clientIdx[pollCnt]			=	iii;
+				pollCnt++;
+			}
+		}
+		pthread_mutex_unlock(&cMJPEGmutex);
+
+		poll(pollList, pollCnt, kMJPEG_PollTimeout_ms);
+		if (pollList[0].revents & POLLIN)
+		{
+			while (read(cMJPEGwakePipe[0], readBuff, sizeof(readBuff)) > 0)
+			{
+				//*	empty the pipe
+			}
+		}
+
+		pthread_mutex_lock(&cMJPEGmutex);
+		for (iii=1; iii<pollCnt; iii++)
+		{
+			client	=	&cMJPEGclients[clientIdx[iii]];
+			if (pollList[iii].revents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				MJPEG_CloseClient(client);
+				continue;
+			}
+			if (pollList[iii].revents & POLLIN)
+			{
+				bytesWritten	=	recv(client->socketFD, readBuff, sizeof(readBuff), MSG_DONTWAIT);
+				if ((bytesWritten == 0) || ((bytesWritten < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)))
+				{
+					MJPEG_CloseClient(client);
+					continue;
+				}
+			}
+			if ((pollList[iii].revents & POLLOUT) && (client->frame != NULL))
+			{
+				bytesWritten	=	send(	client->socketFD,
+											(client->frame->dataPtr + client->sendOffset),
+											(client->frame->dataLen - client->sendOffset),
+											(MSG_DONTWAIT | MSG_NOSIGNAL));
+				if (bytesWritten > 0)
+				{
+					client->sendOffset	+=	bytesWritten;
+					if (client->sendOffset >= client->frame->dataLen)
+					{
+						client->lastFrameSeq	=	client->frame->frameSeq;
+						client->framesSent++;
+						MJPEG_ReleaseFrame(client->frame);
+						client->frame			=	NULL;
+					}
+				}
+				else if ((bytesWritten < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+				{
+					MJPEG_CloseClient(client);
+				}
+			}
+		}
+		pthread_mutex_unlock(&cMJPEGmutex);
+	}
+	CONSOLE_DEBUG_W_STR(__FUNCTION__, "exit");
+}
+
+//*****************************************************************************
+void	CameraDriver::MJPEG_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"mjpegclients",
+									cMJPEGclientCnt,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"mjpegframes",
+									cMJPEGframesEncoded,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"mjpegskipped",
+									cMJPEGframesSkipped,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"mjpeg_encode_ms",
+									cMJPEGencode_ms,
+									INCLUDE_COMMA);
+}
+
+//*****************************************************************************
+//*	maxwidth=INT, stretch=auto|linear|none, quality=INT
+//*	the socket is handed to the stream thread, it stays open until the client closes it
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_MJPEGstream(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_MJPEG_CLIENT	*client;
+char				argumentString[32];
+char				httpHeader[512];
+int					sendBufferSize;
+int					maxWidth;
+int					stretchMode;
+int					quality;
+int					threadErr;
+int					iii;
+ssize_t				bytesWritten;
+
+	if (ImageEncode_JPEGsupported() == false)
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "JPEG not supported in this build");
+		return(kASCOM_Err_NotImplemented);
+	}
+
+	maxWidth	=	kMJPEG_DefaultMaxWidth;
+	stretchMode	=	kPreviewStretch_Auto;
+	quality		=	kMJPEG_DefaultQuality;
+	if (GetKeyWordArgument(reqData->contentData, "maxwidth", argumentString, (sizeof(argumentString) -1)))
+	{
+		maxWidth	=	atoi(argumentString);
+		if (maxWidth < kMJPEG_MinWidth)
+		{
+			maxWidth	=	kMJPEG_MinWidth;
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "stretch", argumentString, (sizeof(argumentString) -1)))
+	{
+		if (strcasecmp(argumentString, "auto") == 0)
+		{
+			stretchMode	=	kPreviewStretch_Auto;
+		}
+		else if (strcasecmp(argumentString, "linear") == 0)
+		{
+			stretchMode	=	kPreviewStretch_Linear;
+		}
+		else if (strcasecmp(argumentString, "none") == 0)
+		{
+			stretchMode	=	kPreviewStretch_None;
+		}
+		else
+		{
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Stretch must be 'auto', 'linear' or 'none'");
+			return(kASCOM_Err_InvalidValue);
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "quality", argumentString, (sizeof(argumentString) -1)))
+	{
+		quality	=	atoi(argumentString);
+		if ((quality < 1) || (quality > 100))
+		{
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Quality must be 1 to 100");
+			return(kASCOM_Err_InvalidValue);
+		}
+	}
+
+	//*	the wake up pipe is made once and kept
+	if (cMJPEGwakePipe[0] < 0)
+	{
+		if (pipe2(cMJPEGwakePipe, (O_NONBLOCK | O_CLOEXEC)) != 0)
+		{
+			cMJPEGwakePipe[0]	=	-1;
+			cMJPEGwakePipe[1]	=	-1;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to create stream pipe");
+			return(kASCOM_Err_InternalError);
+		}
+	}
+
+	pthread_mutex_lock(&cMJPEGmutex);
+	client	=	NULL;
+	for (iii=0; iii<kMJPEG_MaxClients; iii++)
+	{
+		if (cMJPEGclients[iii].socketFD < 0)
+		{
+			client	=	&cMJPEGclients[iii];
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cMJPEGmutex);
+	if (client == NULL)
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Too many stream clients");
+		return(kASCOM_Err_InvalidOperation);
+	}
+
+	//*	the header goes out before the socket is given to the stream thread
+	cResponseIsJSON	=	false;
+	strcpy(httpHeader,	"HTTP/1.0 200 OK\r\n");
+	strcat(httpHeader,	"Content-type: multipart/x-mixed-replace; boundary=" kMJPEG_Boundary "\r\n");
+	strcat(httpHeader,	"Server: AlpacaPi\r\n");
+	strcat(httpHeader,	"Cache-Control: no-cache\r\n");
+	strcat(httpHeader,	"Connection: close\r\n");
+	strcat(httpHeader,	"\r\n");
+	bytesWritten	=	write(reqData->socket, httpHeader, strlen(httpHeader));
+	if (bytesWritten <= 0)
+	{
+		CONSOLE_DEBUG("Write Error");
+		return(kASCOM_Err_Success);
+	}
+	//*	a small send buffer, so a slow client drops frames instead of queueing them
+	sendBufferSize	=	kMJPEG_SendBufferSize;
+	setsockopt(reqData->socket, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+	fcntl(reqData->socket, F_SETFL, (fcntl(reqData->socket, F_GETFL) | O_NONBLOCK));
+	SocketListen_DetachSocket();
+
+	pthread_mutex_lock(&cMJPEGmutex);
+	memset(client, 0, sizeof(TYPE_MJPEG_CLIENT));
+	client->socketFD	=	reqData->socket;
+	strcpy(client->ipAddress, reqData->clientIPaddr);
+	cMJPEGclientCnt++;
+	cMJPEGmaxWidth		=	maxWidth;
+	cMJPEGstretch		=	stretchMode;
+	cMJPEGquality		=	quality;
+	if (cMJPEGthreadRunning == false)
+	{
+		threadErr	=	pthread_create(&cMJPEGthreadID, NULL, &MJPEG_Thread, this);
+		if (threadErr == 0)
+		{
+			pthread_detach(cMJPEGthreadID);
+			cMJPEGthreadRunning	=	true;
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_NUM("pthread_create() returned error#", threadErr);
+			MJPEG_CloseClient(client);
+		}
+	}
+	pthread_mutex_unlock(&cMJPEGmutex);
+	if (write(cMJPEGwakePipe[1], "C", 1) < 0)
+	{
+		//*	the pipe is full, the stream thread is already awake
+	}
+	CONSOLE_DEBUG_W_STR("MJPEG client added\t=", reqData->clientIPaddr);
+	return(kASCOM_Err_Success);
+}
+
+#endif // _ENABLE_CAMERA_
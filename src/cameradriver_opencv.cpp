@@ -40,10 +40,14 @@
 //*	Apr 19,	2020	<MLS> Fixed cross hair location when using sidebar
 //*	Feb 21,	2021	<MLS> Added CloseLiveImage(), live window now closes properly
 //*	Feb 23,	2022	<MLS> Working on converting C++ versions of opencv
+//*	Oct 19,	2026	<MLS> Added display pyramid, DisplayPyramid_Build() & DisplayPyramid_Free()
+//*	Oct 19,	2026	<MLS> Live view is made from the pyramid level closest to the display size
+//*	Oct 19,	2026	<MLS> Sidebar lines and histogram are only redrawn when they change
 //*****************************************************************************
 
 #if defined(_ENABLE_CAMERA_) && defined(_USE_OPENCV_)
 #include	<stdio.h>
+#include	<stdlib.h>
 #include	<string.h>
 
 #ifdef _ENABLE_STAR_SEARCH_
@@ -59,6 +63,7 @@
 #include	"alpacadriver_helper.h"
 #include	"cameradriver.h"
 #include	"commoncolor.h"
+#include	"image_kernels.h"
 
 #define	FC_BLUE()	CV_RGB(0x64, 0x8c, 0xff)
 
@@ -327,9 +332,16 @@ int	iii;
 	{
 		CONSOLE_DEBUG("No window to close, (cOpenCV_LiveDispla NULL");
 	}
+	if (cOpenCV_LiveSmallPtr != NULL)
+	{
+		cvReleaseImage(&cOpenCV_LiveSmallPtr);
+		cOpenCV_LiveSmallPtr	=	NULL;
+	}
 	CONSOLE_DEBUG("Calling cvDestroyWindow(cOpenCV_ImgWindowName)");
 	cvDestroyWindow(cOpenCV_ImgWindowName);
 #endif // _USE_OPENCV_CPP_
+	DisplayPyramid_Free();
+	cSideBarValid			=	false;
 	cCreateOpenCVwindow		=	true;
 	cOpenCV_ImgWindowValid	=	false;
 
@@ -472,6 +484,139 @@ int	iii;
 //}
 //#endif // _USE_OPENCV_CPP_
 
+//*****************************************************************************
+typedef struct	//	TYPE_PYRAMID_BAND
+{
+	const uint8_t	*srcPixels;
+	int				srcRowBytes;
+	uint8_t			*dstPixels;
+	int				dstRowBytes;
+	int				dstWidth;
+	int				channels;
+	int				bytesPerSample;
+} TYPE_PYRAMID_BAND;
+
+//*****************************************************************************
+static void	DisplayPyramid_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_PYRAMID_BAND	*band;
+const uint8_t		*srcRow;
+uint8_t				*dstRow;
+int					yy;
+
+	band	=	(TYPE_PYRAMID_BAND *)context;
+	for (yy=firstRow; yy<lastRow; yy++)
+	{
+		srcRow	=	band->srcPixels + ((size_t)(2 * yy) * band->srcRowBytes);
+		dstRow	=	band->dstPixels + ((size_t)yy * band->dstRowBytes);
+		if (band->bytesPerSample == 2)
+		{
+			ImageKernel_Downsample2xRow_U16(	(uint16_t *)dstRow,
+												(const uint16_t *)srcRow,
+												(const uint16_t *)(srcRow + band->srcRowBytes),
+												band->dstWidth,
+												band->channels);
+		}
+		else
+		{
+			ImageKernel_Downsample2xRow_U8(	dstRow,
+											srcRow,
+											srcRow + band->srcRowBytes,
+											band->dstWidth,
+											band->channels);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	builds levels 1 -> (levelCount - 1) of the display pyramid from the new frame,
+//*	each level is made from the one above it so the full size image is only read once.
+//*	The buffers are kept from one frame to the next
+//*****************************************************************************
+bool	CameraDriver::DisplayPyramid_Build(	const uint8_t	*srcPixels,
+											const int		width,
+											const int		height,
+											const int		srcRowBytes,
+											const int		channels,
+											const int		bytesPerSample,
+											const int		levelCount)
+{
+TYPE_PYRAMID_LEVEL	*prevLevel;
+TYPE_PYRAMID_LEVEL	*thisLevel;
+TYPE_PYRAMID_BAND	bandInfo;
+size_t				bufSize;
+int					iii;
+
+	if ((srcPixels == NULL) || (levelCount > kDisplayPyramid_Levels) ||
+		((channels != 1) && (channels != 3)) ||
+		((bytesPerSample != 1) && (bytesPerSample != 2)))
+	{
+		return(false);
+	}
+	//*	level 0 is the original image
+	cDisplayPyramid[0].pixels	=	(uint8_t *)srcPixels;
+	cDisplayPyramid[0].width	=	width;
+	cDisplayPyramid[0].height	=	height;
+	cDisplayPyramid[0].rowBytes	=	srcRowBytes;
+
+	for (iii=1; iii<levelCount; iii++)
+	{
+		prevLevel	=	&cDisplayPyramid[iii - 1];
+		thisLevel	=	&cDisplayPyramid[iii];
+
+		thisLevel->width	=	prevLevel->width / 2;
+		thisLevel->height	=	prevLevel->height / 2;
+		thisLevel->rowBytes	=	thisLevel->width * channels * bytesPerSample;
+		if ((thisLevel->width < 1) || (thisLevel->height < 1))
+		{
+			return(false);
+		}
+		bufSize	=	(size_t)thisLevel->rowBytes * thisLevel->height;
+		if (bufSize > thisLevel->bufSize)
+		{
+			if (thisLevel->pixels != NULL)
+			{
+				free(thisLevel->pixels);
+			}
+			thisLevel->pixels	=	(uint8_t *)malloc(bufSize);
+			thisLevel->bufSize	=	(thisLevel->pixels != NULL) ? bufSize : 0;
+			if (thisLevel->pixels == NULL)
+			{
+				CONSOLE_DEBUG("Failed to allocate display pyramid");
+				return(false);
+			}
+		}
+
+		bandInfo.srcPixels		=	prevLevel->pixels;
+		bandInfo.srcRowBytes	=	prevLevel->rowBytes;
+		bandInfo.dstPixels		=	thisLevel->pixels;
+		bandInfo.dstRowBytes	=	thisLevel->rowBytes;
+		bandInfo.dstWidth		=	thisLevel->width;
+		bandInfo.channels		=	channels;
+		bandInfo.bytesPerSample	=	bytesPerSample;
+		ImageKernel_RunRowBands(thisLevel->height, DisplayPyramid_BandProc, &bandInfo);
+	}
+	return(true);
+}
+
+//*****************************************************************************
+void	CameraDriver::DisplayPyramid_Free(void)
+{
+int		iii;
+
+	//*	level 0 belongs to the image
+	cDisplayPyramid[0].pixels	=	NULL;
+	for (iii=1; iii<kDisplayPyramid_Levels; iii++)
+	{
+		if (cDisplayPyramid[iii].pixels != NULL)
+		{
+			free(cDisplayPyramid[iii].pixels);
+		}
+	}
+	memset(cDisplayPyramid, 0, sizeof(cDisplayPyramid));
+	cDisplayPyramidLevel	=	0;
+}
+
 #if defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4)
 //	#warning "OpenCV++ not finished"
 //*****************************************************************************
@@ -488,6 +633,12 @@ int			windowWidth;
 int			windowHeight;
 CvRect		roiRect;
 CvRect		myCVrect;
+IplImage	*sourceImage;
+IplImage	levelImage;
+int			levelCount;
+int			levelWidth;
+int			levelHeight;
+bool		sameSize;
 
 //	CONSOLE_DEBUG(__FUNCTION__);
 	if (cNewImageReadyToDisplay)
@@ -564,13 +715,14 @@ CvRect		myCVrect;
 				}
 				CONSOLE_DEBUG("New display image created");
 				SetOpenCVcolors(cOpenCV_LiveDisplayPtr);
+				cSideBarValid	=	false;
 			}
 
 			if (cOpenCV_LiveDisplayPtr != NULL)
 			{
-				//*	check to see if the image sizes are different
-				if ((cLiveDisplayWidth != cOpenCV_LiveDisplayPtr->width ) ||
-					(cLiveDisplayHeight != cOpenCV_LiveDisplayPtr->height ))
+				//*	the background and the sidebar stay on the display image from one frame
+				//*	to the next, they are only erased when the display is new
+				if (cSideBarValid == false)
 				{
 					//*	set the entire background color
 					myCVrect.x		=	0;
@@ -584,19 +736,15 @@ CvRect		myCVrect;
 									CV_FILLED,					//	int thickness CV_DEFAULT(1),
 									8,							//	int line_type CV_DEFAULT(8),
 									0);							//	int shift CV_DEFAULT(0));
-
-					//*	we have to set the ROI
-//					CONSOLE_DEBUG("we have to set the ROI");
-					roiRect.x		=	cSideBarWidth + cSideFrameWidth;
-					roiRect.y		=	cSideFrameWidth;
-					roiRect.width	=	cLiveDisplayWidth;
-					roiRect.height	=	cLiveDisplayHeight;
-					cvSetImageROI(cOpenCV_LiveDisplayPtr,  roiRect);
-				}
-				else
-				{
-					CONSOLE_DEBUG("SAME");
 				}
+
+				//*	we have to set the ROI
+				roiRect.x		=	cSideBarWidth + cSideFrameWidth;
+				roiRect.y		=	cSideFrameWidth;
+				roiRect.width	=	cLiveDisplayWidth;
+				roiRect.height	=	cLiveDisplayHeight;
+				cvSetImageROI(cOpenCV_LiveDisplayPtr,  roiRect);
+
 			#ifdef _ENABLE_STAR_SEARCH_
 				long	keyPointCnt;
 				//*	this is an attempt at finding the locations of all of the stars in an image.
@@ -610,60 +758,99 @@ CvRect		myCVrect;
 
 				CONSOLE_DEBUG_W_NUM("keyPointCnt\t=", keyPointCnt);
 			#endif // _ENABLE_STAR_SEARCH_
-				//*	lets try to display gray scale on a color screen
-				if ((cOpenCV_ImagePtr->nChannels == 1) && (cOpenCV_ImagePtr->depth == 8))
-				{
-				IplImage	*smallImg;
 
-					//CONSOLE_DEBUG_W_STR(__FUNCTION__, "chan = 1 and depth = 8");
-
-					//*	create a small image (8 bit)
-					smallImg	=	cvCreateImage(cvSize(cLiveDisplayWidth, cLiveDisplayHeight), IPL_DEPTH_8U, 1);
-					if (smallImg != NULL)
-					{
-						cvResize(cOpenCV_ImagePtr, smallImg, CV_INTER_LINEAR);
-					#ifdef _ENABLE_STAR_SEARCH_
-						CONSOLE_DEBUG("Calling ProcessORB_Image!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!");
-						SETUP_TIMING();
-
-						ProcessORB_Image(smallImg, NULL);
-
-						DEBUG_TIMING("Time to complete ORB");
-						CONSOLE_DEBUG_W_NUM("Image width\t=", smallImg->width);
-					#endif // _ENABLE_STAR_SEARCH_
-
-						cvCvtColor(smallImg, cOpenCV_LiveDisplayPtr, CV_GRAY2RGB);
-						cvReleaseImage(&smallImg);
-					}
-					else
+				//*************************************************************
+				//*	pick the smallest pyramid level that is still at least as big as the display,
+				//*	the display size is made by halving the image so it is usually an exact match
+				//*	and the resize becomes a copy
+				levelCount	=	1;
+				levelWidth	=	cOpenCV_ImagePtr->width;
+				levelHeight	=	cOpenCV_ImagePtr->height;
+				while ((levelCount < kDisplayPyramid_Levels) &&
+						((levelWidth / 2) >= cLiveDisplayWidth) &&
+						((levelHeight / 2) >= cLiveDisplayHeight))
+				{
+					levelWidth	=	levelWidth / 2;
+					levelHeight	=	levelHeight / 2;
+					levelCount++;
+				}
+				sourceImage				=	cOpenCV_ImagePtr;
+				cDisplayPyramidLevel	=	0;
+				if ((levelCount > 1) && (cOpenCV_ImagePtr->roi == NULL))
+				{
+					if (DisplayPyramid_Build(	(uint8_t *)cOpenCV_ImagePtr->imageData,
+												cOpenCV_ImagePtr->width,
+												cOpenCV_ImagePtr->height,
+												cOpenCV_ImagePtr->widthStep,
+												cOpenCV_ImagePtr->nChannels,
+												(cOpenCV_ImagePtr->depth / 8),
+												levelCount))
 					{
-						CONSOLE_DEBUG("Failed to create small image");
+						cDisplayPyramidLevel	=	levelCount - 1;
+						cvInitImageHeader(	&levelImage,
+											cvSize(	cDisplayPyramid[cDisplayPyramidLevel].width,
+													cDisplayPyramid[cDisplayPyramidLevel].height),
+											cOpenCV_ImagePtr->depth,
+											cOpenCV_ImagePtr->nChannels);
+						cvSetData(	&levelImage,
+									cDisplayPyramid[cDisplayPyramidLevel].pixels,
+									cDisplayPyramid[cDisplayPyramidLevel].rowBytes);
+						sourceImage	=	&levelImage;
 					}
 				}
-				else if ((cOpenCV_ImagePtr->nChannels == 1) && (cOpenCV_ImagePtr->depth == 16))
-				{
-				IplImage	*smallImg;
+				sameSize	=	((sourceImage->width == cLiveDisplayWidth) && (sourceImage->height == cLiveDisplayHeight));
 
-					CONSOLE_DEBUG_W_STR(__FUNCTION__, "chan = 1 and depth = 16");
-
-					//*	create a small image (16 bit)
-					smallImg	=	cvCreateImage(cvSize(cLiveDisplayWidth, cLiveDisplayHeight), IPL_DEPTH_16U, 1);
-					if (smallImg != NULL)
+				//*	lets try to display gray scale on a color screen
+				if (sourceImage->nChannels == 1)
+				{
+					if (sameSize)
 					{
-						cvResize(cOpenCV_ImagePtr, smallImg, CV_INTER_LINEAR);
-
-						cvCvtColor(smallImg, cOpenCV_LiveDisplayPtr, CV_GRAY2RGB);
-						cvReleaseImage(&smallImg);
+						cvCvtColor(sourceImage, cOpenCV_LiveDisplayPtr, CV_GRAY2RGB);
 					}
 					else
 					{
-						CONSOLE_DEBUG("Failed to create small image");
+						//*	the reduced size gray image is kept from one frame to the next
+						if ((cOpenCV_LiveSmallPtr != NULL) &&
+							((cOpenCV_LiveSmallPtr->width != cLiveDisplayWidth) ||
+							(cOpenCV_LiveSmallPtr->height != cLiveDisplayHeight) ||
+							(cOpenCV_LiveSmallPtr->depth != sourceImage->depth)))
+						{
+							cvReleaseImage(&cOpenCV_LiveSmallPtr);
+							cOpenCV_LiveSmallPtr	=	NULL;
+						}
+						if (cOpenCV_LiveSmallPtr == NULL)
+						{
+							cOpenCV_LiveSmallPtr	=	cvCreateImage(cvSize(cLiveDisplayWidth, cLiveDisplayHeight), sourceImage->depth, 1);
+						}
+						if (cOpenCV_LiveSmallPtr != NULL)
+						{
+							cvResize(sourceImage, cOpenCV_LiveSmallPtr, CV_INTER_LINEAR);
+						#ifdef _ENABLE_STAR_SEARCH_
+							CONSOLE_DEBUG("Calling ProcessORB_Image!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!");
+							SETUP_TIMING();
+
+							ProcessORB_Image(cOpenCV_LiveSmallPtr, NULL);
+
+							DEBUG_TIMING("Time to complete ORB");
+							CONSOLE_DEBUG_W_NUM("Image width\t=", cOpenCV_LiveSmallPtr->width);
+						#endif // _ENABLE_STAR_SEARCH_
+
+							cvCvtColor(cOpenCV_LiveSmallPtr, cOpenCV_LiveDisplayPtr, CV_GRAY2RGB);
+						}
+						else
+						{
+							CONSOLE_DEBUG("Failed to create small image");
+						}
 					}
 				}
+				else if (sameSize)
+				{
+					cvCopy(sourceImage, cOpenCV_LiveDisplayPtr);
+				}
 				else
 				{
 //					CONSOLE_DEBUG_W_STR(__FUNCTION__, "default");
-					cvResize(cOpenCV_ImagePtr, cOpenCV_LiveDisplayPtr, CV_INTER_LINEAR);
+					cvResize(sourceImage, cOpenCV_LiveDisplayPtr, CV_INTER_LINEAR);
 				}
 				if (cDisplayCrossHairs || cDrawRectangle)
 				{
@@ -723,63 +910,125 @@ void	CameraDriver::DrawSidebar(cv::Mat *imageDisplay)
 #else
 
 //*****************************************************************************
-void	CameraDriver::DrawSidebar(IplImage *imageDisplay)
+//*	erases and redraws one line of the sidebar, only if the text is different
+//*	from what was drawn there last time. yLoc is the base line of the text
+//*****************************************************************************
+void	CameraDriver::DrawSidebarLine(	IplImage	*imageDisplay,
+										const int	lineIdx,
+										const int	xLoc,
+										const int	yLoc,
+										const int	lineWidth,
+										const char	*label,
+										const char	*value)
 {
-CvRect		roiRect;
-int			yLoc;
+char		lineText[80];
+CvRect		lineRect;
 CvPoint		point1;
-CvPoint		point2;
-char		textBuffer[64];
-const int	deltaY	=	16;
+const int	lineHeight	=	16;
 
-//	CONSOLE_DEBUG(__FUNCTION__);
+	lineText[0]	=	0;
+	if ((label[0] != 0) || (value != NULL))
+	{
+		snprintf(lineText, sizeof(lineText), "%s\t%s", label, ((value != NULL) ? value : ""));
+	}
+	if ((lineIdx >= 0) && (lineIdx < kSideBar_MaxLines))
+	{
+		if (cSideBarValid && (strcmp(lineText, cSideBarText[lineIdx]) == 0))
+		{
+			return;
+		}
+		strcpy(cSideBarText[lineIdx], lineText);
+	}
+
+	lineRect.x		=	xLoc;
+	lineRect.y		=	yLoc - lineHeight + 4;
+	lineRect.width	=	lineWidth;
+	lineRect.height	=	lineHeight;
+	if (lineRect.y < 0)
+	{
+		lineRect.height	+=	lineRect.y;
+		lineRect.y		=	0;
+	}
+	//*	the title line is above the image, do not erase the top of the image
+	if ((lineRect.x >= (cSideBarWidth + cSideFrameWidth)) && ((lineRect.y + lineRect.height) > cSideFrameWidth))
+	{
+		lineRect.height	=	cSideFrameWidth - lineRect.y;
+	}
+	cvRectangleR(	imageDisplay,
+					lineRect,
+					cSideBarBGcolor,	//	color,
+					CV_FILLED,			//	int thickness CV_DEFAULT(1),
+					8,					//	int line_type CV_DEFAULT(8),
+					0);					//	int shift CV_DEFAULT(0));
+
+	point1.x	=	xLoc;
+	point1.y	=	yLoc;
+	cvPutText(	imageDisplay,	label,		point1,	&cTextFont,	cSideBarTXTcolor);
+	if (value != NULL)
+	{
+		point1.x	=	xLoc + (cSideBarWidth / 2);
+		cvPutText(	imageDisplay,	value,	point1,	&cTextFont,	cSideBarTXTcolor);
+	}
+}
+
+//*****************************************************************************
+void	CameraDriver::DrawSidebar(IplImage *imageDisplay)
+{
+CvRect			roiRect;
+int				yLoc;
+int				lineIdx;
+CvPoint			point1;
+char			textBuffer[64];
+const int		deltaY		=	16;
+const int		lineWidth	=	cSideBarWidth - cSideFrameWidth;
+TYPE_PYRAMID_LEVEL	*pyramidLevel;
+int				histImageType;
+bool			histogramChanged;
 
-	yLoc		=	cSideFrameWidth;
-	point1.x	=	cSideBarWidth + cSideFrameWidth;
-	point1.y	=	yLoc -2 ;
-	cvPutText(	imageDisplay,	cFileNameRoot,		point1,	&cTextFont,	cSideBarTXTcolor);
+//	CONSOLE_DEBUG(__FUNCTION__);
+	if (cSideBarValid == false)
+	{
+		memset(cSideBarText, 0, sizeof(cSideBarText));
+	}
 
+	//*	the file name goes above the image
+	DrawSidebarLine(imageDisplay,
+					0,
+					(cSideBarWidth + cSideFrameWidth),
+					(cSideFrameWidth - 2),
+					(imageDisplay->width - (cSideBarWidth + cSideFrameWidth)),
+					cFileNameRoot,
+					NULL);
 
+	yLoc	=	cSideFrameWidth;
+	lineIdx	=	1;
 
 	//=======================================
 	//*	Frame count
-	point1.x	=	cSideFrameWidth;
-	point1.y	=	yLoc;
-	point2.x	=	cSideFrameWidth + (cSideBarWidth/2);
-	point2.y	=	yLoc;
 	sprintf(textBuffer, "#%ld %d-bit", cFramesRead, cOpenCV_LiveDisplayPtr->depth);
-	cvPutText(	imageDisplay,	textBuffer,				point1,	&cTextFont,	cSideBarTXTcolor);
+	DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, textBuffer, NULL);
 	yLoc	+=	deltaY;
 
 	//=======================================
 	//*	Exposure
-	point1.y	=	yLoc;
-	point2.y	=	yLoc;
 	sprintf(textBuffer, "%f", (cCurrentExposure_us / 1000000.0));
 	if (cAutoAdjustExposure)
 	{
 		strcat(textBuffer, " (auto)");
 	}
-	cvPutText(	imageDisplay,	"Exposure:",			point1,	&cTextFont,	cSideBarTXTcolor);
-	cvPutText(	imageDisplay,	textBuffer,				point2,	&cTextFont,	cSideBarTXTcolor);
+	DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Exposure:", textBuffer);
 	yLoc	+=	deltaY;
 
 	//=======================================
 	//*	Gain
-	point1.y	=	yLoc;
-	point2.y	=	yLoc;
 	sprintf(textBuffer, "%d", cCameraProp.Gain);
-	cvPutText(	imageDisplay,	"Gain:",				point1,	&cTextFont,	cSideBarTXTcolor);
-	cvPutText(	imageDisplay,	textBuffer,				point2,	&cTextFont,	cSideBarTXTcolor);
+	DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Gain:", textBuffer);
 	yLoc	+=	deltaY;
 
 	if (cTempReadSupported)
 	{
-		point1.y	=	yLoc;
-		point2.y	=	yLoc;
 		sprintf(textBuffer, "%2.1f C", cCameraProp.CCDtemperature);
-		cvPutText(	imageDisplay,	"Camera Temp:",			point1,	&cTextFont,	cSideBarTXTcolor);
-		cvPutText(	imageDisplay,	textBuffer,				point2,	&cTextFont,	cSideBarTXTcolor);
+		DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Camera Temp:", textBuffer);
 		yLoc	+=	deltaY;
 	}
 
@@ -787,68 +1036,118 @@ const int	deltaY	=	16;
 #ifdef _ENABLE_FILTERWHEEL_
 	if (strlen(cFilterWheelCurrName) > 0)
 	{
-		point1.y	=	yLoc;
-		point2.y	=	yLoc;
-		cvPutText(	imageDisplay,	"Filter:",				point1,	&cTextFont,	cSideBarTXTcolor);
-		cvPutText(	imageDisplay,	cFilterWheelCurrName,	point2,	&cTextFont,	cSideBarTXTcolor);
+		DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Filter:", cFilterWheelCurrName);
 		yLoc	+=	deltaY;
 	}
 #endif // _ENABLE_FILTERWHEEL_
 
-	point1.y	=	yLoc;
-	point2.y	=	yLoc;
-	cvPutText(	imageDisplay,	"Object:",				point1,	&cTextFont,	cSideBarTXTcolor);
-	cvPutText(	imageDisplay,	cObjectName,			point2,	&cTextFont,	cSideBarTXTcolor);
+	DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Object:", cObjectName);
 	yLoc	+=	deltaY;
 
 	if (cFrameRate > 0)
 	{
-		point1.y	=	yLoc;
-		point2.y	=	yLoc;
 		sprintf(textBuffer, "%2.1f fps", cFrameRate);
-		cvPutText(	imageDisplay,	"Frame Rate:",			point1,	&cTextFont,	cSideBarTXTcolor);
-		cvPutText(	imageDisplay,	textBuffer,				point2,	&cTextFont,	cSideBarTXTcolor);
+		DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Frame Rate:", textBuffer);
 		yLoc	+=	deltaY;
 	}
 
 	//=======================================
 	//*	total fames saved
-	point1.y	=	yLoc;
-	point2.y	=	yLoc;
 	sprintf(textBuffer, "%d", cTotalFramesSaved);
-	cvPutText(	imageDisplay,	"Frames Saved:",		point1,	&cTextFont,	cSideBarTXTcolor);
-	cvPutText(	imageDisplay,	textBuffer,				point2,	&cTextFont,	cSideBarTXTcolor);
+	DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "Frames Saved:", textBuffer);
 	yLoc	+=	deltaY;
 
+	//*	if there are fewer lines than last time, erase the ones left over at the bottom
+	while ((lineIdx < kSideBar_MaxLines) && (cSideBarText[lineIdx][0] != 0))
+	{
+		DrawSidebarLine(imageDisplay, lineIdx++, cSideFrameWidth, yLoc, lineWidth, "", NULL);
+		yLoc	+=	deltaY;
+	}
+	//*	the histogram is in a fixed place below the longest possible list (8 lines)
+	yLoc	=	cSideFrameWidth + (8 * deltaY);
 
 
 	yLoc	+=	50;
 	//*************************************
 	//*	Histogram
+	//*	if it has not been done for this frame (when the image was saved)
+	//*	it is calculated from the pyramid level that is being displayed
+	if (cHistogramFrame != cFramesRead)
+	{
+		pyramidLevel	=	&cDisplayPyramid[cDisplayPyramidLevel];
+		histImageType	=	-1;
+		if ((cOpenCV_ImagePtr->nChannels == 1) && (cOpenCV_ImagePtr->depth == 8))
+		{
+			histImageType	=	kImageType_MONO8;
+		}
+		else if ((cOpenCV_ImagePtr->nChannels == 1) && (cOpenCV_ImagePtr->depth == 16))
+		{
+			histImageType	=	kImageType_RAW16;
+		}
+		else if ((cOpenCV_ImagePtr->nChannels == 3) && (cOpenCV_ImagePtr->depth == 8))
+		{
+			histImageType	=	kImageType_RGB24;
+		}
+
+		if ((cDisplayPyramidLevel > 0) && (histImageType >= 0))
+		{
+			CalculateHistogramArray(pyramidLevel->pixels, (pyramidLevel->width * pyramidLevel->height), histImageType);
+		}
+		else
+		{
+			CalculateHistogramArray();
+		}
+	}
+
+	//*	only redraw the graph if something in it is different
+	histogramChanged	=	(cSideBarValid == false);
+	if ((memcmp(cSideBarHistogram[0], cHistogramLum, sizeof(cHistogramLum)) != 0) ||
+		(memcmp(cSideBarHistogram[1], cHistogramRed, sizeof(cHistogramRed)) != 0) ||
+		(memcmp(cSideBarHistogram[2], cHistogramGrn, sizeof(cHistogramGrn)) != 0) ||
+		(memcmp(cSideBarHistogram[3], cHistogramBlu, sizeof(cHistogramBlu)) != 0) ||
+		(cSideBarHistMax[0] != cMaxGryValue) ||
+		(cSideBarHistMax[1] != cMaxRedValue) ||
+		(cSideBarHistMax[2] != cMaxGrnValue) ||
+		(cSideBarHistMax[3] != cMaxBluValue))
+	{
+		histogramChanged	=	true;
+	}
+
 	//*	we have to set the ROI
 	roiRect.x		=	cSideFrameWidth / 2;
 	roiRect.y		=	yLoc;
 	roiRect.width	=	cSideBarWidth;
 	roiRect.height	=	100;
-	cvSetImageROI(imageDisplay,  roiRect);
+	if (histogramChanged)
+	{
+		cvSetImageROI(imageDisplay,  roiRect);
 
-	CalculateHistogramArray();
-	CreateHistogramGraph(imageDisplay);
+		CreateHistogramGraph(imageDisplay);
 
-	cvResetImageROI(imageDisplay);
-	//*	put a boarder around it
-	cvRectangleR(	imageDisplay,
-					roiRect,
-					cSideBarTXTcolor,	//	color,
-					1,					//	int thickness CV_DEFAULT(1),
-					8,					//	int line_type CV_DEFAULT(8),
-					0);					//	int shift CV_DEFAULT(0));
+		cvResetImageROI(imageDisplay);
+		//*	put a boarder around it
+		cvRectangleR(	imageDisplay,
+						roiRect,
+						cSideBarTXTcolor,	//	color,
+						1,					//	int thickness CV_DEFAULT(1),
+						8,					//	int line_type CV_DEFAULT(8),
+						0);					//	int shift CV_DEFAULT(0));
+
+		memcpy(cSideBarHistogram[0], cHistogramLum, sizeof(cHistogramLum));
+		memcpy(cSideBarHistogram[1], cHistogramRed, sizeof(cHistogramRed));
+		memcpy(cSideBarHistogram[2], cHistogramGrn, sizeof(cHistogramGrn));
+		memcpy(cSideBarHistogram[3], cHistogramBlu, sizeof(cHistogramBlu));
+		cSideBarHistMax[0]	=	cMaxGryValue;
+		cSideBarHistMax[1]	=	cMaxRedValue;
+		cSideBarHistMax[2]	=	cMaxGrnValue;
+		cSideBarHistMax[3]	=	cMaxBluValue;
+	}
 	yLoc	+=	100;
 	yLoc	+=	5;
 
 	//=============================================================
-	//*	put the alpaca logo in the bottom left corner
-	if (gAlpacaImgPtr != NULL)
+	//*	put the alpaca logo in the bottom left corner, it only has to be done once
+	if ((cSideBarValid == false) && (gAlpacaImgPtr != NULL))
 	{
 		roiRect.x		=	0;
 		roiRect.y		=	imageDisplay->height - gAlpacaImgPtr->height;
@@ -864,6 +1163,7 @@ const int	deltaY	=	16;
 		point1.y	=	roiRect.y - 1;
 		cvPutText(	imageDisplay,	"Compatible with:",		point1,	&cTextFont,	cSideBarTXTcolor);
 	}
+	cSideBarValid	=	true;
 }
 #endif // _USE_OPENCV_CPP_
 
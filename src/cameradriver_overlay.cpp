@@ -23,6 +23,19 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	Sep  6,	2023	<MLS> Created cameradriver_overlay.cpp
+//*	Oct 19,	2026	<MLS> Added cached overlay layer, only the tiles that change are redrawn
+//*	Oct 19,	2026	<MLS> Added overlay command with the per frame overlay cost
+//*****************************************************************************
+//*	The overlay is a black bar across the top of the image with the shutter
+//*	time information. The original version draws the bar and the text onto
+//*	every frame with OpenCV.
+//*	The cached version splits the bar into tiles, one per field. Each tile is
+//*	rendered once into a BGRA layer and converted to the layout of the frame
+//*	(premultiplied color and 1 - alpha for each sample), it is only rendered
+//*	again when its text or the frame format changes. Per frame, only the
+//*	tiles are blended onto the image (ImageKernel_BlendPremult_U8/U16).
+//*	The label and the exposure time are almost never redrawn, the time
+//*	stamps change every frame but they are small.
 //*****************************************************************************
 
 
@@ -33,69 +46,125 @@
 #include	<stdio.h>
 #include	<stdlib.h>
 #include	<string.h>
+#include	<sys/time.h>
 
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
 
 
+#include	"JsonResponse.h"
 #include	"alpacadriver.h"
 #include	"alpacadriver_helper.h"
 #include	"helper_functions.h"
-#include	"opencv_utils.h"
+#include	"image_kernels.h"
+#ifdef _USE_OPENCV_
+	#include	"opencv_utils.h"
+#endif
 
 #include	"cameradriver.h"
 
+#define	kOverlay_BarHeight		20
+#define	kOverlay_TextBaseline	15
+#define	kOverlay_TextLeft		10
+
+//*****************************************************************************
+static uint32_t	ElapsedMicroSecs(const struct timeval *startTime)
+{
+struct timeval	currentTime;
+
+	gettimeofday(&currentTime, NULL);
+	return(((currentTime.tv_sec - startTime->tv_sec) * 1000000L) + (currentTime.tv_usec - startTime->tv_usec));
+}
 
 //*****************************************************************************
 void		CameraDriver::DrawOverlayOntoImage(void)
 {
-char		overlayString[512];
-char		timeString[64];
-double		exposureTimeSecs;
-cv::Scalar	fillColor;
-cv::Scalar	textColor;
+char			segmentList[kOverlay_MaxTiles][128];
+int				segmentCnt;
+char			overlayString[512];
+char			timeString[64];
+double			exposureTimeSecs;
+struct timeval	startTime;
+bool			cachedOK;
+int				iii;
 
 //	CONSOLE_DEBUG(__FUNCTION__);
+	gettimeofday(&startTime, NULL);
 
-	//*	have to shift by 8 because it is a 16 bit image
-	fillColor	=	CV_RGB(0,		0,		0);
-	textColor	=	CV_RGB(255<<8,	255<<8,	255<<8);
-
-	overlayString[0]	=	0;
+	//*	each segment is a tile in the cached version
+	segmentCnt	=	0;
 	switch(cOverlayMode)
 	{
 		case 1:
-			strcpy(overlayString, "ShutterStart:");
+			strcpy(segmentList[segmentCnt++], "ShutterStart:");
 			if (cGPS.Present)
 			{
-				strcat(overlayString, " GPS=");
-				strcat(overlayString, cGPS.ShutterStartTimeStr);
+				snprintf(segmentList[segmentCnt++], 128, " GPS=%s", cGPS.ShutterStartTimeStr);
 			}
 			FormatTimeStringISO8601(&cCameraProp.Lastexposure_StartTime, timeString);
-			strcat(overlayString, " SYS=");
-			strcat(overlayString, timeString);
+			snprintf(segmentList[segmentCnt++], 128, " SYS=%s", timeString);
 
 			//*	compute the exposure time in seconds
 			exposureTimeSecs	=	(cCameraProp.Lastexposure_duration_us * 1.0) / 1000000.0;
 
-			sprintf(timeString, " EXP=%3.6f (seconds)", exposureTimeSecs);
-			strcat(overlayString, timeString);
+			snprintf(segmentList[segmentCnt++], 128, " EXP=%3.6f (seconds)", exposureTimeSecs);
 			break;
 
 		default:
-			strcpy(overlayString, "Somethings wrong");
+			strcpy(segmentList[segmentCnt++], "Somethings wrong");
 			break;
 	}
-//	CONSOLE_DEBUG_W_STR("overlayString\t=", overlayString);
 
-#if defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4)
+	cachedOK	=	false;
+	if (cOverlayCacheEnabled)
+	{
+		cachedOK	=	Overlay_DrawCached(segmentList, segmentCnt);
+	}
+	if (cachedOK == false)
+	{
+		overlayString[0]	=	0;
+		for (iii=0; iii<segmentCnt; iii++)
+		{
+			strcat(overlayString, segmentList[iii]);
+		}
+//		CONSOLE_DEBUG_W_STR("overlayString\t=", overlayString);
+		Overlay_DrawDirect(overlayString);
+	}
+
+	//*	running average over about 16 frames
+	cOverlayLast_us	=	ElapsedMicroSecs(&startTime);
+	if (cachedOK)
+	{
+		cOverlayCachedAvg_us	=	(cOverlayCachedAvg_us == 0) ? cOverlayLast_us :
+									((cOverlayCachedAvg_us * 15) + cOverlayLast_us) / 16;
+	}
+	else
+	{
+		cOverlayDirectAvg_us	=	(cOverlayDirectAvg_us == 0) ? cOverlayLast_us :
+									((cOverlayDirectAvg_us * 15) + cOverlayLast_us) / 16;
+	}
+}
+
+//*****************************************************************************
+//*	the original overlay, the bar and the text are drawn onto the frame every time
+//*****************************************************************************
+void	CameraDriver::Overlay_DrawDirect(const char *overlayString)
+{
+#if defined(_USE_OPENCV_) && (defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4))
+cv::Scalar	fillColor;
+cv::Scalar	textColor;
+
+	//*	have to shift by 8 because it is a 16 bit image
+	fillColor	=	CV_RGB(0,		0,		0);
+	textColor	=	CV_RGB(255<<8,	255<<8,	255<<8);
+
 	if (cOpenCV_ImagePtr != NULL)
 	{
-		LLG_FillRect(cOpenCV_ImagePtr, 0, 0, cCameraProp.CameraXsize, 20, fillColor);
+		LLG_FillRect(cOpenCV_ImagePtr, 0, 0, cCameraProp.CameraXsize, kOverlay_BarHeight, fillColor);
 
 		LLG_DrawCString(	cOpenCV_ImagePtr,
-							10,
-							15,
+							kOverlay_TextLeft,
+							kOverlay_TextBaseline,
 							overlayString,
 							1,
 							textColor);
@@ -105,9 +174,357 @@ cv::Scalar	textColor;
 	{
 		CONSOLE_DEBUG("cOpenCV_ImagePtr is NULL");
 	}
-#else
+#elif defined(_USE_OPENCV_)
 	#warning "OpenCV drawing primitves only implemented in C++ version of alpacaPi"
 #endif // defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4)
 }
 
+#if defined(_USE_OPENCV_) && (defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4))
+//*****************************************************************************
+//*	renders the tile into BGRA, then converts it to the layout of the frame
+//*****************************************************************************
+bool	CameraDriver::Overlay_RenderTile(TYPE_OVERLAY_TILE *tile, const char *text, const int textX)
+{
+int				channels;
+int				bytesPerSample;
+int				sampleCnt;
+size_t			bufSize;
+void			*newColorBuf;
+void			*newAlphaBuf;
+const uint8_t	*bgraPtr;
+uint8_t			*color8Ptr;
+uint8_t			*alpha8Ptr;
+uint16_t		*color16Ptr;
+uint16_t		*alpha16Ptr;
+uint32_t		alpha;
+uint32_t		premultValue;
+int				xxx;
+int				yyy;
+int				ccc;
+uint8_t			grayValue;
+
+	channels		=	cOpenCV_ImagePtr->channels();
+	bytesPerSample	=	(cOpenCV_ImagePtr->depth() == CV_16U) ? 2 : 1;
+	sampleCnt		=	tile->width * tile->height * channels;
+	bufSize			=	sampleCnt * bytesPerSample;
+	if (bufSize > tile->bufSize)
+	{
+		newColorBuf	=	realloc(tile->colorBuf, bufSize);
+		if (newColorBuf != NULL)
+		{
+			tile->colorBuf	=	newColorBuf;
+		}
+		newAlphaBuf	=	realloc(tile->invAlphaBuf, bufSize);
+		if (newAlphaBuf != NULL)
+		{
+			tile->invAlphaBuf	=	newAlphaBuf;
+		}
+		if ((newColorBuf == NULL) || (newAlphaBuf == NULL))
+		{
+			tile->bufSize	=	0;
+			return(false);
+		}
+		tile->bufSize	=	bufSize;
+	}
+
+	//*	opaque black with white text, same as the original
+	cv::Mat	layerImage(tile->height, tile->width, CV_8UC4, cv::Scalar(0, 0, 0, 255));
+	if (text[0] != 0)
+	{
+		cv::putText(	layerImage,
+						text,
+						cv::Point(textX, kOverlay_TextBaseline),
+						cv::FONT_HERSHEY_SIMPLEX,
+						1.0,
+						cv::Scalar(255, 255, 255, 255),
+						1);
+	}
+
+	color8Ptr	=	(uint8_t *)tile->colorBuf;
+	alpha8Ptr	=	(uint8_t *)tile->invAlphaBuf;
+	color16Ptr	=	(uint16_t *)tile->colorBuf;
+	alpha16Ptr	=	(uint16_t *)tile->invAlphaBuf;
+	for (yyy=0; yyy<tile->height; yyy++)
+	{
+		bgraPtr	=	layerImage.ptr<uint8_t>(yyy);
+		for (xxx=0; xxx<tile->width; xxx++)
+		{
+			alpha		=	bgraPtr[3];
+			grayValue	=	((bgraPtr[2] * 77) + (bgraPtr[1] * 150) + (bgraPtr[0] * 29)) >> 8;
+			for (ccc=0; ccc<channels; ccc++)
+			{
+				if (channels == 1)
+				{
+					premultValue	=	((grayValue * alpha) + 127) / 255;
+				}
+				else
+				{
+					//*	a 4th channel in the frame gets the alpha
+					premultValue	=	(((ccc < 3) ? bgraPtr[ccc] : 255) * alpha + 127) / 255;
+				}
+				if (bytesPerSample == 2)
+				{
+					*color16Ptr++	=	premultValue * 257;
+					*alpha16Ptr++	=	(255 - alpha) * 257;
+				}
+				else
+				{
+					*color8Ptr++	=	premultValue;
+					*alpha8Ptr++	=	255 - alpha;
+				}
+			}
+			bgraPtr	+=	4;
+		}
+	}
+	strncpy(tile->text, text, (sizeof(tile->text) - 1));
+	tile->text[sizeof(tile->text) - 1]	=	0;
+	tile->frameType	=	cOpenCV_ImagePtr->type();
+	cOverlayTileRenders++;
+	return(true);
+}
+#endif // _USE_OPENCV_
+
+//*****************************************************************************
+//*	returns false if the frame can not be done with the cache,
+//*	the caller then uses the original drawing
+//*****************************************************************************
+bool	CameraDriver::Overlay_DrawCached(const char segmentList[][128], const int segmentCnt)
+{
+bool				cachedOK	=	false;
+#if defined(_USE_OPENCV_) && (defined(_USE_OPENCV_CPP_) || (CV_MAJOR_VERSION >= 4))
+TYPE_OVERLAY_TILE	*tile;
+const char			*tileText;
+cv::Size			textSize;
+int					baseLine;
+int					tileCnt;
+int					textX;
+int					tileLeft;
+int					tileWidth;
+int					imageWidth;
+int					barHeight;
+int					channels;
+int					yyy;
+int					iii;
+
+	if ((cOpenCV_ImagePtr == NULL) || (cOpenCV_ImagePtr->data == NULL))
+	{
+		return(false);
+	}
+	channels	=	cOpenCV_ImagePtr->channels();
+	if (((cOpenCV_ImagePtr->depth() != CV_8U) && (cOpenCV_ImagePtr->depth() != CV_16U)) ||
+		(channels < 1) || (channels > 4))
+	{
+		return(false);
+	}
+	imageWidth	=	cOpenCV_ImagePtr->cols;
+	barHeight	=	kOverlay_BarHeight;
+	if (barHeight > cOpenCV_ImagePtr->rows)
+	{
+		barHeight	=	cOpenCV_ImagePtr->rows;
+	}
+
+	//*	one tile per segment and one to fill the rest of the bar
+	tileCnt		=	segmentCnt + 1;
+	if (tileCnt > kOverlay_MaxTiles)
+	{
+		tileCnt	=	kOverlay_MaxTiles;
+	}
+	tileLeft	=	0;
+	cachedOK	=	true;
+	for (iii=0; iii<tileCnt; iii++)
+	{
+		tile	=	&cOverlayTiles[iii];
+		if (iii < (tileCnt - 1))
+		{
+			tileText	=	segmentList[iii];
+			textX		=	(iii == 0) ? kOverlay_TextLeft : 0;
+			textSize	=	cv::getTextSize(tileText, cv::FONT_HERSHEY_SIMPLEX, 1.0, 1, &baseLine);
+			tileWidth	=	textX + textSize.width;
+		}
+		else
+		{
+			tileText	=	"";
+			textX		=	0;
+			tileWidth	=	imageWidth - tileLeft;
+		}
+		if ((tileLeft + tileWidth) > imageWidth)
+		{
+			tileWidth	=	imageWidth - tileLeft;
+		}
+		if (tileWidth <= 0)
+		{
+			tile->width	=	0;
+			continue;
+		}
+
+		//*	only render the tile again if something about it changed
+		if ((tile->left != tileLeft) || (tile->top != 0) ||
+			(tile->width != tileWidth) || (tile->height != barHeight) ||
+			(tile->frameType != cOpenCV_ImagePtr->type()) ||
+			(tile->bufSize == 0) ||
+			(strcmp(tile->text, tileText) != 0))
+		{
+			tile->left		=	tileLeft;
+			tile->top		=	0;
+			tile->width		=	tileWidth;
+			tile->height	=	barHeight;
+			if (Overlay_RenderTile(tile, tileText, textX) == false)
+			{
+				tile->bufSize	=	0;
+				cachedOK		=	false;
+				break;
+			}
+		}
+
+		//*	blend it, one row at a time
+		for (yyy=0; yyy<tile->height; yyy++)
+		{
+			if (cOpenCV_ImagePtr->depth() == CV_16U)
+			{
+				ImageKernel_BlendPremult_U16(	cOpenCV_ImagePtr->ptr<uint16_t>(tile->top + yyy) + (tile->left * channels),
+												(uint16_t *)tile->colorBuf + (yyy * tile->width * channels),
+												(uint16_t *)tile->invAlphaBuf + (yyy * tile->width * channels),
+												tile->width * channels);
+			}
+			else
+			{
+				ImageKernel_BlendPremult_U8(	cOpenCV_ImagePtr->ptr<uint8_t>(tile->top + yyy) + (tile->left * channels),
+												(uint8_t *)tile->colorBuf + (yyy * tile->width * channels),
+												(uint8_t *)tile->invAlphaBuf + (yyy * tile->width * channels),
+												tile->width * channels);
+			}
+		}
+		tileLeft	+=	tileWidth;
+	}
+#endif // _USE_OPENCV_
+	return(cachedOK);
+}
+
+//*****************************************************************************
+void	CameraDriver::Overlay_FreeTiles(void)
+{
+int		iii;
+
+	for (iii=0; iii<kOverlay_MaxTiles; iii++)
+	{
+		if (cOverlayTiles[iii].colorBuf != NULL)
+		{
+			free(cOverlayTiles[iii].colorBuf);
+		}
+		if (cOverlayTiles[iii].invAlphaBuf != NULL)
+		{
+			free(cOverlayTiles[iii].invAlphaBuf);
+		}
+	}
+	memset(cOverlayTiles, 0, sizeof(cOverlayTiles));
+}
+
+//*****************************************************************************
+void	CameraDriver::Overlay_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	Get_Overlay(reqData, NULL, "overlay");
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_Overlay(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cOverlayMode,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"overlaycache",
+									cOverlayCacheEnabled,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"overlay_us",
+									cOverlayLast_us,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"overlaydirect_us",
+									cOverlayDirectAvg_us,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"overlaycached_us",
+									cOverlayCachedAvg_us,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"overlaytilerenders",
+									cOverlayTileRenders,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	overlay=INT			0 = off, 1 = shutter time
+//*	cache=BOOL			(optional) false = draw the whole overlay on every frame
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_Overlay(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				optionFound;
+int					argValue;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	optionFound	=	false;
+	if (GetKeyWordArgument(reqData->contentData, "Overlay", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		argValue	=	atoi(argumentString);
+		if ((argValue >= 0) && (argValue <= 1))
+		{
+			cOverlayMode	=	argValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Overlay must be 0 or 1");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Cache", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound				=	true;
+		cOverlayCacheEnabled	=	IsTrueFalse(argumentString);
+		//*	start the comparison over
+		cOverlayDirectAvg_us	=	0;
+		cOverlayCachedAvg_us	=	0;
+		if (cOverlayCacheEnabled == false)
+		{
+			Overlay_FreeTiles();
+		}
+	}
+
+	if (optionFound == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'overlay' not found");
+	}
+	return(alpacaErrCode);
+}
+
 #endif //	_ENABLE_CAMERA_
@@ -0,0 +1,413 @@
+//**************************************************************************
+//*	Name:			cameradriver_platesolve.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Plate solving of each frame
+//*
+//*					The stars found by star analysis are passed to PlateSolve_SolveImage()
+//*					(plate_solve.c) which matches them against the SkyTravel star catalogs.
+//*					The pixel scale comes from the telescope info (focal length) and the
+//*					pixel size unless it is set with the "scale" argument.
+//*					The results are reported in readall and the WCS is written to the FITS header
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_platesolve.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"star_analysis.h"
+#include	"plate_solve.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+
+//*****************************************************************************
+//*	called from the state machine after star analysis
+//*****************************************************************************
+bool	CameraDriver::PlateSolve_ProcessFrame(void)
+{
+TYPE_PLATESOLVE_REQUEST	solveRequest;
+TYPE_PLATESOLVE_STAR	*solveStars;
+int						iii;
+bool					solvedOK;
+
+	cPlateSolveResult.solved	=	false;
+	if ((cStarResults == NULL) || (cStarResults->valid == false))
+	{
+		strcpy(cPlateSolveResult.errorMsg, "No star data");
+		return(false);
+	}
+	solveStars	=	(TYPE_PLATESOLVE_STAR *)malloc((cStarResults->starCount + 1) * sizeof(TYPE_PLATESOLVE_STAR));
+	if (solveStars == NULL)
+	{
+		strcpy(cPlateSolveResult.errorMsg, "Out of memory");
+		return(false);
+	}
+	for (iii=0; iii<cStarResults->starCount; iii++)
+	{
+		solveStars[iii].xPixel	=	cStarResults->starList[iii].xCenter;
+		solveStars[iii].yPixel	=	cStarResults->starList[iii].yCenter;
+		solveStars[iii].flux	=	cStarResults->starList[iii].flux;
+	}
+
+	memset(&solveRequest, 0, sizeof(TYPE_PLATESOLVE_REQUEST));
+	solveRequest.starList			=	solveStars;
+	solveRequest.starCount			=	cStarResults->starCount;
+	solveRequest.imageWidth			=	cLastExposure_ROIinfo.currentROIwidth;
+	solveRequest.imageHeight		=	cLastExposure_ROIinfo.currentROIheight;
+	solveRequest.pixelScale_arcsec	=	cPlateSolveScale_arcsec;
+	if (solveRequest.pixelScale_arcsec <= 0.0)
+	{
+		solveRequest.pixelScale_arcsec	=	StarAnalysis_GetPixelScale();
+	}
+
+	solvedOK	=	PlateSolve_SolveImage(&solveRequest, &cPlateSolveResult);
+	free(solveStars);
+	if (gVerbose)
+	{
+		if (solvedOK)
+		{
+			CONSOLE_DEBUG_W_DBL("Solved RA \t=", cPlateSolveResult.ra_deg);
+			CONSOLE_DEBUG_W_DBL("Solved DEC\t=", cPlateSolveResult.dec_deg);
+			CONSOLE_DEBUG_W_NUM("Solve ms  \t=", cPlateSolveResult.solveTime_ms);
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_STR("Plate solve failed:", cPlateSolveResult.errorMsg);
+		}
+	}
+	return(solvedOK);
+}
+
+//*****************************************************************************
+void	CameraDriver::PlateSolve_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+bool	solved;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolve",
+									cPlateSolveEnabled,
+									INCLUDE_COMMA);
+
+	solved	=	cPlateSolveEnabled && cPlateSolveResult.solved;
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolved",
+									solved,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolvera",
+									(solved ? cPlateSolveResult.ra_deg : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolvedec",
+									(solved ? cPlateSolveResult.dec_deg : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolverotation",
+									(solved ? cPlateSolveResult.rotation_deg : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"platesolvescale",
+									(solved ? cPlateSolveResult.pixelScale_arcsec : 0.0),
+									INCLUDE_COMMA);
+}
+
+#ifdef _ENABLE_FITS_
+//*****************************************************************************
+//*	FITS WCS, TAN projection with a CD matrix
+//*****************************************************************************
+void	CameraDriver::PlateSolve_WriteFITS(fitsfile *fitsFilePtr)
+{
+int		fitsStatus;
+double	fitsValue;
+
+	if ((cPlateSolveEnabled == false) || (cPlateSolveResult.solved == false))
+	{
+		return;
+	}
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"CTYPE1",
+											(void *)"RA---TAN",
+											"Gnomonic projection", &fitsStatus);
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"CTYPE2",
+											(void *)"DEC--TAN",
+											"Gnomonic projection", &fitsStatus);
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"CUNIT1",
+											(void *)"deg",
+											NULL, &fitsStatus);
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"CUNIT2",
+											(void *)"deg",
+											NULL, &fitsStatus);
+	fitsValue	=	2000.0;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"EQUINOX",
+											&fitsValue,
+											"Equinox of the WCS", &fitsStatus);
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"RADESYS",
+											(void *)"ICRS",
+											NULL, &fitsStatus);
+
+	fitsValue	=	cPlateSolveResult.ra_deg;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CRVAL1",
+											&fitsValue,
+											"RA of the reference pixel (deg)", &fitsStatus);
+	fitsValue	=	cPlateSolveResult.dec_deg;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CRVAL2",
+											&fitsValue,
+											"DEC of the reference pixel (deg)", &fitsStatus);
+	fitsValue	=	cPlateSolveResult.crpix1;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CRPIX1",
+											&fitsValue,
+											"Reference pixel X", &fitsStatus);
+	fitsValue	=	cPlateSolveResult.crpix2;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CRPIX2",
+											&fitsValue,
+											"Reference pixel Y", &fitsStatus);
+
+	fitsValue	=	cPlateSolveResult.cd1_1;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CD1_1",
+											&fitsValue,
+											"Transformation matrix (deg/pixel)", &fitsStatus);
+	fitsValue	=	cPlateSolveResult.cd1_2;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CD1_2",
+											&fitsValue,
+											NULL, &fitsStatus);
+	fitsValue	=	cPlateSolveResult.cd2_1;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CD2_1",
+											&fitsValue,
+											NULL, &fitsStatus);
+	fitsValue	=	cPlateSolveResult.cd2_2;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"CD2_2",
+											&fitsValue,
+											NULL, &fitsStatus);
+
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TINT,		"PLTSTARS",
+											&cPlateSolveResult.matchCount,
+											"Stars matched by the plate solve", &fitsStatus);
+	fitsValue	=	cPlateSolveResult.rmsError_arcsec;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TDOUBLE,	"PLTRMS",
+											&fitsValue,
+											"Plate solve RMS error (arcsec)", &fitsStatus);
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TSTRING,	"PLTCAT",
+											cPlateSolveResult.catalogName,
+											"Plate solve catalog", &fitsStatus);
+}
+#endif // _ENABLE_FITS_
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_PlateSolve(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cPlateSolveEnabled,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"solved",
+									cPlateSolveResult.solved,
+									INCLUDE_COMMA);
+
+	if (cPlateSolveResult.solved)
+	{
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"ra",
+										cPlateSolveResult.ra_deg,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"dec",
+										cPlateSolveResult.dec_deg,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"rotation",
+										cPlateSolveResult.rotation_deg,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"scale",
+										cPlateSolveResult.pixelScale_arcsec,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"mirrored",
+										cPlateSolveResult.mirrored,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"matchcount",
+										cPlateSolveResult.matchCount,
+										INCLUDE_COMMA);
+
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"rmserror",
+										cPlateSolveResult.rmsError_arcsec,
+										INCLUDE_COMMA);
+	}
+	else
+	{
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										"error",
+										cPlateSolveResult.errorMsg,
+										INCLUDE_COMMA);
+	}
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"catalog",
+									cPlateSolveResult.catalogName,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"solvetime_ms",
+									cPlateSolveResult.solveTime_ms,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	platesolve=BOOL
+//*	scale=FLOAT	(optional) arc seconds per pixel, 0 = from the telescope info
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_PlateSolve(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+bool				scaleFound;
+double				newScale;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		scaleFound		=	GetKeyWordArgument(	reqData->contentData,
+												"Scale",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (scaleFound)
+		{
+			newScale	=	atof(argumentString);
+			if ((newScale >= 0.0) && (newScale <= 600.0))
+			{
+				cPlateSolveScale_arcsec	=	newScale;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Scale must be between 0 and 600 arcsec/pixel");
+			}
+		}
+
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"PlateSolve",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			cPlateSolveEnabled	=	IsTrueFalse(argumentString);
+			if (cPlateSolveEnabled && (cPlateSolveScale_arcsec <= 0.0) && (StarAnalysis_GetPixelScale() <= 0.0))
+			{
+				cPlateSolveEnabled	=	false;
+				alpacaErrCode		=	kASCOM_Err_InvalidOperation;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Pixel scale unknown, set the focal length or 'scale'");
+			}
+		}
+		else if (scaleFound == false)
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'platesolve' not found");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
@@ -29,48 +29,32 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	Apr  3,	2020	<MLS> Created cameradriver_png.cpp
+//*	Oct 19,	2026	<MLS> SaveUsingPNGlib() finished, uses the multithreaded encoder (image_encode.c)
+//*	Oct 19,	2026	<MLS> _ENABLE_PNGLIB_ now needs zlib (-lz) instead of libpng
 //*****************************************************************************
-//*	Jan 31,	2120	<TODO> Add support for libpng
-//*****************************************************************************
-
-//#define	_ENABLE_PNGLIB_
 
 #ifdef _ENABLE_PNGLIB_
 
 #include	<stdio.h>
 #include	<string.h>
 
-
-#include	<png.h>
-
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
 
+#include	"helper_functions.h"
+#include	"image_encode.h"
 #include	"cameradriver.h"
 
 //**************************************************************************************
-void abort_(const char *errorString)
-{
-	fprintf(stderr, "%s\n", errorString);
-	fflush(stderr);
-	CONSOLE_ABORT(__FUNCTION__);
-}
-
-
+//*	used when there is no OpenCV, the PNG is made from the raw camera data
 //**************************************************************************************
 void	CameraDriver::SaveUsingPNGlib(void)
 {
-char			imageFileName[64];
-char			imageFilePath[128];
-FILE			*outputFileP;
-png_structp		png_ptr;
-png_infop		info_ptr;
-png_colorp		palette;
-png_byte		color_type;
-png_byte		bit_depth;
-png_bytep		*row_pointers;
-int				number_of_passes;
-int				yyy;
+TYPE_ENCODE_IMAGE	encodeImage;
+TYPE_ENCODE_OPTIONS	encodeOptions;
+uint32_t			startMilliSecs;
+char				imageFileName[64];
+char				imageFilePath[128];
 
 //	CONSOLE_DEBUG(__FUNCTION__);
 
@@ -81,73 +65,18 @@ int				yyy;
 	strcat(imageFilePath, "/");
 	strcat(imageFilePath, imageFileName);
 
-
-	outputFileP	=	fopen(imageFilePath, "wb");
-	if (outputFileP != NULL)
+	ImageEncode_SetupRawImage(&encodeImage);
+	encodeOptions	=	cImageEncodeOptions;
+	if (cImageEncodeFast == false)
 	{
-		//*	code from http://zarb.org/~gc/html/libpng.html
-		//*	initialize stuff
-		png_ptr	=	png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-
-		if (png_ptr != NULL)
-		{
-			info_ptr	=	png_create_info_struct(png_ptr);
-			if (!info_ptr)
-					abort_("[write_png_file] png_create_info_struct failed");
-
-			if (setjmp(png_jmpbuf(png_ptr)))
-					abort_("[write_png_file] Error during init_io");
-
-			png_init_io(png_ptr, outputFileP);
-
-
-			//*	write header
-			if (setjmp(png_jmpbuf(png_ptr)))
-					abort_("[write_png_file] Error during writing header");
-
-			png_set_IHDR(	png_ptr,
-							info_ptr,
-							cCameraXsize,
-							cCameraYsize,
-							bit_depth,
-							color_type,
-							PNG_INTERLACE_NONE,
-							PNG_COMPRESSION_TYPE_BASE,
-							PNG_FILTER_TYPE_BASE);
-
-			png_write_info(png_ptr, info_ptr);
-
-
-			//*	write bytes
-			if (setjmp(png_jmpbuf(png_ptr)))
-					abort_("[write_png_file] Error during writing bytes");
-
-			png_write_image(png_ptr, row_pointers);
-
-
-			//*	end write
-			if (setjmp(png_jmpbuf(png_ptr)))
-					abort_("[write_png_file] Error during end of write");
-
-			png_write_end(png_ptr, NULL);
-
-			//*	cleanup heap allocation
-			for (yyy=0; yyy<cCameraYsize; yyy++)
-			{
-				free(row_pointers[yyy]);
-			}
-			free(row_pointers);
-
-		}
-		else
-		{
-			abort_("[write_png_file] png_create_write_struct failed");
-		}
-//-------------------------------------------------------------
-		fclose(outputFileP);
-
-		AddToDataProductsList(imageFileName, "PNG image-libpng");
+		encodeOptions.stripCount	=	1;
+	}
 
+	startMilliSecs	=	millis();
+	if (ImageEncode_SavePNG(&encodeImage, &encodeOptions, imageFilePath))
+	{
+		cPngEncode_ms	=	millis() - startMilliSecs;
+		AddToDataProductsList(imageFileName, "PNG image-zlib");
 	}
 	else
 	{
@@ -0,0 +1,683 @@
+//**************************************************************************
+//*	Name:			cameradriver_preview.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Server side preview of the current frame
+//*
+//*					/api/v1/camera/0/preview?maxwidth=800&stretch=auto&format=jpeg
+//*
+//*					Clients that only want to look at the frame no longer have to
+//*					download the full imagearray and stretch it themselves.
+//*					The frame is reduced by box filter passes (image_kernels.c BinRow,
+//*					factors of 2, 3 and 4) until it is no wider than maxwidth, then
+//*					stretched to 8 bits through a lookup table made from the histogram
+//*					of the small image and sent as JPEG, PNG or raw bytes.
+//*
+//*					stretch=auto	screen transfer function, the background goes to 25% gray
+//*					stretch=linear	0.1% to 99.9% of the histogram
+//*					stretch=none	16 bit data is shifted down to 8 bits
+//*
+//*					The complete HTTP response is kept, asking again for the same frame
+//*					with the same arguments just sends it again.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_preview.cpp
+//*	Oct 19,	2026	<MLS> Split out Preview_Reduce() & Preview_Stretch(), the MJPEG stream uses them
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<strings.h>
+#include	<unistd.h>
+#include	<math.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+#include	"image_encode.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+#define	kPreview_DefaultMaxWidth	800
+#define	kPreview_MinWidth			16
+#define	kPreview_DefaultQuality		80
+#define	kPreview_MaxPasses			16
+#define	kPreview_TargetBackground	0.25	//*	where the auto stretch puts the median
+#define	kPreview_ShadowsClip		-2.8	//*	in normalized MADs from the median
+#define	kPreview_LinearLowPct		0.1
+#define	kPreview_LinearHighPct		99.9
+
+//*****************************************************************************
+typedef struct	//	TYPE_PREVIEW_BAND
+{
+	const uint8_t	*srcPtr;
+	uint8_t			*dstPtr;
+	long			srcRowBytes;
+	long			dstRowBytes;
+	int				srcRowValues;
+	int				dstWidth;
+	int				channels;
+	int				bytesPerValue;
+	int				binFactor;
+} TYPE_PREVIEW_BAND;
+
+//*****************************************************************************
+static void	Preview_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_PREVIEW_BAND	*band;
+const uint8_t		*srcRow;
+uint8_t				*dstRow;
+int					yyy;
+
+	band	=	(TYPE_PREVIEW_BAND *)context;
+	for (yyy=firstRow; yyy<lastRow; yyy++)
+	{
+		srcRow	=	band->srcPtr + ((long)yyy * band->binFactor * band->srcRowBytes);
+		dstRow	=	band->dstPtr + ((long)yyy * band->dstRowBytes);
+		if (band->bytesPerValue == 2)
+		{
+			ImageKernel_BinRow_U16(	(uint16_t *)dstRow,
+									(const uint16_t *)srcRow,
+									band->srcRowValues,
+									band->dstWidth,
+									band->channels,
+									band->binFactor,
+									kBinMode_Average);
+		}
+		else
+		{
+			ImageKernel_BinRow_U8(	dstRow,
+									srcRow,
+									band->srcRowValues,
+									band->dstWidth,
+									band->channels,
+									band->binFactor,
+									kBinMode_Average);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	the smallest reduction >= the one needed that can be done with 4x, 3x and 2x passes,
+//*	largest first so the full size frame is only read once by the biggest step
+//*****************************************************************************
+static int	Preview_GetPasses(const int width, const int maxWidth, int *passList)
+{
+int		reduction;
+int		remaining;
+int		passCnt;
+
+	reduction	=	(width + maxWidth - 1) / maxWidth;
+	while (true)
+	{
+		remaining	=	reduction;
+		while ((remaining % 2) == 0)
+		{
+			remaining	/=	2;
+		}
+		while ((remaining % 3) == 0)
+		{
+			remaining	/=	3;
+		}
+		if (remaining == 1)
+		{
+			break;
+		}
+		reduction++;
+	}
+	passCnt	=	0;
+	while (((reduction % 4) == 0) && (passCnt < kPreview_MaxPasses))
+	{
+		passList[passCnt++]	=	4;
+		reduction			/=	4;
+	}
+	while (((reduction % 3) == 0) && (passCnt < kPreview_MaxPasses))
+	{
+		passList[passCnt++]	=	3;
+		reduction			/=	3;
+	}
+	if ((reduction == 2) && (passCnt < kPreview_MaxPasses))
+	{
+		passList[passCnt++]	=	2;
+	}
+	return(passCnt);
+}
+
+//*****************************************************************************
+static int	Preview_HistogramPercentile(const uint32_t *histogram, const int histSize, const long total, const double percent)
+{
+long	target;
+long	runningCnt;
+int		ii;
+
+	target		=	(long)((total * percent) / 100.0);
+	runningCnt	=	0;
+	for (ii=0; ii<histSize; ii++)
+	{
+		runningCnt	+=	histogram[ii];
+		if (runningCnt > target)
+		{
+			return(ii);
+		}
+	}
+	return(histSize - 1);
+}
+
+//*****************************************************************************
+//*	midtones transfer function, MTF(m, m) = 0.5
+//*****************************************************************************
+static double	Preview_MTF(const double midTones, const double xValue)
+{
+	if (xValue <= 0.0)
+	{
+		return(0.0);
+	}
+	if (xValue >= 1.0)
+	{
+		return(1.0);
+	}
+	return(((midTones - 1.0) * xValue) / ((((2.0 * midTones) - 1.0) * xValue) - midTones));
+}
+
+//*****************************************************************************
+//*	fills the lookup table from the histogram of the reduced image
+//*****************************************************************************
+static void	Preview_BuildLUT(	uint8_t			*lutPtr,
+								const uint32_t	*histogram,
+								const int		histSize,
+								const int		stretchMode)
+{
+uint32_t	*devHistogram;
+long		total;
+int			blackPoint;
+int			whitePoint;
+int			median;
+int			madValue;
+double		shadows;
+double		midTones;
+double		xValue;
+int			ii;
+
+	total		=	0;
+	whitePoint	=	0;
+	for (ii=0; ii<histSize; ii++)
+	{
+		total	+=	histogram[ii];
+		if (histogram[ii] > 0)
+		{
+			whitePoint	=	ii;
+		}
+	}
+
+	if ((stretchMode == kPreviewStretch_None) || (total == 0))
+	{
+		for (ii=0; ii<histSize; ii++)
+		{
+			lutPtr[ii]	=	(histSize > 256) ? (ii >> 8) : ii;
+		}
+		return;
+	}
+
+	midTones	=	0.5;		//*	straight line
+	if (stretchMode == kPreviewStretch_Auto)
+	{
+		median			=	Preview_HistogramPercentile(histogram, histSize, total, 50.0);
+		devHistogram	=	(uint32_t *)calloc(histSize, sizeof(uint32_t));
+		madValue		=	0;
+		if (devHistogram != NULL)
+		{
+			for (ii=0; ii<histSize; ii++)
+			{
+				devHistogram[abs(ii - median)]	+=	histogram[ii];
+			}
+			madValue	=	Preview_HistogramPercentile(devHistogram, histSize, total, 50.0);
+			free(devHistogram);
+		}
+		shadows		=	median + (kPreview_ShadowsClip * 1.4826 * madValue);
+		blackPoint	=	(shadows > 0.0) ? (int)shadows : 0;
+		if ((median > blackPoint) && (whitePoint > median))
+		{
+			midTones	=	Preview_MTF(kPreview_TargetBackground,
+										(double)(median - blackPoint) / (whitePoint - blackPoint));
+		}
+	}
+	else
+	{
+		blackPoint	=	Preview_HistogramPercentile(histogram, histSize, total, kPreview_LinearLowPct);
+		whitePoint	=	Preview_HistogramPercentile(histogram, histSize, total, kPreview_LinearHighPct);
+	}
+	if (whitePoint <= blackPoint)
+	{
+		whitePoint	=	blackPoint + 1;
+	}
+
+	for (ii=0; ii<histSize; ii++)
+	{
+		xValue		=	(double)(ii - blackPoint) / (whitePoint - blackPoint);
+		lutPtr[ii]	=	(uint8_t)((255.0 * Preview_MTF(midTones, xValue)) + 0.5);
+	}
+}
+
+//*****************************************************************************
+//*	scratch buffers for the reduction passes, kept from one call to the next
+//*****************************************************************************
+static uint8_t	*Preview_GetScratch(uint8_t **scratchBuf, size_t *scratchSize, const int bufIdx, const size_t bufSize)
+{
+	if ((scratchBuf[bufIdx] == NULL) || (scratchSize[bufIdx] < bufSize))
+	{
+		free(scratchBuf[bufIdx]);
+		scratchBuf[bufIdx]	=	(uint8_t *)malloc(bufSize);
+		scratchSize[bufIdx]	=	(scratchBuf[bufIdx] != NULL) ? bufSize : 0;
+	}
+	return(scratchBuf[bufIdx]);
+}
+
+//*****************************************************************************
+//*	reduces the image until it is no wider than maxWidth, width and height are updated.
+//*	Returns the reduced image (in one of the 2 scratch buffers), srcPixels if it
+//*	did not need reducing, NULL if a buffer could not be allocated
+//*****************************************************************************
+const uint8_t	*Preview_Reduce(const uint8_t	*srcPixels,
+								int				*width,
+								int				*height,
+								const int		channels,
+								const int		bytesPerValue,
+								const int		maxWidth,
+								uint8_t			**scratchBuf,
+								size_t			*scratchSize)
+{
+TYPE_PREVIEW_BAND	bandInfo;
+uint8_t				*dstPixels;
+int					passList[kPreview_MaxPasses];
+int					passCnt;
+int					iii;
+
+	memset(&bandInfo, 0, sizeof(TYPE_PREVIEW_BAND));
+	bandInfo.channels		=	channels;
+	bandInfo.bytesPerValue	=	bytesPerValue;
+	passCnt					=	0;
+	if (*width > maxWidth)
+	{
+		passCnt	=	Preview_GetPasses(*width, maxWidth, passList);
+	}
+	for (iii=0; iii<passCnt; iii++)
+	{
+		bandInfo.binFactor		=	passList[iii];
+		bandInfo.srcRowValues	=	*width * channels;
+		bandInfo.srcRowBytes	=	(long)bandInfo.srcRowValues * bytesPerValue;
+		*width					=	*width / bandInfo.binFactor;
+		*height					=	*height / bandInfo.binFactor;
+		bandInfo.dstWidth		=	*width;
+		bandInfo.dstRowBytes	=	(long)*width * channels * bytesPerValue;
+		dstPixels				=	Preview_GetScratch(scratchBuf, scratchSize, (iii & 1), (bandInfo.dstRowBytes * *height));
+		if ((dstPixels == NULL) || (*height < 1))
+		{
+			return(NULL);
+		}
+		bandInfo.srcPtr			=	srcPixels;
+		bandInfo.dstPtr			=	dstPixels;
+		ImageKernel_RunRowBands(*height, Preview_BandProc, &bandInfo);
+		srcPixels				=	dstPixels;
+	}
+	return(srcPixels);
+}
+
+//*****************************************************************************
+//*	stretches to 8 bits through a lookup table made from the histogram,
+//*	3 channel input is BGR, the output is RGB
+//*****************************************************************************
+bool	Preview_Stretch(uint8_t			*displayBuf,
+						const uint8_t	*srcPixels,
+						const int		pixelCnt,
+						const int		channels,
+						const int		bytesPerValue,
+						const int		stretchMode)
+{
+uint32_t	*histogram;
+uint8_t		*lutPtr;
+int			histSize;
+
+	histSize	=	(bytesPerValue == 2) ? 65536 : 256;
+	histogram	=	(uint32_t *)calloc(histSize, sizeof(uint32_t));
+	lutPtr		=	(uint8_t *)malloc(histSize);
+	if ((histogram == NULL) || (lutPtr == NULL))
+	{
+		free(histogram);
+		free(lutPtr);
+		return(false);
+	}
+	if (bytesPerValue == 2)
+	{
+		ImageKernel_Histogram_U16(histogram, (const uint16_t *)srcPixels, (long)pixelCnt * channels);
+		Preview_BuildLUT(lutPtr, histogram, histSize, stretchMode);
+		ImageKernel_LUT_U16toU8(displayBuf, (const uint16_t *)srcPixels, pixelCnt, channels, lutPtr);
+	}
+	else
+	{
+		ImageKernel_Histogram_U8(histogram, srcPixels, (long)pixelCnt * channels);
+		Preview_BuildLUT(lutPtr, histogram, histSize, stretchMode);
+		ImageKernel_LUT_U8(displayBuf, srcPixels, pixelCnt, channels, lutPtr);
+	}
+	free(histogram);
+	free(lutPtr);
+	return(true);
+}
+
+//*****************************************************************************
+//*	builds the complete HTTP response for the current frame in cPreviewCache
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Preview_Build(const int maxWidth, const int stretchMode, const int format, const int quality, char *alpacaErrMsg)
+{
+TYPE_PREVIEW_BAND	bandInfo;
+TYPE_ENCODE_IMAGE	encodeImage;
+TYPE_ENCODE_OPTIONS	encodeOptions;
+const uint8_t		*srcPixels;
+uint8_t				*displayBuf;
+uint8_t				*encodedBuf;
+size_t				encodedSize;
+int					width;
+int					height;
+bool				encodeOK;
+char				httpHeader[512];
+char				lineBuff[128];
+size_t				httpHeaderSize;
+
+	memset(&bandInfo, 0, sizeof(TYPE_PREVIEW_BAND));
+	switch(cLastExposure_ROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	1;
+			break;
+
+		case kImageType_RAW16:
+			bandInfo.bytesPerValue	=	2;
+			bandInfo.channels		=	1;
+			break;
+
+		case kImageType_RGB24:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	3;
+			break;
+
+		default:
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Image type not supported for preview");
+			return(kASCOM_Err_NotImplemented);
+	}
+	if ((format == kPreviewFormat_JPEG) && (ImageEncode_JPEGsupported() == false))
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "JPEG not supported in this build");
+		return(kASCOM_Err_NotImplemented);
+	}
+	if ((format == kPreviewFormat_PNG) && (ImageEncode_PNGsupported() == false))
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "PNG not supported in this build");
+		return(kASCOM_Err_NotImplemented);
+	}
+
+	//*	reduce
+	width		=	cLastExposure_ROIinfo.currentROIwidth;
+	height		=	cLastExposure_ROIinfo.currentROIheight;
+	srcPixels	=	Preview_Reduce(	cCameraDataBuffer,
+									&width,
+									&height,
+									bandInfo.channels,
+									bandInfo.bytesPerValue,
+									maxWidth,
+									cPreviewScratch,
+									cPreviewScratchSize);
+	if (srcPixels == NULL)
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to allocate preview buffer");
+		return(kASCOM_Err_InternalError);
+	}
+
+	//*	stretch to 8 bits
+	displayBuf	=	(uint8_t *)malloc((size_t)width * height * bandInfo.channels);
+	if ((displayBuf == NULL) ||
+		(Preview_Stretch(displayBuf, srcPixels, (width * height), bandInfo.channels, bandInfo.bytesPerValue, stretchMode) == false))
+	{
+		free(displayBuf);
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to allocate preview buffer");
+		return(kASCOM_Err_InternalError);
+	}
+
+	//*	encode, the display buffer is RGB
+	encodedBuf	=	NULL;
+	encodedSize	=	0;
+	encodeOK	=	true;
+	memset(&encodeImage, 0, sizeof(TYPE_ENCODE_IMAGE));
+	encodeImage.pixels			=	displayBuf;
+	encodeImage.width			=	width;
+	encodeImage.height			=	height;
+	encodeImage.rowBytes		=	width * bandInfo.channels;
+	encodeImage.channels		=	bandInfo.channels;
+	encodeImage.bytesPerSample	=	1;
+	encodeImage.bgrOrder		=	false;
+	encodeOptions				=	cImageEncodeOptions;
+	encodeOptions.jpegQuality	=	quality;
+	switch(format)
+	{
+		case kPreviewFormat_JPEG:
+			encodeOK	=	ImageEncode_JPEGtoMemory(&encodeImage, &encodeOptions, &encodedBuf, &encodedSize);
+			strcpy(lineBuff, "image/jpeg");
+			break;
+
+		case kPreviewFormat_PNG:
+			encodeOK	=	ImageEncode_PNGtoMemory(&encodeImage, &encodeOptions, &encodedBuf, &encodedSize);
+			strcpy(lineBuff, "image/png");
+			break;
+
+		default:
+			encodedBuf	=	displayBuf;
+			encodedSize	=	(size_t)width * height * bandInfo.channels;
+			displayBuf	=	NULL;
+			strcpy(lineBuff, "application/octet-stream");
+			break;
+	}
+	free(displayBuf);
+	if ((encodeOK == false) || (encodedBuf == NULL))
+	{
+		free(encodedBuf);
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to encode preview");
+		return(kASCOM_Err_InternalError);
+	}
+
+	//*	HTTP header, the image follows it in the same buffer
+	strcpy(httpHeader,	"HTTP/1.0 200 OK\r\n");
+	strcat(httpHeader,	"Content-type: ");
+	strcat(httpHeader,	lineBuff);
+	strcat(httpHeader,	"\r\n");
+	sprintf(lineBuff,	"Content-Length: %ld\r\n", (long)encodedSize);
+	strcat(httpHeader,	lineBuff);
+	strcat(httpHeader,	"Server: AlpacaPi\r\n");
+	strcat(httpHeader,	"Cache-Control: no-cache\r\n");
+	sprintf(lineBuff,	"AlpacaPi-Preview: width=%d, height=%d, channels=%d, frame=%ld\r\n",
+											width, height, bandInfo.channels, cFramesRead);
+	strcat(httpHeader,	lineBuff);
+	strcat(httpHeader, "\r\n");
+	httpHeaderSize	=	strlen(httpHeader);
+
+	free(cPreviewCache.responseBuf);
+	cPreviewCache.responseBuf	=	(uint8_t *)malloc(httpHeaderSize + encodedSize);
+	cPreviewCache.responseLen	=	0;
+	cPreviewCache.frameNumber	=	-1;
+	if (cPreviewCache.responseBuf == NULL)
+	{
+		free(encodedBuf);
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to allocate preview buffer");
+		return(kASCOM_Err_InternalError);
+	}
+	memcpy(cPreviewCache.responseBuf, httpHeader, httpHeaderSize);
+	memcpy(cPreviewCache.responseBuf + httpHeaderSize, encodedBuf, encodedSize);
+	free(encodedBuf);
+	cPreviewCache.responseLen	=	httpHeaderSize + encodedSize;
+	cPreviewCache.frameNumber	=	cFramesRead;
+	cPreviewCache.maxWidth		=	maxWidth;
+	cPreviewCache.stretch		=	stretchMode;
+	cPreviewCache.format		=	format;
+	cPreviewCache.quality		=	quality;
+	return(kASCOM_Err_Success);
+}
+
+//*****************************************************************************
+void	CameraDriver::Preview_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"preview_ms",
+									cPreviewLast_ms,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"previewcachehits",
+									cPreviewCacheHits,
+									INCLUDE_COMMA);
+}
+
+//*****************************************************************************
+//*	maxwidth=INT, stretch=auto|linear|none, format=jpeg|png|raw, quality=INT
+//*	raw is 8 bit mono or RGB, the size is in the AlpacaPi-Preview header
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_Preview(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+int					maxWidth;
+int					stretchMode;
+int					format;
+int					quality;
+uint32_t			startMilliSecs;
+ssize_t				bytesWritten;
+
+	if ((cCameraDataBuffer == NULL) || (cFramesRead <= 0) ||
+		(cLastExposure_ROIinfo.currentROIwidth <= 0) || (cLastExposure_ROIinfo.currentROIheight <= 0))
+	{
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "No image available");
+		return(kASCOM_Err_InvalidOperation);
+	}
+
+	maxWidth	=	kPreview_DefaultMaxWidth;
+	stretchMode	=	kPreviewStretch_Auto;
+	format		=	kPreviewFormat_JPEG;
+	quality		=	kPreview_DefaultQuality;
+	if (GetKeyWordArgument(reqData->contentData, "maxwidth", argumentString, (sizeof(argumentString) -1)))
+	{
+		maxWidth	=	atoi(argumentString);
+		if (maxWidth < kPreview_MinWidth)
+		{
+			maxWidth	=	kPreview_MinWidth;
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "stretch", argumentString, (sizeof(argumentString) -1)))
+	{
+		if (strcasecmp(argumentString, "auto") == 0)
+		{
+			stretchMode	=	kPreviewStretch_Auto;
+		}
+		else if (strcasecmp(argumentString, "linear") == 0)
+		{
+			stretchMode	=	kPreviewStretch_Linear;
+		}
+		else if (strcasecmp(argumentString, "none") == 0)
+		{
+			stretchMode	=	kPreviewStretch_None;
+		}
+		else
+		{
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Stretch must be 'auto', 'linear' or 'none'");
+			return(kASCOM_Err_InvalidValue);
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "format", argumentString, (sizeof(argumentString) -1)))
+	{
+		if ((strcasecmp(argumentString, "jpeg") == 0) || (strcasecmp(argumentString, "jpg") == 0))
+		{
+			format	=	kPreviewFormat_JPEG;
+		}
+		else if (strcasecmp(argumentString, "png") == 0)
+		{
+			format	=	kPreviewFormat_PNG;
+		}
+		else if (strcasecmp(argumentString, "raw") == 0)
+		{
+			format	=	kPreviewFormat_RAW;
+		}
+		else
+		{
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Format must be 'jpeg', 'png' or 'raw'");
+			return(kASCOM_Err_InvalidValue);
+		}
+	}
+	if (GetKeyWordArgument(reqData->contentData, "quality", argumentString, (sizeof(argumentString) -1)))
+	{
+		quality	=	atoi(argumentString);
+		if ((quality < 1) || (quality > 100))
+		{
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Quality must be 1 to 100");
+			return(kASCOM_Err_InvalidValue);
+		}
+	}
+	if (format != kPreviewFormat_JPEG)
+	{
+		quality	=	0;		//*	so it does not split the cache
+	}
+
+	if ((cPreviewCache.responseBuf == NULL) ||
+		(cPreviewCache.frameNumber != cFramesRead) ||
+		(cPreviewCache.maxWidth != maxWidth) ||
+		(cPreviewCache.stretch != stretchMode) ||
+		(cPreviewCache.format != format) ||
+		(cPreviewCache.quality != quality))
+	{
+		startMilliSecs	=	millis();
+		alpacaErrCode	=	Preview_Build(maxWidth, stretchMode, format, quality, alpacaErrMsg);
+		cPreviewLast_ms	=	millis() - startMilliSecs;
+	}
+	else
+	{
+		cPreviewCacheHits++;
+	}
+
+	if (alpacaErrCode == kASCOM_Err_Success)
+	{
+		cResponseIsJSON	=	false;
+		bytesWritten	=	write(reqData->socket, cPreviewCache.responseBuf, cPreviewCache.responseLen);
+		if (bytesWritten < (ssize_t)cPreviewCache.responseLen)
+		{
+			CONSOLE_DEBUG("Failed to send the entire preview");
+		}
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
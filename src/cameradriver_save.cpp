@@ -37,6 +37,10 @@
 //*	Jul 25,	2022	<MLS> Increased # of decimal points in WriteIMUtextFile()
 //*	Oct  5,	2022	<MLS> Added ReadIMUdata()
 //*	Jun 13,	2023	<MLS> Added checking for valid IMU
+//*	Oct 19,	2026	<MLS> CreateOpenCVImage() demosaics RAW frames from color cameras
+//*	Oct 19,	2026	<MLS> SaveImageData() adds each saved image to the metadata index
+//*	Oct 19,	2026	<MLS> SaveOpenCVImage() uses the multithreaded encoder (cameradriver_encode.cpp)
+//*	Oct 19,	2026	<MLS> OpenCV image size comes from GetLastFrameSize()
 //*****************************************************************************
 
 #ifdef _ENABLE_CAMERA_
@@ -76,7 +80,6 @@
 void	CameraDriver::SaveImageData(void)
 {
 int		iii;
-int		bytesPerPixel;
 
 
 	CONSOLE_DEBUG_W_NUM("cSaveNextImage\t=", cSaveNextImage);
@@ -118,13 +121,19 @@ int		bytesPerPixel;
 	#endif	//	_USE_OPENCV_
 
 
-	#if defined(_ENABLE_JPEGLIB_)
-		bytesPerPixel		=	cOpenCV_ImagePtr->step[1];
-		if (cSaveAsJPEG && (bytesPerPixel!= 2))
+	//*	without OpenCV, the JPEG and PNG files are made from the raw camera data
+	#if defined(_ENABLE_JPEGLIB_) && !defined(_USE_OPENCV_)
+		if (cSaveAsJPEG)
 		{
 			SaveUsingJpegLib();
 		}
 	#endif	//	_ENABLE_JPEGLIB_
+	#if defined(_ENABLE_PNGLIB_) && !defined(_USE_OPENCV_)
+		if (cSaveAsPNG)
+		{
+			SaveUsingPNGlib();
+		}
+	#endif	//	_ENABLE_PNGLIB_
 
 
 	//*	we want FITS to be last so it can include info about other save data products
@@ -159,6 +168,7 @@ int		bytesPerPixel;
 			CONSOLE_DEBUG_W_NUM("cvSaveImage returned\t=", openCVerr);
 		}
 	#endif // _JETSON_
+		ImageIndex_AddSavedImage();
 	}
 	else
 	{
@@ -223,10 +233,32 @@ int				imageDataLen;
 		delete cOpenCV_LiveDisplayPtr;
 		cOpenCV_LiveDisplayPtr	=	NULL;
 	}
-	width			=	cCameraProp.CameraXsize;
-	height			=	cCameraProp.CameraYsize;
+	GetLastFrameSize(&width, &height);
 	GetImage_ROI_info();
 
+	//*	color cameras with RAW data get a color image
+	if (Demosaic_IsActive(cROIinfo.currentROIimageType))
+	{
+		if (Demosaic_OutputBytesPerPixel(cROIinfo.currentROIimageType) == 6)
+		{
+			cOpenCV_ImagePtr	=	new cv::Mat(height, width, CV_16UC3);
+		}
+		else
+		{
+			cOpenCV_ImagePtr	=	new cv::Mat(height, width, CV_8UC3);
+		}
+		if ((imageDataPtr != NULL) && (cOpenCV_ImagePtr->data != NULL))
+		{
+			Demosaic_Frame(	imageDataPtr,
+							cOpenCV_ImagePtr->data,
+							width,
+							height,
+							cOpenCV_ImagePtr->step[0],
+							cROIinfo.currentROIimageType);
+		}
+		return(returnCode);
+	}
+
 	switch(cROIinfo.currentROIimageType)
 	{
 		case kImageType_RAW8:
@@ -329,24 +361,34 @@ int				imageDataLen;
 //*****************************************************************************
 int	CameraDriver::SaveOpenCVImage(void)
 {
-int			bytesPerPixel;
-int			openCVerr;
-char		imageFileName[64];
-char		imageFilePath[128];
+int					bytesPerPixel;
+int					openCVerr;
+char				imageFileName[64];
+char				imageFilePath[128];
+TYPE_ENCODE_IMAGE	encodeImage;
 
 	CONSOLE_DEBUG_W_STR(__FUNCTION__, "Using C++ openCV calls");
 	SETUP_TIMING();
 
 	if (cOpenCV_ImagePtr != NULL)
 	{
+		//*	describe the image for the multithreaded encoder
+		memset(&encodeImage, 0, sizeof(TYPE_ENCODE_IMAGE));
+		encodeImage.pixels			=	cOpenCV_ImagePtr->data;
+		encodeImage.width			=	cOpenCV_ImagePtr->cols;
+		encodeImage.height			=	cOpenCV_ImagePtr->rows;
+		encodeImage.rowBytes		=	cOpenCV_ImagePtr->step[0];
+		encodeImage.channels		=	cOpenCV_ImagePtr->channels();
+		encodeImage.bytesPerSample	=	cOpenCV_ImagePtr->elemSize1();
+		encodeImage.bgrOrder		=	true;
 
 		bytesPerPixel		=	cOpenCV_ImagePtr->step[1];
 		CONSOLE_DEBUG_W_NUM("bytesPerPixel\t=",	bytesPerPixel);
 		if (bytesPerPixel != 0)
 		{
 			//--------------------------------------------------------------------------------------------
-			//*	JPEG does not work on 16 bit images
-			if (cSaveAsJPEG && (bytesPerPixel != 2))
+			//*	JPEG does not work on 16 bit images (mono or demosaiced RGB48)
+			if (cSaveAsJPEG && (cOpenCV_ImagePtr->elemSize1() == 1))
 			{
 				//*	save as JPEG
 				strcpy(imageFileName, cFileNameRoot);
@@ -358,14 +400,21 @@ char		imageFilePath[128];
 
 				strcpy(cLastJpegImageName, imageFilePath);	//*	save the full image path for the web server
 
-				openCVerr	=	cv::imwrite(imageFilePath, *cOpenCV_ImagePtr);
-				if (openCVerr == 1)
+				if (ImageEncode_SaveFile(&encodeImage, imageFilePath, false))
 				{
-					AddToDataProductsList(imageFileName, "JPEG image-openCV");
+					AddToDataProductsList(imageFileName, "JPEG image-libjpeg");
 				}
 				else
 				{
-					CONSOLE_DEBUG_W_NUM("cvSaveImage (jpg) failed, returned\t=", openCVerr);
+					openCVerr	=	cv::imwrite(imageFilePath, *cOpenCV_ImagePtr);
+					if (openCVerr == 1)
+					{
+						AddToDataProductsList(imageFileName, "JPEG image-openCV");
+					}
+					else
+					{
+						CONSOLE_DEBUG_W_NUM("cvSaveImage (jpg) failed, returned\t=", openCVerr);
+					}
 				}
 			}
 
@@ -384,14 +433,21 @@ char		imageFilePath[128];
 				strcat(imageFilePath, "/");
 				strcat(imageFilePath, imageFileName);
 
-				openCVerr	=	cv::imwrite(imageFilePath, *cOpenCV_ImagePtr);
-				if (openCVerr == 1)
+				if (ImageEncode_SaveFile(&encodeImage, imageFilePath, true))
 				{
-					AddToDataProductsList(imageFileName, "PNG image-openCV");
+					AddToDataProductsList(imageFileName, "PNG image-zlib");
 				}
 				else
 				{
-					CONSOLE_DEBUG_W_NUM("cvSaveImage (PNG) failed, returned\t=", openCVerr);
+					openCVerr	=	cv::imwrite(imageFilePath, *cOpenCV_ImagePtr);
+					if (openCVerr == 1)
+					{
+						AddToDataProductsList(imageFileName, "PNG image-openCV");
+					}
+					else
+					{
+						CONSOLE_DEBUG_W_NUM("cvSaveImage (PNG) failed, returned\t=", openCVerr);
+					}
 				}
 //				DEBUG_TIMING("Time to create PNG file=");
 			}
@@ -445,8 +501,7 @@ int				bytesPerPixel2;	//*	calculated 2 different ways
 		cvReleaseImage(&cOpenCV_LiveDisplayPtr);
 		cOpenCV_LiveDisplayPtr	=	NULL;
 	}
-	width			=	cCameraProp.CameraXsize;
-	height			=	cCameraProp.CameraYsize;
+	GetLastFrameSize(&width, &height);
 	GetImage_ROI_info();
 
 //	CONSOLE_DEBUG_W_NUM("currentROIimageType\t=",	cROIinfo.currentROIimageType);
@@ -454,6 +509,25 @@ int				bytesPerPixel2;	//*	calculated 2 different ways
 //	CONSOLE_DEBUG_W_NUM("height\t=",	height);
 //	CONSOLE_DEBUG_W_NUM("w * h\t=",		(width * height));
 
+	//*	color cameras with RAW data get a color image
+	if (Demosaic_IsActive(cROIinfo.currentROIimageType))
+	{
+		cOpenCV_ImagePtr	=	cvCreateImage(	cvSize(width, height),
+												((Demosaic_OutputBytesPerPixel(cROIinfo.currentROIimageType) == 6) ? IPL_DEPTH_16U : IPL_DEPTH_8U),
+												3);
+		if ((imageDataPtr != NULL) && (cOpenCV_ImagePtr != NULL))
+		{
+			Demosaic_Frame(	imageDataPtr,
+							(unsigned char *)cOpenCV_ImagePtr->imageData,
+							width,
+							height,
+							cOpenCV_ImagePtr->widthStep,
+							cROIinfo.currentROIimageType);
+		}
+		DEBUG_TIMING("Demosaic (milliseconds)\t=");
+		return(returnCode);
+	}
+
 	switch(cROIinfo.currentROIimageType)
 	{
 		case kImageType_RAW8:
@@ -557,20 +631,32 @@ int				bytesPerPixel2;	//*	calculated 2 different ways
 //*****************************************************************************
 int	CameraDriver::SaveOpenCVImage(void)
 {
-int			bytesPerPixel;
-int			openCVerr;
-char		imageFileName[64];
-char		imageFilePath[128];
-//int		quality[3] = {CV_IMWRITE_PNG_COMPRESSION, 200, 0};
-int			quality[3] = {16, 200, 0};
+int					bytesPerPixel;
+int					openCVerr;
+char				imageFileName[64];
+char				imageFilePath[128];
+//int				quality[3] = {CV_IMWRITE_PNG_COMPRESSION, 200, 0};
+int					quality[3] = {16, 200, 0};
+TYPE_ENCODE_IMAGE	encodeImage;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 	SETUP_TIMING();
 
 	if (cOpenCV_ImagePtr != NULL)
 	{
+		//*	describe the image for the multithreaded encoder
+		memset(&encodeImage, 0, sizeof(TYPE_ENCODE_IMAGE));
+		encodeImage.pixels			=	(const uint8_t *)cOpenCV_ImagePtr->imageData;
+		encodeImage.width			=	cOpenCV_ImagePtr->width;
+		encodeImage.height			=	cOpenCV_ImagePtr->height;
+		encodeImage.rowBytes		=	cOpenCV_ImagePtr->widthStep;
+		encodeImage.channels		=	cOpenCV_ImagePtr->nChannels;
+		encodeImage.bytesPerSample	=	cOpenCV_ImagePtr->depth / 8;
+		encodeImage.bgrOrder		=	true;
+
 		bytesPerPixel		=	(cOpenCV_ImagePtr->depth / 8) * cOpenCV_ImagePtr->nChannels;
-		if (bytesPerPixel != 2)
+		//*	JPEG does not work on 16 bit images (mono or demosaiced RGB48)
+		if ((bytesPerPixel != 2) && (cOpenCV_ImagePtr->depth == IPL_DEPTH_8U))
 		{
 			//*	save as JPEG
 			strcpy(imageFileName, cFileNameRoot);
@@ -581,14 +667,35 @@ int			quality[3] = {16, 200, 0};
 			strcat(imageFilePath, imageFileName);
 
 			strcpy(cLastJpegImageName, imageFilePath);	//*	save the full image path for the web server
-			openCVerr	=	cvSaveImage(imageFilePath, cOpenCV_ImagePtr, quality);
-			if (openCVerr == 1)
+			if (ImageEncode_SaveFile(&encodeImage, imageFilePath, false))
 			{
-				AddToDataProductsList(imageFileName, "JPEG image-openCV");
+				AddToDataProductsList(imageFileName, "JPEG image-libjpeg");
 			}
 			else
 			{
-				CONSOLE_DEBUG_W_NUM("cvSaveImage (jpg) failed, returned\t=", openCVerr);
+				openCVerr	=	cvSaveImage(imageFilePath, cOpenCV_ImagePtr, quality);
+				if (openCVerr == 1)
+				{
+					AddToDataProductsList(imageFileName, "JPEG image-openCV");
+				}
+				else
+				{
+					CONSOLE_DEBUG_W_NUM("cvSaveImage (jpg) failed, returned\t=", openCVerr);
+				}
+			}
+		}
+		//*	the OpenCV png output is too slow to use (see _ENABLE_PNG_ below), the fast encoder is not
+		if (cSaveAsPNG && cImageEncodeFast)
+		{
+			strcpy(imageFileName, cFileNameRoot);
+			strcat(imageFileName, ".png");
+
+			strcpy(imageFilePath, gImageDataDir);
+			strcat(imageFilePath, "/");
+			strcat(imageFilePath, imageFileName);
+			if (ImageEncode_SaveFile(&encodeImage, imageFilePath, true))
+			{
+				AddToDataProductsList(imageFileName, "PNG image-zlib");
 			}
 		}
 	#ifdef _ENABLE_PNG_
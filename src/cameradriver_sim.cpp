@@ -27,17 +27,27 @@
 //*	Apr 22,	2022	<MLS> Created cameradriver_sim.cpp
 //*	Mar  4,	2023	<MLS> CONFORMU-camera/simulator -> PASSED!!!!!!!!!!!!!!!!!!!!!
 //*	Jun 18,	2023	<MLS> Added Read_CoolerPowerLevel()
+//*	Oct 19,	2026	<MLS> Added star field mode (star_field_sim.c)
+//*	Oct 19,	2026	<MLS> Star field frames are pre-rendered into a ring for high frame rates
+//*	Oct 19,	2026	<MLS> Star field mode uses the requested exposure time
+//*	Oct 19,	2026	<MLS> Creates gSimCameraCount cameras, each with its own serial number and star field seed
+//*	Oct 19,	2026	<MLS> BinX/BinY and sub frames are done in software (SoftBin_Enable())
 //*****************************************************************************
 
 #if defined(_ENABLE_CAMERA_) && defined(_ENABLE_CAMERA_SIMULATOR_)
 
 #include	<stdlib.h>
 #include	<string.h>
+#include	<sys/time.h>
 
 
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
 
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"star_field_sim.h"
+
 #include	"alpaca_defs.h"
 #include	"alpacadriver.h"
 #include	"alpacadriver_helper.h"
@@ -50,12 +60,17 @@
 //**************************************************************************************
 int	CreateCameraObjects_Sim(void)
 {
+int		iii;
 
 	CONSOLE_DEBUG(__FUNCTION__);
 
-	//*	for debugging without a camera
-	new CameraDriverSIM(0);
-	return(1);
+	//*	for debugging without a camera,
+	//*	more than one is for testing multicam
+	for (iii=0; iii<gSimCameraCount; iii++)
+	{
+		new CameraDriverSIM(iii);
+	}
+	return(gSimCameraCount);
 }
 
 //**************************************************************************************
@@ -73,12 +88,14 @@ bool		isConnected;
 	cCameraID					=	deviceNum;
 	cCameraIsSiumlated			=	true;
 	cSimulatedState				=   kExposure_Idle;
+	cSimExposure_us				=	0;
 	cIsColorCam					=	true;
 	cIsCoolerCam				=	true;
 	strcpy(cDeviceManufAbrev,		"SIM");
 	strcpy(cCommonProp.Name,		"AlpacaPi Camera Simulator");
 	strcpy(cCommonProp.Description,	"AlpacaPi Camera Simulator");
 	strcpy(cCameraProp.SensorName,	"Fake-ASI2600");
+	sprintf(cDeviceSerialNum,		"SIM%d", deviceNum);
 
 
 	cTempReadSupported		=	true;
@@ -105,6 +122,9 @@ bool		isConnected;
 	cCameraProp.NumX				=	cCameraProp.CameraXsize;
 	cCameraProp.NumY				=	cCameraProp.CameraYsize;
 
+	//*	the simulated frame is always the full sensor
+	SoftBin_Enable();
+
 	cCameraProp.GainMin				=	0;
 	cCameraProp.GainMax				=	10;
 	cCameraProp.ElectronsPerADU		=	65000;
@@ -118,6 +138,23 @@ bool		isConnected;
 
 	SetImageType(kImageType_RGB24);
 
+	//*	star field mode
+	cStarFieldMode			=	true;
+	StarFieldSim_SetDefaults(&cStarFieldSettings);
+	cStarFieldSettings.randomSeed			+=	deviceNum;
+	//*	3.76 um pixels at 400 mm
+	cStarFieldSettings.pixelScale_arcsec	=	(206.265 * cCameraProp.PixelSizeX) / 400.0;
+	memset(&cStarField, 0, sizeof(TYPE_STARFIELD));
+	cStarFieldValid			=	false;
+	cFrameRing				=	NULL;
+	cFrameRingSize			=	kSimFrameRing_Default;
+	cFrameRingCount			=	0;
+	cFrameRingFrameBytes	=	0;
+	cFrameRingImageType		=	kImageType_Invalid;
+	cFrameRingExposure_us	=	0;
+	cFrameRingNext			=	0;
+	cFrameRingRender_ms		=	0;
+
 	DumpCameraProperties(__FUNCTION__);
 
 	isConnected		=	AlpacaConnect();
@@ -146,6 +183,12 @@ bool		isConnected;
 CameraDriverSIM::~CameraDriverSIM(void)
 {
 	CONSOLE_DEBUG(__FUNCTION__);
+	StarFieldSim_Release(&cStarField);
+	if (cFrameRing != NULL)
+	{
+		free(cFrameRing);
+		cFrameRing	=	NULL;
+	}
 }
 
 
@@ -276,6 +319,7 @@ TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_NotImplemented;
 //		durationSeconds	=	2;
 
 		CONSOLE_DEBUG("Simulating camera");
+		cSimExposure_us			=	exposureMicrosecs;
 		cInternalCameraState	=	kCameraState_TakingPicture;
 		cCameraProp.CameraState	=   kALPACA_CameraState_Exposing;
 		SetLastExposureInfo();
@@ -304,6 +348,7 @@ TYPE_EXPOSURE_STATUS	CameraDriverSIM::Check_Exposure(bool verboseFlag)
 TYPE_EXPOSURE_STATUS	myExposureStatus;
 struct timeval			currentTIme;
 time_t					deltaTime_secs;
+int64_t					deltaTime_us;
 
 	//--------------------------------------------
 	//*	simulate image
@@ -313,6 +358,17 @@ time_t					deltaTime_secs;
 			myExposureStatus		=	kExposure_Working;
 			gettimeofday(&currentTIme, NULL);	//*	get the current time
 			deltaTime_secs	=	currentTIme.tv_sec - cCameraProp.Lastexposure_StartTime.tv_sec;
+			if (cStarFieldMode)
+			{
+				//*	the star field honors the exposure time so it can run at video rates
+				deltaTime_us	=	(deltaTime_secs * 1000000L) +
+									(currentTIme.tv_usec - cCameraProp.Lastexposure_StartTime.tv_usec);
+				if (deltaTime_us >= cSimExposure_us)
+				{
+					myExposureStatus		=	kExposure_Success;
+				}
+				break;
+			}
 
 //			CONSOLE_DEBUG_W_LONG("deltaTime_secs\t=",			deltaTime_secs);
 			if (deltaTime_secs > 2)
@@ -406,6 +462,11 @@ int					bytesPerPixel;
 		}
 		CONSOLE_DEBUG_W_NUM("bytesPerPixel\t=",			bytesPerPixel);
 
+		if (cStarFieldMode)
+		{
+			return(StarField_ReadFrame(bytesPerPixel));
+		}
+
 		AllocateImageBuffer(-1);		//*	let it figure out how much
 		if (cCameraDataBuffer != NULL)
 		{
@@ -429,4 +490,502 @@ int					bytesPerPixel;
 }
 
 
+//*****************************************************************************
+//*	RAW16 is copied as is, 8 bit formats get the high byte.
+//*	RGB24 uses each 2x2 Bayer cell for all 4 pixels, in BGR order like the cameras
+//*****************************************************************************
+void	CameraDriverSIM::StarField_ConvertFrame(const uint16_t *srcPtr, unsigned char *dstPtr, const int bytesPerPixel)
+{
+int				width;
+int				height;
+int				xxx;
+int				yyy;
+int				cellX;
+int				cellY;
+const uint16_t	*cellPtr;
+unsigned char	*outPtr;
+
+	width	=	cCameraProp.CameraXsize;
+	height	=	cCameraProp.CameraYsize;
+	switch(bytesPerPixel)
+	{
+		case 2:
+			memcpy(dstPtr, srcPtr, (width * height * sizeof(uint16_t)));
+			break;
+
+		case 3:
+			for (yyy=0; yyy<height; yyy++)
+			{
+				outPtr	=	&dstPtr[yyy * width * 3];
+				cellY	=	yyy & ~1;
+				if (cellY >= (height - 1))
+				{
+					cellY	=	height - 2;
+				}
+				for (xxx=0; xxx<width; xxx++)
+				{
+					cellX	=	xxx & ~1;
+					if (cellX >= (width - 1))
+					{
+						cellX	=	width - 2;
+					}
+					cellPtr	=	&srcPtr[(cellY * width) + cellX];
+					if (cStarFieldSettings.bayerMosaic)
+					{
+						outPtr[0]	=	cellPtr[width + 1] >> 8;					//*	blue
+						outPtr[1]	=	((cellPtr[1] + cellPtr[width]) >> 1) >> 8;	//*	green
+						outPtr[2]	=	cellPtr[0] >> 8;							//*	red
+					}
+					else
+					{
+						outPtr[0]	=	srcPtr[(yyy * width) + xxx] >> 8;
+						outPtr[1]	=	outPtr[0];
+						outPtr[2]	=	outPtr[0];
+					}
+					outPtr	+=	3;
+				}
+			}
+			break;
+
+		default:
+			for (xxx=0; xxx<(width * height); xxx++)
+			{
+				dstPtr[xxx]	=	srcPtr[xxx] >> 8;
+			}
+			break;
+	}
+}
+
+//*****************************************************************************
+//*	the ring holds frames 0 -> n-1, the tracking drift starts over when it wraps
+//*****************************************************************************
+bool	CameraDriverSIM::StarField_BuildRing(const int bytesPerPixel)
+{
+uint16_t		*renderBuffer;
+unsigned char	*newRing;
+long			frameBytes;
+int				frameCount;
+uint32_t		startMilliSecs;
+bool			ringOK;
+int				iii;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	startMilliSecs	=	millis();
+	if (cStarFieldValid == false)
+	{
+		StarFieldSim_Release(&cStarField);
+		cStarFieldValid	=	StarFieldSim_Create(&cStarField,
+												&cStarFieldSettings,
+												cCameraProp.CameraXsize,
+												cCameraProp.CameraYsize);
+		cFrameRingCount	=	0;
+		if (cStarFieldValid == false)
+		{
+			return(false);
+		}
+	}
+
+	frameBytes	=	(long)cCameraProp.CameraXsize * cCameraProp.CameraYsize * bytesPerPixel;
+	frameCount	=	cFrameRingSize;
+	if ((frameCount * frameBytes) > kSimFrameRing_MaxBytes)
+	{
+		frameCount	=	kSimFrameRing_MaxBytes / frameBytes;
+	}
+	if (frameCount < 1)
+	{
+		frameCount	=	1;
+	}
+
+	cFrameRingCount	=	0;
+	newRing			=	(unsigned char *)realloc(cFrameRing, frameCount * frameBytes);
+	if (newRing == NULL)
+	{
+		CONSOLE_DEBUG("Failed to allocate the frame ring");
+		return(false);
+	}
+	cFrameRing		=	newRing;
+	renderBuffer	=	(uint16_t *)malloc((long)cCameraProp.CameraXsize * cCameraProp.CameraYsize * sizeof(uint16_t));
+	if (renderBuffer == NULL)
+	{
+		return(false);
+	}
+	ringOK	=	true;
+	for (iii=0; iii<frameCount; iii++)
+	{
+		ringOK	=	StarFieldSim_Render(&cStarField, iii, (cSimExposure_us / 1000000.0), renderBuffer);
+		if (ringOK == false)
+		{
+			break;
+		}
+		StarField_ConvertFrame(renderBuffer, &cFrameRing[iii * frameBytes], bytesPerPixel);
+	}
+	free(renderBuffer);
+	if (ringOK)
+	{
+		cFrameRingCount			=	frameCount;
+		cFrameRingFrameBytes	=	frameBytes;
+		cFrameRingImageType		=	cROIinfo.currentROIimageType;
+		cFrameRingExposure_us	=	cSimExposure_us;
+		cFrameRingNext			=	0;
+	}
+	cFrameRingRender_ms	=	millis() - startMilliSecs;
+	CONSOLE_DEBUG_W_NUM("Frame ring count    \t=", cFrameRingCount);
+	CONSOLE_DEBUG_W_NUM("Frame ring build ms \t=", cFrameRingRender_ms);
+	return(ringOK);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriverSIM::StarField_ReadFrame(const int bytesPerPixel)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	AllocateImageBuffer(-1);		//*	let it figure out how much
+	if (cCameraDataBuffer == NULL)
+	{
+		CONSOLE_ABORT("Failed to allocate image buffer");
+	}
+	if ((cStarFieldValid == false) ||
+		(cFrameRingCount == 0) ||
+		(cFrameRingImageType != cROIinfo.currentROIimageType) ||
+		(cFrameRingExposure_us != cSimExposure_us))
+	{
+		if (StarField_BuildRing(bytesPerPixel) == false)
+		{
+			strcpy(cLastCameraErrMsg, "Failed to render the star field");
+			return(kASCOM_Err_FailedUnknown);
+		}
+	}
+	memcpy(cCameraDataBuffer, &cFrameRing[(cFrameRingNext % cFrameRingCount) * cFrameRingFrameBytes], cFrameRingFrameBytes);
+	cFrameRingNext++;
+	cCameraProp.ImageReady	=	true;
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriverSIM::Get_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									(cStarFieldMode ? "starfield" : "pattern"),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_ra",
+									cStarFieldSettings.ra_deg,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_dec",
+									cStarFieldSettings.dec_deg,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_rotation",
+									cStarFieldSettings.rotation_deg,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_scale",
+									cStarFieldSettings.pixelScale_arcsec,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_seeing",
+									cStarFieldSettings.seeing_arcsec,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_maglimit",
+									cStarFieldSettings.limitMagnitude,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_skylevel",
+									cStarFieldSettings.skyLevel,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_readnoise",
+									cStarFieldSettings.readNoise,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_hotpixels",
+									cStarFieldSettings.hotPixelCount,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_driftra",
+									cStarFieldSettings.driftRA_arcsec,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_driftdec",
+									cStarFieldSettings.driftDec_arcsec,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_bayer",
+									cStarFieldSettings.bayerMosaic,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_seed",
+									cStarFieldSettings.randomSeed,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_catalog",
+									(cStarFieldValid ? cStarField.catalogName : ""),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_catalogstars",
+									(cStarFieldValid ? cStarField.catalogStarCount : 0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_stars",
+									(cStarFieldValid ? cStarField.starCount : 0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_ringsize",
+									cFrameRingSize,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_ringframes",
+									cFrameRingCount,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_ringrender_ms",
+									cFrameRingRender_ms,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"sim_framecount",
+									cFrameRingNext,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+typedef struct	//	TYPE_SIM_ARGUMENT
+{
+	const char	*keyword;
+	double		minValue;
+	double		maxValue;
+} TYPE_SIM_ARGUMENT;
+
+//*****************************************************************************
+//*	same order as the pointer list in Put_Simulator()
+static const TYPE_SIM_ARGUMENT	gSimArguments[]	=
+{
+	{	"RA",			0.0,		360.0	},
+	{	"Dec",			-90.0,		90.0	},
+	{	"Rotation",		-360.0,		360.0	},
+	{	"Scale",		0.05,		300.0	},
+	{	"Seeing",		0.1,		600.0	},
+	{	"MagLimit",		-2.0,		20.0	},
+	{	"SkyLevel",		0.0,		1.0e6	},
+	{	"ReadNoise",	0.0,		1000.0	},
+	{	"DriftRA",		-3600.0,	3600.0	},
+	{	"DriftDec",		-3600.0,	3600.0	},
+	{	NULL,			0.0,		0.0		}
+};
+
+//*****************************************************************************
+//*	simulator=starfield|pattern
+//*	ra=FLOAT, dec=FLOAT			degrees
+//*	rotation=FLOAT				degrees, +Y east of north
+//*	scale=FLOAT					arc-seconds per pixel
+//*	seeing=FLOAT				FWHM, arc-seconds
+//*	maglimit=FLOAT
+//*	skylevel=FLOAT				electrons per pixel per second
+//*	readnoise=FLOAT				electrons
+//*	hotpixels=INT
+//*	driftra=FLOAT, driftdec=FLOAT	arc-seconds per frame
+//*	bayer=BOOL
+//*	seed=INT
+//*	ringsize=INT				number of pre-rendered frames
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriverSIM::Put_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS		alpacaErrCode	=	kASCOM_Err_Success;
+TYPE_STARFIELD_SETTINGS	newSettings;
+char					argumentString[32];
+bool					optionFound;
+double					argValue;
+int						intValue;
+int						newRingSize;
+int						iii;
+double					*valuePtrs[]	=
+{
+	&newSettings.ra_deg,
+	&newSettings.dec_deg,
+	&newSettings.rotation_deg,
+	&newSettings.pixelScale_arcsec,
+	&newSettings.seeing_arcsec,
+	&newSettings.limitMagnitude,
+	&newSettings.skyLevel,
+	&newSettings.readNoise,
+	&newSettings.driftRA_arcsec,
+	&newSettings.driftDec_arcsec
+};
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	optionFound	=	false;
+	newSettings	=	cStarFieldSettings;
+	newRingSize	=	cFrameRingSize;
+	if (GetKeyWordArgument(reqData->contentData, "Simulator", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		if (strcasecmp(argumentString, "starfield") == 0)
+		{
+			cStarFieldMode	=	true;
+		}
+		else if (strcasecmp(argumentString, "pattern") == 0)
+		{
+			cStarFieldMode	=	false;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Simulator must be 'starfield' or 'pattern'");
+		}
+	}
+
+	for (iii=0; gSimArguments[iii].keyword != NULL; iii++)
+	{
+		if (GetKeyWordArgument(reqData->contentData, gSimArguments[iii].keyword, argumentString, (sizeof(argumentString) -1)))
+		{
+			optionFound	=	true;
+			argValue	=	atof(argumentString);
+			if ((argValue >= gSimArguments[iii].minValue) && (argValue <= gSimArguments[iii].maxValue))
+			{
+				*valuePtrs[iii]	=	argValue;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				sprintf(alpacaErrMsg, "AlpacaPi:%s out of range: %s: %d", gSimArguments[iii].keyword, __FUNCTION__, __LINE__);
+			}
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "HotPixels", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		intValue	=	atoi(argumentString);
+		if ((intValue >= 0) && (intValue <= kStarFieldSim_MaxHotPixels))
+		{
+			newSettings.hotPixelCount	=	intValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "HotPixels out of range");
+		}
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Bayer", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		newSettings.bayerMosaic	=	IsTrueFalse(argumentString);
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "Seed", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		newSettings.randomSeed	=	strtoul(argumentString, NULL, 10);
+	}
+
+	if (GetKeyWordArgument(reqData->contentData, "RingSize", argumentString, (sizeof(argumentString) -1)))
+	{
+		optionFound	=	true;
+		intValue	=	atoi(argumentString);
+		if ((intValue >= 1) && (intValue <= kSimFrameRing_Max))
+		{
+			newRingSize	=	intValue;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "RingSize out of range");
+		}
+	}
+
+	if (optionFound == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'simulator' not found");
+	}
+	else if (alpacaErrCode == kASCOM_Err_Success)
+	{
+		//*	the field is rebuilt on the next frame
+		if (memcmp(&newSettings, &cStarFieldSettings, sizeof(TYPE_STARFIELD_SETTINGS)) != 0)
+		{
+			cStarFieldSettings	=	newSettings;
+			cStarFieldValid		=	false;
+		}
+		if (newRingSize != cFrameRingSize)
+		{
+			cFrameRingSize	=	newRingSize;
+			cFrameRingCount	=	0;
+		}
+	}
+	return(alpacaErrCode);
+}
+
+
 #endif // defined(_ENABLE_CAMERA_) && defined(_ENABLE_CAMERA_SIMULATOR_)
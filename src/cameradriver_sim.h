@@ -17,6 +17,7 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	May  4,	2022	<MLS> Created cameradriver_sim.h
+//*	Oct 19,	2026	<MLS> Added star field mode with a pre-rendered frame ring
 //*****************************************************************************
 //#include	"cameradriver_sim.h"
 
@@ -30,6 +31,18 @@
 	#include	"cameradriver.h"
 #endif
 
+#ifndef _STAR_FIELD_SIM_H_
+	#include	"star_field_sim.h"
+#endif
+
+#define	kSimFrameRing_Default		8
+#define	kSimFrameRing_Max			256
+#ifdef __arm__
+	#define	kSimFrameRing_MaxBytes	(128L * 1024L * 1024L)
+#else
+	#define	kSimFrameRing_MaxBytes	(1024L * 1024L * 1024L)
+#endif
+
 int		CreateCameraObjects_Sim(void);
 
 
@@ -92,8 +105,30 @@ class CameraDriverSIM: public CameraDriver
 //		virtual	TYPE_ASCOM_STATUS		Read_Fastreadout(void);
 		virtual	TYPE_ASCOM_STATUS		Read_ImageData(void);
 
+		virtual	TYPE_ASCOM_STATUS		Get_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+		virtual	TYPE_ASCOM_STATUS		Put_Simulator(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+
 	protected:
 		TYPE_EXPOSURE_STATUS			cSimulatedState;
+		int32_t							cSimExposure_us;
+
+		//*	star field mode, frames are rendered into a ring once and then copied out
+		bool							StarField_BuildRing(const int bytesPerPixel);
+		void							StarField_ConvertFrame(const uint16_t *srcPtr, unsigned char *dstPtr, const int bytesPerPixel);
+		TYPE_ASCOM_STATUS				StarField_ReadFrame(const int bytesPerPixel);
+
+		bool							cStarFieldMode;
+		TYPE_STARFIELD_SETTINGS			cStarFieldSettings;
+		TYPE_STARFIELD					cStarField;
+		bool							cStarFieldValid;		//*	false when the settings change
+		unsigned char					*cFrameRing;
+		int								cFrameRingSize;			//*	requested
+		int								cFrameRingCount;		//*	frames in the ring
+		long							cFrameRingFrameBytes;
+		TYPE_IMAGE_TYPE					cFrameRingImageType;
+		int32_t							cFrameRingExposure_us;
+		uint32_t						cFrameRingNext;
+		uint32_t						cFrameRingRender_ms;
 
 };
 #endif // _CAMERA_DRIVER_SIM_H_
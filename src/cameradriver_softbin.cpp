@@ -0,0 +1,344 @@
+//**************************************************************************
+//*	Name:			cameradriver_softbin.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Software binning and sub frame (ROI) extraction
+//*
+//*					For cameras whose SDK always returns the full sensor (and the simulator),
+//*					BinX/BinY and StartX/StartY/NumX/NumY are applied to the frame
+//*					right after it is read, so everything after that (calibration,
+//*					star analysis, imagearray, saving) sees the frame the client asked for.
+//*
+//*					Binning is 2x2, 3x3 or 4x4 of RAW8, RAW16 or RGB24, either the sum
+//*					(saturating at full scale, like on chip binning) or the average.
+//*					The row kernels are in image_kernels.c (SSE2/NEON).
+//*
+//*					Binned frames are built in a pooled buffer by row bands in parallel,
+//*					then copied back to the start of the frame buffer. The pool is kept
+//*					from frame to frame. If it cannot be allocated, the frame is binned in
+//*					place in one thread, which is safe because each output row is never
+//*					after the input rows it comes from.
+//*					A sub frame without binning is moved in place with memmove().
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_softbin.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<strings.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+#include	"frame_alloc.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+#define	kSoftBinMaxFactor	4
+
+//*****************************************************************************
+typedef struct	//	TYPE_SOFTBIN_BAND
+{
+	const unsigned char	*srcPtr;			//*	first pixel of the sub frame
+	unsigned char		*dstPtr;
+	long				srcRowBytes;
+	long				dstRowBytes;
+	int					srcRowValues;
+	int					dstWidth;
+	int					channels;
+	int					bytesPerValue;
+	int					binFactor;
+	int					binMode;
+} TYPE_SOFTBIN_BAND;
+
+//*****************************************************************************
+//*	called by ImageKernel_RunRowBands() for each band of output rows
+//*****************************************************************************
+static void	SoftBin_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_SOFTBIN_BAND	*band;
+const unsigned char	*srcRow;
+unsigned char		*dstRow;
+int					yyy;
+
+	band	=	(TYPE_SOFTBIN_BAND *)context;
+	for (yyy=firstRow; yyy<lastRow; yyy++)
+	{
+		srcRow	=	band->srcPtr + ((long)yyy * band->binFactor * band->srcRowBytes);
+		dstRow	=	band->dstPtr + ((long)yyy * band->dstRowBytes);
+		if (band->bytesPerValue == 2)
+		{
+			ImageKernel_BinRow_U16(	(uint16_t *)dstRow,
+									(const uint16_t *)srcRow,
+									band->srcRowValues,
+									band->dstWidth,
+									band->channels,
+									band->binFactor,
+									band->binMode);
+		}
+		else
+		{
+			ImageKernel_BinRow_U8(	dstRow,
+									srcRow,
+									band->srcRowValues,
+									band->dstWidth,
+									band->channels,
+									band->binFactor,
+									band->binMode);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	called by drivers that always read the full sensor
+//*****************************************************************************
+void	CameraDriver::SoftBin_Enable(void)
+{
+	cSoftBinEnabled				=	true;
+	cCameraProp.MaxbinX			=	kSoftBinMaxFactor;
+	cCameraProp.MaxbinY			=	kSoftBinMaxFactor;
+	cCameraProp.CanAsymmetricBin	=	false;
+}
+
+//*****************************************************************************
+//*	called from the state machine after Read_ImageData() succeeds,
+//*	cLastExposure_ROIinfo has the size of the full frame
+//*****************************************************************************
+void	CameraDriver::SoftBin_ProcessFrame(void)
+{
+TYPE_SOFTBIN_BAND	bandInfo;
+uint32_t			startMilliSecs;
+int					fullWidth;
+int					fullHeight;
+int					binFactor;
+int					startX;
+int					startY;
+int					numX;
+int					numY;
+long				outputBytes;
+
+	if ((cSoftBinEnabled == false) || (cCameraDataBuffer == NULL))
+	{
+		return;
+	}
+	memset(&bandInfo, 0, sizeof(TYPE_SOFTBIN_BAND));
+	switch(cLastExposure_ROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW8:
+		case kImageType_Y8:
+		case kImageType_MONO8:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	1;
+			break;
+
+		case kImageType_RAW16:
+			bandInfo.bytesPerValue	=	2;
+			bandInfo.channels		=	1;
+			break;
+
+		case kImageType_RGB24:
+			bandInfo.bytesPerValue	=	1;
+			bandInfo.channels		=	3;
+			break;
+
+		default:
+			return;
+	}
+	fullWidth	=	cLastExposure_ROIinfo.currentROIwidth;
+	fullHeight	=	cLastExposure_ROIinfo.currentROIheight;
+	binFactor	=	cCameraProp.BinX;
+	if ((binFactor < 1) || (binFactor > kSoftBinMaxFactor))
+	{
+		binFactor	=	1;
+	}
+
+	//*	the sub frame is in binned pixels
+	startX		=	cCameraProp.StartX;
+	startY		=	cCameraProp.StartY;
+	numX		=	cCameraProp.NumX;
+	numY		=	cCameraProp.NumY;
+	if ((startX < 0) || (startX >= (fullWidth / binFactor)))
+	{
+		startX	=	0;
+	}
+	if ((startY < 0) || (startY >= (fullHeight / binFactor)))
+	{
+		startY	=	0;
+	}
+	if ((numX < 1) || (numX > ((fullWidth / binFactor) - startX)))
+	{
+		numX	=	(fullWidth / binFactor) - startX;
+	}
+	if ((numY < 1) || (numY > ((fullHeight / binFactor) - startY)))
+	{
+		numY	=	(fullHeight / binFactor) - startY;
+	}
+	if ((binFactor == 1) && (numX == fullWidth) && (numY == fullHeight))
+	{
+		//*	full frame, nothing to do
+		return;
+	}
+	startMilliSecs	=	millis();
+
+	bandInfo.srcRowValues	=	fullWidth * bandInfo.channels;
+	bandInfo.srcRowBytes	=	(long)bandInfo.srcRowValues * bandInfo.bytesPerValue;
+	bandInfo.dstRowBytes	=	(long)numX * bandInfo.channels * bandInfo.bytesPerValue;
+	bandInfo.srcPtr			=	cCameraDataBuffer +	((long)startY * binFactor * bandInfo.srcRowBytes) +
+													((long)startX * binFactor * bandInfo.channels * bandInfo.bytesPerValue);
+	bandInfo.dstWidth		=	numX;
+	bandInfo.binFactor		=	binFactor;
+	bandInfo.binMode		=	cSoftBinMode;
+	outputBytes				=	bandInfo.dstRowBytes * numY;
+
+	if (binFactor == 1)
+	{
+		ImageKernel_CropRows(cCameraDataBuffer, bandInfo.srcPtr, bandInfo.srcRowBytes, bandInfo.dstRowBytes, numY);
+	}
+	else
+	{
+		if ((cSoftBinPool.dataPtr == NULL) || (cSoftBinPool.bufferSize < (size_t)outputBytes))
+		{
+			FrameAlloc_Free(&cSoftBinPool);
+			FrameAlloc_Allocate(&cSoftBinPool, outputBytes, gLockFrameBuffers);
+		}
+		if (cSoftBinPool.dataPtr != NULL)
+		{
+			bandInfo.dstPtr	=	cSoftBinPool.dataPtr;
+			ImageKernel_RunRowBands(numY, SoftBin_BandProc, &bandInfo);
+			memcpy(cCameraDataBuffer, cSoftBinPool.dataPtr, outputBytes);
+		}
+		else
+		{
+			CONSOLE_DEBUG("Failed to allocate the binning buffer, binning in place");
+			bandInfo.dstPtr	=	cCameraDataBuffer;
+			SoftBin_BandProc(&bandInfo, 0, numY);
+		}
+	}
+
+	//*	from here on, the frame is the binned sub frame
+	cLastExposure_ROIinfo.currentROIwidth	=	numX;
+	cLastExposure_ROIinfo.currentROIheight	=	numY;
+	cLastExposure_ROIinfo.currentROIbin		=	binFactor;
+	cSoftBinLast_ms							=	millis() - startMilliSecs;
+}
+
+//*****************************************************************************
+//*	the size of the frame in cCameraDataBuffer, after hardware or software binning.
+//*	Falls back to the sensor size for drivers that do not fill in cLastExposure_ROIinfo
+//*****************************************************************************
+void	CameraDriver::GetLastFrameSize(int *width, int *height)
+{
+	*width	=	cLastExposure_ROIinfo.currentROIwidth;
+	*height	=	cLastExposure_ROIinfo.currentROIheight;
+	if ((*width <= 0) || (*height <= 0) || (*width > cCameraProp.CameraXsize) || (*height > cCameraProp.CameraYsize))
+	{
+		*width	=	cCameraProp.CameraXsize;
+		*height	=	cCameraProp.CameraYsize;
+	}
+}
+
+//*****************************************************************************
+void	CameraDriver::SoftBin_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+	if (cSoftBinEnabled)
+	{
+		Get_SoftBinning(reqData, NULL, "softbinning");
+	}
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_SoftBinning(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cSoftBinEnabled,
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"softbinmode",
+									((cSoftBinMode == kBinMode_Average) ? "average" : "sum"),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"softbin_ms",
+									cSoftBinLast_ms,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	mode=sum|average
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_SoftBinning(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	if (cSoftBinEnabled == false)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "This camera does its own binning");
+	}
+	else if (GetKeyWordArgument(reqData->contentData, "Mode", argumentString, (sizeof(argumentString) -1)))
+	{
+		if (strcasecmp(argumentString, "sum") == 0)
+		{
+			cSoftBinMode	=	kBinMode_Sum;
+		}
+		else if (strcasecmp(argumentString, "average") == 0)
+		{
+			cSoftBinMode	=	kBinMode_Average;
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Mode must be 'sum' or 'average'");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'mode' not found");
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
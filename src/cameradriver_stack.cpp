@@ -0,0 +1,889 @@
+//**************************************************************************
+//*	Name:			cameradriver_stack.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Live stacking inside the camera driver
+//*
+//*					Each new frame is registered against a set of reference stars
+//*					from the first frame and added into a floating point accumulator.
+//*					Registration is a whole pixel translation, the median of the
+//*					centroid offsets of the reference stars.
+//*					For bayer RAW images the translation is rounded to an even number
+//*					so that the color pattern stays aligned.
+//*
+//*					Two accumulator modes
+//*						mean		simple running sum
+//*						sigma		sigma clipped, pixels that are further than N sigma
+//*									from the running mean are replaced by the mean
+//*
+//*					The accumulator buffers are allocated once for a given image size
+//*					and are only reallocated when the geometry or image type changes.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_stack.cpp
+//*	Oct 19,	2026	<MLS> Added LiveStack_AddFrame() & LiveStack_Register()
+//*	Oct 19,	2026	<MLS> Added Get_LiveStack(), Put_LiveStack() & Get_StackedImage()
+//*	Oct 19,	2026	<MLS> The buffers and counts are protected by cLiveStackMutex
+//*	Oct 19,	2026	<MLS> Get_StackedImage() bypasses the imagearray cache
+//*	Oct 19,	2026	<MLS> Get_StackedImage() sends a private copy, the lock is only held while copying
+//*	Oct 19,	2026	<MLS> The accumulator is double, float was not exact after 256 RAW16 frames
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<math.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+
+#define	kLiveStackGridSize		4		//*	reference stars are picked from a 4x4 grid
+#define	kLiveStackCentroidHalf	7		//*	15 x 15 centroid box
+#define	kLiveStackSearchRadius	32		//*	how far a star can move between frames
+#define	kLiveStackMinStars		3
+
+//*****************************************************************************
+typedef struct	//	TYPE_STACK_BAND
+{
+	double				*sumPtr;
+	double				*sumSqPtr;
+	const unsigned char	*srcPtr;
+	int					width;
+	int					height;
+	int					channels;
+	int					bytesPerValue;
+	int					deltaX;
+	int					deltaY;
+	double				invFrameCnt;
+	double				clipSigmaSqrd;
+} TYPE_STACK_BAND;
+
+//*****************************************************************************
+//*	called by ImageKernel_RunRowBands() for each band of rows
+//*	rows of the accumulator that have no source data get the current mean added
+//*****************************************************************************
+static void	LiveStack_BandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_STACK_BAND	*band;
+int				rowValues;
+int				yyy;
+int				srcRow;
+int				firstClm;
+int				lastClm;
+double			*sumRowPtr;
+double			*sqRowPtr;
+long			srcOffset;
+
+	band		=	(TYPE_STACK_BAND *)context;
+	rowValues	=	band->width * band->channels;
+
+	//*	the columns that have source data are the same for every row
+	firstClm	=	(band->deltaX < 0) ? -band->deltaX : 0;
+	lastClm		=	(band->deltaX > 0) ? (band->width - band->deltaX) : band->width;
+
+	for (yyy = firstRow; yyy < lastRow; yyy++)
+	{
+		sumRowPtr	=	band->sumPtr + ((long)yyy * rowValues);
+		sqRowPtr	=	(band->sumSqPtr != NULL) ? (band->sumSqPtr + ((long)yyy * rowValues)) : NULL;
+		srcRow		=	yyy + band->deltaY;
+
+		if ((srcRow < 0) || (srcRow >= band->height) || (lastClm <= firstClm))
+		{
+			ImageKernel_StackAddMean(sumRowPtr, sqRowPtr, rowValues, band->invFrameCnt);
+			continue;
+		}
+		if (firstClm > 0)
+		{
+			ImageKernel_StackAddMean(sumRowPtr, sqRowPtr, (firstClm * band->channels), band->invFrameCnt);
+		}
+
+		srcOffset	=	(((long)srcRow * band->width) + firstClm + band->deltaX) * band->channels;
+		if (band->bytesPerValue == 2)
+		{
+			ImageKernel_StackAdd_U16(	sumRowPtr + (firstClm * band->channels),
+										(sqRowPtr != NULL) ? (sqRowPtr + (firstClm * band->channels)) : NULL,
+										((const uint16_t *)band->srcPtr) + srcOffset,
+										((lastClm - firstClm) * band->channels),
+										band->invFrameCnt,
+										band->clipSigmaSqrd);
+		}
+		else
+		{
+			ImageKernel_StackAdd_U8(	sumRowPtr + (firstClm * band->channels),
+										(sqRowPtr != NULL) ? (sqRowPtr + (firstClm * band->channels)) : NULL,
+										band->srcPtr + srcOffset,
+										((lastClm - firstClm) * band->channels),
+										band->invFrameCnt,
+										band->clipSigmaSqrd);
+		}
+
+		if (lastClm < band->width)
+		{
+			ImageKernel_StackAddMean(	sumRowPtr + (lastClm * band->channels),
+										(sqRowPtr != NULL) ? (sqRowPtr + (lastClm * band->channels)) : NULL,
+										((band->width - lastClm) * band->channels),
+										band->invFrameCnt);
+		}
+	}
+}
+
+//*****************************************************************************
+static int	DoubleSort(const void *e1, const void *e2)
+{
+double	value1	=	*((const double *)e1);
+double	value2	=	*((const double *)e2);
+
+	if (value1 < value2)
+	{
+		return(-1);
+	}
+	else if (value1 > value2)
+	{
+		return(1);
+	}
+	return(0);
+}
+
+//*****************************************************************************
+static double	MedianOfList(double *valueList, int valueCnt)
+{
+	qsort(valueList, valueCnt, sizeof(double), DoubleSort);
+	if (valueCnt & 0x01)
+	{
+		return(valueList[valueCnt / 2]);
+	}
+	return((valueList[(valueCnt / 2) - 1] + valueList[valueCnt / 2]) / 2.0);
+}
+
+//*****************************************************************************
+//*	resets the stack, the buffers are kept for the next run
+//*****************************************************************************
+void	CameraDriver::LiveStack_Reset(void)
+{
+	CONSOLE_DEBUG(__FUNCTION__);
+	cLiveStackFrameCnt		=	0;
+	cLiveStackRejectCnt		=	0;
+	cLiveStackRefCnt		=	0;
+	cLiveStackLastDeltaX	=	0;
+	cLiveStackLastDeltaY	=	0;
+	cLiveStackLastAdd_ms	=	0;
+}
+
+//*****************************************************************************
+//*	must be called with cLiveStackMutex locked
+//*****************************************************************************
+void	CameraDriver::LiveStack_FreeBuffers(void)
+{
+	DISPOSEPTR_IF_INUSE(cLiveStackSum);
+	DISPOSEPTR_IF_INUSE(cLiveStackSumSq);
+	cLiveStackAllocCnt	=	0;
+}
+
+//*****************************************************************************
+//*	allocates the accumulator for the geometry in cLiveStackROIinfo
+//*	if the existing buffers are big enough they are reused
+//*	must be called with cLiveStackMutex locked
+//*****************************************************************************
+bool	CameraDriver::LiveStack_AllocateBuffers(void)
+{
+bool	allocOK;
+
+	if ((cLiveStackElementCnt > cLiveStackAllocCnt) || (cLiveStackSum == NULL))
+	{
+		LiveStack_FreeBuffers();
+		CONSOLE_DEBUG_W_LONG("Allocating live stack buffers, values\t=", cLiveStackElementCnt);
+		cLiveStackSum		=	(double *)malloc(cLiveStackElementCnt * sizeof(double));
+		cLiveStackAllocCnt	=	cLiveStackElementCnt;
+	}
+	if ((cLiveStackMode == kLiveStack_SigmaClip) && (cLiveStackSumSq == NULL) && (cLiveStackAllocCnt > 0))
+	{
+		cLiveStackSumSq		=	(double *)malloc(cLiveStackAllocCnt * sizeof(double));
+	}
+
+	allocOK	=	(cLiveStackSum != NULL);
+	if (cLiveStackMode == kLiveStack_SigmaClip)
+	{
+		allocOK	=	allocOK && (cLiveStackSumSq != NULL);
+	}
+	if (allocOK)
+	{
+		memset(cLiveStackSum, 0, (cLiveStackElementCnt * sizeof(double)));
+		if (cLiveStackSumSq != NULL)
+		{
+			memset(cLiveStackSumSq, 0, (cLiveStackElementCnt * sizeof(double)));
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG("Failed to allocate live stack buffers");
+		LiveStack_FreeBuffers();
+	}
+	return(allocOK);
+}
+
+//*****************************************************************************
+//*	returns the value used for registration, green for RGB images
+//*****************************************************************************
+uint32_t	CameraDriver::LiveStack_GetPixel(int xxx, int yyy)
+{
+long		pixelIndex;
+uint32_t	pixelValue;
+
+	pixelIndex	=	((long)yyy * cLiveStackROIinfo.currentROIwidth) + xxx;
+	switch(cLiveStackROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW16:
+			pixelValue	=	((uint16_t *)cCameraDataBuffer)[pixelIndex];
+			break;
+
+		case kImageType_RGB24:
+			//*	openCV order, BGR
+			pixelValue	=	cCameraDataBuffer[(pixelIndex * 3) + 1];
+			break;
+
+		default:
+			pixelValue	=	cCameraDataBuffer[pixelIndex];
+			break;
+	}
+	return(pixelValue);
+}
+
+//*****************************************************************************
+//*	background subtracted centroid in a box around the peak,
+//*	the background is the average of the pixels on the edge of the box
+//*****************************************************************************
+bool	CameraDriver::LiveStack_Centroid(int peakX, int peakY, TYPE_STACK_STAR *starInfo)
+{
+int		xxx;
+int		yyy;
+int		edgeCnt;
+double	edgeSum;
+double	background;
+double	pixValue;
+double	weightSum;
+double	xSum;
+double	ySum;
+double	peakValue;
+
+	if ((peakX < kLiveStackCentroidHalf) || (peakX >= (cLiveStackROIinfo.currentROIwidth - kLiveStackCentroidHalf)) ||
+		(peakY < kLiveStackCentroidHalf) || (peakY >= (cLiveStackROIinfo.currentROIheight - kLiveStackCentroidHalf)))
+	{
+		return(false);
+	}
+
+	edgeSum	=	0.0;
+	edgeCnt	=	0;
+	for (xxx = -kLiveStackCentroidHalf; xxx <= kLiveStackCentroidHalf; xxx++)
+	{
+		edgeSum	+=	LiveStack_GetPixel(peakX + xxx, peakY - kLiveStackCentroidHalf);
+		edgeSum	+=	LiveStack_GetPixel(peakX + xxx, peakY + kLiveStackCentroidHalf);
+		edgeCnt	+=	2;
+	}
+	for (yyy = (1 - kLiveStackCentroidHalf); yyy < kLiveStackCentroidHalf; yyy++)
+	{
+		edgeSum	+=	LiveStack_GetPixel(peakX - kLiveStackCentroidHalf, peakY + yyy);
+		edgeSum	+=	LiveStack_GetPixel(peakX + kLiveStackCentroidHalf, peakY + yyy);
+		edgeCnt	+=	2;
+	}
+	background	=	edgeSum / edgeCnt;
+
+	weightSum	=	0.0;
+	xSum		=	0.0;
+	ySum		=	0.0;
+	for (yyy = -kLiveStackCentroidHalf; yyy <= kLiveStackCentroidHalf; yyy++)
+	{
+		for (xxx = -kLiveStackCentroidHalf; xxx <= kLiveStackCentroidHalf; xxx++)
+		{
+			pixValue	=	LiveStack_GetPixel(peakX + xxx, peakY + yyy) - background;
+			if (pixValue > 0.0)
+			{
+				weightSum	+=	pixValue;
+				xSum		+=	pixValue * (peakX + xxx);
+				ySum		+=	pixValue * (peakY + yyy);
+			}
+		}
+	}
+	peakValue	=	LiveStack_GetPixel(peakX, peakY) - background;
+	if ((weightSum <= 0.0) || (peakValue <= 0.0))
+	{
+		return(false);
+	}
+	starInfo->xCenter	=	xSum / weightSum;
+	starInfo->yCenter	=	ySum / weightSum;
+	starInfo->starFlux	=	peakValue;
+	return(true);
+}
+
+//*****************************************************************************
+//*	picks the brightest star in each cell of a grid
+//*	stars are kept away from the edges so they can still be found after the image moves
+//*****************************************************************************
+int	CameraDriver::LiveStack_FindStars(void)
+{
+int				cellWidth;
+int				cellHeight;
+int				gridX;
+int				gridY;
+int				xxx;
+int				yyy;
+int				firstX;
+int				lastX;
+int				firstY;
+int				lastY;
+int				peakX;
+int				peakY;
+uint32_t		pixValue;
+uint32_t		peakValue;
+double			sampleSum;
+double			sampleSqSum;
+long			sampleCnt;
+double			mean;
+double			sigma;
+int				margin;
+TYPE_STACK_STAR	starInfo;
+
+	cLiveStackRefCnt	=	0;
+	margin				=	kLiveStackSearchRadius + kLiveStackCentroidHalf + 1;
+	cellWidth			=	cLiveStackROIinfo.currentROIwidth / kLiveStackGridSize;
+	cellHeight			=	cLiveStackROIinfo.currentROIheight / kLiveStackGridSize;
+
+	for (gridY = 0; gridY < kLiveStackGridSize; gridY++)
+	{
+		for (gridX = 0; gridX < kLiveStackGridSize; gridX++)
+		{
+			firstX	=	gridX * cellWidth;
+			lastX	=	firstX + cellWidth;
+			firstY	=	gridY * cellHeight;
+			lastY	=	firstY + cellHeight;
+			if (firstX < margin)
+			{
+				firstX	=	margin;
+			}
+			if (lastX > (cLiveStackROIinfo.currentROIwidth - margin))
+			{
+				lastX	=	cLiveStackROIinfo.currentROIwidth - margin;
+			}
+			if (firstY < margin)
+			{
+				firstY	=	margin;
+			}
+			if (lastY > (cLiveStackROIinfo.currentROIheight - margin))
+			{
+				lastY	=	cLiveStackROIinfo.currentROIheight - margin;
+			}
+			if ((lastX <= firstX) || (lastY <= firstY))
+			{
+				continue;
+			}
+
+			peakValue	=	0;
+			peakX		=	firstX;
+			peakY		=	firstY;
+			sampleSum	=	0.0;
+			sampleSqSum	=	0.0;
+			sampleCnt	=	0;
+			for (yyy = firstY; yyy < lastY; yyy++)
+			{
+				for (xxx = firstX; xxx < lastX; xxx++)
+				{
+					pixValue	=	LiveStack_GetPixel(xxx, yyy);
+					if (pixValue > peakValue)
+					{
+						peakValue	=	pixValue;
+						peakX		=	xxx;
+						peakY		=	yyy;
+					}
+					//*	the background statistics only need a sample
+					if (((xxx | yyy) & 0x03) == 0)
+					{
+						sampleSum	+=	pixValue;
+						sampleSqSum	+=	(double)pixValue * pixValue;
+						sampleCnt++;
+					}
+				}
+			}
+			if (sampleCnt > 0)
+			{
+				mean	=	sampleSum / sampleCnt;
+				sigma	=	sqrt(fabs((sampleSqSum / sampleCnt) - (mean * mean)));
+				if (sigma < 1.0)
+				{
+					sigma	=	1.0;
+				}
+				if ((peakValue > (mean + (8.0 * sigma))) && LiveStack_Centroid(peakX, peakY, &starInfo))
+				{
+					cLiveStackRefStars[cLiveStackRefCnt]	=	starInfo;
+					cLiveStackRefCnt++;
+					if (cLiveStackRefCnt >= kLiveStackMaxStars)
+					{
+						return(cLiveStackRefCnt);
+					}
+				}
+			}
+		}
+	}
+	CONSOLE_DEBUG_W_NUM("Live stack reference stars\t=", cLiveStackRefCnt);
+	return(cLiveStackRefCnt);
+}
+
+//*****************************************************************************
+//*	finds each reference star in the current frame and returns the median offset
+//*	returns false if not enough stars were found
+//*****************************************************************************
+bool	CameraDriver::LiveStack_Register(int *deltaX, int *deltaY)
+{
+double			deltaXlist[kLiveStackMaxStars];
+double			deltaYlist[kLiveStackMaxStars];
+int				matchCnt;
+int				starIdx;
+int				refX;
+int				refY;
+int				xxx;
+int				yyy;
+int				peakX;
+int				peakY;
+uint32_t		pixValue;
+uint32_t		peakValue;
+TYPE_STACK_STAR	starInfo;
+
+	matchCnt	=	0;
+	for (starIdx = 0; starIdx < cLiveStackRefCnt; starIdx++)
+	{
+		refX		=	lround(cLiveStackRefStars[starIdx].xCenter);
+		refY		=	lround(cLiveStackRefStars[starIdx].yCenter);
+		peakValue	=	0;
+		peakX		=	refX;
+		peakY		=	refY;
+		for (yyy = (refY - kLiveStackSearchRadius); yyy <= (refY + kLiveStackSearchRadius); yyy++)
+		{
+			for (xxx = (refX - kLiveStackSearchRadius); xxx <= (refX + kLiveStackSearchRadius); xxx++)
+			{
+				pixValue	=	LiveStack_GetPixel(xxx, yyy);
+				if (pixValue > peakValue)
+				{
+					peakValue	=	pixValue;
+					peakX		=	xxx;
+					peakY		=	yyy;
+				}
+			}
+		}
+		//*	make sure it is the same star and not just noise
+		if (LiveStack_Centroid(peakX, peakY, &starInfo) &&
+			(starInfo.starFlux > (0.3 * cLiveStackRefStars[starIdx].starFlux)))
+		{
+			deltaXlist[matchCnt]	=	starInfo.xCenter - cLiveStackRefStars[starIdx].xCenter;
+			deltaYlist[matchCnt]	=	starInfo.yCenter - cLiveStackRefStars[starIdx].yCenter;
+			matchCnt++;
+		}
+	}
+	if (matchCnt < kLiveStackMinStars)
+	{
+		CONSOLE_DEBUG_W_NUM("Not enough stars to register frame, matchCnt\t=", matchCnt);
+		return(false);
+	}
+	*deltaX	=	lround(MedianOfList(deltaXlist, matchCnt));
+	*deltaY	=	lround(MedianOfList(deltaYlist, matchCnt));
+	return(true);
+}
+
+//*****************************************************************************
+//*	called from the state machine after Read_ImageData() succeeds,
+//*	with cLiveStackMutex locked
+//*****************************************************************************
+void	CameraDriver::LiveStack_AddFrame(void)
+{
+TYPE_STACK_BAND	bandInfo;
+bool			newGeometry;
+bool			registrationOK;
+int				deltaX;
+int				deltaY;
+uint32_t		startMilliSecs;
+
+	if (cCameraDataBuffer == NULL)
+	{
+		return;
+	}
+	startMilliSecs	=	millis();
+	newGeometry		=	(cLiveStackROIinfo.currentROIwidth		!= cLastExposure_ROIinfo.currentROIwidth) ||
+						(cLiveStackROIinfo.currentROIheight		!= cLastExposure_ROIinfo.currentROIheight) ||
+						(cLiveStackROIinfo.currentROIimageType	!= cLastExposure_ROIinfo.currentROIimageType);
+
+	if ((cLiveStackFrameCnt == 0) || newGeometry)
+	{
+		//*	this is the first frame, it becomes the reference
+		LiveStack_Reset();
+		cLiveStackROIinfo		=	cLastExposure_ROIinfo;
+		cLiveStackElementCnt	=	(long)cLiveStackROIinfo.currentROIwidth * cLiveStackROIinfo.currentROIheight;
+		if (cLiveStackROIinfo.currentROIimageType == kImageType_RGB24)
+		{
+			cLiveStackElementCnt	*=	3;
+		}
+		if (LiveStack_AllocateBuffers() == false)
+		{
+			cLiveStackEnabled	=	false;
+			return;
+		}
+		LiveStack_FindStars();
+		deltaX	=	0;
+		deltaY	=	0;
+	}
+	else if (cLiveStackRefCnt >= kLiveStackMinStars)
+	{
+		registrationOK	=	LiveStack_Register(&deltaX, &deltaY);
+		if (registrationOK == false)
+		{
+			cLiveStackRejectCnt++;
+			return;
+		}
+	}
+	else
+	{
+		//*	no stars in the reference frame (daytime, planetary), stack without registration
+		deltaX	=	0;
+		deltaY	=	0;
+	}
+
+	//*	keep the bayer pattern aligned
+	if (cIsColorCam &&	((cLiveStackROIinfo.currentROIimageType == kImageType_RAW8) ||
+						(cLiveStackROIinfo.currentROIimageType == kImageType_RAW16)))
+	{
+		deltaX	=	2 * lround(deltaX / 2.0);
+		deltaY	=	2 * lround(deltaY / 2.0);
+	}
+	cLiveStackLastDeltaX	=	deltaX;
+	cLiveStackLastDeltaY	=	deltaY;
+
+	bandInfo.sumPtr			=	cLiveStackSum;
+	bandInfo.sumSqPtr		=	(cLiveStackMode == kLiveStack_SigmaClip) ? cLiveStackSumSq : NULL;
+	bandInfo.srcPtr			=	cCameraDataBuffer;
+	bandInfo.width			=	cLiveStackROIinfo.currentROIwidth;
+	bandInfo.height			=	cLiveStackROIinfo.currentROIheight;
+	bandInfo.channels		=	(cLiveStackROIinfo.currentROIimageType == kImageType_RGB24) ? 3 : 1;
+	bandInfo.bytesPerValue	=	(cLiveStackROIinfo.currentROIimageType == kImageType_RAW16) ? 2 : 1;
+	bandInfo.deltaX			=	deltaX;
+	bandInfo.deltaY			=	deltaY;
+	bandInfo.invFrameCnt	=	(cLiveStackFrameCnt > 0) ? (1.0 / cLiveStackFrameCnt) : 0.0;
+	bandInfo.clipSigmaSqrd	=	0.0;
+	//*	need a few frames before the variance means anything
+	if ((cLiveStackMode == kLiveStack_SigmaClip) && (cLiveStackFrameCnt >= 3))
+	{
+		bandInfo.clipSigmaSqrd	=	cLiveStackSigma * cLiveStackSigma;
+	}
+
+	ImageKernel_RunRowBands(bandInfo.height, LiveStack_BandProc, &bandInfo);
+	cLiveStackFrameCnt++;
+
+	cLiveStackLastAdd_ms	=	millis() - startMilliSecs;
+	if (gVerbose)
+	{
+		CONSOLE_DEBUG_W_NUM("Live stack frame count\t=", cLiveStackFrameCnt);
+		CONSOLE_DEBUG_W_NUM("Live stack add time (ms)\t=", cLiveStackLastAdd_ms);
+	}
+}
+
+//*****************************************************************************
+//*	converts the accumulator to the mean image in the same format as the camera data
+//*	outputPtr has to hold cLiveStackElementCnt values
+//*	must be called with cLiveStackMutex locked
+//*****************************************************************************
+void	CameraDriver::LiveStack_RenderOutput(unsigned char *outputPtr)
+{
+double	invFrameCnt;
+
+	if ((outputPtr != NULL) && (cLiveStackSum != NULL) && (cLiveStackFrameCnt > 0))
+	{
+		invFrameCnt	=	1.0 / cLiveStackFrameCnt;
+		if (cLiveStackROIinfo.currentROIimageType == kImageType_RAW16)
+		{
+			ImageKernel_ScaleToU16((uint16_t *)outputPtr, cLiveStackSum, cLiveStackElementCnt, invFrameCnt);
+		}
+		else
+		{
+			ImageKernel_ScaleToU8(outputPtr, cLiveStackSum, cLiveStackElementCnt, invFrameCnt);
+		}
+	}
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_LiveStack(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cLiveStackEnabled,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	livestack=true starts a new stack, livestack=false stops adding frames
+//*	the stacked image is still available after it is stopped
+//*		mode=mean|sigma
+//*		sigma=FLOAT
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_LiveStack(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+bool				newLiveStackState;
+double				newSigma;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Mode",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			if (strcasecmp(argumentString, "mean") == 0)
+			{
+				cLiveStackMode	=	kLiveStack_Mean;
+			}
+			else if (strcasecmp(argumentString, "sigma") == 0)
+			{
+				cLiveStackMode	=	kLiveStack_SigmaClip;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid mode, must be mean or sigma");
+			}
+		}
+
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"Sigma",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			newSigma	=	atof(argumentString);
+			if ((newSigma >= 1.0) && (newSigma <= 10.0))
+			{
+				cLiveStackSigma	=	newSigma;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Invalid sigma, must be 1.0 to 10.0");
+			}
+		}
+
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"LiveStack",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord && (alpacaErrCode == kASCOM_Err_Success))
+		{
+			newLiveStackState	=	IsTrueFalse(argumentString);
+			if (newLiveStackState)
+			{
+				//*	the next frame starts a new stack
+				pthread_mutex_lock(&cLiveStackMutex);
+				LiveStack_Reset();
+				pthread_mutex_unlock(&cLiveStackMutex);
+			}
+			cLiveStackEnabled	=	newLiveStackState;
+		}
+		else if (foundKeyWord == false)
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'livestack' not found");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	sends the stacked image using the same formats as imagearray.
+//*	Commands run in the listen thread and the state machine in the main thread,
+//*	the mean image is rendered into a private buffer with cLiveStackMutex locked,
+//*	it is sent after the lock is released so a slow client never holds up a frame.
+//*	The stack is not the current frame, so it does not go through the imagearray cache
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_StackedImage(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+unsigned char		*stackImage;
+TYPE_IMAGE_ROI_Info	stackROIinfo;
+int					stackFrameCnt;
+int					bytesPerValue;
+uint8_t				*responseBuffer;
+size_t				responseLen;
+char				httpHeader[500];
+
+	CONSOLE_DEBUG(__FUNCTION__);
+
+	stackImage		=	NULL;
+	stackFrameCnt	=	0;
+	pthread_mutex_lock(&cLiveStackMutex);
+	if ((cLiveStackFrameCnt > 0) && (cLiveStackSum != NULL))
+	{
+		stackROIinfo	=	cLiveStackROIinfo;
+		stackFrameCnt	=	cLiveStackFrameCnt;
+		bytesPerValue	=	(stackROIinfo.currentROIimageType == kImageType_RAW16) ? 2 : 1;
+		stackImage		=	(unsigned char *)malloc(cLiveStackElementCnt * bytesPerValue);
+		LiveStack_RenderOutput(stackImage);
+	}
+	pthread_mutex_unlock(&cLiveStackMutex);
+
+	if (stackImage == NULL)
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidOperation;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, (stackFrameCnt > 0) ? "Failed to allocate memory" : "No stacked image available");
+		JsonResponse_FinishHeader(httpHeader, "");
+		JsonResponse_SendTextBuffer(reqData->socket, httpHeader);
+	}
+	else if (strcasestr(reqData->htmlData, "application/imagebytes") != NULL)
+	{
+		cResponseIsJSON	=	false;
+		responseBuffer	=	BuildImageBytesResponse(stackImage,
+													&stackROIinfo,
+													(reqData->cHTTPclientType == kHTTPclient_AlpacaPi),
+													&responseLen);
+		if (responseBuffer != NULL)
+		{
+			if (ImageCache_Write(reqData->socket, responseBuffer, responseLen) != responseLen)
+			{
+				CONSOLE_DEBUG("Failed to send the stacked image");
+			}
+			free(responseBuffer);
+		}
+		else
+		{
+			alpacaErrCode	=	kASCOM_Err_InternalError;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Failed to build the stacked image");
+		}
+	}
+	else
+	{
+		LiveStack_SendJSON(reqData, stackImage, &stackROIinfo, stackFrameCnt);
+	}
+	free(stackImage);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	the imagearray JSON for the stacked image, the same layout as Get_Imagearray_JSON()
+//*****************************************************************************
+void	CameraDriver::LiveStack_SendJSON(	TYPE_GetPutRequestData		*reqData,
+											unsigned char				*stackImage,
+											const TYPE_IMAGE_ROI_Info	*stackROIinfo,
+											const int					stackFrameCnt)
+{
+int		mySocket;
+int		pixelCount;
+char	httpHeader[500];
+
+	mySocket	=	reqData->socket;
+	JsonResponse_FinishHeader(httpHeader, "");
+	JsonResponse_SendTextBuffer(mySocket, httpHeader);
+
+	pixelCount	=	stackROIinfo->currentROIwidth * stackROIinfo->currentROIheight;
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"xsize",
+									stackROIinfo->currentROIwidth,
+									INCLUDE_COMMA);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"ysize",
+									stackROIinfo->currentROIheight,
+									INCLUDE_COMMA);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"framecount",
+									stackFrameCnt,
+									INCLUDE_COMMA);
+	//*	Type = 2  >> 32 bit interger
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"Type",
+									2,
+									INCLUDE_COMMA);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"Rank",
+									((stackROIinfo->currentROIimageType == kImageType_RGB24) ? 3 : 2),
+									INCLUDE_COMMA);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									gValueString);
+	JsonResponse_SendTextBuffer(mySocket, reqData->jsonTextBuffer);
+
+	switch(stackROIinfo->currentROIimageType)
+	{
+		case kImageType_RAW16:
+			Send_imagearray_raw16(	mySocket,
+									(uint16_t *)stackImage,
+									stackROIinfo->currentROIheight,		//*	# of rows
+									stackROIinfo->currentROIwidth,		//*	# of columns
+									pixelCount);
+			break;
+
+		case kImageType_RGB24:
+			Send_imagearray_rgb24(	mySocket,
+									stackImage,
+									stackROIinfo->currentROIheight,		//*	# of rows
+									stackROIinfo->currentROIwidth,		//*	# of columns
+									pixelCount);
+			break;
+
+		default:
+			Send_imagearray_raw8(	mySocket,
+									stackImage,
+									stackROIinfo->currentROIheight,		//*	# of rows
+									stackROIinfo->currentROIwidth,		//*	# of columns
+									pixelCount);
+			break;
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	mySocket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+}
+
+#endif // _ENABLE_CAMERA_
@@ -0,0 +1,309 @@
+//**************************************************************************
+//*	Name:			cameradriver_stars.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Star detection, HFR and FWHM of each frame
+//*
+//*					The work is done by StarAnalysis_ProcessImage() (star_analysis.c),
+//*					this file connects it to the camera driver.
+//*					The results are reported in readall, in the FITS header and
+//*					are passed to observing conditions (StarFWHM) through gEnvData
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_stars.cpp
+//*	Oct 19,	2026	<MLS> Autofocus frames are not passed to observing conditions
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<sys/time.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+#include	"star_analysis.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+#include	"obsconditions_globals.h"
+
+
+//*****************************************************************************
+//*	arc seconds per pixel, 0 if the telescope focal length or pixel size is not known
+//*****************************************************************************
+double	CameraDriver::StarAnalysis_GetPixelScale(void)
+{
+double	pixelScale;
+
+	pixelScale	=	0.0;
+	if ((cTS_info.focalLen_mm > 0.0) && (cCameraProp.PixelSizeX > 0.0))
+	{
+		pixelScale	=	(206.265 * cCameraProp.PixelSizeX * cCameraProp.BinX) / cTS_info.focalLen_mm;
+	}
+	return(pixelScale);
+}
+
+//*****************************************************************************
+//*	called from the state machine after the frame has been calibrated
+//*****************************************************************************
+bool	CameraDriver::StarAnalysis_ProcessFrame(void)
+{
+TYPE_STAR_IMAGE	starImage;
+double			pixelScale;
+bool			analysisOK;
+
+	if (cCameraDataBuffer == NULL)
+	{
+		return(false);
+	}
+	if (cStarResults == NULL)
+	{
+		cStarResults	=	(TYPE_STAR_RESULTS *)calloc(1, sizeof(TYPE_STAR_RESULTS));
+		if (cStarResults == NULL)
+		{
+			CONSOLE_DEBUG("Failed to allocate star results");
+			return(false);
+		}
+	}
+
+	memset(&starImage, 0, sizeof(TYPE_STAR_IMAGE));
+	starImage.imageData			=	cCameraDataBuffer;
+	starImage.width				=	cLastExposure_ROIinfo.currentROIwidth;
+	starImage.height			=	cLastExposure_ROIinfo.currentROIheight;
+	starImage.sigmaThreshold	=	cStarSigma;
+	switch(cLastExposure_ROIinfo.currentROIimageType)
+	{
+		case kImageType_RAW16:
+			starImage.bytesPerValue		=	2;
+			starImage.valuesPerPixel	=	1;
+			starImage.saturationValue	=	0.98 * 65535;
+			break;
+
+		case kImageType_RGB24:
+			//*	BGR, green is used
+			starImage.bytesPerValue		=	1;
+			starImage.valuesPerPixel	=	3;
+			starImage.channel			=	1;
+			starImage.saturationValue	=	250;
+			break;
+
+		default:
+			starImage.bytesPerValue		=	1;
+			starImage.valuesPerPixel	=	1;
+			starImage.saturationValue	=	250;
+			break;
+	}
+
+	analysisOK	=	StarAnalysis_ProcessImage(&starImage, cStarResults);
+	if (analysisOK && (cStarResults->starCount > 0))
+	{
+		if (gVerbose)
+		{
+			CONSOLE_DEBUG_W_NUM("starCount\t=", cStarResults->starCount);
+			CONSOLE_DEBUG_W_DBL("medianHFR\t=", cStarResults->medianHFR);
+			CONSOLE_DEBUG_W_NUM("process ms\t=", cStarResults->processTime_ms);
+		}
+
+		//*	observing conditions wants the FWHM in arc seconds
+		//*	autofocus frames are out of focus on purpose, they say nothing about the seeing
+		pixelScale	=	StarAnalysis_GetPixelScale();
+		if ((pixelScale > 0.0) && (cStarResults->medianFWHM > 0.0) && (AutoFocus_IsActive() == false))
+		{
+			gEnvData.seeingDataValid	=	true;
+			gEnvData.starFWHM_arcsec	=	cStarResults->medianFWHM * pixelScale;
+			gEnvData.starHFR_pixels		=	cStarResults->medianHFR;
+			gEnvData.starCount			=	cStarResults->starCount;
+			strcpy(gEnvData.seeingDataSource, cCommonProp.Name);
+			gettimeofday(&gEnvData.seeingLastUpdate, NULL);
+		}
+	}
+	return(analysisOK);
+}
+
+//*****************************************************************************
+void	CameraDriver::StarAnalysis_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+bool	resultsValid;
+
+	Get_StarAnalysis(reqData, NULL, "staranalysis");
+
+	resultsValid	=	cStarAnalysisEnabled && (cStarResults != NULL) && cStarResults->valid;
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"starcount",
+									(resultsValid ? cStarResults->starCount : 0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"starhfr",
+									(resultsValid ? cStarResults->medianHFR : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"starfwhm",
+									(resultsValid ? cStarResults->medianFWHM : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Double(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"stareccentricity",
+									(resultsValid ? cStarResults->medianEccentricity : 0.0),
+									INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"staranalysis_ms",
+									(resultsValid ? cStarResults->processTime_ms : 0),
+									INCLUDE_COMMA);
+}
+
+#ifdef _ENABLE_FITS_
+//*****************************************************************************
+void	CameraDriver::StarAnalysis_WriteFITS(fitsfile *fitsFilePtr)
+{
+int		fitsStatus;
+int		starCount;
+double	fitsValue;
+double	pixelScale;
+
+	if ((cStarAnalysisEnabled == false) || (cStarResults == NULL) || (cStarResults->valid == false))
+	{
+		return;
+	}
+	starCount	=	cStarResults->starCount;
+	fitsStatus	=	0;
+	fits_write_key(fitsFilePtr, TINT,		"STARCNT",
+											&starCount,
+											"Number of stars detected", &fitsStatus);
+	if (starCount > 0)
+	{
+		fitsValue	=	cStarResults->medianHFR;
+		fitsStatus	=	0;
+		fits_write_key(fitsFilePtr, TDOUBLE,	"HFR",
+												&fitsValue,
+												"Median half flux radius (pixels)", &fitsStatus);
+
+		fitsValue	=	cStarResults->medianFWHM;
+		fitsStatus	=	0;
+		fits_write_key(fitsFilePtr, TDOUBLE,	"FWHM",
+												&fitsValue,
+												"Median star FWHM (pixels)", &fitsStatus);
+
+		pixelScale	=	StarAnalysis_GetPixelScale();
+		if (pixelScale > 0.0)
+		{
+			fitsValue	=	cStarResults->medianFWHM * pixelScale;
+			fitsStatus	=	0;
+			fits_write_key(fitsFilePtr, TDOUBLE,	"FWHMASEC",
+													&fitsValue,
+													"Median star FWHM (arcsec)", &fitsStatus);
+		}
+
+		fitsValue	=	cStarResults->medianEccentricity;
+		fitsStatus	=	0;
+		fits_write_key(fitsFilePtr, TDOUBLE,	"ECCENTR",
+												&fitsValue,
+												"Median star eccentricity", &fitsStatus);
+	}
+}
+#endif // _ENABLE_FITS_
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_StarAnalysis(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									cStarAnalysisEnabled,
+									INCLUDE_COMMA);
+
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	staranalysis=BOOL
+//*	sigma=FLOAT	(optional)
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_StarAnalysis(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+bool				foundKeyWord;
+bool				sigmaFound;
+double				newSigma;
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData != NULL)
+	{
+		sigmaFound		=	GetKeyWordArgument(	reqData->contentData,
+												"Sigma",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (sigmaFound)
+		{
+			newSigma	=	atof(argumentString);
+			if ((newSigma >= 2.0) && (newSigma <= 50.0))
+			{
+				cStarSigma	=	newSigma;
+			}
+			else
+			{
+				alpacaErrCode	=	kASCOM_Err_InvalidValue;
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Sigma must be between 2 and 50");
+			}
+		}
+
+		foundKeyWord	=	GetKeyWordArgument(	reqData->contentData,
+												"StarAnalysis",
+												argumentString,
+												(sizeof(argumentString) -1));
+		if (foundKeyWord)
+		{
+			cStarAnalysisEnabled	=	IsTrueFalse(argumentString);
+		}
+		else if (sigmaFound == false)
+		{
+			alpacaErrCode	=	kASCOM_Err_InvalidValue;
+			GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'staranalysis' not found");
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InternalError;
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
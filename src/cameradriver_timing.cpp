@@ -0,0 +1,430 @@
+//**************************************************************************
+//*	Name:			cameradriver_timing.cpp
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Per stage timing of the capture pipeline
+//*
+//*					Each exposure gets a record with the time spent in each stage,
+//*					from the start of the exposure to the end of the first imagearray
+//*					send to a client. The last kPipelineTiming_RingSize records are kept.
+//*					Recording is a clock_gettime() per stage, the percentiles are only
+//*					computed when asked for, so this is always on.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created cameradriver_timing.cpp
+//*****************************************************************************
+
+#ifdef _ENABLE_CAMERA_
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"JsonResponse.h"
+#include	"helper_functions.h"
+
+#include	"alpacadriver.h"
+#include	"alpacadriver_helper.h"
+#include	"cameradriver.h"
+
+//*****************************************************************************
+//*	the summaries have 2 more rows than there are stages
+#define	kPipeSummary_Latency	(kPipeStage_Last)		//*	end of exposure to delivered
+#define	kPipeSummary_Total		(kPipeStage_Last + 1)	//*	start of exposure to delivered
+#define	kPipeSummary_Count		(kPipeStage_Last + 2)
+
+//*****************************************************************************
+//*	same order as kPipeStage_xxx, then the summaries
+static const char	*gPipeStageNames[]	=
+{
+	"exposure",
+	"readout",
+	"analysis",
+	"overlay",
+	"save",
+	"serialize",
+	"send",
+	"latency",
+	"total"
+};
+
+//*****************************************************************************
+uint64_t	PipelineTiming_Now_us(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return(((uint64_t)timeNow.tv_sec * 1000000) + (timeNow.tv_nsec / 1000));
+}
+
+//*****************************************************************************
+static uint32_t	ElapsedMicroSecs(const uint64_t startTime_us, const uint64_t endTime_us)
+{
+	if ((startTime_us == 0) || (endTime_us < startTime_us))
+	{
+		return(0);
+	}
+	return((uint32_t)(endTime_us - startTime_us));
+}
+
+//*****************************************************************************
+static int	CompareUInt32(const void *valuePtr1, const void *valuePtr2)
+{
+uint32_t	value1	=	*((const uint32_t *)valuePtr1);
+uint32_t	value2	=	*((const uint32_t *)valuePtr2);
+
+	return((value1 > value2) - (value1 < value2));
+}
+
+//*****************************************************************************
+//*	returns false if the record does not have a value for this stage (yet)
+//*****************************************************************************
+static bool	GetStageValue(const TYPE_PIPELINE_TIMING *timingRec, const int stage, uint32_t *stageValue)
+{
+	if ((timingRec->frameNumber <= 0) || (timingRec->processed == false))
+	{
+		return(false);
+	}
+	switch(stage)
+	{
+		case kPipeStage_Serialize:
+		case kPipeStage_Send:
+		case kPipeSummary_Latency:
+			if (timingRec->delivery_us == 0)
+			{
+				return(false);
+			}
+			*stageValue	=	((stage == kPipeSummary_Latency) ? timingRec->delivery_us : timingRec->stage_us[stage]);
+			break;
+
+		case kPipeSummary_Total:
+			if ((timingRec->delivery_us == 0) || (timingRec->exposureStart_us == 0))
+			{
+				return(false);
+			}
+			*stageValue	=	timingRec->stage_us[kPipeStage_Exposure] + timingRec->delivery_us;
+			break;
+
+		default:
+			*stageValue	=	timingRec->stage_us[stage];
+			break;
+	}
+	return(true);
+}
+
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_Reset(void)
+{
+	memset(cPipeTiming, 0, sizeof(cPipeTiming));
+	cPipeTimingIdx		=	0;
+	cPipeTimingCount	=	0;
+}
+
+//*****************************************************************************
+//*	called just before Start_CameraExposure()
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_ExposureStart(void)
+{
+	if (cPipeTimingCount > 0)
+	{
+		cPipeTimingIdx	=	(cPipeTimingIdx + 1) % kPipelineTiming_RingSize;
+	}
+	cPipeTimingCount++;
+	memset(&cPipeTiming[cPipeTimingIdx], 0, sizeof(TYPE_PIPELINE_TIMING));
+	cPipeTiming[cPipeTimingIdx].exposureStart_us	=	PipelineTiming_Now_us();
+}
+
+//*****************************************************************************
+//*	the end of the exposure stage also assigns the frame number to the record,
+//*	the other stages pass the time they started
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_StageDone(const int stage, const uint64_t stageStart_us)
+{
+TYPE_PIPELINE_TIMING	*timingRec;
+uint64_t				timeNow_us;
+
+	if ((stage < 0) || (stage >= kPipeStage_Last))
+	{
+		return;
+	}
+	timeNow_us	=	PipelineTiming_Now_us();
+	if (stage == kPipeStage_Exposure)
+	{
+		//*	this exposure was not started through PipelineTiming_ExposureStart()
+		if ((cPipeTimingCount == 0) || (cPipeTiming[cPipeTimingIdx].frameNumber != 0))
+		{
+			PipelineTiming_ExposureStart();
+			cPipeTiming[cPipeTimingIdx].exposureStart_us	=	0;
+		}
+		timingRec					=	&cPipeTiming[cPipeTimingIdx];
+		timingRec->frameNumber		=	cFramesRead;
+		timingRec->exposureEnd_us	=	timeNow_us;
+		timingRec->stage_us[stage]	=	ElapsedMicroSecs(timingRec->exposureStart_us, timeNow_us);
+	}
+	else if (cPipeTimingCount > 0)
+	{
+		timingRec					=	&cPipeTiming[cPipeTimingIdx];
+		timingRec->stage_us[stage]	+=	ElapsedMicroSecs(stageStart_us, timeNow_us);
+		if (stage == kPipeStage_Save)
+		{
+			timingRec->processed	=	true;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	called from Get_Imagearray_Binary() after the data has been sent,
+//*	only the first download of a frame is recorded
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_Delivered(const uint64_t serializeStart_us, const uint64_t sendStart_us)
+{
+TYPE_PIPELINE_TIMING	*timingRec;
+uint64_t				timeNow_us;
+int						recIdx;
+int						iii;
+
+	timeNow_us	=	PipelineTiming_Now_us();
+	recIdx		=	cPipeTimingIdx;
+	for (iii=0; iii<kPipelineTiming_RingSize; iii++)
+	{
+		timingRec	=	&cPipeTiming[recIdx];
+		if (timingRec->frameNumber == cFramesRead)
+		{
+			if (timingRec->processed && (timingRec->delivery_us == 0))
+			{
+				timingRec->stage_us[kPipeStage_Serialize]	=	ElapsedMicroSecs(serializeStart_us, sendStart_us);
+				timingRec->stage_us[kPipeStage_Send]		=	ElapsedMicroSecs(sendStart_us, timeNow_us);
+				timingRec->delivery_us						=	ElapsedMicroSecs(timingRec->exposureEnd_us, timeNow_us);
+			}
+			break;
+		}
+		recIdx	=	(recIdx + kPipelineTiming_RingSize - 1) % kPipelineTiming_RingSize;
+	}
+}
+
+//*****************************************************************************
+//*	returns the number of records that have this stage
+//*****************************************************************************
+int	CameraDriver::PipelineTiming_GetPercentiles(const int	stage,
+												uint32_t	*p50,
+												uint32_t	*p90,
+												uint32_t	*p99,
+												uint32_t	*maxValue)
+{
+uint32_t	stageValues[kPipelineTiming_RingSize];
+int			valueCnt;
+int			iii;
+
+	valueCnt	=	0;
+	for (iii=0; iii<kPipelineTiming_RingSize; iii++)
+	{
+		if (GetStageValue(&cPipeTiming[iii], stage, &stageValues[valueCnt]))
+		{
+			valueCnt++;
+		}
+	}
+	*p50		=	0;
+	*p90		=	0;
+	*p99		=	0;
+	*maxValue	=	0;
+	if (valueCnt > 0)
+	{
+		qsort(stageValues, valueCnt, sizeof(uint32_t), CompareUInt32);
+		//*	nearest rank
+		*p50		=	stageValues[((50 * (valueCnt - 1)) + 50) / 100];
+		*p90		=	stageValues[((90 * (valueCnt - 1)) + 50) / 100];
+		*p99		=	stageValues[((99 * (valueCnt - 1)) + 50) / 100];
+		*maxValue	=	stageValues[valueCnt - 1];
+	}
+	return(valueCnt);
+}
+
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_OutputReadall(TYPE_GetPutRequestData *reqData)
+{
+uint32_t	p50;
+uint32_t	p90;
+uint32_t	p99;
+uint32_t	maxValue;
+
+	PipelineTiming_GetPercentiles(kPipeSummary_Latency, &p50, &p90, &p99, &maxValue);
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pipelinelatency_p50_us",
+									p50,
+									INCLUDE_COMMA);
+}
+
+//*****************************************************************************
+//*	table of the percentiles for the setup page
+//*****************************************************************************
+void	CameraDriver::PipelineTiming_OutputHTML(TYPE_GetPutRequestData *reqData)
+{
+int			mySocketFD;
+char		lineBuff[256];
+uint32_t	p50;
+uint32_t	p90;
+uint32_t	p99;
+uint32_t	maxValue;
+int			valueCnt;
+int			stage;
+
+	mySocketFD	=	reqData->socket;
+
+	SocketWriteData(mySocketFD,	"<CENTER>\r\n");
+	SocketWriteData(mySocketFD,	"<H2>Capture pipeline timing (milliseconds)</H2>\r\n");
+	SocketWriteData(mySocketFD,	"<TABLE BORDER=1>\r\n");
+	SocketWriteData(mySocketFD,	"<TR><TH>Stage</TH><TH>Frames</TH><TH>p50</TH><TH>p90</TH><TH>p99</TH><TH>Max</TH></TR>\r\n");
+	for (stage=0; stage<kPipeSummary_Count; stage++)
+	{
+		valueCnt	=	PipelineTiming_GetPercentiles(stage, &p50, &p90, &p99, &maxValue);
+		sprintf(lineBuff,	"<TR><TD>%s</TD><TD>%d</TD><TD>%1.3f</TD><TD>%1.3f</TD><TD>%1.3f</TD><TD>%1.3f</TD></TR>\r\n",
+							gPipeStageNames[stage],
+							valueCnt,
+							(p50 / 1000.0),
+							(p90 / 1000.0),
+							(p99 / 1000.0),
+							(maxValue / 1000.0));
+		SocketWriteData(mySocketFD,	lineBuff);
+	}
+	SocketWriteData(mySocketFD,	"</TABLE>\r\n");
+	SocketWriteData(mySocketFD,	"</CENTER>\r\n");
+}
+
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Get_PipelineTiming(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS		alpacaErrCode	=	kASCOM_Err_Success;
+char					lineBuff[256];
+uint32_t				p50;
+uint32_t				p90;
+uint32_t				p99;
+uint32_t				maxValue;
+int						valueCnt;
+int						stage;
+int						recIdx;
+int						recCnt;
+int						iii;
+TYPE_PIPELINE_TIMING	*timingRec;
+
+	recCnt	=	cPipeTimingCount;
+	if (recCnt > kPipelineTiming_RingSize)
+	{
+		recCnt	=	kPipelineTiming_RingSize;
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									responseString,
+									recCnt,
+									INCLUDE_COMMA);
+
+	//*	percentiles of each stage
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pipelinestages");
+	for (stage=0; stage<kPipeSummary_Count; stage++)
+	{
+		valueCnt	=	PipelineTiming_GetPercentiles(stage, &p50, &p90, &p99, &maxValue);
+		sprintf(lineBuff, "{\"stage\":\"%s\",\"count\":%d,\"p50_us\":%u,\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u}%s",
+							gPipeStageNames[stage],
+							valueCnt,
+							p50,
+							p90,
+							p99,
+							maxValue,
+							((stage < (kPipeSummary_Count - 1)) ? "," : ""));
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										lineBuff);
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+
+	//*	the records, oldest first
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									"pipelineframes");
+	recIdx	=	(cPipeTimingIdx + kPipelineTiming_RingSize - (recCnt - 1)) % kPipelineTiming_RingSize;
+	for (iii=0; iii<recCnt; iii++)
+	{
+		timingRec	=	&cPipeTiming[recIdx];
+		sprintf(lineBuff, "{\"frame\":%ld,\"exposure_us\":%u,\"readout_us\":%u,\"analysis_us\":%u,\"overlay_us\":%u,\"save_us\":%u,\"serialize_us\":%u,\"send_us\":%u,\"latency_us\":%u}%s",
+							timingRec->frameNumber,
+							timingRec->stage_us[kPipeStage_Exposure],
+							timingRec->stage_us[kPipeStage_Readout],
+							timingRec->stage_us[kPipeStage_Analysis],
+							timingRec->stage_us[kPipeStage_Overlay],
+							timingRec->stage_us[kPipeStage_Save],
+							timingRec->stage_us[kPipeStage_Serialize],
+							timingRec->stage_us[kPipeStage_Send],
+							timingRec->delivery_us,
+							((iii < (recCnt - 1)) ? "," : ""));
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+										reqData->jsonTextBuffer,
+										kMaxJsonBuffLen,
+										lineBuff);
+		recIdx	=	(recIdx + 1) % kPipelineTiming_RingSize;
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+									reqData->jsonTextBuffer,
+									kMaxJsonBuffLen,
+									INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
+//*****************************************************************************
+//*	reset=BOOL
+//*****************************************************************************
+TYPE_ASCOM_STATUS	CameraDriver::Put_PipelineTiming(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				argumentString[32];
+
+	CONSOLE_DEBUG(__FUNCTION__);
+	if (reqData == NULL)
+	{
+		return(kASCOM_Err_InternalError);
+	}
+	if (GetKeyWordArgument(reqData->contentData, "Reset", argumentString, (sizeof(argumentString) -1)))
+	{
+		if (IsTrueFalse(argumentString))
+		{
+			PipelineTiming_Reset();
+		}
+	}
+	else
+	{
+		alpacaErrCode	=	kASCOM_Err_InvalidValue;
+		GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, "Keyword 'reset' not found");
+	}
+	return(alpacaErrCode);
+}
+
+#endif // _ENABLE_CAMERA_
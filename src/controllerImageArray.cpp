@@ -26,6 +26,11 @@
 //*	May 18,	2022	<MLS> Added AlpacaGetImageArray_Binary_Int32()
 //*	Feb 19,	2023	<MLS> Added AlpacaGetImageArray_Binary_Int16()
 //*	Feb 19,	2023	<MLS> Changed byte order in 32 bit integer image read
+//*	Oct 19,	2026	<MLS> Added AlpacaGetImageArray_Binary_Packed() for packed 12/14 bit data
+//*	Oct 19,	2026	<MLS> Added AlpacaGetImageArray_Binary_Inflate() for compressed data
+//*	Oct 19,	2026	<MLS> Moved the TransmissionElementType switch to AlpacaGetImageArray_Binary_Block()
+//*	Oct 19,	2026	<MLS> Added AlpacaGetImageArray_Binary_Resume(), interrupted downloads are resumed
+//*	Oct 19,	2026	<MLS> Elements split between two recv() blocks are now decoded correctly
 //*****************************************************************************
 
 #include	<string.h>
@@ -47,11 +52,13 @@
 
 #include	"alpaca_defs.h"
 #include	"helper_functions.h"
+#include	"image_kernels.h"
 
 #include	"controller.h"
 #include	"controller_camera.h"
 
 #define		kImageArrayBuffSize	15000
+#define		kMaxResumeCount		5
 
 
 
@@ -154,6 +161,28 @@ char	*argumentPtr;
 			strcpy(httpHdrStruct->ContentLengthStr, argumentPtr);
 			httpHdrStruct->contentLength	=	atoi(argumentPtr);
 		}
+		else if (strncasecmp(httpHeaderLine,	"HTTP/", 5) == 0)
+		{
+			//*	HTTP/1.0 206 Partial Content
+			argumentPtr	=	strchr(httpHeaderLine, 0x20);
+			if (argumentPtr != NULL)
+			{
+				httpHdrStruct->httpStatus	=	atoi(argumentPtr);
+			}
+		}
+		else if (strncasecmp(httpHeaderLine,	"ETag:", 5) == 0)
+		{
+			strncpy(httpHdrStruct->entityTag, argumentPtr, (sizeof(httpHdrStruct->entityTag) - 1));
+			httpHdrStruct->entityTag[sizeof(httpHdrStruct->entityTag) - 1]	=	0;
+		}
+		else if (strncasecmp(httpHeaderLine,	"Content-Range:", 14) == 0)
+		{
+			//*	bytes 1000-4999/5000
+			if (strncasecmp(argumentPtr, "bytes ", 6) == 0)
+			{
+				httpHdrStruct->contentRangeStart	=	atol(argumentPtr + 6);
+			}
+		}
 	}
 	else
 	{
@@ -700,6 +729,408 @@ uint32_t		binaryDataValue;
 	}
 }
 
+//*****************************************************************************
+//*	AlpacaPi packed 12/14 bit data (kAlpacaImageData_Packed12/14), see alpaca_defs.h
+//*	A group of 4 pixels can be split across 2 recv() blocks, the partial group
+//*	is kept in cPackedCarry[] until the rest of it arrives
+//*****************************************************************************
+void	ControllerCamera::AlpacaGetImageArray_Binary_Packed(	TYPE_ImageArray	*imageArray,
+																int				imageArrayLen)
+{
+#define	kUnpackChunkPixels	4096
+uint16_t		pixelChunk[kUnpackChunkPixels];
+int				groupBytes;
+int				totalPixels;
+int				pixelsLeft;
+int				pixelCnt;
+int				groupCnt;
+int				iii;
+
+	groupBytes	=	cPackedBits / 2;
+	totalPixels	=	cBinaryImageHdr.Dimension1 * cBinaryImageHdr.Dimension2;
+	if (totalPixels > imageArrayLen)
+	{
+		totalPixels	=	imageArrayLen;
+	}
+	if ((cBinaryImageHdr.Rank != 2) || (groupBytes <= 0))
+	{
+		CONSOLE_DEBUG_W_NUM("Packed data not supported, Rank=", cBinaryImageHdr.Rank);
+		cData_iii	=	cRecvdByteCnt;
+		return;
+	}
+
+	//*	finish the group that was split across the last block
+	if (cPackedCarryCnt > 0)
+	{
+		while ((cPackedCarryCnt < groupBytes) && (cData_iii < cRecvdByteCnt))
+		{
+			cPackedCarry[cPackedCarryCnt++]	=	cReturnedData[cData_iii++];
+		}
+		if (cPackedCarryCnt < groupBytes)
+		{
+			return;
+		}
+		pixelCnt	=	totalPixels - cImageArrayIndex;
+		if (pixelCnt > 4)
+		{
+			pixelCnt	=	4;
+		}
+		if (pixelCnt > 0)
+		{
+			ImageKernel_UnpackBits_U16(pixelChunk, cPackedCarry, pixelCnt, cPackedBits, cPackedShift);
+			for (iii=0; iii<pixelCnt; iii++)
+			{
+				imageArray[cImageArrayIndex].RedValue	=	pixelChunk[iii];
+				imageArray[cImageArrayIndex].GrnValue	=	pixelChunk[iii];
+				imageArray[cImageArrayIndex].BluValue	=	pixelChunk[iii];
+				cImageArrayIndex++;
+			}
+		}
+		cPackedCarryCnt	=	0;
+	}
+
+	//*	all of the complete groups in this block
+	while ((cRecvdByteCnt - cData_iii) >= groupBytes)
+	{
+		pixelsLeft	=	totalPixels - cImageArrayIndex;
+		if (pixelsLeft <= 0)
+		{
+			break;
+		}
+		groupCnt	=	(cRecvdByteCnt - cData_iii) / groupBytes;
+		if (groupCnt > (kUnpackChunkPixels / 4))
+		{
+			groupCnt	=	kUnpackChunkPixels / 4;
+		}
+		pixelCnt	=	groupCnt * 4;
+		if (pixelCnt > pixelsLeft)
+		{
+			pixelCnt	=	pixelsLeft;
+		}
+		cData_iii	+=	ImageKernel_UnpackBits_U16(	pixelChunk,
+													(uint8_t *)&cReturnedData[cData_iii],
+													pixelCnt,
+													cPackedBits,
+													cPackedShift);
+		for (iii=0; iii<pixelCnt; iii++)
+		{
+			imageArray[cImageArrayIndex].RedValue	=	pixelChunk[iii];
+			imageArray[cImageArrayIndex].GrnValue	=	pixelChunk[iii];
+			imageArray[cImageArrayIndex].BluValue	=	pixelChunk[iii];
+			cImageArrayIndex++;
+		}
+	}
+
+	//*	save the start of a partial group for the next block
+	while ((cData_iii < cRecvdByteCnt) && (cImageArrayIndex < totalPixels))
+	{
+		cPackedCarry[cPackedCarryCnt++]	=	cReturnedData[cData_iii++];
+	}
+	cData_iii	=	cRecvdByteCnt;
+}
+
+//*****************************************************************************
+//*	AlpacaPi compressed data (kAlpacaImageData_Compressed), see alpaca_defs.h
+//*	The bands can not be inflated until all of the data is here,
+//*	everything after the standard header is saved in cCompressedData
+//*****************************************************************************
+void	ControllerCamera::AlpacaGetImageArray_Binary_Collect(void)
+{
+size_t		newLen;
+size_t		newSize;
+uint8_t		*newBuffer;
+
+	if (cData_iii >= cRecvdByteCnt)
+	{
+		return;
+	}
+	newLen	=	cCompressedLen + (cRecvdByteCnt - cData_iii);
+	if (newLen > cCompressedSize)
+	{
+		newSize	=	2 * cCompressedSize;
+		if (newSize < newLen)
+		{
+			newSize	=	newLen;
+		}
+		newBuffer	=	(uint8_t *)realloc(cCompressedData, newSize);
+		if (newBuffer == NULL)
+		{
+			CONSOLE_DEBUG_W_SIZE("Failed to allocate compressed data buffer of size", newSize);
+			cData_iii	=	cRecvdByteCnt;
+			return;
+		}
+		cCompressedData	=	newBuffer;
+		cCompressedSize	=	newSize;
+	}
+	memcpy(&cCompressedData[cCompressedLen], &cReturnedData[cData_iii], (cRecvdByteCnt - cData_iii));
+	cCompressedLen	=	newLen;
+	cData_iii		=	cRecvdByteCnt;
+}
+
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+//*****************************************************************************
+typedef struct	//	TYPE_INFLATE_BANDS
+{
+	const uint8_t	*bandData;
+	const int32_t	*bandSizes;
+	const size_t	*bandOffsets;
+	uint8_t			*rawPtr;
+	long			columnBytes;
+	int				numClms;
+	int				bandCount;
+	int				elementBytes;
+	int				stride;
+	int				errorCnt;
+} TYPE_INFLATE_BANDS;
+
+//*****************************************************************************
+//*	called by ImageKernel_RunRowBands() with a range of columns,
+//*	does every band that starts in that range
+//*****************************************************************************
+static void	Inflate_BandProc(void *context, int firstClm, int lastClm)
+{
+TYPE_INFLATE_BANDS	*bandInfo;
+int					bandFirstClm;
+int					bandLastClm;
+long				bandBytes;
+int					bb;
+
+	bandInfo	=	(TYPE_INFLATE_BANDS *)context;
+	for (bb=0; bb<bandInfo->bandCount; bb++)
+	{
+		bandFirstClm	=	(bb * bandInfo->numClms) / bandInfo->bandCount;
+		if ((bandFirstClm >= firstClm) && (bandFirstClm < lastClm))
+		{
+			bandLastClm	=	((bb + 1) * bandInfo->numClms) / bandInfo->bandCount;
+			bandBytes	=	(bandLastClm - bandFirstClm) * bandInfo->columnBytes;
+			if (ImageKernel_InflateElements(&bandInfo->rawPtr[bandFirstClm * bandInfo->columnBytes],
+											bandBytes,
+											&bandInfo->bandData[bandInfo->bandOffsets[bb]],
+											bandInfo->bandSizes[bb],
+											bandInfo->elementBytes,
+											bandInfo->stride) != bandBytes)
+			{
+				__sync_fetch_and_add(&bandInfo->errorCnt, 1);
+			}
+		}
+	}
+}
+#endif	//	_ENABLE_IMAGEBYTES_DEFLATE_
+
+//*****************************************************************************
+//*	the bands are inflated on all of the cores, then the normal imagebytes data
+//*	is fed through AlpacaGetImageArray_Binary_Block() as if it had just been received
+//*****************************************************************************
+void	ControllerCamera::AlpacaGetImageArray_Binary_Inflate(	TYPE_ImageArray	*imageArray,
+																int				imageArrayLen)
+{
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+TYPE_CompressedImageInfo	compressInfo;
+TYPE_INFLATE_BANDS			bandInfo;
+int32_t						bandSizes[256];
+size_t						bandOffsets[256];
+size_t						dataOffset;
+size_t						rawOffset;
+int							blockLen;
+uint32_t					startMillisecs;
+int							bb;
+
+	startMillisecs	=	millis();
+	if (cCompressedLen < sizeof(TYPE_CompressedImageInfo))
+	{
+		CONSOLE_DEBUG("Compressed data is incomplete");
+		return;
+	}
+	memcpy(&compressInfo, cCompressedData, sizeof(TYPE_CompressedImageInfo));
+	CONSOLE_DEBUG_W_NUM("ElementType            \t=",	compressInfo.ElementType);
+	CONSOLE_DEBUG_W_NUM("BandCount              \t=",	compressInfo.BandCount);
+	CONSOLE_DEBUG_W_NUM("UncompressedSize       \t=",	compressInfo.UncompressedSize);
+
+	memset((void *)&bandInfo, 0, sizeof(TYPE_INFLATE_BANDS));
+	switch(compressInfo.ElementType)
+	{
+		case kAlpacaImageData_Byte:		bandInfo.elementBytes	=	1;	break;
+		case kAlpacaImageData_Int16:
+		case kAlpacaImageData_UInt16:	bandInfo.elementBytes	=	2;	break;
+		case kAlpacaImageData_Int32:	bandInfo.elementBytes	=	4;	break;
+		default:						bandInfo.elementBytes	=	0;	break;
+	}
+	bandInfo.numClms		=	cBinaryImageHdr.Dimension1;
+	bandInfo.bandCount		=	compressInfo.BandCount;
+	bandInfo.stride			=	compressInfo.PredictorStride;
+	bandInfo.columnBytes	=	cBinaryImageHdr.Dimension2 * bandInfo.elementBytes;
+	if (cBinaryImageHdr.Rank == 3)
+	{
+		bandInfo.columnBytes	*=	cBinaryImageHdr.Dimension3;
+	}
+	dataOffset	=	cBinaryImageHdr.DataStart - sizeof(TYPE_BinaryImageHdr);
+	if ((compressInfo.Codec != kAlpacaCodec_Deflate) ||
+		(compressInfo.Predictor != kAlpacaPredictor_Delta) ||
+		(bandInfo.elementBytes == 0) ||
+		(bandInfo.bandCount <= 0) || (bandInfo.bandCount > 256) || (bandInfo.bandCount > bandInfo.numClms) ||
+		(compressInfo.UncompressedSize != (bandInfo.columnBytes * bandInfo.numClms)) ||
+		(dataOffset < (sizeof(TYPE_CompressedImageInfo) + (bandInfo.bandCount * sizeof(int32_t)))) ||
+		(dataOffset > cCompressedLen))
+	{
+		CONSOLE_DEBUG("Compressed data format not supported");
+		return;
+	}
+	memcpy(bandSizes, &cCompressedData[sizeof(TYPE_CompressedImageInfo)], (bandInfo.bandCount * sizeof(int32_t)));
+	rawOffset	=	0;
+	for (bb=0; bb<bandInfo.bandCount; bb++)
+	{
+		bandOffsets[bb]	=	rawOffset;
+		rawOffset		+=	bandSizes[bb];
+		if ((bandSizes[bb] <= 0) || ((dataOffset + rawOffset) > cCompressedLen))
+		{
+			CONSOLE_DEBUG_W_NUM("Compressed data is incomplete, band=", bb);
+			return;
+		}
+	}
+
+	bandInfo.bandData		=	&cCompressedData[dataOffset];
+	bandInfo.bandSizes		=	bandSizes;
+	bandInfo.bandOffsets	=	bandOffsets;
+	bandInfo.rawPtr			=	(uint8_t *)malloc(compressInfo.UncompressedSize);
+	if (bandInfo.rawPtr == NULL)
+	{
+		CONSOLE_DEBUG_W_NUM("Failed to allocate buffer of size", compressInfo.UncompressedSize);
+		return;
+	}
+	ImageKernel_RunRowBands(bandInfo.numClms, Inflate_BandProc, &bandInfo);
+	CONSOLE_DEBUG_W_DBL("Compression ratio      \t=",	((1.0 * compressInfo.UncompressedSize) / (cCompressedLen - dataOffset)));
+	CONSOLE_DEBUG_W_NUM("Inflate time (ms)      \t=",	(millis() - startMillisecs));
+	if (bandInfo.errorCnt == 0)
+	{
+		//*	kReadBuffLen is a multiple of 4, an element is never split between blocks
+		cBinaryImageHdr.TransmissionElementType	=	compressInfo.ElementType;
+		cImgArrayType							=	compressInfo.ElementType;
+		for (rawOffset=0; rawOffset < (size_t)compressInfo.UncompressedSize; rawOffset += blockLen)
+		{
+			blockLen	=	compressInfo.UncompressedSize - rawOffset;
+			if (blockLen > kReadBuffLen)
+			{
+				blockLen	=	kReadBuffLen;
+			}
+			memcpy(cReturnedData, &bandInfo.rawPtr[rawOffset], blockLen);
+			cRecvdByteCnt	=	blockLen;
+			cData_iii		=	0;
+			AlpacaGetImageArray_Binary_Block(imageArray, imageArrayLen);
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_NUM("Bands that failed to inflate=", bandInfo.errorCnt);
+	}
+	free(bandInfo.rawPtr);
+#else
+	CONSOLE_DEBUG("Not built with _ENABLE_IMAGEBYTES_DEFLATE_");
+#endif	//	_ENABLE_IMAGEBYTES_DEFLATE_
+}
+
+//*****************************************************************************
+//*	put the data into the image array based on the TransmissionElementType
+//*****************************************************************************
+void	ControllerCamera::AlpacaGetImageArray_Binary_Block(	TYPE_ImageArray	*imageArray,
+															int				imageArrayLen)
+{
+int		elementBytes;
+int		dataLen;
+int		extraBytes;
+
+	//*	an element can be split between two blocks (odd sized recv(), resumed download),
+	//*	the decoders only get whole elements, the rest is kept for the next block
+	switch(cBinaryImageHdr.TransmissionElementType)
+	{
+		case kAlpacaImageData_Int16:
+		case kAlpacaImageData_UInt16:
+			elementBytes	=	2;
+			break;
+
+		case kAlpacaImageData_Int32:
+			elementBytes	=	(cBinaryImageHdr.Rank == 2) ? 4 : 1;
+			break;
+
+		default:
+			elementBytes	=	1;
+			break;
+	}
+	if (cElementCarryCnt > 0)
+	{
+		if (cData_iii >= cElementCarryCnt)
+		{
+			cData_iii	-=	cElementCarryCnt;
+		}
+		else
+		{
+			//*	cReturnedData has room for the extra bytes
+			memmove(&cReturnedData[cElementCarryCnt], &cReturnedData[cData_iii], (cRecvdByteCnt - cData_iii));
+			cRecvdByteCnt	+=	cElementCarryCnt - cData_iii;
+			cData_iii		=	0;
+		}
+		memcpy(&cReturnedData[cData_iii], cElementCarry, cElementCarryCnt);
+		cElementCarryCnt	=	0;
+	}
+	dataLen		=	cRecvdByteCnt - cData_iii;
+	extraBytes	=	(dataLen > 0) ? (dataLen % elementBytes) : 0;
+	if (extraBytes > 0)
+	{
+		cRecvdByteCnt		-=	extraBytes;
+		memcpy(cElementCarry, &cReturnedData[cRecvdByteCnt], extraBytes);
+		cElementCarryCnt	=	extraBytes;
+	}
+
+	switch(cBinaryImageHdr.TransmissionElementType)
+	{
+		case kAlpacaImageData_Unknown:
+		case kAlpacaImageData_Double:
+		case kAlpacaImageData_Single:
+		case kAlpacaImageData_Decimal:
+			CONSOLE_DEBUG("Specified Binary mode not implemented yet")
+//			LogEvent(	"camera",
+//						"Binary Download",
+//						NULL,
+//						kASCOM_Err_Success,
+//						"Mode not not supported yet");
+			break;
+
+		case kAlpacaImageData_Byte:
+			AlpacaGetImageArray_Binary_Byte(imageArray, imageArrayLen);
+			break;
+
+		case kAlpacaImageData_Int32:
+			AlpacaGetImageArray_Binary_Int32(imageArray, imageArrayLen);
+			break;
+
+		case kAlpacaImageData_Int64:
+			CONSOLE_DEBUG("Specified Binary mode not implemented yet")
+			break;
+
+		case kAlpacaImageData_Int16:
+		case kAlpacaImageData_UInt16:
+			AlpacaGetImageArray_Binary_Int16(imageArray, imageArrayLen);
+			break;
+
+		case kAlpacaImageData_Packed12:
+		case kAlpacaImageData_Packed14:
+			AlpacaGetImageArray_Binary_Packed(imageArray, imageArrayLen);
+			break;
+
+		case kAlpacaImageData_Compressed:
+			AlpacaGetImageArray_Binary_Collect();
+			break;
+
+		default:
+			CONSOLE_DEBUG_W_NUM("TransmissionElementType not supported yet:", cBinaryImageHdr.TransmissionElementType);
+//			LogEvent(	"camera",
+//						"Binary Download",
+//						NULL,
+//						kASCOM_Err_Success,
+//						"Mode not not supported yet");
+			break;
+	}
+}
+
 //*****************************************************************************
 static void WriteRawDataForDebug(const char *dataBuffer, const int arrayLength)
 {
@@ -739,6 +1170,11 @@ int				dataBlkCount;
 	imgRank			=	0;
 	cRGBidx			=	0;
 	dataBlkCount	=	0;
+	cCompressedData	=	NULL;
+	cCompressedSize	=	0;
+	cCompressedLen	=	0;
+	cResumeCnt		=	0;
+	cBodyBytesRead	=	cRecvdByteCnt - cData_iii;		//*	cData_iii is at the end of the HTTP header
 	while (cKeepReading)
 	{
 		dataBlkCount++;
@@ -762,6 +1198,43 @@ int				dataBlkCount;
 				cData_iii++;
 			}
 			CONSOLE_DEBUG_W_NUM("cData_iii                  \t=", cData_iii);
+
+			//*	AlpacaPi packed data has the bit depth after the standard header
+			cPackedBits		=	0;
+			cPackedShift	=	0;
+			cPackedCarryCnt	=	0;
+			cElementCarryCnt	=	0;
+			if (((cBinaryImageHdr.TransmissionElementType == kAlpacaImageData_Packed12) ||
+				(cBinaryImageHdr.TransmissionElementType == kAlpacaImageData_Packed14)) &&
+				(cBinaryImageHdr.DataStart >= (int)(sizeof(TYPE_BinaryImageHdr) + sizeof(TYPE_PackedImageInfo))))
+			{
+			TYPE_PackedImageInfo	packedInfo;
+
+				memcpy(&packedInfo, &cReturnedData[cData_iii], sizeof(TYPE_PackedImageInfo));
+				cPackedBits		=	packedInfo.BitsPerPixel;
+				cPackedShift	=	packedInfo.Shift;
+				CONSOLE_DEBUG_W_NUM("cPackedBits                \t=", cPackedBits);
+				CONSOLE_DEBUG_W_NUM("cPackedShift               \t=", cPackedShift);
+			}
+			//*	AlpacaPi compressed data, the info and band sizes are collected with the data
+			if (cBinaryImageHdr.TransmissionElementType == kAlpacaImageData_Compressed)
+			{
+				cCompressedSize	=	cHttpHdrStruct.contentLength - sizeof(TYPE_BinaryImageHdr);
+				if (cHttpHdrStruct.contentLength <= (int)sizeof(TYPE_BinaryImageHdr))
+				{
+					cCompressedSize	=	kReadBuffLen;
+				}
+				cCompressedData	=	(uint8_t *)malloc(cCompressedSize);
+				if (cCompressedData == NULL)
+				{
+					cCompressedSize	=	0;
+				}
+			}
+			else
+			{
+				//*	skip anything else before the data
+				cData_iii	+=	cBinaryImageHdr.DataStart - sizeof(TYPE_BinaryImageHdr);
+			}
 			CONSOLE_DEBUG("Imagebytes header");
 //			DumpHex((char *)binaryImgHdrPtr, 6);
 			CONSOLE_DEBUG("Raw data (cReturnedData)");
@@ -796,47 +1269,7 @@ int				dataBlkCount;
 
 
 //		CONSOLE_DEBUG_W_NUM("cImageArrayIndex\t=",	cImageArrayIndex);
-		//*	put the data into a long word based on the TransmissionElementType
-		switch(cBinaryImageHdr.TransmissionElementType)
-		{
-			case kAlpacaImageData_Unknown:
-			case kAlpacaImageData_Double:
-			case kAlpacaImageData_Single:
-			case kAlpacaImageData_Decimal:
-				CONSOLE_DEBUG("Specified Binary mode not implemented yet")
-//				LogEvent(	"camera",
-//							"Binary Download",
-//							NULL,
-//							kASCOM_Err_Success,
-//							"Mode not not supported yet");
-				break;
-
-			case kAlpacaImageData_Byte:
-				AlpacaGetImageArray_Binary_Byte(imageArray, imageArrayLen);
-				break;
-
-			case kAlpacaImageData_Int32:
-				AlpacaGetImageArray_Binary_Int32(imageArray, imageArrayLen);
-				break;
-
-			case kAlpacaImageData_Int64:
-				CONSOLE_DEBUG("Specified Binary mode not implemented yet")
-				break;
-
-			case kAlpacaImageData_Int16:
-			case kAlpacaImageData_UInt16:
-				AlpacaGetImageArray_Binary_Int16(imageArray, imageArrayLen);
-				break;
-
-			default:
-				CONSOLE_DEBUG_W_NUM("TransmissionElementType not supported yet:", cBinaryImageHdr.TransmissionElementType);
-//				LogEvent(	"camera",
-//							"Binary Download",
-//							NULL,
-//							kASCOM_Err_Success,
-//							"Mode not not supported yet");
-				break;
-		}
+		AlpacaGetImageArray_Binary_Block(imageArray, imageArrayLen);
 
 		UpdateImageProgressBar(imageArrayLen);
 		cRecvdByteCnt	=	recv(cSocket_desc, cReturnedData , kReadBuffLen , 0);
@@ -844,20 +1277,186 @@ int				dataBlkCount;
 		{
 			cSocketReadCnt++;
 			cTotalBytesRead					+=	cRecvdByteCnt;
+			cBodyBytesRead					+=	cRecvdByteCnt;
 			cReturnedData[cRecvdByteCnt]	=	0;
 			cData_iii	=	0;
 		}
+		else if (AlpacaGetImageArray_Binary_Resume())
+		{
+			//*	cReturnedData has the first block of the new response,
+			//*	if it is a new frame, cReadBinaryHeader is set again
+		}
 		else
 		{
 			cKeepReading		=	false;
 		}
 	}
+	if (cCompressedData != NULL)
+	{
+		AlpacaGetImageArray_Binary_Inflate(imageArray, imageArrayLen);
+		free(cCompressedData);
+		cCompressedData	=	NULL;
+	}
 	CONSOLE_DEBUG_W_NUM("dataBlkCount    \t=",	dataBlkCount);
 	CONSOLE_DEBUG_W_NUM("imgRank         \t=",	imgRank);
 	CONSOLE_DEBUG_W_NUM("cImageArrayIndex\t=",	cImageArrayIndex);
 	return(imgRank);
 }
 
+//*****************************************************************************
+//*	reads the HTTP header of the response to a resume request,
+//*	cReturnedData gets the header and whatever data came with it
+//*	returns the length of the header, 0 if the connection was lost
+//*****************************************************************************
+static int	ReadResumeHeader(int socketDesc, char *returnedData, int *recvdByteCnt, TYPE_HTTPheader *httpHdr)
+{
+char	*headerEnd;
+char	*linePtr;
+char	*lineEnd;
+int		recvByteCnt;
+
+	*recvdByteCnt	=	0;
+	headerEnd		=	NULL;
+	while ((headerEnd == NULL) && (*recvdByteCnt < kReadBuffLen))
+	{
+		recvByteCnt	=	recv(socketDesc, &returnedData[*recvdByteCnt], (kReadBuffLen - *recvdByteCnt), 0);
+		if (recvByteCnt <= 0)
+		{
+			return(0);
+		}
+		*recvdByteCnt					+=	recvByteCnt;
+		returnedData[*recvdByteCnt]		=	0;
+		headerEnd	=	strstr(returnedData, "\r\n\r\n");
+	}
+	if (headerEnd == NULL)
+	{
+		return(0);
+	}
+	*headerEnd	=	0;
+
+	memset(httpHdr, 0, sizeof(TYPE_HTTPheader));
+	linePtr	=	returnedData;
+	while (linePtr != NULL)
+	{
+		lineEnd	=	strstr(linePtr, "\r\n");
+		if (lineEnd != NULL)
+		{
+			*lineEnd	=	0;
+		}
+		ProcessHTTPheaderLine(linePtr, httpHdr);
+		linePtr	=	(lineEnd != NULL) ? (lineEnd + 2) : NULL;
+	}
+	return((headerEnd - returnedData) + 4);
+}
+
+//*****************************************************************************
+//*	The connection ended before all of the data was received (WiFi drop out, timeout).
+//*	Ask for the rest with "Range: bytes=<cBodyBytesRead>-" and "If-Range: <ETag>".
+//*	The ETag pins the frame, if the camera has a new frame by now the server
+//*	sends the whole new frame (200) and the decoding starts over.
+//*	returns true if there is more data in cReturnedData starting at cData_iii
+//*****************************************************************************
+bool	ControllerCamera::AlpacaGetImageArray_Binary_Resume(void)
+{
+TYPE_HTTPheader	resumeHdr;
+int				recvByteCnt;
+int				headerLen;
+bool			resumeOK;
+
+	if ((cHttpHdrStruct.contentLength <= 0) ||
+		(cBodyBytesRead >= cHttpHdrStruct.contentLength) ||
+		(strlen(cHttpHdrStruct.entityTag) == 0))
+	{
+		return(false);
+	}
+	resumeOK	=	false;
+	while ((resumeOK == false) && (cResumeCnt < kMaxResumeCount))
+	{
+		cResumeCnt++;
+		CONSOLE_DEBUG_W_LONG("Connection lost, resuming at byte\t=", cBodyBytesRead);
+		CONSOLE_DEBUG_W_NUM("cResumeCnt\t\t\t\t=", cResumeCnt);
+
+		shutdown(cSocket_desc, SHUT_RDWR);
+		close(cSocket_desc);
+		//*	give the network a moment to recover
+		usleep(cResumeCnt * 100000);
+		//*	firstByte of 0 does not send a Range, that gets all of it again
+		cSocket_desc	=	OpenSocketAndSendRequest_Range(	&cDeviceAddress,
+															cPort,
+															"GET",
+															cLastAlpacaCmdString,
+															cImageDataString,
+															READ_BINARY_IMAGE,
+															cBodyBytesRead,
+															cHttpHdrStruct.entityTag);
+		if (cSocket_desc < 0)
+		{
+			continue;
+		}
+		headerLen	=	ReadResumeHeader(cSocket_desc, cReturnedData, &cRecvdByteCnt, &resumeHdr);
+		if (headerLen == 0)
+		{
+			continue;
+		}
+		cTotalBytesRead	+=	cRecvdByteCnt;
+		cData_iii		=	headerLen;
+
+		if ((resumeHdr.httpStatus == 206) && (resumeHdr.contentRangeStart == cBodyBytesRead))
+		{
+			//*	the rest of the same data, keep going where we were
+			cBodyBytesRead	+=	cRecvdByteCnt - cData_iii;
+			resumeOK		=	true;
+		}
+		else if ((resumeHdr.httpStatus == 200) && resumeHdr.dataIsBinary)
+		{
+			//*	the frame has changed (or we asked for all of it), start over
+			CONSOLE_DEBUG("Starting over with the whole image");
+			memcpy(&cHttpHdrStruct, &resumeHdr, sizeof(TYPE_HTTPheader));
+			if (cCompressedData != NULL)
+			{
+				free(cCompressedData);
+				cCompressedData	=	NULL;
+			}
+			cCompressedSize		=	0;
+			cCompressedLen		=	0;
+			cImageArrayIndex	=	0;
+			cRGBidx				=	0;
+			cBodyBytesRead		=	0;
+			cReadBinaryHeader	=	true;
+
+			//*	the binary header has to be in the first block
+			resumeOK	=	true;
+			while (resumeOK && ((cRecvdByteCnt - cData_iii) < (int)(sizeof(TYPE_BinaryImageHdr) + sizeof(TYPE_PackedImageInfo))))
+			{
+				recvByteCnt	=	recv(cSocket_desc, &cReturnedData[cRecvdByteCnt], (kReadBuffLen - cRecvdByteCnt), 0);
+				if (recvByteCnt > 0)
+				{
+					cRecvdByteCnt		+=	recvByteCnt;
+					cTotalBytesRead		+=	recvByteCnt;
+				}
+				else
+				{
+					resumeOK	=	false;
+				}
+			}
+			if (resumeOK)
+			{
+				cBodyBytesRead	=	cRecvdByteCnt - cData_iii;
+			}
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_NUM("Resume failed, httpStatus\t=", resumeHdr.httpStatus);
+			break;
+		}
+	}
+	if (resumeOK)
+	{
+		cSocketReadCnt++;
+	}
+	return(resumeOK);
+}
+
 //*****************************************************************************
 int	ControllerCamera::AlpacaGetImageArray_JSON(	TYPE_ImageArray	*imageArray,
 												int				imageArrayLen,
@@ -1139,6 +1738,7 @@ int				ccc;
 
 
 	memset(&cHttpHdrStruct, 0, sizeof(TYPE_HTTPheader));
+	cImageDataString		=	dataString;
 
 	sprintf(alpacaString,	"/api/v1/%s/%d/%s", alpacaDevice, alpacaDevNum, alpacaCmd);
 	strcpy(cLastAlpacaCmdString, alpacaString);
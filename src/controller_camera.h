@@ -45,6 +45,9 @@ typedef struct
 	bool	dataIsBinary;
 	bool	dataIsJson;
 	int		contentLength;
+	int		httpStatus;				//*	200, 206 (partial), 416 ...
+	long	contentRangeStart;		//*	from "Content-Range: bytes start-end/total"
+	char	entityTag[80];			//*	"ETag:", sent back in "If-Range:" to resume
 
 } TYPE_HTTPheader;
 
@@ -245,9 +248,20 @@ class ControllerCamera: public Controller
 				void	AlpacaGetImageArray_Binary_Int32(	TYPE_ImageArray	*imageArray,
 															int				arrayLength);
 
+				void	AlpacaGetImageArray_Binary_Packed(	TYPE_ImageArray	*imageArray,
+															int				arrayLength);
+
+				void	AlpacaGetImageArray_Binary_Block(	TYPE_ImageArray	*imageArray,
+															int				arrayLength);
+
+				void	AlpacaGetImageArray_Binary_Collect(void);
+				void	AlpacaGetImageArray_Binary_Inflate(	TYPE_ImageArray	*imageArray,
+															int				arrayLength);
+
 				int		AlpacaGetImageArray_Binary(			TYPE_ImageArray	*imageArray,
 															int				arrayLength,
 															int				*actualValueCnt);
+				bool	AlpacaGetImageArray_Binary_Resume(void);
 
 				void	UpdateImageProgressBar(int maxArrayLength);
 
@@ -269,6 +283,18 @@ class ControllerCamera: public Controller
 				int						cImgArrayType;
 				int						cRGBidx;
 				char					cReturnedData[kReadBuffLen + 10];
+				int						cPackedBits;		//*	0 if not packed
+				int						cPackedShift;
+				uint8_t					cPackedCarry[8];	//*	partial group from the last recv()
+				int						cPackedCarryCnt;
+				uint8_t					cElementCarry[4];	//*	partial element from the last recv()
+				int						cElementCarryCnt;
+				uint8_t					*cCompressedData;	//*	kAlpacaImageData_Compressed, everything after the header
+				size_t					cCompressedSize;
+				size_t					cCompressedLen;
+				const char				*cImageDataString;	//*	to send the request again when resuming
+				long					cBodyBytesRead;		//*	offset of the next byte in the response body
+				int						cResumeCnt;
 
 				uint32_t				tStartMillisecs;
 				uint32_t				tCurrentMillisecs;
@@ -0,0 +1,680 @@
+//*****************************************************************************
+//*	Name:			file_index.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	In memory sorted index of the file names in a directory
+//*
+//*					The directory is scanned once, after that inotify reports
+//*					the files that are created, deleted or renamed and only those
+//*					names are inserted or removed (binary search, the list stays sorted).
+//*					If the inotify queue overflows the directory is scanned again.
+//*					Without inotify (not Linux, or out of watches) the directory
+//*					modification time is checked and the directory is scanned
+//*					again when it changes.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	References:		man 7 inotify
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created file_index.c
+//*	Oct 19,	2026	<MLS> Rescan without inotify while the dir time is in the scan second
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_FILE_INDEX_MAIN_ self test
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<dirent.h>
+#include	<pthread.h>
+#include	<time.h>
+#include	<sys/stat.h>
+#ifdef __linux__
+	#include	<sys/inotify.h>
+#endif
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"file_index.h"
+
+#define	kFileIndex_AllocChunk	1024
+
+//*****************************************************************************
+static uint32_t	GetMilliSecs(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return((timeNow.tv_sec * 1000) + (timeNow.tv_nsec / 1000000));
+}
+
+//*****************************************************************************
+void	FileIndex_Init(TYPE_FILE_INDEX *fileIndex)
+{
+	memset(fileIndex, 0, sizeof(TYPE_FILE_INDEX));
+	fileIndex->inotifyFD	=	-1;
+	fileIndex->watchDesc	=	-1;
+	pthread_mutex_init(&fileIndex->indexMutex, NULL);
+}
+
+//*****************************************************************************
+static void	FreeNames(TYPE_FILE_INDEX *fileIndex)
+{
+int		iii;
+
+	for (iii=0; iii<fileIndex->nameCnt; iii++)
+	{
+		free(fileIndex->nameList[iii]);
+	}
+	fileIndex->nameCnt	=	0;
+}
+
+//*****************************************************************************
+static void	StopWatching(TYPE_FILE_INDEX *fileIndex)
+{
+	if (fileIndex->inotifyFD >= 0)
+	{
+		close(fileIndex->inotifyFD);
+	}
+	fileIndex->inotifyFD	=	-1;
+	fileIndex->watchDesc	=	-1;
+}
+
+//*****************************************************************************
+void	FileIndex_Release(TYPE_FILE_INDEX *fileIndex)
+{
+	pthread_mutex_lock(&fileIndex->indexMutex);
+	StopWatching(fileIndex);
+	FreeNames(fileIndex);
+	if (fileIndex->nameList != NULL)
+	{
+		free(fileIndex->nameList);
+	}
+	fileIndex->nameList		=	NULL;
+	fileIndex->nameAlloc	=	0;
+	fileIndex->valid		=	false;
+	pthread_mutex_unlock(&fileIndex->indexMutex);
+}
+
+//*****************************************************************************
+static bool	MakeRoom(TYPE_FILE_INDEX *fileIndex)
+{
+char	**newList;
+int		newAlloc;
+
+	if (fileIndex->nameCnt < fileIndex->nameAlloc)
+	{
+		return(true);
+	}
+	newAlloc	=	fileIndex->nameAlloc + kFileIndex_AllocChunk + (fileIndex->nameAlloc / 2);
+	newList		=	(char **)realloc(fileIndex->nameList, newAlloc * sizeof(char *));
+	if (newList == NULL)
+	{
+		CONSOLE_DEBUG("Failed to allocate file index");
+		return(false);
+	}
+	fileIndex->nameList		=	newList;
+	fileIndex->nameAlloc	=	newAlloc;
+	return(true);
+}
+
+//*****************************************************************************
+//*	returns the index of the name, or where it would be inserted
+//*****************************************************************************
+static int	FindName(TYPE_FILE_INDEX *fileIndex, const char *fileName, bool *foundIt)
+{
+int		lowIdx;
+int		highIdx;
+int		midIdx;
+int		compareResult;
+
+	*foundIt	=	false;
+	lowIdx		=	0;
+	highIdx		=	fileIndex->nameCnt;
+	while (lowIdx < highIdx)
+	{
+		midIdx			=	(lowIdx + highIdx) / 2;
+		compareResult	=	strcmp(fileIndex->nameList[midIdx], fileName);
+		if (compareResult == 0)
+		{
+			*foundIt	=	true;
+			return(midIdx);
+		}
+		else if (compareResult < 0)
+		{
+			lowIdx	=	midIdx + 1;
+		}
+		else
+		{
+			highIdx	=	midIdx;
+		}
+	}
+	return(lowIdx);
+}
+
+//*****************************************************************************
+static void	AddName(TYPE_FILE_INDEX *fileIndex, const char *fileName)
+{
+int		nameIdx;
+bool	foundIt;
+char	*newName;
+
+	nameIdx	=	FindName(fileIndex, fileName, &foundIt);
+	if ((foundIt == false) && MakeRoom(fileIndex))
+	{
+		newName	=	strdup(fileName);
+		if (newName != NULL)
+		{
+			memmove(&fileIndex->nameList[nameIdx + 1],
+					&fileIndex->nameList[nameIdx],
+					(fileIndex->nameCnt - nameIdx) * sizeof(char *));
+			fileIndex->nameList[nameIdx]	=	newName;
+			fileIndex->nameCnt++;
+		}
+	}
+}
+
+//*****************************************************************************
+static void	RemoveName(TYPE_FILE_INDEX *fileIndex, const char *fileName)
+{
+int		nameIdx;
+bool	foundIt;
+
+	nameIdx	=	FindName(fileIndex, fileName, &foundIt);
+	if (foundIt)
+	{
+		free(fileIndex->nameList[nameIdx]);
+		fileIndex->nameCnt--;
+		memmove(&fileIndex->nameList[nameIdx],
+				&fileIndex->nameList[nameIdx + 1],
+				(fileIndex->nameCnt - nameIdx) * sizeof(char *));
+	}
+}
+
+//*****************************************************************************
+static int	CompareNames(const void *namePtr1, const void *namePtr2)
+{
+	return(strcmp(*((char * const *)namePtr1), *((char * const *)namePtr2)));
+}
+
+//*****************************************************************************
+static bool	IsDirectory(const char *dirPath, struct dirent *dirEntry)
+{
+char		filePath[512];
+struct stat	fileStatus;
+
+	if (dirEntry->d_type == DT_DIR)
+	{
+		return(true);
+	}
+	//*	some file systems do not fill in d_type
+	if (dirEntry->d_type == DT_UNKNOWN)
+	{
+		snprintf(filePath, sizeof(filePath), "%s/%s", dirPath, dirEntry->d_name);
+		if ((stat(filePath, &fileStatus) == 0) && S_ISDIR(fileStatus.st_mode))
+		{
+			return(true);
+		}
+	}
+	return(false);
+}
+
+//*****************************************************************************
+//*	the names are appended and then sorted once
+//*****************************************************************************
+static void	ScanDirectory(TYPE_FILE_INDEX *fileIndex)
+{
+DIR				*directory;
+struct dirent	*dirEntry;
+struct stat		dirStatus;
+uint32_t		startMilliSecs;
+char			*newName;
+
+	startMilliSecs	=	GetMilliSecs();
+	FreeNames(fileIndex);
+	fileIndex->valid	=	false;
+
+	fileIndex->scanTime	=	time(NULL);
+	if (stat(fileIndex->dirPath, &dirStatus) == 0)
+	{
+		fileIndex->dirModTime	=	dirStatus.st_mtime;
+	}
+	directory	=	opendir(fileIndex->dirPath);
+	if (directory != NULL)
+	{
+		while ((dirEntry = readdir(directory)) != NULL)
+		{
+			if ((dirEntry->d_name[0] != '.') && (IsDirectory(fileIndex->dirPath, dirEntry) == false))
+			{
+				if (MakeRoom(fileIndex))
+				{
+					newName	=	strdup(dirEntry->d_name);
+					if (newName != NULL)
+					{
+						fileIndex->nameList[fileIndex->nameCnt]	=	newName;
+						fileIndex->nameCnt++;
+					}
+				}
+			}
+		}
+		closedir(directory);
+		if (fileIndex->nameCnt > 1)
+		{
+			qsort(fileIndex->nameList, fileIndex->nameCnt, sizeof(char *), CompareNames);
+		}
+		fileIndex->valid	=	true;
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Failed to open", fileIndex->dirPath);
+	}
+	fileIndex->buildTime_ms	=	GetMilliSecs() - startMilliSecs;
+	fileIndex->rebuildCnt++;
+	CONSOLE_DEBUG_W_NUM("File index scan time (ms)\t=", fileIndex->buildTime_ms);
+}
+
+//*****************************************************************************
+//*	the watch is set up before the scan so nothing is missed in between,
+//*	the names that show up in both are ignored by AddName()
+//*****************************************************************************
+static void	StartWatching(TYPE_FILE_INDEX *fileIndex)
+{
+#ifdef __linux__
+	fileIndex->inotifyFD	=	inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fileIndex->inotifyFD >= 0)
+	{
+		fileIndex->watchDesc	=	inotify_add_watch(	fileIndex->inotifyFD,
+														fileIndex->dirPath,
+														IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+														IN_DELETE_SELF | IN_MOVE_SELF);
+		if (fileIndex->watchDesc < 0)
+		{
+			CONSOLE_DEBUG_W_STR("inotify_add_watch failed", fileIndex->dirPath);
+			StopWatching(fileIndex);
+		}
+	}
+#endif // __linux__
+}
+
+//*****************************************************************************
+//*	returns true if the directory has to be scanned again
+//*****************************************************************************
+static bool	ReadEvents(TYPE_FILE_INDEX *fileIndex)
+{
+bool	rescanNeeded	=	false;
+#ifdef __linux__
+char	eventBuffer[16384] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+ssize_t	bytesRead;
+ssize_t	bufIdx;
+const struct inotify_event	*event;
+
+	while ((bytesRead = read(fileIndex->inotifyFD, eventBuffer, sizeof(eventBuffer))) > 0)
+	{
+		bufIdx	=	0;
+		while (bufIdx < bytesRead)
+		{
+			event	=	(const struct inotify_event *)&eventBuffer[bufIdx];
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				rescanNeeded	=	true;
+			}
+			else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+			{
+				//*	the directory itself is gone, start over
+				StopWatching(fileIndex);
+				fileIndex->valid	=	false;
+				return(true);
+			}
+			else if ((event->len > 0) && ((event->mask & IN_ISDIR) == 0) && (event->name[0] != '.'))
+			{
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					AddName(fileIndex, event->name);
+				}
+				else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+				{
+					RemoveName(fileIndex, event->name);
+				}
+				fileIndex->eventCnt++;
+			}
+			bufIdx	+=	sizeof(struct inotify_event) + event->len;
+		}
+	}
+#endif // __linux__
+	return(rescanNeeded);
+}
+
+//*****************************************************************************
+bool	FileIndex_Update(TYPE_FILE_INDEX *fileIndex, const char *dirPath)
+{
+struct stat	dirStatus;
+bool		rescanNeeded;
+bool		isValid;
+
+	pthread_mutex_lock(&fileIndex->indexMutex);
+	rescanNeeded	=	false;
+	if ((strcmp(dirPath, fileIndex->dirPath) != 0) || (fileIndex->valid == false))
+	{
+		//*	new directory, or it was not there the last time
+		StopWatching(fileIndex);
+		strncpy(fileIndex->dirPath, dirPath, (sizeof(fileIndex->dirPath) - 1));
+		fileIndex->dirPath[sizeof(fileIndex->dirPath) - 1]	=	0;
+		StartWatching(fileIndex);
+		rescanNeeded	=	true;
+	}
+	else if (fileIndex->inotifyFD >= 0)
+	{
+		rescanNeeded	=	ReadEvents(fileIndex);
+		if (fileIndex->inotifyFD < 0)
+		{
+			StartWatching(fileIndex);
+		}
+	}
+	else if (stat(fileIndex->dirPath, &dirStatus) == 0)
+	{
+		//*	st_mtime is in seconds, a change in the same second as the scan
+		//*	does not change it, so keep scanning until that second is over
+		rescanNeeded	=	(dirStatus.st_mtime != fileIndex->dirModTime) ||
+							(fileIndex->dirModTime >= fileIndex->scanTime);
+	}
+
+	if (rescanNeeded)
+	{
+		ScanDirectory(fileIndex);
+	}
+	isValid	=	fileIndex->valid;
+	pthread_mutex_unlock(&fileIndex->indexMutex);
+	return(isValid);
+}
+
+//*****************************************************************************
+int	FileIndex_Query(TYPE_FILE_INDEX		*fileIndex,
+					const char			*nameFilter,
+					const int			startIdx,
+					const int			maxCount,
+					FileIndex_Proc		fileProc,
+					void				*context)
+{
+int		matchCnt;
+int		endIdx;
+int		iii;
+
+	pthread_mutex_lock(&fileIndex->indexMutex);
+	if ((nameFilter == NULL) || (nameFilter[0] == 0))
+	{
+		//*	no filter, go straight to the page
+		matchCnt	=	fileIndex->nameCnt;
+		endIdx		=	startIdx + maxCount;
+		if (endIdx > matchCnt)
+		{
+			endIdx	=	matchCnt;
+		}
+		for (iii=startIdx; iii<endIdx; iii++)
+		{
+			fileProc(fileIndex->nameList[iii], context);
+		}
+	}
+	else
+	{
+		matchCnt	=	0;
+		for (iii=0; iii<fileIndex->nameCnt; iii++)
+		{
+			if (strstr(fileIndex->nameList[iii], nameFilter) != NULL)
+			{
+				if ((matchCnt >= startIdx) && (matchCnt < (startIdx + maxCount)))
+				{
+					fileProc(fileIndex->nameList[iii], context);
+				}
+				matchCnt++;
+			}
+		}
+	}
+	pthread_mutex_unlock(&fileIndex->indexMutex);
+	return(matchCnt);
+}
+
+#ifdef _INCLUDE_FILE_INDEX_MAIN_
+//*****************************************************************************
+//*	self test and benchmark
+//*	make fileindextest
+//*	./fileindextest [file count] [directory], the directory is made and removed
+//*****************************************************************************
+#include	<fcntl.h>
+#include	<errno.h>
+
+static int	gTestNameCnt;
+static char	**gTestNameList;
+
+//*****************************************************************************
+static void	CollectName(const char *fileName, void *context)
+{
+	(void)context;
+	gTestNameList[gTestNameCnt++]	=	(char *)fileName;
+}
+
+//*****************************************************************************
+static double	GetTestMilliSecs(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return((timeNow.tv_sec * 1000.0) + (timeNow.tv_nsec / 1.0e6));
+}
+
+//*****************************************************************************
+static int	FilterFiles(const struct dirent *dirEntry)
+{
+	return((dirEntry->d_name[0] != '.') && (dirEntry->d_type != DT_DIR));
+}
+
+//*****************************************************************************
+static int	CompareEntries(const struct dirent **entry1, const struct dirent **entry2)
+{
+	return(strcmp((*entry1)->d_name, (*entry2)->d_name));
+}
+
+//*****************************************************************************
+//*	the index has to hold exactly what a fresh sorted scandir() finds
+//*****************************************************************************
+static int	CheckAgainstScandir(TYPE_FILE_INDEX *fileIndex, const char *title)
+{
+struct dirent	**entryList;
+int				entryCnt;
+int				iii;
+int				errorCnt;
+
+	errorCnt	=	0;
+	entryCnt	=	scandir(fileIndex->dirPath, &entryList, FilterFiles, CompareEntries);
+	if (entryCnt != fileIndex->nameCnt)
+	{
+		printf("%s: index has %d names, scandir() found %d\r\n", title, fileIndex->nameCnt, entryCnt);
+		errorCnt++;
+	}
+	for (iii=0; iii<entryCnt; iii++)
+	{
+		if ((errorCnt == 0) && (strcmp(entryList[iii]->d_name, fileIndex->nameList[iii]) != 0))
+		{
+			printf("%s: name %d is %s, expected %s\r\n", title, iii, fileIndex->nameList[iii], entryList[iii]->d_name);
+			errorCnt++;
+		}
+		free(entryList[iii]);
+	}
+	if (entryCnt >= 0)
+	{
+		free(entryList);
+	}
+	return(errorCnt);
+}
+
+//*****************************************************************************
+static void	MakeFile(const char *dirPath, const char *fileName)
+{
+char	filePath[512];
+int		fileDesc;
+
+	snprintf(filePath, sizeof(filePath), "%s/%s", dirPath, fileName);
+	fileDesc	=	open(filePath, (O_CREAT | O_WRONLY), 0644);
+	if (fileDesc >= 0)
+	{
+		close(fileDesc);
+	}
+}
+
+//*****************************************************************************
+static void	RemoveFile(const char *dirPath, const char *fileName)
+{
+char	filePath[512];
+
+	snprintf(filePath, sizeof(filePath), "%s/%s", dirPath, fileName);
+	unlink(filePath);
+}
+
+//*****************************************************************************
+int	main(int argc, char **argv)
+{
+TYPE_FILE_INDEX	fileIndex;
+const char		*dirPath;
+char			fileName[128];
+char			oldPath[512];
+char			newPath[512];
+struct dirent	**entryList;
+int				fileCnt;
+int				entryCnt;
+int				matchCnt;
+int				refMatchCnt;
+int				iii;
+int				errorCnt;
+double			startTime;
+
+	fileCnt	=	(argc > 1) ? atoi(argv[1]) : 100000;
+	dirPath	=	(argc > 2) ? argv[2] : "/tmp/fileindextest";
+	if (fileCnt < 1000)
+	{
+		fileCnt	=	1000;
+	}
+	errorCnt		=	0;
+	gTestNameList	=	(char **)malloc(fileCnt * sizeof(char *));
+	if ((gTestNameList == NULL) || ((mkdir(dirPath, 0755) != 0) && (errno != EEXIST)))
+	{
+		printf("Can not make %s\r\n", dirPath);
+		return(1);
+	}
+	//*	not in name order, the way a sequence of images would not be
+	for (iii=0; iii<fileCnt; iii++)
+	{
+		snprintf(fileName, sizeof(fileName), "2026-10-19T%06d-SIM0.fits", ((iii * 7919) % fileCnt));
+		MakeFile(dirPath, fileName);
+	}
+	printf("%d files in %s\r\n", fileCnt, dirPath);
+
+	startTime	=	GetTestMilliSecs();
+	entryCnt	=	scandir(dirPath, &entryList, FilterFiles, CompareEntries);
+	printf("scandir + sort\t\t%8.2f ms per request\r\n", (GetTestMilliSecs() - startTime));
+	for (iii=0; iii<entryCnt; iii++)
+	{
+		free(entryList[iii]);
+	}
+	if (entryCnt >= 0)
+	{
+		free(entryList);
+	}
+
+	FileIndex_Init(&fileIndex);
+	startTime	=	GetTestMilliSecs();
+	FileIndex_Update(&fileIndex, dirPath);
+	printf("initial index build\t%8.2f ms, once\r\n", (GetTestMilliSecs() - startTime));
+	errorCnt	+=	CheckAgainstScandir(&fileIndex, "Initial scan");
+
+	//*	a page from the middle
+	gTestNameCnt	=	0;
+	startTime		=	GetTestMilliSecs();
+	FileIndex_Update(&fileIndex, dirPath);
+	matchCnt		=	FileIndex_Query(&fileIndex, NULL, (fileCnt / 2), 100, CollectName, NULL);
+	printf("page of 100 from index\t%8.3f ms\r\n", (GetTestMilliSecs() - startTime));
+	if ((matchCnt != fileCnt) || (gTestNameCnt != 100) ||
+		(strcmp(gTestNameList[0], fileIndex.nameList[fileCnt / 2]) != 0))
+	{
+		printf("Page query: wrong names\r\n");
+		errorCnt++;
+	}
+
+	//*	sub string filter, the count has to match a brute force search
+	gTestNameCnt	=	0;
+	startTime		=	GetTestMilliSecs();
+	matchCnt		=	FileIndex_Query(&fileIndex, "T0009", 0, 100, CollectName, NULL);
+	printf("substring filter query\t%8.3f ms\r\n", (GetTestMilliSecs() - startTime));
+	refMatchCnt	=	0;
+	for (iii=0; iii<fileIndex.nameCnt; iii++)
+	{
+		if (strstr(fileIndex.nameList[iii], "T0009") != NULL)
+		{
+			refMatchCnt++;
+		}
+	}
+	if ((matchCnt != refMatchCnt) || (gTestNameCnt != ((refMatchCnt < 100) ? refMatchCnt : 100)))
+	{
+		printf("Filter query: %d matches, expected %d\r\n", matchCnt, refMatchCnt);
+		errorCnt++;
+	}
+
+	//*	changes, sub directories and hidden files have to stay out of the index
+	for (iii=0; iii<100; iii++)
+	{
+		snprintf(fileName, sizeof(fileName), "2026-10-19T%06d-SIM0.fits", iii);
+		RemoveFile(dirPath, fileName);
+	}
+	MakeFile(dirPath, "zzz-new.jpg");
+	MakeFile(dirPath, ".hidden");
+	snprintf(oldPath, sizeof(oldPath), "%s/2026-10-19T000100-SIM0.fits", dirPath);
+	snprintf(newPath, sizeof(newPath), "%s/aaa-renamed.fits", dirPath);
+	rename(oldPath, newPath);
+	snprintf(newPath, sizeof(newPath), "%s/subdir", dirPath);
+	mkdir(newPath, 0755);
+	startTime	=	GetTestMilliSecs();
+	FileIndex_Update(&fileIndex, dirPath);
+	printf("103 changes applied\t%8.3f ms, %ld events, %ld scans\r\n", (GetTestMilliSecs() - startTime), fileIndex.eventCnt, fileIndex.rebuildCnt);
+	errorCnt	+=	CheckAgainstScandir(&fileIndex, "After changes");
+
+	//*	without inotify the directory time is used, the second change is
+	//*	in the same second as the scan before it and does not change st_mtime
+	StopWatching(&fileIndex);
+	MakeFile(dirPath, "no-inotify-1.fits");
+	FileIndex_Update(&fileIndex, dirPath);
+	errorCnt	+=	CheckAgainstScandir(&fileIndex, "Without inotify");
+	MakeFile(dirPath, "no-inotify-2.fits");
+	FileIndex_Update(&fileIndex, dirPath);
+	errorCnt	+=	CheckAgainstScandir(&fileIndex, "Same second");
+
+	//*	clean up
+	for (iii=0; iii<fileIndex.nameCnt; iii++)
+	{
+		RemoveFile(dirPath, fileIndex.nameList[iii]);
+	}
+	RemoveFile(dirPath, ".hidden");
+	rmdir(newPath);
+	rmdir(dirPath);
+	FileIndex_Release(&fileIndex);
+	free(gTestNameList);
+
+	printf("%d errors\r\n", errorCnt);
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_FILE_INDEX_MAIN_
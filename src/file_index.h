@@ -0,0 +1,65 @@
+//*****************************************************************************
+//#include	"file_index.h"
+
+#ifndef _FILE_INDEX_H_
+#define	_FILE_INDEX_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+#include	<pthread.h>
+#include	<time.h>
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+//*****************************************************************************
+//*	sorted list of the file names in one directory, sub directories and
+//*	names starting with '.' are not included
+typedef struct	//	TYPE_FILE_INDEX
+{
+	char			dirPath[256];
+	char			**nameList;			//*	malloc'd names, sorted with strcmp()
+	int				nameCnt;
+	int				nameAlloc;
+	bool			valid;
+	int				inotifyFD;			//*	-1 = not available, the directory time is checked instead
+	int				watchDesc;
+	time_t			dirModTime;
+	time_t			scanTime;			//*	when dirModTime was read
+	uint32_t		buildTime_ms;		//*	time the last full scan took
+	long			rebuildCnt;
+	long			eventCnt;			//*	inotify events applied
+	pthread_mutex_t	indexMutex;
+} TYPE_FILE_INDEX;
+
+void	FileIndex_Init(TYPE_FILE_INDEX *fileIndex);
+void	FileIndex_Release(TYPE_FILE_INDEX *fileIndex);
+
+//*	makes sure the index is for this directory and is up to date,
+//*	the first call scans the directory, after that only the changes are applied
+bool	FileIndex_Update(TYPE_FILE_INDEX *fileIndex, const char *dirPath);
+
+//*	calls fileProc() for the matching names from startIdx, up to maxCount of them,
+//*	nameFilter is a sub string to match (NULL or "" matches everything).
+//*	Returns the total number of matching names
+typedef void	(*FileIndex_Proc)(const char *fileName, void *context);
+int		FileIndex_Query(	TYPE_FILE_INDEX		*fileIndex,
+							const char			*nameFilter,
+							const int			startIdx,
+							const int			maxCount,
+							FileIndex_Proc		fileProc,
+							void				*context);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _FILE_INDEX_H_
@@ -43,6 +43,7 @@
 //*	Nov  4,	2022	<MLS> Added GetCommandArgumentString()
 //*	Nov  8,	2022	<MLS> Fixed bug in JSON for temperatureLog in all drivers.
 //*	Jun 18,	2023	<MLS> Added DeviceState_Add_Content() to focuser dirver
+//*	Oct 19,	2026	<MLS> Added GetFocuserIsMoving() & GetFocuserMaxStep()
 //*****************************************************************************
 
 #ifdef _ENABLE_FOCUSER_
@@ -905,6 +906,18 @@ int32_t	FocuserDriver::GetFocuserPosition(void)
 	return(cFocuserProp.Position);
 }
 
+//*****************************************************************************
+bool	FocuserDriver::GetFocuserIsMoving(void)
+{
+	return(cFocuserProp.IsMoving);
+}
+
+//*****************************************************************************
+int32_t	FocuserDriver::GetFocuserMaxStep(void)
+{
+	return(cFocuserProp.MaxStep);
+}
+
 //*****************************************************************************
 void	FocuserDriver::GetFocuserManufacturer(char *manufactString)
 {
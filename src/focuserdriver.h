@@ -9,6 +9,7 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	Nov 28,	2020	<MLS> Updated return values to TYPE_ASCOM_STATUS
+//*	Oct 19,	2026	<MLS> Added GetFocuserIsMoving() & GetFocuserMaxStep() for autofocus
 //*****************************************************************************
 //#include	"focuserdriver.h"
 
@@ -75,6 +76,8 @@ class FocuserDriver: public AlpacaDriver
 		void	GetFocuserSerialNumber(char *serialNumString);
 		double	GetFocuserTemperature(void);
 		double	GetFocuserVoltage(void);
+		bool	GetFocuserIsMoving(void);
+		int32_t	GetFocuserMaxStep(void);
 
 
 		//*	focuser specific commands
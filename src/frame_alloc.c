@@ -0,0 +1,509 @@
+//*****************************************************************************
+//*	Name:			frame_alloc.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Allocation of the big camera frame buffers
+//*
+//*					A 50 to 200 MB frame from malloc() takes a page fault on the
+//*					first touch of every 4K page, that happens during the first
+//*					readout into a new buffer, and full frame passes take TLB misses.
+//*					The buffers here are mmap()'d with all of the pages faulted in
+//*					up front and use huge pages if the system has them:
+//*						1) explicit huge pages (vm.nr_hugepages) if enough are free
+//*						2) 2MB aligned anonymous mmap with MADV_HUGEPAGE
+//*						3) malloc()
+//*					mlock() is optional, it keeps the frame out of swap on small Pis.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created frame_alloc.c
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_FRAME_ALLOC_MAIN_ benchmark
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<time.h>
+#include	<unistd.h>
+#include	<sys/mman.h>
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"frame_alloc.h"
+
+#define	kTHPageSize		(2 * 1024 * 1024)
+
+//*****************************************************************************
+static uint32_t	GetElapsed_us(const struct timespec *startTime)
+{
+struct timespec	endTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &endTime);
+	return(((endTime.tv_sec - startTime->tv_sec) * 1000000) + ((endTime.tv_nsec - startTime->tv_nsec) / 1000));
+}
+
+//*****************************************************************************
+static size_t	RoundUp(const size_t theSize, const size_t alignment)
+{
+	return(((theSize + alignment - 1) / alignment) * alignment);
+}
+
+//*****************************************************************************
+//*	returns the huge page size if there are enough free ones for this buffer, else 0
+//*****************************************************************************
+static size_t	GetFreeHugePageSize(const size_t bufferSize)
+{
+FILE	*filePointer;
+char	lineBuff[128];
+long	hugePagesFree;
+long	hugePageSize_KB;
+size_t	hugePageSize;
+
+	hugePagesFree	=	0;
+	hugePageSize_KB	=	0;
+	filePointer		=	fopen("/proc/meminfo", "r");
+	if (filePointer != NULL)
+	{
+		while (fgets(lineBuff, sizeof(lineBuff), filePointer) != NULL)
+		{
+			sscanf(lineBuff, "HugePages_Free: %ld", &hugePagesFree);
+			sscanf(lineBuff, "Hugepagesize: %ld", &hugePageSize_KB);
+		}
+		fclose(filePointer);
+	}
+	hugePageSize	=	hugePageSize_KB * 1024;
+	if ((hugePageSize > 0) && ((size_t)hugePagesFree >= (RoundUp(bufferSize, hugePageSize) / hugePageSize)))
+	{
+		return(hugePageSize);
+	}
+	return(0);
+}
+
+//*****************************************************************************
+//*	2MB aligned so the kernel can use transparent huge pages for all of it
+//*****************************************************************************
+static unsigned char	*MapAligned(const size_t mapLen)
+{
+unsigned char	*mapPtr;
+unsigned char	*alignedPtr;
+size_t			headLen;
+size_t			tailLen;
+
+	mapPtr	=	(unsigned char *)mmap(NULL, (mapLen + kTHPageSize), (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+	if (mapPtr == MAP_FAILED)
+	{
+		return(NULL);
+	}
+	alignedPtr	=	(unsigned char *)RoundUp((size_t)mapPtr, kTHPageSize);
+	headLen		=	alignedPtr - mapPtr;
+	tailLen		=	kTHPageSize - headLen;
+	if (headLen > 0)
+	{
+		munmap(mapPtr, headLen);
+	}
+	if (tailLen > 0)
+	{
+		munmap(alignedPtr + mapLen, tailLen);
+	}
+	return(alignedPtr);
+}
+
+//*****************************************************************************
+//*	MAP_POPULATE would fault the pages in before madvise(MADV_HUGEPAGE),
+//*	so they are faulted in afterwards, one write per page
+//*****************************************************************************
+static void	FaultInPages(unsigned char *dataPtr, const size_t mapLen)
+{
+size_t	offset;
+long	pageSize;
+
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(dataPtr, mapLen, MADV_POPULATE_WRITE) == 0)
+	{
+		return;
+	}
+#endif
+	pageSize	=	sysconf(_SC_PAGESIZE);
+	if (pageSize <= 0)
+	{
+		pageSize	=	4096;
+	}
+	for (offset=0; offset < mapLen; offset += pageSize)
+	{
+		dataPtr[offset]	=	0;
+	}
+}
+
+//*****************************************************************************
+bool	FrameAlloc_Allocate(TYPE_FRAME_BUFFER *frameBuffer, const size_t bufferSize, const bool lockInRAM)
+{
+struct timespec	startTime;
+size_t			hugePageSize;
+void			*mapPtr;
+
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	memset(frameBuffer, 0, sizeof(TYPE_FRAME_BUFFER));
+	frameBuffer->bufferSize	=	bufferSize;
+
+	//*	explicit huge pages, only if they have been set up
+#ifdef MAP_HUGETLB
+	hugePageSize	=	GetFreeHugePageSize(bufferSize);
+	if (hugePageSize > 0)
+	{
+		frameBuffer->mapLen	=	RoundUp(bufferSize, hugePageSize);
+		mapPtr	=	mmap(NULL, frameBuffer->mapLen, (PROT_READ | PROT_WRITE),
+							(MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE), -1, 0);
+		if (mapPtr != MAP_FAILED)
+		{
+			frameBuffer->dataPtr	=	(unsigned char *)mapPtr;
+			frameBuffer->allocType	=	kFrameAlloc_HugeTLB;
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_NUM("MAP_HUGETLB failed, errno\t=", errno);
+		}
+	}
+#else
+	(void)hugePageSize;
+#endif
+
+	//*	transparent huge pages
+	if (frameBuffer->dataPtr == NULL)
+	{
+		frameBuffer->mapLen		=	RoundUp(bufferSize, kTHPageSize);
+		frameBuffer->dataPtr	=	MapAligned(frameBuffer->mapLen);
+		if (frameBuffer->dataPtr != NULL)
+		{
+			frameBuffer->allocType	=	kFrameAlloc_Mmap;
+		#ifdef MADV_HUGEPAGE
+			if (madvise(frameBuffer->dataPtr, frameBuffer->mapLen, MADV_HUGEPAGE) == 0)
+			{
+				frameBuffer->allocType	=	kFrameAlloc_MmapTHP;
+			}
+		#endif
+			FaultInPages(frameBuffer->dataPtr, frameBuffer->mapLen);
+		}
+	}
+
+	//*	last resort
+	if (frameBuffer->dataPtr == NULL)
+	{
+		CONSOLE_DEBUG("mmap failed, using malloc()");
+		frameBuffer->mapLen		=	0;
+		frameBuffer->dataPtr	=	(unsigned char *)malloc(bufferSize);
+		if (frameBuffer->dataPtr != NULL)
+		{
+			frameBuffer->allocType	=	kFrameAlloc_Malloc;
+		}
+	}
+
+	if ((frameBuffer->dataPtr != NULL) && lockInRAM)
+	{
+		if (mlock(frameBuffer->dataPtr, bufferSize) == 0)
+		{
+			frameBuffer->locked	=	true;
+		}
+		else
+		{
+			//*	usually RLIMIT_MEMLOCK, the buffer is still usable
+			CONSOLE_DEBUG_W_NUM("mlock() failed, errno\t=", errno);
+		}
+	}
+	frameBuffer->allocTime_us	=	GetElapsed_us(&startTime);
+
+	CONSOLE_DEBUG_W_STR("Frame buffer type\t=",			FrameAlloc_GetTypeString(frameBuffer->allocType));
+	CONSOLE_DEBUG_W_NUM("Frame buffer alloc (us)\t=",	frameBuffer->allocTime_us);
+	return(frameBuffer->dataPtr != NULL);
+}
+
+//*****************************************************************************
+void	FrameAlloc_Free(TYPE_FRAME_BUFFER *frameBuffer)
+{
+	if (frameBuffer->dataPtr != NULL)
+	{
+		if (frameBuffer->mapLen > 0)
+		{
+			//*	munmap() also unlocks it
+			munmap(frameBuffer->dataPtr, frameBuffer->mapLen);
+		}
+		else
+		{
+			if (frameBuffer->locked)
+			{
+				munlock(frameBuffer->dataPtr, frameBuffer->bufferSize);
+			}
+			free(frameBuffer->dataPtr);
+		}
+	}
+	memset(frameBuffer, 0, sizeof(TYPE_FRAME_BUFFER));
+}
+
+//*****************************************************************************
+const char	*FrameAlloc_GetTypeString(const int allocType)
+{
+	switch(allocType)
+	{
+		case kFrameAlloc_Malloc:	return("malloc");
+		case kFrameAlloc_Mmap:		return("mmap");
+		case kFrameAlloc_MmapTHP:	return("mmap-THP");
+		case kFrameAlloc_HugeTLB:	return("hugetlb");
+	}
+	return("none");
+}
+
+#ifdef _INCLUDE_FRAME_ALLOC_MAIN_
+//*****************************************************************************
+//*	benchmark, malloc() vs FrameAlloc_Allocate() for a 9576x6388 16 bit frame
+//*	make framealloctest
+//*	./framealloctest [-k]		-k = mlock() the buffers
+//*****************************************************************************
+#define	kTestWidth		9576
+#define	kTestHeight		6388
+#define	kTestPasses		3
+
+//*****************************************************************************
+static double	GetTestMilliSecs(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return((timeNow.tv_sec * 1000.0) + (timeNow.tv_nsec / 1.0e6));
+}
+
+//*****************************************************************************
+//*	returns the huge page memory of this process in kB
+//*****************************************************************************
+static long	GetAnonHugePages(void)
+{
+FILE	*filePointer;
+char	lineBuff[256];
+long	hugePages_kB;
+
+	hugePages_kB	=	-1;
+	filePointer		=	fopen("/proc/self/smaps_rollup", "r");
+	if (filePointer != NULL)
+	{
+		while (fgets(lineBuff, sizeof(lineBuff), filePointer) != NULL)
+		{
+			if (strncmp(lineBuff, "AnonHugePages:", 14) == 0)
+			{
+				hugePages_kB	=	atol(&lineBuff[14]);
+			}
+		}
+		fclose(filePointer);
+	}
+	return(hugePages_kB);
+}
+
+//*****************************************************************************
+static uint32_t	RowPass(const uint16_t *pixelPtr)
+{
+uint32_t	pixelSum;
+size_t		iii;
+
+	pixelSum	=	0;
+	for (iii=0; iii<((size_t)kTestWidth * kTestHeight); iii++)
+	{
+		pixelSum	+=	pixelPtr[iii];
+	}
+	return(pixelSum);
+}
+
+//*****************************************************************************
+//*	the order imagebytes goes through the frame
+//*****************************************************************************
+static uint32_t	ColumnPass(const uint16_t *pixelPtr)
+{
+uint32_t	pixelSum;
+int			xxx;
+int			yyy;
+
+	pixelSum	=	0;
+	for (xxx=0; xxx<kTestWidth; xxx+=64)
+	{
+		for (yyy=0; yyy<kTestHeight; yyy++)
+		{
+			pixelSum	+=	pixelPtr[((size_t)yyy * kTestWidth) + xxx];
+		}
+	}
+	return(pixelSum);
+}
+
+//*****************************************************************************
+int	main(int argc, char **argv)
+{
+TYPE_FRAME_BUFFER	frameBuffer;
+uint16_t			*readoutBuff;
+uint16_t			*pixelPtr;
+size_t				bufferSize;
+size_t				iii;
+uint32_t			refRowSum;
+uint32_t			refColumnSum;
+int					passNum;
+int					useFrameAlloc;
+int					allocType;
+int					errorCnt;
+bool				lockInRAM;
+long				hugePages_kB;
+double				startTime;
+double				allocTime;
+double				copyTime;
+double				rowTime;
+double				columnTime;
+double				bestFirst;
+double				bestAlloc;
+double				bestCopy;
+double				bestRow;
+double				bestColumn;
+
+	lockInRAM	=	((argc > 1) && (strcmp(argv[1], "-k") == 0));
+	bufferSize	=	(size_t)kTestWidth * kTestHeight * sizeof(uint16_t);
+	errorCnt	=	0;
+	readoutBuff	=	(uint16_t *)malloc(bufferSize);
+	if (readoutBuff == NULL)
+	{
+		printf("Out of memory\r\n");
+		return(1);
+	}
+	//*	what the camera hands over
+	for (iii=0; iii<((size_t)kTestWidth * kTestHeight); iii++)
+	{
+		readoutBuff[iii]	=	(uint16_t)((iii * 2654435761u) >> 20);
+	}
+	refRowSum		=	RowPass(readoutBuff);
+	refColumnSum	=	ColumnPass(readoutBuff);
+	printf("%dx%d 16 bit frame, %zu MB%s\r\n", kTestWidth, kTestHeight, (bufferSize / (1024 * 1024)), (lockInRAM ? ", mlock()" : ""));
+
+	for (useFrameAlloc=0; useFrameAlloc<2; useFrameAlloc++)
+	{
+		bestFirst	=	1.0e9;
+		bestAlloc	=	1.0e9;
+		bestCopy	=	1.0e9;
+		bestRow		=	1.0e9;
+		bestColumn	=	1.0e9;
+		hugePages_kB	=	0;
+		allocType		=	kFrameAlloc_Malloc;
+		memset(&frameBuffer, 0, sizeof(TYPE_FRAME_BUFFER));
+		for (passNum=0; passNum<kTestPasses; passNum++)
+		{
+			//*	a new buffer every time, the way a camera connects
+			startTime	=	GetTestMilliSecs();
+			if (useFrameAlloc)
+			{
+				if (FrameAlloc_Allocate(&frameBuffer, bufferSize, lockInRAM) == false)
+				{
+					printf("FrameAlloc_Allocate failed\r\n");
+					errorCnt++;
+					break;
+				}
+				pixelPtr	=	(uint16_t *)frameBuffer.dataPtr;
+			}
+			else
+			{
+				pixelPtr	=	(uint16_t *)malloc(bufferSize);
+				if ((pixelPtr != NULL) && lockInRAM)
+				{
+					mlock(pixelPtr, bufferSize);
+				}
+			}
+			if (pixelPtr == NULL)
+			{
+				printf("Out of memory\r\n");
+				errorCnt++;
+				break;
+			}
+			allocTime	=	GetTestMilliSecs() - startTime;
+			hugePages_kB	=	GetAnonHugePages();
+
+			startTime	=	GetTestMilliSecs();
+			memcpy(pixelPtr, readoutBuff, bufferSize);
+			copyTime	=	GetTestMilliSecs() - startTime;
+
+			startTime	=	GetTestMilliSecs();
+			if (RowPass(pixelPtr) != refRowSum)
+			{
+				errorCnt++;
+			}
+			rowTime		=	GetTestMilliSecs() - startTime;
+
+			startTime	=	GetTestMilliSecs();
+			if (ColumnPass(pixelPtr) != refColumnSum)
+			{
+				errorCnt++;
+			}
+			columnTime	=	GetTestMilliSecs() - startTime;
+
+			if ((allocTime + copyTime) < bestFirst)
+			{
+				bestFirst	=	allocTime + copyTime;
+				bestAlloc	=	allocTime;
+				bestCopy	=	copyTime;
+			}
+			bestRow		=	(rowTime < bestRow) ? rowTime : bestRow;
+			bestColumn	=	(columnTime < bestColumn) ? columnTime : bestColumn;
+
+			if (useFrameAlloc)
+			{
+				allocType	=	frameBuffer.allocType;
+				if ((frameBuffer.bufferSize != bufferSize) || (allocType == kFrameAlloc_None))
+				{
+					printf("Wrong buffer size or type\r\n");
+					errorCnt++;
+				}
+				if (lockInRAM && (frameBuffer.locked == false))
+				{
+					//*	not an error, the buffer is still used
+					printf("mlock() failed, check ulimit -l\r\n");
+				}
+				if ((frameBuffer.allocType == kFrameAlloc_MmapTHP) && (((uintptr_t)frameBuffer.dataPtr % kTHPageSize) != 0))
+				{
+					printf("THP buffer is not 2MB aligned\r\n");
+					errorCnt++;
+				}
+				FrameAlloc_Free(&frameBuffer);
+				if (frameBuffer.dataPtr != NULL)
+				{
+					errorCnt++;
+				}
+			}
+			else
+			{
+				if (lockInRAM)
+				{
+					munlock(pixelPtr, bufferSize);
+				}
+				free(pixelPtr);
+			}
+		}
+		printf("%-10s first frame %6.1f ms (alloc %5.1f, copy %5.1f), row pass %6.0f MB/s, column pass %5.1f ms, AnonHugePages %ld kB\r\n",
+					FrameAlloc_GetTypeString(allocType),
+					bestFirst, bestAlloc, bestCopy,
+					((bufferSize / (1024.0 * 1024.0)) / (bestRow / 1000.0)),
+					bestColumn,
+					hugePages_kB);
+	}
+	free(readoutBuff);
+
+	printf("%d errors\r\n", errorCnt);
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_FRAME_ALLOC_MAIN_
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//#include	"frame_alloc.h"
+
+#ifndef _FRAME_ALLOC_H_
+#define	_FRAME_ALLOC_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+#include	<stddef.h>
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+//*****************************************************************************
+enum
+{
+	kFrameAlloc_None	=	0,
+	kFrameAlloc_Malloc,			//*	fall back, mmap failed
+	kFrameAlloc_Mmap,			//*	anonymous mmap, normal pages
+	kFrameAlloc_MmapTHP,		//*	anonymous mmap, transparent huge pages requested
+	kFrameAlloc_HugeTLB			//*	explicit huge pages (vm.nr_hugepages)
+};
+
+//*****************************************************************************
+typedef struct	//	TYPE_FRAME_BUFFER
+{
+	unsigned char	*dataPtr;
+	size_t			bufferSize;		//*	what was asked for
+	size_t			mapLen;			//*	what was mapped, 0 if malloc'd
+	int				allocType;		//*	kFrameAlloc_xxx
+	bool			locked;			//*	mlock() worked
+	uint32_t		allocTime_us;	//*	time to allocate and fault in all of the pages
+} TYPE_FRAME_BUFFER;
+
+//*	allocates a frame buffer with all of the pages already present,
+//*	using huge pages if the system has them. lockInRAM asks for mlock()
+bool		FrameAlloc_Allocate(TYPE_FRAME_BUFFER *frameBuffer, const size_t bufferSize, const bool lockInRAM);
+void		FrameAlloc_Free(TYPE_FRAME_BUFFER *frameBuffer);
+const char	*FrameAlloc_GetTypeString(const int allocType);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _FRAME_ALLOC_H_
@@ -0,0 +1,1155 @@
+//*****************************************************************************
+//*	Name:			image_encode.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Multithreaded JPEG and PNG encoding of camera images
+//*
+//*					JPEG:	The image is cut into horizontal strips, each strip is
+//*							compressed by its own libjpeg instance in its own thread
+//*							with a restart marker at the start of every MCU row.
+//*							Strips are a multiple of 8 MCU rows so the RST0-7 numbering
+//*							lines up, the entropy coded data of the strips is then
+//*							joined with RST7 markers into one standard baseline JPEG.
+//*							libjpeg-turbo does the DCT, color conversion and Huffman coding
+//*							with its own SIMD code, BGR input is handed to it directly
+//*							(JCS_EXT_BGR) so there is no extra conversion pass.
+//*
+//*					PNG:	The rows are filtered and deflated in strips (same as pigz),
+//*							each strip ends with a sync flush so the raw deflate
+//*							streams can be concatenated, the adler32 values are
+//*							combined for the zlib trailer.
+//*
+//*					With stripCount = 1 the output is a normal single stream file.
+//*
+//*					_ENABLE_JPEGLIB_	needs -ljpeg
+//*					_ENABLE_PNGLIB_		needs -lz
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	References:		https://www.w3.org/TR/png/
+//*					https://www.w3.org/Graphics/JPEG/itu-t81.pdf
+//*					https://zlib.net/pigz/
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created image_encode.c
+//*	Oct 19,	2026	<MLS> Added parallel JPEG encoding using restart markers
+//*	Oct 19,	2026	<MLS> Added parallel PNG encoding with selectable filter
+//*	Oct 19,	2026	<MLS> JPEG strip row buffer is volatile across setjmp()
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<pthread.h>
+
+#ifdef _ENABLE_JPEGLIB_
+	#include	<setjmp.h>
+	#include	<jpeglib.h>
+	#include	<jerror.h>
+#endif
+#ifdef _ENABLE_PNGLIB_
+	#include	<zlib.h>
+#endif
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"image_kernels.h"
+#include	"image_encode.h"
+
+#define	kJpegRowsPerWrite		16
+#define	kPngMinRowsPerStrip		64
+
+//*****************************************************************************
+void	ImageEncode_SetDefaults(TYPE_ENCODE_OPTIONS *options)
+{
+	options->jpegQuality	=	kImageEncode_DefaultJpegQuality;
+	options->jpegFastDCT	=	false;
+	options->pngCompression	=	kImageEncode_DefaultPngCompression;
+	options->pngFilter		=	kImageEncode_DefaultPngFilter;
+	options->stripCount		=	0;
+}
+
+#if defined(_ENABLE_JPEGLIB_) || defined(_ENABLE_PNGLIB_)
+//*****************************************************************************
+static int	GetStripLimit(const TYPE_ENCODE_OPTIONS *options)
+{
+int		stripLimit;
+
+	stripLimit	=	options->stripCount;
+	if (stripLimit <= 0)
+	{
+		stripLimit	=	ImageKernel_GetThreadCount();
+	}
+	if (stripLimit > kImageKernel_MaxThreads)
+	{
+		stripLimit	=	kImageKernel_MaxThreads;
+	}
+	if (stripLimit < 1)
+	{
+		stripLimit	=	1;
+	}
+	return(stripLimit);
+}
+
+//*****************************************************************************
+//*	runs stripProc on each strip, all but the first in separate threads.
+//*	Does not return until all strips are finished
+//*****************************************************************************
+static void	RunStrips(void *(*stripProc)(void *), void *stripArray, size_t stripSize, int stripCnt)
+{
+pthread_t	threadID[kImageKernel_MaxThreads];
+bool		threadValid[kImageKernel_MaxThreads];
+uint8_t		*stripPtr;
+int			threadErr;
+int			ii;
+
+	stripPtr	=	(uint8_t *)stripArray;
+	for (ii=1; ii<stripCnt; ii++)
+	{
+		threadValid[ii]	=	false;
+		threadErr		=	pthread_create(&threadID[ii], NULL, stripProc, (stripPtr + (ii * stripSize)));
+		if (threadErr == 0)
+		{
+			threadValid[ii]	=	true;
+		}
+		else
+		{
+			//*	could not start the thread, do it ourselves
+			CONSOLE_DEBUG_W_NUM("pthread_create failed, strip#", ii);
+			stripProc(stripPtr + (ii * stripSize));
+		}
+	}
+	stripProc(stripPtr);
+
+	for (ii=1; ii<stripCnt; ii++)
+	{
+		if (threadValid[ii])
+		{
+			pthread_join(threadID[ii], NULL);
+		}
+	}
+}
+#endif	//	_ENABLE_JPEGLIB_ || _ENABLE_PNGLIB_
+
+//*****************************************************************************
+static bool	WriteBufferToFile(const char *filePath, const uint8_t *dataBuf, size_t dataSize)
+{
+FILE	*filePointer;
+size_t	bytesWritten;
+bool	writeOK;
+
+	writeOK		=	false;
+	filePointer	=	fopen(filePath, "wb");
+	if (filePointer != NULL)
+	{
+		bytesWritten	=	fwrite(dataBuf, 1, dataSize, filePointer);
+		if (fclose(filePointer) == 0)
+		{
+			writeOK	=	(bytesWritten == dataSize);
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Failed to create file", filePath);
+	}
+	return(writeOK);
+}
+
+#ifdef _ENABLE_JPEGLIB_
+
+//*	libjpeg-turbo can take BGR directly, plain libjpeg needs it swapped first
+#ifdef JCS_EXTENSIONS
+	#define	kJpegTakesBGR	true
+#else
+	#define	kJpegTakesBGR	false
+#endif
+
+//*****************************************************************************
+typedef struct	//	TYPE_JPEG_ERROR
+{
+	struct jpeg_error_mgr	pub;
+	jmp_buf					setjmpBuffer;
+} TYPE_JPEG_ERROR;
+
+//*****************************************************************************
+//*	memory destination that grows as needed, jpeg_mem_dest() is not in every libjpeg
+typedef struct	//	TYPE_JPEG_MEMDEST
+{
+	struct jpeg_destination_mgr	pub;
+	uint8_t						*buffer;
+	size_t						bufferSize;
+} TYPE_JPEG_MEMDEST;
+
+//*****************************************************************************
+typedef struct	//	TYPE_JPEG_STRIP
+{
+	const TYPE_ENCODE_IMAGE		*image;
+	const TYPE_ENCODE_OPTIONS	*options;
+	int							firstRow;
+	int							rowCount;
+	bool						restartEachRow;
+	uint8_t						*jpegBuf;
+	size_t						jpegSize;
+	bool						encodeOK;
+} TYPE_JPEG_STRIP;
+
+//*****************************************************************************
+static void	JpegErrorExit(j_common_ptr cinfo)
+{
+TYPE_JPEG_ERROR	*jpegError;
+
+	(*cinfo->err->output_message)(cinfo);
+	jpegError	=	(TYPE_JPEG_ERROR *)cinfo->err;
+	longjmp(jpegError->setjmpBuffer, 1);
+}
+
+//*****************************************************************************
+static void	JpegDest_Init(j_compress_ptr cinfo)
+{
+TYPE_JPEG_MEMDEST	*memDest;
+
+	memDest							=	(TYPE_JPEG_MEMDEST *)cinfo->dest;
+	memDest->pub.next_output_byte	=	memDest->buffer;
+	memDest->pub.free_in_buffer		=	memDest->bufferSize;
+}
+
+//*****************************************************************************
+//*	the buffer is full, double it and keep going
+static boolean	JpegDest_Empty(j_compress_ptr cinfo)
+{
+TYPE_JPEG_MEMDEST	*memDest;
+uint8_t				*newBuffer;
+size_t				oldSize;
+
+	memDest		=	(TYPE_JPEG_MEMDEST *)cinfo->dest;
+	oldSize		=	memDest->bufferSize;
+	newBuffer	=	(uint8_t *)realloc(memDest->buffer, oldSize * 2);
+	if (newBuffer == NULL)
+	{
+		ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 10);
+	}
+	memDest->buffer					=	newBuffer;
+	memDest->bufferSize				=	oldSize * 2;
+	memDest->pub.next_output_byte	=	newBuffer + oldSize;
+	memDest->pub.free_in_buffer		=	oldSize;
+	return(TRUE);
+}
+
+//*****************************************************************************
+static void	JpegDest_Term(j_compress_ptr cinfo)
+{
+	//*	nothing to do, the size is picked up from free_in_buffer
+	(void)cinfo;
+}
+
+//*****************************************************************************
+//*	16 bit samples go to their high byte, BGR is swapped if libjpeg can not take it
+static void	ConvertRowForJpeg(uint8_t *dstPtr, const uint8_t *srcPtr, const TYPE_ENCODE_IMAGE *image)
+{
+const uint16_t	*src16Ptr;
+int				sampleCnt;
+int				ii;
+
+	sampleCnt	=	image->width * image->channels;
+	if (image->bytesPerSample == 2)
+	{
+		src16Ptr	=	(const uint16_t *)srcPtr;
+		for (ii=0; ii<sampleCnt; ii++)
+		{
+			dstPtr[ii]	=	src16Ptr[ii] >> 8;
+		}
+	}
+	else
+	{
+		memcpy(dstPtr, srcPtr, sampleCnt);
+	}
+	if ((image->channels == 3) && image->bgrOrder && (kJpegTakesBGR == false))
+	{
+		for (ii=0; ii<sampleCnt; ii+=3)
+		{
+			uint8_t	blueValue	=	dstPtr[ii];
+			dstPtr[ii]			=	dstPtr[ii + 2];
+			dstPtr[ii + 2]		=	blueValue;
+		}
+	}
+}
+
+//*****************************************************************************
+static void	*EncodeJpegStrip(void *arg)
+{
+TYPE_JPEG_STRIP				*strip;
+const TYPE_ENCODE_IMAGE		*image;
+struct jpeg_compress_struct	cinfo;
+TYPE_JPEG_ERROR				jpegError;
+TYPE_JPEG_MEMDEST			memDest;
+JSAMPROW					rowPointers[kJpegRowsPerWrite];
+uint8_t						* volatile rowBuffer;	//*	volatile, it is freed after longjmp()
+const uint8_t				*srcRowPtr;
+bool						convertRows;
+int							rowLength;
+int							rowCnt;
+int							ii;
+
+	strip			=	(TYPE_JPEG_STRIP *)arg;
+	image			=	strip->image;
+	strip->encodeOK	=	false;
+	strip->jpegBuf	=	NULL;
+	strip->jpegSize	=	0;
+
+	rowLength		=	image->width * image->channels;
+	convertRows		=	(image->bytesPerSample == 2) ||
+						((image->channels == 3) && image->bgrOrder && (kJpegTakesBGR == false));
+	rowBuffer		=	NULL;
+	if (convertRows)
+	{
+		rowBuffer	=	(uint8_t *)malloc(rowLength * kJpegRowsPerWrite);
+	}
+	memset(&memDest, 0, sizeof(TYPE_JPEG_MEMDEST));
+	memDest.bufferSize	=	((size_t)rowLength * strip->rowCount / 4) + 4096;
+	memDest.buffer		=	(uint8_t *)malloc(memDest.bufferSize);
+	if ((memDest.buffer == NULL) || (convertRows && (rowBuffer == NULL)))
+	{
+		CONSOLE_DEBUG("Failed to allocate memory");
+		free(memDest.buffer);
+		free(rowBuffer);
+		return(NULL);
+	}
+
+	cinfo.err						=	jpeg_std_error(&jpegError.pub);
+	jpegError.pub.error_exit		=	JpegErrorExit;
+	if (setjmp(jpegError.setjmpBuffer))
+	{
+		//*	libjpeg reported an error
+		jpeg_destroy_compress(&cinfo);
+		free(memDest.buffer);
+		free(rowBuffer);
+		return(NULL);
+	}
+	jpeg_create_compress(&cinfo);
+
+	memDest.pub.init_destination	=	JpegDest_Init;
+	memDest.pub.empty_output_buffer	=	JpegDest_Empty;
+	memDest.pub.term_destination	=	JpegDest_Term;
+	cinfo.dest						=	&memDest.pub;
+
+	cinfo.image_width				=	image->width;
+	cinfo.image_height				=	strip->rowCount;
+	cinfo.input_components			=	image->channels;
+	if (image->channels == 1)
+	{
+		cinfo.in_color_space		=	JCS_GRAYSCALE;
+	}
+	else
+	{
+		cinfo.in_color_space		=	JCS_RGB;
+	#ifdef JCS_EXTENSIONS
+		if (image->bgrOrder)
+		{
+			cinfo.in_color_space	=	JCS_EXT_BGR;
+		}
+	#endif
+	}
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, strip->options->jpegQuality, TRUE);
+	cinfo.dct_method				=	strip->options->jpegFastDCT ? JDCT_IFAST : JDCT_ISLOW;
+	if (strip->restartEachRow)
+	{
+		cinfo.restart_in_rows		=	1;
+	}
+	jpeg_start_compress(&cinfo, TRUE);
+
+	while (cinfo.next_scanline < cinfo.image_height)
+	{
+		rowCnt	=	cinfo.image_height - cinfo.next_scanline;
+		if (rowCnt > kJpegRowsPerWrite)
+		{
+			rowCnt	=	kJpegRowsPerWrite;
+		}
+		for (ii=0; ii<rowCnt; ii++)
+		{
+			srcRowPtr	=	image->pixels + ((size_t)(strip->firstRow + cinfo.next_scanline + ii) * image->rowBytes);
+			if (convertRows)
+			{
+				ConvertRowForJpeg(&rowBuffer[ii * rowLength], srcRowPtr, image);
+				rowPointers[ii]	=	&rowBuffer[ii * rowLength];
+			}
+			else
+			{
+				rowPointers[ii]	=	(JSAMPROW)srcRowPtr;
+			}
+		}
+		jpeg_write_scanlines(&cinfo, rowPointers, rowCnt);
+	}
+	jpeg_finish_compress(&cinfo);
+
+	strip->jpegBuf	=	memDest.buffer;
+	strip->jpegSize	=	memDest.bufferSize - memDest.pub.free_in_buffer;
+	strip->encodeOK	=	true;
+
+	jpeg_destroy_compress(&cinfo);
+	free(rowBuffer);
+	return(NULL);
+}
+
+//*****************************************************************************
+//*	finds the SOF segment and the start of the entropy coded data (just past the SOS header)
+//*****************************************************************************
+static bool	FindJpegScanData(const uint8_t *jpegBuf, size_t jpegSize, size_t *sofOffsetPtr, size_t *scanOffsetPtr)
+{
+size_t	offset;
+size_t	segmentLen;
+uint8_t	marker;
+
+	*sofOffsetPtr	=	0;
+	*scanOffsetPtr	=	0;
+	if ((jpegSize < 4) || (jpegBuf[0] != 0xFF) || (jpegBuf[1] != 0xD8))
+	{
+		return(false);
+	}
+	offset	=	2;
+	while ((offset + 4) <= jpegSize)
+	{
+		if (jpegBuf[offset] != 0xFF)
+		{
+			return(false);
+		}
+		marker		=	jpegBuf[offset + 1];
+		segmentLen	=	(jpegBuf[offset + 2] << 8) + jpegBuf[offset + 3];
+		if (marker == 0xC0)
+		{
+			*sofOffsetPtr	=	offset;
+		}
+		offset	+=	2 + segmentLen;
+		if (marker == 0xDA)
+		{
+			*scanOffsetPtr	=	offset;
+			return((*sofOffsetPtr != 0) && (offset < jpegSize));
+		}
+	}
+	return(false);
+}
+
+//*****************************************************************************
+//*	joins the strips into one JPEG, the headers are from the first strip
+//*	with the image height patched in
+//*****************************************************************************
+static bool	JoinJpegStrips(	TYPE_JPEG_STRIP	*stripList,
+							int				stripCnt,
+							int				imageHeight,
+							uint8_t			**jpegBufPtr,
+							size_t			*jpegSizePtr)
+{
+uint8_t		*jpegBuf;
+size_t		totalSize;
+size_t		outOffset;
+size_t		sofOffset;
+size_t		scanOffset;
+size_t		scanLen;
+int			ii;
+
+	totalSize	=	0;
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		totalSize	+=	stripList[ii].jpegSize;
+	}
+	//*	the strip headers that get dropped are always larger than the RST markers that replace them
+	jpegBuf	=	(uint8_t *)malloc(totalSize + 2);
+	if (jpegBuf == NULL)
+	{
+		return(false);
+	}
+	outOffset	=	0;
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		if (FindJpegScanData(stripList[ii].jpegBuf, stripList[ii].jpegSize, &sofOffset, &scanOffset) == false)
+		{
+			CONSOLE_DEBUG_W_NUM("Bad JPEG strip#", ii);
+			free(jpegBuf);
+			return(false);
+		}
+		if (ii == 0)
+		{
+			memcpy(jpegBuf, stripList[ii].jpegBuf, scanOffset);
+			jpegBuf[sofOffset + 5]	=	(imageHeight >> 8) & 0x00ff;
+			jpegBuf[sofOffset + 6]	=	imageHeight & 0x00ff;
+			outOffset				=	scanOffset;
+		}
+		else
+		{
+			//*	strips start on a multiple of 8 MCU rows, so this is always RST7
+			jpegBuf[outOffset++]	=	0xFF;
+			jpegBuf[outOffset++]	=	0xD7;
+		}
+		//*	the entropy coded data, without the EOI marker
+		scanLen	=	stripList[ii].jpegSize - scanOffset - 2;
+		memcpy(&jpegBuf[outOffset], &stripList[ii].jpegBuf[scanOffset], scanLen);
+		outOffset	+=	scanLen;
+	}
+	jpegBuf[outOffset++]	=	0xFF;
+	jpegBuf[outOffset++]	=	0xD9;
+
+	*jpegBufPtr		=	jpegBuf;
+	*jpegSizePtr	=	outOffset;
+	return(true);
+}
+
+#endif	//	_ENABLE_JPEGLIB_
+
+//*****************************************************************************
+bool	ImageEncode_JPEGsupported(void)
+{
+#ifdef _ENABLE_JPEGLIB_
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+//*****************************************************************************
+bool	ImageEncode_JPEGtoMemory(	const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									uint8_t						**jpegBufPtr,
+									size_t						*jpegSizePtr)
+{
+bool				encodeOK;
+#ifdef _ENABLE_JPEGLIB_
+TYPE_JPEG_STRIP		stripList[kImageKernel_MaxThreads];
+int					stripCnt;
+int					mcuHeight;
+int					stripGroupRows;
+int					groupCnt;
+int					rowsPerStrip;
+int					ii;
+#endif
+
+	encodeOK		=	false;
+	*jpegBufPtr		=	NULL;
+	*jpegSizePtr	=	0;
+	if ((image->pixels == NULL) || (image->width <= 0) || (image->height <= 0) ||
+		((image->channels != 1) && (image->channels != 3)))
+	{
+		return(false);
+	}
+#ifdef _ENABLE_JPEGLIB_
+	//*	strips have to be a multiple of 8 MCU rows,
+	//*	the MCU is 8 rows for mono and 16 rows for color (2x2 chroma subsampling)
+	mcuHeight		=	(image->channels == 1) ? 8 : 16;
+	stripGroupRows	=	mcuHeight * 8;
+	groupCnt		=	(image->height + stripGroupRows - 1) / stripGroupRows;
+	stripCnt		=	GetStripLimit(options);
+	if (stripCnt > groupCnt)
+	{
+		stripCnt	=	groupCnt;
+	}
+	rowsPerStrip	=	((groupCnt + stripCnt - 1) / stripCnt) * stripGroupRows;
+	stripCnt		=	(image->height + rowsPerStrip - 1) / rowsPerStrip;
+
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		stripList[ii].image				=	image;
+		stripList[ii].options			=	options;
+		stripList[ii].firstRow			=	ii * rowsPerStrip;
+		stripList[ii].rowCount			=	rowsPerStrip;
+		if ((stripList[ii].firstRow + rowsPerStrip) > image->height)
+		{
+			stripList[ii].rowCount		=	image->height - stripList[ii].firstRow;
+		}
+		stripList[ii].restartEachRow	=	(stripCnt > 1);
+		stripList[ii].jpegBuf			=	NULL;
+		stripList[ii].jpegSize			=	0;
+		stripList[ii].encodeOK			=	false;
+	}
+	RunStrips(EncodeJpegStrip, stripList, sizeof(TYPE_JPEG_STRIP), stripCnt);
+
+	encodeOK	=	true;
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		encodeOK	=	encodeOK && stripList[ii].encodeOK;
+	}
+	if (encodeOK)
+	{
+		if (stripCnt == 1)
+		{
+			*jpegBufPtr			=	stripList[0].jpegBuf;
+			*jpegSizePtr		=	stripList[0].jpegSize;
+			stripList[0].jpegBuf	=	NULL;
+		}
+		else
+		{
+			encodeOK	=	JoinJpegStrips(stripList, stripCnt, image->height, jpegBufPtr, jpegSizePtr);
+		}
+	}
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		free(stripList[ii].jpegBuf);
+	}
+#else
+	(void)options;
+	CONSOLE_DEBUG("Not built with _ENABLE_JPEGLIB_");
+#endif	//	_ENABLE_JPEGLIB_
+	return(encodeOK);
+}
+
+//*****************************************************************************
+bool	ImageEncode_SaveJPEG(	const TYPE_ENCODE_IMAGE		*image,
+								const TYPE_ENCODE_OPTIONS	*options,
+								const char					*filePath)
+{
+uint8_t		*jpegBuf;
+size_t		jpegSize;
+bool		saveOK;
+
+	saveOK	=	ImageEncode_JPEGtoMemory(image, options, &jpegBuf, &jpegSize);
+	if (saveOK)
+	{
+		saveOK	=	WriteBufferToFile(filePath, jpegBuf, jpegSize);
+		free(jpegBuf);
+	}
+	return(saveOK);
+}
+
+#ifdef _ENABLE_PNGLIB_
+
+//*****************************************************************************
+typedef struct	//	TYPE_PNG_STRIP
+{
+	const TYPE_ENCODE_IMAGE		*image;
+	const TYPE_ENCODE_OPTIONS	*options;
+	int							firstRow;
+	int							rowCount;
+	bool						lastStrip;
+	uint8_t						*zBuf;
+	size_t						zSize;
+	uLong						adler;
+	size_t						rawSize;		//*	filtered bytes fed to deflate
+	bool						encodeOK;
+} TYPE_PNG_STRIP;
+
+//*****************************************************************************
+//*	returns a pointer to the row in PNG order (RGB, big endian),
+//*	rowBuffer is only used if the row has to be converted
+//*****************************************************************************
+static const uint8_t	*GetPNGrow(const TYPE_ENCODE_IMAGE *image, int rowNum, uint8_t *rowBuffer)
+{
+const uint8_t	*srcPtr;
+const uint16_t	*src16Ptr;
+int				sampleCnt;
+int				ii;
+
+	srcPtr		=	image->pixels + ((size_t)rowNum * image->rowBytes);
+	sampleCnt	=	image->width * image->channels;
+	if (image->bytesPerSample == 2)
+	{
+		src16Ptr	=	(const uint16_t *)srcPtr;
+		for (ii=0; ii<sampleCnt; ii++)
+		{
+			rowBuffer[ii * 2]		=	src16Ptr[ii] >> 8;
+			rowBuffer[(ii * 2) + 1]	=	src16Ptr[ii] & 0x00ff;
+		}
+		if ((image->channels == 3) && image->bgrOrder)
+		{
+			for (ii=0; ii<(sampleCnt * 2); ii+=6)
+			{
+				uint8_t	blueHigh		=	rowBuffer[ii];
+				uint8_t	blueLow			=	rowBuffer[ii + 1];
+				rowBuffer[ii]			=	rowBuffer[ii + 4];
+				rowBuffer[ii + 1]		=	rowBuffer[ii + 5];
+				rowBuffer[ii + 4]		=	blueHigh;
+				rowBuffer[ii + 5]		=	blueLow;
+			}
+		}
+		return(rowBuffer);
+	}
+	else if ((image->channels == 3) && image->bgrOrder)
+	{
+		for (ii=0; ii<sampleCnt; ii+=3)
+		{
+			rowBuffer[ii]		=	srcPtr[ii + 2];
+			rowBuffer[ii + 1]	=	srcPtr[ii + 1];
+			rowBuffer[ii + 2]	=	srcPtr[ii];
+		}
+		return(rowBuffer);
+	}
+	return(srcPtr);
+}
+
+//*****************************************************************************
+static inline uint8_t	PaethPredictor(int leftValue, int upValue, int upLeftValue)
+{
+int		estimate;
+int		leftDist;
+int		upDist;
+int		upLeftDist;
+
+	estimate	=	leftValue + upValue - upLeftValue;
+	leftDist	=	abs(estimate - leftValue);
+	upDist		=	abs(estimate - upValue);
+	upLeftDist	=	abs(estimate - upLeftValue);
+	if ((leftDist <= upDist) && (leftDist <= upLeftDist))
+	{
+		return(leftValue);
+	}
+	else if (upDist <= upLeftDist)
+	{
+		return(upValue);
+	}
+	return(upLeftValue);
+}
+
+//*****************************************************************************
+//*	dstPtr gets the filter type byte followed by the filtered row
+//*	prevPtr is a row of zeros for the first row of the image
+//*****************************************************************************
+static void	FilterPNGrow(	uint8_t			*dstPtr,
+							const int		filterType,
+							const uint8_t	*curPtr,
+							const uint8_t	*prevPtr,
+							const int		lineBytes,
+							const int		bpp)
+{
+int		ii;
+
+	dstPtr[0]	=	filterType;
+	dstPtr++;
+	switch(filterType)
+	{
+		case kPNGfilter_Sub:
+			memcpy(dstPtr, curPtr, bpp);
+			for (ii=bpp; ii<lineBytes; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - curPtr[ii - bpp];
+			}
+			break;
+
+		case kPNGfilter_Up:
+			for (ii=0; ii<lineBytes; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - prevPtr[ii];
+			}
+			break;
+
+		case kPNGfilter_Average:
+			for (ii=0; ii<bpp; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - (prevPtr[ii] >> 1);
+			}
+			for (ii=bpp; ii<lineBytes; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - ((curPtr[ii - bpp] + prevPtr[ii]) >> 1);
+			}
+			break;
+
+		case kPNGfilter_Paeth:
+			for (ii=0; ii<bpp; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - prevPtr[ii];
+			}
+			for (ii=bpp; ii<lineBytes; ii++)
+			{
+				dstPtr[ii]	=	curPtr[ii] - PaethPredictor(curPtr[ii - bpp], prevPtr[ii], prevPtr[ii - bpp]);
+			}
+			break;
+
+		case kPNGfilter_None:
+		default:
+			dstPtr[-1]	=	kPNGfilter_None;
+			memcpy(dstPtr, curPtr, lineBytes);
+			break;
+	}
+}
+
+//*****************************************************************************
+//*	sum of the filtered bytes taken as signed, the same heuristic libpng uses
+static uint32_t	FilterCost(const uint8_t *filteredPtr, const int lineBytes)
+{
+uint32_t	costSum;
+int			ii;
+
+	costSum	=	0;
+	for (ii=0; ii<lineBytes; ii++)
+	{
+		costSum	+=	abs((int8_t)filteredPtr[ii]);
+	}
+	return(costSum);
+}
+
+//*****************************************************************************
+static bool	DeflatePNGbytes(TYPE_PNG_STRIP *strip, z_stream *zStream, const uint8_t *dataPtr, size_t dataLen, int flushMode)
+{
+uint8_t		*newBuffer;
+size_t		usedBytes;
+int			zErr;
+
+	zStream->next_in	=	(Bytef *)dataPtr;
+	zStream->avail_in	=	dataLen;
+	do
+	{
+		if (zStream->avail_out == 0)
+		{
+			usedBytes	=	zStream->next_out - strip->zBuf;
+			newBuffer	=	(uint8_t *)realloc(strip->zBuf, usedBytes * 2);
+			if (newBuffer == NULL)
+			{
+				return(false);
+			}
+			strip->zBuf			=	newBuffer;
+			zStream->next_out	=	newBuffer + usedBytes;
+			zStream->avail_out	=	usedBytes;
+		}
+		zErr	=	deflate(zStream, flushMode);
+		if (zErr == Z_STREAM_ERROR)
+		{
+			return(false);
+		}
+	} while ((zStream->avail_in > 0) || (zStream->avail_out == 0) ||
+			((flushMode == Z_FINISH) && (zErr != Z_STREAM_END)));
+	return(true);
+}
+
+//*****************************************************************************
+static void	*EncodePNGstrip(void *arg)
+{
+TYPE_PNG_STRIP			*strip;
+const TYPE_ENCODE_IMAGE	*image;
+z_stream				zStream;
+uint8_t					*workBuffer;
+uint8_t					*convertBuf[2];
+uint8_t					*zeroRow;
+uint8_t					*filterBuf[kPNGfilter_Adaptive];
+const uint8_t			*curRowPtr;
+const uint8_t			*prevRowPtr;
+const uint8_t			*bestRowPtr;
+uint32_t				bestCost;
+uint32_t				filterCost;
+size_t					lineBytes;
+size_t					zBufSize;
+int						bpp;
+int						filterType;
+int						rowNum;
+int						flushMode;
+int						ii;
+bool					deflateOK;
+
+	strip			=	(TYPE_PNG_STRIP *)arg;
+	image			=	strip->image;
+	strip->encodeOK	=	false;
+	strip->zBuf		=	NULL;
+	strip->zSize	=	0;
+
+	bpp				=	image->channels * image->bytesPerSample;
+	lineBytes		=	(size_t)image->width * bpp;
+	strip->rawSize	=	(lineBytes + 1) * strip->rowCount;
+	strip->adler	=	adler32(0L, Z_NULL, 0);
+
+	//*	2 conversion rows, a row of zeros and the filter outputs
+	workBuffer		=	(uint8_t *)calloc(3 + kPNGfilter_Adaptive, lineBytes + 1);
+	if (workBuffer == NULL)
+	{
+		return(NULL);
+	}
+	convertBuf[0]	=	workBuffer;
+	convertBuf[1]	=	workBuffer + (lineBytes + 1);
+	zeroRow			=	workBuffer + (2 * (lineBytes + 1));
+	for (ii=0; ii<kPNGfilter_Adaptive; ii++)
+	{
+		filterBuf[ii]	=	workBuffer + ((3 + ii) * (lineBytes + 1));
+	}
+
+	memset(&zStream, 0, sizeof(z_stream));
+	//*	raw deflate, the zlib header and trailer are added when the strips are joined
+	if (deflateInit2(&zStream,
+					strip->options->pngCompression,
+					Z_DEFLATED,
+					-15,
+					8,
+					((strip->options->pngFilter == kPNGfilter_None) ? Z_DEFAULT_STRATEGY : Z_FILTERED)) != Z_OK)
+	{
+		free(workBuffer);
+		return(NULL);
+	}
+	zBufSize		=	deflateBound(&zStream, strip->rawSize) + 64;
+	strip->zBuf		=	(uint8_t *)malloc(zBufSize);
+	deflateOK		=	(strip->zBuf != NULL);
+	zStream.next_out	=	strip->zBuf;
+	zStream.avail_out	=	zBufSize;
+
+	//*	the first row of the strip is filtered against the last row of the previous strip
+	prevRowPtr	=	zeroRow;
+	if (strip->firstRow > 0)
+	{
+		prevRowPtr	=	GetPNGrow(image, (strip->firstRow - 1), convertBuf[1]);
+	}
+	for (ii=0; deflateOK && (ii<strip->rowCount); ii++)
+	{
+		rowNum		=	strip->firstRow + ii;
+		curRowPtr	=	GetPNGrow(image, rowNum, convertBuf[ii & 1]);
+		if (strip->options->pngFilter == kPNGfilter_Adaptive)
+		{
+			bestRowPtr	=	NULL;
+			bestCost	=	0;
+			for (filterType=kPNGfilter_None; filterType<kPNGfilter_Adaptive; filterType++)
+			{
+				FilterPNGrow(filterBuf[filterType], filterType, curRowPtr, prevRowPtr, lineBytes, bpp);
+				filterCost	=	FilterCost(filterBuf[filterType] + 1, lineBytes);
+				if ((bestRowPtr == NULL) || (filterCost < bestCost))
+				{
+					bestRowPtr	=	filterBuf[filterType];
+					bestCost	=	filterCost;
+				}
+			}
+		}
+		else
+		{
+			FilterPNGrow(filterBuf[0], strip->options->pngFilter, curRowPtr, prevRowPtr, lineBytes, bpp);
+			bestRowPtr	=	filterBuf[0];
+		}
+		strip->adler	=	adler32(strip->adler, bestRowPtr, (lineBytes + 1));
+
+		flushMode	=	Z_NO_FLUSH;
+		if (ii == (strip->rowCount - 1))
+		{
+			//*	a sync flush ends on a byte boundary, so the next strip can follow directly
+			flushMode	=	strip->lastStrip ? Z_FINISH : Z_SYNC_FLUSH;
+		}
+		deflateOK	=	DeflatePNGbytes(strip, &zStream, bestRowPtr, (lineBytes + 1), flushMode);
+
+		//*	if the row was not converted, it is still in the image
+		prevRowPtr	=	curRowPtr;
+	}
+	if (deflateOK)
+	{
+		strip->zSize	=	zStream.next_out - strip->zBuf;
+		strip->encodeOK	=	true;
+	}
+	deflateEnd(&zStream);
+	free(workBuffer);
+	return(NULL);
+}
+
+//*****************************************************************************
+static void	PutBigEndian32(uint8_t *dstPtr, uint32_t value)
+{
+	dstPtr[0]	=	(value >> 24) & 0x00ff;
+	dstPtr[1]	=	(value >> 16) & 0x00ff;
+	dstPtr[2]	=	(value >> 8) & 0x00ff;
+	dstPtr[3]	=	value & 0x00ff;
+}
+
+//*****************************************************************************
+//*	a chunk made of up to 3 pieces so the zlib header and trailer do not need another copy
+//*****************************************************************************
+static size_t	AppendPNGchunk(	uint8_t			*dstPtr,
+								const char		*chunkType,
+								const uint8_t	*data1, size_t len1,
+								const uint8_t	*data2, size_t len2,
+								const uint8_t	*data3, size_t len3)
+{
+uLong	chunkCRC;
+size_t	dataLen;
+size_t	offset;
+
+	dataLen	=	len1 + len2 + len3;
+	PutBigEndian32(dstPtr, dataLen);
+	memcpy(&dstPtr[4], chunkType, 4);
+	offset	=	8;
+	if (len1 > 0)
+	{
+		memcpy(&dstPtr[offset], data1, len1);
+		offset	+=	len1;
+	}
+	if (len2 > 0)
+	{
+		memcpy(&dstPtr[offset], data2, len2);
+		offset	+=	len2;
+	}
+	if (len3 > 0)
+	{
+		memcpy(&dstPtr[offset], data3, len3);
+		offset	+=	len3;
+	}
+	chunkCRC	=	crc32(0L, &dstPtr[4], (4 + dataLen));
+	PutBigEndian32(&dstPtr[offset], chunkCRC);
+	return(offset + 4);
+}
+
+#endif	//	_ENABLE_PNGLIB_
+
+//*****************************************************************************
+bool	ImageEncode_PNGsupported(void)
+{
+#ifdef _ENABLE_PNGLIB_
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+//*****************************************************************************
+bool	ImageEncode_PNGtoMemory(	const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									uint8_t						**pngBufPtr,
+									size_t						*pngSizePtr)
+{
+bool					encodeOK;
+#ifdef _ENABLE_PNGLIB_
+static const uint8_t	pngSignature[8]	=	{0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+TYPE_ENCODE_OPTIONS		pngOptions;
+TYPE_PNG_STRIP			stripList[kImageKernel_MaxThreads];
+uint8_t					headerData[13];
+uint8_t					zlibHeader[2];
+uint8_t					zlibTrailer[4];
+uint8_t					*pngBuf;
+size_t					pngSize;
+size_t					offset;
+uLong					adlerValue;
+int						stripCnt;
+int						rowsPerStrip;
+int						zLevel;
+int						flagByte;
+int						ii;
+#endif
+
+	encodeOK		=	false;
+	*pngBufPtr		=	NULL;
+	*pngSizePtr		=	0;
+	if ((image->pixels == NULL) || (image->width <= 0) || (image->height <= 0) ||
+		((image->channels != 1) && (image->channels != 3)))
+	{
+		return(false);
+	}
+#ifdef _ENABLE_PNGLIB_
+	pngOptions	=	*options;
+	if ((pngOptions.pngCompression < 0) || (pngOptions.pngCompression > 9))
+	{
+		pngOptions.pngCompression	=	kImageEncode_DefaultPngCompression;
+	}
+	if ((pngOptions.pngFilter < kPNGfilter_None) || (pngOptions.pngFilter >= kPNGfilter_Last))
+	{
+		pngOptions.pngFilter	=	kImageEncode_DefaultPngFilter;
+	}
+
+	stripCnt	=	GetStripLimit(&pngOptions);
+	if (stripCnt > (image->height / kPngMinRowsPerStrip))
+	{
+		stripCnt	=	image->height / kPngMinRowsPerStrip;
+	}
+	if (stripCnt < 1)
+	{
+		stripCnt	=	1;
+	}
+	rowsPerStrip	=	(image->height + stripCnt - 1) / stripCnt;
+	stripCnt		=	(image->height + rowsPerStrip - 1) / rowsPerStrip;
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		stripList[ii].image		=	image;
+		stripList[ii].options	=	&pngOptions;
+		stripList[ii].firstRow	=	ii * rowsPerStrip;
+		stripList[ii].rowCount	=	rowsPerStrip;
+		if ((stripList[ii].firstRow + rowsPerStrip) > image->height)
+		{
+			stripList[ii].rowCount	=	image->height - stripList[ii].firstRow;
+		}
+		stripList[ii].lastStrip	=	(ii == (stripCnt - 1));
+		stripList[ii].zBuf		=	NULL;
+		stripList[ii].zSize		=	0;
+		stripList[ii].encodeOK	=	false;
+	}
+	RunStrips(EncodePNGstrip, stripList, sizeof(TYPE_PNG_STRIP), stripCnt);
+
+	encodeOK	=	true;
+	pngSize		=	sizeof(pngSignature) + (12 + sizeof(headerData)) + 12;	//*	signature, IHDR, IEND
+	pngSize		+=	sizeof(zlibHeader) + sizeof(zlibTrailer);
+	adlerValue	=	adler32(0L, Z_NULL, 0);
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		encodeOK	=	encodeOK && stripList[ii].encodeOK;
+		pngSize		+=	12 + stripList[ii].zSize;
+		adlerValue	=	adler32_combine(adlerValue, stripList[ii].adler, stripList[ii].rawSize);
+	}
+	pngBuf	=	NULL;
+	if (encodeOK)
+	{
+		pngBuf	=	(uint8_t *)malloc(pngSize);
+		encodeOK	=	(pngBuf != NULL);
+	}
+	if (encodeOK)
+	{
+		memcpy(pngBuf, pngSignature, sizeof(pngSignature));
+		offset	=	sizeof(pngSignature);
+
+		PutBigEndian32(&headerData[0],	image->width);
+		PutBigEndian32(&headerData[4],	image->height);
+		headerData[8]	=	image->bytesPerSample * 8;			//*	bit depth
+		headerData[9]	=	(image->channels == 3) ? 2 : 0;		//*	color type, RGB or gray
+		headerData[10]	=	0;									//*	compression
+		headerData[11]	=	0;									//*	filter method
+		headerData[12]	=	0;									//*	no interlace
+		offset	+=	AppendPNGchunk(&pngBuf[offset], "IHDR", headerData, sizeof(headerData), NULL, 0, NULL, 0);
+
+		//*	zlib header, 32k window, the level bits are informational only
+		zLevel			=	pngOptions.pngCompression;
+		zlibHeader[0]	=	0x78;
+		flagByte		=	((zLevel < 2) ? 0 : ((zLevel < 6) ? 1 : ((zLevel == 6) ? 2 : 3))) << 6;
+		flagByte		+=	31 - (((zlibHeader[0] << 8) + flagByte) % 31);
+		zlibHeader[1]	=	flagByte;
+		PutBigEndian32(zlibTrailer, adlerValue);
+
+		//*	one IDAT per strip
+		for (ii=0; ii<stripCnt; ii++)
+		{
+			offset	+=	AppendPNGchunk(	&pngBuf[offset],
+										"IDAT",
+										zlibHeader,			((ii == 0) ? sizeof(zlibHeader) : 0),
+										stripList[ii].zBuf,	stripList[ii].zSize,
+										zlibTrailer,		((ii == (stripCnt - 1)) ? sizeof(zlibTrailer) : 0));
+		}
+		offset	+=	AppendPNGchunk(&pngBuf[offset], "IEND", NULL, 0, NULL, 0, NULL, 0);
+
+		*pngBufPtr	=	pngBuf;
+		*pngSizePtr	=	offset;
+	}
+	for (ii=0; ii<stripCnt; ii++)
+	{
+		free(stripList[ii].zBuf);
+	}
+#else
+	(void)options;
+	CONSOLE_DEBUG("Not built with _ENABLE_PNGLIB_");
+#endif	//	_ENABLE_PNGLIB_
+	return(encodeOK);
+}
+
+//*****************************************************************************
+bool	ImageEncode_SavePNG(const TYPE_ENCODE_IMAGE		*image,
+							const TYPE_ENCODE_OPTIONS	*options,
+							const char					*filePath)
+{
+uint8_t		*pngBuf;
+size_t		pngSize;
+bool		saveOK;
+
+	saveOK	=	ImageEncode_PNGtoMemory(image, options, &pngBuf, &pngSize);
+	if (saveOK)
+	{
+		saveOK	=	WriteBufferToFile(filePath, pngBuf, pngSize);
+		free(pngBuf);
+	}
+	return(saveOK);
+}
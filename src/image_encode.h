@@ -0,0 +1,87 @@
+//*****************************************************************************
+//#include	"image_encode.h"
+
+#ifndef _IMAGE_ENCODE_H_
+#define	_IMAGE_ENCODE_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+#include	<stddef.h>
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+//*****************************************************************************
+enum
+{
+	kPNGfilter_None	=	0,
+	kPNGfilter_Sub,
+	kPNGfilter_Up,
+	kPNGfilter_Average,
+	kPNGfilter_Paeth,
+	kPNGfilter_Adaptive,		//*	pick the best filter for each row, same as libpng
+
+	kPNGfilter_Last
+};
+
+#define	kImageEncode_DefaultJpegQuality		95
+#define	kImageEncode_DefaultPngCompression	3
+#define	kImageEncode_DefaultPngFilter		kPNGfilter_Up
+
+//*****************************************************************************
+typedef struct	//	TYPE_ENCODE_IMAGE
+{
+	const uint8_t	*pixels;
+	int				width;
+	int				height;
+	int				rowBytes;			//*	distance from one row to the next
+	int				channels;			//*	1 = mono, 3 = color
+	int				bytesPerSample;		//*	1 or 2, 16 bit samples are in host byte order
+	bool			bgrOrder;			//*	OpenCV images are BGR
+} TYPE_ENCODE_IMAGE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_ENCODE_OPTIONS
+{
+	int		jpegQuality;		//*	1 -> 100
+	bool	jpegFastDCT;		//*	JDCT_IFAST instead of JDCT_ISLOW
+	int		pngCompression;		//*	zlib level, 0 -> 9
+	int		pngFilter;			//*	kPNGfilter_xxx
+	int		stripCount;			//*	0 = one per cpu, 1 = single threaded
+} TYPE_ENCODE_OPTIONS;
+
+void	ImageEncode_SetDefaults(TYPE_ENCODE_OPTIONS *options);
+bool	ImageEncode_JPEGsupported(void);
+bool	ImageEncode_PNGsupported(void);
+
+//*	the memory versions return a malloc'd buffer, the caller must free() it
+//*	16 bit samples are reduced to 8 bits for JPEG (the high byte)
+bool	ImageEncode_JPEGtoMemory(	const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									uint8_t						**jpegBufPtr,
+									size_t						*jpegSizePtr);
+bool	ImageEncode_SaveJPEG(		const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									const char					*filePath);
+
+bool	ImageEncode_PNGtoMemory(	const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									uint8_t						**pngBufPtr,
+									size_t						*pngSizePtr);
+bool	ImageEncode_SavePNG(		const TYPE_ENCODE_IMAGE		*image,
+									const TYPE_ENCODE_OPTIONS	*options,
+									const char					*filePath);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _IMAGE_ENCODE_H_
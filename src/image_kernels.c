@@ -0,0 +1,3756 @@
+//*****************************************************************************
+//*	Name:			image_kernels.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Low level image processing kernels used by the camera driver
+//*					These are the inner loops that have to run on every frame,
+//*					they use SSE2 on x86 and NEON on ARM with a plain C fallback
+//*
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created image_kernels.c
+//*	Oct 19,	2026	<MLS> Added ImageKernel_RunRowBands()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_StackAdd_U8() & ImageKernel_StackAdd_U16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_ScaleToU8() & ImageKernel_ScaleToU16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_Calibrate_U8() & ImageKernel_Calibrate_U16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_ScanAbove_U8() & ImageKernel_ScanAbove_U16()
+//*	Oct 19,	2026	<MLS> Added Bayer demosaic, ImageKernel_DemosaicRow_U8/U16/U16toU8()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_BlendPremult_U8() & ImageKernel_BlendPremult_U16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_Downsample2xRow_U8() & ImageKernel_Downsample2xRow_U16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_OrReduce_U16(), ImageKernel_PackBits_U16() & ImageKernel_UnpackBits_U16()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_BinRow_U8(), ImageKernel_BinRow_U16() & ImageKernel_CropRows()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_Histogram_U8/U16() & ImageKernel_LUT_U8/U16toU8()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_Histogram_BGR()
+//*	Oct 19,	2026	<MLS> Added ImageKernel_DeflateElements() & ImageKernel_InflateElements()
+//*	Oct 19,	2026	<MLS> Stack accumulators changed from float to double
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_IMAGE_KERNELS_MAIN_ self test, make kerneltest
+//*	Oct 19,	2026	<MLS> Added demosaic tests to the self test
+//*	Oct 19,	2026	<MLS> Added pack/unpack round trip and benchmark to the self test
+//*	Oct 19,	2026	<MLS> Added binning and crop tests and the binning benchmark to the self test
+//*	Oct 19,	2026	<MLS> Added deflate round trip and benchmark to the self test
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<math.h>
+#include	<pthread.h>
+#include	<unistd.h>
+#include	<time.h>
+
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+	#include	<zlib.h>
+#endif
+
+#if defined(__SSE2__)
+	#include	<emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include	<arm_neon.h>
+	#define	_IMAGE_KERNEL_NEON_
+	#if defined(__aarch64__)
+		#define	_IMAGE_KERNEL_NEON64_
+	#endif
+#endif
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"image_kernels.h"
+
+//*	bands smaller than this are not worth starting a thread for
+#define	kMinRowsPerBand		32
+
+static int	gImageKernelThreadCnt	=	0;
+
+//*****************************************************************************
+typedef struct	//	TYPE_BAND_INFO
+{
+	ImageKernel_BandProc	bandProc;
+	void					*context;
+	int						firstRow;
+	int						lastRow;
+} TYPE_BAND_INFO;
+
+//*****************************************************************************
+int	ImageKernel_GetThreadCount(void)
+{
+long	cpuCount;
+
+	if (gImageKernelThreadCnt <= 0)
+	{
+		cpuCount	=	sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpuCount < 1)
+		{
+			cpuCount	=	1;
+		}
+		if (cpuCount > kImageKernel_MaxThreads)
+		{
+			cpuCount	=	kImageKernel_MaxThreads;
+		}
+		gImageKernelThreadCnt	=	cpuCount;
+		CONSOLE_DEBUG_W_NUM("gImageKernelThreadCnt\t=", gImageKernelThreadCnt);
+	}
+	return(gImageKernelThreadCnt);
+}
+
+//*****************************************************************************
+static void	*ImageKernel_BandThread(void *arg)
+{
+TYPE_BAND_INFO	*bandInfo;
+
+	bandInfo	=	(TYPE_BAND_INFO *)arg;
+	bandInfo->bandProc(bandInfo->context, bandInfo->firstRow, bandInfo->lastRow);
+	return(NULL);
+}
+
+//*****************************************************************************
+//*	splits the rows into bands, runs all but the first band in separate threads,
+//*	the first band is run in the calling thread.
+//*	Does not return until all bands are finished
+//*****************************************************************************
+void	ImageKernel_RunRowBands(int numRows, ImageKernel_BandProc bandProc, void *context)
+{
+TYPE_BAND_INFO	bandInfo[kImageKernel_MaxThreads];
+pthread_t		threadID[kImageKernel_MaxThreads];
+bool			threadValid[kImageKernel_MaxThreads];
+int				threadCnt;
+int				rowsPerBand;
+int				threadErr;
+int				ii;
+
+	if ((bandProc == NULL) || (numRows <= 0))
+	{
+		return;
+	}
+	threadCnt	=	ImageKernel_GetThreadCount();
+	if (numRows < (threadCnt * kMinRowsPerBand))
+	{
+		threadCnt	=	numRows / kMinRowsPerBand;
+	}
+	if (threadCnt <= 1)
+	{
+		bandProc(context, 0, numRows);
+		return;
+	}
+
+	rowsPerBand	=	(numRows + threadCnt - 1) / threadCnt;
+	for (ii=0; ii<threadCnt; ii++)
+	{
+		bandInfo[ii].bandProc	=	bandProc;
+		bandInfo[ii].context	=	context;
+		bandInfo[ii].firstRow	=	ii * rowsPerBand;
+		bandInfo[ii].lastRow	=	bandInfo[ii].firstRow + rowsPerBand;
+		if (bandInfo[ii].lastRow > numRows)
+		{
+			bandInfo[ii].lastRow	=	numRows;
+		}
+		threadValid[ii]	=	false;
+	}
+
+	for (ii=1; ii<threadCnt; ii++)
+	{
+		threadErr	=	pthread_create(&threadID[ii], NULL, &ImageKernel_BandThread, &bandInfo[ii]);
+		if (threadErr == 0)
+		{
+			threadValid[ii]	=	true;
+		}
+		else
+		{
+			//*	could not start the thread, do it ourselves
+			CONSOLE_DEBUG_W_NUM("pthread_create failed, band#", ii);
+			ImageKernel_BandThread(&bandInfo[ii]);
+		}
+	}
+	ImageKernel_BandThread(&bandInfo[0]);
+
+	for (ii=1; ii<threadCnt; ii++)
+	{
+		if (threadValid[ii])
+		{
+			pthread_join(threadID[ii], NULL);
+		}
+	}
+}
+
+//*****************************************************************************
+//*	the stack accumulators are double, a float sum of RAW16 frames is not exact
+//*	after 256 frames and the sumSq - (mean * mean) variance cancels out
+//*****************************************************************************
+//*	scalar version of the stack update, used for the tail end and non SIMD builds
+//*****************************************************************************
+static inline void	StackAdd1(	double			*sumPtr,
+								double			*sumSqPtr,
+								double			pixValue,
+								const double	invFrameCnt,
+								const double	clipSigmaSqrd)
+{
+double	meanValue;
+double	variance;
+double	delta;
+
+	if (sumSqPtr != NULL)
+	{
+		if (clipSigmaSqrd > 0.0)
+		{
+			meanValue	=	*sumPtr * invFrameCnt;
+			variance	=	(*sumSqPtr * invFrameCnt) - (meanValue * meanValue);
+			if (variance < 1.0)
+			{
+				variance	=	1.0;
+			}
+			delta		=	pixValue - meanValue;
+			if ((delta * delta) > (variance * clipSigmaSqrd))
+			{
+				pixValue	=	meanValue;
+			}
+		}
+		*sumSqPtr	+=	pixValue * pixValue;
+	}
+	*sumPtr	+=	pixValue;
+}
+
+#if defined(__SSE2__)
+//*****************************************************************************
+static inline void	StackAdd2_SSE2(	double			*sumPtr,
+									double			*sumSqPtr,
+									__m128d			pixValue,
+									const __m128d	invFrameCnt,
+									const __m128d	clipSigmaSqrd,
+									const bool		clipping)
+{
+__m128d	sumValue;
+__m128d	sqValue;
+__m128d	meanValue;
+__m128d	variance;
+__m128d	delta;
+__m128d	keepMask;
+
+	sumValue	=	_mm_loadu_pd(sumPtr);
+	if (sumSqPtr != NULL)
+	{
+		sqValue	=	_mm_loadu_pd(sumSqPtr);
+		if (clipping)
+		{
+			meanValue	=	_mm_mul_pd(sumValue, invFrameCnt);
+			variance	=	_mm_sub_pd(_mm_mul_pd(sqValue, invFrameCnt), _mm_mul_pd(meanValue, meanValue));
+			variance	=	_mm_max_pd(variance, _mm_set1_pd(1.0));
+			delta		=	_mm_sub_pd(pixValue, meanValue);
+			keepMask	=	_mm_cmple_pd(_mm_mul_pd(delta, delta), _mm_mul_pd(variance, clipSigmaSqrd));
+			pixValue	=	_mm_or_pd(_mm_and_pd(keepMask, pixValue), _mm_andnot_pd(keepMask, meanValue));
+		}
+		_mm_storeu_pd(sumSqPtr, _mm_add_pd(sqValue, _mm_mul_pd(pixValue, pixValue)));
+	}
+	_mm_storeu_pd(sumPtr, _mm_add_pd(sumValue, pixValue));
+}
+
+//*****************************************************************************
+//*	4 pixels as 32 bit ints, done as 2 pairs of doubles
+//*****************************************************************************
+static inline void	StackAdd4_SSE2(	double			*sumPtr,
+									double			*sumSqPtr,
+									__m128i			pixValue,
+									const __m128d	invFrameCnt,
+									const __m128d	clipSigmaSqrd,
+									const bool		clipping)
+{
+	StackAdd2_SSE2(sumPtr,		sumSqPtr,								_mm_cvtepi32_pd(pixValue),						invFrameCnt, clipSigmaSqrd, clipping);
+	StackAdd2_SSE2(sumPtr + 2,	(sumSqPtr != NULL) ? (sumSqPtr + 2) : NULL,	_mm_cvtepi32_pd(_mm_srli_si128(pixValue, 8)),	invFrameCnt, clipSigmaSqrd, clipping);
+}
+#endif	//	__SSE2__
+
+#ifdef _IMAGE_KERNEL_NEON64_
+//*****************************************************************************
+//*	double precision NEON is only available on aarch64,
+//*	32 bit ARM builds use the scalar code for the stack
+//*****************************************************************************
+static inline void	StackAdd2_NEON(	double				*sumPtr,
+									double				*sumSqPtr,
+									float64x2_t			pixValue,
+									const float64x2_t	invFrameCnt,
+									const float64x2_t	clipSigmaSqrd,
+									const bool			clipping)
+{
+float64x2_t	sumValue;
+float64x2_t	sqValue;
+float64x2_t	meanValue;
+float64x2_t	variance;
+float64x2_t	delta;
+uint64x2_t	keepMask;
+
+	sumValue	=	vld1q_f64(sumPtr);
+	if (sumSqPtr != NULL)
+	{
+		sqValue	=	vld1q_f64(sumSqPtr);
+		if (clipping)
+		{
+			meanValue	=	vmulq_f64(sumValue, invFrameCnt);
+			variance	=	vsubq_f64(vmulq_f64(sqValue, invFrameCnt), vmulq_f64(meanValue, meanValue));
+			variance	=	vmaxq_f64(variance, vdupq_n_f64(1.0));
+			delta		=	vsubq_f64(pixValue, meanValue);
+			keepMask	=	vcleq_f64(vmulq_f64(delta, delta), vmulq_f64(variance, clipSigmaSqrd));
+			pixValue	=	vbslq_f64(keepMask, pixValue, meanValue);
+		}
+		vst1q_f64(sumSqPtr, vaddq_f64(sqValue, vmulq_f64(pixValue, pixValue)));
+	}
+	vst1q_f64(sumPtr, vaddq_f64(sumValue, pixValue));
+}
+
+//*****************************************************************************
+static inline void	StackAdd4_NEON(	double				*sumPtr,
+									double				*sumSqPtr,
+									uint32x4_t			pixValue,
+									const float64x2_t	invFrameCnt,
+									const float64x2_t	clipSigmaSqrd,
+									const bool			clipping)
+{
+	StackAdd2_NEON(sumPtr,		sumSqPtr,								vcvtq_f64_u64(vmovl_u32(vget_low_u32(pixValue))),	invFrameCnt, clipSigmaSqrd, clipping);
+	StackAdd2_NEON(sumPtr + 2,	(sumSqPtr != NULL) ? (sumSqPtr + 2) : NULL,	vcvtq_f64_u64(vmovl_u32(vget_high_u32(pixValue))),	invFrameCnt, clipSigmaSqrd, clipping);
+}
+#endif	//	_IMAGE_KERNEL_NEON64_
+
+//*****************************************************************************
+void	ImageKernel_StackAdd_U8(	double			*sumPtr,
+									double			*sumSqPtr,
+									const uint8_t	*srcPtr,
+									const int		count,
+									const double	invFrameCnt,
+									const double	clipSigmaSqrd)
+{
+int		ii;
+bool	clipping;
+
+	ii			=	0;
+	clipping	=	(sumSqPtr != NULL) && (clipSigmaSqrd > 0.0);
+#if defined(__SSE2__)
+__m128i	zero		=	_mm_setzero_si128();
+__m128d	invCnt_x2	=	_mm_set1_pd(invFrameCnt);
+__m128d	clipSig_x2	=	_mm_set1_pd(clipSigmaSqrd);
+__m128i	rawPixels;
+__m128i	lo16;
+__m128i	hi16;
+double	*sqPtr;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		sqPtr		=	(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL;
+		rawPixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ii));
+		lo16		=	_mm_unpacklo_epi8(rawPixels, zero);
+		hi16		=	_mm_unpackhi_epi8(rawPixels, zero);
+		StackAdd4_SSE2(sumPtr + ii,			sqPtr,									_mm_unpacklo_epi16(lo16, zero), invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_SSE2(sumPtr + ii + 4,		(sqPtr != NULL) ? (sqPtr + 4) : NULL,	_mm_unpackhi_epi16(lo16, zero), invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_SSE2(sumPtr + ii + 8,		(sqPtr != NULL) ? (sqPtr + 8) : NULL,	_mm_unpacklo_epi16(hi16, zero), invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_SSE2(sumPtr + ii + 12,	(sqPtr != NULL) ? (sqPtr + 12) : NULL,	_mm_unpackhi_epi16(hi16, zero), invCnt_x2, clipSig_x2, clipping);
+	}
+#elif defined(_IMAGE_KERNEL_NEON64_)
+float64x2_t	invCnt_x2	=	vdupq_n_f64(invFrameCnt);
+float64x2_t	clipSig_x2	=	vdupq_n_f64(clipSigmaSqrd);
+uint8x16_t	rawPixels;
+uint16x8_t	lo16;
+uint16x8_t	hi16;
+double		*sqPtr;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		sqPtr		=	(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL;
+		rawPixels	=	vld1q_u8(srcPtr + ii);
+		lo16		=	vmovl_u8(vget_low_u8(rawPixels));
+		hi16		=	vmovl_u8(vget_high_u8(rawPixels));
+		StackAdd4_NEON(sumPtr + ii,			sqPtr,									vmovl_u16(vget_low_u16(lo16)),	invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_NEON(sumPtr + ii + 4,		(sqPtr != NULL) ? (sqPtr + 4) : NULL,	vmovl_u16(vget_high_u16(lo16)),	invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_NEON(sumPtr + ii + 8,		(sqPtr != NULL) ? (sqPtr + 8) : NULL,	vmovl_u16(vget_low_u16(hi16)),	invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_NEON(sumPtr + ii + 12,	(sqPtr != NULL) ? (sqPtr + 12) : NULL,	vmovl_u16(vget_high_u16(hi16)),	invCnt_x2, clipSig_x2, clipping);
+	}
+#endif
+	//*	finish up whatever is left over
+	for (; ii < count; ii++)
+	{
+		StackAdd1(	sumPtr + ii,
+					(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL,
+					srcPtr[ii],
+					invFrameCnt,
+					(clipping ? clipSigmaSqrd : 0.0));
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_StackAdd_U16(	double			*sumPtr,
+									double			*sumSqPtr,
+									const uint16_t	*srcPtr,
+									const int		count,
+									const double	invFrameCnt,
+									const double	clipSigmaSqrd)
+{
+int		ii;
+bool	clipping;
+
+	ii			=	0;
+	clipping	=	(sumSqPtr != NULL) && (clipSigmaSqrd > 0.0);
+#if defined(__SSE2__)
+__m128i	zero		=	_mm_setzero_si128();
+__m128d	invCnt_x2	=	_mm_set1_pd(invFrameCnt);
+__m128d	clipSig_x2	=	_mm_set1_pd(clipSigmaSqrd);
+__m128i	rawPixels;
+double	*sqPtr;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		sqPtr		=	(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL;
+		rawPixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ii));
+		StackAdd4_SSE2(sumPtr + ii,		sqPtr,									_mm_unpacklo_epi16(rawPixels, zero), invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_SSE2(sumPtr + ii + 4,	(sqPtr != NULL) ? (sqPtr + 4) : NULL,	_mm_unpackhi_epi16(rawPixels, zero), invCnt_x2, clipSig_x2, clipping);
+	}
+#elif defined(_IMAGE_KERNEL_NEON64_)
+float64x2_t	invCnt_x2	=	vdupq_n_f64(invFrameCnt);
+float64x2_t	clipSig_x2	=	vdupq_n_f64(clipSigmaSqrd);
+uint16x8_t	rawPixels;
+double		*sqPtr;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		sqPtr		=	(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL;
+		rawPixels	=	vld1q_u16(srcPtr + ii);
+		StackAdd4_NEON(sumPtr + ii,		sqPtr,									vmovl_u16(vget_low_u16(rawPixels)),		invCnt_x2, clipSig_x2, clipping);
+		StackAdd4_NEON(sumPtr + ii + 4,	(sqPtr != NULL) ? (sqPtr + 4) : NULL,	vmovl_u16(vget_high_u16(rawPixels)),	invCnt_x2, clipSig_x2, clipping);
+	}
+#endif
+	//*	finish up whatever is left over
+	for (; ii < count; ii++)
+	{
+		StackAdd1(	sumPtr + ii,
+					(sumSqPtr != NULL) ? (sumSqPtr + ii) : NULL,
+					srcPtr[ii],
+					invFrameCnt,
+					(clipping ? clipSigmaSqrd : 0.0));
+	}
+}
+
+//*****************************************************************************
+//*	used where there is no data for this pixel (edges of a shifted frame)
+//*	adds the current mean so the mean does not change
+//*****************************************************************************
+void	ImageKernel_StackAddMean(	double			*sumPtr,
+									double			*sumSqPtr,
+									const int		count,
+									const double	invFrameCnt)
+{
+int		ii;
+double	meanValue;
+
+	for (ii=0; ii<count; ii++)
+	{
+		meanValue	=	sumPtr[ii] * invFrameCnt;
+		sumPtr[ii]	+=	meanValue;
+		if (sumSqPtr != NULL)
+		{
+			sumSqPtr[ii]	+=	meanValue * meanValue;
+		}
+	}
+}
+
+#if defined(__SSE2__)
+//*****************************************************************************
+//*	scale 4 doubles, clip to 0..maxValue and return them as 32 bit ints
+//*****************************************************************************
+static inline __m128i	ScaleLoad4_SSE2(const double	*srcPtr,
+										const __m128d	scaleFactor,
+										const __m128d	maxValue)
+{
+__m128d	half_x2	=	_mm_set1_pd(0.5);
+__m128d	zero_x2	=	_mm_setzero_pd();
+__m128d	lowPair;
+__m128d	highPair;
+
+	lowPair		=	_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(srcPtr),		scaleFactor), half_x2);
+	highPair	=	_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(srcPtr + 2),	scaleFactor), half_x2);
+	lowPair		=	_mm_min_pd(_mm_max_pd(lowPair, zero_x2), maxValue);
+	highPair	=	_mm_min_pd(_mm_max_pd(highPair, zero_x2), maxValue);
+	return(_mm_unpacklo_epi64(_mm_cvttpd_epi32(lowPair), _mm_cvttpd_epi32(highPair)));
+}
+#elif defined(_IMAGE_KERNEL_NEON64_)
+//*****************************************************************************
+static inline uint32x4_t	ScaleLoad4_NEON(const double		*srcPtr,
+											const float64x2_t	scaleFactor)
+{
+float64x2_t	half_x2	=	vdupq_n_f64(0.5);
+
+	//*	the unsigned convert clips negative values to 0
+	return(vcombine_u32(vqmovn_u64(vcvtq_u64_f64(vfmaq_f64(half_x2, vld1q_f64(srcPtr),		scaleFactor))),
+						vqmovn_u64(vcvtq_u64_f64(vfmaq_f64(half_x2, vld1q_f64(srcPtr + 2),	scaleFactor)))));
+}
+#endif
+
+//*****************************************************************************
+void	ImageKernel_ScaleToU8(		uint8_t			*dstPtr,
+									const double	*srcPtr,
+									const int		count,
+									const double	scaleFactor)
+{
+int		ii;
+double	pixValue;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128d	scale_x2	=	_mm_set1_pd(scaleFactor);
+__m128d	max_x2		=	_mm_set1_pd(255.0);
+__m128i	int32_0;
+__m128i	int32_1;
+__m128i	int32_2;
+__m128i	int32_3;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		int32_0	=	ScaleLoad4_SSE2(srcPtr + ii,		scale_x2, max_x2);
+		int32_1	=	ScaleLoad4_SSE2(srcPtr + ii + 4,	scale_x2, max_x2);
+		int32_2	=	ScaleLoad4_SSE2(srcPtr + ii + 8,	scale_x2, max_x2);
+		int32_3	=	ScaleLoad4_SSE2(srcPtr + ii + 12,	scale_x2, max_x2);
+		_mm_storeu_si128((__m128i *)(dstPtr + ii),
+						_mm_packus_epi16(_mm_packs_epi32(int32_0, int32_1), _mm_packs_epi32(int32_2, int32_3)));
+	}
+#elif defined(_IMAGE_KERNEL_NEON64_)
+float64x2_t	scale_x2	=	vdupq_n_f64(scaleFactor);
+uint16x4_t	u16_0;
+uint16x4_t	u16_1;
+uint16x4_t	u16_2;
+uint16x4_t	u16_3;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		u16_0	=	vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii,			scale_x2));
+		u16_1	=	vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii + 4,		scale_x2));
+		u16_2	=	vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii + 8,		scale_x2));
+		u16_3	=	vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii + 12,	scale_x2));
+		vst1q_u8(dstPtr + ii, vcombine_u8(	vqmovn_u16(vcombine_u16(u16_0, u16_1)),
+											vqmovn_u16(vcombine_u16(u16_2, u16_3))));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		pixValue	=	(srcPtr[ii] * scaleFactor) + 0.5;
+		if (pixValue < 0.0)
+		{
+			pixValue	=	0.0;
+		}
+		if (pixValue > 255.0)
+		{
+			pixValue	=	255.0;
+		}
+		dstPtr[ii]	=	pixValue;
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_ScaleToU16(		uint16_t		*dstPtr,
+									const double	*srcPtr,
+									const int		count,
+									const double	scaleFactor)
+{
+int		ii;
+double	pixValue;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128d	scale_x2	=	_mm_set1_pd(scaleFactor);
+__m128d	max_x2		=	_mm_set1_pd(65535.0);
+__m128i	bias32		=	_mm_set1_epi32(32768);
+__m128i	bias16		=	_mm_set1_epi16((short)0x8000);
+__m128i	int32_0;
+__m128i	int32_1;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		//*	SSE2 does not have an unsigned 32->16 pack, so bias the values into the signed range
+		int32_0	=	_mm_sub_epi32(ScaleLoad4_SSE2(srcPtr + ii,		scale_x2, max_x2), bias32);
+		int32_1	=	_mm_sub_epi32(ScaleLoad4_SSE2(srcPtr + ii + 4,	scale_x2, max_x2), bias32);
+		_mm_storeu_si128((__m128i *)(dstPtr + ii), _mm_xor_si128(_mm_packs_epi32(int32_0, int32_1), bias16));
+	}
+#elif defined(_IMAGE_KERNEL_NEON64_)
+float64x2_t	scale_x2	=	vdupq_n_f64(scaleFactor);
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		vst1q_u16(dstPtr + ii, vcombine_u16(vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii,		scale_x2)),
+											vqmovn_u32(ScaleLoad4_NEON(srcPtr + ii + 4,	scale_x2))));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		pixValue	=	(srcPtr[ii] * scaleFactor) + 0.5;
+		if (pixValue < 0.0)
+		{
+			pixValue	=	0.0;
+		}
+		if (pixValue > 65535.0)
+		{
+			pixValue	=	65535.0;
+		}
+		dstPtr[ii]	=	pixValue;
+	}
+}
+
+//*****************************************************************************
+static inline float	Calibrate1(	float		pixValue,
+								const float	*biasPtr,
+								const float	*darkPtr,
+								const float	*flatGainPtr,
+								const int	ii,
+								const float	biasScale,
+								const float	darkScale)
+{
+	if (biasPtr != NULL)
+	{
+		pixValue	-=	biasPtr[ii] * biasScale;
+	}
+	if (darkPtr != NULL)
+	{
+		pixValue	-=	darkPtr[ii] * darkScale;
+	}
+	if (flatGainPtr != NULL)
+	{
+		pixValue	*=	flatGainPtr[ii];
+	}
+	return(pixValue + 0.5f);
+}
+
+#if defined(__SSE2__)
+//*****************************************************************************
+static inline __m128	Calibrate4_SSE2(__m128		pixValue,
+										const float	*biasPtr,
+										const float	*darkPtr,
+										const float	*flatGainPtr,
+										const int	ii,
+										const __m128	biasScale,
+										const __m128	darkScale)
+{
+	if (biasPtr != NULL)
+	{
+		pixValue	=	_mm_sub_ps(pixValue, _mm_mul_ps(_mm_loadu_ps(biasPtr + ii), biasScale));
+	}
+	if (darkPtr != NULL)
+	{
+		pixValue	=	_mm_sub_ps(pixValue, _mm_mul_ps(_mm_loadu_ps(darkPtr + ii), darkScale));
+	}
+	if (flatGainPtr != NULL)
+	{
+		pixValue	=	_mm_mul_ps(pixValue, _mm_loadu_ps(flatGainPtr + ii));
+	}
+	return(_mm_add_ps(pixValue, _mm_set1_ps(0.5f)));
+}
+#endif	//	__SSE2__
+
+#ifdef _IMAGE_KERNEL_NEON_
+//*****************************************************************************
+static inline float32x4_t	Calibrate4_NEON(float32x4_t			pixValue,
+											const float			*biasPtr,
+											const float			*darkPtr,
+											const float			*flatGainPtr,
+											const int			ii,
+											const float32x4_t	biasScale,
+											const float32x4_t	darkScale)
+{
+	if (biasPtr != NULL)
+	{
+		pixValue	=	vmlsq_f32(pixValue, vld1q_f32(biasPtr + ii), biasScale);
+	}
+	if (darkPtr != NULL)
+	{
+		pixValue	=	vmlsq_f32(pixValue, vld1q_f32(darkPtr + ii), darkScale);
+	}
+	if (flatGainPtr != NULL)
+	{
+		pixValue	=	vmulq_f32(pixValue, vld1q_f32(flatGainPtr + ii));
+	}
+	return(vaddq_f32(pixValue, vdupq_n_f32(0.5f)));
+}
+#endif	//	_IMAGE_KERNEL_NEON_
+
+//*****************************************************************************
+void	ImageKernel_Calibrate_U8(	uint8_t			*pixelPtr,
+									const float		*biasPtr,
+									const float		*darkPtr,
+									const float		*flatGainPtr,
+									const int		count,
+									const float		biasScale,
+									const float		darkScale)
+{
+int		ii;
+float	pixValue;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	zero		=	_mm_setzero_si128();
+__m128	biasScale_x4	=	_mm_set1_ps(biasScale);
+__m128	darkScale_x4	=	_mm_set1_ps(darkScale);
+__m128i	rawPixels;
+__m128i	lo16;
+__m128i	hi16;
+__m128i	int32_0;
+__m128i	int32_1;
+__m128i	int32_2;
+__m128i	int32_3;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		rawPixels	=	_mm_loadu_si128((const __m128i *)(pixelPtr + ii));
+		lo16		=	_mm_unpacklo_epi8(rawPixels, zero);
+		hi16		=	_mm_unpackhi_epi8(rawPixels, zero);
+		int32_0		=	_mm_cvttps_epi32(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero)), biasPtr, darkPtr, flatGainPtr, ii,		biasScale_x4, darkScale_x4));
+		int32_1		=	_mm_cvttps_epi32(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero)), biasPtr, darkPtr, flatGainPtr, ii + 4,	biasScale_x4, darkScale_x4));
+		int32_2		=	_mm_cvttps_epi32(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero)), biasPtr, darkPtr, flatGainPtr, ii + 8,	biasScale_x4, darkScale_x4));
+		int32_3		=	_mm_cvttps_epi32(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero)), biasPtr, darkPtr, flatGainPtr, ii + 12,	biasScale_x4, darkScale_x4));
+		_mm_storeu_si128((__m128i *)(pixelPtr + ii),
+						_mm_packus_epi16(_mm_packs_epi32(int32_0, int32_1), _mm_packs_epi32(int32_2, int32_3)));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+float32x4_t	biasScale_x4	=	vdupq_n_f32(biasScale);
+float32x4_t	darkScale_x4	=	vdupq_n_f32(darkScale);
+uint8x16_t	rawPixels;
+uint16x8_t	lo16;
+uint16x8_t	hi16;
+uint16x4_t	u16_0;
+uint16x4_t	u16_1;
+uint16x4_t	u16_2;
+uint16x4_t	u16_3;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		rawPixels	=	vld1q_u8(pixelPtr + ii);
+		lo16		=	vmovl_u8(vget_low_u8(rawPixels));
+		hi16		=	vmovl_u8(vget_high_u8(rawPixels));
+		u16_0		=	vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo16))),	biasPtr, darkPtr, flatGainPtr, ii,		biasScale_x4, darkScale_x4)));
+		u16_1		=	vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo16))),	biasPtr, darkPtr, flatGainPtr, ii + 4,	biasScale_x4, darkScale_x4)));
+		u16_2		=	vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi16))),	biasPtr, darkPtr, flatGainPtr, ii + 8,	biasScale_x4, darkScale_x4)));
+		u16_3		=	vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi16))),	biasPtr, darkPtr, flatGainPtr, ii + 12,	biasScale_x4, darkScale_x4)));
+		vst1q_u8(pixelPtr + ii, vcombine_u8(vqmovn_u16(vcombine_u16(u16_0, u16_1)),
+											vqmovn_u16(vcombine_u16(u16_2, u16_3))));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		pixValue	=	Calibrate1(pixelPtr[ii], biasPtr, darkPtr, flatGainPtr, ii, biasScale, darkScale);
+		if (pixValue < 0.0f)
+		{
+			pixValue	=	0.0f;
+		}
+		if (pixValue > 255.0f)
+		{
+			pixValue	=	255.0f;
+		}
+		pixelPtr[ii]	=	pixValue;
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_Calibrate_U16(	uint16_t		*pixelPtr,
+									const float		*biasPtr,
+									const float		*darkPtr,
+									const float		*flatGainPtr,
+									const int		count,
+									const float		biasScale,
+									const float		darkScale)
+{
+int		ii;
+float	pixValue;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	zero			=	_mm_setzero_si128();
+__m128	biasScale_x4	=	_mm_set1_ps(biasScale);
+__m128	darkScale_x4	=	_mm_set1_ps(darkScale);
+__m128	zero_x4			=	_mm_setzero_ps();
+__m128	max_x4			=	_mm_set1_ps(65535.0f);
+__m128i	bias32			=	_mm_set1_epi32(32768);
+__m128i	bias16			=	_mm_set1_epi16((short)0x8000);
+__m128i	rawPixels;
+__m128i	int32_0;
+__m128i	int32_1;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		rawPixels	=	_mm_loadu_si128((const __m128i *)(pixelPtr + ii));
+		int32_0		=	_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpacklo_epi16(rawPixels, zero)), biasPtr, darkPtr, flatGainPtr, ii,	biasScale_x4, darkScale_x4), zero_x4), max_x4));
+		int32_1		=	_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(Calibrate4_SSE2(_mm_cvtepi32_ps(_mm_unpackhi_epi16(rawPixels, zero)), biasPtr, darkPtr, flatGainPtr, ii + 4,	biasScale_x4, darkScale_x4), zero_x4), max_x4));
+		int32_0		=	_mm_sub_epi32(int32_0, bias32);
+		int32_1		=	_mm_sub_epi32(int32_1, bias32);
+		_mm_storeu_si128((__m128i *)(pixelPtr + ii), _mm_xor_si128(_mm_packs_epi32(int32_0, int32_1), bias16));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+float32x4_t	biasScale_x4	=	vdupq_n_f32(biasScale);
+float32x4_t	darkScale_x4	=	vdupq_n_f32(darkScale);
+uint16x8_t	rawPixels;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		rawPixels	=	vld1q_u16(pixelPtr + ii);
+		vst1q_u16(pixelPtr + ii, vcombine_u16(	vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_low_u16(rawPixels))),	biasPtr, darkPtr, flatGainPtr, ii,		biasScale_x4, darkScale_x4))),
+												vqmovn_u32(vcvtq_u32_f32(Calibrate4_NEON(vcvtq_f32_u32(vmovl_u16(vget_high_u16(rawPixels))),	biasPtr, darkPtr, flatGainPtr, ii + 4,	biasScale_x4, darkScale_x4)))));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		pixValue	=	Calibrate1(pixelPtr[ii], biasPtr, darkPtr, flatGainPtr, ii, biasScale, darkScale);
+		if (pixValue < 0.0f)
+		{
+			pixValue	=	0.0f;
+		}
+		if (pixValue > 65535.0f)
+		{
+			pixValue	=	65535.0f;
+		}
+		pixelPtr[ii]	=	pixValue;
+	}
+}
+
+//*****************************************************************************
+//*	returns the index of the first value that is greater than threshold,
+//*	or count if there is none. Used to skip over the background quickly
+//*****************************************************************************
+int	ImageKernel_ScanAbove_U8(const uint8_t *srcPtr, const int count, const uint8_t threshold)
+{
+int		ii;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	threshold_x16	=	_mm_set1_epi8((char)threshold);
+__m128i	pixels;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		pixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ii));
+		//*	max(pixel, threshold) == threshold for all pixels that are not above
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(pixels, threshold_x16), threshold_x16)) != 0x0ffff)
+		{
+			break;
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint8x16_t	threshold_x16	=	vdupq_n_u8(threshold);
+uint64x2_t	aboveFlags;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		aboveFlags	=	vreinterpretq_u64_u8(vcgtq_u8(vld1q_u8(srcPtr + ii), threshold_x16));
+		if ((vgetq_lane_u64(aboveFlags, 0) | vgetq_lane_u64(aboveFlags, 1)) != 0)
+		{
+			break;
+		}
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		if (srcPtr[ii] > threshold)
+		{
+			break;
+		}
+	}
+	return(ii);
+}
+
+//*****************************************************************************
+int	ImageKernel_ScanAbove_U16(const uint16_t *srcPtr, const int count, const uint16_t threshold)
+{
+int		ii;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	threshold_x8	=	_mm_set1_epi16((short)threshold);
+__m128i	zero			=	_mm_setzero_si128();
+__m128i	pixels;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		pixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ii));
+		//*	saturating subtract is zero for all pixels that are not above
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(pixels, threshold_x8), zero)) != 0x0ffff)
+		{
+			break;
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t	threshold_x8	=	vdupq_n_u16(threshold);
+uint64x2_t	aboveFlags;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		aboveFlags	=	vreinterpretq_u64_u16(vcgtq_u16(vld1q_u16(srcPtr + ii), threshold_x8));
+		if ((vgetq_lane_u64(aboveFlags, 0) | vgetq_lane_u64(aboveFlags, 1)) != 0)
+		{
+			break;
+		}
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		if (srcPtr[ii] > threshold)
+		{
+			break;
+		}
+	}
+	return(ii);
+}
+
+//*****************************************************************************
+//*	Bayer demosaic
+//*	Within a row the pixels alternate between the row color (red or blue) and green,
+//*	the other color (blue or red) is only in the rows above and below.
+//*	The output is BGR, the same order as the RGB24 cameras and OpenCV.
+//*
+//*	Averages round up, the same as _mm_avg_epu8() and vrhaddq_u8(),
+//*	so the SIMD and C versions give exactly the same result
+//*****************************************************************************
+#define	AVG2(aa, bb)	(((aa) + (bb) + 1) >> 1)
+
+//*****************************************************************************
+typedef struct	//	TYPE_DEMOSAIC_NEIGHBORS
+{
+	int		cur;
+	int		left;
+	int		right;
+	int		up;
+	int		down;
+	int		upLeft;
+	int		upRight;
+	int		downLeft;
+	int		downRight;
+} TYPE_DEMOSAIC_NEIGHBORS;
+
+//*****************************************************************************
+static inline void	DemosaicPixel(	const TYPE_DEMOSAIC_NEIGHBORS	*nbr,
+									const bool						colorSite,
+									const int						method,
+									int								*rowColor,
+									int								*green,
+									int								*otherColor)
+{
+int		hAvg;
+int		vAvg;
+int		deltaH;
+int		deltaV;
+
+	hAvg	=	AVG2(nbr->left, nbr->right);
+	vAvg	=	AVG2(nbr->up, nbr->down);
+	if (colorSite)
+	{
+		*rowColor	=	nbr->cur;
+		*otherColor	=	AVG2(AVG2(nbr->upLeft, nbr->upRight), AVG2(nbr->downLeft, nbr->downRight));
+		*green		=	AVG2(hAvg, vAvg);
+		if (method == kDemosaic_EdgeAware)
+		{
+			//*	interpolate along the edge, not across it
+			deltaH	=	abs(nbr->left - nbr->right);
+			deltaV	=	abs(nbr->up - nbr->down);
+			if (deltaH < deltaV)
+			{
+				*green	=	hAvg;
+			}
+			else if (deltaV < deltaH)
+			{
+				*green	=	vAvg;
+			}
+		}
+	}
+	else
+	{
+		*rowColor	=	hAvg;
+		*green		=	nbr->cur;
+		*otherColor	=	vAvg;
+	}
+}
+
+//*****************************************************************************
+//*	the columns are mirrored at the edges of the image, this keeps the pattern
+//*****************************************************************************
+static inline void	DemosaicColumns(const int width, const int xx, int *leftX, int *rightX)
+{
+	*leftX	=	(xx > 0) ? (xx - 1) : (xx + 1);
+	*rightX	=	(xx < (width - 1)) ? (xx + 1) : (xx - 1);
+	if (width < 2)
+	{
+		*leftX	=	xx;
+		*rightX	=	xx;
+	}
+}
+
+//*****************************************************************************
+static void	DemosaicPixels_U8(	uint8_t			*dstPtr,
+								const uint8_t	*prevRow,
+								const uint8_t	*curRow,
+								const uint8_t	*nextRow,
+								const int		width,
+								const int		firstX,
+								const int		lastX,
+								const int		redRow,
+								const int		greenFirst,
+								const int		method)
+{
+TYPE_DEMOSAIC_NEIGHBORS	nbr;
+int						xx;
+int						leftX;
+int						rightX;
+int						rowColor;
+int						green;
+int						otherColor;
+uint8_t					*pixelPtr;
+
+	for (xx=firstX; xx<lastX; xx++)
+	{
+		DemosaicColumns(width, xx, &leftX, &rightX);
+		nbr.cur			=	curRow[xx];
+		nbr.left		=	curRow[leftX];
+		nbr.right		=	curRow[rightX];
+		nbr.up			=	prevRow[xx];
+		nbr.down		=	nextRow[xx];
+		nbr.upLeft		=	prevRow[leftX];
+		nbr.upRight		=	prevRow[rightX];
+		nbr.downLeft	=	nextRow[leftX];
+		nbr.downRight	=	nextRow[rightX];
+		DemosaicPixel(&nbr, ((xx & 1) == (greenFirst ? 1 : 0)), method, &rowColor, &green, &otherColor);
+
+		pixelPtr	=	dstPtr + (xx * 3);
+		pixelPtr[0]	=	redRow ? otherColor : rowColor;
+		pixelPtr[1]	=	green;
+		pixelPtr[2]	=	redRow ? rowColor : otherColor;
+	}
+}
+
+//*****************************************************************************
+static void	DemosaicPixels_U16(	void			*dstPtr,
+								const bool		output8,
+								const uint16_t	*prevRow,
+								const uint16_t	*curRow,
+								const uint16_t	*nextRow,
+								const int		width,
+								const int		firstX,
+								const int		lastX,
+								const int		redRow,
+								const int		greenFirst,
+								const int		method)
+{
+TYPE_DEMOSAIC_NEIGHBORS	nbr;
+int						xx;
+int						leftX;
+int						rightX;
+int						rowColor;
+int						green;
+int						otherColor;
+int						blue;
+int						red;
+
+	for (xx=firstX; xx<lastX; xx++)
+	{
+		DemosaicColumns(width, xx, &leftX, &rightX);
+		nbr.cur			=	curRow[xx];
+		nbr.left		=	curRow[leftX];
+		nbr.right		=	curRow[rightX];
+		nbr.up			=	prevRow[xx];
+		nbr.down		=	nextRow[xx];
+		nbr.upLeft		=	prevRow[leftX];
+		nbr.upRight		=	prevRow[rightX];
+		nbr.downLeft	=	nextRow[leftX];
+		nbr.downRight	=	nextRow[rightX];
+		DemosaicPixel(&nbr, ((xx & 1) == (greenFirst ? 1 : 0)), method, &rowColor, &green, &otherColor);
+
+		blue	=	redRow ? otherColor : rowColor;
+		red		=	redRow ? rowColor : otherColor;
+		if (output8)
+		{
+			((uint8_t *)dstPtr)[(xx * 3) + 0]	=	blue >> 8;
+			((uint8_t *)dstPtr)[(xx * 3) + 1]	=	green >> 8;
+			((uint8_t *)dstPtr)[(xx * 3) + 2]	=	red >> 8;
+		}
+		else
+		{
+			((uint16_t *)dstPtr)[(xx * 3) + 0]	=	blue;
+			((uint16_t *)dstPtr)[(xx * 3) + 1]	=	green;
+			((uint16_t *)dstPtr)[(xx * 3) + 2]	=	red;
+		}
+	}
+}
+
+#if defined(__SSE2__)
+//*****************************************************************************
+static inline __m128i	Select_SSE2(const __m128i mask, const __m128i ifSet, const __m128i ifClear)
+{
+	return(_mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear)));
+}
+#endif	//	__SSE2__
+
+//*****************************************************************************
+//*	one row of RAW8 to RGB24 (BGR)
+//*	prevRow and nextRow are the rows above and below, at the top and bottom of the
+//*	image the rows are mirrored (row 1 is used for row -1) so the pattern is kept
+//*	redRow is true if this row has red pixels, greenFirst if pixel 0 is green
+//*****************************************************************************
+void	ImageKernel_DemosaicRow_U8(	uint8_t			*dstPtr,
+									const uint8_t	*prevRow,
+									const uint8_t	*curRow,
+									const uint8_t	*nextRow,
+									const int		width,
+									const int		redRow,
+									const int		greenFirst,
+									const int		method)
+{
+int		xx;
+
+	//*	the SIMD loop starts at 1 so the left neighbor is always there
+	DemosaicPixels_U8(dstPtr, prevRow, curRow, nextRow, width, 0, 1, redRow, greenFirst, method);
+	xx	=	1;
+#if defined(__SSE2__)
+__m128i	zero		=	_mm_setzero_si128();
+__m128i	colorMask;
+__m128i	cur;
+__m128i	left;
+__m128i	right;
+__m128i	hAvg;
+__m128i	vAvg;
+__m128i	crossAvg;
+__m128i	diagAvg;
+__m128i	deltaH;
+__m128i	deltaV;
+__m128i	hLessEq;
+__m128i	vLessEq;
+__m128i	greenAtColor;
+__m128i	rowColor;
+__m128i	green;
+__m128i	otherColor;
+uint8_t	maskBytes[16];
+uint8_t	blueBytes[16];
+uint8_t	greenBytes[16];
+uint8_t	redBytes[16];
+int		ii;
+
+	//*	the loop always starts on an odd pixel
+	for (ii=0; ii<16; ii++)
+	{
+		maskBytes[ii]	=	(((1 + ii) & 1) == (greenFirst ? 1 : 0)) ? 0xff : 0;
+	}
+	colorMask	=	_mm_loadu_si128((const __m128i *)maskBytes);
+	for (; xx <= (width - 17); xx += 16)
+	{
+		cur			=	_mm_loadu_si128((const __m128i *)(curRow + xx));
+		left		=	_mm_loadu_si128((const __m128i *)(curRow + xx - 1));
+		right		=	_mm_loadu_si128((const __m128i *)(curRow + xx + 1));
+		hAvg		=	_mm_avg_epu8(left, right);
+		vAvg		=	_mm_avg_epu8(	_mm_loadu_si128((const __m128i *)(prevRow + xx)),
+										_mm_loadu_si128((const __m128i *)(nextRow + xx)));
+		crossAvg	=	_mm_avg_epu8(hAvg, vAvg);
+		diagAvg		=	_mm_avg_epu8(	_mm_avg_epu8(	_mm_loadu_si128((const __m128i *)(prevRow + xx - 1)),
+														_mm_loadu_si128((const __m128i *)(prevRow + xx + 1))),
+										_mm_avg_epu8(	_mm_loadu_si128((const __m128i *)(nextRow + xx - 1)),
+														_mm_loadu_si128((const __m128i *)(nextRow + xx + 1))));
+		greenAtColor	=	crossAvg;
+		if (method == kDemosaic_EdgeAware)
+		{
+			deltaH	=	_mm_or_si128(_mm_subs_epu8(left, right), _mm_subs_epu8(right, left));
+			deltaV	=	_mm_or_si128(	_mm_subs_epu8(	_mm_loadu_si128((const __m128i *)(prevRow + xx)),
+														_mm_loadu_si128((const __m128i *)(nextRow + xx))),
+										_mm_subs_epu8(	_mm_loadu_si128((const __m128i *)(nextRow + xx)),
+														_mm_loadu_si128((const __m128i *)(prevRow + xx))));
+			hLessEq	=	_mm_cmpeq_epi8(_mm_subs_epu8(deltaH, deltaV), zero);
+			vLessEq	=	_mm_cmpeq_epi8(_mm_subs_epu8(deltaV, deltaH), zero);
+			greenAtColor	=	Select_SSE2(_mm_andnot_si128(vLessEq, hLessEq), hAvg, greenAtColor);
+			greenAtColor	=	Select_SSE2(_mm_andnot_si128(hLessEq, vLessEq), vAvg, greenAtColor);
+		}
+		rowColor	=	Select_SSE2(colorMask, cur, hAvg);
+		green		=	Select_SSE2(colorMask, greenAtColor, cur);
+		otherColor	=	Select_SSE2(colorMask, diagAvg, vAvg);
+
+		//*	SSE2 has no byte shuffle, interleave from memory
+		_mm_storeu_si128((__m128i *)blueBytes,	(redRow ? otherColor : rowColor));
+		_mm_storeu_si128((__m128i *)greenBytes,	green);
+		_mm_storeu_si128((__m128i *)redBytes,	(redRow ? rowColor : otherColor));
+		for (ii=0; ii<16; ii++)
+		{
+			dstPtr[((xx + ii) * 3) + 0]	=	blueBytes[ii];
+			dstPtr[((xx + ii) * 3) + 1]	=	greenBytes[ii];
+			dstPtr[((xx + ii) * 3) + 2]	=	redBytes[ii];
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint8x16_t		colorMask;
+uint8x16_t		cur;
+uint8x16_t		left;
+uint8x16_t		right;
+uint8x16_t		up;
+uint8x16_t		down;
+uint8x16_t		hAvg;
+uint8x16_t		vAvg;
+uint8x16_t		diagAvg;
+uint8x16_t		deltaH;
+uint8x16_t		deltaV;
+uint8x16_t		greenAtColor;
+uint8x16_t		rowColor;
+uint8x16_t		otherColor;
+uint8x16x3_t	bgrPixels;
+uint8_t			maskBytes[16];
+int				ii;
+
+	for (ii=0; ii<16; ii++)
+	{
+		maskBytes[ii]	=	(((1 + ii) & 1) == (greenFirst ? 1 : 0)) ? 0xff : 0;
+	}
+	colorMask	=	vld1q_u8(maskBytes);
+	for (; xx <= (width - 17); xx += 16)
+	{
+		cur			=	vld1q_u8(curRow + xx);
+		left		=	vld1q_u8(curRow + xx - 1);
+		right		=	vld1q_u8(curRow + xx + 1);
+		up			=	vld1q_u8(prevRow + xx);
+		down		=	vld1q_u8(nextRow + xx);
+		hAvg		=	vrhaddq_u8(left, right);
+		vAvg		=	vrhaddq_u8(up, down);
+		diagAvg		=	vrhaddq_u8(	vrhaddq_u8(vld1q_u8(prevRow + xx - 1), vld1q_u8(prevRow + xx + 1)),
+									vrhaddq_u8(vld1q_u8(nextRow + xx - 1), vld1q_u8(nextRow + xx + 1)));
+		greenAtColor	=	vrhaddq_u8(hAvg, vAvg);
+		if (method == kDemosaic_EdgeAware)
+		{
+			deltaH			=	vabdq_u8(left, right);
+			deltaV			=	vabdq_u8(up, down);
+			greenAtColor	=	vbslq_u8(vcltq_u8(deltaH, deltaV), hAvg, greenAtColor);
+			greenAtColor	=	vbslq_u8(vcltq_u8(deltaV, deltaH), vAvg, greenAtColor);
+		}
+		rowColor		=	vbslq_u8(colorMask, cur, hAvg);
+		otherColor		=	vbslq_u8(colorMask, diagAvg, vAvg);
+		bgrPixels.val[0]	=	redRow ? otherColor : rowColor;
+		bgrPixels.val[1]	=	vbslq_u8(colorMask, greenAtColor, cur);
+		bgrPixels.val[2]	=	redRow ? rowColor : otherColor;
+		vst3q_u8(dstPtr + (xx * 3), bgrPixels);
+	}
+#endif
+	DemosaicPixels_U8(dstPtr, prevRow, curRow, nextRow, width, xx, width, redRow, greenFirst, method);
+}
+
+//*****************************************************************************
+static void	DemosaicRow_U16(void			*dstPtr,
+							const bool		output8,
+							const uint16_t	*prevRow,
+							const uint16_t	*curRow,
+							const uint16_t	*nextRow,
+							const int		width,
+							const int		redRow,
+							const int		greenFirst,
+							const int		method)
+{
+int		xx;
+
+	DemosaicPixels_U16(dstPtr, output8, prevRow, curRow, nextRow, width, 0, 1, redRow, greenFirst, method);
+	xx	=	1;
+#if defined(__SSE2__)
+__m128i		zero		=	_mm_setzero_si128();
+__m128i		colorMask;
+__m128i		cur;
+__m128i		left;
+__m128i		right;
+__m128i		up;
+__m128i		down;
+__m128i		hAvg;
+__m128i		vAvg;
+__m128i		diagAvg;
+__m128i		deltaH;
+__m128i		deltaV;
+__m128i		hLessEq;
+__m128i		vLessEq;
+__m128i		greenAtColor;
+__m128i		rowColor;
+__m128i		otherColor;
+uint16_t	maskWords[8];
+uint16_t	blueWords[8];
+uint16_t	greenWords[8];
+uint16_t	redWords[8];
+int			ii;
+
+	for (ii=0; ii<8; ii++)
+	{
+		maskWords[ii]	=	(((1 + ii) & 1) == (greenFirst ? 1 : 0)) ? 0xffff : 0;
+	}
+	colorMask	=	_mm_loadu_si128((const __m128i *)maskWords);
+	for (; xx <= (width - 9); xx += 8)
+	{
+		cur			=	_mm_loadu_si128((const __m128i *)(curRow + xx));
+		left		=	_mm_loadu_si128((const __m128i *)(curRow + xx - 1));
+		right		=	_mm_loadu_si128((const __m128i *)(curRow + xx + 1));
+		up			=	_mm_loadu_si128((const __m128i *)(prevRow + xx));
+		down		=	_mm_loadu_si128((const __m128i *)(nextRow + xx));
+		hAvg		=	_mm_avg_epu16(left, right);
+		vAvg		=	_mm_avg_epu16(up, down);
+		diagAvg		=	_mm_avg_epu16(	_mm_avg_epu16(	_mm_loadu_si128((const __m128i *)(prevRow + xx - 1)),
+														_mm_loadu_si128((const __m128i *)(prevRow + xx + 1))),
+										_mm_avg_epu16(	_mm_loadu_si128((const __m128i *)(nextRow + xx - 1)),
+														_mm_loadu_si128((const __m128i *)(nextRow + xx + 1))));
+		greenAtColor	=	_mm_avg_epu16(hAvg, vAvg);
+		if (method == kDemosaic_EdgeAware)
+		{
+			deltaH	=	_mm_or_si128(_mm_subs_epu16(left, right), _mm_subs_epu16(right, left));
+			deltaV	=	_mm_or_si128(_mm_subs_epu16(up, down), _mm_subs_epu16(down, up));
+			hLessEq	=	_mm_cmpeq_epi16(_mm_subs_epu16(deltaH, deltaV), zero);
+			vLessEq	=	_mm_cmpeq_epi16(_mm_subs_epu16(deltaV, deltaH), zero);
+			greenAtColor	=	Select_SSE2(_mm_andnot_si128(vLessEq, hLessEq), hAvg, greenAtColor);
+			greenAtColor	=	Select_SSE2(_mm_andnot_si128(hLessEq, vLessEq), vAvg, greenAtColor);
+		}
+		rowColor	=	Select_SSE2(colorMask, cur, hAvg);
+		otherColor	=	Select_SSE2(colorMask, diagAvg, vAvg);
+		_mm_storeu_si128((__m128i *)blueWords,	(redRow ? otherColor : rowColor));
+		_mm_storeu_si128((__m128i *)greenWords,	Select_SSE2(colorMask, greenAtColor, cur));
+		_mm_storeu_si128((__m128i *)redWords,	(redRow ? rowColor : otherColor));
+		if (output8)
+		{
+			for (ii=0; ii<8; ii++)
+			{
+				((uint8_t *)dstPtr)[((xx + ii) * 3) + 0]	=	blueWords[ii] >> 8;
+				((uint8_t *)dstPtr)[((xx + ii) * 3) + 1]	=	greenWords[ii] >> 8;
+				((uint8_t *)dstPtr)[((xx + ii) * 3) + 2]	=	redWords[ii] >> 8;
+			}
+		}
+		else
+		{
+			for (ii=0; ii<8; ii++)
+			{
+				((uint16_t *)dstPtr)[((xx + ii) * 3) + 0]	=	blueWords[ii];
+				((uint16_t *)dstPtr)[((xx + ii) * 3) + 1]	=	greenWords[ii];
+				((uint16_t *)dstPtr)[((xx + ii) * 3) + 2]	=	redWords[ii];
+			}
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t		colorMask;
+uint16x8_t		cur;
+uint16x8_t		left;
+uint16x8_t		right;
+uint16x8_t		up;
+uint16x8_t		down;
+uint16x8_t		hAvg;
+uint16x8_t		vAvg;
+uint16x8_t		diagAvg;
+uint16x8_t		greenAtColor;
+uint16x8_t		rowColor;
+uint16x8_t		otherColor;
+uint16x8x3_t	bgrPixels;
+uint8x8x3_t		bgrPixels8;
+uint16_t		maskWords[8];
+int				ii;
+
+	for (ii=0; ii<8; ii++)
+	{
+		maskWords[ii]	=	(((1 + ii) & 1) == (greenFirst ? 1 : 0)) ? 0xffff : 0;
+	}
+	colorMask	=	vld1q_u16(maskWords);
+	for (; xx <= (width - 9); xx += 8)
+	{
+		cur			=	vld1q_u16(curRow + xx);
+		left		=	vld1q_u16(curRow + xx - 1);
+		right		=	vld1q_u16(curRow + xx + 1);
+		up			=	vld1q_u16(prevRow + xx);
+		down		=	vld1q_u16(nextRow + xx);
+		hAvg		=	vrhaddq_u16(left, right);
+		vAvg		=	vrhaddq_u16(up, down);
+		diagAvg		=	vrhaddq_u16(vrhaddq_u16(vld1q_u16(prevRow + xx - 1), vld1q_u16(prevRow + xx + 1)),
+									vrhaddq_u16(vld1q_u16(nextRow + xx - 1), vld1q_u16(nextRow + xx + 1)));
+		greenAtColor	=	vrhaddq_u16(hAvg, vAvg);
+		if (method == kDemosaic_EdgeAware)
+		{
+			greenAtColor	=	vbslq_u16(vcltq_u16(vabdq_u16(left, right), vabdq_u16(up, down)), hAvg, greenAtColor);
+			greenAtColor	=	vbslq_u16(vcltq_u16(vabdq_u16(up, down), vabdq_u16(left, right)), vAvg, greenAtColor);
+		}
+		rowColor			=	vbslq_u16(colorMask, cur, hAvg);
+		otherColor			=	vbslq_u16(colorMask, diagAvg, vAvg);
+		bgrPixels.val[0]	=	redRow ? otherColor : rowColor;
+		bgrPixels.val[1]	=	vbslq_u16(colorMask, greenAtColor, cur);
+		bgrPixels.val[2]	=	redRow ? rowColor : otherColor;
+		if (output8)
+		{
+			bgrPixels8.val[0]	=	vshrn_n_u16(bgrPixels.val[0], 8);
+			bgrPixels8.val[1]	=	vshrn_n_u16(bgrPixels.val[1], 8);
+			bgrPixels8.val[2]	=	vshrn_n_u16(bgrPixels.val[2], 8);
+			vst3_u8(((uint8_t *)dstPtr) + (xx * 3), bgrPixels8);
+		}
+		else
+		{
+			vst3q_u16(((uint16_t *)dstPtr) + (xx * 3), bgrPixels);
+		}
+	}
+#endif
+	DemosaicPixels_U16(dstPtr, output8, prevRow, curRow, nextRow, width, xx, width, redRow, greenFirst, method);
+}
+
+//*****************************************************************************
+//*	one row of RAW16 to RGB48 (BGR)
+//*****************************************************************************
+void	ImageKernel_DemosaicRow_U16(	uint16_t		*dstPtr,
+										const uint16_t	*prevRow,
+										const uint16_t	*curRow,
+										const uint16_t	*nextRow,
+										const int		width,
+										const int		redRow,
+										const int		greenFirst,
+										const int		method)
+{
+	DemosaicRow_U16(dstPtr, false, prevRow, curRow, nextRow, width, redRow, greenFirst, method);
+}
+
+//*****************************************************************************
+//*	one row of RAW16 to RGB24 (BGR), the high byte of each value is kept
+//*****************************************************************************
+void	ImageKernel_DemosaicRow_U16toU8(	uint8_t			*dstPtr,
+											const uint16_t	*prevRow,
+											const uint16_t	*curRow,
+											const uint16_t	*nextRow,
+											const int		width,
+											const int		redRow,
+											const int		greenFirst,
+											const int		method)
+{
+	DemosaicRow_U16(dstPtr, true, prevRow, curRow, nextRow, width, redRow, greenFirst, method);
+}
+
+//*****************************************************************************
+//*	dst = color + (dst * invAlpha / 255)
+//*	color is premultiplied by alpha, invAlpha is 255 - alpha
+//*	(t + (t >> 8) + 128) >> 8 is an exact rounded divide by 255 for t <= 255 * 255
+//*****************************************************************************
+void	ImageKernel_BlendPremult_U8(	uint8_t			*dstPtr,
+										const uint8_t	*colorPtr,
+										const uint8_t	*invAlphaPtr,
+										const int		count)
+{
+int			ii;
+uint32_t	scaled;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	zero_x16	=	_mm_setzero_si128();
+__m128i	round_x8	=	_mm_set1_epi16(128);
+__m128i	pixels;
+__m128i	invAlpha;
+__m128i	prodLo;
+__m128i	prodHi;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		pixels		=	_mm_loadu_si128((const __m128i *)(dstPtr + ii));
+		invAlpha	=	_mm_loadu_si128((const __m128i *)(invAlphaPtr + ii));
+		prodLo		=	_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero_x16), _mm_unpacklo_epi8(invAlpha, zero_x16)), round_x8);
+		prodHi		=	_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero_x16), _mm_unpackhi_epi8(invAlpha, zero_x16)), round_x8);
+		prodLo		=	_mm_srli_epi16(_mm_add_epi16(prodLo, _mm_srli_epi16(prodLo, 8)), 8);
+		prodHi		=	_mm_srli_epi16(_mm_add_epi16(prodHi, _mm_srli_epi16(prodHi, 8)), 8);
+		_mm_storeu_si128((__m128i *)(dstPtr + ii),
+						_mm_adds_epu8(_mm_packus_epi16(prodLo, prodHi), _mm_loadu_si128((const __m128i *)(colorPtr + ii))));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint8x16_t	pixels;
+uint8x16_t	invAlpha;
+uint16x8_t	prodLo;
+uint16x8_t	prodHi;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		pixels		=	vld1q_u8(dstPtr + ii);
+		invAlpha	=	vld1q_u8(invAlphaPtr + ii);
+		prodLo		=	vmull_u8(vget_low_u8(pixels), vget_low_u8(invAlpha));
+		prodHi		=	vmull_u8(vget_high_u8(pixels), vget_high_u8(invAlpha));
+		//*	vraddhn(t, t >> 8) is the same rounded divide by 255
+		vst1q_u8(dstPtr + ii, vqaddq_u8(vcombine_u8(vraddhn_u16(prodLo, vrshrq_n_u16(prodLo, 8)),
+													vraddhn_u16(prodHi, vrshrq_n_u16(prodHi, 8))),
+										vld1q_u8(colorPtr + ii)));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		scaled		=	(dstPtr[ii] * invAlphaPtr[ii]) + 128;
+		scaled		=	((scaled + (scaled >> 8)) >> 8) + colorPtr[ii];
+		dstPtr[ii]	=	(scaled > 255) ? 255 : scaled;
+	}
+}
+
+//*****************************************************************************
+//*	same as above with 16 bit samples, invAlpha is 65535 - alpha
+//*	(dst * invAlpha + dst) >> 16 is 0 when invAlpha is 0 and dst when it is 65535
+//*****************************************************************************
+void	ImageKernel_BlendPremult_U16(	uint16_t		*dstPtr,
+										const uint16_t	*colorPtr,
+										const uint16_t	*invAlphaPtr,
+										const int		count)
+{
+int			ii;
+uint32_t	scaled;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	signBit_x8	=	_mm_set1_epi16((short)0x8000);
+__m128i	pixels;
+__m128i	invAlpha;
+__m128i	prodLo;
+__m128i	prodHi;
+__m128i	sumLo;
+__m128i	carry;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		pixels		=	_mm_loadu_si128((const __m128i *)(dstPtr + ii));
+		invAlpha	=	_mm_loadu_si128((const __m128i *)(invAlphaPtr + ii));
+		prodLo		=	_mm_mullo_epi16(pixels, invAlpha);
+		prodHi		=	_mm_mulhi_epu16(pixels, invAlpha);
+		sumLo		=	_mm_add_epi16(prodLo, pixels);
+		//*	no unsigned compare in SSE2, flip the sign bits and use the signed one
+		carry		=	_mm_cmpgt_epi16(_mm_xor_si128(prodLo, signBit_x8), _mm_xor_si128(sumLo, signBit_x8));
+		prodHi		=	_mm_sub_epi16(prodHi, carry);
+		_mm_storeu_si128((__m128i *)(dstPtr + ii),
+						_mm_adds_epu16(prodHi, _mm_loadu_si128((const __m128i *)(colorPtr + ii))));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t	pixels;
+uint16x8_t	invAlpha;
+uint32x4_t	prodLo;
+uint32x4_t	prodHi;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		pixels		=	vld1q_u16(dstPtr + ii);
+		invAlpha	=	vld1q_u16(invAlphaPtr + ii);
+		prodLo		=	vaddw_u16(vmull_u16(vget_low_u16(pixels), vget_low_u16(invAlpha)), vget_low_u16(pixels));
+		prodHi		=	vaddw_u16(vmull_u16(vget_high_u16(pixels), vget_high_u16(invAlpha)), vget_high_u16(pixels));
+		vst1q_u16(dstPtr + ii, vqaddq_u16(vcombine_u16(vshrn_n_u32(prodLo, 16), vshrn_n_u32(prodHi, 16)),
+										vld1q_u16(colorPtr + ii)));
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		scaled		=	(((uint32_t)dstPtr[ii] * invAlphaPtr[ii]) + dstPtr[ii]) >> 16;
+		scaled		+=	colorPtr[ii];
+		dstPtr[ii]	=	(scaled > 65535) ? 65535 : scaled;
+	}
+}
+
+//*****************************************************************************
+//*	each output sample is (a + b + c + d + 2) / 4 of the 2x2 block below it,
+//*	the odd column and row at the right and bottom edge are dropped.
+//*	On ARM vld3 splits the color channels apart so color runs as fast as mono,
+//*	SSE2 has no equivalent so color uses the C loop on x86
+//*****************************************************************************
+void	ImageKernel_Downsample2xRow_U8(	uint8_t			*dstPtr,
+										const uint8_t	*row0,
+										const uint8_t	*row1,
+										const int		dstWidth,
+										const int		channels)
+{
+int		ii;
+int		xx;
+int		cc;
+int		srcIdx;
+int		count;
+
+	ii		=	0;
+	count	=	dstWidth * channels;
+#if defined(__SSE2__)
+__m128i	lowMask_x8	=	_mm_set1_epi16(0x00ff);
+__m128i	two_x8		=	_mm_set1_epi16(2);
+__m128i	top;
+__m128i	bottom;
+__m128i	sumLo;
+__m128i	sumHi;
+
+	if (channels == 1)
+	{
+		for (; ii <= (count - 16); ii += 16)
+		{
+			top		=	_mm_loadu_si128((const __m128i *)(row0 + (2 * ii)));
+			bottom	=	_mm_loadu_si128((const __m128i *)(row1 + (2 * ii)));
+			sumLo	=	_mm_add_epi16(	_mm_add_epi16(_mm_and_si128(top, lowMask_x8),		_mm_srli_epi16(top, 8)),
+										_mm_add_epi16(_mm_and_si128(bottom, lowMask_x8),	_mm_srli_epi16(bottom, 8)));
+
+			top		=	_mm_loadu_si128((const __m128i *)(row0 + (2 * ii) + 16));
+			bottom	=	_mm_loadu_si128((const __m128i *)(row1 + (2 * ii) + 16));
+			sumHi	=	_mm_add_epi16(	_mm_add_epi16(_mm_and_si128(top, lowMask_x8),		_mm_srli_epi16(top, 8)),
+										_mm_add_epi16(_mm_and_si128(bottom, lowMask_x8),	_mm_srli_epi16(bottom, 8)));
+
+			sumLo	=	_mm_srli_epi16(_mm_add_epi16(sumLo, two_x8), 2);
+			sumHi	=	_mm_srli_epi16(_mm_add_epi16(sumHi, two_x8), 2);
+			_mm_storeu_si128((__m128i *)(dstPtr + ii), _mm_packus_epi16(sumLo, sumHi));
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t		sumLo;
+uint16x8_t		sumHi;
+uint8x16x3_t	top_x3;
+uint8x16x3_t	bottom_x3;
+uint8x8x3_t		result_x3;
+
+	if (channels == 1)
+	{
+		for (; ii <= (count - 16); ii += 16)
+		{
+			sumLo	=	vpadalq_u8(vpaddlq_u8(vld1q_u8(row0 + (2 * ii))),		vld1q_u8(row1 + (2 * ii)));
+			sumHi	=	vpadalq_u8(vpaddlq_u8(vld1q_u8(row0 + (2 * ii) + 16)),	vld1q_u8(row1 + (2 * ii) + 16));
+			vst1q_u8(dstPtr + ii, vcombine_u8(vrshrn_n_u16(sumLo, 2), vrshrn_n_u16(sumHi, 2)));
+		}
+	}
+	else if (channels == 3)
+	{
+		//*	16 source pixels -> 8 output pixels
+		for (; ii <= (count - 24); ii += 24)
+		{
+			top_x3		=	vld3q_u8(row0 + (2 * ii));
+			bottom_x3	=	vld3q_u8(row1 + (2 * ii));
+			for (cc=0; cc<3; cc++)
+			{
+				result_x3.val[cc]	=	vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top_x3.val[cc]), bottom_x3.val[cc]), 2);
+			}
+			vst3_u8(dstPtr + ii, result_x3);
+		}
+	}
+#endif
+	for (xx = (ii / channels); xx < dstWidth; xx++)
+	{
+		srcIdx	=	xx * 2 * channels;
+		for (cc=0; cc<channels; cc++)
+		{
+			dstPtr[(xx * channels) + cc]	=	(row0[srcIdx + cc] + row0[srcIdx + channels + cc] +
+												row1[srcIdx + cc] + row1[srcIdx + channels + cc] + 2) >> 2;
+		}
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_Downsample2xRow_U16(uint16_t		*dstPtr,
+										const uint16_t	*row0,
+										const uint16_t	*row1,
+										const int		dstWidth,
+										const int		channels)
+{
+int			ii;
+int			xx;
+int			cc;
+int			srcIdx;
+int			count;
+uint32_t	sum;
+
+	ii		=	0;
+	count	=	dstWidth * channels;
+#if defined(__SSE2__)
+__m128i	lowMask_x4	=	_mm_set1_epi32(0x0000ffff);
+__m128i	two_x4		=	_mm_set1_epi32(2);
+__m128i	top;
+__m128i	bottom;
+__m128i	sumLo;
+__m128i	sumHi;
+
+	if (channels == 1)
+	{
+		for (; ii <= (count - 8); ii += 8)
+		{
+			top		=	_mm_loadu_si128((const __m128i *)(row0 + (2 * ii)));
+			bottom	=	_mm_loadu_si128((const __m128i *)(row1 + (2 * ii)));
+			sumLo	=	_mm_add_epi32(	_mm_add_epi32(_mm_and_si128(top, lowMask_x4),		_mm_srli_epi32(top, 16)),
+										_mm_add_epi32(_mm_and_si128(bottom, lowMask_x4),	_mm_srli_epi32(bottom, 16)));
+
+			top		=	_mm_loadu_si128((const __m128i *)(row0 + (2 * ii) + 8));
+			bottom	=	_mm_loadu_si128((const __m128i *)(row1 + (2 * ii) + 8));
+			sumHi	=	_mm_add_epi32(	_mm_add_epi32(_mm_and_si128(top, lowMask_x4),		_mm_srli_epi32(top, 16)),
+										_mm_add_epi32(_mm_and_si128(bottom, lowMask_x4),	_mm_srli_epi32(bottom, 16)));
+
+			sumLo	=	_mm_srli_epi32(_mm_add_epi32(sumLo, two_x4), 2);
+			sumHi	=	_mm_srli_epi32(_mm_add_epi32(sumHi, two_x4), 2);
+			//*	no unsigned 32 -> 16 pack in SSE2, sign extend the low half so the signed pack keeps the bits
+			sumLo	=	_mm_srai_epi32(_mm_slli_epi32(sumLo, 16), 16);
+			sumHi	=	_mm_srai_epi32(_mm_slli_epi32(sumHi, 16), 16);
+			_mm_storeu_si128((__m128i *)(dstPtr + ii), _mm_packs_epi32(sumLo, sumHi));
+		}
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint32x4_t		sumLo;
+uint32x4_t		sumHi;
+uint16x8x3_t	top_x3;
+uint16x8x3_t	bottom_x3;
+uint16x4x3_t	result_x3;
+
+	if (channels == 1)
+	{
+		for (; ii <= (count - 8); ii += 8)
+		{
+			sumLo	=	vpadalq_u16(vpaddlq_u16(vld1q_u16(row0 + (2 * ii))),		vld1q_u16(row1 + (2 * ii)));
+			sumHi	=	vpadalq_u16(vpaddlq_u16(vld1q_u16(row0 + (2 * ii) + 8)),	vld1q_u16(row1 + (2 * ii) + 8));
+			vst1q_u16(dstPtr + ii, vcombine_u16(vrshrn_n_u32(sumLo, 2), vrshrn_n_u32(sumHi, 2)));
+		}
+	}
+	else if (channels == 3)
+	{
+		//*	8 source pixels -> 4 output pixels
+		for (; ii <= (count - 12); ii += 12)
+		{
+			top_x3		=	vld3q_u16(row0 + (2 * ii));
+			bottom_x3	=	vld3q_u16(row1 + (2 * ii));
+			for (cc=0; cc<3; cc++)
+			{
+				result_x3.val[cc]	=	vrshrn_n_u32(vpadalq_u16(vpaddlq_u16(top_x3.val[cc]), bottom_x3.val[cc]), 2);
+			}
+			vst3_u16(dstPtr + ii, result_x3);
+		}
+	}
+#endif
+	for (xx = (ii / channels); xx < dstWidth; xx++)
+	{
+		srcIdx	=	xx * 2 * channels;
+		for (cc=0; cc<channels; cc++)
+		{
+			sum		=	(uint32_t)row0[srcIdx + cc] + row0[srcIdx + channels + cc];
+			sum		+=	(uint32_t)row1[srcIdx + cc] + row1[srcIdx + channels + cc];
+			dstPtr[(xx * channels) + cc]	=	(sum + 2) >> 2;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	OR of all of the values, the highest and lowest bits set tell how many
+//*	bits the data really uses
+//*****************************************************************************
+uint16_t	ImageKernel_OrReduce_U16(	const uint16_t	*srcPtr,
+										const int		count)
+{
+int			ii;
+uint16_t	orValue;
+
+	ii		=	0;
+	orValue	=	0;
+#if defined(__SSE2__)
+__m128i	or_x8	=	_mm_setzero_si128();
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		or_x8	=	_mm_or_si128(or_x8, _mm_loadu_si128((const __m128i *)(srcPtr + ii)));
+		or_x8	=	_mm_or_si128(or_x8, _mm_loadu_si128((const __m128i *)(srcPtr + ii + 8)));
+	}
+	or_x8	=	_mm_or_si128(or_x8, _mm_srli_si128(or_x8, 8));
+	or_x8	=	_mm_or_si128(or_x8, _mm_srli_si128(or_x8, 4));
+	or_x8	=	_mm_or_si128(or_x8, _mm_srli_si128(or_x8, 2));
+	orValue	=	_mm_cvtsi128_si32(or_x8) & 0x0ffff;
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t	or_x8	=	vdupq_n_u16(0);
+uint16x4_t	or_x4;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		or_x8	=	vorrq_u16(or_x8, vld1q_u16(srcPtr + ii));
+		or_x8	=	vorrq_u16(or_x8, vld1q_u16(srcPtr + ii + 8));
+	}
+	or_x4	=	vorr_u16(vget_low_u16(or_x8), vget_high_u16(or_x8));
+	orValue	=	vget_lane_u16(or_x4, 0) | vget_lane_u16(or_x4, 1) | vget_lane_u16(or_x4, 2) | vget_lane_u16(or_x4, 3);
+#endif
+	for (; ii < count; ii++)
+	{
+		orValue	|=	srcPtr[ii];
+	}
+	return(orValue);
+}
+
+//*****************************************************************************
+//*	bit packing, 4 pixels make a group of (bitsPerPixel / 2) bytes, little endian,
+//*	pixel 0 in the low bits. The pixels are shifted right by "shift" before packing
+//*	and left by "shift" after unpacking so MSB aligned data (12 bit sensors that
+//*	report 0..65520) packs as well.
+//*	The SIMD loops build 2 groups in the two 64 bit lanes and store 8 bytes per group,
+//*	each store overwrites the unused top bytes of the one before it, so they stop
+//*	while there are still 8 bytes of room and the last groups are done one at a time.
+//*****************************************************************************
+static inline void	PackGroup(uint8_t *dstPtr, const uint16_t *srcPtr, const int groupCnt, const int bitsPerPixel, const int shift)
+{
+uint64_t	groupBits;
+int			ii;
+
+	groupBits	=	0;
+	for (ii=(groupCnt - 1); ii>=0; ii--)
+	{
+		groupBits	=	(groupBits << bitsPerPixel) | (srcPtr[ii] >> shift);
+	}
+	for (ii=0; ii<(bitsPerPixel / 2); ii++)
+	{
+		dstPtr[ii]	=	groupBits & 0x0ff;
+		groupBits	>>=	8;
+	}
+}
+
+//*****************************************************************************
+//*	count does not have to be a multiple of 4, the last group is padded with 0.
+//*	bitsPerPixel must be even, 8 to 16.  Returns the number of bytes written
+//*****************************************************************************
+int		ImageKernel_PackBits_U16(	uint8_t			*dstPtr,
+									const uint16_t	*srcPtr,
+									const int		count,
+									const int		bitsPerPixel,
+									const int		shift)
+{
+int		ii;
+int		dstIdx;
+int		groupBytes;
+int		dstLen;
+
+	groupBytes	=	bitsPerPixel / 2;
+	dstLen		=	((count + 3) / 4) * groupBytes;
+	ii			=	0;
+	dstIdx		=	0;
+#if defined(__SSE2__)
+__m128i		shift_x8		=	_mm_cvtsi32_si128(shift);
+__m128i		bits_x4			=	_mm_cvtsi32_si128(bitsPerPixel);
+__m128i		bits2_x2		=	_mm_cvtsi32_si128(bitsPerPixel * 2);
+__m128i		lowMask16_x4	=	_mm_set1_epi32(0x0000ffff);
+__m128i		lowMask32_x2	=	_mm_set1_epi64x(0x00000000ffffffffLL);
+__m128i		pixels;
+__m128i		pairs;
+__m128i		groups;
+
+	for (; (ii <= (count - 8)) && ((dstIdx + (2 * groupBytes) + 8) <= dstLen); ii += 8)
+	{
+		pixels	=	_mm_srl_epi16(_mm_loadu_si128((const __m128i *)(srcPtr + ii)), shift_x8);
+		pairs	=	_mm_or_si128(_mm_and_si128(pixels, lowMask16_x4), _mm_sll_epi32(_mm_srli_epi32(pixels, 16), bits_x4));
+		groups	=	_mm_or_si128(_mm_and_si128(pairs, lowMask32_x2), _mm_sll_epi64(_mm_srli_epi64(pairs, 32), bits2_x2));
+		_mm_storel_epi64((__m128i *)(dstPtr + dstIdx), groups);
+		_mm_storel_epi64((__m128i *)(dstPtr + dstIdx + groupBytes), _mm_srli_si128(groups, 8));
+		dstIdx	+=	2 * groupBytes;
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+int16x8_t	shift_x8		=	vdupq_n_s16(-shift);
+int32x4_t	bits_x4			=	vdupq_n_s32(bitsPerPixel);
+int64x2_t	bits2_x2		=	vdupq_n_s64(bitsPerPixel * 2);
+uint32x4_t	lowMask16_x4	=	vdupq_n_u32(0x0000ffff);
+uint64x2_t	lowMask32_x2	=	vdupq_n_u64(0x00000000ffffffffULL);
+uint16x8_t	pixels;
+uint32x4_t	pairs;
+uint64x2_t	groups;
+uint64_t	groupBits;
+
+	for (; (ii <= (count - 8)) && ((dstIdx + (2 * groupBytes) + 8) <= dstLen); ii += 8)
+	{
+		pixels	=	vshlq_u16(vld1q_u16(srcPtr + ii), shift_x8);
+		pairs	=	vreinterpretq_u32_u16(pixels);
+		pairs	=	vorrq_u32(vandq_u32(pairs, lowMask16_x4), vshlq_u32(vshrq_n_u32(pairs, 16), bits_x4));
+		groups	=	vreinterpretq_u64_u32(pairs);
+		groups	=	vorrq_u64(vandq_u64(groups, lowMask32_x2), vshlq_u64(vshrq_n_u64(groups, 32), bits2_x2));
+		groupBits	=	vgetq_lane_u64(groups, 0);
+		memcpy(dstPtr + dstIdx, &groupBits, 8);
+		groupBits	=	vgetq_lane_u64(groups, 1);
+		memcpy(dstPtr + dstIdx + groupBytes, &groupBits, 8);
+		dstIdx	+=	2 * groupBytes;
+	}
+#endif
+	for (; ii <= (count - 4); ii += 4)
+	{
+		PackGroup(dstPtr + dstIdx, srcPtr + ii, 4, bitsPerPixel, shift);
+		dstIdx	+=	groupBytes;
+	}
+	if (ii < count)
+	{
+		PackGroup(dstPtr + dstIdx, srcPtr + ii, (count - ii), bitsPerPixel, shift);
+		dstIdx	+=	groupBytes;
+	}
+	return(dstIdx);
+}
+
+//*****************************************************************************
+//*	the reverse of ImageKernel_PackBits_U16(), srcPtr must have all of the groups,
+//*	((count + 3) / 4) * (bitsPerPixel / 2) bytes.  Returns the number of bytes used
+//*****************************************************************************
+int		ImageKernel_UnpackBits_U16(	uint16_t		*dstPtr,
+									const uint8_t	*srcPtr,
+									const int		count,
+									const int		bitsPerPixel,
+									const int		shift)
+{
+int			ii;
+int			jj;
+int			srcIdx;
+int			groupBytes;
+int			srcLen;
+uint64_t	groupBits;
+uint16_t	pixelMask;
+
+	groupBytes	=	bitsPerPixel / 2;
+	srcLen		=	((count + 3) / 4) * groupBytes;
+	pixelMask	=	(1 << bitsPerPixel) - 1;
+	ii			=	0;
+	srcIdx		=	0;
+#if defined(__SSE2__)
+__m128i		shift_x8		=	_mm_cvtsi32_si128(shift);
+__m128i		bits_x4			=	_mm_cvtsi32_si128(bitsPerPixel);
+__m128i		bits2_x2		=	_mm_cvtsi32_si128(bitsPerPixel * 2);
+__m128i		pixelMask_x4	=	_mm_set1_epi32(pixelMask);
+__m128i		pairMask_x2		=	_mm_set1_epi64x((1LL << (bitsPerPixel * 2)) - 1);
+__m128i		groups;
+__m128i		pairs;
+__m128i		pixels;
+int64_t		group0;
+int64_t		group1;
+
+	for (; (ii <= (count - 8)) && ((srcIdx + groupBytes + 8) <= srcLen); ii += 8)
+	{
+		memcpy(&group0, srcPtr + srcIdx, 8);
+		memcpy(&group1, srcPtr + srcIdx + groupBytes, 8);
+		groups	=	_mm_set_epi64x(group1, group0);
+		pairs	=	_mm_or_si128(_mm_and_si128(groups, pairMask_x2), _mm_slli_epi64(_mm_srl_epi64(groups, bits2_x2), 32));
+		pixels	=	_mm_or_si128(_mm_and_si128(pairs, pixelMask_x4), _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(pairs, bits_x4), pixelMask_x4), 16));
+		_mm_storeu_si128((__m128i *)(dstPtr + ii), _mm_sll_epi16(pixels, shift_x8));
+		srcIdx	+=	2 * groupBytes;
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+int16x8_t	shift_x8		=	vdupq_n_s16(shift);
+int32x4_t	negBits_x4		=	vdupq_n_s32(-bitsPerPixel);
+int64x2_t	negBits2_x2		=	vdupq_n_s64(-(bitsPerPixel * 2));
+uint32x4_t	pixelMask_x4	=	vdupq_n_u32(pixelMask);
+uint64x2_t	pairMask_x2		=	vdupq_n_u64((1ULL << (bitsPerPixel * 2)) - 1);
+uint64x2_t	groups;
+uint32x4_t	pairs;
+uint64_t	group0;
+uint64_t	group1;
+
+	for (; (ii <= (count - 8)) && ((srcIdx + groupBytes + 8) <= srcLen); ii += 8)
+	{
+		memcpy(&group0, srcPtr + srcIdx, 8);
+		memcpy(&group1, srcPtr + srcIdx + groupBytes, 8);
+		groups	=	vcombine_u64(vcreate_u64(group0), vcreate_u64(group1));
+		groups	=	vorrq_u64(vandq_u64(groups, pairMask_x2), vshlq_n_u64(vshlq_u64(groups, negBits2_x2), 32));
+		pairs	=	vreinterpretq_u32_u64(groups);
+		pairs	=	vorrq_u32(vandq_u32(pairs, pixelMask_x4), vshlq_n_u32(vandq_u32(vshlq_u32(pairs, negBits_x4), pixelMask_x4), 16));
+		vst1q_u16(dstPtr + ii, vshlq_u16(vreinterpretq_u16_u32(pairs), shift_x8));
+		srcIdx	+=	2 * groupBytes;
+	}
+#endif
+	for (; ii < count; ii += 4)
+	{
+		groupBits	=	0;
+		for (jj=(groupBytes - 1); jj>=0; jj--)
+		{
+			groupBits	=	(groupBits << 8) | srcPtr[srcIdx + jj];
+		}
+		for (jj=0; (jj < 4) && ((ii + jj) < count); jj++)
+		{
+			dstPtr[ii + jj]	=	(groupBits & pixelMask) << shift;
+			groupBits		>>=	bitsPerPixel;
+		}
+		srcIdx	+=	groupBytes;
+	}
+	return(srcIdx);
+}
+
+//*****************************************************************************
+//*	software binning
+//*	The row is done in chunks so the column sums stay in the L1 cache.
+//*	The column sums (binFactor rows added together) are done with SIMD, this is
+//*	where all of the source data gets read. The horizontal sums are then done from
+//*	the chunk with the bin factor as a constant so the compiler can unroll them
+//*****************************************************************************
+#define	kBinChunkPixels		256
+#define	kBinMaxFactor		4
+#define	kBinChunkValues		(kBinChunkPixels * kBinMaxFactor * 3)
+
+//*****************************************************************************
+static void	BinColumnSum_U8(uint16_t		*accumPtr,
+							const uint8_t	*srcPtr,
+							const int		srcRowValues,
+							const int		count,
+							const int		binFactor)
+{
+int				ii;
+int				rr;
+const uint8_t	*rowPtr;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	zero_x16	=	_mm_setzero_si128();
+__m128i	pixels;
+__m128i	sumLo;
+__m128i	sumHi;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		sumLo	=	zero_x16;
+		sumHi	=	zero_x16;
+		for (rr=0; rr<binFactor; rr++)
+		{
+			pixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ((long)rr * srcRowValues) + ii));
+			sumLo	=	_mm_add_epi16(sumLo, _mm_unpacklo_epi8(pixels, zero_x16));
+			sumHi	=	_mm_add_epi16(sumHi, _mm_unpackhi_epi8(pixels, zero_x16));
+		}
+		_mm_storeu_si128((__m128i *)(accumPtr + ii),		sumLo);
+		_mm_storeu_si128((__m128i *)(accumPtr + ii + 8),	sumHi);
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint8x16_t	pixels;
+uint16x8_t	sumLo;
+uint16x8_t	sumHi;
+
+	for (; ii <= (count - 16); ii += 16)
+	{
+		sumLo	=	vdupq_n_u16(0);
+		sumHi	=	vdupq_n_u16(0);
+		for (rr=0; rr<binFactor; rr++)
+		{
+			pixels	=	vld1q_u8(srcPtr + ((long)rr * srcRowValues) + ii);
+			sumLo	=	vaddw_u8(sumLo, vget_low_u8(pixels));
+			sumHi	=	vaddw_u8(sumHi, vget_high_u8(pixels));
+		}
+		vst1q_u16(accumPtr + ii,		sumLo);
+		vst1q_u16(accumPtr + ii + 8,	sumHi);
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		accumPtr[ii]	=	0;
+		rowPtr			=	srcPtr + ii;
+		for (rr=0; rr<binFactor; rr++)
+		{
+			accumPtr[ii]	+=	*rowPtr;
+			rowPtr			+=	srcRowValues;
+		}
+	}
+}
+
+//*****************************************************************************
+static void	BinColumnSum_U16(	uint32_t		*accumPtr,
+								const uint16_t	*srcPtr,
+								const int		srcRowValues,
+								const int		count,
+								const int		binFactor)
+{
+int				ii;
+int				rr;
+const uint16_t	*rowPtr;
+
+	ii	=	0;
+#if defined(__SSE2__)
+__m128i	zero_x8	=	_mm_setzero_si128();
+__m128i	pixels;
+__m128i	sumLo;
+__m128i	sumHi;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		sumLo	=	zero_x8;
+		sumHi	=	zero_x8;
+		for (rr=0; rr<binFactor; rr++)
+		{
+			pixels	=	_mm_loadu_si128((const __m128i *)(srcPtr + ((long)rr * srcRowValues) + ii));
+			sumLo	=	_mm_add_epi32(sumLo, _mm_unpacklo_epi16(pixels, zero_x8));
+			sumHi	=	_mm_add_epi32(sumHi, _mm_unpackhi_epi16(pixels, zero_x8));
+		}
+		_mm_storeu_si128((__m128i *)(accumPtr + ii),		sumLo);
+		_mm_storeu_si128((__m128i *)(accumPtr + ii + 4),	sumHi);
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+uint16x8_t	pixels;
+uint32x4_t	sumLo;
+uint32x4_t	sumHi;
+
+	for (; ii <= (count - 8); ii += 8)
+	{
+		sumLo	=	vdupq_n_u32(0);
+		sumHi	=	vdupq_n_u32(0);
+		for (rr=0; rr<binFactor; rr++)
+		{
+			pixels	=	vld1q_u16(srcPtr + ((long)rr * srcRowValues) + ii);
+			sumLo	=	vaddw_u16(sumLo, vget_low_u16(pixels));
+			sumHi	=	vaddw_u16(sumHi, vget_high_u16(pixels));
+		}
+		vst1q_u32(accumPtr + ii,		sumLo);
+		vst1q_u32(accumPtr + ii + 4,	sumHi);
+	}
+#endif
+	for (; ii < count; ii++)
+	{
+		accumPtr[ii]	=	0;
+		rowPtr			=	srcPtr + ii;
+		for (rr=0; rr<binFactor; rr++)
+		{
+			accumPtr[ii]	+=	*rowPtr;
+			rowPtr			+=	srcRowValues;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	binFactor is always a constant where this is called
+//*****************************************************************************
+static inline void	BinFinish_U8(	uint8_t			*dstPtr,
+									const uint16_t	*accumPtr,
+									const int		pixelCnt,
+									const int		channels,
+									const int		binFactor,
+									const int		binMode)
+{
+int			ii;
+int			bb;
+int			cc;
+uint32_t	sum;
+uint32_t	blockCnt;
+const uint16_t	*blockPtr;
+
+	blockCnt	=	binFactor * binFactor;
+	for (ii=0; ii<pixelCnt; ii++)
+	{
+		blockPtr	=	accumPtr + (ii * binFactor * channels);
+		for (cc=0; cc<channels; cc++)
+		{
+			sum	=	0;
+			for (bb=0; bb<binFactor; bb++)
+			{
+				sum	+=	blockPtr[(bb * channels) + cc];
+			}
+			if (binMode == kBinMode_Average)
+			{
+				sum	=	(sum + (blockCnt / 2)) / blockCnt;
+			}
+			else if (sum > 0x00ff)
+			{
+				sum	=	0x00ff;
+			}
+			dstPtr[(ii * channels) + cc]	=	sum;
+		}
+	}
+}
+
+//*****************************************************************************
+static inline void	BinFinish_U16(	uint16_t		*dstPtr,
+									const uint32_t	*accumPtr,
+									const int		pixelCnt,
+									const int		channels,
+									const int		binFactor,
+									const int		binMode)
+{
+int			ii;
+int			bb;
+int			cc;
+uint32_t	sum;
+uint32_t	blockCnt;
+const uint32_t	*blockPtr;
+
+	blockCnt	=	binFactor * binFactor;
+	for (ii=0; ii<pixelCnt; ii++)
+	{
+		blockPtr	=	accumPtr + (ii * binFactor * channels);
+		for (cc=0; cc<channels; cc++)
+		{
+			sum	=	0;
+			for (bb=0; bb<binFactor; bb++)
+			{
+				sum	+=	blockPtr[(bb * channels) + cc];
+			}
+			if (binMode == kBinMode_Average)
+			{
+				sum	=	(sum + (blockCnt / 2)) / blockCnt;
+			}
+			else if (sum > 0xffff)
+			{
+				sum	=	0xffff;
+			}
+			dstPtr[(ii * channels) + cc]	=	sum;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	mono 2x2 and 4x4, the horizontal sums are pairwise adds of neighbors
+//*	(once for 2x2, twice for 4x4). Returns the number of pixels done
+//*****************************************************************************
+#if defined(__SSE2__)
+static inline __m128i	PairSum_U32_SSE2(const __m128i lowValues, const __m128i highValues)
+{
+__m128	lowPS	=	_mm_castsi128_ps(lowValues);
+__m128	highPS	=	_mm_castsi128_ps(highValues);
+
+	return(_mm_add_epi32(	_mm_castps_si128(_mm_shuffle_ps(lowPS, highPS, _MM_SHUFFLE(2, 0, 2, 0))),
+							_mm_castps_si128(_mm_shuffle_ps(lowPS, highPS, _MM_SHUFFLE(3, 1, 3, 1)))));
+}
+#endif
+
+//*****************************************************************************
+static int	BinFinishMono_U8(	uint8_t			*dstPtr,
+								const uint16_t	*accumPtr,
+								const int		pixelCnt,
+								const int		binFactor,
+								const int		binMode)
+{
+int		ii;
+int		roundShift;
+
+	ii			=	0;
+	roundShift	=	(binFactor == 2) ? 2 : 4;
+	if ((binFactor != 2) && (binFactor != 4))
+	{
+		return(0);
+	}
+#if defined(__SSE2__)
+__m128i			ones_x8		=	_mm_set1_epi16(1);
+__m128i			round_x8	=	_mm_set1_epi16((binFactor * binFactor) / 2);
+__m128i			shift_x1	=	_mm_cvtsi32_si128(roundShift);
+__m128i			sums;
+const __m128i	*blockPtr;
+
+	for (; ii <= (pixelCnt - 8); ii += 8)
+	{
+		//*	the column sums are at most 4 * 255, the signed 16 bit math is safe
+		blockPtr	=	(const __m128i *)(accumPtr + (ii * binFactor));
+		sums		=	_mm_packs_epi32(_mm_madd_epi16(_mm_loadu_si128(blockPtr), ones_x8),
+										_mm_madd_epi16(_mm_loadu_si128(blockPtr + 1), ones_x8));
+		if (binFactor == 4)
+		{
+			sums	=	_mm_packs_epi32(_mm_madd_epi16(sums, ones_x8),
+										_mm_madd_epi16(_mm_packs_epi32(	_mm_madd_epi16(_mm_loadu_si128(blockPtr + 2), ones_x8),
+																		_mm_madd_epi16(_mm_loadu_si128(blockPtr + 3), ones_x8)),
+														ones_x8));
+		}
+		if (binMode == kBinMode_Average)
+		{
+			sums	=	_mm_srl_epi16(_mm_add_epi16(sums, round_x8), shift_x1);
+		}
+		//*	unsigned saturation to 255 is the saturating sum
+		_mm_storel_epi64((__m128i *)(dstPtr + ii), _mm_packus_epi16(sums, sums));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+int16x8_t		negShift_x8	=	vdupq_n_s16(-roundShift);
+uint16x8x2_t	pairs;
+uint16x8_t		sums;
+uint16x8_t		sumsHigh;
+const uint16_t	*blockPtr;
+
+	for (; ii <= (pixelCnt - 8); ii += 8)
+	{
+		blockPtr	=	accumPtr + (ii * binFactor);
+		pairs		=	vuzpq_u16(vld1q_u16(blockPtr), vld1q_u16(blockPtr + 8));
+		sums		=	vaddq_u16(pairs.val[0], pairs.val[1]);
+		if (binFactor == 4)
+		{
+			pairs		=	vuzpq_u16(vld1q_u16(blockPtr + 16), vld1q_u16(blockPtr + 24));
+			sumsHigh	=	vaddq_u16(pairs.val[0], pairs.val[1]);
+			pairs		=	vuzpq_u16(sums, sumsHigh);
+			sums		=	vaddq_u16(pairs.val[0], pairs.val[1]);
+		}
+		if (binMode == kBinMode_Average)
+		{
+			sums	=	vrshlq_u16(sums, negShift_x8);
+		}
+		vst1_u8(dstPtr + ii, vqmovn_u16(sums));
+	}
+#else
+	(void)roundShift;
+#endif
+	return(ii);
+}
+
+//*****************************************************************************
+static int	BinFinishMono_U16(	uint16_t		*dstPtr,
+								const uint32_t	*accumPtr,
+								const int		pixelCnt,
+								const int		binFactor,
+								const int		binMode)
+{
+int		ii;
+int		roundShift;
+
+	ii			=	0;
+	roundShift	=	(binFactor == 2) ? 2 : 4;
+	if ((binFactor != 2) && (binFactor != 4))
+	{
+		return(0);
+	}
+#if defined(__SSE2__)
+__m128i			round_x4	=	_mm_set1_epi32((binFactor * binFactor) / 2);
+__m128i			shift_x1	=	_mm_cvtsi32_si128(roundShift);
+__m128i			bias_x4		=	_mm_set1_epi32(0x8000);
+__m128i			bias_x8		=	_mm_set1_epi16((short)0x8000);
+__m128i			sumLo;
+__m128i			sumHi;
+const __m128i	*blockPtr;
+
+	for (; ii <= (pixelCnt - 8); ii += 8)
+	{
+		blockPtr	=	(const __m128i *)(accumPtr + (ii * binFactor));
+		if (binFactor == 2)
+		{
+			sumLo	=	PairSum_U32_SSE2(_mm_loadu_si128(blockPtr),		_mm_loadu_si128(blockPtr + 1));
+			sumHi	=	PairSum_U32_SSE2(_mm_loadu_si128(blockPtr + 2),	_mm_loadu_si128(blockPtr + 3));
+		}
+		else
+		{
+			sumLo	=	PairSum_U32_SSE2(	PairSum_U32_SSE2(_mm_loadu_si128(blockPtr),		_mm_loadu_si128(blockPtr + 1)),
+											PairSum_U32_SSE2(_mm_loadu_si128(blockPtr + 2),	_mm_loadu_si128(blockPtr + 3)));
+			sumHi	=	PairSum_U32_SSE2(	PairSum_U32_SSE2(_mm_loadu_si128(blockPtr + 4),	_mm_loadu_si128(blockPtr + 5)),
+											PairSum_U32_SSE2(_mm_loadu_si128(blockPtr + 6),	_mm_loadu_si128(blockPtr + 7)));
+		}
+		if (binMode == kBinMode_Average)
+		{
+			sumLo	=	_mm_srl_epi32(_mm_add_epi32(sumLo, round_x4), shift_x1);
+			sumHi	=	_mm_srl_epi32(_mm_add_epi32(sumHi, round_x4), shift_x1);
+		}
+		//*	no unsigned 32 -> 16 pack in SSE2, offset by 0x8000 so the signed
+		//*	saturation of the pack is the unsigned saturation at 65535
+		sumLo	=	_mm_sub_epi32(sumLo, bias_x4);
+		sumHi	=	_mm_sub_epi32(sumHi, bias_x4);
+		_mm_storeu_si128((__m128i *)(dstPtr + ii), _mm_xor_si128(_mm_packs_epi32(sumLo, sumHi), bias_x8));
+	}
+#elif defined(_IMAGE_KERNEL_NEON_)
+int32x4_t		negShift_x4	=	vdupq_n_s32(-roundShift);
+uint32x4x2_t	pairs;
+uint32x4_t		sumLo;
+uint32x4_t		sumHi;
+uint32x4_t		sumTmp;
+const uint32_t	*blockPtr;
+
+	for (; ii <= (pixelCnt - 8); ii += 8)
+	{
+		blockPtr	=	accumPtr + (ii * binFactor);
+		pairs		=	vuzpq_u32(vld1q_u32(blockPtr), vld1q_u32(blockPtr + 4));
+		sumLo		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+		pairs		=	vuzpq_u32(vld1q_u32(blockPtr + 8), vld1q_u32(blockPtr + 12));
+		sumHi		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+		if (binFactor == 4)
+		{
+			pairs		=	vuzpq_u32(sumLo, sumHi);
+			sumLo		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+
+			pairs		=	vuzpq_u32(vld1q_u32(blockPtr + 16), vld1q_u32(blockPtr + 20));
+			sumHi		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+			pairs		=	vuzpq_u32(vld1q_u32(blockPtr + 24), vld1q_u32(blockPtr + 28));
+			sumTmp		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+			pairs		=	vuzpq_u32(sumHi, sumTmp);
+			sumHi		=	vaddq_u32(pairs.val[0], pairs.val[1]);
+		}
+		if (binMode == kBinMode_Average)
+		{
+			sumLo	=	vrshlq_u32(sumLo, negShift_x4);
+			sumHi	=	vrshlq_u32(sumHi, negShift_x4);
+		}
+		vst1q_u16(dstPtr + ii, vcombine_u16(vqmovn_u32(sumLo), vqmovn_u32(sumHi)));
+	}
+#else
+	(void)roundShift;
+#endif
+	return(ii);
+}
+
+//*****************************************************************************
+void	ImageKernel_BinRow_U8(	uint8_t			*dstPtr,
+								const uint8_t	*srcPtr,
+								const int		srcRowValues,
+								const int		dstWidth,
+								const int		channels,
+								const int		binFactor,
+								const int		binMode)
+{
+uint16_t	accum[kBinChunkValues];
+int			firstPixel;
+int			chunkPixels;
+int			srcOffset;
+int			simdPixels;
+int			accumOffset;
+uint8_t		*outPtr;
+
+	if ((binFactor < 1) || (binFactor > kBinMaxFactor) || (channels < 1) || (channels > 3))
+	{
+		return;
+	}
+	for (firstPixel=0; firstPixel < dstWidth; firstPixel += kBinChunkPixels)
+	{
+		chunkPixels	=	dstWidth - firstPixel;
+		if (chunkPixels > kBinChunkPixels)
+		{
+			chunkPixels	=	kBinChunkPixels;
+		}
+		srcOffset	=	firstPixel * binFactor * channels;
+		BinColumnSum_U8(accum, srcPtr + srcOffset, srcRowValues, (chunkPixels * binFactor * channels), binFactor);
+		simdPixels	=	0;
+		if (channels == 1)
+		{
+			simdPixels	=	BinFinishMono_U8(dstPtr + firstPixel, accum, chunkPixels, binFactor, binMode);
+		}
+		outPtr		=	dstPtr + ((firstPixel + simdPixels) * channels);
+		accumOffset	=	simdPixels * binFactor * channels;
+		switch(binFactor)
+		{
+			case 1:	BinFinish_U8(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 1, binMode);	break;
+			case 2:	BinFinish_U8(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 2, binMode);	break;
+			case 3:	BinFinish_U8(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 3, binMode);	break;
+			case 4:	BinFinish_U8(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 4, binMode);	break;
+		}
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_BinRow_U16(	uint16_t		*dstPtr,
+								const uint16_t	*srcPtr,
+								const int		srcRowValues,
+								const int		dstWidth,
+								const int		channels,
+								const int		binFactor,
+								const int		binMode)
+{
+uint32_t	accum[kBinChunkValues];
+int			firstPixel;
+int			chunkPixels;
+int			srcOffset;
+int			simdPixels;
+int			accumOffset;
+uint16_t	*outPtr;
+
+	if ((binFactor < 1) || (binFactor > kBinMaxFactor) || (channels < 1) || (channels > 3))
+	{
+		return;
+	}
+	for (firstPixel=0; firstPixel < dstWidth; firstPixel += kBinChunkPixels)
+	{
+		chunkPixels	=	dstWidth - firstPixel;
+		if (chunkPixels > kBinChunkPixels)
+		{
+			chunkPixels	=	kBinChunkPixels;
+		}
+		srcOffset	=	firstPixel * binFactor * channels;
+		BinColumnSum_U16(accum, srcPtr + srcOffset, srcRowValues, (chunkPixels * binFactor * channels), binFactor);
+		simdPixels	=	0;
+		if (channels == 1)
+		{
+			simdPixels	=	BinFinishMono_U16(dstPtr + firstPixel, accum, chunkPixels, binFactor, binMode);
+		}
+		outPtr		=	dstPtr + ((firstPixel + simdPixels) * channels);
+		accumOffset	=	simdPixels * binFactor * channels;
+		switch(binFactor)
+		{
+			case 1:	BinFinish_U16(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 1, binMode);	break;
+			case 2:	BinFinish_U16(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 2, binMode);	break;
+			case 3:	BinFinish_U16(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 3, binMode);	break;
+			case 4:	BinFinish_U16(outPtr, accum + accumOffset, (chunkPixels - simdPixels), channels, 4, binMode);	break;
+		}
+	}
+}
+
+//*****************************************************************************
+//*	memmove() so the ROI can be moved to the top of the same buffer
+//*****************************************************************************
+void	ImageKernel_CropRows(	void			*dstPtr,
+								const void		*srcPtr,
+								const long		srcRowBytes,
+								const long		dstRowBytes,
+								const int		rowCnt)
+{
+int					yyy;
+unsigned char		*dstRow;
+const unsigned char	*srcRow;
+
+	dstRow	=	(unsigned char *)dstPtr;
+	srcRow	=	(const unsigned char *)srcPtr;
+	for (yyy=0; yyy<rowCnt; yyy++)
+	{
+		if (dstRow != srcRow)
+		{
+			memmove(dstRow, srcRow, dstRowBytes);
+		}
+		dstRow	+=	dstRowBytes;
+		srcRow	+=	srcRowBytes;
+	}
+}
+
+//*****************************************************************************
+//*	4 sub histograms, so runs of the same value do not wait on the previous increment
+//*****************************************************************************
+void	ImageKernel_Histogram_U8(	uint32_t		*histogram,
+									const uint8_t	*srcPtr,
+									const long		count)
+{
+uint32_t	subHist[4][256];
+long		ii;
+int			jj;
+
+	memset(subHist, 0, sizeof(subHist));
+	for (ii=0; ii <= (count - 4); ii += 4)
+	{
+		subHist[0][srcPtr[ii]]++;
+		subHist[1][srcPtr[ii + 1]]++;
+		subHist[2][srcPtr[ii + 2]]++;
+		subHist[3][srcPtr[ii + 3]]++;
+	}
+	for (; ii < count; ii++)
+	{
+		subHist[0][srcPtr[ii]]++;
+	}
+	for (jj=0; jj<256; jj++)
+	{
+		histogram[jj]	+=	subHist[0][jj] + subHist[1][jj] + subHist[2][jj] + subHist[3][jj];
+	}
+}
+
+//*****************************************************************************
+//*	the 16 bit table is 256K, too big to have more than one copy in the cache,
+//*	so runs of the same value are counted as a pair instead
+//*****************************************************************************
+void	ImageKernel_Histogram_U16(	uint32_t		*histogram,
+									const uint16_t	*srcPtr,
+									const long		count)
+{
+long		ii;
+uint16_t	value0;
+uint16_t	value1;
+
+	for (ii=0; ii <= (count - 2); ii += 2)
+	{
+		value0	=	srcPtr[ii];
+		value1	=	srcPtr[ii + 1];
+		if (value0 == value1)
+		{
+			histogram[value0]	+=	2;
+		}
+		else
+		{
+			histogram[value0]++;
+			histogram[value1]++;
+		}
+	}
+	for (; ii < count; ii++)
+	{
+		histogram[srcPtr[ii]]++;
+	}
+}
+
+//*****************************************************************************
+//*	BGR input (camera order), histogram[] is red[256], green[256], blue[256]
+//*****************************************************************************
+void	ImageKernel_Histogram_BGR(	uint32_t		*histogram,
+									const uint8_t	*srcPtr,
+									const long		pixelCnt)
+{
+uint32_t	*redHist;
+uint32_t	*grnHist;
+uint32_t	*bluHist;
+long		ii;
+
+	redHist	=	histogram;
+	grnHist	=	histogram + 256;
+	bluHist	=	histogram + 512;
+	for (ii=0; ii < pixelCnt; ii++)
+	{
+		bluHist[srcPtr[0]]++;
+		grnHist[srcPtr[1]]++;
+		redHist[srcPtr[2]]++;
+		srcPtr	+=	3;
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_LUT_U8(	uint8_t			*dstPtr,
+							const uint8_t	*srcPtr,
+							const int		pixelCnt,
+							const int		channels,
+							const uint8_t	*lutPtr)
+{
+int		ii;
+
+	if (channels == 3)
+	{
+		for (ii=0; ii < pixelCnt; ii++)
+		{
+			dstPtr[0]	=	lutPtr[srcPtr[2]];
+			dstPtr[1]	=	lutPtr[srcPtr[1]];
+			dstPtr[2]	=	lutPtr[srcPtr[0]];
+			dstPtr		+=	3;
+			srcPtr		+=	3;
+		}
+	}
+	else
+	{
+		for (ii=0; ii <= (pixelCnt - 4); ii += 4)
+		{
+			dstPtr[ii]		=	lutPtr[srcPtr[ii]];
+			dstPtr[ii + 1]	=	lutPtr[srcPtr[ii + 1]];
+			dstPtr[ii + 2]	=	lutPtr[srcPtr[ii + 2]];
+			dstPtr[ii + 3]	=	lutPtr[srcPtr[ii + 3]];
+		}
+		for (; ii < pixelCnt; ii++)
+		{
+			dstPtr[ii]	=	lutPtr[srcPtr[ii]];
+		}
+	}
+}
+
+//*****************************************************************************
+void	ImageKernel_LUT_U16toU8(uint8_t			*dstPtr,
+								const uint16_t	*srcPtr,
+								const int		pixelCnt,
+								const int		channels,
+								const uint8_t	*lutPtr)
+{
+int		ii;
+
+	if (channels == 3)
+	{
+		for (ii=0; ii < pixelCnt; ii++)
+		{
+			dstPtr[0]	=	lutPtr[srcPtr[2]];
+			dstPtr[1]	=	lutPtr[srcPtr[1]];
+			dstPtr[2]	=	lutPtr[srcPtr[0]];
+			dstPtr		+=	3;
+			srcPtr		+=	3;
+		}
+	}
+	else
+	{
+		for (ii=0; ii <= (pixelCnt - 4); ii += 4)
+		{
+			dstPtr[ii]		=	lutPtr[srcPtr[ii]];
+			dstPtr[ii + 1]	=	lutPtr[srcPtr[ii + 1]];
+			dstPtr[ii + 2]	=	lutPtr[srcPtr[ii + 2]];
+			dstPtr[ii + 3]	=	lutPtr[srcPtr[ii + 3]];
+		}
+		for (; ii < pixelCnt; ii++)
+		{
+			dstPtr[ii]	=	lutPtr[srcPtr[ii]];
+		}
+	}
+}
+
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+//*****************************************************************************
+//*	the predicted data is kept as byte planes, all of byte 0, then all of byte 1...
+//*	so the (mostly zero) high bytes end up in long runs for deflate
+//*****************************************************************************
+static void	Predict_Forward(	uint8_t			*planePtr,
+								const uint8_t	*srcPtr,
+								const long		count,
+								const int		elementBytes,
+								const int		stride)
+{
+long		ii;
+int			bb;
+uint32_t	value;
+uint32_t	prevValue;
+uint32_t	residual;
+uint32_t	mask;
+int			signShift;
+
+	if (elementBytes == 2)
+	{
+	const uint16_t	*src16	=	(const uint16_t *)srcPtr;
+	uint16_t		diff;
+	uint16_t		zigzag;
+
+		for (ii=0; ii<count; ii++)
+		{
+			diff	=	src16[ii] - ((ii >= stride) ? src16[ii - stride] : 0);
+			zigzag	=	(diff << 1) ^ ((diff & 0x8000) ? 0xffff : 0);
+			planePtr[ii]			=	zigzag & 0x00ff;
+			planePtr[count + ii]	=	zigzag >> 8;
+		}
+		return;
+	}
+
+	mask		=	(elementBytes == 4) ? 0xffffffff : 0x000000ff;
+	signShift	=	(elementBytes * 8) - 1;
+	for (ii=0; ii<count; ii++)
+	{
+		value		=	0;
+		prevValue	=	0;
+		for (bb=0; bb<elementBytes; bb++)
+		{
+			value	|=	(uint32_t)srcPtr[(ii * elementBytes) + bb] << (bb * 8);
+			if (ii >= stride)
+			{
+				prevValue	|=	(uint32_t)srcPtr[((ii - stride) * elementBytes) + bb] << (bb * 8);
+			}
+		}
+		residual	=	(value - prevValue) & mask;
+		residual	=	((residual << 1) & mask) ^ (((residual >> signShift) & 1) ? mask : 0);
+		for (bb=0; bb<elementBytes; bb++)
+		{
+			planePtr[(bb * count) + ii]	=	(residual >> (bb * 8)) & 0x00ff;
+		}
+	}
+}
+
+//*****************************************************************************
+static void	Predict_Reverse(	uint8_t			*dstPtr,
+								const uint8_t	*planePtr,
+								const long		count,
+								const int		elementBytes,
+								const int		stride)
+{
+long		ii;
+int			bb;
+uint32_t	value;
+uint32_t	prevValue;
+uint32_t	residual;
+uint32_t	mask;
+
+	if (elementBytes == 2)
+	{
+	uint16_t	*dst16	=	(uint16_t *)dstPtr;
+	uint16_t	zigzag;
+	uint16_t	diff;
+
+		for (ii=0; ii<count; ii++)
+		{
+			zigzag	=	planePtr[ii] | (planePtr[count + ii] << 8);
+			diff	=	(zigzag >> 1) ^ ((zigzag & 1) ? 0xffff : 0);
+			dst16[ii]	=	diff + ((ii >= stride) ? dst16[ii - stride] : 0);
+		}
+		return;
+	}
+
+	mask	=	(elementBytes == 4) ? 0xffffffff : 0x000000ff;
+	for (ii=0; ii<count; ii++)
+	{
+		residual	=	0;
+		prevValue	=	0;
+		for (bb=0; bb<elementBytes; bb++)
+		{
+			residual	|=	(uint32_t)planePtr[(bb * count) + ii] << (bb * 8);
+			if (ii >= stride)
+			{
+				prevValue	|=	(uint32_t)dstPtr[((ii - stride) * elementBytes) + bb] << (bb * 8);
+			}
+		}
+		residual	=	(residual >> 1) ^ ((residual & 1) ? mask : 0);
+		value		=	(prevValue + residual) & mask;
+		for (bb=0; bb<elementBytes; bb++)
+		{
+			dstPtr[(ii * elementBytes) + bb]	=	(value >> (bb * 8)) & 0x00ff;
+		}
+	}
+}
+
+//*****************************************************************************
+long	ImageKernel_DeflateBound(const long srcLen)
+{
+	return(compressBound(srcLen));
+}
+
+//*****************************************************************************
+//*	level 1 deflate with run length matches only (Z_RLE). After the predictor a
+//*	sky frame is mostly noise, searching for longer matches does not find any,
+//*	Z_RLE is twice as fast as the default strategy and a little smaller
+//*****************************************************************************
+long	ImageKernel_DeflateElements(uint8_t			*dstPtr,
+									const long		dstSize,
+									const uint8_t	*srcPtr,
+									const long		srcLen,
+									const int		elementBytes,
+									const int		stride)
+{
+uint8_t		*planeBuf;
+z_stream	zStream;
+long		compressedLen;
+long		count;
+int			zErr;
+
+	if ((elementBytes != 1) && (elementBytes != 2) && (elementBytes != 4))
+	{
+		return(0);
+	}
+	count		=	srcLen / elementBytes;
+	planeBuf	=	(uint8_t *)malloc(srcLen + 1);
+	if (planeBuf == NULL)
+	{
+		return(0);
+	}
+	Predict_Forward(planeBuf, srcPtr, count, elementBytes, stride);
+
+	compressedLen	=	0;
+	memset((void *)&zStream, 0, sizeof(z_stream));
+	if (deflateInit2(&zStream, Z_BEST_SPEED, Z_DEFLATED, 15, 8, Z_RLE) == Z_OK)
+	{
+		zStream.next_in		=	planeBuf;
+		zStream.avail_in	=	count * elementBytes;
+		zStream.next_out	=	dstPtr;
+		zStream.avail_out	=	dstSize;
+		zErr				=	deflate(&zStream, Z_FINISH);
+		if (zErr == Z_STREAM_END)
+		{
+			compressedLen	=	zStream.total_out;
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_NUM("deflate() failed, zErr=", zErr);
+		}
+		deflateEnd(&zStream);
+	}
+	free(planeBuf);
+	return(compressedLen);
+}
+
+//*****************************************************************************
+long	ImageKernel_InflateElements(uint8_t			*dstPtr,
+									const long		dstLen,
+									const uint8_t	*srcPtr,
+									const long		srcLen,
+									const int		elementBytes,
+									const int		stride)
+{
+uint8_t		*planeBuf;
+uLongf		planeLen;
+long		count;
+int			zErr;
+
+	if ((elementBytes != 1) && (elementBytes != 2) && (elementBytes != 4))
+	{
+		return(-1);
+	}
+	count		=	dstLen / elementBytes;
+	planeBuf	=	(uint8_t *)malloc(dstLen + 1);
+	if (planeBuf == NULL)
+	{
+		return(-1);
+	}
+	planeLen	=	dstLen;
+	zErr		=	uncompress(planeBuf, &planeLen, srcPtr, srcLen);
+	if ((zErr != Z_OK) || (planeLen != (uLongf)(count * elementBytes)))
+	{
+		CONSOLE_DEBUG_W_NUM("uncompress() failed, zErr=", zErr);
+		free(planeBuf);
+		return(-1);
+	}
+	Predict_Reverse(dstPtr, planeBuf, count, elementBytes, stride);
+	free(planeBuf);
+	return(planeLen);
+}
+#endif	//	_ENABLE_IMAGEBYTES_DEFLATE_
+
+#ifdef _INCLUDE_IMAGE_KERNELS_MAIN_
+//*****************************************************************************
+//*	self test for the kernels
+//*	make kerneltest
+//*****************************************************************************
+
+#define	kTestFrameCnt	1000
+#define	kTestPixelCnt	37		//*	not a multiple of 8 or 16 so the scalar tail gets tested
+
+//*****************************************************************************
+//*	known RAW16 frames near the top of the range with a small spread
+//*****************************************************************************
+static uint16_t	TestPixelValue(int frameNum, int pixelNum)
+{
+	return(65000 + ((frameNum * 7) + (pixelNum * 13)) % 536);
+}
+
+//*****************************************************************************
+//*	stacks kTestFrameCnt RAW16 frames and checks the sums, mean and variance
+//*	against an exact integer reference
+//*****************************************************************************
+static int	Test_StackRAW16(void)
+{
+double		sumBuf[kTestPixelCnt];
+double		sumSqBuf[kTestPixelCnt];
+uint16_t	frameBuf[kTestPixelCnt];
+uint16_t	meanBuf[kTestPixelCnt];
+uint64_t	refSum[kTestPixelCnt];
+uint64_t	refSumSq[kTestPixelCnt];
+uint64_t	refMean;
+double		refVariance;
+double		meanValue;
+double		variance;
+int			frameNum;
+int			ii;
+int			errorCnt;
+
+	memset(sumBuf, 0, sizeof(sumBuf));
+	memset(sumSqBuf, 0, sizeof(sumSqBuf));
+	memset(refSum, 0, sizeof(refSum));
+	memset(refSumSq, 0, sizeof(refSumSq));
+	for (frameNum=0; frameNum<kTestFrameCnt; frameNum++)
+	{
+		for (ii=0; ii<kTestPixelCnt; ii++)
+		{
+			frameBuf[ii]	=	TestPixelValue(frameNum, ii);
+			refSum[ii]		+=	frameBuf[ii];
+			refSumSq[ii]	+=	(uint64_t)frameBuf[ii] * frameBuf[ii];
+		}
+		ImageKernel_StackAdd_U16(sumBuf, sumSqBuf, frameBuf, kTestPixelCnt, 0.0, 0.0);
+	}
+	ImageKernel_ScaleToU16(meanBuf, sumBuf, kTestPixelCnt, (1.0 / kTestFrameCnt));
+
+	errorCnt	=	0;
+	for (ii=0; ii<kTestPixelCnt; ii++)
+	{
+		refMean		=	(refSum[ii] + (kTestFrameCnt / 2)) / kTestFrameCnt;
+		refVariance	=	(double)((kTestFrameCnt * refSumSq[ii]) - (refSum[ii] * refSum[ii])) /
+															((double)kTestFrameCnt * kTestFrameCnt);
+		meanValue	=	sumBuf[ii] / kTestFrameCnt;
+		variance	=	(sumSqBuf[ii] / kTestFrameCnt) - (meanValue * meanValue);
+		if ((sumBuf[ii] != (double)refSum[ii]) || (sumSqBuf[ii] != (double)refSumSq[ii]))
+		{
+			printf("RAW16 stack: pixel %d sum is not exact\r\n", ii);
+			errorCnt++;
+		}
+		if (meanBuf[ii] != refMean)
+		{
+			printf("RAW16 stack: pixel %d mean=%d, expected %d\r\n", ii, meanBuf[ii], (int)refMean);
+			errorCnt++;
+		}
+		//*	a float accumulator gets this wrong by thousands
+		if (fabs(variance - refVariance) > 0.01)
+		{
+			printf("RAW16 stack: pixel %d variance=%f, expected %f\r\n", ii, variance, refVariance);
+			errorCnt++;
+		}
+	}
+	printf("RAW16 stack of %d frames\t%s\r\n", kTestFrameCnt, ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	a pixel far from the running mean is replaced by the mean, one that is close is kept
+//*****************************************************************************
+static int	Test_SigmaClip(void)
+{
+double		sumBuf[kTestPixelCnt];
+double		sumSqBuf[kTestPixelCnt];
+double		oldSum[kTestPixelCnt];
+uint16_t	frameBuf[kTestPixelCnt];
+int			frameNum;
+int			frameCnt;
+int			ii;
+int			errorCnt;
+
+	memset(sumBuf, 0, sizeof(sumBuf));
+	memset(sumSqBuf, 0, sizeof(sumSqBuf));
+	frameCnt	=	0;
+	//*	mean 30005, sigma 5
+	for (frameNum=0; frameNum<20; frameNum++)
+	{
+		for (ii=0; ii<kTestPixelCnt; ii++)
+		{
+			frameBuf[ii]	=	(frameNum & 0x01) ? 30010 : 30000;
+		}
+		ImageKernel_StackAdd_U16(sumBuf, sumSqBuf, frameBuf, kTestPixelCnt, 0.0, 0.0);
+		frameCnt++;
+	}
+	memcpy(oldSum, sumBuf, sizeof(oldSum));
+	//*	even pixels are outliers, odd pixels are within 3 sigma
+	for (ii=0; ii<kTestPixelCnt; ii++)
+	{
+		frameBuf[ii]	=	(ii & 0x01) ? 30012 : 0;
+	}
+	ImageKernel_StackAdd_U16(sumBuf, sumSqBuf, frameBuf, kTestPixelCnt, (1.0 / frameCnt), (3.0 * 3.0));
+
+	errorCnt	=	0;
+	for (ii=0; ii<kTestPixelCnt; ii++)
+	{
+		if ((ii & 0x01) && (fabs(sumBuf[ii] - (oldSum[ii] + 30012.0)) > 0.0001))
+		{
+			printf("Sigma clip: pixel %d was rejected\r\n", ii);
+			errorCnt++;
+		}
+		if (((ii & 0x01) == 0) && (fabs(sumBuf[ii] - (oldSum[ii] + 30005.0)) > 0.0001))
+		{
+			printf("Sigma clip: pixel %d was not replaced by the mean\r\n", ii);
+			errorCnt++;
+		}
+	}
+	printf("Sigma clip\t\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	the SIMD rows against the plain C rows, all patterns, both methods,
+//*	widths that end in every position of the SIMD loop
+//*****************************************************************************
+#define	kTestMaxWidth	80
+
+static int	Test_DemosaicSIMD(void)
+{
+uint8_t		rows8[3][kTestMaxWidth];
+uint16_t	rows16[3][kTestMaxWidth];
+uint8_t		simd8[kTestMaxWidth * 3];
+uint8_t		ref8[kTestMaxWidth * 3];
+uint16_t	simd16[kTestMaxWidth * 3];
+uint16_t	ref16[kTestMaxWidth * 3];
+int			width;
+int			pattern;
+int			redRow;
+int			greenFirst;
+int			method;
+int			ii;
+int			rr;
+int			errorCnt;
+
+	srand(1);
+	errorCnt	=	0;
+	for (rr=0; rr<3; rr++)
+	{
+		for (ii=0; ii<kTestMaxWidth; ii++)
+		{
+			rows8[rr][ii]	=	rand() & 0x00ff;
+			rows16[rr][ii]	=	rand() & 0x0ffff;
+		}
+	}
+	for (width=1; width<=kTestMaxWidth; width++)
+	{
+		for (pattern=0; pattern<4; pattern++)
+		{
+			redRow		=	pattern & 0x01;
+			greenFirst	=	(pattern >> 1) & 0x01;
+			for (method=kDemosaic_Bilinear; method<=kDemosaic_EdgeAware; method++)
+			{
+				ImageKernel_DemosaicRow_U8(simd8, rows8[0], rows8[1], rows8[2], width, redRow, greenFirst, method);
+				DemosaicPixels_U8(ref8, rows8[0], rows8[1], rows8[2], width, 0, width, redRow, greenFirst, method);
+				if (memcmp(simd8, ref8, (width * 3)) != 0)
+				{
+					printf("Demosaic U8: width=%d pattern=%d method=%d does not match\r\n", width, pattern, method);
+					errorCnt++;
+				}
+
+				ImageKernel_DemosaicRow_U16(simd16, rows16[0], rows16[1], rows16[2], width, redRow, greenFirst, method);
+				DemosaicPixels_U16(ref16, false, rows16[0], rows16[1], rows16[2], width, 0, width, redRow, greenFirst, method);
+				if (memcmp(simd16, ref16, (width * 3 * sizeof(uint16_t))) != 0)
+				{
+					printf("Demosaic U16: width=%d pattern=%d method=%d does not match\r\n", width, pattern, method);
+					errorCnt++;
+				}
+
+				ImageKernel_DemosaicRow_U16toU8(simd8, rows16[0], rows16[1], rows16[2], width, redRow, greenFirst, method);
+				DemosaicPixels_U16(ref8, true, rows16[0], rows16[1], rows16[2], width, 0, width, redRow, greenFirst, method);
+				if (memcmp(simd8, ref8, (width * 3)) != 0)
+				{
+					printf("Demosaic U16toU8: width=%d pattern=%d method=%d does not match\r\n", width, pattern, method);
+					errorCnt++;
+				}
+			}
+		}
+	}
+	printf("Demosaic SIMD = C\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	golden image, a mosaic of one flat color has to come back as that color
+//*	at every pixel, including the edges
+//*****************************************************************************
+static int	Test_DemosaicFlatColor(void)
+{
+uint16_t	mosaic[4][kTestMaxWidth];
+uint16_t	rgbOut[kTestMaxWidth * 3];
+const int	redValue	=	51000;
+const int	greenValue	=	23000;
+const int	blueValue	=	7000;
+int			pattern;
+int			redRow;
+int			greenFirst;
+int			method;
+int			yy;
+int			xx;
+bool		colorSite;
+int			errorCnt;
+
+	errorCnt	=	0;
+	for (pattern=0; pattern<4; pattern++)
+	{
+		//*	pattern bit 0 is red in row 0, bit 1 is green first in row 0
+		for (yy=0; yy<4; yy++)
+		{
+			redRow		=	((yy & 0x01) == 0) ? (pattern & 0x01) : !(pattern & 0x01);
+			greenFirst	=	((yy & 0x01) == 0) ? ((pattern >> 1) & 0x01) : !((pattern >> 1) & 0x01);
+			for (xx=0; xx<kTestMaxWidth; xx++)
+			{
+				colorSite		=	((xx & 1) == (greenFirst ? 1 : 0));
+				mosaic[yy][xx]	=	colorSite ? (redRow ? redValue : blueValue) : greenValue;
+			}
+		}
+		for (yy=1; yy<3; yy++)
+		{
+			redRow		=	((yy & 0x01) == 0) ? (pattern & 0x01) : !(pattern & 0x01);
+			greenFirst	=	((yy & 0x01) == 0) ? ((pattern >> 1) & 0x01) : !((pattern >> 1) & 0x01);
+			for (method=kDemosaic_Bilinear; method<=kDemosaic_EdgeAware; method++)
+			{
+				ImageKernel_DemosaicRow_U16(rgbOut, mosaic[yy - 1], mosaic[yy], mosaic[yy + 1], kTestMaxWidth, redRow, greenFirst, method);
+				for (xx=0; xx<kTestMaxWidth; xx++)
+				{
+					if ((rgbOut[(xx * 3) + 0] != blueValue) ||
+						(rgbOut[(xx * 3) + 1] != greenValue) ||
+						(rgbOut[(xx * 3) + 2] != redValue))
+					{
+						printf("Demosaic flat color: pattern=%d method=%d x=%d is %d,%d,%d\r\n",
+								pattern, method, xx, rgbOut[(xx * 3) + 2], rgbOut[(xx * 3) + 1], rgbOut[xx * 3]);
+						errorCnt++;
+						break;
+					}
+				}
+			}
+		}
+	}
+	printf("Demosaic flat color\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	pack then unpack has to give back the input, for every bit depth, shift and
+//*	pixel count, and the SIMD packing has to match the one group at a time version
+//*****************************************************************************
+#define	kTestMaxPackCnt	200
+
+static int	Test_PackBits(void)
+{
+uint16_t	srcBuf[kTestMaxPackCnt];
+uint16_t	unpackBuf[kTestMaxPackCnt];
+uint8_t		packBuf[kTestMaxPackCnt * 2];
+uint8_t		refBuf[kTestMaxPackCnt * 2];
+uint16_t	refOr;
+int			bitsPerPixel;
+int			shift;
+int			count;
+int			groupBytes;
+int			packLen;
+int			unpackLen;
+int			refLen;
+int			ii;
+int			errorCnt;
+
+	srand(2);
+	errorCnt	=	0;
+	for (bitsPerPixel=8; bitsPerPixel<=16; bitsPerPixel += 2)
+	{
+		groupBytes	=	bitsPerPixel / 2;
+		for (shift=0; shift<=(16 - bitsPerPixel); shift++)
+		{
+			for (count=1; count<=kTestMaxPackCnt; count++)
+			{
+				refOr	=	0;
+				for (ii=0; ii<count; ii++)
+				{
+					srcBuf[ii]	=	((rand() & ((1 << bitsPerPixel) - 1)) << shift) & 0x0ffff;
+					refOr		|=	srcBuf[ii];
+				}
+				refLen	=	0;
+				for (ii=0; ii<count; ii += 4)
+				{
+					PackGroup(refBuf + refLen, srcBuf + ii, (((count - ii) < 4) ? (count - ii) : 4), bitsPerPixel, shift);
+					refLen	+=	groupBytes;
+				}
+				memset(unpackBuf, 0, sizeof(unpackBuf));
+				packLen		=	ImageKernel_PackBits_U16(packBuf, srcBuf, count, bitsPerPixel, shift);
+				unpackLen	=	ImageKernel_UnpackBits_U16(unpackBuf, packBuf, count, bitsPerPixel, shift);
+				if ((packLen != refLen) || (memcmp(packBuf, refBuf, refLen) != 0))
+				{
+					printf("PackBits: bits=%d shift=%d count=%d does not match\r\n", bitsPerPixel, shift, count);
+					errorCnt++;
+				}
+				if ((unpackLen != refLen) || (memcmp(unpackBuf, srcBuf, (count * sizeof(uint16_t))) != 0))
+				{
+					printf("UnpackBits: bits=%d shift=%d count=%d does not give back the input\r\n", bitsPerPixel, shift, count);
+					errorCnt++;
+				}
+				if (ImageKernel_OrReduce_U16(srcBuf, count) != refOr)
+				{
+					printf("OrReduce: count=%d is wrong\r\n", count);
+					errorCnt++;
+				}
+			}
+		}
+	}
+	printf("Pack/unpack round trip\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+static double	GetSeconds(void)
+{
+struct timespec	timeNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &timeNow);
+	return(timeNow.tv_sec + (timeNow.tv_nsec / 1.0e9));
+}
+
+//*****************************************************************************
+//*	pack/unpack speed on a 6248x4176 frame, one core
+//*	the SIMD loops are used on SSE2/NEON builds, the scalar loop everywhere else
+//*****************************************************************************
+#define	kBenchWidth		6248
+#define	kBenchHeight	4176
+
+static int	Bench_PackBits(void)
+{
+uint16_t	*srcBuf;
+uint16_t	*unpackBuf;
+uint8_t		*packBuf;
+long		pixelCnt;
+long		ii;
+int			bitsPerPixel;
+int			passNum;
+int			packLen;
+uint16_t	orValue;
+uint16_t	refOr;
+double		startTime;
+double		packTime;
+double		unpackTime;
+double		orTime;
+double		frameMB;
+int			errorCnt;
+
+	errorCnt	=	0;
+	pixelCnt	=	(long)kBenchWidth * kBenchHeight;
+	frameMB		=	(pixelCnt * sizeof(uint16_t)) / 1.0e6;
+	srcBuf		=	(uint16_t *)malloc(pixelCnt * sizeof(uint16_t));
+	unpackBuf	=	(uint16_t *)malloc(pixelCnt * sizeof(uint16_t));
+	packBuf		=	(uint8_t *)malloc(pixelCnt * sizeof(uint16_t));
+	if ((srcBuf != NULL) && (unpackBuf != NULL) && (packBuf != NULL))
+	{
+		//*	touch the pages so the first pass does not time the page faults
+		memset(unpackBuf, 0, (pixelCnt * sizeof(uint16_t)));
+		memset(packBuf, 0, (pixelCnt * sizeof(uint16_t)));
+		for (bitsPerPixel=12; bitsPerPixel<=14; bitsPerPixel += 2)
+		{
+			refOr	=	0;
+			for (ii=0; ii<pixelCnt; ii++)
+			{
+				srcBuf[ii]	=	rand() & ((1 << bitsPerPixel) - 1);
+				refOr		|=	srcBuf[ii];
+			}
+			//*	best of 3 passes, the first one is slow while the CPU clocks up
+			orTime		=	1.0e9;
+			packTime	=	1.0e9;
+			unpackTime	=	1.0e9;
+			for (passNum=0; passNum<3; passNum++)
+			{
+				startTime	=	GetSeconds();
+				orValue		=	ImageKernel_OrReduce_U16(srcBuf, pixelCnt);
+				orTime		=	fmin(orTime, (GetSeconds() - startTime));
+
+				startTime	=	GetSeconds();
+				packLen		=	ImageKernel_PackBits_U16(packBuf, srcBuf, pixelCnt, bitsPerPixel, 0);
+				packTime	=	fmin(packTime, (GetSeconds() - startTime));
+
+				startTime	=	GetSeconds();
+				ImageKernel_UnpackBits_U16(unpackBuf, packBuf, pixelCnt, bitsPerPixel, 0);
+				unpackTime	=	fmin(unpackTime, (GetSeconds() - startTime));
+			}
+
+			if ((orValue != refOr) || (memcmp(srcBuf, unpackBuf, (pixelCnt * sizeof(uint16_t))) != 0))
+			{
+				printf("Pack benchmark: %d bit frame did not round trip\r\n", bitsPerPixel);
+				errorCnt++;
+			}
+			printf("%d bit %dx%d: pack %.0f MB/s, unpack %.0f MB/s, OR reduce %.0f MB/s, %.1f%% smaller\r\n",
+					bitsPerPixel, kBenchWidth, kBenchHeight,
+					(frameMB / packTime),
+					(frameMB / unpackTime),
+					(frameMB / orTime),
+					100.0 * (1.0 - (packLen / (pixelCnt * 2.0))));
+		}
+	}
+	else
+	{
+		printf("Pack benchmark: out of memory\r\n");
+		errorCnt++;
+	}
+	free(srcBuf);
+	free(unpackBuf);
+	free(packBuf);
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	straight forward binning, the reference for the tests and the benchmark
+//*****************************************************************************
+static void	RefBinRow(	void		*dstPtr,
+						const void	*srcPtr,
+						const int	bytesPerValue,
+						const int	srcRowValues,
+						const int	dstWidth,
+						const int	channels,
+						const int	binFactor,
+						const int	binMode)
+{
+int			xx;
+int			cc;
+int			bx;
+int			by;
+long		srcIdx;
+uint32_t	sum;
+uint32_t	blockCnt;
+uint32_t	maxValue;
+
+	blockCnt	=	binFactor * binFactor;
+	maxValue	=	(bytesPerValue == 2) ? 0xffff : 0x00ff;
+	for (xx=0; xx<dstWidth; xx++)
+	{
+		for (cc=0; cc<channels; cc++)
+		{
+			sum	=	0;
+			for (by=0; by<binFactor; by++)
+			{
+				for (bx=0; bx<binFactor; bx++)
+				{
+					srcIdx	=	((long)by * srcRowValues) + ((((long)xx * binFactor) + bx) * channels) + cc;
+					sum		+=	(bytesPerValue == 2) ? ((const uint16_t *)srcPtr)[srcIdx] : ((const uint8_t *)srcPtr)[srcIdx];
+				}
+			}
+			if (binMode == kBinMode_Average)
+			{
+				sum	=	(sum + (blockCnt / 2)) / blockCnt;
+			}
+			else if (sum > maxValue)
+			{
+				sum	=	maxValue;
+			}
+			if (bytesPerValue == 2)
+			{
+				((uint16_t *)dstPtr)[(xx * channels) + cc]	=	sum;
+			}
+			else
+			{
+				((uint8_t *)dstPtr)[(xx * channels) + cc]	=	sum;
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//*	every type, factor and mode against the reference, the widths cross the
+//*	SIMD steps and the 256 pixel chunks
+//*****************************************************************************
+static int	Test_BinRow(void)
+{
+const int	widthList[]	=	{1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 255, 256, 257, 600, 0};
+uint8_t		*srcBuf;
+uint8_t		*binBuf;
+uint8_t		*refBuf;
+int			srcRowValues;
+int			dstWidth;
+int			widthIdx;
+int			bytesPerValue;
+int			channels;
+int			binFactor;
+int			binMode;
+long		srcBytes;
+long		dstBytes;
+long		ii;
+int			errorCnt;
+
+	srand(3);
+	errorCnt	=	0;
+	//*	big enough for 4 rows of 600 * 4 pixels, 3 channels, 2 bytes
+	srcBytes	=	4L * 600 * 4 * 3 * 2;
+	srcBuf		=	(uint8_t *)malloc(srcBytes);
+	binBuf		=	(uint8_t *)malloc(600 * 3 * 2);
+	refBuf		=	(uint8_t *)malloc(600 * 3 * 2);
+	if ((srcBuf == NULL) || (binBuf == NULL) || (refBuf == NULL))
+	{
+		printf("BinRow: out of memory\r\n");
+		free(srcBuf);
+		free(binBuf);
+		free(refBuf);
+		return(1);
+	}
+	for (ii=0; ii<srcBytes; ii++)
+	{
+		srcBuf[ii]	=	rand() & 0x00ff;
+	}
+	for (widthIdx=0; widthList[widthIdx] > 0; widthIdx++)
+	{
+		dstWidth	=	widthList[widthIdx];
+		for (bytesPerValue=1; bytesPerValue<=2; bytesPerValue++)
+		{
+			for (channels=1; channels<=3; channels += 2)
+			{
+				for (binFactor=1; binFactor<=kBinMaxFactor; binFactor++)
+				{
+					srcRowValues	=	dstWidth * binFactor * channels;
+					dstBytes		=	(long)dstWidth * channels * bytesPerValue;
+					for (binMode=kBinMode_Sum; binMode<=kBinMode_Average; binMode++)
+					{
+						memset(binBuf, 0, dstBytes);
+						if (bytesPerValue == 2)
+						{
+							ImageKernel_BinRow_U16((uint16_t *)binBuf, (const uint16_t *)srcBuf, srcRowValues, dstWidth, channels, binFactor, binMode);
+						}
+						else
+						{
+							ImageKernel_BinRow_U8(binBuf, srcBuf, srcRowValues, dstWidth, channels, binFactor, binMode);
+						}
+						RefBinRow(refBuf, srcBuf, bytesPerValue, srcRowValues, dstWidth, channels, binFactor, binMode);
+						if (memcmp(binBuf, refBuf, dstBytes) != 0)
+						{
+							printf("BinRow: U%d width=%d channels=%d bin=%d mode=%d does not match\r\n",
+									(bytesPerValue * 8), dstWidth, channels, binFactor, binMode);
+							errorCnt++;
+						}
+					}
+				}
+			}
+		}
+	}
+	free(srcBuf);
+	free(binBuf);
+	free(refBuf);
+	printf("Binning\t\t\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	ROI extraction in place, the ROI is moved to the top of the same buffer
+//*****************************************************************************
+static int	Test_CropRows(void)
+{
+uint16_t	frameBuf[64 * 48];
+uint16_t	expected[20 * 30];
+const int	frameWidth	=	64;
+const int	frameHeight	=	48;
+const int	startX		=	5;
+const int	startY		=	7;
+const int	roiWidth	=	20;
+const int	roiHeight	=	30;
+int			xx;
+int			yy;
+int			errorCnt;
+
+	for (yy=0; yy<frameHeight; yy++)
+	{
+		for (xx=0; xx<frameWidth; xx++)
+		{
+			frameBuf[(yy * frameWidth) + xx]	=	(yy * 1000) + xx;
+		}
+	}
+	for (yy=0; yy<roiHeight; yy++)
+	{
+		for (xx=0; xx<roiWidth; xx++)
+		{
+			expected[(yy * roiWidth) + xx]	=	((yy + startY) * 1000) + (xx + startX);
+		}
+	}
+	ImageKernel_CropRows(	frameBuf,
+							frameBuf + (startY * frameWidth) + startX,
+							(frameWidth * sizeof(uint16_t)),
+							(roiWidth * sizeof(uint16_t)),
+							roiHeight);
+	errorCnt	=	(memcmp(frameBuf, expected, sizeof(expected)) == 0) ? 0 : 1;
+	printf("ROI crop in place\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+//*	binning speed on a 6000x4000 frame, one thread, the reference C loop in brackets
+//*****************************************************************************
+static void	Bench_BinOne(	const char		*title,
+							uint8_t			*dstPtr,
+							const uint8_t	*srcPtr,
+							const int		bytesPerValue,
+							const int		channels,
+							const int		binFactor,
+							const int		binMode)
+{
+int		dstWidth;
+int		dstHeight;
+int		srcRowValues;
+int		yy;
+int		passNum;
+int		useRef;
+long	srcRowBytes;
+long	dstRowBytes;
+double	startTime;
+double	bestTime[2];
+
+	dstWidth		=	6000 / binFactor;
+	dstHeight		=	4000 / binFactor;
+	srcRowValues	=	6000 * channels;
+	srcRowBytes		=	(long)srcRowValues * bytesPerValue;
+	dstRowBytes		=	(long)dstWidth * channels * bytesPerValue;
+	for (useRef=0; useRef<2; useRef++)
+	{
+		bestTime[useRef]	=	1.0e9;
+		for (passNum=0; passNum<3; passNum++)
+		{
+			startTime	=	GetSeconds();
+			for (yy=0; yy<dstHeight; yy++)
+			{
+				if (useRef)
+				{
+					RefBinRow(	dstPtr + (yy * dstRowBytes),
+								srcPtr + (yy * binFactor * srcRowBytes),
+								bytesPerValue, srcRowValues, dstWidth, channels, binFactor, binMode);
+				}
+				else if (bytesPerValue == 2)
+				{
+					ImageKernel_BinRow_U16(	(uint16_t *)(dstPtr + (yy * dstRowBytes)),
+											(const uint16_t *)(srcPtr + (yy * binFactor * srcRowBytes)),
+											srcRowValues, dstWidth, channels, binFactor, binMode);
+				}
+				else
+				{
+					ImageKernel_BinRow_U8(	dstPtr + (yy * dstRowBytes),
+											srcPtr + (yy * binFactor * srcRowBytes),
+											srcRowValues, dstWidth, channels, binFactor, binMode);
+				}
+			}
+			bestTime[useRef]	=	fmin(bestTime[useRef], (GetSeconds() - startTime));
+		}
+	}
+	printf("%-20s %6.1f ms (%.1f ms)\r\n", title, (bestTime[0] * 1000.0), (bestTime[1] * 1000.0));
+}
+
+//*****************************************************************************
+static int	Bench_BinRow(void)
+{
+uint8_t		*srcBuf;
+uint8_t		*dstBuf;
+long		frameBytes;
+long		ii;
+int			errorCnt;
+
+	errorCnt	=	0;
+	frameBytes	=	6000L * 4000 * 3;		//*	big enough for RGB24 and RAW16
+	srcBuf		=	(uint8_t *)malloc(frameBytes);
+	dstBuf		=	(uint8_t *)malloc(frameBytes);
+	if ((srcBuf != NULL) && (dstBuf != NULL))
+	{
+		for (ii=0; ii<frameBytes; ii++)
+		{
+			srcBuf[ii]	=	rand() & 0x00ff;
+		}
+		memset(dstBuf, 0, frameBytes);
+		Bench_BinOne("RAW16 2x2 average",	dstBuf, srcBuf, 2, 1, 2, kBinMode_Average);
+		Bench_BinOne("RAW16 3x3 average",	dstBuf, srcBuf, 2, 1, 3, kBinMode_Average);
+		Bench_BinOne("RAW16 4x4 average",	dstBuf, srcBuf, 2, 1, 4, kBinMode_Average);
+		Bench_BinOne("RAW8 2x2 average",	dstBuf, srcBuf, 1, 1, 2, kBinMode_Average);
+		Bench_BinOne("RAW8 4x4 average",	dstBuf, srcBuf, 1, 1, 4, kBinMode_Average);
+		Bench_BinOne("RGB24 2x2 average",	dstBuf, srcBuf, 1, 3, 2, kBinMode_Average);
+	}
+	else
+	{
+		printf("Binning benchmark: out of memory\r\n");
+		errorCnt++;
+	}
+	free(srcBuf);
+	free(dstBuf);
+	return(errorCnt);
+}
+
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+//*****************************************************************************
+//*	deflate then inflate has to give back the input byte for byte
+//*****************************************************************************
+static int	Test_Deflate(void)
+{
+const long	lengthList[]	=	{1, 2, 3, 7, 100, 1001, 65536, 0};
+uint8_t		*srcBuf;
+uint8_t		*packBuf;
+uint8_t		*dstBuf;
+long		valueCnt;
+long		srcLen;
+long		packSize;
+long		packLen;
+long		dstLen;
+long		ii;
+int			lengthIdx;
+int			elementBytes;
+int			stride;
+int			errorCnt;
+
+	srand(4);
+	errorCnt	=	0;
+	srcBuf		=	(uint8_t *)malloc(65536 * 4);
+	dstBuf		=	(uint8_t *)malloc(65536 * 4);
+	packSize	=	ImageKernel_DeflateBound(65536 * 4);
+	packBuf		=	(uint8_t *)malloc(packSize);
+	if ((srcBuf == NULL) || (dstBuf == NULL) || (packBuf == NULL))
+	{
+		printf("Deflate: out of memory\r\n");
+		free(srcBuf);
+		free(dstBuf);
+		free(packBuf);
+		return(1);
+	}
+	for (elementBytes=1; elementBytes<=4; elementBytes *= 2)
+	{
+		for (stride=1; stride<=3; stride++)
+		{
+			for (lengthIdx=0; lengthList[lengthIdx] > 0; lengthIdx++)
+			{
+				valueCnt	=	lengthList[lengthIdx];
+				srcLen		=	valueCnt * elementBytes;
+				//*	small steps in both directions, with the odd full range value
+				for (ii=0; ii<srcLen; ii++)
+				{
+					srcBuf[ii]	=	((ii % elementBytes) == 0) ? ((ii / elementBytes) + (rand() % 7)) : ((rand() % 50) == 0) ? rand() : 0;
+				}
+				packLen	=	ImageKernel_DeflateElements(packBuf, packSize, srcBuf, srcLen, elementBytes, stride);
+				memset(dstBuf, 0, srcLen);
+				dstLen	=	ImageKernel_InflateElements(dstBuf, srcLen, packBuf, packLen, elementBytes, stride);
+				if ((packLen <= 0) || (dstLen != srcLen) || (memcmp(srcBuf, dstBuf, srcLen) != 0))
+				{
+					printf("Deflate: %d byte elements, stride=%d, count=%ld does not round trip\r\n", elementBytes, stride, valueCnt);
+					errorCnt++;
+				}
+			}
+		}
+	}
+	//*	damaged data has to be rejected, not decoded into the buffer
+	packLen	=	ImageKernel_DeflateElements(packBuf, packSize, srcBuf, 1000, 2, 2);
+	if (packLen > 10)
+	{
+		packBuf[packLen / 2]	^=	0x55;
+		if (ImageKernel_InflateElements(dstBuf, 1000, packBuf, packLen, 2, 2) >= 0)
+		{
+			printf("Inflate: damaged data was accepted\r\n");
+			errorCnt++;
+		}
+	}
+	free(srcBuf);
+	free(dstBuf);
+	free(packBuf);
+	printf("Deflate round trip\t\t%s\r\n", ((errorCnt == 0) ? "OK" : "FAILED"));
+	return(errorCnt);
+}
+
+//*****************************************************************************
+static double	GaussNoise(void)
+{
+double	uu;
+double	vv;
+
+	uu	=	(rand() + 1.0) / (RAND_MAX + 2.0);
+	vv	=	(rand() + 1.0) / (RAND_MAX + 2.0);
+	return(sqrt(-2.0 * log(uu)) * cos(2.0 * M_PI * vv));
+}
+
+//*****************************************************************************
+//*	synthetic 6248x4176 RAW16 sky, background, gaussian noise and 3000 stars,
+//*	the data is shifted left to look like a 12 or 14 bit sensor,
+//*	noiseSigma is in ADU after the shift
+//*****************************************************************************
+static void	MakeSkyFrame(uint16_t *framePtr, const int width, const int height, const int dataShift, const double noiseSigma)
+{
+long	ii;
+int		starNum;
+int		starX;
+int		starY;
+int		xx;
+int		yy;
+double	peakValue;
+double	pixValue;
+int		maxValue;
+
+	maxValue	=	0x0ffff >> dataShift;
+	for (ii=0; ii<((long)width * height); ii++)
+	{
+		pixValue		=	(800 >> dataShift) + (GaussNoise() * noiseSigma / (1 << dataShift));
+		framePtr[ii]	=	(pixValue < 0) ? 0 : (pixValue > maxValue) ? maxValue : (int)pixValue;
+	}
+	for (starNum=0; starNum<3000; starNum++)
+	{
+		starX		=	8 + (rand() % (width - 16));
+		starY		=	8 + (rand() % (height - 16));
+		peakValue	=	(rand() % maxValue) / 2;
+		for (yy=-6; yy<=6; yy++)
+		{
+			for (xx=-6; xx<=6; xx++)
+			{
+				ii			=	((long)(starY + yy) * width) + starX + xx;
+				pixValue	=	framePtr[ii] + (peakValue * exp(-((xx * xx) + (yy * yy)) / 4.5));
+				framePtr[ii]	=	(pixValue > maxValue) ? maxValue : (int)pixValue;
+			}
+		}
+	}
+	for (ii=0; ii<((long)width * height); ii++)
+	{
+		framePtr[ii]	<<=	dataShift;
+	}
+}
+
+//*****************************************************************************
+//*	one band, one core. The driver splits the frame into up to 32 bands
+//*****************************************************************************
+static int	Bench_Deflate(void)
+{
+const int	width		=	6248;
+const int	height		=	4176;
+uint16_t	*frameBuf;
+uint16_t	*checkBuf;
+uint8_t		*packBuf;
+long		frameBytes;
+long		packSize;
+long		packLen;
+int			testNum;
+int			dataShift;
+double		noiseSigma;
+double		startTime;
+double		deflateTime;
+double		inflateTime;
+int			errorCnt;
+
+	errorCnt	=	0;
+	frameBytes	=	(long)width * height * sizeof(uint16_t);
+	packSize	=	ImageKernel_DeflateBound(frameBytes);
+	frameBuf	=	(uint16_t *)malloc(frameBytes);
+	checkBuf	=	(uint16_t *)malloc(frameBytes);
+	packBuf		=	(uint8_t *)malloc(packSize);
+	if ((frameBuf != NULL) && (checkBuf != NULL) && (packBuf != NULL))
+	{
+		for (testNum=0; testNum<3; testNum++)
+		{
+			dataShift	=	(testNum == 0) ? 0 : (testNum == 1) ? 2 : 4;
+			noiseSigma	=	(testNum == 2) ? 20.0 : 12.0;
+			MakeSkyFrame(frameBuf, width, height, dataShift, noiseSigma);
+
+			startTime	=	GetSeconds();
+			packLen		=	ImageKernel_DeflateElements(packBuf, packSize, (uint8_t *)frameBuf, frameBytes, 2, 2);
+			deflateTime	=	GetSeconds() - startTime;
+
+			startTime	=	GetSeconds();
+			if ((ImageKernel_InflateElements((uint8_t *)checkBuf, frameBytes, packBuf, packLen, 2, 2) != frameBytes) ||
+				(memcmp(frameBuf, checkBuf, frameBytes) != 0))
+			{
+				printf("Deflate benchmark: frame did not round trip\r\n");
+				errorCnt++;
+			}
+			inflateTime	=	GetSeconds() - startTime;
+			printf("%d bit << %d, sigma %2.0f: %.1f MB -> %.1f MB (%.2fx), deflate %.0f ms, inflate %.0f ms\r\n",
+					(16 - dataShift), dataShift, noiseSigma,
+					(frameBytes / 1.0e6),
+					(packLen / 1.0e6),
+					((double)frameBytes / packLen),
+					(deflateTime * 1000.0),
+					(inflateTime * 1000.0));
+		}
+	}
+	else
+	{
+		printf("Deflate benchmark: out of memory\r\n");
+		errorCnt++;
+	}
+	free(frameBuf);
+	free(checkBuf);
+	free(packBuf);
+	return(errorCnt);
+}
+#endif	//	_ENABLE_IMAGEBYTES_DEFLATE_
+
+//*****************************************************************************
+int	main(void)
+{
+int		errorCnt;
+
+	errorCnt	=	0;
+	errorCnt	+=	Test_StackRAW16();
+	errorCnt	+=	Test_SigmaClip();
+	errorCnt	+=	Test_DemosaicSIMD();
+	errorCnt	+=	Test_DemosaicFlatColor();
+	errorCnt	+=	Test_PackBits();
+	errorCnt	+=	Bench_PackBits();
+	errorCnt	+=	Test_BinRow();
+	errorCnt	+=	Test_CropRows();
+	errorCnt	+=	Bench_BinRow();
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+	errorCnt	+=	Test_Deflate();
+	errorCnt	+=	Bench_Deflate();
+#endif
+
+	printf("%d errors\r\n", errorCnt);
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_IMAGE_KERNELS_MAIN_
@@ -0,0 +1,271 @@
+//*****************************************************************************
+//#include	"image_kernels.h"
+
+#ifndef _IMAGE_KERNELS_H_
+#define	_IMAGE_KERNELS_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#define	kImageKernel_MaxThreads	8
+
+//*****************************************************************************
+//*	row band processing, the image is split into horizontal bands
+//*	and each band is handed to a separate thread
+//*	firstRow is inclusive, lastRow is exclusive
+typedef void (*ImageKernel_BandProc)(void *context, int firstRow, int lastRow);
+
+int		ImageKernel_GetThreadCount(void);
+void	ImageKernel_RunRowBands(int numRows, ImageKernel_BandProc bandProc, void *context);
+
+//*****************************************************************************
+//*	stacking accumulators
+//*	the sums are double so long RAW16 stacks stay exact
+//*	if sumSqPtr is NULL, this is a simple running sum
+//*	if clipSigmaSqrd > 0, pixels further than sigma from the running mean are replaced by the mean
+void	ImageKernel_StackAdd_U8(	double			*sumPtr,
+									double			*sumSqPtr,
+									const uint8_t	*srcPtr,
+									const int		count,
+									const double	invFrameCnt,
+									const double	clipSigmaSqrd);
+
+void	ImageKernel_StackAdd_U16(	double			*sumPtr,
+									double			*sumSqPtr,
+									const uint16_t	*srcPtr,
+									const int		count,
+									const double	invFrameCnt,
+									const double	clipSigmaSqrd);
+
+void	ImageKernel_StackAddMean(	double			*sumPtr,
+									double			*sumSqPtr,
+									const int		count,
+									const double	invFrameCnt);
+
+void	ImageKernel_ScaleToU8(		uint8_t			*dstPtr,
+									const double	*srcPtr,
+									const int		count,
+									const double	scaleFactor);
+
+void	ImageKernel_ScaleToU16(		uint16_t		*dstPtr,
+									const double	*srcPtr,
+									const int		count,
+									const double	scaleFactor);
+
+//*****************************************************************************
+//*	calibration, pixel = ((pixel - (bias * biasScale) - (dark * darkScale)) * flatGain)
+//*	any of the master pointers can be NULL
+void	ImageKernel_Calibrate_U8(	uint8_t			*pixelPtr,
+									const float		*biasPtr,
+									const float		*darkPtr,
+									const float		*flatGainPtr,
+									const int		count,
+									const float		biasScale,
+									const float		darkScale);
+
+void	ImageKernel_Calibrate_U16(	uint16_t		*pixelPtr,
+									const float		*biasPtr,
+									const float		*darkPtr,
+									const float		*flatGainPtr,
+									const int		count,
+									const float		biasScale,
+									const float		darkScale);
+
+//*****************************************************************************
+//*	returns the index of the first value > threshold, count if none
+int		ImageKernel_ScanAbove_U8(	const uint8_t	*srcPtr,
+									const int		count,
+									const uint8_t	threshold);
+
+int		ImageKernel_ScanAbove_U16(	const uint16_t	*srcPtr,
+									const int		count,
+									const uint16_t	threshold);
+
+//*****************************************************************************
+//*	Bayer demosaic of one row, the output is BGR
+//*	prevRow and nextRow are the rows above and below, at the top and bottom of the
+//*	image the rows are mirrored (row 1 is used for row -1) so the pattern is kept
+//*	redRow is true if this row has red pixels, greenFirst if pixel 0 is green
+enum
+{
+	kDemosaic_Bilinear	=	0,
+	kDemosaic_EdgeAware			//*	green is interpolated along edges, not across them
+};
+
+void	ImageKernel_DemosaicRow_U8(		uint8_t			*dstPtr,
+										const uint8_t	*prevRow,
+										const uint8_t	*curRow,
+										const uint8_t	*nextRow,
+										const int		width,
+										const int		redRow,
+										const int		greenFirst,
+										const int		method);
+
+void	ImageKernel_DemosaicRow_U16(	uint16_t		*dstPtr,
+										const uint16_t	*prevRow,
+										const uint16_t	*curRow,
+										const uint16_t	*nextRow,
+										const int		width,
+										const int		redRow,
+										const int		greenFirst,
+										const int		method);
+
+void	ImageKernel_DemosaicRow_U16toU8(uint8_t			*dstPtr,
+										const uint16_t	*prevRow,
+										const uint16_t	*curRow,
+										const uint16_t	*nextRow,
+										const int		width,
+										const int		redRow,
+										const int		greenFirst,
+										const int		method);
+
+//*****************************************************************************
+//*	alpha blending of a premultiplied layer that is already in the frame layout
+//*	dst = color + (dst * (1 - alpha)), invAlpha is (1 - alpha) at full scale
+void	ImageKernel_BlendPremult_U8(	uint8_t			*dstPtr,
+										const uint8_t	*colorPtr,
+										const uint8_t	*invAlphaPtr,
+										const int		count);
+
+void	ImageKernel_BlendPremult_U16(	uint16_t		*dstPtr,
+										const uint16_t	*colorPtr,
+										const uint16_t	*invAlphaPtr,
+										const int		count);
+
+//*****************************************************************************
+//*	2x2 box filter for the display pyramid, one output row from two input rows
+//*	dstWidth is in pixels, channels is 1 or 3 (interleaved), the averages are rounded
+void	ImageKernel_Downsample2xRow_U8(	uint8_t			*dstPtr,
+										const uint8_t	*row0,
+										const uint8_t	*row1,
+										const int		dstWidth,
+										const int		channels);
+
+void	ImageKernel_Downsample2xRow_U16(uint16_t		*dstPtr,
+										const uint16_t	*row0,
+										const uint16_t	*row1,
+										const int		dstWidth,
+										const int		channels);
+
+//*****************************************************************************
+//*	bit packing of 16 bit data to the real bit depth of the sensor,
+//*	see image_kernels.c for the layout
+uint16_t	ImageKernel_OrReduce_U16(	const uint16_t	*srcPtr,
+										const int		count);
+
+int			ImageKernel_PackBits_U16(	uint8_t			*dstPtr,
+										const uint16_t	*srcPtr,
+										const int		count,
+										const int		bitsPerPixel,
+										const int		shift);
+
+int			ImageKernel_UnpackBits_U16(	uint16_t		*dstPtr,
+										const uint8_t	*srcPtr,
+										const int		count,
+										const int		bitsPerPixel,
+										const int		shift);
+
+//*****************************************************************************
+//*	software binning of one output row, binFactor x binFactor blocks become one pixel.
+//*	srcPtr is the first value of the first block, srcRowValues is the source row
+//*	length in values (width * channels), dstWidth is in output pixels.
+//*	binFactor is 1 to 4, channels is 1 or 3 (interleaved).
+//*	Sums saturate at full scale, averages are rounded
+enum
+{
+	kBinMode_Sum	=	0,
+	kBinMode_Average
+};
+
+void	ImageKernel_BinRow_U8(	uint8_t			*dstPtr,
+								const uint8_t	*srcPtr,
+								const int		srcRowValues,
+								const int		dstWidth,
+								const int		channels,
+								const int		binFactor,
+								const int		binMode);
+
+void	ImageKernel_BinRow_U16(	uint16_t		*dstPtr,
+								const uint16_t	*srcPtr,
+								const int		srcRowValues,
+								const int		dstWidth,
+								const int		channels,
+								const int		binFactor,
+								const int		binMode);
+
+//*	ROI extraction, dstPtr can be the same buffer as srcPtr as long as it is not after it
+void	ImageKernel_CropRows(	void			*dstPtr,
+								const void		*srcPtr,
+								const long		srcRowBytes,
+								const long		dstRowBytes,
+								const int		rowCnt);
+
+//*****************************************************************************
+//*	histograms, the counts are added to what is already in histogram[]
+//*	(256 entries for U8, 65536 for U16)
+void	ImageKernel_Histogram_U8(	uint32_t		*histogram,
+									const uint8_t	*srcPtr,
+									const long		count);
+
+void	ImageKernel_Histogram_U16(	uint32_t		*histogram,
+									const uint16_t	*srcPtr,
+									const long		count);
+
+//*	histogram[] is red[256], green[256], blue[256]
+void	ImageKernel_Histogram_BGR(	uint32_t		*histogram,
+									const uint8_t	*srcPtr,
+									const long		pixelCnt);
+
+//*	8 bit display lookup, lutPtr has 256 or 65536 entries.
+//*	3 channel input is BGR (camera order), the output is RGB
+void	ImageKernel_LUT_U8(			uint8_t			*dstPtr,
+									const uint8_t	*srcPtr,
+									const int		pixelCnt,
+									const int		channels,
+									const uint8_t	*lutPtr);
+
+void	ImageKernel_LUT_U16toU8(	uint8_t			*dstPtr,
+									const uint16_t	*srcPtr,
+									const int		pixelCnt,
+									const int		channels,
+									const uint8_t	*lutPtr);
+
+//*****************************************************************************
+//*	lossless compression of imagebytes data (AlpacaPi extension, see alpaca_defs.h).
+//*	Each value is replaced by the difference to the value stride elements back
+//*	(same Bayer color or RGB plane), zigzag coded so small differences of either
+//*	sign have zero high bytes, split into byte planes and deflated.
+//*	elementBytes is 1, 2 or 4, little endian.  Needs zlib (-lz)
+#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+long	ImageKernel_DeflateBound(	const long		srcLen);
+
+//*	returns the compressed length, 0 if it failed
+long	ImageKernel_DeflateElements(uint8_t			*dstPtr,
+									const long		dstSize,
+									const uint8_t	*srcPtr,
+									const long		srcLen,
+									const int		elementBytes,
+									const int		stride);
+
+//*	returns the number of bytes written to dstPtr, -1 if the data is bad
+long	ImageKernel_InflateElements(uint8_t			*dstPtr,
+									const long		dstLen,
+									const uint8_t	*srcPtr,
+									const long		srcLen,
+									const int		elementBytes,
+									const int		stride);
+#endif	//	_ENABLE_IMAGEBYTES_DEFLATE_
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _IMAGE_KERNELS_H_
@@ -0,0 +1,271 @@
+//*****************************************************************************
+//*	Name:			image_meta_index.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Append only index of the images saved in a directory
+//*
+//*					The camera driver appends one fixed size record as each image
+//*					is saved (name, time, exposure, gain, filter, object, RA/Dec,
+//*					HFR and pixel statistics). Browsing the directory is then one
+//*					read of the index instead of opening every FITS file.
+//*					The file starts with a header with the record size, an index
+//*					written with a different record layout is moved out of the way.
+//*					A partial record at the end (power failure while writing) is ignored.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created image_meta_index.c
+//*	Oct 19,	2026	<MLS> Skip the .old rename if the name does not fit
+//*****************************************************************************
+
+#ifndef _GNU_SOURCE
+	#define	_GNU_SOURCE		//*	strcasestr()
+#endif
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<strings.h>
+#include	<unistd.h>
+#include	<fcntl.h>
+#include	<sys/stat.h>
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"image_meta_index.h"
+
+//*****************************************************************************
+static void	BuildIndexPath(const char *dirPath, const char *fileName, char *indexPath, const int maxLen)
+{
+int		dirLen;
+
+	dirLen	=	strlen(dirPath);
+	if ((dirLen > 0) && (dirPath[dirLen - 1] == '/'))
+	{
+		snprintf(indexPath, maxLen, "%s%s", dirPath, fileName);
+	}
+	else
+	{
+		snprintf(indexPath, maxLen, "%s/%s", dirPath, fileName);
+	}
+}
+
+//*****************************************************************************
+static bool	HeaderIsValid(const TYPE_IMAGE_META_HEADER *indexHeader)
+{
+	return((indexHeader->magic == kImageMetaIndex_Magic) &&
+			(indexHeader->version == kImageMetaIndex_Version) &&
+			(indexHeader->recordSize == sizeof(TYPE_IMAGE_META)));
+}
+
+//*****************************************************************************
+static void	SetupHeader(TYPE_IMAGE_META_HEADER *indexHeader)
+{
+	memset(indexHeader, 0, sizeof(TYPE_IMAGE_META_HEADER));
+	indexHeader->magic		=	kImageMetaIndex_Magic;
+	indexHeader->version	=	kImageMetaIndex_Version;
+	indexHeader->recordSize	=	sizeof(TYPE_IMAGE_META);
+}
+
+//*****************************************************************************
+static int	OpenForAppend(const char *indexPath)
+{
+int						indexFD;
+struct stat				fileStatus;
+TYPE_IMAGE_META_HEADER	indexHeader;
+char					oldPath[512];
+bool					headerOK;
+
+	indexFD	=	open(indexPath, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (indexFD < 0)
+	{
+		CONSOLE_DEBUG_W_STR("Failed to open", indexPath);
+		return(-1);
+	}
+	fstat(indexFD, &fileStatus);
+	if (fileStatus.st_size > 0)
+	{
+		headerOK	=	false;
+		if (pread(indexFD, &indexHeader, sizeof(TYPE_IMAGE_META_HEADER), 0) == sizeof(TYPE_IMAGE_META_HEADER))
+		{
+			headerOK	=	HeaderIsValid(&indexHeader);
+		}
+		if (headerOK)
+		{
+			return(indexFD);
+		}
+		//*	written by a different version, keep it but start a new one
+		CONSOLE_DEBUG_W_STR("Index has a different format, starting a new one", indexPath);
+		close(indexFD);
+		if (snprintf(oldPath, sizeof(oldPath), "%s.old", indexPath) < (int)sizeof(oldPath))
+		{
+			rename(indexPath, oldPath);
+		}
+		//*	if the name was too long to rename, the old index is discarded
+		indexFD	=	open(indexPath, O_RDWR | O_CREAT | O_APPEND | O_TRUNC, 0644);
+		if (indexFD < 0)
+		{
+			return(-1);
+		}
+	}
+	SetupHeader(&indexHeader);
+	if (write(indexFD, &indexHeader, sizeof(TYPE_IMAGE_META_HEADER)) != sizeof(TYPE_IMAGE_META_HEADER))
+	{
+		close(indexFD);
+		indexFD	=	-1;
+	}
+	return(indexFD);
+}
+
+//*****************************************************************************
+bool	ImageMetaIndex_Append(const char *dirPath, const TYPE_IMAGE_META *imageMeta)
+{
+char	indexPath[512];
+int		indexFD;
+bool	successFlag;
+
+	successFlag	=	false;
+	BuildIndexPath(dirPath, kImageMetaIndex_FileName, indexPath, sizeof(indexPath));
+	indexFD	=	OpenForAppend(indexPath);
+	if (indexFD >= 0)
+	{
+		//*	one write() of the whole record with O_APPEND
+		if (write(indexFD, imageMeta, sizeof(TYPE_IMAGE_META)) == sizeof(TYPE_IMAGE_META))
+		{
+			successFlag	=	true;
+		}
+		else
+		{
+			CONSOLE_DEBUG_W_STR("Failed to write", indexPath);
+		}
+		close(indexFD);
+	}
+	return(successFlag);
+}
+
+//*****************************************************************************
+TYPE_IMAGE_META	*ImageMetaIndex_Load(const char *dirPath, int *recordCnt)
+{
+char					indexPath[512];
+int						indexFD;
+struct stat				fileStatus;
+TYPE_IMAGE_META_HEADER	indexHeader;
+TYPE_IMAGE_META			*metaList;
+int						metaCnt;
+size_t					bytesWanted;
+size_t					bytesRead;
+ssize_t					readCnt;
+int						iii;
+
+	*recordCnt	=	0;
+	metaList	=	NULL;
+	BuildIndexPath(dirPath, kImageMetaIndex_FileName, indexPath, sizeof(indexPath));
+	indexFD	=	open(indexPath, O_RDONLY);
+	if (indexFD < 0)
+	{
+		return(NULL);
+	}
+	fstat(indexFD, &fileStatus);
+	if ((read(indexFD, &indexHeader, sizeof(TYPE_IMAGE_META_HEADER)) == sizeof(TYPE_IMAGE_META_HEADER)) &&
+		HeaderIsValid(&indexHeader))
+	{
+		metaCnt		=	(fileStatus.st_size - sizeof(TYPE_IMAGE_META_HEADER)) / sizeof(TYPE_IMAGE_META);
+		metaList	=	(TYPE_IMAGE_META *)malloc((metaCnt + 1) * sizeof(TYPE_IMAGE_META));
+		if (metaList != NULL)
+		{
+			bytesWanted	=	metaCnt * sizeof(TYPE_IMAGE_META);
+			bytesRead	=	0;
+			while (bytesRead < bytesWanted)
+			{
+				readCnt	=	read(indexFD, ((char *)metaList) + bytesRead, bytesWanted - bytesRead);
+				if (readCnt <= 0)
+				{
+					break;
+				}
+				bytesRead	+=	readCnt;
+			}
+			metaCnt	=	bytesRead / sizeof(TYPE_IMAGE_META);
+			for (iii=0; iii<metaCnt; iii++)
+			{
+				metaList[iii].fileName[sizeof(metaList[iii].fileName) - 1]	=	0;
+				metaList[iii].filter[sizeof(metaList[iii].filter) - 1]		=	0;
+				metaList[iii].object[sizeof(metaList[iii].object) - 1]		=	0;
+			}
+			*recordCnt	=	metaCnt;
+		}
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Not a valid index", indexPath);
+	}
+	close(indexFD);
+	return(metaList);
+}
+
+//*****************************************************************************
+void	ImageMetaIndex_InitQuery(TYPE_IMAGE_META_QUERY *query)
+{
+	memset(query, 0, sizeof(TYPE_IMAGE_META_QUERY));
+}
+
+//*****************************************************************************
+static bool	StringIsSet(const char *theString)
+{
+	return((theString != NULL) && (theString[0] != 0));
+}
+
+//*****************************************************************************
+bool	ImageMetaIndex_Match(const TYPE_IMAGE_META *imageMeta, const TYPE_IMAGE_META_QUERY *query)
+{
+	//*	the numbers first, they are the cheapest
+	if ((query->minExposure_secs > 0.0) && (imageMeta->exposure_secs < query->minExposure_secs))
+	{
+		return(false);
+	}
+	if ((query->maxExposure_secs > 0.0) && (imageMeta->exposure_secs > query->maxExposure_secs))
+	{
+		return(false);
+	}
+	if ((query->maxHFR > 0.0) && ((imageMeta->hfr <= 0.0) || (imageMeta->hfr > query->maxHFR)))
+	{
+		return(false);
+	}
+	if ((query->since_secs > 0.0) && (imageMeta->time_secs < query->since_secs))
+	{
+		return(false);
+	}
+	if ((query->until_secs > 0.0) && (imageMeta->time_secs > query->until_secs))
+	{
+		return(false);
+	}
+	if (StringIsSet(query->filter) && (strcasecmp(imageMeta->filter, query->filter) != 0))
+	{
+		return(false);
+	}
+	if (StringIsSet(query->object) && (strcasestr(imageMeta->object, query->object) == NULL))
+	{
+		return(false);
+	}
+	if (StringIsSet(query->fileName) && (strstr(imageMeta->fileName, query->fileName) == NULL))
+	{
+		return(false);
+	}
+	return(true);
+}
@@ -0,0 +1,85 @@
+//*****************************************************************************
+//#include	"image_meta_index.h"
+
+#ifndef _IMAGE_META_INDEX_H_
+#define	_IMAGE_META_INDEX_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#define	kImageMetaIndex_FileName	"imageindex.dat"
+#define	kImageMetaIndex_Magic		0x58494d49		//*	"IMIX"
+#define	kImageMetaIndex_Version		1
+
+//*****************************************************************************
+//*	one record per saved image, fixed size so the file can be read in one block.
+//*	The file is in the native byte order, it is read on the machine that wrote it
+typedef struct	//	TYPE_IMAGE_META
+{
+	double		time_secs;			//*	unix time the exposure started
+	double		ra_deg;				//*	NAN if not known
+	double		dec_deg;
+	float		exposure_secs;
+	float		hfr;				//*	median HFR in pixels, 0 = not measured
+	float		meanPixel;
+	int32_t		gain;
+	int32_t		minPixel;
+	int32_t		maxPixel;
+	int32_t		width;
+	int32_t		height;
+	int32_t		imageType;
+	float		saturationPct;		//*	percent of the pixels at full scale
+	char		fileName[96];		//*	name only, the file is in the same directory as the index
+	char		filter[24];
+	char		object[40];
+} TYPE_IMAGE_META;
+
+//*****************************************************************************
+typedef struct	//	TYPE_IMAGE_META_HEADER
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	recordSize;
+	uint32_t	spare;
+} TYPE_IMAGE_META_HEADER;
+
+//*****************************************************************************
+//*	NULL strings and 0 limits match everything
+typedef struct	//	TYPE_IMAGE_META_QUERY
+{
+	const char	*fileName;			//*	sub string
+	const char	*object;			//*	sub string, case insensitive
+	const char	*filter;			//*	case insensitive
+	double		minExposure_secs;
+	double		maxExposure_secs;
+	double		maxHFR;
+	double		since_secs;			//*	unix time
+	double		until_secs;
+} TYPE_IMAGE_META_QUERY;
+
+//*	appends one record to the index in dirPath, the index is created if needed
+bool				ImageMetaIndex_Append(const char *dirPath, const TYPE_IMAGE_META *imageMeta);
+
+//*	reads the whole index, the returned list is malloc'd and must be freed by the caller.
+//*	Returns NULL if there is no valid index in dirPath
+TYPE_IMAGE_META		*ImageMetaIndex_Load(const char *dirPath, int *recordCnt);
+
+void				ImageMetaIndex_InitQuery(TYPE_IMAGE_META_QUERY *query);
+bool				ImageMetaIndex_Match(const TYPE_IMAGE_META *imageMeta, const TYPE_IMAGE_META_QUERY *query);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _IMAGE_META_INDEX_H_
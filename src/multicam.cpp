@@ -22,6 +22,16 @@
 //*	Apr 27,	2023	<MLS> Changed multicam commands to match camera commands
 //*	Jun 16,	2023	<MLS> Added readall to multicam
 //*	Jun 23,	2023	<MLS> Added GetCmdNameFromMyCmdTable() to multicam
+//*	Oct 19,	2026	<MLS> Exposures are now started by one thread per camera released by a barrier
+//*	Oct 19,	2026	<MLS> Added startskew command, start offsets in readall and the web page
+//*****************************************************************************
+//*	Synchronized start
+//*		Each camera gets a thread that does everything up to the camera's
+//*		start exposure call and then waits on a barrier. The main thread waits
+//*		for the millisecond to change and then joins the barrier, releasing all
+//*		of them at once. The time just before each start call is recorded,
+//*		the skew is the difference between the first and the last.
+//*		startexposure with Sync=false starts them one after the other (the old way)
 //*****************************************************************************
 
 #ifdef _ENABLE_MULTICAM_
@@ -32,6 +42,7 @@
 #include	<stdbool.h>
 #include	<ctype.h>
 #include	<stdint.h>
+#include	<pthread.h>
 
 #define _ENABLE_CONSOLE_DEBUG_
 #include	"ConsoleDebug.h"
@@ -39,6 +50,7 @@
 #include	"RequestData.h"
 #include	"JsonResponse.h"
 #include	"eventlogging.h"
+#include	"helper_functions.h"
 
 #include	"alpacadriver.h"
 #include	"alpacadriver_helper.h"
@@ -74,6 +86,7 @@ enum
 	kCmd_MultiCam_exposuretime,
 	kCmd_MultiCam_livemode,
 	kCmd_MultiCam_readall,
+	kCmd_MultiCam_startskew,
 
 
 	kCmd_MultiCam_last
@@ -90,6 +103,7 @@ static TYPE_CmdEntry	gMultiCamCmdTable[]	=
 	{	"exposuretime",			kCmd_MultiCam_exposuretime,		kCmdType_BOTH	},
 	{	"livemode",				kCmd_MultiCam_livemode,			kCmdType_BOTH	},
 	{	"readall",				kCmd_MultiCam_readall,			kCmdType_GET	},
+	{	"startskew",			kCmd_MultiCam_startskew,		kCmdType_GET	},
 
 
 
@@ -106,6 +120,10 @@ MultiCam::MultiCam(const int argDevNum)
 	strcpy(cCommonProp.Name, "MultiCam");
 	cDriverCmdTablePtr	=	gMultiCamCmdTable;
 
+	cSyncStart		=	true;
+	memset(cStartInfo, 0, sizeof(cStartInfo));
+	cStartCnt		=	0;
+	cStartSkew_us	=	0;
 }
 
 //**************************************************************************************
@@ -230,6 +248,10 @@ int					mySocket;
 			alpacaErrCode	=	Get_Readall(reqData, alpacaErrMsg);
 			break;
 
+		case kCmd_MultiCam_startskew:
+			alpacaErrCode	=	Get_StartSkew(reqData, alpacaErrMsg, gValueString);
+			break;
+
 		//----------------------------------------------------------------------------------------
 		//*	let anything undefined go to the common command processor
 		//----------------------------------------------------------------------------------------
@@ -375,6 +397,138 @@ int			sLen;
 	}
 }
 
+//*****************************************************************************
+//*	everything that does not have to happen at the start time is done
+//*	before waiting on the barrier
+//*****************************************************************************
+static void	*MultiCamStartThread(void *arg)
+{
+TYPE_MULTICAM_START	*startInfo;
+CameraDriver		*cameraObj;
+
+	startInfo	=	(TYPE_MULTICAM_START *)arg;
+	cameraObj	=	startInfo->cameraObj;
+
+	cameraObj->SaveNextImage();
+
+	//*	the main thread holds this until all of the threads are created
+	pthread_mutex_lock(startInfo->armMutex);
+	pthread_mutex_unlock(startInfo->armMutex);
+	if (startInfo->startBarrier != NULL)
+	{
+		pthread_barrier_wait(startInfo->startBarrier);
+	}
+
+	startInfo->start_us			=	PipelineTiming_Now_us();
+	cameraObj->PipelineTiming_ExposureStart();
+	startInfo->alpacaErrCode	=	cameraObj->Start_CameraExposure(startInfo->exposure_us);
+	startInfo->return_us		=	PipelineTiming_Now_us();
+	return(NULL);
+}
+
+//*****************************************************************************
+//*	starts the cameras in cStartInfo[0 -> startCnt-1]
+//*****************************************************************************
+void	MultiCam::StartExposures(const int startCnt, const bool syncStart)
+{
+pthread_barrier_t	startBarrier;
+pthread_mutex_t		armMutex;
+int					threadCnt;
+int					threadErr;
+int					iii;
+struct timeval		currentTime;
+long				curr_millisec;
+long				prev_millisec;
+uint64_t			firstStart_us;
+uint64_t			lastStart_us;
+
+	cStartCnt		=	startCnt;
+	cStartSkew_us	=	0;
+	if (startCnt <= 0)
+	{
+		return;
+	}
+
+	//*	create the threads, they can not get to the barrier until armMutex is released
+	threadCnt	=	0;
+	pthread_mutex_init(&armMutex, NULL);
+	pthread_mutex_lock(&armMutex);
+	if (syncStart && (startCnt > 1))
+	{
+		for (iii=0; iii<startCnt; iii++)
+		{
+			cStartInfo[iii].startBarrier	=	&startBarrier;
+			cStartInfo[iii].armMutex		=	&armMutex;
+			threadErr	=	pthread_create(&cStartInfo[iii].threadID, NULL, &MultiCamStartThread, &cStartInfo[iii]);
+			if (threadErr == 0)
+			{
+				cStartInfo[iii].threadCreated	=	true;
+				threadCnt++;
+			}
+			else
+			{
+				CONSOLE_DEBUG_W_NUM("pthread_create failed, camera will be started after the others:", iii);
+			}
+		}
+	}
+	//*	the threads plus this one
+	pthread_barrier_init(&startBarrier, NULL, (threadCnt + 1));
+	pthread_mutex_unlock(&armMutex);
+
+	//****************************************************
+	//*	sit here and waste time until we change millisecs
+	//*	this way, the images will have the same time stamp
+	gettimeofday(&currentTime, NULL);
+	prev_millisec	=	currentTime.tv_usec / 1000;
+	curr_millisec	=	currentTime.tv_usec / 1000;
+	while (curr_millisec == prev_millisec)
+	{
+		gettimeofday(&currentTime, NULL);
+		curr_millisec	=	currentTime.tv_usec / 1000;
+	}
+
+	if (threadCnt > 0)
+	{
+		//*	this releases all of the threads
+		pthread_barrier_wait(&startBarrier);
+		for (iii=0; iii<startCnt; iii++)
+		{
+			if (cStartInfo[iii].threadCreated)
+			{
+				pthread_join(cStartInfo[iii].threadID, NULL);
+			}
+		}
+	}
+	pthread_barrier_destroy(&startBarrier);
+
+	//*	anything that did not get a thread is started from here, one after the other
+	for (iii=0; iii<startCnt; iii++)
+	{
+		if (cStartInfo[iii].threadCreated == false)
+		{
+			cStartInfo[iii].startBarrier	=	NULL;
+			cStartInfo[iii].armMutex		=	&armMutex;
+			MultiCamStartThread(&cStartInfo[iii]);
+		}
+	}
+	pthread_mutex_destroy(&armMutex);
+
+	firstStart_us	=	cStartInfo[0].start_us;
+	lastStart_us	=	cStartInfo[0].start_us;
+	for (iii=1; iii<startCnt; iii++)
+	{
+		if (cStartInfo[iii].start_us < firstStart_us)
+		{
+			firstStart_us	=	cStartInfo[iii].start_us;
+		}
+		if (cStartInfo[iii].start_us > lastStart_us)
+		{
+			lastStart_us	=	cStartInfo[iii].start_us;
+		}
+	}
+	cStartSkew_us	=	lastStart_us - firstStart_us;
+}
+
 //*****************************************************************************
 TYPE_ASCOM_STATUS	MultiCam::Put_StartExposure(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg)
 {
@@ -384,9 +538,6 @@ double				expDurationValues_secs[kMaxDevices];
 int					iii;
 int					ccc;
 CameraDriver		*cameraObj;
-struct timeval		currentTime;
-long				curr_millisec;
-long				prev_millisec;
 bool				durationFound;
 char				durationString[128];
 bool				objectNameFound;
@@ -397,6 +548,7 @@ bool				filenamePrefixFound;
 char				myFileNamePrefix[kFileNamePrefixMaxLen];
 bool				filenameSuffixFound;
 char				myFileNameSuffix[kFileNamePrefixMaxLen];
+char				syncString[32];
 
 //bool			imageTypeFound;
 //char			myImageType[32];
@@ -433,6 +585,11 @@ char				myFileNameSuffix[kFileNamePrefixMaxLen];
 //													myImageType,
 //													30);
 
+		if (GetKeyWordArgument(reqData->contentData, "Sync", syncString, (sizeof(syncString) -1)))
+		{
+			cSyncStart	=	IsTrueFalse(syncString);
+		}
+
 		//*	Duration=1000.0&Light=true HTTP/1.1
 		durationFound		=	GetKeyWordArgument(	reqData->contentData,
 													"Duration",
@@ -487,19 +644,7 @@ char				myFileNameSuffix[kFileNamePrefixMaxLen];
 		}
 
 		//****************************************************
-		//*	sit here and waste time until we change millisecs
-		//*	this way, the 2 images will have the same time stamp
-		gettimeofday(&currentTime, NULL);
-		prev_millisec	=	currentTime.tv_usec / 1000;
-		curr_millisec	=	currentTime.tv_usec / 1000;
-		while (curr_millisec == prev_millisec)
-		{
-			gettimeofday(&currentTime, NULL);
-			curr_millisec	=	currentTime.tv_usec / 1000;
-		}
-
-		//****************************************************
-		//*	now start the exposures
+		//*	set up the start info for each camera
 		//****************************************************
 		ccc	=	0;		//*	set the camera counter to zero
 		for (iii=0; iii<gDeviceCnt; iii++)
@@ -512,23 +657,39 @@ char				myFileNameSuffix[kFileNamePrefixMaxLen];
 					CONSOLE_DEBUG("---------------------------------------------------------");
 					CONSOLE_DEBUG_W_STR("We have a camera:", cameraObj->cCommonProp.Name);
 
+					memset(&cStartInfo[ccc], 0, sizeof(TYPE_MULTICAM_START));
+					cStartInfo[ccc].cameraObj	=	cameraObj;
 				//	exposureDuration_usecs	=	exposureDuration_secs * 1000 * 1000;
-					exposureDuration_usecs	=	expDurationValues_secs[ccc] * 1000 * 1000;
-					alpacaErrCode			=	cameraObj->Start_CameraExposure(exposureDuration_usecs);
-					cameraObj->SaveNextImage();
-
-
-					if (alpacaErrCode != 0)
-					{
-						CONSOLE_DEBUG_W_NUM("Start_CameraExposure->alpacaErrCode\t=",	alpacaErrCode);
-						GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, cameraObj->cLastCameraErrMsg);
-						CONSOLE_DEBUG(alpacaErrMsg);
-					}
-
+					exposureDuration_usecs		=	expDurationValues_secs[ccc] * 1000 * 1000;
+					cStartInfo[ccc].exposure_us	=	exposureDuration_usecs;
 					ccc++;
 				}
 			}
 		}
+
+		//****************************************************
+		//*	now start the exposures
+		//****************************************************
+		StartExposures(ccc, cSyncStart);
+
+		alpacaErrCode	=	kASCOM_Err_Success;
+		for (iii=0; iii<cStartCnt; iii++)
+		{
+			if (cStartInfo[iii].alpacaErrCode != 0)
+			{
+				alpacaErrCode	=	cStartInfo[iii].alpacaErrCode;
+				CONSOLE_DEBUG_W_NUM("Start_CameraExposure->alpacaErrCode\t=",	alpacaErrCode);
+				GENERATE_ALPACAPI_ERRMSG(alpacaErrMsg, cStartInfo[iii].cameraObj->cLastCameraErrMsg);
+				CONSOLE_DEBUG(alpacaErrMsg);
+			}
+		}
+		CONSOLE_DEBUG_W_NUM("Exposure start skew (us)\t=",	cStartSkew_us);
+		JsonResponse_Add_Int32(	reqData->socket,
+								reqData->jsonTextBuffer,
+								kMaxJsonBuffLen,
+								"startskew_us",
+								cStartSkew_us,
+								INCLUDE_COMMA);
 //		CONSOLE_DEBUG_W_INT32("currentTime\t=",		millis());
 	}
 	else
@@ -599,6 +760,7 @@ int				mySocketFD;
 char			lineBuffer[512];
 int				iii;
 CameraDriver	*cameraObj;
+uint64_t		startTime_us;
 
 	if (reqData != NULL)
 	{
@@ -635,6 +797,36 @@ CameraDriver	*cameraObj;
 		}
 		SocketWriteData(mySocketFD,	"</TABLE>\r\n");
 		SocketWriteData(mySocketFD,	"<P>\r\n");
+
+		//*-----------------------------------------------------------
+		//*	start times from the last startexposure
+		if (cStartCnt > 0)
+		{
+			SocketWriteData(mySocketFD,	"<TABLE BORDER=1>\r\n");
+			sprintf(lineBuffer, "<TR><TD COLSPAN=3><CENTER>Last exposure start, %s, skew = %u us</TD></TR>\r\n",
+										(cSyncStart ? "synchronized" : "sequential"),
+										cStartSkew_us);
+			SocketWriteData(mySocketFD,	lineBuffer);
+			SocketWriteData(mySocketFD,	"<TR><TH>Camera</TH><TH>Start offset (us)</TH><TH>Start call (us)</TH></TR>\r\n");
+			startTime_us	=	cStartInfo[0].start_us;
+			for (iii=1; iii<cStartCnt; iii++)
+			{
+				if (cStartInfo[iii].start_us < startTime_us)
+				{
+					startTime_us	=	cStartInfo[iii].start_us;
+				}
+			}
+			for (iii=0; iii<cStartCnt; iii++)
+			{
+				sprintf(lineBuffer, "\t<TR><TD>%s</TD><TD>%u</TD><TD>%u</TD></TR>\r\n",
+											cStartInfo[iii].cameraObj->cCommonProp.Name,
+											(uint32_t)(cStartInfo[iii].start_us - startTime_us),
+											(uint32_t)(cStartInfo[iii].return_us - cStartInfo[iii].start_us));
+				SocketWriteData(mySocketFD,	lineBuffer);
+			}
+			SocketWriteData(mySocketFD,	"</TABLE>\r\n");
+			SocketWriteData(mySocketFD,	"<P>\r\n");
+		}
 		SocketWriteData(mySocketFD,	"</CENTER>\r\n");
 	}
 }
@@ -657,12 +849,16 @@ bool	foundFlag	=	true;
 
 	switch(cmdENum)
 	{
-		case kCmd_MultiCam_startexposure:
+		case kCmd_MultiCam_startexposure:	strcpy(agumentString, "Duration=FLOAT[,FLOAT...], Sync=BOOL, Object=STR, Telescope=STR, Prefix=STR, Suffix=STR");	break;
 		case kCmd_MultiCam_stopexposure:
 			break;
 
 		case kCmd_MultiCam_exposuretime:	strcpy(agumentString, "Duration=FLOAT");		break;
 		case kCmd_MultiCam_livemode:		strcpy(agumentString, "Livemode=BOOL");			break;
+		case kCmd_MultiCam_startskew:
+			strcpy(agumentString, "");
+			strcpy(commentString, "Start time of each camera relative to the first, from the last startexposure");
+			break;
 
 		default:
 			strcpy(agumentString, "");
@@ -712,6 +908,8 @@ CameraDriver		*cameraObj;
 		}
 
 
+		Get_StartSkew(reqData, alpacaErrMsg, "startskew_us");
+
 		//===============================================================
 		cBytesWrittenForThisCmd	+=	JsonResponse_Add_String(reqData->socket,
 															reqData->jsonTextBuffer,
@@ -731,4 +929,58 @@ CameraDriver		*cameraObj;
 	return(alpacaErrCode);
 }
 
+//*****************************************************************************
+TYPE_ASCOM_STATUS	MultiCam::Get_StartSkew(TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString)
+{
+TYPE_ASCOM_STATUS	alpacaErrCode	=	kASCOM_Err_Success;
+char				lineBuff[256];
+uint64_t			firstStart_us;
+int					iii;
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Int32(	reqData->socket,
+															reqData->jsonTextBuffer,
+															kMaxJsonBuffLen,
+															responseString,
+															cStartSkew_us,
+															INCLUDE_COMMA);
+
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_Bool(	reqData->socket,
+															reqData->jsonTextBuffer,
+															kMaxJsonBuffLen,
+															"syncstart",
+															cSyncStart,
+															INCLUDE_COMMA);
+
+	firstStart_us	=	cStartInfo[0].start_us;
+	for (iii=1; iii<cStartCnt; iii++)
+	{
+		if (cStartInfo[iii].start_us < firstStart_us)
+		{
+			firstStart_us	=	cStartInfo[iii].start_us;
+		}
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayStart(reqData->socket,
+															reqData->jsonTextBuffer,
+															kMaxJsonBuffLen,
+															"startoffsets");
+	for (iii=0; iii<cStartCnt; iii++)
+	{
+		sprintf(lineBuff, "{\"camera\":\"%s\",\"offset_us\":%u,\"startcall_us\":%u,\"error\":%d}%s",
+							cStartInfo[iii].cameraObj->cCommonProp.Name,
+							(uint32_t)(cStartInfo[iii].start_us - firstStart_us),
+							(uint32_t)(cStartInfo[iii].return_us - cStartInfo[iii].start_us),
+							cStartInfo[iii].alpacaErrCode,
+							((iii < (cStartCnt - 1)) ? "," : ""));
+		cBytesWrittenForThisCmd	+=	JsonResponse_Add_RawText(reqData->socket,
+															reqData->jsonTextBuffer,
+															kMaxJsonBuffLen,
+															lineBuff);
+	}
+	cBytesWrittenForThisCmd	+=	JsonResponse_Add_ArrayEnd(	reqData->socket,
+															reqData->jsonTextBuffer,
+															kMaxJsonBuffLen,
+															INCLUDE_COMMA);
+	return(alpacaErrCode);
+}
+
 #endif	//	_ENABLE_MULTICAM_
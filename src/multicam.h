@@ -17,16 +17,37 @@
 //*****************************************************************************
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
+//*	Oct 19,	2026	<MLS> Added TYPE_MULTICAM_START for synchronized exposure start
 //*****************************************************************************
 //#include	"multicam.h"
 
 #ifndef _DOME_DRIVER_H_
 #define	_DOME_DRIVER_H_
 
+#include	<pthread.h>
+
 #ifndef _ALPACA_DRIVER_H_
 	#include	"alpacadriver.h"
 #endif
 
+class CameraDriver;
+
+//**************************************************************************************
+//*	one per camera, each camera's exposure is started by its own thread,
+//*	all of the threads are released at the same time by a barrier
+typedef struct	//	TYPE_MULTICAM_START
+{
+	CameraDriver		*cameraObj;
+	int32_t				exposure_us;
+	pthread_barrier_t	*startBarrier;		//*	NULL = start without waiting
+	pthread_mutex_t		*armMutex;
+	pthread_t			threadID;
+	bool				threadCreated;
+	uint64_t			start_us;			//*	CLOCK_MONOTONIC, just before the camera's start call
+	uint64_t			return_us;			//*	when the start call returned
+	TYPE_ASCOM_STATUS	alpacaErrCode;
+} TYPE_MULTICAM_START;
+
 
 
 //**************************************************************************************
@@ -49,10 +70,17 @@ class MultiCam: public AlpacaDriver
 			TYPE_ASCOM_STATUS		Put_StartExposure(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
 			TYPE_ASCOM_STATUS		Put_ExposureTime(	TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
 			TYPE_ASCOM_STATUS		Get_Readall(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg);
+			TYPE_ASCOM_STATUS		Get_StartSkew(		TYPE_GetPutRequestData *reqData, char *alpacaErrMsg, const char *responseString);
+			void					StartExposures(		const int startCnt, const bool syncStart);
 
 	protected:
 				int		cCameraCnt;
 				int		cMultiCamState;
+
+				bool				cSyncStart;					//*	false = start the cameras one after the other
+				TYPE_MULTICAM_START	cStartInfo[kMaxDevices];
+				int					cStartCnt;
+				uint32_t			cStartSkew_us;				//*	first to last start call
 };
 
 
@@ -19,6 +19,7 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	Jan  2,	2020	<MLS> Created obsconditions_globals.h
+//*	Oct 19,	2026	<MLS> Added seeing data from camera star analysis
 //**************************************************************************
 //#include	"obsconditions_globals.h"
 
@@ -55,6 +56,13 @@ typedef struct
 	double			domePressure_kPa;
 	double			domeHumidity;
 
+	//*	seeing, measured from the stars in the camera images
+	bool			seeingDataValid;
+	char			seeingDataSource[64];
+	struct timeval	seeingLastUpdate;
+	double			starFWHM_arcsec;
+	double			starHFR_pixels;
+	int				starCount;
 
 } TYPE_OBS_GLOBALS;
 
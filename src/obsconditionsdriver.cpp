@@ -41,6 +41,7 @@
 //*	Nov 27,	2022	<MLS> CONFORMU-observingconditions -> PASSED!!!!!!!!!!!!!!!!!!!!!
 //*	Jun  4,	2023	<MLS> Updated compile time ifdefs
 //*	Jun 18,	2023	<MLS> Added DeviceState_Add_Content() to obsConditions driver
+//*	Oct 19,	2026	<MLS> StarFWHM is reported from the camera star analysis (gEnvData)
 //*****************************************************************************
 
 
@@ -133,6 +134,7 @@ int	ii;
 	cObsConditionProp.Averageperiod.Value	=	(kAvgSampleCount * kSampleDetlaSecs * 1.0) / 3600.0;
 
 	cCurrentPressure_kPa					=	0;		//*	kPa
+	cStarFWHMfromCamera						=	false;
 	cSuccesfullReadCnt						=	0;		//*	used to know if we have active sensors
 	cTimeOfLastUpdate_secs					=	0;		//*	time in seconds
 	cObservCondState						=	kObservCondState_Startup;
@@ -432,6 +434,22 @@ double	humidityTotal;
 	gEnvData.domeHumidity			=	cObsConditionProp.Humidity.Value;
 	gEnvData.domeDataValid			=	true;
 	gettimeofday(&gEnvData.domeLastUpdate, NULL);
+
+	//*	if there is no seeing sensor, use the stars measured by a camera
+	if ((cObsConditionProp.StarFWHM.IsSupported == false) || cStarFWHMfromCamera)
+	{
+		if (gEnvData.seeingDataValid && ((time(NULL) - gEnvData.seeingLastUpdate.tv_sec) < kSeeingMaxAge_secs))
+		{
+			cStarFWHMfromCamera						=	true;
+			cObsConditionProp.StarFWHM.IsSupported	=	true;
+			cObsConditionProp.StarFWHM.ValidData	=	true;
+			cObsConditionProp.StarFWHM.Value		=	gEnvData.starFWHM_arcsec;
+		}
+		else if (cStarFWHMfromCamera)
+		{
+			cObsConditionProp.StarFWHM.ValidData	=	false;
+		}
+	}
 }
 
 //*****************************************************************************
@@ -998,6 +1016,11 @@ double					lastUpdateTime;
 		mySensorType	=	GetSensorEnum(sensorNameString);
 
 		alpacaErrCode	=	GetSensorInfo(mySensorType, theDescription, &lastUpdateTime);
+		if ((mySensorType == kSensor_StarFWHM) && cStarFWHMfromCamera)
+		{
+			alpacaErrCode	=	kASCOM_Err_Success;
+			strcpy(theDescription, "AlpacaPi: Camera star analysis");
+		}
 
 			JsonResponse_Add_String(reqData->socket,
 									reqData->jsonTextBuffer,
@@ -1049,6 +1072,10 @@ double					lastUpdateTime;
 		if (mySensorType > kSensor_Invalid)
 		{
 			alpacaErrCode	=	GetSensorInfo(mySensorType, theDescription, &lastUpdateTime);
+			if ((mySensorType == kSensor_StarFWHM) && cStarFWHMfromCamera)
+			{
+				alpacaErrCode	=	kASCOM_Err_Success;
+			}
 		}
 		else if (strlen(sensorNameString) == 0)
 		{
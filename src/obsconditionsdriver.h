@@ -60,6 +60,7 @@ enum TYPE_ObsConSensorType
 
 #define	kAvgSampleCount		20
 #define	kSampleDetlaSecs	10
+#define	kSeeingMaxAge_secs	600		//*	star FWHM from the camera older than this is not used
 //**************************************************************************************
 class ObsConditionsDriver: public AlpacaDriver
 {
@@ -131,6 +132,7 @@ virtual	TYPE_ASCOM_STATUS	GetSensorInfo(			TYPE_ObsConSensorType sensorType,
 		double		cCurrentPressure_kPa;		//*	kilo Pascals
 		int			cSuccesfullReadCnt;			//*	used to know if we have active sensors
 		time_t		cTimeOfLastUpdate_secs;		//*	time in seconds
+		bool		cStarFWHMfromCamera;		//*	StarFWHM comes from the camera star analysis
 
 };
 
@@ -0,0 +1,1609 @@
+//*****************************************************************************
+//*	Name:			plate_solve.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Offline plate solver using the SkyTravel star catalogs
+//*
+//*					The index is built from hip_main.dat (Hipparcos) if it is present,
+//*					otherwise from YALEcatalog.dat (Yale bright star catalog).
+//*
+//*					Index
+//*						For every catalog star, triangles are formed with pairs of its
+//*						brightest neighbors within the index radius. Each triangle is
+//*						filed in a hash table by the ratios of its sides (s2/s1, s3/s1),
+//*						which do not change with position, rotation, scale or mirroring.
+//*						The index is built once and cached on disk, a new one is only
+//*						built when the index radius or the catalog changes.
+//*
+//*					Solving (near blind, the pixel scale must be known)
+//*						The same triangles are formed from the brightest image stars and
+//*						looked up in the hash table, candidates with the wrong scale or
+//*						that are not a similarity transform are thrown out.
+//*						Each remaining candidate is checked by projecting the catalog stars
+//*						that should be in the frame and counting how many land on image stars.
+//*						The best candidate is refined by a least squares fit of all matches.
+//*
+//*					The result is the FITS TAN projection (CRVAL, CRPIX, CD matrix)
+//*
+//*					The fields of view that can be solved are limited by the depth of the
+//*					catalog, Hipparcos needs about 1 degree or more, Yale about 10 degrees.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created plate_solve.c
+//*	Oct 19,	2026	<MLS> Added PlateSolve_ReadCatalogField() for the star field simulator
+//*	Oct 19,	2026	<MLS> Removed unused VectorToRaDec(), the index magic is compared with memcmp()
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<math.h>
+#include	<pthread.h>
+#include	<sys/stat.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"helper_functions.h"
+#include	"plate_solve.h"
+
+#define	kIndexVersion			1
+#define	kNeighborCnt			6		//*	brightest neighbors used for the triangles of each star
+#define	kMaxNeighbors			512
+#define	kKeyBins				100		//*	hash table is kKeyBins x kKeyBins
+#define	kKeyTolerance			0.012	//*	allowed difference of the side ratios
+#define	kMinSideDiff			0.02	//*	sides closer than this can not be ordered reliably
+#define	kMinSeparation			0.05	//*	of the index radius
+#define	kSimilarityTol			0.05
+#define	kMinMatches				6
+#define	kMinMatchFraction		0.35
+#define	kMaxCatStarsInFrame		4096
+
+#ifndef PI
+	#define	PI	3.14159265358979323846
+#endif
+
+//*****************************************************************************
+typedef struct	//	TYPE_SOLVE_CATSTAR
+{
+	float		ra;						//*	radians
+	float		decl;
+	float		magn;
+} TYPE_SOLVE_CATSTAR;
+
+//*****************************************************************************
+//*	the vertices are ordered, opposite the longest side first
+typedef struct	//	TYPE_SOLVE_TRIANGLE
+{
+	int32_t		starIdx[3];
+} TYPE_SOLVE_TRIANGLE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_SOLVE_INDEX_HDR
+{
+	char		magic[8];
+	int32_t		version;
+	int32_t		radius_arcmin;
+	int64_t		catalogSize;
+	int64_t		catalogTime;
+	int32_t		starCount;
+	int32_t		triangleCount;
+	int32_t		binCount;
+	int32_t		neighborCnt;
+	char		catalogName[32];
+} TYPE_SOLVE_INDEX_HDR;
+
+//*****************************************************************************
+typedef struct	//	TYPE_SOLVE_INDEX
+{
+	bool					valid;
+	TYPE_SOLVE_INDEX_HDR	header;
+	TYPE_SOLVE_CATSTAR		*starList;
+	double					*unitVector;		//*	3 per star
+	int32_t					*binStart;			//*	binCount + 1
+	TYPE_SOLVE_TRIANGLE		*triangleList;		//*	sorted by bin
+	//*	spatial hash of the stars, cells are the index radius in size
+	double					cellSize;
+	int32_t					hashSize;
+	int32_t					*hashHead;
+	int32_t					*hashNext;
+	int32_t					*cellCoord;			//*	3 per star
+} TYPE_SOLVE_INDEX;
+
+//*****************************************************************************
+typedef struct	//	TYPE_BUILD_TRIANGLE
+{
+	int32_t				bin;
+	TYPE_SOLVE_TRIANGLE	triangle;
+} TYPE_BUILD_TRIANGLE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_IMAGE_TRIANGLE
+{
+	int			starIdx[3];
+	double		key2;
+	double		key3;
+	double		longSide;
+} TYPE_IMAGE_TRIANGLE;
+
+//*****************************************************************************
+//*	pixel (relative to the image center) to tangent plane (radians)
+//*	xi = aaa * u + bbb * v + eee,	eta = ccc * u + ddd * v + fff
+typedef struct	//	TYPE_SOLVE_XFORM
+{
+	double		aaa;
+	double		bbb;
+	double		ccc;
+	double		ddd;
+	double		eee;
+	double		fff;
+	double		tangentRA;
+	double		tangentDecl;
+} TYPE_SOLVE_XFORM;
+
+static TYPE_SOLVE_INDEX	gSolveIndex;
+static pthread_mutex_t	gSolveMutex	=	PTHREAD_MUTEX_INITIALIZER;
+
+
+//*****************************************************************************
+static void	RaDecToVector(const double ra, const double decl, double *vector)
+{
+	vector[0]	=	cos(decl) * cos(ra);
+	vector[1]	=	cos(decl) * sin(ra);
+	vector[2]	=	sin(decl);
+}
+
+//*****************************************************************************
+//*	angle between two unit vectors, accurate for small angles
+//*****************************************************************************
+static double	VectorAngle(const double *vector1, const double *vector2)
+{
+double	dx;
+double	dy;
+double	dz;
+double	chord;
+
+	dx		=	vector1[0] - vector2[0];
+	dy		=	vector1[1] - vector2[1];
+	dz		=	vector1[2] - vector2[2];
+	chord	=	sqrt((dx * dx) + (dy * dy) + (dz * dz));
+	return(2.0 * asin(chord / 2.0));
+}
+
+//*****************************************************************************
+//*	gnomonic (TAN) projection
+//*****************************************************************************
+static bool	ProjectToTangent(const double tangentRA, const double tangentDecl, const double ra, const double decl, double *xi, double *eta)
+{
+double	cosC;
+
+	cosC	=	(sin(tangentDecl) * sin(decl)) + (cos(tangentDecl) * cos(decl) * cos(ra - tangentRA));
+	if (cosC <= 0.1)
+	{
+		return(false);
+	}
+	*xi		=	(cos(decl) * sin(ra - tangentRA)) / cosC;
+	*eta	=	((cos(tangentDecl) * sin(decl)) - (sin(tangentDecl) * cos(decl) * cos(ra - tangentRA))) / cosC;
+	return(true);
+}
+
+//*****************************************************************************
+static void	TangentToRaDec(const double tangentRA, const double tangentDecl, const double xi, const double eta, double *ra, double *decl)
+{
+double	rho;
+double	ccc;
+
+	rho	=	sqrt((xi * xi) + (eta * eta));
+	if (rho < 1.0e-12)
+	{
+		*ra		=	tangentRA;
+		*decl	=	tangentDecl;
+		return;
+	}
+	ccc		=	atan(rho);
+	*decl	=	asin((cos(ccc) * sin(tangentDecl)) + ((eta * sin(ccc) * cos(tangentDecl)) / rho));
+	*ra		=	tangentRA + atan2(xi * sin(ccc), (rho * cos(tangentDecl) * cos(ccc)) - (eta * sin(tangentDecl) * sin(ccc)));
+	while (*ra < 0.0)
+	{
+		*ra	+=	2.0 * PI;
+	}
+	while (*ra >= (2.0 * PI))
+	{
+		*ra	-=	2.0 * PI;
+	}
+}
+
+//*****************************************************************************
+//*	Gaussian elimination with partial pivoting
+//*****************************************************************************
+static bool	Solve3x3(double matrix[3][3], double vector[3], double result[3])
+{
+int		iii;
+int		jjj;
+int		kkk;
+int		pivotRow;
+double	factor;
+double	temp;
+
+	for (iii=0; iii<3; iii++)
+	{
+		pivotRow	=	iii;
+		for (jjj=iii+1; jjj<3; jjj++)
+		{
+			if (fabs(matrix[jjj][iii]) > fabs(matrix[pivotRow][iii]))
+			{
+				pivotRow	=	jjj;
+			}
+		}
+		if (fabs(matrix[pivotRow][iii]) < 1.0e-30)
+		{
+			return(false);
+		}
+		if (pivotRow != iii)
+		{
+			for (kkk=0; kkk<3; kkk++)
+			{
+				temp					=	matrix[iii][kkk];
+				matrix[iii][kkk]		=	matrix[pivotRow][kkk];
+				matrix[pivotRow][kkk]	=	temp;
+			}
+			temp				=	vector[iii];
+			vector[iii]			=	vector[pivotRow];
+			vector[pivotRow]	=	temp;
+		}
+		for (jjj=iii+1; jjj<3; jjj++)
+		{
+			factor	=	matrix[jjj][iii] / matrix[iii][iii];
+			for (kkk=iii; kkk<3; kkk++)
+			{
+				matrix[jjj][kkk]	-=	factor * matrix[iii][kkk];
+			}
+			vector[jjj]	-=	factor * vector[iii];
+		}
+	}
+	for (iii=2; iii>=0; iii--)
+	{
+		temp	=	vector[iii];
+		for (kkk=iii+1; kkk<3; kkk++)
+		{
+			temp	-=	matrix[iii][kkk] * result[kkk];
+		}
+		result[iii]	=	temp / matrix[iii][iii];
+	}
+	return(true);
+}
+
+//*****************************************************************************
+//*	orders the vertices by the opposite side, longest first
+//*	side01 is the side between vertex 0 and vertex 1, etc
+//*	returns false if the triangle can not be ordered reliably
+//*****************************************************************************
+static bool	OrderTriangle(	const int	vertex[3],
+							const double side01,
+							const double side02,
+							const double side12,
+							int			*orderedVertex,
+							double		*key2,
+							double		*key3,
+							double		*longSide)
+{
+double	sideLen[3];
+int		opposite[3];
+double	tempLen;
+int		tempVertex;
+int		iii;
+int		jjj;
+
+	sideLen[0]	=	side12;		opposite[0]	=	vertex[0];
+	sideLen[1]	=	side02;		opposite[1]	=	vertex[1];
+	sideLen[2]	=	side01;		opposite[2]	=	vertex[2];
+	for (iii=0; iii<2; iii++)
+	{
+		for (jjj=iii+1; jjj<3; jjj++)
+		{
+			if (sideLen[jjj] > sideLen[iii])
+			{
+				tempLen			=	sideLen[iii];
+				sideLen[iii]	=	sideLen[jjj];
+				sideLen[jjj]	=	tempLen;
+				tempVertex		=	opposite[iii];
+				opposite[iii]	=	opposite[jjj];
+				opposite[jjj]	=	tempVertex;
+			}
+		}
+	}
+	if (sideLen[0] <= 0.0)
+	{
+		return(false);
+	}
+	if (((sideLen[0] - sideLen[1]) < (kMinSideDiff * sideLen[0])) ||
+		((sideLen[1] - sideLen[2]) < (kMinSideDiff * sideLen[0])))
+	{
+		return(false);
+	}
+	for (iii=0; iii<3; iii++)
+	{
+		orderedVertex[iii]	=	opposite[iii];
+	}
+	*key2		=	sideLen[1] / sideLen[0];
+	*key3		=	sideLen[2] / sideLen[0];
+	*longSide	=	sideLen[0];
+	return(true);
+}
+
+//*****************************************************************************
+static int	KeyToBin(const double key2, const double key3)
+{
+int		bin2;
+int		bin3;
+
+	bin2	=	(int)(key2 * kKeyBins);
+	bin3	=	(int)(key3 * kKeyBins);
+	if (bin2 >= kKeyBins)
+	{
+		bin2	=	kKeyBins - 1;
+	}
+	if (bin3 >= kKeyBins)
+	{
+		bin3	=	kKeyBins - 1;
+	}
+	return((bin2 * kKeyBins) + bin3);
+}
+
+//*****************************************************************************
+//*	firstCol is 1 based to match the catalog documentation
+//*****************************************************************************
+static bool	ParseField(const char *lineBuff, const int lineLen, const int firstCol, const int width, double *value)
+{
+char	fieldBuff[32];
+
+	if (((firstCol - 1 + width) > lineLen) || (width >= (int)sizeof(fieldBuff)))
+	{
+		return(false);
+	}
+	memcpy(fieldBuff, &lineBuff[firstCol - 1], width);
+	fieldBuff[width]	=	0;
+	if ((int)strspn(fieldBuff, " ") == width)
+	{
+		return(false);
+	}
+	*value	=	atof(fieldBuff);
+	return(true);
+}
+
+//*****************************************************************************
+//*	hip_main.dat, see HipparcosCatalog.c for the format
+//*****************************************************************************
+static bool	ParseHipparcosLine(const char *lineBuff, const int lineLen, TYPE_SOLVE_CATSTAR *catStar)
+{
+double	raDegrees;
+double	declDegrees;
+double	magnitude;
+
+	if ((ParseField(lineBuff, lineLen, 52, 12, &raDegrees) == false) ||
+		(ParseField(lineBuff, lineLen, 65, 12, &declDegrees) == false))
+	{
+		return(false);
+	}
+	if (ParseField(lineBuff, lineLen, 42, 5, &magnitude) == false)
+	{
+		if (ParseField(lineBuff, lineLen, 275, 7, &magnitude) == false)
+		{
+			return(false);
+		}
+	}
+	catStar->ra		=	(raDegrees * PI) / 180.0;
+	catStar->decl	=	(declDegrees * PI) / 180.0;
+	catStar->magn	=	magnitude;
+	return(true);
+}
+
+//*****************************************************************************
+//*	YALEcatalog.dat, see YaleStarCatalog.c for the format
+//*****************************************************************************
+static bool	ParseYaleLine(const char *lineBuff, const int lineLen, TYPE_SOLVE_CATSTAR *catStar)
+{
+double	raHour;
+double	raMin;
+double	raSec;
+double	deDeg;
+double	deMin;
+double	deSec;
+double	magnitude;
+double	declDegrees;
+
+	if ((ParseField(lineBuff, lineLen, 76, 2, &raHour) == false) ||
+		(ParseField(lineBuff, lineLen, 78, 2, &raMin) == false) ||
+		(ParseField(lineBuff, lineLen, 80, 4, &raSec) == false) ||
+		(ParseField(lineBuff, lineLen, 85, 2, &deDeg) == false) ||
+		(ParseField(lineBuff, lineLen, 87, 2, &deMin) == false) ||
+		(ParseField(lineBuff, lineLen, 89, 2, &deSec) == false) ||
+		(ParseField(lineBuff, lineLen, 103, 5, &magnitude) == false))
+	{
+		return(false);
+	}
+	declDegrees	=	deDeg + (deMin / 60.0) + (deSec / 3600.0);
+	if (lineBuff[84 - 1] == '-')
+	{
+		declDegrees	=	-declDegrees;
+	}
+	catStar->ra		=	((raHour + (raMin / 60.0) + (raSec / 3600.0)) * 15.0 * PI) / 180.0;
+	catStar->decl	=	(declDegrees * PI) / 180.0;
+	catStar->magn	=	magnitude;
+	return(true);
+}
+
+//*****************************************************************************
+static int	ReadCatalog(const char *filePath, const bool isHipparcos, TYPE_SOLVE_CATSTAR **starListPtr)
+{
+FILE				*filePointer;
+char				lineBuff[1024];
+int					lineLen;
+int					starCount;
+int					allocCnt;
+TYPE_SOLVE_CATSTAR	*starList;
+TYPE_SOLVE_CATSTAR	*newList;
+TYPE_SOLVE_CATSTAR	catStar;
+bool				validStar;
+
+	starCount	=	0;
+	allocCnt	=	0;
+	starList	=	NULL;
+	filePointer	=	fopen(filePath, "r");
+	if (filePointer != NULL)
+	{
+		while (fgets(lineBuff, sizeof(lineBuff), filePointer) != NULL)
+		{
+			lineLen		=	strlen(lineBuff);
+			if (isHipparcos)
+			{
+				validStar	=	ParseHipparcosLine(lineBuff, lineLen, &catStar);
+			}
+			else
+			{
+				validStar	=	ParseYaleLine(lineBuff, lineLen, &catStar);
+			}
+			if (validStar)
+			{
+				if (starCount >= allocCnt)
+				{
+					allocCnt	+=	16384;
+					newList		=	(TYPE_SOLVE_CATSTAR *)realloc(starList, allocCnt * sizeof(TYPE_SOLVE_CATSTAR));
+					if (newList == NULL)
+					{
+						break;
+					}
+					starList	=	newList;
+				}
+				starList[starCount++]	=	catStar;
+			}
+		}
+		fclose(filePointer);
+	}
+	*starListPtr	=	starList;
+	return(starCount);
+}
+
+//*****************************************************************************
+static uint32_t	HashCell(const int32_t cellX, const int32_t cellY, const int32_t cellZ, const int32_t hashSize)
+{
+uint32_t	hashValue;
+
+	hashValue	=	((uint32_t)cellX * 73856093u) ^ ((uint32_t)cellY * 19349663u) ^ ((uint32_t)cellZ * 83492791u);
+	return(hashValue % (uint32_t)hashSize);
+}
+
+//*****************************************************************************
+static void	ReleaseSpatialHash(TYPE_SOLVE_INDEX *solveIndex)
+{
+	free(solveIndex->unitVector);
+	free(solveIndex->hashHead);
+	free(solveIndex->hashNext);
+	free(solveIndex->cellCoord);
+	solveIndex->unitVector	=	NULL;
+	solveIndex->hashHead	=	NULL;
+	solveIndex->hashNext	=	NULL;
+	solveIndex->cellCoord	=	NULL;
+}
+
+//*****************************************************************************
+static bool	BuildSpatialHash(TYPE_SOLVE_INDEX *solveIndex, const double cellSize)
+{
+int32_t		starCount;
+int32_t		iii;
+int32_t		*cellPtr;
+double		*vectorPtr;
+uint32_t	hashIdx;
+
+	starCount				=	solveIndex->header.starCount;
+	solveIndex->cellSize	=	cellSize;
+	solveIndex->hashSize	=	(2 * starCount) + 1;
+	solveIndex->unitVector	=	(double *)malloc(3 * starCount * sizeof(double));
+	solveIndex->hashHead	=	(int32_t *)malloc(solveIndex->hashSize * sizeof(int32_t));
+	solveIndex->hashNext	=	(int32_t *)malloc(starCount * sizeof(int32_t));
+	solveIndex->cellCoord	=	(int32_t *)malloc(3 * starCount * sizeof(int32_t));
+	if ((solveIndex->unitVector == NULL) || (solveIndex->hashHead == NULL) ||
+		(solveIndex->hashNext == NULL) || (solveIndex->cellCoord == NULL))
+	{
+		ReleaseSpatialHash(solveIndex);
+		return(false);
+	}
+	for (iii=0; iii<solveIndex->hashSize; iii++)
+	{
+		solveIndex->hashHead[iii]	=	-1;
+	}
+	for (iii=0; iii<starCount; iii++)
+	{
+		vectorPtr	=	&solveIndex->unitVector[3 * iii];
+		cellPtr		=	&solveIndex->cellCoord[3 * iii];
+		RaDecToVector(solveIndex->starList[iii].ra, solveIndex->starList[iii].decl, vectorPtr);
+		cellPtr[0]	=	(int32_t)floor((vectorPtr[0] + 1.0) / cellSize);
+		cellPtr[1]	=	(int32_t)floor((vectorPtr[1] + 1.0) / cellSize);
+		cellPtr[2]	=	(int32_t)floor((vectorPtr[2] + 1.0) / cellSize);
+		hashIdx		=	HashCell(cellPtr[0], cellPtr[1], cellPtr[2], solveIndex->hashSize);
+		solveIndex->hashNext[iii]		=	solveIndex->hashHead[hashIdx];
+		solveIndex->hashHead[hashIdx]	=	iii;
+	}
+	return(true);
+}
+
+//*****************************************************************************
+//*	returns the number of stars within radius (radians) of centerVector
+//*****************************************************************************
+static int	FindStarsInRadius(	const TYPE_SOLVE_INDEX	*solveIndex,
+								const double			*centerVector,
+								const double			radius,
+								int32_t					*foundList,
+								const int				maxFound)
+{
+int		foundCnt;
+int32_t	centerCell[3];
+int32_t	cellRange;
+int32_t	cellX;
+int32_t	cellY;
+int32_t	cellZ;
+int32_t	starIdx;
+int32_t	*cellPtr;
+double	minDot;
+double	chord;
+double	*vectorPtr;
+
+	foundCnt	=	0;
+	chord		=	2.0 * sin(radius / 2.0);
+	minDot		=	cos(radius);
+	cellRange	=	(int32_t)ceil(chord / solveIndex->cellSize);
+	for (cellX=0; cellX<3; cellX++)
+	{
+		centerCell[cellX]	=	(int32_t)floor((centerVector[cellX] + 1.0) / solveIndex->cellSize);
+	}
+	for (cellX=centerCell[0]-cellRange; cellX<=centerCell[0]+cellRange; cellX++)
+	{
+		for (cellY=centerCell[1]-cellRange; cellY<=centerCell[1]+cellRange; cellY++)
+		{
+			for (cellZ=centerCell[2]-cellRange; cellZ<=centerCell[2]+cellRange; cellZ++)
+			{
+				starIdx	=	solveIndex->hashHead[HashCell(cellX, cellY, cellZ, solveIndex->hashSize)];
+				while (starIdx >= 0)
+				{
+					cellPtr	=	&solveIndex->cellCoord[3 * starIdx];
+					//*	other cells can share the hash entry
+					if ((cellPtr[0] == cellX) && (cellPtr[1] == cellY) && (cellPtr[2] == cellZ))
+					{
+						vectorPtr	=	&solveIndex->unitVector[3 * starIdx];
+						if (((vectorPtr[0] * centerVector[0]) +
+							(vectorPtr[1] * centerVector[1]) +
+							(vectorPtr[2] * centerVector[2])) >= minDot)
+						{
+							if (foundCnt < maxFound)
+							{
+								foundList[foundCnt++]	=	starIdx;
+							}
+						}
+					}
+					starIdx	=	solveIndex->hashNext[starIdx];
+				}
+			}
+		}
+	}
+	return(foundCnt);
+}
+
+//*****************************************************************************
+static const TYPE_SOLVE_CATSTAR	*gSortStarList;
+
+static int	CompareStarMagnitude(const void *ptr1, const void *ptr2)
+{
+float	magn1	=	gSortStarList[*((const int32_t *)ptr1)].magn;
+float	magn2	=	gSortStarList[*((const int32_t *)ptr2)].magn;
+
+	if (magn1 < magn2)
+	{
+		return(-1);
+	}
+	return((magn1 > magn2) ? 1 : 0);
+}
+
+//*****************************************************************************
+static int	CompareBuildTriangle(const void *ptr1, const void *ptr2)
+{
+const TYPE_BUILD_TRIANGLE	*triangle1	=	(const TYPE_BUILD_TRIANGLE *)ptr1;
+const TYPE_BUILD_TRIANGLE	*triangle2	=	(const TYPE_BUILD_TRIANGLE *)ptr2;
+int							iii;
+
+	if (triangle1->bin != triangle2->bin)
+	{
+		return((triangle1->bin < triangle2->bin) ? -1 : 1);
+	}
+	for (iii=0; iii<3; iii++)
+	{
+		if (triangle1->triangle.starIdx[iii] != triangle2->triangle.starIdx[iii])
+		{
+			return((triangle1->triangle.starIdx[iii] < triangle2->triangle.starIdx[iii]) ? -1 : 1);
+		}
+	}
+	return(0);
+}
+
+//*****************************************************************************
+//*	the sides of a catalog triangle, in radians
+//*****************************************************************************
+static bool	CatalogTriangle(const TYPE_SOLVE_INDEX	*solveIndex,
+							const int				vertex[3],
+							int						*orderedVertex,
+							double					*key2,
+							double					*key3,
+							double					*longSide)
+{
+const double	*vector0	=	&solveIndex->unitVector[3 * vertex[0]];
+const double	*vector1	=	&solveIndex->unitVector[3 * vertex[1]];
+const double	*vector2	=	&solveIndex->unitVector[3 * vertex[2]];
+
+	return(OrderTriangle(	vertex,
+							VectorAngle(vector0, vector1),
+							VectorAngle(vector0, vector2),
+							VectorAngle(vector1, vector2),
+							orderedVertex, key2, key3, longSide));
+}
+
+//*****************************************************************************
+static bool	BuildTriangles(TYPE_SOLVE_INDEX *solveIndex, const double indexRadius)
+{
+TYPE_BUILD_TRIANGLE	*buildList;
+int32_t				buildCnt;
+int32_t				allocCnt;
+int32_t				neighborList[kMaxNeighbors];
+int32_t				usedList[kNeighborCnt];
+int					neighborCnt;
+int					usedCnt;
+int32_t				starIdx;
+int					iii;
+int					jjj;
+int					kkk;
+int					vertex[3];
+int					orderedVertex[3];
+double				key2;
+double				key3;
+double				longSide;
+int32_t				binIdx;
+int32_t				uniqueCnt;
+
+	allocCnt	=	solveIndex->header.starCount * ((kNeighborCnt * (kNeighborCnt - 1)) / 2);
+	buildList	=	(TYPE_BUILD_TRIANGLE *)malloc(allocCnt * sizeof(TYPE_BUILD_TRIANGLE));
+	if (buildList == NULL)
+	{
+		return(false);
+	}
+	buildCnt		=	0;
+	gSortStarList	=	solveIndex->starList;
+	for (starIdx=0; starIdx<solveIndex->header.starCount; starIdx++)
+	{
+		neighborCnt	=	FindStarsInRadius(	solveIndex,
+											&solveIndex->unitVector[3 * starIdx],
+											indexRadius,
+											neighborList,
+											kMaxNeighbors);
+		qsort(neighborList, neighborCnt, sizeof(int32_t), CompareStarMagnitude);
+
+		//*	the brightest neighbors, not too close to this star
+		usedCnt	=	0;
+		for (iii=0; (iii<neighborCnt) && (usedCnt < kNeighborCnt); iii++)
+		{
+			if ((neighborList[iii] != starIdx) &&
+				(VectorAngle(	&solveIndex->unitVector[3 * starIdx],
+								&solveIndex->unitVector[3 * neighborList[iii]]) > (kMinSeparation * indexRadius)))
+			{
+				usedList[usedCnt++]	=	neighborList[iii];
+			}
+		}
+		for (jjj=0; jjj<usedCnt; jjj++)
+		{
+			for (kkk=jjj+1; kkk<usedCnt; kkk++)
+			{
+				vertex[0]	=	starIdx;
+				vertex[1]	=	usedList[jjj];
+				vertex[2]	=	usedList[kkk];
+				if (CatalogTriangle(solveIndex, vertex, orderedVertex, &key2, &key3, &longSide))
+				{
+					buildList[buildCnt].bin	=	KeyToBin(key2, key3);
+					for (iii=0; iii<3; iii++)
+					{
+						buildList[buildCnt].triangle.starIdx[iii]	=	orderedVertex[iii];
+					}
+					buildCnt++;
+				}
+			}
+		}
+	}
+
+	//*	sort by bin and remove the triangles that were found from more than one star
+	qsort(buildList, buildCnt, sizeof(TYPE_BUILD_TRIANGLE), CompareBuildTriangle);
+	uniqueCnt	=	0;
+	for (iii=0; iii<buildCnt; iii++)
+	{
+		if ((uniqueCnt == 0) || (CompareBuildTriangle(&buildList[uniqueCnt - 1], &buildList[iii]) != 0))
+		{
+			buildList[uniqueCnt++]	=	buildList[iii];
+		}
+	}
+
+	solveIndex->header.binCount			=	kKeyBins * kKeyBins;
+	solveIndex->header.triangleCount	=	uniqueCnt;
+	solveIndex->binStart				=	(int32_t *)calloc(solveIndex->header.binCount + 1, sizeof(int32_t));
+	solveIndex->triangleList			=	(TYPE_SOLVE_TRIANGLE *)malloc((uniqueCnt + 1) * sizeof(TYPE_SOLVE_TRIANGLE));
+	if ((solveIndex->binStart == NULL) || (solveIndex->triangleList == NULL))
+	{
+		free(buildList);
+		return(false);
+	}
+	binIdx	=	0;
+	for (iii=0; iii<uniqueCnt; iii++)
+	{
+		while (binIdx <= buildList[iii].bin)
+		{
+			solveIndex->binStart[binIdx++]	=	iii;
+		}
+		solveIndex->triangleList[iii]	=	buildList[iii].triangle;
+	}
+	while (binIdx <= solveIndex->header.binCount)
+	{
+		solveIndex->binStart[binIdx++]	=	uniqueCnt;
+	}
+	free(buildList);
+	return(true);
+}
+
+//*****************************************************************************
+static void	ReleaseIndex(TYPE_SOLVE_INDEX *solveIndex)
+{
+	ReleaseSpatialHash(solveIndex);
+	free(solveIndex->starList);
+	free(solveIndex->binStart);
+	free(solveIndex->triangleList);
+	memset(solveIndex, 0, sizeof(TYPE_SOLVE_INDEX));
+}
+
+//*****************************************************************************
+static bool	ReadIndexFile(const char *indexPath, TYPE_SOLVE_INDEX *solveIndex, const TYPE_SOLVE_INDEX_HDR *expected)
+{
+FILE		*filePointer;
+bool		readOK;
+size_t		itemCnt;
+
+	readOK		=	false;
+	filePointer	=	fopen(indexPath, "r");
+	if (filePointer == NULL)
+	{
+		return(false);
+	}
+	itemCnt	=	fread(&solveIndex->header, sizeof(TYPE_SOLVE_INDEX_HDR), 1, filePointer);
+	if ((itemCnt == 1) &&
+		(memcmp(solveIndex->header.magic, expected->magic, 8) == 0) &&
+		(solveIndex->header.version == expected->version) &&
+		(solveIndex->header.radius_arcmin == expected->radius_arcmin) &&
+		(solveIndex->header.catalogSize == expected->catalogSize) &&
+		(solveIndex->header.catalogTime == expected->catalogTime) &&
+		(solveIndex->header.neighborCnt == expected->neighborCnt) &&
+		(solveIndex->header.binCount == (kKeyBins * kKeyBins)) &&
+		(solveIndex->header.starCount > 0))
+	{
+		solveIndex->starList		=	(TYPE_SOLVE_CATSTAR *)malloc(solveIndex->header.starCount * sizeof(TYPE_SOLVE_CATSTAR));
+		solveIndex->binStart		=	(int32_t *)malloc((solveIndex->header.binCount + 1) * sizeof(int32_t));
+		solveIndex->triangleList	=	(TYPE_SOLVE_TRIANGLE *)malloc((solveIndex->header.triangleCount + 1) * sizeof(TYPE_SOLVE_TRIANGLE));
+		if ((solveIndex->starList != NULL) && (solveIndex->binStart != NULL) && (solveIndex->triangleList != NULL))
+		{
+			readOK	=	(fread(solveIndex->starList, sizeof(TYPE_SOLVE_CATSTAR), solveIndex->header.starCount, filePointer)
+								== (size_t)solveIndex->header.starCount);
+			readOK	=	readOK && (fread(solveIndex->binStart, sizeof(int32_t), solveIndex->header.binCount + 1, filePointer)
+								== (size_t)(solveIndex->header.binCount + 1));
+			readOK	=	readOK && (fread(solveIndex->triangleList, sizeof(TYPE_SOLVE_TRIANGLE), solveIndex->header.triangleCount, filePointer)
+								== (size_t)solveIndex->header.triangleCount);
+		}
+	}
+	fclose(filePointer);
+	if (readOK == false)
+	{
+		ReleaseIndex(solveIndex);
+	}
+	return(readOK);
+}
+
+//*****************************************************************************
+static void	WriteIndexFile(const char *indexPath, const TYPE_SOLVE_INDEX *solveIndex)
+{
+FILE		*filePointer;
+
+	filePointer	=	fopen(indexPath, "w");
+	if (filePointer != NULL)
+	{
+		fwrite(&solveIndex->header,		sizeof(TYPE_SOLVE_INDEX_HDR),	1,									filePointer);
+		fwrite(solveIndex->starList,	sizeof(TYPE_SOLVE_CATSTAR),		solveIndex->header.starCount,		filePointer);
+		fwrite(solveIndex->binStart,	sizeof(int32_t),				solveIndex->header.binCount + 1,	filePointer);
+		fwrite(solveIndex->triangleList,sizeof(TYPE_SOLVE_TRIANGLE),	solveIndex->header.triangleCount,	filePointer);
+		fclose(filePointer);
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Failed to create", indexPath);
+	}
+}
+
+//*****************************************************************************
+//*	Hipparcos if we have it, otherwise the bright star catalog
+//*****************************************************************************
+static bool	FindCatalog(char *catalogPath, char *catalogName, bool *isHipparcos, struct stat *fileStatus)
+{
+	*isHipparcos	=	true;
+	strcpy(catalogName, "Hipparcos");
+	sprintf(catalogPath, "%s/hip_main.dat", kPlateSolveDataDir);
+	if (stat(catalogPath, fileStatus) != 0)
+	{
+		*isHipparcos	=	false;
+		strcpy(catalogName, "Yale");
+		sprintf(catalogPath, "%s/YALEcatalog.dat", kPlateSolveDataDir);
+		if (stat(catalogPath, fileStatus) != 0)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+//*****************************************************************************
+//*	loads the index for this radius from the cache, builds it if needed
+//*****************************************************************************
+static bool	LoadIndex(const double indexRadius_deg, char *errorMsg)
+{
+TYPE_SOLVE_INDEX_HDR	expected;
+TYPE_SOLVE_INDEX		newIndex;
+struct stat				fileStatus;
+char					catalogPath[256];
+char					indexPath[256];
+bool					isHipparcos;
+bool					indexOK;
+double					indexRadius;
+uint32_t				startMilliSecs;
+
+	memset(&expected, 0, sizeof(TYPE_SOLVE_INDEX_HDR));
+	memcpy(expected.magic, "ALPSOLVE", 8);		//*	not nul terminated
+	expected.version		=	kIndexVersion;
+	expected.radius_arcmin	=	(int32_t)((indexRadius_deg * 60.0) + 0.5);
+	expected.neighborCnt	=	kNeighborCnt;
+	if (expected.radius_arcmin < 5)
+	{
+		strcpy(errorMsg, "Field of view is too small");
+		return(false);
+	}
+	if (gSolveIndex.valid && (gSolveIndex.header.radius_arcmin == expected.radius_arcmin))
+	{
+		return(true);
+	}
+
+	if (FindCatalog(catalogPath, expected.catalogName, &isHipparcos, &fileStatus) == false)
+	{
+		strcpy(errorMsg, "No star catalog found");
+		return(false);
+	}
+	expected.catalogSize	=	fileStatus.st_size;
+	expected.catalogTime	=	fileStatus.st_mtime;
+	sprintf(indexPath, "%s/platesolve_%s_r%d.idx", kPlateSolveDataDir, expected.catalogName, expected.radius_arcmin);
+
+	startMilliSecs	=	millis();
+	indexRadius		=	(expected.radius_arcmin * PI) / (60.0 * 180.0);
+	memset(&newIndex, 0, sizeof(TYPE_SOLVE_INDEX));
+	indexOK			=	ReadIndexFile(indexPath, &newIndex, &expected);
+	if (indexOK)
+	{
+		indexOK	=	BuildSpatialHash(&newIndex, 2.0 * sin(indexRadius / 2.0));
+	}
+	else
+	{
+		CONSOLE_DEBUG_W_STR("Building plate solve index", indexPath);
+		newIndex.header				=	expected;
+		newIndex.header.starCount	=	ReadCatalog(catalogPath, isHipparcos, &newIndex.starList);
+		indexOK	=	(newIndex.header.starCount > 0);
+		indexOK	=	indexOK && BuildSpatialHash(&newIndex, 2.0 * sin(indexRadius / 2.0));
+		indexOK	=	indexOK && BuildTriangles(&newIndex, indexRadius);
+		if (indexOK)
+		{
+			WriteIndexFile(indexPath, &newIndex);
+		}
+	}
+	if (indexOK)
+	{
+		ReleaseIndex(&gSolveIndex);
+		gSolveIndex			=	newIndex;
+		gSolveIndex.valid	=	true;
+		CONSOLE_DEBUG_W_NUM("Plate solve stars    \t=", gSolveIndex.header.starCount);
+		CONSOLE_DEBUG_W_NUM("Plate solve triangles\t=", gSolveIndex.header.triangleCount);
+		CONSOLE_DEBUG_W_NUM("Plate solve index ms \t=", (millis() - startMilliSecs));
+	}
+	else
+	{
+		ReleaseIndex(&newIndex);
+		strcpy(errorMsg, "Failed to build the plate solve index");
+	}
+	return(indexOK);
+}
+
+//*****************************************************************************
+bool	PlateSolve_LoadIndex(const double indexRadius_deg, char *errorMsg)
+{
+bool	indexOK;
+
+	pthread_mutex_lock(&gSolveMutex);
+	indexOK	=	LoadIndex(indexRadius_deg, errorMsg);
+	pthread_mutex_unlock(&gSolveMutex);
+	return(indexOK);
+}
+
+//*****************************************************************************
+void	PlateSolve_ReleaseIndex(void)
+{
+	pthread_mutex_lock(&gSolveMutex);
+	ReleaseIndex(&gSolveIndex);
+	pthread_mutex_unlock(&gSolveMutex);
+}
+
+//*****************************************************************************
+//*	returns the catalog stars within radius of the center that are brighter than
+//*	limitMagnitude, the caller must free() the list.
+//*	This reads the whole catalog, it is meant for setting up a field, not for every frame
+//*****************************************************************************
+int	PlateSolve_ReadCatalogField(const double			ra_deg,
+								const double			dec_deg,
+								const double			radius_deg,
+								const double			limitMagnitude,
+								TYPE_PLATESOLVE_CATSTAR	**starListPtr,
+								char					*catalogName)
+{
+struct stat				fileStatus;
+char					catalogPath[256];
+bool					isHipparcos;
+TYPE_SOLVE_CATSTAR		*catalogList;
+TYPE_PLATESOLVE_CATSTAR	*fieldList;
+int						catalogCnt;
+int						fieldCnt;
+int						iii;
+double					centerVector[3];
+double					starVector[3];
+double					minDot;
+
+	*starListPtr	=	NULL;
+	catalogName[0]	=	0;
+	if (FindCatalog(catalogPath, catalogName, &isHipparcos, &fileStatus) == false)
+	{
+		catalogName[0]	=	0;
+		return(0);
+	}
+	catalogList	=	NULL;
+	catalogCnt	=	ReadCatalog(catalogPath, isHipparcos, &catalogList);
+	fieldCnt	=	0;
+	fieldList	=	NULL;
+	if ((catalogCnt > 0) && (catalogList != NULL))
+	{
+		fieldList	=	(TYPE_PLATESOLVE_CATSTAR *)malloc(catalogCnt * sizeof(TYPE_PLATESOLVE_CATSTAR));
+	}
+	if (fieldList != NULL)
+	{
+		RaDecToVector((ra_deg * PI) / 180.0, (dec_deg * PI) / 180.0, centerVector);
+		minDot	=	cos((radius_deg * PI) / 180.0);
+		for (iii=0; iii<catalogCnt; iii++)
+		{
+			if (catalogList[iii].magn <= limitMagnitude)
+			{
+				RaDecToVector(catalogList[iii].ra, catalogList[iii].decl, starVector);
+				if (((starVector[0] * centerVector[0]) +
+					(starVector[1] * centerVector[1]) +
+					(starVector[2] * centerVector[2])) >= minDot)
+				{
+					fieldList[fieldCnt].ra_deg		=	(catalogList[iii].ra * 180.0) / PI;
+					fieldList[fieldCnt].dec_deg		=	(catalogList[iii].decl * 180.0) / PI;
+					fieldList[fieldCnt].magnitude	=	catalogList[iii].magn;
+					fieldCnt++;
+				}
+			}
+		}
+	}
+	if (catalogList != NULL)
+	{
+		free(catalogList);
+	}
+	*starListPtr	=	fieldList;
+	return(fieldCnt);
+}
+
+//*****************************************************************************
+//*	builds the triangles of the brightest image stars, same rules as the catalog
+//*****************************************************************************
+static int	BuildImageTriangles(const TYPE_PLATESOLVE_STAR	*starList,
+								const int					starCount,
+								const double				neighborRadius,
+								TYPE_IMAGE_TRIANGLE			*triangleList,
+								const int					maxTriangles)
+{
+int		triangleCnt;
+int		usedList[kNeighborCnt];
+int		usedCnt;
+int		baseIdx;
+int		iii;
+int		jjj;
+int		vertex[3];
+double	deltaX;
+double	deltaY;
+double	distance;
+double	sides[3];
+
+	triangleCnt	=	0;
+	for (baseIdx=0; baseIdx<starCount; baseIdx++)
+	{
+		//*	the list is brightest first, so the first ones found are the brightest
+		usedCnt	=	0;
+		for (iii=0; (iii<starCount) && (usedCnt < kNeighborCnt); iii++)
+		{
+			if (iii != baseIdx)
+			{
+				deltaX		=	starList[iii].xPixel - starList[baseIdx].xPixel;
+				deltaY		=	starList[iii].yPixel - starList[baseIdx].yPixel;
+				distance	=	sqrt((deltaX * deltaX) + (deltaY * deltaY));
+				if ((distance <= neighborRadius) && (distance > (kMinSeparation * neighborRadius)))
+				{
+					usedList[usedCnt++]	=	iii;
+				}
+			}
+		}
+		for (iii=0; iii<usedCnt; iii++)
+		{
+			for (jjj=iii+1; (jjj<usedCnt) && (triangleCnt < maxTriangles); jjj++)
+			{
+				vertex[0]	=	baseIdx;
+				vertex[1]	=	usedList[iii];
+				vertex[2]	=	usedList[jjj];
+				sides[0]	=	hypot(starList[vertex[0]].xPixel - starList[vertex[1]].xPixel, starList[vertex[0]].yPixel - starList[vertex[1]].yPixel);
+				sides[1]	=	hypot(starList[vertex[0]].xPixel - starList[vertex[2]].xPixel, starList[vertex[0]].yPixel - starList[vertex[2]].yPixel);
+				sides[2]	=	hypot(starList[vertex[1]].xPixel - starList[vertex[2]].xPixel, starList[vertex[1]].yPixel - starList[vertex[2]].yPixel);
+				if (OrderTriangle(	vertex, sides[0], sides[1], sides[2],
+									triangleList[triangleCnt].starIdx,
+									&triangleList[triangleCnt].key2,
+									&triangleList[triangleCnt].key3,
+									&triangleList[triangleCnt].longSide))
+				{
+					triangleCnt++;
+				}
+			}
+		}
+	}
+	return(triangleCnt);
+}
+
+//*****************************************************************************
+//*	exact affine transform from 3 pairs of points
+//*****************************************************************************
+static bool	XformFrom3Points(const double pixelU[3], const double pixelV[3], const double xi[3], const double eta[3], TYPE_SOLVE_XFORM *xform)
+{
+double	matrix[3][3];
+double	vector[3];
+double	result[3];
+int		iii;
+
+	for (iii=0; iii<3; iii++)
+	{
+		matrix[iii][0]	=	pixelU[iii];
+		matrix[iii][1]	=	pixelV[iii];
+		matrix[iii][2]	=	1.0;
+		vector[iii]		=	xi[iii];
+	}
+	if (Solve3x3(matrix, vector, result) == false)
+	{
+		return(false);
+	}
+	xform->aaa	=	result[0];
+	xform->bbb	=	result[1];
+	xform->eee	=	result[2];
+	for (iii=0; iii<3; iii++)
+	{
+		matrix[iii][0]	=	pixelU[iii];
+		matrix[iii][1]	=	pixelV[iii];
+		matrix[iii][2]	=	1.0;
+		vector[iii]		=	eta[iii];
+	}
+	if (Solve3x3(matrix, vector, result) == false)
+	{
+		return(false);
+	}
+	xform->ccc	=	result[0];
+	xform->ddd	=	result[1];
+	xform->fff	=	result[2];
+	return(true);
+}
+
+//*****************************************************************************
+//*	the transform from the image to the sky has to be a rotation and a scale
+//*	(and possibly a mirror), returns the scale in radians per pixel, 0 if not
+//*****************************************************************************
+static double	XformScale(const TYPE_SOLVE_XFORM *xform)
+{
+double	scaleU;
+double	scaleV;
+
+	scaleU	=	hypot(xform->aaa, xform->ccc);
+	scaleV	=	hypot(xform->bbb, xform->ddd);
+	if ((scaleU <= 0.0) || (scaleV <= 0.0))
+	{
+		return(0.0);
+	}
+	if ((fabs(scaleU - scaleV) > (kSimilarityTol * scaleU)) ||
+		(fabs((xform->aaa * xform->bbb) + (xform->ccc * xform->ddd)) > (kSimilarityTol * scaleU * scaleV)))
+	{
+		return(0.0);
+	}
+	return((scaleU + scaleV) / 2.0);
+}
+
+//*****************************************************************************
+static bool	SkyToPixel(const TYPE_SOLVE_XFORM *xform, const double ra, const double decl, double *pixelU, double *pixelV)
+{
+double	xi;
+double	eta;
+double	determinant;
+
+	if (ProjectToTangent(xform->tangentRA, xform->tangentDecl, ra, decl, &xi, &eta) == false)
+	{
+		return(false);
+	}
+	xi			-=	xform->eee;
+	eta			-=	xform->fff;
+	determinant	=	(xform->aaa * xform->ddd) - (xform->bbb * xform->ccc);
+	*pixelU		=	((xform->ddd * xi) - (xform->bbb * eta)) / determinant;
+	*pixelV		=	((xform->aaa * eta) - (xform->ccc * xi)) / determinant;
+	return(true);
+}
+
+//*****************************************************************************
+//*	counts the catalog stars that land on image stars, the pairs are returned in
+//*	matchImage / matchCatalog if they are not NULL
+//*****************************************************************************
+static int	MatchStars(	const TYPE_PLATESOLVE_REQUEST	*request,
+						const TYPE_SOLVE_XFORM			*xform,
+						const double					tolerance,
+						int								*expectedCnt,
+						int								*matchImage,
+						int32_t							*matchCatalog)
+{
+int32_t		catalogList[kMaxCatStarsInFrame];
+int			catalogCnt;
+int			matchCnt;
+int			iii;
+int			jjj;
+int			closestIdx;
+double		centerRA;
+double		centerDecl;
+double		centerVector[3];
+double		halfWidth;
+double		halfHeight;
+double		radius;
+double		pixelU;
+double		pixelV;
+double		deltaU;
+double		deltaV;
+double		distance;
+double		closestDist;
+
+	halfWidth	=	request->imageWidth / 2.0;
+	halfHeight	=	request->imageHeight / 2.0;
+	radius		=	1.05 * hypot(halfWidth, halfHeight) * hypot(xform->aaa, xform->ccc);
+	TangentToRaDec(xform->tangentRA, xform->tangentDecl, xform->eee, xform->fff, &centerRA, &centerDecl);
+	RaDecToVector(centerRA, centerDecl, centerVector);
+	catalogCnt	=	FindStarsInRadius(&gSolveIndex, centerVector, radius, catalogList, kMaxCatStarsInFrame);
+
+	matchCnt		=	0;
+	*expectedCnt	=	0;
+	for (iii=0; iii<catalogCnt; iii++)
+	{
+		if (SkyToPixel(	xform,
+						gSolveIndex.starList[catalogList[iii]].ra,
+						gSolveIndex.starList[catalogList[iii]].decl,
+						&pixelU, &pixelV))
+		{
+			if ((fabs(pixelU) < halfWidth) && (fabs(pixelV) < halfHeight))
+			{
+				(*expectedCnt)++;
+				closestIdx	=	-1;
+				closestDist	=	tolerance;
+				for (jjj=0; jjj<request->starCount; jjj++)
+				{
+					deltaU		=	(request->starList[jjj].xPixel - halfWidth) - pixelU;
+					deltaV		=	(request->starList[jjj].yPixel - halfHeight) - pixelV;
+					if ((fabs(deltaU) < closestDist) && (fabs(deltaV) < closestDist))
+					{
+						distance	=	hypot(deltaU, deltaV);
+						if (distance < closestDist)
+						{
+							closestDist	=	distance;
+							closestIdx	=	jjj;
+						}
+					}
+				}
+				if (closestIdx >= 0)
+				{
+					if (matchImage != NULL)
+					{
+						matchImage[matchCnt]	=	closestIdx;
+						matchCatalog[matchCnt]	=	catalogList[iii];
+					}
+					matchCnt++;
+				}
+			}
+		}
+	}
+	return(matchCnt);
+}
+
+//*****************************************************************************
+//*	least squares fit of the matched stars, the tangent point is moved to the
+//*	center of the image
+//*****************************************************************************
+static bool	RefineXform(const TYPE_PLATESOLVE_REQUEST	*request,
+						TYPE_SOLVE_XFORM				*xform,
+						const int						*matchImage,
+						const int32_t					*matchCatalog,
+						const int						matchCnt,
+						double							*rmsError)
+{
+TYPE_SOLVE_XFORM	newXform;
+double				matrix[3][3];
+double				vectorXi[3];
+double				vectorEta[3];
+double				normal[3][3];
+double				result[3];
+double				xiList[kMaxCatStarsInFrame];
+double				etaList[kMaxCatStarsInFrame];
+double				pixelU;
+double				pixelV;
+double				deltaXi;
+double				deltaEta;
+double				sumSquares;
+int					validCnt;
+int					iii;
+int					jjj;
+int					kkk;
+
+	newXform	=	*xform;
+	TangentToRaDec(xform->tangentRA, xform->tangentDecl, xform->eee, xform->fff, &newXform.tangentRA, &newXform.tangentDecl);
+
+	memset(normal,		0,	sizeof(normal));
+	memset(vectorXi,	0,	sizeof(vectorXi));
+	memset(vectorEta,	0,	sizeof(vectorEta));
+	validCnt	=	0;
+	for (iii=0; iii<matchCnt; iii++)
+	{
+		if (ProjectToTangent(	newXform.tangentRA, newXform.tangentDecl,
+								gSolveIndex.starList[matchCatalog[iii]].ra,
+								gSolveIndex.starList[matchCatalog[iii]].decl,
+								&xiList[iii], &etaList[iii]))
+		{
+			pixelU	=	request->starList[matchImage[iii]].xPixel - (request->imageWidth / 2.0);
+			pixelV	=	request->starList[matchImage[iii]].yPixel - (request->imageHeight / 2.0);
+			result[0]	=	pixelU;
+			result[1]	=	pixelV;
+			result[2]	=	1.0;
+			for (jjj=0; jjj<3; jjj++)
+			{
+				for (kkk=0; kkk<3; kkk++)
+				{
+					normal[jjj][kkk]	+=	result[jjj] * result[kkk];
+				}
+				vectorXi[jjj]	+=	result[jjj] * xiList[iii];
+				vectorEta[jjj]	+=	result[jjj] * etaList[iii];
+			}
+			validCnt++;
+		}
+	}
+	if (validCnt < 3)
+	{
+		return(false);
+	}
+	memcpy(matrix, normal, sizeof(matrix));
+	if (Solve3x3(matrix, vectorXi, result) == false)
+	{
+		return(false);
+	}
+	newXform.aaa	=	result[0];
+	newXform.bbb	=	result[1];
+	newXform.eee	=	result[2];
+	memcpy(matrix, normal, sizeof(matrix));
+	if (Solve3x3(matrix, vectorEta, result) == false)
+	{
+		return(false);
+	}
+	newXform.ccc	=	result[0];
+	newXform.ddd	=	result[1];
+	newXform.fff	=	result[2];
+
+	sumSquares	=	0.0;
+	for (iii=0; iii<matchCnt; iii++)
+	{
+		pixelU		=	request->starList[matchImage[iii]].xPixel - (request->imageWidth / 2.0);
+		pixelV		=	request->starList[matchImage[iii]].yPixel - (request->imageHeight / 2.0);
+		deltaXi		=	(newXform.aaa * pixelU) + (newXform.bbb * pixelV) + newXform.eee - xiList[iii];
+		deltaEta	=	(newXform.ccc * pixelU) + (newXform.ddd * pixelV) + newXform.fff - etaList[iii];
+		sumSquares	+=	(deltaXi * deltaXi) + (deltaEta * deltaEta);
+	}
+	*rmsError	=	sqrt(sumSquares / validCnt);
+	*xform		=	newXform;
+	return(true);
+}
+
+//*****************************************************************************
+static void	FillResult(const TYPE_PLATESOLVE_REQUEST *request, const TYPE_SOLVE_XFORM *xform, TYPE_PLATESOLVE_RESULT *result)
+{
+double	centerRA;
+double	centerDecl;
+double	radToDeg;
+double	rotation;
+
+	radToDeg	=	180.0 / PI;
+	TangentToRaDec(xform->tangentRA, xform->tangentDecl, xform->eee, xform->fff, &centerRA, &centerDecl);
+	result->ra_deg				=	centerRA * radToDeg;
+	result->dec_deg				=	centerDecl * radToDeg;
+	//*	pixel (x,y) in the buffer is (x+1, y+1) in the FITS file
+	result->crpix1				=	(request->imageWidth / 2.0) + 1.0;
+	result->crpix2				=	(request->imageHeight / 2.0) + 1.0;
+	result->cd1_1				=	xform->aaa * radToDeg;
+	result->cd1_2				=	xform->bbb * radToDeg;
+	result->cd2_1				=	xform->ccc * radToDeg;
+	result->cd2_2				=	xform->ddd * radToDeg;
+	result->pixelScale_arcsec	=	sqrt(fabs((xform->aaa * xform->ddd) - (xform->bbb * xform->ccc))) * radToDeg * 3600.0;
+	//*	with east to the left when north is up, the determinant is negative
+	result->mirrored			=	(((xform->aaa * xform->ddd) - (xform->bbb * xform->ccc)) > 0.0);
+	rotation					=	atan2(xform->bbb, xform->ddd) * radToDeg;
+	if (rotation < 0.0)
+	{
+		rotation	+=	360.0;
+	}
+	result->rotation_deg		=	rotation;
+}
+
+//*****************************************************************************
+bool	PlateSolve_SolveImage(const TYPE_PLATESOLVE_REQUEST *request, TYPE_PLATESOLVE_RESULT *result)
+{
+TYPE_IMAGE_TRIANGLE		*imageTriangles;
+int						imageTriangleCnt;
+int						maxTriangles;
+int						brightCnt;
+int						triIdx;
+int						bin2;
+int						bin3;
+int						binIdx;
+int32_t					catTriIdx;
+int						vertex[3];
+int						catVertex[3];
+double					catKey2;
+double					catKey3;
+double					catLongSide;
+double					expectedScale;
+double					scaleTolerance;
+double					indexRadius;
+double					pixelU[3];
+double					pixelV[3];
+double					xiList[3];
+double					etaList[3];
+double					xformScale;
+double					tolerance;
+double					rmsError;
+TYPE_SOLVE_XFORM		xform;
+TYPE_SOLVE_XFORM		bestXform;
+int						bestMatchCnt;
+int						matchCnt;
+int						expectedCnt;
+int						*matchImage;
+int32_t					*matchCatalog;
+int						iii;
+int						loopCnt;
+uint32_t				startMilliSecs;
+bool					searchDone;
+const TYPE_PLATESOLVE_STAR	*imageStar;
+
+	memset(result, 0, sizeof(TYPE_PLATESOLVE_RESULT));
+	startMilliSecs	=	millis();
+	if ((request->starCount < kMinMatches) || (request->pixelScale_arcsec <= 0.0))
+	{
+		strcpy(result->errorMsg, (request->starCount < kMinMatches) ? "Not enough stars" : "Pixel scale is not known");
+		return(false);
+	}
+	expectedScale	=	(request->pixelScale_arcsec / 3600.0) * (PI / 180.0);
+	scaleTolerance	=	(request->scaleTolerance > 0.0) ? request->scaleTolerance : kPlateSolve_DefaultScaleTol;
+
+	//*	the index radius is half the short side of the image
+	indexRadius		=	0.5 * ((request->imageWidth < request->imageHeight) ? request->imageWidth : request->imageHeight);
+	indexRadius		*=	request->pixelScale_arcsec / 3600.0;
+
+	pthread_mutex_lock(&gSolveMutex);
+	if (LoadIndex(indexRadius, result->errorMsg) == false)
+	{
+		pthread_mutex_unlock(&gSolveMutex);
+		return(false);
+	}
+	strcpy(result->catalogName, gSolveIndex.header.catalogName);
+	//*	use the radius the index was built with
+	indexRadius		=	gSolveIndex.header.radius_arcmin / 60.0;
+
+	brightCnt		=	(request->starCount < kPlateSolve_MaxImageStars) ? request->starCount : kPlateSolve_MaxImageStars;
+	maxTriangles	=	brightCnt * ((kNeighborCnt * (kNeighborCnt - 1)) / 2);
+	imageTriangles	=	(TYPE_IMAGE_TRIANGLE *)malloc(maxTriangles * sizeof(TYPE_IMAGE_TRIANGLE));
+	matchImage		=	(int *)malloc(kMaxCatStarsInFrame * sizeof(int));
+	matchCatalog	=	(int32_t *)malloc(kMaxCatStarsInFrame * sizeof(int32_t));
+	if ((imageTriangles == NULL) || (matchImage == NULL) || (matchCatalog == NULL))
+	{
+		free(imageTriangles);
+		free(matchImage);
+		free(matchCatalog);
+		pthread_mutex_unlock(&gSolveMutex);
+		strcpy(result->errorMsg, "Out of memory");
+		return(false);
+	}
+	imageTriangleCnt	=	BuildImageTriangles(request->starList,
+												brightCnt,
+												(indexRadius * 3600.0) / request->pixelScale_arcsec,
+												imageTriangles,
+												maxTriangles);
+
+	//*	the tolerance for the first match has to allow for the error of a 3 star transform
+	tolerance		=	0.01 * hypot(request->imageWidth, request->imageHeight);
+	if (tolerance < 5.0)
+	{
+		tolerance	=	5.0;
+	}
+	bestMatchCnt	=	0;
+	searchDone		=	false;
+	memset(&bestXform, 0, sizeof(TYPE_SOLVE_XFORM));
+	for (triIdx=0; (triIdx<imageTriangleCnt) && (searchDone == false); triIdx++)
+	{
+		for (bin2=(int)(imageTriangles[triIdx].key2 * kKeyBins) - 1; bin2<=(int)(imageTriangles[triIdx].key2 * kKeyBins) + 1; bin2++)
+		{
+			for (bin3=(int)(imageTriangles[triIdx].key3 * kKeyBins) - 1; bin3<=(int)(imageTriangles[triIdx].key3 * kKeyBins) + 1; bin3++)
+			{
+				if ((bin2 < 0) || (bin2 >= kKeyBins) || (bin3 < 0) || (bin3 >= kKeyBins) || searchDone)
+				{
+					continue;
+				}
+				binIdx	=	(bin2 * kKeyBins) + bin3;
+				for (catTriIdx=gSolveIndex.binStart[binIdx]; catTriIdx<gSolveIndex.binStart[binIdx + 1]; catTriIdx++)
+				{
+					for (iii=0; iii<3; iii++)
+					{
+						vertex[iii]	=	gSolveIndex.triangleList[catTriIdx].starIdx[iii];
+					}
+					if (CatalogTriangle(&gSolveIndex, vertex, catVertex, &catKey2, &catKey3, &catLongSide) == false)
+					{
+						continue;
+					}
+					if ((fabs(catKey2 - imageTriangles[triIdx].key2) > kKeyTolerance) ||
+						(fabs(catKey3 - imageTriangles[triIdx].key3) > kKeyTolerance) ||
+						(fabs((catLongSide / imageTriangles[triIdx].longSide) - expectedScale) > (scaleTolerance * expectedScale)))
+					{
+						continue;
+					}
+
+					//*	transform from the image to the tangent plane at the first vertex
+					xform.tangentRA		=	gSolveIndex.starList[catVertex[0]].ra;
+					xform.tangentDecl	=	gSolveIndex.starList[catVertex[0]].decl;
+					for (iii=0; iii<3; iii++)
+					{
+						imageStar	=	&request->starList[imageTriangles[triIdx].starIdx[iii]];
+						pixelU[iii]	=	imageStar->xPixel - (request->imageWidth / 2.0);
+						pixelV[iii]	=	imageStar->yPixel - (request->imageHeight / 2.0);
+						ProjectToTangent(	xform.tangentRA, xform.tangentDecl,
+											gSolveIndex.starList[catVertex[iii]].ra,
+											gSolveIndex.starList[catVertex[iii]].decl,
+											&xiList[iii], &etaList[iii]);
+					}
+					if (XformFrom3Points(pixelU, pixelV, xiList, etaList, &xform) == false)
+					{
+						continue;
+					}
+					xformScale	=	XformScale(&xform);
+					if ((xformScale <= 0.0) || (fabs(xformScale - expectedScale) > (scaleTolerance * expectedScale)))
+					{
+						continue;
+					}
+
+					matchCnt	=	MatchStars(request, &xform, tolerance, &expectedCnt, NULL, NULL);
+					//*	the image may go deeper or less deep than the catalog
+					if (expectedCnt > request->starCount)
+					{
+						expectedCnt	=	request->starCount;
+					}
+					if ((matchCnt >= kMinMatches) &&
+						(matchCnt >= (kMinMatchFraction * expectedCnt)) &&
+						(matchCnt > bestMatchCnt))
+					{
+						bestMatchCnt	=	matchCnt;
+						bestXform		=	xform;
+						//*	this is clearly the right answer, no need to keep looking
+						if ((matchCnt >= (2 * kMinMatches)) && (matchCnt >= (0.6 * expectedCnt)))
+						{
+							searchDone	=	true;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (bestMatchCnt > 0)
+	{
+		//*	refine with all of the matched stars, tightening the tolerance each time
+		xform		=	bestXform;
+		rmsError	=	0.0;
+		for (loopCnt=0; loopCnt<4; loopCnt++)
+		{
+			matchCnt	=	MatchStars(request, &xform, tolerance, &expectedCnt, matchImage, matchCatalog);
+			if ((matchCnt < kMinMatches) || (RefineXform(request, &xform, matchImage, matchCatalog, matchCnt, &rmsError) == false))
+			{
+				break;
+			}
+			result->matchCount	=	matchCnt;
+			tolerance			=	3.0 * (rmsError / hypot(xform.aaa, xform.ccc));
+			if (tolerance < 2.0)
+			{
+				tolerance	=	2.0;
+			}
+		}
+		if (result->matchCount >= kMinMatches)
+		{
+			FillResult(request, &xform, result);
+			result->rmsError_arcsec	=	rmsError * (180.0 / PI) * 3600.0;
+			result->solved			=	true;
+		}
+	}
+	if (result->solved == false)
+	{
+		strcpy(result->errorMsg, "No match found");
+	}
+	pthread_mutex_unlock(&gSolveMutex);
+
+	free(imageTriangles);
+	free(matchImage);
+	free(matchCatalog);
+	result->solveTime_ms	=	millis() - startMilliSecs;
+	return(result->solved);
+}
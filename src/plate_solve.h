@@ -0,0 +1,92 @@
+//*****************************************************************************
+//#include	"plate_solve.h"
+
+#ifndef _PLATE_SOLVE_H_
+#define	_PLATE_SOLVE_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+//*	the catalogs are the same ones used by SkyTravel (kSkyTravelDataDirectory)
+#define	kPlateSolveDataDir			"skytravel_data"
+#define	kPlateSolve_MaxImageStars	64			//*	brightest image stars used for matching
+#define	kPlateSolve_DefaultScaleTol	0.10		//*	pixel scale tolerance, fraction
+
+//*****************************************************************************
+typedef struct	//	TYPE_PLATESOLVE_STAR
+{
+	double		xPixel;
+	double		yPixel;
+	double		flux;
+} TYPE_PLATESOLVE_STAR;
+
+//*****************************************************************************
+typedef struct	//	TYPE_PLATESOLVE_REQUEST
+{
+	const TYPE_PLATESOLVE_STAR	*starList;			//*	brightest first
+	int							starCount;
+	int							imageWidth;
+	int							imageHeight;
+	double						pixelScale_arcsec;	//*	expected pixel scale
+	double						scaleTolerance;		//*	fraction, 0 = default
+} TYPE_PLATESOLVE_REQUEST;
+
+//*****************************************************************************
+//*	the WCS is the FITS TAN projection, CRPIX is 1 based
+typedef struct	//	TYPE_PLATESOLVE_RESULT
+{
+	bool		solved;
+	double		ra_deg;					//*	center of the image, J2000
+	double		dec_deg;
+	double		rotation_deg;			//*	position angle of image +Y, east of north
+	double		pixelScale_arcsec;
+	bool		mirrored;
+	double		crpix1;
+	double		crpix2;
+	double		cd1_1;					//*	degrees per pixel
+	double		cd1_2;
+	double		cd2_1;
+	double		cd2_2;
+	int			matchCount;
+	double		rmsError_arcsec;
+	uint32_t	solveTime_ms;
+	char		catalogName[32];
+	char		errorMsg[80];
+} TYPE_PLATESOLVE_RESULT;
+
+//*****************************************************************************
+typedef struct	//	TYPE_PLATESOLVE_CATSTAR
+{
+	double		ra_deg;
+	double		dec_deg;
+	double		magnitude;
+} TYPE_PLATESOLVE_CATSTAR;
+
+bool	PlateSolve_LoadIndex(const double indexRadius_deg, char *errorMsg);
+bool	PlateSolve_SolveImage(const TYPE_PLATESOLVE_REQUEST *request, TYPE_PLATESOLVE_RESULT *result);
+void	PlateSolve_ReleaseIndex(void);
+
+//*	catalogName is "Hipparcos" or "Yale", empty if there is no catalog
+int		PlateSolve_ReadCatalogField(const double			ra_deg,
+									const double			dec_deg,
+									const double			radius_deg,
+									const double			limitMagnitude,
+									TYPE_PLATESOLVE_CATSTAR	**starListPtr,
+									char					*catalogName);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _PLATE_SOLVE_H_
@@ -38,6 +38,9 @@
 //*	Sep  4,	2021	<MLS> Added microsecs arg to SetSocketTimeouts()
 //*	Sep  8,	2021	<MLS> Added "Connection: close" as per suggestion from Patrick Chevalley
 //*	Dec 14,	2021	<MLS> Added imagebytes option to OpenSocketAndSendRequest()
+//*	Oct 19,	2026	<MLS> imagebytes option now also accepts AlpacaPi packed data
+//*	Oct 19,	2026	<MLS> imagebytes option now also accepts AlpacaPi compressed data
+//*	Oct 19,	2026	<MLS> Added OpenSocketAndSendRequest_Range() to resume downloads
 //*****************************************************************************
 
 #include	<stdio.h>
@@ -119,6 +122,29 @@ int	OpenSocketAndSendRequest(	struct sockaddr_in	*deviceAddress,
 								const char			*sendData,
 								const char			*dataString,
 								const bool			includeImageBinary)
+{
+	return(OpenSocketAndSendRequest_Range(	deviceAddress,
+											port,
+											get_put_string,
+											sendData,
+											dataString,
+											includeImageBinary,
+											0,
+											NULL));
+}
+
+//*****************************************************************************
+//*	returns a socket description
+//*	firstByte > 0 adds a "Range:" header line to get the rest of the data
+//*****************************************************************************
+int	OpenSocketAndSendRequest_Range(	struct sockaddr_in	*deviceAddress,
+									const int			port,
+									const char			*get_put_string,	//*	must be either GET or PUT
+									const char			*sendData,
+									const char			*dataString,
+									const bool			includeImageBinary,
+									const long			firstByte,
+									const char			*entityTag)
 {
 int					socket_desc;
 struct sockaddr_in	remoteDev;
@@ -186,8 +212,24 @@ int					so_oobinline;
 			if (includeImageBinary)
 			{
 				strcat(xmitBuffer,	",application/imagebytes");
+				//*	AlpacaPi extension, packed 12/14 bit RAW16 data, see alpaca_defs.h
+				strcat(xmitBuffer,	",application/imagebytes-packed");
+			#ifdef _ENABLE_IMAGEBYTES_DEFLATE_
+				//*	AlpacaPi extension, lossless compressed data, see alpaca_defs.h
+				strcat(xmitBuffer,	",application/imagebytes-deflate");
+			#endif
 			}
 			strcat(xmitBuffer,	"\r\n");
+			if (firstByte > 0)
+			{
+				sprintf(linebuf,	"Range: bytes=%ld-\r\n", firstByte);
+				strcat(xmitBuffer,	linebuf);
+				if ((entityTag != NULL) && (strlen(entityTag) < 80))
+				{
+					sprintf(linebuf,	"If-Range: %s\r\n", entityTag);
+					strcat(xmitBuffer,	linebuf);
+				}
+			}
 
 			strcat(xmitBuffer,	"Connection: close\r\n");
 //			strcat(xmitBuffer,	"Accept: application/json, text/json, text/x-json, text/javascript, application/xml, text/xml\r\n");
@@ -38,6 +38,18 @@ int		OpenSocketAndSendRequest(	struct sockaddr_in	*deviceAddress,
 									const char			*dataString,
 									const bool			includeImageBinary);
 
+//*	same, but asks for the data starting at firstByte (Range: bytes=firstByte-)
+//*	if entityTag is not NULL it is sent as If-Range, so the server sends
+//*	everything again if the data has changed
+int		OpenSocketAndSendRequest_Range(	struct sockaddr_in	*deviceAddress,
+										const int			port,
+										const char			*get_put_string,
+										const char			*sendData,
+										const char			*dataString,
+										const bool			includeImageBinary,
+										const long			firstByte,
+										const char			*entityTag);
+
 extern	char		gUserAgentAlpacaPiStr[];
 
 #ifdef __cplusplus
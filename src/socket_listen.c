@@ -26,6 +26,9 @@
 //*	Feb 10,	2021	<MLS> Reduced timeout to 2500 (micro-secs)
 //*	Dec  3,	2022	<MLS> Added ipAddressString to SendDataToSocket()
 //*	Jan  8,	2024	<MLS> Added _SHOW_HTTP_DATA_
+//*	Oct 19,	2026	<MLS> Added SocketListen_DetachSocket() for streaming responses
+//*	Oct 19,	2026	<MLS> SendDataToSocket() keeps reading until the request is complete
+//*	Oct 19,	2026	<MLS> SendDataToSocket() no longer overflows htmlBuffer on long requests
 //*****************************************************************************
 
 #define	_SHOW_HTTP_DATA_
@@ -36,6 +39,7 @@
 
 //*****************************************************************************
 #include	<stdlib.h>
+#include	<stdbool.h>
 #include	<string.h>
 #include	<strings.h>
 #include	<unistd.h>
@@ -45,6 +49,7 @@
 #include	<sys/socket.h>
 #include	<netinet/in.h>
 #include	<arpa/inet.h>
+#include	<time.h>
 
 
 #ifdef _BANDWIDTH_
@@ -57,12 +62,14 @@
 #include	"socket_listen.h"
 
 #define		kTimeOut_MicroSecs	2500
+#define		kRequestTimeOut_ms	1500		//*	to get the rest of a request that is slow to arrive
 
 SocketData_Callback			gSocketCallbackProcPtr		=	NULL;
 
 //*****************************************************************************
 //*	globals so we can make this code non-blocking
 static	int		gSocketFD;		//*	socket File Descriptor
+static	bool	gSocketDetached;	//*	set by SocketListen_DetachSocket() during the callback
 
 void SendDataToSocket(const int sock, const char *ipAddressString);
 
@@ -119,6 +126,14 @@ void	SocketListen_SetCallback(SocketData_Callback callBackPtr)
 
 
 
+//*****************************************************************************
+//*	the current connection has been handed off (i.e. a stream that stays open)
+//*****************************************************************************
+void	SocketListen_DetachSocket(void)
+{
+	gSocketDetached	=	true;
+}
+
 //*****************************************************************************
 int SocketListen_Poll(void)
 {
@@ -142,7 +157,13 @@ char				ipAddrString[64];
 #endif // _SHOW_HTTP_DATA_
 	if (newsockfd >= 0)
 	{
+		gSocketDetached	=	false;
 		SendDataToSocket(newsockfd, ipAddrString);
+		if (gSocketDetached)
+		{
+			//*	whoever took it over will close it
+			return(0);
+		}
 
 		shutDownRetCode	=	shutdown(newsockfd, SHUT_RDWR);
 		if (shutDownRetCode != 0)
@@ -284,11 +305,57 @@ int				setOptRetCode;
 
 #else
 
+//*****************************************************************************
+static uint32_t	GetElapsed_ms(struct timespec *startTime)
+{
+struct timespec	currentTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &currentTime);
+	return(((currentTime.tv_sec - startTime->tv_sec) * 1000) +
+			((currentTime.tv_nsec - startTime->tv_nsec) / 1000000));
+}
+
+//*****************************************************************************
+//*	returns true if all of the request is in the buffer,
+//*	the header has to be complete and if there is a Content-Length, the body as well
+//*****************************************************************************
+static bool	IsRequestComplete(const char *htmlBuffer, const int htmlLen)
+{
+const char	*headerEnd;
+const char	*lengthPtr;
+int			contentLength;
+
+	headerEnd	=	strstr(htmlBuffer, "\r\n\r\n");
+	if (headerEnd == NULL)
+	{
+		return(false);
+	}
+	lengthPtr	=	strchr(htmlBuffer, '\n');
+	while ((lengthPtr != NULL) && (lengthPtr < headerEnd))
+	{
+		lengthPtr++;
+		if (strncasecmp(lengthPtr, "Content-Length:", 15) == 0)
+		{
+			contentLength	=	atoi(lengthPtr + 15);
+			if ((htmlLen - ((headerEnd + 4) - htmlBuffer)) < contentLength)
+			{
+				return(false);
+			}
+		}
+		lengthPtr	=	strchr(lengthPtr, '\n');
+	}
+	return(true);
+}
+
 //*****************************************************************************
 //*	SendDataToSocket()
 //*		There is a separate instance of this function
 //*		for each connection.  It handles all communication
 //*		once a connection has been established.
+//*
+//*		The short read timeout keeps the normal case fast, but on a slow link
+//*		(WiFi) the request can arrive in pieces. If the request is not complete
+//*		when the read times out, keep waiting for up to kRequestTimeOut_ms.
 //*****************************************************************************
 void SendDataToSocket(const int sock, const char *ipAddressString)
 {
@@ -297,7 +364,10 @@ int				bytesRead;
 //int			resultsMsgLen;
 char			readBuffer[kReadBuffLen];
 char			htmlBuffer[kReadBuffLen];
+int				htmlLen;
+bool			keepReading;
 struct timeval	timeoutLength;
+struct timespec	startTime;
 int				setOptRetCode;
 
 //	CONSOLE_DEBUG(__FUNCTION__);
@@ -318,20 +388,35 @@ int				setOptRetCode;
 		CONSOLE_DEBUG_W_NUM("setsockopt() returned", setOptRetCode);
 	}
 
-	do
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	htmlLen		=	0;
+	keepReading	=	true;
+	while (keepReading && (htmlLen < (kReadBuffLen - 2)))
 	{
-		bytesRead	=	read(sock, readBuffer, (kReadBuffLen - 2));
+		bytesRead	=	read(sock, readBuffer, ((kReadBuffLen - 2) - htmlLen));
 //		CONSOLE_DEBUG_W_NUM("bytesRead=", bytesRead);
 		if (bytesRead > 0)
 		{
-			readBuffer[bytesRead]	=	0;
-			strcat(htmlBuffer, readBuffer);
+			memcpy(&htmlBuffer[htmlLen], readBuffer, bytesRead);
+			htmlLen				+=	bytesRead;
+			htmlBuffer[htmlLen]	=	0;
 		}
-		else if (bytesRead < 0)
+		else if ((bytesRead < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
 		{
+			//*	timed out, only keep waiting if there is more to come
+			if (IsRequestComplete(htmlBuffer, htmlLen) || (GetElapsed_ms(&startTime) > kRequestTimeOut_ms))
+			{
+				keepReading	=	false;
+			}
+		}
+		else
+		{
+			//*	closed by the other end or an error
 		//	error("ERROR reading from socket");
+			keepReading	=	false;
 		}
-	} while (bytesRead > 0);
+	}
+	bytesRead	=	htmlLen;
 
 #ifdef _FIX_ESCAPE_CHARS_
 //	CONSOLE_DEBUG_W_NUM("bytesRead=", bytesRead);
@@ -9,6 +9,7 @@
 //*	<MLS>	=	Mark L Sproul
 //*****************************************************************************
 //*	Feb 14,	2019	<MLS> Created socket_listen.h
+//*	Oct 19,	2026	<MLS> Added SocketListen_DetachSocket()
 //*****************************************************************************
 
 
@@ -25,6 +26,10 @@ int		SocketListen_Init(const int listenPortNum);
 int		SocketListen_Poll(void);
 void	SocketListen_SetCallback(SocketData_Callback callBackPtr);
 
+//*	called from the callback when something else has taken over the socket,
+//*	the listener will not shut it down or close it
+void	SocketListen_DetachSocket(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1014 @@
+//*****************************************************************************
+//*	Name:			star_analysis.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Star detection and measurement
+//*
+//*					1)	the background and noise are estimated on a coarse grid
+//*						from a sub sample of each cell (median & MAD)
+//*					2)	each row is scanned for runs of pixels above the threshold
+//*						of its cell, the scan uses the SIMD kernels and runs in row bands
+//*					3)	the runs are joined into connected components (8 connected)
+//*					4)	the components that look like stars are measured,
+//*						centroid, flux, HFR, FWHM (second moments) and eccentricity
+//*
+//*					Only the runs and the components are touched after the scan,
+//*					so the cost is mostly one pass over the image
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created star_analysis.c
+//*	Oct 19,	2026	<MLS> Added _INCLUDE_STAR_ANALYSIS_MAIN_ self test, make startest
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<math.h>
+
+//#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"helper_functions.h"
+#include	"image_kernels.h"
+#include	"star_analysis.h"
+
+#define	kGridCellSize			64		//*	background grid, pixels
+#define	kGridSampleStep			4		//*	every 4th pixel of every 4th row is sampled
+#define	kMinStarPixels			3
+#define	kMaxStarSize			64		//*	components bigger than this are not stars
+#define	kEdgeMargin				4
+#define	kMaxMeasureRadius		32
+#define	kMaxRunsPerBand			(1024 * 1024)
+
+//*****************************************************************************
+typedef struct	//	TYPE_STAR_RUN
+{
+	int		row;
+	int		xStart;
+	int		xEnd;		//*	inclusive
+	int		parent;		//*	union find
+} TYPE_STAR_RUN;
+
+//*****************************************************************************
+typedef struct	//	TYPE_RUN_BAND
+{
+	int				firstRow;
+	int				runCnt;
+	int				allocCnt;
+	bool			overflow;
+	TYPE_STAR_RUN	*runList;
+} TYPE_RUN_BAND;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STAR_BLOB
+{
+	int		pixelCnt;
+	int		xMin;
+	int		xMax;
+	int		yMin;
+	int		yMax;
+	int		peakX;
+	int		peakY;
+	float	peakValue;
+	float	flux;
+} TYPE_STAR_BLOB;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STAR_CONTEXT
+{
+	const TYPE_STAR_IMAGE	*starImage;
+	int						gridCols;
+	int						gridRows;
+	float					*cellBackground;
+	float					*cellNoise;
+	uint32_t				*cellThreshold;
+
+	TYPE_RUN_BAND			bandList[kImageKernel_MaxThreads];
+	int						bandCnt;
+
+	TYPE_STAR_BLOB			*blobList;
+	TYPE_STAR_RESULTS		*results;
+} TYPE_STAR_CONTEXT;
+
+//*****************************************************************************
+static inline uint32_t	StarPixel(const TYPE_STAR_IMAGE *starImage, int xxx, int yyy)
+{
+long	valueIndex;
+
+	valueIndex	=	((((long)yyy * starImage->width) + xxx) * starImage->valuesPerPixel) + starImage->channel;
+	if (starImage->bytesPerValue == 2)
+	{
+		return(((const uint16_t *)starImage->imageData)[valueIndex]);
+	}
+	return(starImage->imageData[valueIndex]);
+}
+
+//*****************************************************************************
+//*	quick select, the list is re-ordered
+//*****************************************************************************
+static uint32_t	SelectNth(uint32_t *valueList, int valueCnt, int nth)
+{
+int			left;
+int			right;
+int			iii;
+int			jjj;
+uint32_t	pivot;
+uint32_t	temp;
+
+	left	=	0;
+	right	=	valueCnt - 1;
+	while (left < right)
+	{
+		pivot	=	valueList[(left + right) / 2];
+		iii		=	left;
+		jjj		=	right;
+		while (iii <= jjj)
+		{
+			while (valueList[iii] < pivot)
+			{
+				iii++;
+			}
+			while (valueList[jjj] > pivot)
+			{
+				jjj--;
+			}
+			if (iii <= jjj)
+			{
+				temp			=	valueList[iii];
+				valueList[iii]	=	valueList[jjj];
+				valueList[jjj]	=	temp;
+				iii++;
+				jjj--;
+			}
+		}
+		if (nth <= jjj)
+		{
+			right	=	jjj;
+		}
+		else if (nth >= iii)
+		{
+			left	=	iii;
+		}
+		else
+		{
+			break;
+		}
+	}
+	return(valueList[nth]);
+}
+
+//*****************************************************************************
+static int	CompareFloat(const void *ptr1, const void *ptr2)
+{
+float	value1	=	*((const float *)ptr1);
+float	value2	=	*((const float *)ptr2);
+
+	if (value1 < value2)
+	{
+		return(-1);
+	}
+	return((value1 > value2) ? 1 : 0);
+}
+
+//*****************************************************************************
+//*	brightest first
+static int	CompareBlobFlux(const void *ptr1, const void *ptr2)
+{
+float	flux1	=	((const TYPE_STAR_BLOB *)ptr1)->flux;
+float	flux2	=	((const TYPE_STAR_BLOB *)ptr2)->flux;
+
+	if (flux1 > flux2)
+	{
+		return(-1);
+	}
+	return((flux1 < flux2) ? 1 : 0);
+}
+
+//*****************************************************************************
+static double	MedianOfFloats(float *valueList, int valueCnt)
+{
+	if (valueCnt <= 0)
+	{
+		return(0.0);
+	}
+	qsort(valueList, valueCnt, sizeof(float), CompareFloat);
+	if (valueCnt & 0x01)
+	{
+		return(valueList[valueCnt / 2]);
+	}
+	return((valueList[(valueCnt / 2) - 1] + valueList[valueCnt / 2]) / 2.0);
+}
+
+//*****************************************************************************
+//*	background grid, this band proc does the cells that start in its rows
+//*****************************************************************************
+static void	StarAnalysis_GridBandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_STAR_CONTEXT		*starContext;
+const TYPE_STAR_IMAGE	*starImage;
+uint32_t				sampleList[(kGridCellSize / kGridSampleStep) * (kGridCellSize / kGridSampleStep)];
+uint32_t				medianValue;
+uint32_t				madValue;
+double					thresholdValue;
+int						sampleCnt;
+int						cellX;
+int						cellY;
+int						cellIndex;
+int						xxx;
+int						yyy;
+int						iii;
+
+	starContext	=	(TYPE_STAR_CONTEXT *)context;
+	starImage	=	starContext->starImage;
+	for (cellY = (firstRow + kGridCellSize - 1) / kGridCellSize; (cellY * kGridCellSize) < lastRow; cellY++)
+	{
+		for (cellX = 0; cellX < starContext->gridCols; cellX++)
+		{
+			sampleCnt	=	0;
+			for (yyy = (cellY * kGridCellSize); (yyy < ((cellY + 1) * kGridCellSize)) && (yyy < starImage->height); yyy += kGridSampleStep)
+			{
+				for (xxx = (cellX * kGridCellSize); (xxx < ((cellX + 1) * kGridCellSize)) && (xxx < starImage->width); xxx += kGridSampleStep)
+				{
+					sampleList[sampleCnt++]	=	StarPixel(starImage, xxx, yyy);
+				}
+			}
+			medianValue	=	SelectNth(sampleList, sampleCnt, sampleCnt / 2);
+			for (iii=0; iii<sampleCnt; iii++)
+			{
+				sampleList[iii]	=	(sampleList[iii] > medianValue) ? (sampleList[iii] - medianValue) : (medianValue - sampleList[iii]);
+			}
+			madValue	=	SelectNth(sampleList, sampleCnt, sampleCnt / 2);
+
+			cellIndex	=	(cellY * starContext->gridCols) + cellX;
+			starContext->cellBackground[cellIndex]	=	medianValue;
+			starContext->cellNoise[cellIndex]		=	1.4826 * madValue;
+			if (starContext->cellNoise[cellIndex] < 1.0)
+			{
+				starContext->cellNoise[cellIndex]	=	1.0;
+			}
+			thresholdValue	=	medianValue + (starImage->sigmaThreshold * starContext->cellNoise[cellIndex]);
+			if (thresholdValue >= starImage->saturationValue)
+			{
+				thresholdValue	=	starImage->saturationValue - 1;
+			}
+			starContext->cellThreshold[cellIndex]	=	thresholdValue;
+		}
+	}
+}
+
+//*****************************************************************************
+static void	StarAnalysis_AddRun(TYPE_RUN_BAND *runBand, int row, int xStart, int xEnd)
+{
+TYPE_STAR_RUN	*newList;
+int				newAllocCnt;
+
+	if (runBand->runCnt >= runBand->allocCnt)
+	{
+		if (runBand->allocCnt >= kMaxRunsPerBand)
+		{
+			runBand->overflow	=	true;
+			return;
+		}
+		newAllocCnt	=	(runBand->allocCnt > 0) ? (runBand->allocCnt * 2) : 4096;
+		newList		=	(TYPE_STAR_RUN *)realloc(runBand->runList, newAllocCnt * sizeof(TYPE_STAR_RUN));
+		if (newList == NULL)
+		{
+			runBand->overflow	=	true;
+			return;
+		}
+		runBand->runList	=	newList;
+		runBand->allocCnt	=	newAllocCnt;
+	}
+	runBand->runList[runBand->runCnt].row		=	row;
+	runBand->runList[runBand->runCnt].xStart	=	xStart;
+	runBand->runList[runBand->runCnt].xEnd		=	xEnd;
+	runBand->runList[runBand->runCnt].parent	=	-1;
+	runBand->runCnt++;
+}
+
+//*****************************************************************************
+//*	finds the runs of pixels above the threshold, each band has its own run list
+//*****************************************************************************
+static void	StarAnalysis_ScanBandProc(void *context, int firstRow, int lastRow)
+{
+TYPE_STAR_CONTEXT		*starContext;
+const TYPE_STAR_IMAGE	*starImage;
+TYPE_RUN_BAND			*runBand;
+const uint32_t			*rowThresholds;
+int						bandIndex;
+int						xxx;
+int						yyy;
+int						xStart;
+int						segmentEnd;
+long					rowOffset;
+
+	starContext	=	(TYPE_STAR_CONTEXT *)context;
+	starImage	=	starContext->starImage;
+	bandIndex	=	__sync_fetch_and_add(&starContext->bandCnt, 1);
+	runBand		=	&starContext->bandList[bandIndex];
+	runBand->firstRow	=	firstRow;
+
+	for (yyy=firstRow; (yyy < lastRow) && (runBand->overflow == false); yyy++)
+	{
+		rowThresholds	=	&starContext->cellThreshold[(yyy / kGridCellSize) * starContext->gridCols];
+		rowOffset		=	(long)yyy * starImage->width;
+		xxx				=	0;
+		while (xxx < starImage->width)
+		{
+			//*	skip the background one grid cell at a time
+			segmentEnd	=	((xxx / kGridCellSize) + 1) * kGridCellSize;
+			if (segmentEnd > starImage->width)
+			{
+				segmentEnd	=	starImage->width;
+			}
+			if (starImage->valuesPerPixel != 1)
+			{
+				while ((xxx < segmentEnd) && (StarPixel(starImage, xxx, yyy) <= rowThresholds[xxx / kGridCellSize]))
+				{
+					xxx++;
+				}
+			}
+			else if (starImage->bytesPerValue == 2)
+			{
+				xxx	+=	ImageKernel_ScanAbove_U16(	((const uint16_t *)starImage->imageData) + rowOffset + xxx,
+													(segmentEnd - xxx),
+													rowThresholds[xxx / kGridCellSize]);
+			}
+			else
+			{
+				xxx	+=	ImageKernel_ScanAbove_U8(	starImage->imageData + rowOffset + xxx,
+													(segmentEnd - xxx),
+													rowThresholds[xxx / kGridCellSize]);
+			}
+			if (xxx >= segmentEnd)
+			{
+				continue;
+			}
+			//*	a run may cross into the next cell
+			xStart	=	xxx;
+			while ((xxx < starImage->width) && (StarPixel(starImage, xxx, yyy) > rowThresholds[xxx / kGridCellSize]))
+			{
+				xxx++;
+			}
+			StarAnalysis_AddRun(runBand, yyy, xStart, (xxx - 1));
+		}
+	}
+}
+
+//*****************************************************************************
+static int	FindRoot(TYPE_STAR_RUN *runList, int runIndex)
+{
+int		rootIndex;
+int		nextIndex;
+
+	rootIndex	=	runIndex;
+	while (runList[rootIndex].parent >= 0)
+	{
+		rootIndex	=	runList[rootIndex].parent;
+	}
+	//*	path compression
+	while (runList[runIndex].parent >= 0)
+	{
+		nextIndex					=	runList[runIndex].parent;
+		runList[runIndex].parent	=	rootIndex;
+		runIndex					=	nextIndex;
+	}
+	return(rootIndex);
+}
+
+//*****************************************************************************
+static void	UnionRuns(TYPE_STAR_RUN *runList, int runIndex1, int runIndex2)
+{
+int		root1;
+int		root2;
+
+	root1	=	FindRoot(runList, runIndex1);
+	root2	=	FindRoot(runList, runIndex2);
+	if (root1 < root2)
+	{
+		runList[root2].parent	=	root1;
+	}
+	else if (root2 < root1)
+	{
+		runList[root1].parent	=	root2;
+	}
+}
+
+//*****************************************************************************
+//*	measures the blobs in this range, rows are blob indexes
+//*****************************************************************************
+static void	StarAnalysis_MeasureBandProc(void *context, int firstBlob, int lastBlob)
+{
+TYPE_STAR_CONTEXT		*starContext;
+const TYPE_STAR_IMAGE	*starImage;
+TYPE_STAR_BLOB			*blob;
+TYPE_STAR_INFO			*starInfo;
+int						blobIndex;
+int						radius;
+int						xxx;
+int						yyy;
+int						xMin;
+int						xMax;
+int						yMin;
+int						yMax;
+int						cellIndex;
+double					background;
+double					pixValue;
+double					sumValue;
+double					sumX;
+double					sumY;
+double					xCenter;
+double					yCenter;
+double					deltaX;
+double					deltaY;
+double					distSqrd;
+double					radiusSqrd;
+double					sumRadius;
+double					momentXX;
+double					momentYY;
+double					momentXY;
+double					halfTrace;
+double					halfDiff;
+double					majorAxis;
+double					minorAxis;
+
+	starContext	=	(TYPE_STAR_CONTEXT *)context;
+	starImage	=	starContext->starImage;
+	for (blobIndex=firstBlob; blobIndex<lastBlob; blobIndex++)
+	{
+		blob		=	&starContext->blobList[blobIndex];
+		starInfo	=	&starContext->results->starList[blobIndex];
+		cellIndex	=	((blob->peakY / kGridCellSize) * starContext->gridCols) + (blob->peakX / kGridCellSize);
+		background	=	starContext->cellBackground[cellIndex];
+
+		radius		=	((blob->xMax - blob->xMin) > (blob->yMax - blob->yMin)) ? (blob->xMax - blob->xMin) : (blob->yMax - blob->yMin);
+		radius		+=	3;
+		if (radius > kMaxMeasureRadius)
+		{
+			radius	=	kMaxMeasureRadius;
+		}
+		radiusSqrd	=	radius * radius;
+		xMin		=	(blob->peakX > radius) ? (blob->peakX - radius) : 0;
+		yMin		=	(blob->peakY > radius) ? (blob->peakY - radius) : 0;
+		xMax		=	((blob->peakX + radius) < starImage->width) ? (blob->peakX + radius) : (starImage->width - 1);
+		yMax		=	((blob->peakY + radius) < starImage->height) ? (blob->peakY + radius) : (starImage->height - 1);
+
+		//*	first pass, centroid
+		sumValue	=	0.0;
+		sumX		=	0.0;
+		sumY		=	0.0;
+		for (yyy=yMin; yyy<=yMax; yyy++)
+		{
+			for (xxx=xMin; xxx<=xMax; xxx++)
+			{
+				pixValue	=	StarPixel(starImage, xxx, yyy) - background;
+				if (pixValue > 0.0)
+				{
+					sumValue	+=	pixValue;
+					sumX		+=	pixValue * xxx;
+					sumY		+=	pixValue * yyy;
+				}
+			}
+		}
+		if (sumValue <= 0.0)
+		{
+			continue;
+		}
+		xCenter	=	sumX / sumValue;
+		yCenter	=	sumY / sumValue;
+
+		//*	second pass, HFR and moments inside the circle around the centroid
+		sumValue	=	0.0;
+		sumRadius	=	0.0;
+		momentXX	=	0.0;
+		momentYY	=	0.0;
+		momentXY	=	0.0;
+		for (yyy=yMin; yyy<=yMax; yyy++)
+		{
+			deltaY	=	yyy - yCenter;
+			for (xxx=xMin; xxx<=xMax; xxx++)
+			{
+				deltaX		=	xxx - xCenter;
+				distSqrd	=	(deltaX * deltaX) + (deltaY * deltaY);
+				if (distSqrd > radiusSqrd)
+				{
+					continue;
+				}
+				//*	negative values are kept so the noise averages out
+				pixValue	=	StarPixel(starImage, xxx, yyy) - background;
+				sumValue	+=	pixValue;
+				sumRadius	+=	pixValue * sqrt(distSqrd);
+				momentXX	+=	pixValue * deltaX * deltaX;
+				momentYY	+=	pixValue * deltaY * deltaY;
+				momentXY	+=	pixValue * deltaX * deltaY;
+			}
+		}
+		if (sumValue <= 0.0)
+		{
+			continue;
+		}
+		momentXX	/=	sumValue;
+		momentYY	/=	sumValue;
+		momentXY	/=	sumValue;
+		halfTrace	=	(momentXX + momentYY) / 2.0;
+		halfDiff	=	(momentXX - momentYY) / 2.0;
+		majorAxis	=	halfTrace + sqrt((halfDiff * halfDiff) + (momentXY * momentXY));
+		minorAxis	=	halfTrace - sqrt((halfDiff * halfDiff) + (momentXY * momentXY));
+		if (minorAxis < 0.0)
+		{
+			minorAxis	=	0.0;
+		}
+
+		starInfo->xCenter		=	xCenter;
+		starInfo->yCenter		=	yCenter;
+		starInfo->flux			=	sumValue;
+		starInfo->peak			=	blob->peakValue - background;
+		starInfo->background	=	background;
+		starInfo->hfr			=	sumRadius / sumValue;
+		//*	FWHM of a gaussian with the same second moments
+		starInfo->fwhm			=	2.3548 * sqrt(halfTrace);
+		starInfo->eccentricity	=	(majorAxis > 0.0) ? sqrt(1.0 - (minorAxis / majorAxis)) : 0.0;
+		starInfo->pixelCnt		=	blob->pixelCnt;
+		starInfo->saturated		=	(blob->peakValue >= starImage->saturationValue);
+	}
+}
+
+//*****************************************************************************
+bool	StarAnalysis_ProcessImage(const TYPE_STAR_IMAGE *starImage, TYPE_STAR_RESULTS *results)
+{
+TYPE_STAR_CONTEXT	starContext;
+TYPE_RUN_BAND		tempBand;
+TYPE_STAR_RUN		*runList;
+int					*blobIndexList;
+float				*medianList;
+TYPE_STAR_BLOB		*blob;
+int					totalRuns;
+int					cellCount;
+int					runIndex;
+int					rowStart;
+int					prevStart;
+int					prevEnd;
+int					prevIndex;
+int					matchIndex;
+int					rootIndex;
+int					blobCnt;
+int					goodCnt;
+int					medianCnt;
+int					xxx;
+int					iii;
+int					jjj;
+float				pixValue;
+float				background;
+uint32_t			startMilliSecs;
+bool				overflow;
+
+	if ((starImage == NULL) || (results == NULL) || (starImage->imageData == NULL) ||
+		(starImage->width < kGridCellSize) || (starImage->height < kGridCellSize))
+	{
+		return(false);
+	}
+	startMilliSecs	=	millis();
+	memset(results, 0, sizeof(TYPE_STAR_RESULTS));
+	memset(&starContext, 0, sizeof(TYPE_STAR_CONTEXT));
+	starContext.starImage	=	starImage;
+	starContext.results		=	results;
+	starContext.gridCols	=	(starImage->width + kGridCellSize - 1) / kGridCellSize;
+	starContext.gridRows	=	(starImage->height + kGridCellSize - 1) / kGridCellSize;
+	cellCount				=	starContext.gridCols * starContext.gridRows;
+
+	starContext.cellBackground	=	(float *)malloc(cellCount * sizeof(float));
+	starContext.cellNoise		=	(float *)malloc(cellCount * sizeof(float));
+	starContext.cellThreshold	=	(uint32_t *)malloc(cellCount * sizeof(uint32_t));
+	if ((starContext.cellBackground == NULL) || (starContext.cellNoise == NULL) || (starContext.cellThreshold == NULL))
+	{
+		DISPOSEPTR_IF_INUSE(starContext.cellBackground);
+		DISPOSEPTR_IF_INUSE(starContext.cellNoise);
+		DISPOSEPTR_IF_INUSE(starContext.cellThreshold);
+		return(false);
+	}
+
+	//*	1)	background
+	ImageKernel_RunRowBands(starImage->height, StarAnalysis_GridBandProc, &starContext);
+	medianList	=	(float *)malloc(cellCount * sizeof(float));
+	if (medianList != NULL)
+	{
+		memcpy(medianList, starContext.cellBackground, (cellCount * sizeof(float)));
+		results->backgroundLevel	=	MedianOfFloats(medianList, cellCount);
+		memcpy(medianList, starContext.cellNoise, (cellCount * sizeof(float)));
+		results->noiseSigma			=	MedianOfFloats(medianList, cellCount);
+		DISPOSEPTR_IF_INUSE(medianList);
+	}
+
+	//*	2)	runs above the threshold
+	ImageKernel_RunRowBands(starImage->height, StarAnalysis_ScanBandProc, &starContext);
+
+	//*	the bands finish in any order, put them back in row order and join them
+	for (iii=1; iii<starContext.bandCnt; iii++)
+	{
+		tempBand	=	starContext.bandList[iii];
+		jjj			=	iii - 1;
+		while ((jjj >= 0) && (starContext.bandList[jjj].firstRow > tempBand.firstRow))
+		{
+			starContext.bandList[jjj + 1]	=	starContext.bandList[jjj];
+			jjj--;
+		}
+		starContext.bandList[jjj + 1]	=	tempBand;
+	}
+	totalRuns	=	0;
+	overflow	=	false;
+	for (iii=0; iii<starContext.bandCnt; iii++)
+	{
+		totalRuns	+=	starContext.bandList[iii].runCnt;
+		overflow	|=	starContext.bandList[iii].overflow;
+	}
+	runList			=	NULL;
+	blobIndexList	=	NULL;
+	if ((totalRuns > 0) && (overflow == false))
+	{
+		runList			=	(TYPE_STAR_RUN *)malloc(totalRuns * sizeof(TYPE_STAR_RUN));
+		blobIndexList	=	(int *)malloc(totalRuns * sizeof(int));
+	}
+	if ((runList != NULL) && (blobIndexList != NULL))
+	{
+		runIndex	=	0;
+		for (iii=0; iii<starContext.bandCnt; iii++)
+		{
+			memcpy(&runList[runIndex], starContext.bandList[iii].runList, (starContext.bandList[iii].runCnt * sizeof(TYPE_STAR_RUN)));
+			runIndex	+=	starContext.bandList[iii].runCnt;
+		}
+	}
+	for (iii=0; iii<starContext.bandCnt; iii++)
+	{
+		DISPOSEPTR_IF_INUSE(starContext.bandList[iii].runList);
+	}
+
+	if ((runList != NULL) && (blobIndexList != NULL))
+	{
+		//*	3)	connected components, the runs are in row order and left to right within the row
+		prevStart	=	0;
+		prevEnd		=	0;
+		runIndex	=	0;
+		while (runIndex < totalRuns)
+		{
+			rowStart	=	runIndex;
+			while ((runIndex < totalRuns) && (runList[runIndex].row == runList[rowStart].row))
+			{
+				runIndex++;
+			}
+			if ((prevEnd > prevStart) && (runList[prevStart].row == (runList[rowStart].row - 1)))
+			{
+				prevIndex	=	prevStart;
+				for (iii=rowStart; iii<runIndex; iii++)
+				{
+					while ((prevIndex < prevEnd) && ((runList[prevIndex].xEnd + 1) < runList[iii].xStart))
+					{
+						prevIndex++;
+					}
+					matchIndex	=	prevIndex;
+					while ((matchIndex < prevEnd) && (runList[matchIndex].xStart <= (runList[iii].xEnd + 1)))
+					{
+						UnionRuns(runList, matchIndex, iii);
+						matchIndex++;
+					}
+				}
+			}
+			prevStart	=	rowStart;
+			prevEnd		=	runIndex;
+		}
+
+		//*	collect the component statistics
+		starContext.blobList	=	(TYPE_STAR_BLOB *)malloc(totalRuns * sizeof(TYPE_STAR_BLOB));
+		blobCnt					=	0;
+		if (starContext.blobList != NULL)
+		{
+			for (iii=0; iii<totalRuns; iii++)
+			{
+				rootIndex	=	FindRoot(runList, iii);
+				if (rootIndex == iii)
+				{
+					blobIndexList[iii]	=	blobCnt;
+					blob				=	&starContext.blobList[blobCnt];
+					memset(blob, 0, sizeof(TYPE_STAR_BLOB));
+					blob->xMin			=	runList[iii].xStart;
+					blob->xMax			=	runList[iii].xEnd;
+					blob->yMin			=	runList[iii].row;
+					blob->yMax			=	runList[iii].row;
+					blobCnt++;
+				}
+				//*	roots always come before their children
+				blob	=	&starContext.blobList[blobIndexList[rootIndex]];
+				background	=	starContext.cellBackground[((runList[iii].row / kGridCellSize) * starContext.gridCols) +
+																(runList[iii].xStart / kGridCellSize)];
+				for (xxx=runList[iii].xStart; xxx<=runList[iii].xEnd; xxx++)
+				{
+					pixValue	=	StarPixel(starImage, xxx, runList[iii].row);
+					blob->flux	+=	pixValue - background;
+					if (pixValue > blob->peakValue)
+					{
+						blob->peakValue	=	pixValue;
+						blob->peakX		=	xxx;
+						blob->peakY		=	runList[iii].row;
+					}
+				}
+				blob->pixelCnt	+=	(runList[iii].xEnd - runList[iii].xStart) + 1;
+				if (runList[iii].xStart < blob->xMin)	blob->xMin	=	runList[iii].xStart;
+				if (runList[iii].xEnd > blob->xMax)		blob->xMax	=	runList[iii].xEnd;
+				if (runList[iii].row > blob->yMax)		blob->yMax	=	runList[iii].row;
+			}
+			results->blobCount	=	blobCnt;
+
+			//*	keep the ones that look like stars
+			goodCnt	=	0;
+			for (iii=0; iii<blobCnt; iii++)
+			{
+				blob	=	&starContext.blobList[iii];
+				if ((blob->pixelCnt >= kMinStarPixels) &&
+					((blob->xMax - blob->xMin) < kMaxStarSize) &&
+					((blob->yMax - blob->yMin) < kMaxStarSize) &&
+					(blob->xMin >= kEdgeMargin) &&
+					(blob->yMin >= kEdgeMargin) &&
+					(blob->xMax < (starImage->width - kEdgeMargin)) &&
+					(blob->yMax < (starImage->height - kEdgeMargin)))
+				{
+					starContext.blobList[goodCnt++]	=	*blob;
+				}
+			}
+			qsort(starContext.blobList, goodCnt, sizeof(TYPE_STAR_BLOB), CompareBlobFlux);
+			if (goodCnt > kStarAnalysis_MaxStars)
+			{
+				goodCnt	=	kStarAnalysis_MaxStars;
+			}
+			results->starCount	=	goodCnt;
+
+			//*	4)	measure them
+			ImageKernel_RunRowBands(goodCnt, StarAnalysis_MeasureBandProc, &starContext);
+			DISPOSEPTR_IF_INUSE(starContext.blobList);
+		}
+	}
+	DISPOSEPTR_IF_INUSE(runList);
+	DISPOSEPTR_IF_INUSE(blobIndexList);
+	DISPOSEPTR_IF_INUSE(starContext.cellBackground);
+	DISPOSEPTR_IF_INUSE(starContext.cellNoise);
+	DISPOSEPTR_IF_INUSE(starContext.cellThreshold);
+
+	//*	medians of the unsaturated stars
+	medianList	=	(float *)malloc(kStarAnalysis_MaxStars * sizeof(float));
+	if ((medianList != NULL) && (results->starCount > 0))
+	{
+		medianCnt	=	0;
+		for (iii=0; iii<results->starCount; iii++)
+		{
+			if (results->starList[iii].saturated)
+			{
+				results->saturatedCount++;
+			}
+			else if (results->starList[iii].hfr > 0.0)
+			{
+				medianList[medianCnt++]	=	results->starList[iii].hfr;
+			}
+		}
+		results->medianHFR	=	MedianOfFloats(medianList, medianCnt);
+
+		medianCnt	=	0;
+		for (iii=0; iii<results->starCount; iii++)
+		{
+			if ((results->starList[iii].saturated == false) && (results->starList[iii].hfr > 0.0))
+			{
+				medianList[medianCnt++]	=	results->starList[iii].fwhm;
+			}
+		}
+		results->medianFWHM	=	MedianOfFloats(medianList, medianCnt);
+
+		medianCnt	=	0;
+		for (iii=0; iii<results->starCount; iii++)
+		{
+			if ((results->starList[iii].saturated == false) && (results->starList[iii].hfr > 0.0))
+			{
+				medianList[medianCnt++]	=	results->starList[iii].eccentricity;
+			}
+		}
+		results->medianEccentricity	=	MedianOfFloats(medianList, medianCnt);
+	}
+	DISPOSEPTR_IF_INUSE(medianList);
+
+	results->valid			=	true;
+	results->processTime_ms	=	millis() - startMilliSecs;
+	return(true);
+}
+
+#ifdef _INCLUDE_STAR_ANALYSIS_MAIN_
+//*****************************************************************************
+//*	self test on synthetic star fields
+//*	make startest
+//*****************************************************************************
+
+#define	kTestWidth		6224
+#define	kTestHeight		4168
+#define	kTestStarCnt	800
+
+static float	gTestStarX[kTestStarCnt];
+static float	gTestStarY[kTestStarCnt];
+
+//*****************************************************************************
+static double	GaussNoise(void)
+{
+double	uu;
+double	vv;
+
+	uu	=	(rand() + 1.0) / (RAND_MAX + 2.0);
+	vv	=	(rand() + 1.0) / (RAND_MAX + 2.0);
+	return(sqrt(-2.0 * log(uu)) * cos(2.0 * M_PI * vv));
+}
+
+//*****************************************************************************
+//*	RAW16 field, background 1000, noise sigma 20, 800 gaussian stars with sub pixel positions.
+//*	elongation stretches the stars in x, peakMax > 65535 gives saturated stars
+//*****************************************************************************
+static void	MakeStarField(uint16_t *imageData, const double starSigma, const double elongation, const int peakMax)
+{
+long	ii;
+int		starNum;
+int		xxx;
+int		yyy;
+double	peakValue;
+double	deltaX;
+double	deltaY;
+double	pixValue;
+
+	srand(5);
+	for (ii=0; ii<((long)kTestWidth * kTestHeight); ii++)
+	{
+		pixValue		=	1000.0 + (20.0 * GaussNoise());
+		imageData[ii]	=	(pixValue < 0.0) ? 0 : pixValue;
+	}
+	for (starNum=0; starNum<kTestStarCnt; starNum++)
+	{
+		//*	one star in each cell of a 40 x 20 grid so they do not blend
+		gTestStarX[starNum]	=	50 + ((starNum % 40) * ((kTestWidth - 100) / 40)) + (rand() % 100) + ((rand() % 100) / 100.0);
+		gTestStarY[starNum]	=	50 + ((starNum / 40) * ((kTestHeight - 100) / 20)) + (rand() % 100) + ((rand() % 100) / 100.0);
+		peakValue			=	300 + (rand() % (peakMax - 300));
+		for (yyy=(int)gTestStarY[starNum] - 15; yyy<=(gTestStarY[starNum] + 15); yyy++)
+		{
+			for (xxx=(int)gTestStarX[starNum] - 15; xxx<=(gTestStarX[starNum] + 15); xxx++)
+			{
+				deltaX		=	(xxx - gTestStarX[starNum]) / elongation;
+				deltaY		=	yyy - gTestStarY[starNum];
+				ii			=	((long)yyy * kTestWidth) + xxx;
+				pixValue	=	imageData[ii] + (peakValue * exp(-((deltaX * deltaX) + (deltaY * deltaY)) / (2.0 * starSigma * starSigma)));
+				imageData[ii]	=	(pixValue > 65535.0) ? 65535 : pixValue;
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//*	distance from a detected star to the closest star that was put in the field
+//*****************************************************************************
+static double	ClosestTestStar(const TYPE_STAR_INFO *starInfo)
+{
+int		starNum;
+double	distance;
+double	closest;
+
+	closest	=	1.0e9;
+	for (starNum=0; starNum<kTestStarCnt; starNum++)
+	{
+		distance	=	hypot((starInfo->xCenter - gTestStarX[starNum]), (starInfo->yCenter - gTestStarY[starNum]));
+		if (distance < closest)
+		{
+			closest	=	distance;
+		}
+	}
+	return(closest);
+}
+
+//*****************************************************************************
+static int	Test_StarField(	uint16_t	*imageData,
+							const char	*title,
+							const double	starSigma,
+							const double	elongation,
+							const int		peakMax,
+							const double	expectedEccentricity)
+{
+TYPE_STAR_IMAGE				starImage;
+static TYPE_STAR_RESULTS	results;
+double						expectedFWHM;
+double						worstCentroid;
+double						distance;
+int							starNum;
+int							errorCnt;
+
+	MakeStarField(imageData, starSigma, elongation, peakMax);
+	memset(&starImage, 0, sizeof(starImage));
+	starImage.imageData			=	(const unsigned char *)imageData;
+	starImage.width				=	kTestWidth;
+	starImage.height			=	kTestHeight;
+	starImage.bytesPerValue		=	2;
+	starImage.valuesPerPixel	=	1;
+	starImage.channel			=	0;
+	starImage.saturationValue	=	65535;
+	starImage.sigmaThreshold	=	kStarAnalysis_DefaultSigma;
+
+	errorCnt	=	0;
+	if (StarAnalysis_ProcessImage(&starImage, &results) == false)
+	{
+		printf("%s: StarAnalysis_ProcessImage() failed\r\n", title);
+		return(1);
+	}
+	//*	for elongated stars the FWHM is the geometric mean of the two axes
+	expectedFWHM	=	2.0 * sqrt(2.0 * log(2.0)) * starSigma * sqrt(elongation);
+	worstCentroid	=	0.0;
+	for (starNum=0; starNum<results.starCount; starNum++)
+	{
+		if (results.starList[starNum].saturated == false)
+		{
+			distance	=	ClosestTestStar(&results.starList[starNum]);
+			if (distance > worstCentroid)
+			{
+				worstCentroid	=	distance;
+			}
+		}
+	}
+	printf("%-18s stars=%d blobs=%d saturated=%d FWHM=%.3f (%.3f) HFR=%.3f ecc=%.3f (%.2f) centroid=%.3f px, %u ms\r\n",
+			title,
+			results.starCount,
+			results.blobCount,
+			results.saturatedCount,
+			results.medianFWHM,
+			expectedFWHM,
+			results.medianHFR,
+			results.medianEccentricity,
+			expectedEccentricity,
+			worstCentroid,
+			results.processTime_ms);
+
+	if (results.starCount != kStarAnalysis_MaxStars)
+	{
+		printf("%s: only %d stars found\r\n", title, results.starCount);
+		errorCnt++;
+	}
+	if ((elongation == 1.0) && (fabs(results.medianFWHM - expectedFWHM) > (0.05 * expectedFWHM)))
+	{
+		printf("%s: FWHM is more than 5%% off\r\n", title);
+		errorCnt++;
+	}
+	if (fabs(results.medianEccentricity - expectedEccentricity) > 0.15)
+	{
+		printf("%s: eccentricity is wrong\r\n", title);
+		errorCnt++;
+	}
+	if (worstCentroid > 0.25)
+	{
+		printf("%s: a centroid is %.2f pixels from any star\r\n", title, worstCentroid);
+		errorCnt++;
+	}
+	if ((peakMax > 65535) && (results.saturatedCount == 0))
+	{
+		printf("%s: no saturated stars were reported\r\n", title);
+		errorCnt++;
+	}
+	return(errorCnt);
+}
+
+//*****************************************************************************
+int	main(void)
+{
+uint16_t	*imageData;
+int			errorCnt;
+
+	imageData	=	(uint16_t *)malloc((long)kTestWidth * kTestHeight * sizeof(uint16_t));
+	if (imageData == NULL)
+	{
+		printf("Out of memory\r\n");
+		return(1);
+	}
+	errorCnt	=	0;
+	//*	noise gives round stars an eccentricity of about 0.25
+	errorCnt	+=	Test_StarField(imageData, "sigma 1.5",			1.5, 1.0, 20300, 0.25);
+	errorCnt	+=	Test_StarField(imageData, "sigma 2.5",			2.5, 1.0, 20300, 0.25);
+	errorCnt	+=	Test_StarField(imageData, "sigma 1.5 x 1.6",	1.5, 1.6, 20300, sqrt(1.0 - (1.0 / (1.6 * 1.6))));
+	errorCnt	+=	Test_StarField(imageData, "saturated",			2.0, 1.0, 120000, 0.25);
+	free(imageData);
+
+	printf("%d errors\r\n", errorCnt);
+	return((errorCnt == 0) ? 0 : 1);
+}
+#endif	//	_INCLUDE_STAR_ANALYSIS_MAIN_
@@ -0,0 +1,76 @@
+//*****************************************************************************
+//#include	"star_analysis.h"
+
+#ifndef _STAR_ANALYSIS_H_
+#define	_STAR_ANALYSIS_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#define	kStarAnalysis_MaxStars		512
+#define	kStarAnalysis_DefaultSigma	5.0
+
+//*****************************************************************************
+//*	description of the image to be analyzed
+//*	for RGB24, valuesPerPixel is 3 and channel selects which color is used
+typedef struct	//	TYPE_STAR_IMAGE
+{
+	const unsigned char	*imageData;
+	int					width;
+	int					height;
+	int					bytesPerValue;		//*	1 or 2
+	int					valuesPerPixel;		//*	1 or 3
+	int					channel;
+	uint32_t			saturationValue;
+	double				sigmaThreshold;		//*	detection threshold above the background noise
+} TYPE_STAR_IMAGE;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STAR_INFO
+{
+	float		xCenter;
+	float		yCenter;
+	float		flux;				//*	background subtracted
+	float		peak;				//*	background subtracted
+	float		background;
+	float		hfr;				//*	half flux radius, pixels
+	float		fwhm;				//*	pixels
+	float		eccentricity;		//*	0 = round
+	int			pixelCnt;			//*	pixels above the threshold
+	bool		saturated;
+} TYPE_STAR_INFO;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STAR_RESULTS
+{
+	bool			valid;
+	int				starCount;			//*	stars in starList
+	int				blobCount;			//*	connected components above the threshold
+	int				saturatedCount;
+	double			medianHFR;			//*	saturated stars are not included
+	double			medianFWHM;
+	double			medianEccentricity;
+	double			backgroundLevel;
+	double			noiseSigma;
+	uint32_t		processTime_ms;
+	TYPE_STAR_INFO	starList[kStarAnalysis_MaxStars];	//*	brightest first
+} TYPE_STAR_RESULTS;
+
+bool	StarAnalysis_ProcessImage(const TYPE_STAR_IMAGE *starImage, TYPE_STAR_RESULTS *results);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _STAR_ANALYSIS_H_
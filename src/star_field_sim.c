@@ -0,0 +1,615 @@
+//*****************************************************************************
+//*	Name:			star_field_sim.c
+//*
+//*	Author:			Mark Sproul (C) 2026
+//*
+//*	Description:	Renders simulated star fields for the camera simulator
+//*
+//*					The stars come from the same catalogs the plate solver uses,
+//*					projected (TAN) onto the sensor at the requested RA/Dec,
+//*					rotation and pixel scale, so the frames plate solve back
+//*					to the settings. Stars fainter than the catalog goes are
+//*					filled in at random positions with a typical star count
+//*					per magnitude so narrow fields are not empty.
+//*
+//*					Each frame has
+//*						a Gaussian PSF with the FWHM set by the seeing,
+//*						integrated over each pixel
+//*						sky background
+//*						shot noise (Poisson) and read noise
+//*						hot pixels, always in the same place, scaled by the exposure
+//*						RGGB Bayer response if enabled
+//*						tracking drift, the field moves a fixed amount each frame
+//*
+//*					The noise is seeded from the frame number, the same settings
+//*					and frame number always give the same frame, so benchmark runs
+//*					can be repeated.
+//*****************************************************************************
+//*	AlpacaPi is an open source project written in C/C++
+//*
+//*	Use of this source code for private or individual use is granted
+//*	Use of this source code, in whole or in part for commercial purpose requires
+//*	written agreement in advance.
+//*
+//*	You may use or modify this source code in any way you find useful, provided
+//*	that you agree that the author(s) have no warranty, obligations or liability.  You
+//*	must determine the suitability of this source code for your use.
+//*
+//*	Redistributions of this source code must retain this copyright notice.
+//*****************************************************************************
+//*	Edit History
+//*****************************************************************************
+//*	<MLS>	=	Mark L Sproul
+//*****************************************************************************
+//*	Oct 19,	2026	<MLS> Created star_field_sim.c
+//*****************************************************************************
+
+#include	<stdlib.h>
+#include	<stdbool.h>
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<math.h>
+
+#define _ENABLE_CONSOLE_DEBUG_
+#include	"ConsoleDebug.h"
+
+#include	"image_kernels.h"
+#include	"plate_solve.h"
+#include	"star_field_sim.h"
+
+#ifndef PI
+	#define	PI	3.14159265358979323846
+#endif
+
+#define	kHipparcosDepth		9.0		//*	faintest magnitude where the catalog is close to complete
+#define	kYaleDepth			6.5
+#define	kStarDensity6		0.12	//*	stars per square degree brighter than magnitude 6
+#define	kStarDensitySlope	0.46	//*	log10 of the increase per magnitude
+#define	kPSFradiusSigma		4.0		//*	PSF is rendered out to this many sigma
+#define	kMaxPSFradius		64
+
+//*****************************************************************************
+//*	Bayer response, RGGB, the sky glow is a little red
+static const float	gSkyChannelGain[4]	=	{	0.80,	1.00,	1.00,	0.70	};
+
+//*****************************************************************************
+typedef struct	//	TYPE_RENDER_CONTEXT
+{
+	const TYPE_STARFIELD	*starField;
+	const float				*electronBuf;
+	uint16_t				*frameBuffer;
+	int						frameNumber;
+} TYPE_RENDER_CONTEXT;
+
+//*****************************************************************************
+//*	splitmix64, good enough for noise and fast
+//*****************************************************************************
+static uint64_t	RandomNext(uint64_t *state)
+{
+uint64_t	zzz;
+
+	*state	+=	0x9E3779B97F4A7C15ull;
+	zzz		=	*state;
+	zzz		=	(zzz ^ (zzz >> 30)) * 0xBF58476D1CE4E5B9ull;
+	zzz		=	(zzz ^ (zzz >> 27)) * 0x94D049BB133111EBull;
+	return(zzz ^ (zzz >> 31));
+}
+
+//*****************************************************************************
+//*	0.0 < value < 1.0
+//*****************************************************************************
+static double	RandomUniform(uint64_t *state)
+{
+	return(((RandomNext(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0));
+}
+
+//*****************************************************************************
+//*	Box-Muller, the second value is not kept so the sequence only depends on the seed
+//*****************************************************************************
+static double	RandomGaussian(uint64_t *state)
+{
+double	uuu;
+double	vvv;
+
+	uuu	=	RandomUniform(state);
+	vvv	=	RandomUniform(state);
+	return(sqrt(-2.0 * log(uuu)) * cos(2.0 * PI * vvv));
+}
+
+//*****************************************************************************
+//*	small means are done exactly, large ones with the normal approximation
+//*****************************************************************************
+static double	RandomPoisson(uint64_t *state, const double mean)
+{
+double	limit;
+double	product;
+int		count;
+
+	if (mean <= 0.0)
+	{
+		return(0.0);
+	}
+	if (mean > 30.0)
+	{
+		return(floor(mean + (sqrt(mean) * RandomGaussian(state)) + 0.5));
+	}
+	limit	=	exp(-mean);
+	product	=	RandomUniform(state);
+	count	=	0;
+	while (product > limit)
+	{
+		product	*=	RandomUniform(state);
+		count++;
+	}
+	return(count);
+}
+
+//*****************************************************************************
+static int	BayerChannel(const int xxx, const int yyy)
+{
+	return(((yyy & 1) << 1) | (xxx & 1));
+}
+
+//*****************************************************************************
+//*	gnomonic (TAN) projection, angles in radians
+//*****************************************************************************
+static bool	ProjectToTangent(const double tangentRA, const double tangentDecl, const double ra, const double decl, double *xi, double *eta)
+{
+double	cosC;
+
+	cosC	=	(sin(tangentDecl) * sin(decl)) + (cos(tangentDecl) * cos(decl) * cos(ra - tangentRA));
+	if (cosC <= 0.1)
+	{
+		return(false);
+	}
+	*xi		=	(cos(decl) * sin(ra - tangentRA)) / cosC;
+	*eta	=	((cos(tangentDecl) * sin(decl)) - (sin(tangentDecl) * cos(decl) * cos(ra - tangentRA))) / cosC;
+	return(true);
+}
+
+//*****************************************************************************
+//*	tangent plane to pixels relative to the center, same orientation as the
+//*	plate solver, east is left when north is up and the rotation is 0
+//*****************************************************************************
+static void	TangentToPixel(const TYPE_STARFIELD_SETTINGS *settings, const double xi, const double eta, double *pixelU, double *pixelV)
+{
+double	rotation;
+double	scale;
+
+	rotation	=	(settings->rotation_deg * PI) / 180.0;
+	scale		=	(settings->pixelScale_arcsec * PI) / (180.0 * 3600.0);
+	*pixelU		=	-((cos(rotation) * xi) - (sin(rotation) * eta)) / scale;
+	*pixelV		=	((cos(rotation) * eta) + (sin(rotation) * xi)) / scale;
+}
+
+//*****************************************************************************
+void	StarFieldSim_SetDefaults(TYPE_STARFIELD_SETTINGS *settings)
+{
+	memset(settings, 0, sizeof(TYPE_STARFIELD_SETTINGS));
+	//*	the Pleiades
+	settings->ra_deg			=	56.75;
+	settings->dec_deg			=	24.12;
+	settings->rotation_deg		=	0.0;
+	settings->pixelScale_arcsec	=	1.94;		//*	3.76 um pixels at 400 mm
+	settings->seeing_arcsec		=	2.5;
+	settings->limitMagnitude	=	14.0;
+	settings->zeroPointFlux		=	2.0e7;
+	settings->skyLevel			=	20.0;
+	settings->readNoise			=	3.0;
+	settings->electronsPerADU	=	1.0;
+	settings->offsetADU			=	500;
+	settings->hotPixelCount		=	200;
+	settings->driftRA_arcsec	=	0.5;
+	settings->driftDec_arcsec	=	0.2;
+	settings->bayerMosaic		=	true;
+	settings->randomSeed		=	1;
+}
+
+//*****************************************************************************
+static bool	AddStar(TYPE_STARFIELD *starField, const double pixelU, const double pixelV, const double magnitude, uint64_t *randomState)
+{
+double	xPixel;
+double	yPixel;
+int		margin;
+
+	if (starField->starCount >= kStarFieldSim_MaxStars)
+	{
+		return(false);
+	}
+	xPixel	=	(starField->width / 2.0) + pixelU;
+	yPixel	=	(starField->height / 2.0) + pixelV;
+	margin	=	kMaxPSFradius;
+	if ((xPixel < -margin) || (xPixel > (starField->width + margin)) ||
+		(yPixel < -margin) || (yPixel > (starField->height + margin)))
+	{
+		return(true);
+	}
+	starField->starList[starField->starCount].xPixel	=	xPixel;
+	starField->starList[starField->starCount].yPixel	=	yPixel;
+	starField->starList[starField->starCount].flux		=	starField->settings.zeroPointFlux * pow(10.0, -0.4 * magnitude);
+	starField->starList[starField->starCount].colorRB	=	0.7 + (0.8 * RandomUniform(randomState));
+	starField->starCount++;
+	return(true);
+}
+
+//*****************************************************************************
+//*	random stars between the catalog depth and the limit magnitude,
+//*	the cumulative count goes up by 10^kStarDensitySlope per magnitude
+//*****************************************************************************
+static void	AddRandomStars(TYPE_STARFIELD *starField, const double brightMagn, uint64_t *randomState)
+{
+const TYPE_STARFIELD_SETTINGS	*settings;
+double							fieldWidth_deg;
+double							fieldHeight_deg;
+double							densityBright;
+double							densityFaint;
+double							magnitude;
+double							cumulative;
+int								starCnt;
+int								iii;
+
+	settings	=	&starField->settings;
+	if (brightMagn >= settings->limitMagnitude)
+	{
+		return;
+	}
+	fieldWidth_deg	=	((starField->width + (2 * kMaxPSFradius)) * settings->pixelScale_arcsec) / 3600.0;
+	fieldHeight_deg	=	((starField->height + (2 * kMaxPSFradius)) * settings->pixelScale_arcsec) / 3600.0;
+	densityBright	=	kStarDensity6 * pow(10.0, kStarDensitySlope * (brightMagn - 6.0));
+	densityFaint	=	kStarDensity6 * pow(10.0, kStarDensitySlope * (settings->limitMagnitude - 6.0));
+	starCnt			=	(int)((densityFaint - densityBright) * fieldWidth_deg * fieldHeight_deg);
+	for (iii=0; iii<starCnt; iii++)
+	{
+		cumulative	=	densityBright + (RandomUniform(randomState) * (densityFaint - densityBright));
+		magnitude	=	6.0 + (log10(cumulative / kStarDensity6) / kStarDensitySlope);
+		if (AddStar(starField,
+					(RandomUniform(randomState) - 0.5) * (starField->width + (2 * kMaxPSFradius)),
+					(RandomUniform(randomState) - 0.5) * (starField->height + (2 * kMaxPSFradius)),
+					magnitude,
+					randomState) == false)
+		{
+			break;
+		}
+	}
+}
+
+//*****************************************************************************
+bool	StarFieldSim_Create(	TYPE_STARFIELD					*starField,
+								const TYPE_STARFIELD_SETTINGS	*settings,
+								const int						width,
+								const int						height)
+{
+TYPE_PLATESOLVE_CATSTAR	*catalogList;
+int						catalogCnt;
+double					fieldRadius_deg;
+double					catalogDepth;
+double					xi;
+double					eta;
+double					pixelU;
+double					pixelV;
+double					rotation;
+double					scale;
+uint64_t				randomState;
+int						iii;
+
+	memset(starField, 0, sizeof(TYPE_STARFIELD));
+	if ((width <= 0) || (height <= 0) || (settings->pixelScale_arcsec <= 0.0))
+	{
+		return(false);
+	}
+	starField->settings	=	*settings;
+	starField->width	=	width;
+	starField->height	=	height;
+	starField->starList	=	(TYPE_STARFIELD_STAR *)malloc(kStarFieldSim_MaxStars * sizeof(TYPE_STARFIELD_STAR));
+	if (starField->starList == NULL)
+	{
+		return(false);
+	}
+	randomState	=	settings->randomSeed;
+
+	//*	catalog stars
+	fieldRadius_deg	=	(sqrt((double)(width * width) + (double)(height * height)) * settings->pixelScale_arcsec) / (2.0 * 3600.0);
+	fieldRadius_deg	+=	(kMaxPSFradius * settings->pixelScale_arcsec) / 3600.0;
+	catalogCnt		=	PlateSolve_ReadCatalogField(settings->ra_deg,
+													settings->dec_deg,
+													fieldRadius_deg,
+													settings->limitMagnitude,
+													&catalogList,
+													starField->catalogName);
+	if (catalogList != NULL)
+	{
+		for (iii=0; iii<catalogCnt; iii++)
+		{
+			if (ProjectToTangent(	(settings->ra_deg * PI) / 180.0,
+									(settings->dec_deg * PI) / 180.0,
+									(catalogList[iii].ra_deg * PI) / 180.0,
+									(catalogList[iii].dec_deg * PI) / 180.0,
+									&xi,
+									&eta))
+			{
+				TangentToPixel(settings, xi, eta, &pixelU, &pixelV);
+				if (AddStar(starField, pixelU, pixelV, catalogList[iii].magnitude, &randomState) == false)
+				{
+					break;
+				}
+			}
+		}
+		free(catalogList);
+	}
+	starField->catalogStarCount	=	starField->starCount;
+
+	//*	fill in below the catalog
+	if (strcmp(starField->catalogName, "Hipparcos") == 0)
+	{
+		catalogDepth	=	kHipparcosDepth;
+	}
+	else if (strcmp(starField->catalogName, "Yale") == 0)
+	{
+		catalogDepth	=	kYaleDepth;
+	}
+	else
+	{
+		strcpy(starField->catalogName, "Random");
+		catalogDepth	=	-1.0;
+	}
+	AddRandomStars(starField, catalogDepth, &randomState);
+
+	//*	hot pixels do not move
+	starField->hotPixelCount	=	settings->hotPixelCount;
+	if (starField->hotPixelCount > kStarFieldSim_MaxHotPixels)
+	{
+		starField->hotPixelCount	=	kStarFieldSim_MaxHotPixels;
+	}
+	if (starField->hotPixelCount > 0)
+	{
+		starField->hotPixelList	=	(uint32_t *)malloc(starField->hotPixelCount * sizeof(uint32_t));
+		if (starField->hotPixelList == NULL)
+		{
+			starField->hotPixelCount	=	0;
+		}
+		for (iii=0; iii<starField->hotPixelCount; iii++)
+		{
+			starField->hotPixelList[iii]	=	RandomNext(&randomState) % ((uint64_t)width * height);
+		}
+	}
+
+	//*	tracking drift, the same direction as the catalog stars
+	rotation				=	(settings->rotation_deg * PI) / 180.0;
+	scale					=	settings->pixelScale_arcsec;
+	starField->pixelDriftX	=	-((cos(rotation) * settings->driftRA_arcsec) - (sin(rotation) * settings->driftDec_arcsec)) / scale;
+	starField->pixelDriftY	=	((cos(rotation) * settings->driftDec_arcsec) + (sin(rotation) * settings->driftRA_arcsec)) / scale;
+
+	CONSOLE_DEBUG_W_STR("Star field catalog \t=",	starField->catalogName);
+	CONSOLE_DEBUG_W_NUM("Catalog stars      \t=",	starField->catalogStarCount);
+	CONSOLE_DEBUG_W_NUM("Total stars        \t=",	starField->starCount);
+	return(true);
+}
+
+//*****************************************************************************
+void	StarFieldSim_Release(TYPE_STARFIELD *starField)
+{
+	if (starField->starList != NULL)
+	{
+		free(starField->starList);
+	}
+	if (starField->hotPixelList != NULL)
+	{
+		free(starField->hotPixelList);
+	}
+	memset(starField, 0, sizeof(TYPE_STARFIELD));
+}
+
+//*****************************************************************************
+//*	fraction of a Gaussian that lands on each pixel, pixel centers are on integers
+//*****************************************************************************
+static void	PixelWeights(const double center, const double sigma, const int firstPixel, const int pixelCnt, float *weights)
+{
+double	scale;
+double	lowerEdge;
+double	upperEdge;
+int		iii;
+
+	scale		=	1.0 / (sqrt(2.0) * sigma);
+	lowerEdge	=	erf(((firstPixel - 0.5) - center) * scale);
+	for (iii=0; iii<pixelCnt; iii++)
+	{
+		upperEdge		=	erf(((firstPixel + iii + 0.5) - center) * scale);
+		weights[iii]	=	0.5 * (upperEdge - lowerEdge);
+		lowerEdge		=	upperEdge;
+	}
+}
+
+//*****************************************************************************
+//*	adds the expected electrons of every star to the buffer
+//*****************************************************************************
+static void	RenderStars(const TYPE_STARFIELD *starField, const double driftX, const double driftY, const double exposure_secs, float *electronBuf)
+{
+const TYPE_STARFIELD_SETTINGS	*settings;
+const TYPE_STARFIELD_STAR		*star;
+float							xWeights[(2 * kMaxPSFradius) + 1];
+float							yWeights[(2 * kMaxPSFradius) + 1];
+float							channelGain[4];
+float							starElectrons;
+float							rowElectrons;
+double							sigma;
+double							xCenter;
+double							yCenter;
+int								psfRadius;
+int								firstX;
+int								firstY;
+int								lastX;
+int								lastY;
+int								xxx;
+int								yyy;
+int								iii;
+
+	settings	=	&starField->settings;
+	sigma		=	(settings->seeing_arcsec / settings->pixelScale_arcsec) / 2.3548;
+	if (sigma < 0.3)
+	{
+		sigma	=	0.3;
+	}
+	psfRadius	=	(int)ceil(kPSFradiusSigma * sigma);
+	if (psfRadius > kMaxPSFradius)
+	{
+		psfRadius	=	kMaxPSFradius;
+	}
+	for (iii=0; iii<starField->starCount; iii++)
+	{
+		star	=	&starField->starList[iii];
+		xCenter	=	star->xPixel + driftX;
+		yCenter	=	star->yPixel + driftY;
+		firstX	=	(int)floor(xCenter) - psfRadius;
+		firstY	=	(int)floor(yCenter) - psfRadius;
+		lastX	=	firstX + (2 * psfRadius);
+		lastY	=	firstY + (2 * psfRadius);
+		if ((lastX < 0) || (lastY < 0) || (firstX >= starField->width) || (firstY >= starField->height))
+		{
+			continue;
+		}
+		PixelWeights(xCenter, sigma, firstX, (2 * psfRadius) + 1, xWeights);
+		PixelWeights(yCenter, sigma, firstY, (2 * psfRadius) + 1, yWeights);
+		starElectrons	=	star->flux * exposure_secs;
+		channelGain[0]	=	1.0;
+		channelGain[1]	=	1.0;
+		channelGain[2]	=	1.0;
+		channelGain[3]	=	1.0;
+		if (settings->bayerMosaic)
+		{
+			channelGain[0]	=	0.75 * star->colorRB;
+			channelGain[3]	=	0.65 / star->colorRB;
+		}
+		for (yyy=firstY; yyy<=lastY; yyy++)
+		{
+			if ((yyy < 0) || (yyy >= starField->height))
+			{
+				continue;
+			}
+			rowElectrons	=	starElectrons * yWeights[yyy - firstY];
+			for (xxx=firstX; xxx<=lastX; xxx++)
+			{
+				if ((xxx >= 0) && (xxx < starField->width))
+				{
+					electronBuf[(yyy * starField->width) + xxx]	+=	rowElectrons *
+																	xWeights[xxx - firstX] *
+																	channelGain[BayerChannel(xxx, yyy)];
+				}
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//*	noise and conversion to ADU, each row has its own random sequence
+//*	so the result does not depend on the number of threads
+//*****************************************************************************
+static void	RenderNoiseBand(void *context, int firstRow, int lastRow)
+{
+TYPE_RENDER_CONTEXT				*renderContext;
+const TYPE_STARFIELD_SETTINGS	*settings;
+const float						*electronPtr;
+uint16_t						*outputPtr;
+uint64_t						randomState;
+double							electrons;
+double							adcValue;
+double							aduPerElectron;
+int								width;
+int								xxx;
+int								yyy;
+
+	renderContext	=	(TYPE_RENDER_CONTEXT *)context;
+	settings		=	&renderContext->starField->settings;
+	width			=	renderContext->starField->width;
+	aduPerElectron	=	1.0 / settings->electronsPerADU;
+	for (yyy=firstRow; yyy<lastRow; yyy++)
+	{
+		randomState	=	((uint64_t)settings->randomSeed << 40) ^
+						((uint64_t)renderContext->frameNumber << 20) ^
+						(uint64_t)yyy;
+		RandomNext(&randomState);
+		electronPtr	=	&renderContext->electronBuf[yyy * width];
+		outputPtr	=	&renderContext->frameBuffer[yyy * width];
+		for (xxx=0; xxx<width; xxx++)
+		{
+			electrons	=	RandomPoisson(&randomState, electronPtr[xxx]);
+			electrons	+=	settings->readNoise * RandomGaussian(&randomState);
+			adcValue	=	(electrons * aduPerElectron) + settings->offsetADU;
+			if (adcValue < 0.0)
+			{
+				adcValue	=	0.0;
+			}
+			else if (adcValue > 65535.0)
+			{
+				adcValue	=	65535.0;
+			}
+			outputPtr[xxx]	=	(uint16_t)adcValue;
+		}
+	}
+}
+
+//*****************************************************************************
+bool	StarFieldSim_Render(	const TYPE_STARFIELD	*starField,
+								const int				frameNumber,
+								const double			exposure_secs,
+								uint16_t				*frameBuffer)
+{
+TYPE_RENDER_CONTEXT	renderContext;
+float				*electronBuf;
+float				skyElectrons;
+uint64_t			randomState;
+int					pixelCount;
+int					xxx;
+int					yyy;
+int					iii;
+
+	if ((starField->starList == NULL) || (frameBuffer == NULL))
+	{
+		return(false);
+	}
+	pixelCount	=	starField->width * starField->height;
+	electronBuf	=	(float *)malloc(pixelCount * sizeof(float));
+	if (electronBuf == NULL)
+	{
+		return(false);
+	}
+
+	//*	sky background
+	skyElectrons	=	starField->settings.skyLevel * exposure_secs;
+	for (yyy=0; yyy<starField->height; yyy++)
+	{
+		for (xxx=0; xxx<starField->width; xxx++)
+		{
+			if (starField->settings.bayerMosaic)
+			{
+				electronBuf[(yyy * starField->width) + xxx]	=	skyElectrons * gSkyChannelGain[BayerChannel(xxx, yyy)];
+			}
+			else
+			{
+				electronBuf[(yyy * starField->width) + xxx]	=	skyElectrons;
+			}
+		}
+	}
+
+	RenderStars(starField,
+				frameNumber * starField->pixelDriftX,
+				frameNumber * starField->pixelDriftY,
+				exposure_secs,
+				electronBuf);
+
+	//*	hot pixels are dark current, the rate is fixed for each pixel
+	randomState	=	starField->settings.randomSeed ^ 0x5DEECE66Dull;
+	for (iii=0; iii<starField->hotPixelCount; iii++)
+	{
+		electronBuf[starField->hotPixelList[iii]]	+=	(200.0 + (20000.0 * RandomUniform(&randomState))) * exposure_secs;
+	}
+
+	renderContext.starField		=	starField;
+	renderContext.electronBuf	=	electronBuf;
+	renderContext.frameBuffer	=	frameBuffer;
+	renderContext.frameNumber	=	frameNumber;
+	ImageKernel_RunRowBands(starField->height, RenderNoiseBand, &renderContext);
+
+	free(electronBuf);
+	return(true);
+}
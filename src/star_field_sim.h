@@ -0,0 +1,90 @@
+//*****************************************************************************
+//#include	"star_field_sim.h"
+
+#ifndef _STAR_FIELD_SIM_H_
+#define	_STAR_FIELD_SIM_H_
+
+#ifndef _STDINT_H
+	#include	<stdint.h>
+#endif
+#ifndef _STDBOOL_H
+	#include	<stdbool.h>
+#endif
+
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#define	kStarFieldSim_MaxStars		50000
+#define	kStarFieldSim_MaxHotPixels	100000
+
+//*****************************************************************************
+typedef struct	//	TYPE_STARFIELD_SETTINGS
+{
+	double		ra_deg;					//*	center of the field, J2000
+	double		dec_deg;
+	double		rotation_deg;			//*	position angle of image +Y, east of north
+	double		pixelScale_arcsec;
+	double		seeing_arcsec;			//*	FWHM of the PSF
+	double		limitMagnitude;			//*	faintest star rendered
+	double		zeroPointFlux;			//*	electrons per second from a magnitude 0 star
+	double		skyLevel;				//*	electrons per pixel per second
+	double		readNoise;				//*	electrons rms
+	double		electronsPerADU;
+	int			offsetADU;
+	int			hotPixelCount;
+	double		driftRA_arcsec;			//*	tracking error, per frame
+	double		driftDec_arcsec;
+	bool		bayerMosaic;			//*	RGGB
+	uint32_t	randomSeed;
+} TYPE_STARFIELD_SETTINGS;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STARFIELD_STAR
+{
+	float		xPixel;					//*	position in frame 0
+	float		yPixel;
+	float		flux;					//*	electrons per second
+	float		colorRB;				//*	red / blue response, 1.0 = white
+} TYPE_STARFIELD_STAR;
+
+//*****************************************************************************
+typedef struct	//	TYPE_STARFIELD
+{
+	TYPE_STARFIELD_SETTINGS	settings;
+	int						width;
+	int						height;
+	TYPE_STARFIELD_STAR		*starList;
+	int						starCount;
+	int						catalogStarCount;	//*	the rest are random stars fainter than the catalog
+	uint32_t				*hotPixelList;		//*	pixel index
+	int						hotPixelCount;
+	char					catalogName[32];	//*	"Random" if there is no catalog
+	double					pixelDriftX;		//*	per frame
+	double					pixelDriftY;
+} TYPE_STARFIELD;
+
+void	StarFieldSim_SetDefaults(TYPE_STARFIELD_SETTINGS *settings);
+
+//*	projects the catalog stars onto the sensor, this reads the catalog and is slow
+bool	StarFieldSim_Create(	TYPE_STARFIELD					*starField,
+								const TYPE_STARFIELD_SETTINGS	*settings,
+								const int						width,
+								const int						height);
+void	StarFieldSim_Release(TYPE_STARFIELD *starField);
+
+//*	renders one frame in ADU, frameNumber sets the tracking drift and the noise.
+//*	The same frameNumber always gives the same frame
+bool	StarFieldSim_Render(	const TYPE_STARFIELD	*starField,
+								const int				frameNumber,
+								const double			exposure_secs,
+								uint16_t				*frameBuffer);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _STAR_FIELD_SIM_H_
@@ -12,6 +12,7 @@
 //*	Mar 24,	2024	<MLS> Added recursive directory reading
 //*	Mar 24,	2024	<MLS> Fixed crash bug when image failed to load
 //*	Mar 27,	2024	<MLS> Added NASA MoonPhase window ti SkyImage
+//*	Oct 19,	2026	<MLS> Added ApplyImageIndex(), uses imageindex.dat instead of reading every FITS header
 //*****************************************************************************
 
 
@@ -46,6 +47,7 @@
 #include	"windowtab_MoonPhase.h"
 #include	"controller_image.h"
 #include	"imagelist.h"
+#include	"image_meta_index.h"
 
 
 bool	gKeepRunning			=	true;
@@ -64,6 +66,7 @@ static void	ReadFitsInfoForImage(TYPE_ImageFile *imageFileData);
 static void	ExtractFileExtension(const char *fileName, char *extension);
 static void	SetImageFileType(TYPE_ImageFile *imageFileInfo, const char *fileExtension);
 static int	FileNameQSort(const void *e1, const void* e2);
+static int	FileNameBSearch(const void *key, const void* element);
 
 //**************************************************************************************
 ControllerSkyImage::ControllerSkyImage(	const char *argWindowName, const char *argDirectoryPath)
@@ -335,6 +338,12 @@ TYPE_ImageFile	*entry2;
 	return(retValue);
 }
 
+//*****************************************************************************
+static int	FileNameBSearch(const void *key, const void* element)
+{
+	return(strcmp((const char *)key, ((const TYPE_ImageFile *)element)->FileName));
+}
+
 //*****************************************************************************
 static void	SetImageFileType(TYPE_ImageFile *imageFileInfo, const char *fileExtension)
 {
@@ -362,12 +371,70 @@ void	ControllerSkyImage::ReadFileDirectory(const char *directoryPath)
 	CONSOLE_DEBUG_W_STR(__FUNCTION__, directoryPath);
 
 	cFileIndex	=	0;
+	memset(gImageList, 0, sizeof(gImageList));
 	gImageCount	=	BuildFileList(directoryPath);
 	CONSOLE_DEBUG_W_NUM("gImageCount\t=", gImageCount);
+	ApplyImageIndex(directoryPath);
 //	CONSOLE_ABORT(__FUNCTION__);
 }
 
 
+//*****************************************************************************
+//*	The camera driver keeps an index of the images it saved (imageindex.dat),
+//*	the info for those files comes from the index so the FITS headers do not have to be read.
+//*	The directory is still read so deleted files and files that are not in the index are correct.
+//*	Returns the number of files that were found in the index
+//*****************************************************************************
+int	ControllerSkyImage::ApplyImageIndex(const char *directoryPath)
+{
+TYPE_IMAGE_META	*metaList;
+TYPE_IMAGE_META	*imageMeta;
+TYPE_ImageFile	*imageFile;
+int				metaCnt;
+int				matchCnt;
+int				iii;
+uint32_t		startMillisecs;
+
+	matchCnt	=	0;
+	if (gImageCount <= 0)
+	{
+		return(0);
+	}
+	startMillisecs	=	millis();
+	metaList		=	ImageMetaIndex_Load(directoryPath, &metaCnt);
+	if (metaList != NULL)
+	{
+		//*	gImageList is sorted by file name
+		for (iii=0; iii<metaCnt; iii++)
+		{
+			imageMeta	=	&metaList[iii];
+			imageFile	=	(TYPE_ImageFile *)bsearch(	imageMeta->fileName,
+														gImageList,
+														gImageCount,
+														sizeof(TYPE_ImageFile),
+														FileNameBSearch);
+			if ((imageFile != NULL) && (strcmp(imageFile->DirectoryPath, directoryPath) == 0))
+			{
+				imageFile->Exposure_secs		=	imageMeta->exposure_secs;
+				imageFile->Gain					=	imageMeta->gain;
+				imageFile->SaturationPercent	=	imageMeta->saturationPct;
+				imageFile->DATAMIN				=	imageMeta->minPixel;
+				imageFile->DATAMAX				=	imageMeta->maxPixel;
+				imageFile->HFR					=	imageMeta->hfr;
+				strcpy(imageFile->Object,	imageMeta->object);
+				strcpy(imageFile->Filter,	imageMeta->filter);
+				imageFile->FitsProcessed		=	true;
+				matchCnt++;
+			}
+		}
+		free(metaList);
+		CONSOLE_DEBUG_W_NUM("Index records\t=", metaCnt);
+		CONSOLE_DEBUG_W_NUM("Files in index\t=", matchCnt);
+		CONSOLE_DEBUG_W_NUM("Time (ms)\t=", (millis() - startMillisecs));
+	}
+	return(matchCnt);
+}
+
 //*****************************************************************************
 bool	LoadNextImageFromList(ControllerImage *imageController)
 {
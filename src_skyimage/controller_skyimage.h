@@ -59,6 +59,7 @@ class ControllerSkyImage: public Controller
 		virtual	void	RunBackgroundTasks(const char *callingFunction=NULL, bool enableDebug=false);
 		void			ReadFileDirectory(const char *directoryPath);
 		int				BuildFileList(const char *directoryPath);
+		int				ApplyImageIndex(const char *directoryPath);
 
 //		bool			LoadNextImageFromList(void);
 //		bool			LoadPreviousImageFromList(void);
@@ -23,6 +23,10 @@ typedef struct
 	double	SaturationPercent;
 	int		DATAMIN;
 	int		DATAMAX;
+	//*	only available from the image index (imageindex.dat)
+	char	Object[40];
+	char	Filter[24];
+	double	HFR;
 
 	//*	image alignment data
 	int		ImageOffsetX;